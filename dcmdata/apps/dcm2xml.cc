@@ -26,6 +26,7 @@
 #include "dcmtk/dcmdata/cmdlnarg.h"
 #include "dcmtk/ofstd/ofstd.h"
 #include "dcmtk/ofstd/ofstream.h"
+#include "dcmtk/ofstd/ofbufout.h"
 #include "dcmtk/ofstd/ofconapp.h"
 
 #ifdef WITH_ZLIB
@@ -47,6 +48,62 @@ static char rcsid[] = "$dcmtk: " OFFIS_CONSOLE_APPLICATION " v"
 
 // ********************************************
 
+static OFCondition writeDocument(STD_NAMESPACE ostream &out,
+                                 DcmFileFormat *dfile,
+                                 const E_FileReadMode readMode,
+                                 const char *dtdFilename,
+                                 const OFString &encString,
+                                 const size_t writeFlags)
+{
+    OFCondition result;
+    /* write XML document header */
+    out << "<?xml version=\"1.0\"";
+    /* optional character set */
+    if (encString.length() > 0)
+        out << " encoding=\"" << encString << "\"";
+    out << "?>" << OFendl;
+    /* add document type definition (DTD) */
+    if (writeFlags & DCMTypes::XF_addDocumentType)
+    {
+        out << "<!DOCTYPE ";
+        if (readMode == ERM_dataset)
+           out << "data-set";
+        else
+           out << "file-format";
+        /* embed DTD */
+        if (writeFlags & DCMTypes::XF_embedDocumentType)
+        {
+            out << " [" << OFendl;
+            /* copy content from DTD file */
+#ifdef HAVE_IOS_NOCREATE
+            STD_NAMESPACE ifstream dtdFile(dtdFilename, STD_NAMESPACE ios::in | STD_NAMESPACE ios::nocreate);
+#else
+            STD_NAMESPACE ifstream dtdFile(dtdFilename, STD_NAMESPACE ios::in);
+#endif
+            if (dtdFile)
+            {
+                char c;
+                /* copy all characters */
+                while (dtdFile.get(c))
+                    out << c;
+            } else {
+                OFLOG_WARN(dcm2xmlLogger, OFFIS_CONSOLE_APPLICATION << ": cannot open DTD file: " << dtdFilename);
+            }
+            out << "]";
+        } else { /* reference DTD */
+            out << " SYSTEM \"" << DOCUMENT_TYPE_DEFINITION_FILE << "\"";
+        }
+        out << ">" << OFendl;
+    }
+    /* write XML document content */
+    if (readMode == ERM_dataset)
+        result = dfile->getDataset()->writeXML(out, writeFlags);
+    else
+        result = dfile->writeXML(out, writeFlags);
+    return result;
+}
+
+
 static OFCondition writeFile(STD_NAMESPACE ostream &out,
                              const char *ifname,
                              DcmFileFormat *dfile,
@@ -55,7 +112,8 @@ static OFCondition writeFile(STD_NAMESPACE ostream &out,
                              const char *dtdFilename,
                              const char *defaultCharset,
                              /*const*/ size_t writeFlags,
-                             const OFBool checkAllStrings)
+                             const OFBool checkAllStrings,
+                             const OFBool bufferedOutput)
 {
     OFCondition result = EC_IllegalParameter;
     if ((ifname != NULL) && (dfile != NULL))
@@ -165,50 +223,15 @@ static OFCondition writeFile(STD_NAMESPACE ostream &out,
             }
         }
 
-        /* write XML document header */
-        out << "<?xml version=\"1.0\"";
-        /* optional character set */
-        if (encString.length() > 0)
-            out << " encoding=\"" << encString << "\"";
-        out << "?>" << OFendl;
-        /* add document type definition (DTD) */
-        if (writeFlags & DCMTypes::XF_addDocumentType)
+        /* write XML document (optionally collecting the output in a large buffer) */
+        if (bufferedOutput)
         {
-            out << "<!DOCTYPE ";
-            if (readMode == ERM_dataset)
-               out << "data-set";
-            else
-               out << "file-format";
-            /* embed DTD */
-            if (writeFlags & DCMTypes::XF_embedDocumentType)
-            {
-                out << " [" << OFendl;
-                /* copy content from DTD file */
-#ifdef HAVE_IOS_NOCREATE
-                STD_NAMESPACE ifstream dtdFile(dtdFilename, STD_NAMESPACE ios::in | STD_NAMESPACE ios::nocreate);
-#else
-                STD_NAMESPACE ifstream dtdFile(dtdFilename, STD_NAMESPACE ios::in);
-#endif
-                if (dtdFile)
-                {
-                    char c;
-                    /* copy all characters */
-                    while (dtdFile.get(c))
-                        out << c;
-                } else {
-                    OFLOG_WARN(dcm2xmlLogger, OFFIS_CONSOLE_APPLICATION << ": cannot open DTD file: " << dtdFilename);
-                }
-                out << "]";
-            } else { /* reference DTD */
-                out << " SYSTEM \"" << DOCUMENT_TYPE_DEFINITION_FILE << "\"";
-            }
-            out << ">" << OFendl;
-        }
-        /* write XML document content */
-        if (readMode == ERM_dataset)
-            result = dset->writeXML(out, writeFlags);
-        else
-            result = dfile->writeXML(out, writeFlags);
+            OFBufferedOutputStream bufferedStream(out);
+            result = writeDocument(bufferedStream, dfile, readMode, dtdFilename, encString, writeFlags);
+            if (result.good() && !bufferedStream.flushBuffer())
+                result = EC_InvalidStream;
+        } else
+            result = writeDocument(out, dfile, readMode, dtdFilename, encString, writeFlags);
     }
     return result;
 }
@@ -223,6 +246,7 @@ int main(int argc, char *argv[])
     size_t opt_writeFlags = 0;
     OFBool opt_loadIntoMemory = OFFalse;
     OFBool opt_checkAllStrings = OFFalse;
+    OFBool opt_bufferedOutput = OFFalse;
 #ifdef WITH_LIBICONV
     OFBool opt_convertToUTF8 = OFFalse;
 #endif
@@ -290,6 +314,9 @@ int main(int argc, char *argv[])
         cmd.addOption("--write-binary-data",  "+Wb",    "write binary data of OB and OW elements\n(default: off, be careful with --load-all)");
         cmd.addOption("--encode-hex",         "+Eh",    "encode binary data as hex numbers (default)");
         cmd.addOption("--encode-base64",      "+Eb",    "encode binary data as Base64 (RFC 2045, MIME)");
+      cmd.addSubGroup("output buffering:");
+        cmd.addOption("--unbuffered-output",  "-Ob",    "flush the output after each line (default)");
+        cmd.addOption("--buffered-output",    "+Ob",    "collect the output in a large buffer\n(faster for large documents)");
 
     /* evaluate command line */
     prepareCmdLineArgs(argc, argv, OFFIS_CONSOLE_APPLICATION);
@@ -439,6 +466,13 @@ int main(int argc, char *argv[])
             opt_writeFlags |= DCMTypes::XF_encodeBase64;
         }
         cmd.endOptionBlock();
+
+        cmd.beginOptionBlock();
+        if (cmd.findOption("--unbuffered-output"))
+            opt_bufferedOutput = OFFalse;
+        if (cmd.findOption("--buffered-output"))
+            opt_bufferedOutput = OFTrue;
+        cmd.endOptionBlock();
     }
 
     /* print resource identifier */
@@ -542,14 +576,14 @@ int main(int argc, char *argv[])
                     {
                         /* write content in XML format to file */
                         if (writeFile(stream, ifname, &dfile, opt_readMode, opt_loadIntoMemory, opt_dtdFilename,
-                                      opt_defaultCharset, opt_writeFlags, opt_checkAllStrings).bad())
+                                      opt_defaultCharset, opt_writeFlags, opt_checkAllStrings, opt_bufferedOutput).bad())
                             result = 2;
                     } else
                         result = 1;
                 } else {
                     /* write content in XML format to standard output */
                     if (writeFile(COUT, ifname, &dfile, opt_readMode, opt_loadIntoMemory, opt_dtdFilename,
-                                  opt_defaultCharset, opt_writeFlags, opt_checkAllStrings).bad())
+                                  opt_defaultCharset, opt_writeFlags, opt_checkAllStrings, opt_bufferedOutput).bad())
                         result = 3;
                 }
             }
@@ -26,16 +26,31 @@
 #define INCLUDE_CSTRING
 #include "dcmtk/ofstd/ofstdinc.h"
 
+BEGIN_EXTERN_C
+#ifdef HAVE_SYS_STAT_H
+#include <sys/stat.h>    /* for mkdir() */
+#endif
+END_EXTERN_C
+
 #ifdef HAVE_GUSI_H
 #include <GUSI.h>
 #endif
 
+#ifdef HAVE_WINDOWS_H
+#include <direct.h>      /* for _mkdir() */
+#endif
+
 #include "dcmtk/dcmdata/dctk.h"
 #include "dcmtk/dcmdata/cmdlnarg.h"
 #include "dcmtk/ofstd/ofconapp.h"
 #include "dcmtk/dcmdata/dcuid.h"       /* for dcmtk version name */
 #include "dcmtk/dcmdata/dcostrmz.h"    /* for dcmZlibCompressionLevel */
 #include "dcmtk/dcmdata/dcistrmz.h"    /* for dcmZlibExpectRFC1950Encoding */
+#include "dcmtk/ofstd/ofstd.h"         /* for OFStandard */
+#include "dcmtk/ofstd/ofmap.h"         /* for OFMap */
+#include "dcmtk/ofstd/ofvector.h"      /* for OFVector */
+
+#include "dcmtk/ofstd/ofthpool.h"     /* for OFThreadPool */
 
 #ifdef WITH_ZLIB
 #include <zlib.h>                      /* for zlibVersion() */
@@ -57,6 +72,53 @@ static char rcsid[] = "$dcmtk: " OFFIS_CONSOLE_APPLICATION " v"
 #define SHORTCOL 3
 #define LONGCOL 21
 
+/* pattern matching is only available on certain platforms */
+#if defined(HAVE_FNMATCH_H) || defined(HAVE_WINDOWS_H)
+#define PATTERN_MATCHING_AVAILABLE
+#endif
+
+
+/* options that control the conversion of a single file */
+struct DcmconvOptions
+{
+  DcmconvOptions()
+  : readMode(ERM_autoDetect)
+  , writeMode(EWM_fileformat)
+  , ixfer(EXS_Unknown)
+  , oxfer(EXS_Unknown)
+  , oglenc(EGL_recalcGL)
+  , oenctype(EET_ExplicitLength)
+  , opadenc(EPD_noChange)
+  , filepad(0)
+  , itempad(0)
+#ifdef WITH_LIBICONV
+  , convertToCharset(NULL)
+  , transliterate(OFFalse)
+#endif
+  , noInvalidGroups(OFFalse)
+  , batchMode(OFFalse)
+  {
+  }
+
+  E_FileReadMode readMode;
+  E_FileWriteMode writeMode;
+  E_TransferSyntax ixfer;
+  E_TransferSyntax oxfer;
+  E_GrpLenEncoding oglenc;
+  E_EncodingType oenctype;
+  E_PaddingEncoding opadenc;
+  OFCmdUnsignedInt filepad;
+  OFCmdUnsignedInt itempad;
+#ifdef WITH_LIBICONV
+  const char *convertToCharset;
+  OFBool transliterate;
+#endif
+  OFBool noInvalidGroups;
+  /* if true, a failure only affects the current file and is not fatal */
+  OFBool batchMode;
+};
+
+
 static DcmTagKey parseTagKey(const char *tagName)
 {
   unsigned int group = 0xffff;
@@ -82,6 +144,150 @@ static DcmTagKey parseTagKey(const char *tagName)
   }
 }
 
+static void logFailure(const DcmconvOptions &options, const OFString &message)
+{
+  /* in batch mode, the remaining files are still processed */
+  if (options.batchMode)
+    OFLOG_ERROR(dcmconvLogger, message);
+  else
+    OFLOG_FATAL(dcmconvLogger, message);
+}
+
+static OFCondition convertFile(const char *ifname, const char *ofname, const DcmconvOptions &options)
+{
+    DcmFileFormat fileformat;
+    DcmDataset *dataset = fileformat.getDataset();
+
+    OFLOG_INFO(dcmconvLogger, "open input file " << ifname);
+
+    OFCondition error = fileformat.loadFile(ifname, options.ixfer, EGL_noChange, DCM_MaxReadLength, options.readMode);
+
+    if (error.bad())
+    {
+        logFailure(options, OFString(error.text()) + ": reading file: " + ifname);
+        return error;
+    }
+
+    OFLOG_INFO(dcmconvLogger, "load all data into memory");
+    /* make sure that pixel data is loaded before output file is created */
+    dataset->loadAllDataIntoMemory();
+
+    if (options.noInvalidGroups)
+    {
+        OFLOG_INFO(dcmconvLogger, "remove all elements with an invalid group number");
+        fileformat.removeInvalidGroups();
+    }
+#ifdef WITH_LIBICONV
+    if (options.convertToCharset != NULL)
+    {
+        OFString toCharset(options.convertToCharset);
+        /* convert the complete dataset to a new character encoding */
+        OFLOG_INFO(dcmconvLogger, "converting all element values that are affected by "
+            << "Specific Character Set (0008,0005) to '" << options.convertToCharset << "'"
+            << (toCharset.empty() ? " (ASCII)" : ""));
+        error = fileformat.convertCharacterSet(toCharset, options.transliterate);
+        if (error.bad())
+        {
+            logFailure(options, OFString(error.text()) + ": processing file: " + ifname);
+            return error;
+        }
+    }
+#endif
+
+    E_TransferSyntax oxfer = options.oxfer;
+    if (oxfer == EXS_Unknown)
+    {
+        OFLOG_INFO(dcmconvLogger, "set output transfer syntax to input transfer syntax");
+        oxfer = dataset->getOriginalXfer();
+    }
+
+    OFLOG_INFO(dcmconvLogger, "check if new output transfer syntax is possible");
+
+    DcmXfer oxferSyn(oxfer);
+
+    dataset->chooseRepresentation(oxfer, NULL);
+
+    if (dataset->canWriteXfer(oxfer))
+    {
+        OFLOG_INFO(dcmconvLogger, "output transfer syntax " << oxferSyn.getXferName() << " can be written");
+    } else {
+        logFailure(options, OFString("no conversion to transfer syntax ") + oxferSyn.getXferName() + " possible!"
+            + (options.batchMode ? OFString(": ") + ifname : OFString()));
+        return EC_CannotChangeRepresentation;
+    }
+
+    OFLOG_INFO(dcmconvLogger, "create output file " << ofname);
+
+    error = fileformat.saveFile(ofname, oxfer, options.oenctype, options.oglenc, options.opadenc,
+        OFstatic_cast(Uint32, options.filepad), OFstatic_cast(Uint32, options.itempad), options.writeMode);
+
+    if (error.bad())
+    {
+        logFailure(options, OFString(error.text()) + ": writing file: " + ofname);
+        return error;
+    }
+
+    OFLOG_INFO(dcmconvLogger, "conversion successful");
+
+    return EC_Normal;
+}
+
+/* list of files to be converted in batch mode, processed by a pool of threads */
+class DcmconvBatch : public OFParallelJobs
+{
+public:
+  DcmconvBatch(const DcmconvOptions &options)
+  : inputFiles()
+  , outputFiles()
+  , results()
+  , options_(options)
+  {
+  }
+
+  /* convert the file with the given index */
+  virtual OFCondition processJob(const size_t jobNo, const size_t /* threadNo */)
+  {
+    results[jobNo] = convertFile(inputFiles[jobNo].c_str(), outputFiles[jobNo].c_str(), options_);
+    return results[jobNo];
+  }
+
+  OFVector<OFString> inputFiles;
+  OFVector<OFString> outputFiles;
+  /* result of the conversion for each file */
+  OFVector<OFCondition> results;
+
+private:
+  const DcmconvOptions &options_;
+};
+
+/* create the given subdirectory (and all its parent directories) of the output directory */
+static OFBool createOutputSubdirectory(const OFString &outputDirectory, const OFString &subdirectory)
+{
+  OFString dirName;
+  OFStandard::combineDirAndFilename(dirName, outputDirectory, subdirectory);
+  if (subdirectory.empty() || OFStandard::dirExists(dirName))
+    return OFTrue;
+  OFString parentDir;
+  OFStandard::getDirNameFromPath(parentDir, subdirectory, OFFalse /*assumeDirName*/);
+  if (!createOutputSubdirectory(outputDirectory, parentDir))
+    return OFFalse;
+  OFLOG_DEBUG(dcmconvLogger, "creating output subdirectory: " << dirName);
+#ifdef HAVE_WINDOWS_H
+  if (_mkdir(dirName.c_str()) == -1)
+#else
+  if (mkdir(dirName.c_str(), S_IRWXU | S_IRWXG | S_IRWXO) == -1)
+#endif
+  {
+    /* the directory might have been created in the meantime */
+    if (!OFStandard::dirExists(dirName))
+    {
+      OFLOG_ERROR(dcmconvLogger, "cannot create output subdirectory: " << dirName);
+      return OFFalse;
+    }
+  }
+  return OFTrue;
+}
+
 int main(int argc, char *argv[])
 {
 
@@ -110,14 +316,21 @@ int main(int argc, char *argv[])
   OFBool opt_transliterate = OFFalse;
 #endif
   OFBool opt_noInvalidGroups = OFFalse;
+  const char *opt_outputDirectory = NULL;
+  OFBool opt_scanDir = OFFalse;
+  OFBool opt_recurse = OFFalse;
+  const char *opt_scanPattern = "";
+#ifdef WITH_THREADS
+  OFCmdUnsignedInt opt_threads = 1;
+#endif
 
   OFConsoleApplication app(OFFIS_CONSOLE_APPLICATION , "Convert DICOM file encoding", rcsid);
   OFCommandLine cmd;
   cmd.setOptionColumns(LONGCOL, SHORTCOL);
   cmd.setParamColumn(LONGCOL + SHORTCOL + 4);
 
-  cmd.addParam("dcmfile-in",  "DICOM input filename to be converted");
-  cmd.addParam("dcmfile-out", "DICOM output filename");
+  cmd.addParam("dcmfile-in",  "DICOM input filename to be converted\n(more than one with --output-directory)", OFCmdParam::PM_MultiMandatory);
+  cmd.addParam("dcmfile-out", "DICOM output filename (not with --output-directory)", OFCmdParam::PM_Optional);
 
   cmd.addGroup("general options:", LONGCOL, SHORTCOL + 2);
     cmd.addOption("--help",                  "-h",     "print this help text and exit", OFCommandLine::AF_Exclusive);
@@ -129,6 +342,14 @@ int main(int argc, char *argv[])
       cmd.addOption("--read-file",           "+f",     "read file format or data set (default)");
       cmd.addOption("--read-file-only",      "+fo",    "read file format only");
       cmd.addOption("--read-dataset",        "-f",     "read data set without file meta information");
+    cmd.addSubGroup("input files (only with --output-directory):");
+      cmd.addOption("--scan-directories",    "+sd",    "scan directories for input files (dcmfile-in)");
+#ifdef PATTERN_MATCHING_AVAILABLE
+      cmd.addOption("--scan-pattern",        "+sp", 1, "[p]attern: string (only with --scan-directories)",
+                                                       "pattern for filename matching (wildcards)");
+#endif
+      cmd.addOption("--no-recurse",          "-r",     "do not recurse within directories (default)");
+      cmd.addOption("--recurse",             "+r",     "recurse within specified directories");
     cmd.addSubGroup("input transfer syntax:", LONGCOL, SHORTCOL);
       cmd.addOption("--read-xfer-auto",      "-t=",    "use TS recognition (default)");
       cmd.addOption("--read-xfer-detect",    "-td",    "ignore TS specified in the file meta header");
@@ -186,8 +407,16 @@ int main(int argc, char *argv[])
 #endif
     cmd.addSubGroup("other processing options:");
       cmd.addOption("--no-invalid-groups",   "-ig",    "remove elements with invalid group number");
+#ifdef WITH_THREADS
+    cmd.addSubGroup("multi-threading (only with --output-directory):");
+      cmd.addOption("--threads",             "+th", 1, "[n]umber: integer (default: 1)",
+                                                       "convert n files in parallel");
+#endif
 
   cmd.addGroup("output options:");
+    cmd.addSubGroup("output files:");
+      cmd.addOption("--output-directory",    "-od", 1, "[d]irectory: string",
+                                                       "write output files to existing directory d,\nall parameters are input files (batch mode)");
     cmd.addSubGroup("output file format:");
       cmd.addOption("--write-file",          "+F",     "write file format (default)");
       cmd.addOption("--write-new-meta-info", "+Fm",    "write file format with new meta information");
@@ -249,13 +478,20 @@ int main(int argc, char *argv[])
           }
       }
 
-      /* command line parameters */
-      cmd.getParam(1, opt_ifname);
-      cmd.getParam(2, opt_ofname);
-
       /* general options */
       OFLog::configureFromCommandLine(cmd, app);
 
+      /* command line parameters */
+      if (cmd.findOption("--output-directory"))
+      {
+        app.checkValue(cmd.getValue(opt_outputDirectory));
+      } else {
+        if (cmd.getParamCount() != 2)
+          app.printError("exactly one input and one output file required (or use --output-directory)");
+        cmd.getParam(1, opt_ifname);
+        cmd.getParam(2, opt_ofname);
+      }
+
       /* input options */
       cmd.beginOptionBlock();
       if (cmd.findOption("--read-file")) opt_readMode = ERM_autoDetect;
@@ -263,6 +499,27 @@ int main(int argc, char *argv[])
       if (cmd.findOption("--read-dataset")) opt_readMode = ERM_dataset;
       cmd.endOptionBlock();
 
+      if (cmd.findOption("--scan-directories"))
+      {
+        app.checkDependence("--scan-directories", "--output-directory", opt_outputDirectory != NULL);
+        opt_scanDir = OFTrue;
+      }
+#ifdef PATTERN_MATCHING_AVAILABLE
+      if (cmd.findOption("--scan-pattern"))
+      {
+        app.checkDependence("--scan-pattern", "--scan-directories", opt_scanDir);
+        app.checkValue(cmd.getValue(opt_scanPattern));
+      }
+#endif
+      cmd.beginOptionBlock();
+      if (cmd.findOption("--no-recurse")) opt_recurse = OFFalse;
+      if (cmd.findOption("--recurse"))
+      {
+        app.checkDependence("--recurse", "--scan-directories", opt_scanDir);
+        opt_recurse = OFTrue;
+      }
+      cmd.endOptionBlock();
+
       cmd.beginOptionBlock();
       if (cmd.findOption("--read-xfer-auto"))
         opt_ixfer = EXS_Unknown;
@@ -433,6 +690,13 @@ int main(int argc, char *argv[])
       }
 #endif
       if (cmd.findOption("--no-invalid-groups")) opt_noInvalidGroups = OFTrue;
+#ifdef WITH_THREADS
+      if (cmd.findOption("--threads"))
+      {
+        app.checkDependence("--threads", "--output-directory", opt_outputDirectory != NULL);
+        app.checkValue(cmd.getValueAndCheckMinMax(opt_threads, 1, 256));
+      }
+#endif
 
       /* output options */
       cmd.beginOptionBlock();
@@ -516,84 +780,139 @@ int main(int argc, char *argv[])
             << DCM_DICT_ENVIRONMENT_VARIABLE);
     }
 
-    /* open input file */
-    if ((opt_ifname == NULL) || (strlen(opt_ifname) == 0))
+    DcmconvOptions options;
+    options.readMode = opt_readMode;
+    options.writeMode = opt_writeMode;
+    options.ixfer = opt_ixfer;
+    options.oxfer = opt_oxfer;
+    options.oglenc = opt_oglenc;
+    options.oenctype = opt_oenctype;
+    options.opadenc = opt_opadenc;
+    options.filepad = opt_filepad;
+    options.itempad = opt_itempad;
+#ifdef WITH_LIBICONV
+    options.convertToCharset = opt_convertToCharset;
+    options.transliterate = opt_transliterate;
+#endif
+    options.noInvalidGroups = opt_noInvalidGroups;
+
+    if (opt_outputDirectory == NULL)
     {
-        OFLOG_FATAL(dcmconvLogger, "invalid filename: <empty string>");
-        return 1;
+        /* open input file */
+        if ((opt_ifname == NULL) || (strlen(opt_ifname) == 0))
+        {
+            OFLOG_FATAL(dcmconvLogger, "invalid filename: <empty string>");
+            return 1;
+        }
+        return convertFile(opt_ifname, opt_ofname, options).good() ? 0 : 1;
     }
 
-    DcmFileFormat fileformat;
-    DcmDataset *dataset = fileformat.getDataset();
-
-    OFLOG_INFO(dcmconvLogger, "open input file " << opt_ifname);
-
-    OFCondition error = fileformat.loadFile(opt_ifname, opt_ixfer, EGL_noChange, DCM_MaxReadLength, opt_readMode);
-
-    if (error.bad())
+    /* batch mode: convert all input files into the output directory */
+    options.batchMode = OFTrue;
+    if (!OFStandard::dirExists(opt_outputDirectory))
     {
-        OFLOG_FATAL(dcmconvLogger, error.text() << ": reading file: " <<  opt_ifname);
+        OFLOG_FATAL(dcmconvLogger, "specified output directory does not exist: " << opt_outputDirectory);
         return 1;
     }
 
-    OFLOG_INFO(dcmconvLogger, "load all data into memory");
-    /* make sure that pixel data is loaded before output file is created */
-    dataset->loadAllDataIntoMemory();
-
-    if (opt_noInvalidGroups)
-    {
-        OFLOG_INFO(dcmconvLogger, "remove all elements with an invalid group number");
-        fileformat.removeInvalidGroups();
-    }
-#ifdef WITH_LIBICONV
-    if (opt_convertToCharset != NULL)
+    /* create list of input files, together with their path relative to the input directory */
+    OFList<OFString> inputFiles;
+    OFList<OFString> relativeFiles;
+    const int paramCount = cmd.getParamCount();
+    const char *paramString = NULL;
+    OFString fileName;
+    if (opt_scanDir)
+        OFLOG_INFO(dcmconvLogger, "determining input files ...");
+    for (int i = 1; i <= paramCount; i++)
     {
-        OFString toCharset(opt_convertToCharset);
-        /* convert the complete dataset to a new character encoding */
-        OFLOG_INFO(dcmconvLogger, "converting all element values that are affected by "
-            << "Specific Character Set (0008,0005) to '" << opt_convertToCharset << "'"
-            << (toCharset.empty() ? " (ASCII)" : ""));
-        error = fileformat.convertCharacterSet(toCharset, opt_transliterate);
-        if (error.bad())
+        cmd.getParam(i, paramString);
+        /* search directory recursively (if required) */
+        if (OFStandard::dirExists(paramString))
         {
-            OFLOG_FATAL(dcmconvLogger, error.text() << ": processing file: " << opt_ifname);
-            return 1;
+            if (opt_scanDir)
+            {
+                OFList<OFString> fileList;
+                OFStandard::searchDirectoryRecursively("" /*directory*/, fileList, opt_scanPattern, paramString /*dirPrefix*/, opt_recurse);
+                OFListIterator(OFString) iter = fileList.begin();
+                OFListIterator(OFString) last = fileList.end();
+                while (iter != last)
+                {
+                    inputFiles.push_back(OFStandard::combineDirAndFilename(fileName, paramString, *iter));
+                    relativeFiles.push_back(*iter);
+                    ++iter;
+                }
+            } else
+                OFLOG_WARN(dcmconvLogger, "ignoring directory because option --scan-directories is not set: " << paramString);
+        } else {
+            inputFiles.push_back(paramString);
+            relativeFiles.push_back(OFStandard::getFilenameFromPath(fileName, paramString));
         }
     }
-#endif
-
-    if (opt_oxfer == EXS_Unknown)
+    if (inputFiles.empty())
     {
-        OFLOG_INFO(dcmconvLogger, "set output transfer syntax to input transfer syntax");
-        opt_oxfer = dataset->getOriginalXfer();
+        OFLOG_FATAL(dcmconvLogger, "no input files to be converted");
+        return 1;
     }
 
-    OFLOG_INFO(dcmconvLogger, "check if new output transfer syntax is possible");
-
-    DcmXfer opt_oxferSyn(opt_oxfer);
-
-    dataset->chooseRepresentation(opt_oxfer, NULL);
-
-    if (dataset->canWriteXfer(opt_oxfer))
+    /* output files keep the path relative to the input directory, but each path must only be used once */
+    DcmconvBatch batch(options);
+    OFMap<OFString, OFString> usedNames;
+    OFString outputFile, subdirectory;
+    size_t ignoredFiles = 0;
+    OFListIterator(OFString) if_iter = inputFiles.begin();
+    OFListIterator(OFString) if_last = inputFiles.end();
+    OFListIterator(OFString) rf_iter = relativeFiles.begin();
+    while (if_iter != if_last)
     {
-        OFLOG_INFO(dcmconvLogger, "output transfer syntax " << opt_oxferSyn.getXferName() << " can be written");
-    } else {
-        OFLOG_FATAL(dcmconvLogger, "no conversion to transfer syntax " << opt_oxferSyn.getXferName() << " possible!");
-        return 1;
+        OFMap<OFString, OFString>::iterator it = usedNames.find(*rf_iter);
+        if (it != usedNames.end())
+        {
+            OFLOG_ERROR(dcmconvLogger, "ignoring file " << *if_iter << " because output file name is already used for "
+                << it->second);
+            ++ignoredFiles;
+        }
+        /* the subdirectories are created before the files are converted in parallel */
+        else if (!createOutputSubdirectory(opt_outputDirectory, OFStandard::getDirNameFromPath(subdirectory, *rf_iter, OFFalse /*assumeDirName*/)))
+        {
+            OFLOG_ERROR(dcmconvLogger, "ignoring file " << *if_iter << " because output directory cannot be created");
+            ++ignoredFiles;
+        } else {
+            usedNames.insert(OFMake_pair(*rf_iter, *if_iter));
+            batch.inputFiles.push_back(*if_iter);
+            batch.outputFiles.push_back(OFStandard::combineDirAndFilename(outputFile, opt_outputDirectory, *rf_iter));
+        }
+        ++if_iter;
+        ++rf_iter;
     }
 
-    OFLOG_INFO(dcmconvLogger, "create output file " << opt_ofname);
-
-    error = fileformat.saveFile(opt_ofname, opt_oxfer, opt_oenctype, opt_oglenc, opt_opadenc,
-        OFstatic_cast(Uint32, opt_filepad), OFstatic_cast(Uint32, opt_itempad), opt_writeMode);
-
-    if (error.bad())
+#ifdef WITH_THREADS
+    size_t numThreads = OFstatic_cast(size_t, opt_threads);
+#else
+    size_t numThreads = 1;
+#endif
+    if (numThreads > batch.inputFiles.size())
+        numThreads = batch.inputFiles.size();
+    /* the calling thread also converts files */
+    OFThreadPool pool(numThreads);
+    if (pool.getNumberOfThreads() < numThreads)
+        OFLOG_WARN(dcmconvLogger, "unable to start worker thread, using fewer threads");
+    if (pool.getNumberOfThreads() > 1)
+        OFLOG_INFO(dcmconvLogger, "converting " << batch.inputFiles.size() << " files with " << pool.getNumberOfThreads() << " threads");
+    batch.results.resize(batch.inputFiles.size());
+    /* the remaining files are still converted after a failure */
+    pool.run(batch, batch.inputFiles.size(), OFFalse /* stopOnError */);
+
+    size_t failedFiles = ignoredFiles;
+    for (size_t i = 0; i < batch.results.size(); ++i)
     {
-        OFLOG_FATAL(dcmconvLogger, error.text() << ": writing file: " <<  opt_ofname);
+        if (batch.results[i].bad())
+            ++failedFiles;
+    }
+    if (failedFiles > 0)
+    {
+        OFLOG_ERROR(dcmconvLogger, failedFiles << " of " << inputFiles.size() << " file(s) could not be converted");
         return 1;
     }
-
-    OFLOG_INFO(dcmconvLogger, "conversion successful");
-
+    OFLOG_INFO(dcmconvLogger, "successfully converted " << batch.inputFiles.size() << " file(s)");
     return 0;
 }
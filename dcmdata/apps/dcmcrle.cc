@@ -78,6 +78,7 @@ int main(int argc, char *argv[])
   OFBool           opt_createOffsetTable = OFTrue;
   OFBool           opt_uidcreation = OFFalse;
   OFBool           opt_secondarycapture = OFFalse;
+  OFCmdUnsignedInt opt_threads = 1;
 
   OFConsoleApplication app(OFFIS_CONSOLE_APPLICATION, "Encode DICOM file to RLE transfer syntax", rcsid);
   OFCommandLine cmd;
@@ -120,6 +121,11 @@ int main(int argc, char *argv[])
     cmd.addSubGroup("SOP Instance UID:");
       cmd.addOption("--uid-never",           "+un",    "never assign new UID (default)");
       cmd.addOption("--uid-always",          "+ua",    "always assign new UID");
+#ifdef WITH_THREADS
+    cmd.addSubGroup("multi-threading:");
+      cmd.addOption("--threads",             "+th", 1, "[n]umber: integer (default: 1)",
+                                                       "compress up to n frames in parallel");
+#endif
 
   cmd.addGroup("output options:");
     cmd.addSubGroup("post-1993 value representations:");
@@ -218,6 +224,11 @@ int main(int argc, char *argv[])
       if (cmd.findOption("--uid-never")) opt_uidcreation = OFFalse;
       cmd.endOptionBlock();
 
+#ifdef WITH_THREADS
+      if (cmd.findOption("--threads"))
+        app.checkValue(cmd.getValueAndCheckMinMax(opt_threads, 1, 256));
+#endif
+
       cmd.beginOptionBlock();
       if (cmd.findOption("--enable-new-vr"))
       {
@@ -259,7 +270,8 @@ int main(int argc, char *argv[])
 
     // register RLE compression codec
     DcmRLEEncoderRegistration::registerCodecs(opt_uidcreation,
-      opt_fragmentSize, opt_createOffsetTable, opt_secondarycapture);
+      opt_fragmentSize, opt_createOffsetTable, opt_secondarycapture,
+      OFstatic_cast(Uint32, opt_threads));
 
     /* make sure data dictionary is loaded */
     if (!dcmDataDict.isDictionaryLoaded())
@@ -28,6 +28,13 @@
 #include "dcmtk/ofstd/ofstd.h"
 #include "dcmtk/dcmdata/dcuid.h"      /* for dcmtk version name */
 #include "dcmtk/dcmdata/dcistrmz.h"   /* for dcmZlibExpectRFC1950Encoding */
+#include "dcmtk/dcmdata/dcpixseq.h"   /* for class DcmPixelSequence */
+#include "dcmtk/dcmdata/dcpxitem.h"   /* for class DcmPixelItem */
+#include "dcmtk/ofstd/ofmap.h"        /* for class OFMap */
+#include "dcmtk/ofstd/ofvector.h"     /* for class OFVector */
+#ifdef WITH_THREADS
+#include "dcmtk/ofstd/ofthpool.h"     /* for class OFThreadPool */
+#endif
 
 #define INCLUDE_CSTDLIB
 #define INCLUDE_CSTRING
@@ -61,6 +68,53 @@ static char rcsid[] = "$dcmtk: " OFFIS_CONSOLE_APPLICATION " v"
 #include <SIOUX.h>
 #endif
 
+/* number of files that are dumped per thread before the output is printed */
+#define FILES_PER_THREAD 16
+
+/* cache for the names of the tags, avoids repeated dictionary lookups */
+class DcmTagNameCache
+{
+  public:
+
+    DcmTagNameCache()
+      : Names()
+    {
+    }
+
+    /// append the name of the given element's tag to the output
+    void appendTagName(OFString &out, DcmObject *obj)
+    {
+        const DcmTag &tag = obj->getTag();
+        /* the name of a private tag depends on the private creator */
+        if (tag.isPrivate())
+            out += lookupTagName(tag, tag.getPrivateCreator());
+        else
+        {
+            OFString &name = Names[tag];
+            if (name.empty())
+                name = lookupTagName(tag, NULL);
+            out += name;
+        }
+    }
+
+  private:
+
+    /// look up the name of the given tag in the data dictionary
+    static OFString lookupTagName(const DcmTagKey &tag, const char *privateCreator)
+    {
+        OFString name = DcmTag_ERROR_TagName;
+        const DcmDataDictionary &globalDataDict = dcmDataDict.rdlock();
+        const DcmDictEntry *dictRef = globalDataDict.findEntry(tag, privateCreator);
+        if ((dictRef != NULL) && (dictRef->getTagName() != NULL))
+            name = dictRef->getTagName();
+        dcmDataDict.unlock();
+        return name;
+    }
+
+    /// names of the public tags looked up so far
+    OFMap<DcmTagKey, OFString> Names;
+};
+
 static int dumpFile(STD_NAMESPACE ostream &out,
                     const char *ifname,
                     const E_FileReadMode readMode,
@@ -69,7 +123,93 @@ static int dumpFile(STD_NAMESPACE ostream &out,
                     const OFBool loadIntoMemory,
                     const OFBool stopOnErrors,
                     const OFBool convertToUTF8,
-                    const char *pixelDirectory);
+                    const char *pixelDirectory,
+                    DcmTagNameCache &tagNames,
+                    OFBool *tagFound = NULL);
+
+static void printFileHeader(STD_NAMESPACE ostream &out,
+                            const char *ifname,
+                            const size_t count);
+
+static void printSearchHeader(STD_NAMESPACE ostream &out,
+                              const char *ifname);
+
+#ifdef WITH_THREADS
+
+/* a file to be dumped by one of the threads, the output is buffered */
+struct DumpFileJob
+{
+    DumpFileJob()
+      : Filename()
+      , Output()
+      , Result(0)
+      , TagFound(OFFalse)
+    {
+    }
+
+    /// name of the file to be dumped
+    OFString Filename;
+    /// output of the dump
+    OFString Output;
+    /// result of dumpFile(), i.e. number of errors
+    int Result;
+    /// true if any of the tags searched for has been found
+    OFBool TagFound;
+};
+
+/* list of files that are dumped by a pool of threads */
+class DumpFileQueue : public OFParallelJobs
+{
+  public:
+
+    DumpFileQueue(OFVector<DumpFileJob> &jobs,
+                  const size_t numberOfThreads,
+                  const E_FileReadMode readMode,
+                  const E_TransferSyntax xfer,
+                  const size_t printFlags,
+                  const OFBool loadIntoMemory,
+                  const OFBool stopOnErrors,
+                  const OFBool convertToUTF8,
+                  const char *pixelDirectory)
+      : Jobs(jobs)
+      , TagNames(numberOfThreads)
+      , ReadMode(readMode)
+      , Xfer(xfer)
+      , PrintFlags(printFlags)
+      , LoadIntoMemory(loadIntoMemory)
+      , StopOnErrors(stopOnErrors)
+      , ConvertToUTF8(convertToUTF8)
+      , PixelDirectory(pixelDirectory)
+    {
+    }
+
+    /// dump the file with the given index, each thread uses its own tag name cache
+    virtual OFCondition processJob(const size_t jobNo,
+                                   const size_t threadNo)
+    {
+        DumpFileJob &job = Jobs[jobNo];
+        OFOStringStream stream;
+        job.Result = dumpFile(stream, job.Filename.c_str(), ReadMode, Xfer, PrintFlags, LoadIntoMemory,
+            StopOnErrors, ConvertToUTF8, PixelDirectory, TagNames[threadNo], &job.TagFound);
+        OFSTRINGSTREAM_GETOFSTRING(stream, output)
+        job.Output = output;
+        return EC_Normal;
+    }
+
+  private:
+
+    OFVector<DumpFileJob> &Jobs;
+    OFVector<DcmTagNameCache> TagNames;
+    const E_FileReadMode ReadMode;
+    const E_TransferSyntax Xfer;
+    const size_t PrintFlags;
+    const OFBool LoadIntoMemory;
+    const OFBool StopOnErrors;
+    const OFBool ConvertToUTF8;
+    const char *PixelDirectory;
+};
+
+#endif
 
 // ********************************************
 
@@ -77,6 +217,7 @@ static OFBool printFilename = OFFalse;
 static OFBool printFileSearch = OFFalse;
 static OFBool printAllInstances = OFTrue;
 static OFBool prependSequenceHierarchy = OFFalse;
+static OFBool printLines = OFFalse;
 static int printTagCount = 0;
 static const int MAX_PRINT_TAG_NAMES = 1024;
 static const char *printTagNames[MAX_PRINT_TAG_NAMES];
@@ -159,6 +300,9 @@ int main(int argc, char *argv[])
     const char *scanPattern = "";
     const char *pixelDirectory = NULL;
     OFBool convertToUTF8 = OFFalse;
+#ifdef WITH_THREADS
+    OFCmdUnsignedInt numberOfThreads = 1;
+#endif
 
 #ifdef HAVE_GUSI_H
     /* needed for Macintosh */
@@ -247,11 +391,18 @@ int main(int argc, char *argv[])
         cmd.addOption("--bitstream-zlib",      "+bz",    "expect deflated zlib bitstream");
 #endif
 
-#ifdef WITH_LIBICONV
+#if defined(WITH_LIBICONV) || defined(WITH_THREADS)
     cmd.addGroup("processing options:");
+#endif
+#ifdef WITH_LIBICONV
       cmd.addSubGroup("specific character set:");
         cmd.addOption("--convert-to-utf8",     "+U8",    "convert all element values that are affected\nby Specific Character Set (0008,0005) to UTF-8");
 #endif
+#ifdef WITH_THREADS
+      cmd.addSubGroup("multi-threading:");
+        cmd.addOption("--threads",             "+th", 1, "[n]umber: integer (default: 1)",
+                                                         "dump n files in parallel, the output is still\nprinted in the order of the input files");
+#endif
 
     cmd.addGroup("output options:");
       cmd.addSubGroup("printing:");
@@ -259,6 +410,7 @@ int main(int argc, char *argv[])
         cmd.addOption("--print-short",         "-L",     "print long tag values shortened (default)");
         cmd.addOption("--print-tree",          "+T",     "print hierarchical structure as a simple tree");
         cmd.addOption("--print-indented",      "-T",     "print hierarchical structure indented (default)");
+        cmd.addOption("--print-lines",         "+Pl",    "print one line per element with tag path, VR,\nVM, length, name and value (tab-separated)");
         cmd.addOption("--print-filename",      "+F",     "print header with filename for each input file");
         cmd.addOption("--print-file-search",   "+Fs",    "print header with filename only for those input\nfiles that contain one of the searched tags");
       cmd.addSubGroup("mapping:");
@@ -501,6 +653,10 @@ int main(int argc, char *argv[])
 #ifdef WITH_LIBICONV
       if (cmd.findOption("--convert-to-utf8")) convertToUTF8 = OFTrue;
 #endif
+#ifdef WITH_THREADS
+      if (cmd.findOption("--threads"))
+        app.checkValue(cmd.getValueAndCheckMinMax(numberOfThreads, 1, 256));
+#endif
 
       /* output options */
       cmd.beginOptionBlock();
@@ -509,8 +665,21 @@ int main(int argc, char *argv[])
       cmd.endOptionBlock();
 
       cmd.beginOptionBlock();
-      if (cmd.findOption("--print-tree")) printFlags |= DCMTypes::PF_showTreeStructure;
-      if (cmd.findOption("--print-indented")) printFlags &= ~DCMTypes::PF_showTreeStructure;
+      if (cmd.findOption("--print-tree"))
+      {
+        printFlags |= DCMTypes::PF_showTreeStructure;
+        printLines = OFFalse;
+      }
+      if (cmd.findOption("--print-indented"))
+      {
+        printFlags &= ~DCMTypes::PF_showTreeStructure;
+        printLines = OFFalse;
+      }
+      if (cmd.findOption("--print-lines"))
+      {
+        printFlags &= ~DCMTypes::PF_showTreeStructure;
+        printLines = OFTrue;
+      }
       cmd.endOptionBlock();
 
       cmd.beginOptionBlock();
@@ -604,7 +773,10 @@ int main(int argc, char *argv[])
       app.checkConflict("--prepend", "--print-tree", prependSequenceHierarchy && (printFlags & DCMTypes::PF_showTreeStructure) > 0);
 
       if (cmd.findOption("--write-pixel"))
+      {
+        app.checkConflict("--write-pixel", "--print-lines", printLines);
         app.checkValue(cmd.getValue(pixelDirectory));
+      }
     }
 
     /* print resource identifier */
@@ -663,22 +835,316 @@ int main(int argc, char *argv[])
     const char *current = NULL;
     OFListIterator(OFString) if_iter = inputFiles.begin();
     OFListIterator(OFString) if_last = inputFiles.end();
+    DcmTagNameCache tagNames;
+#ifdef WITH_THREADS
+    if (numberOfThreads > 1)
+    {
+      /* dump the files in batches, the output of each file is buffered */
+      const size_t batchSize = OFstatic_cast(size_t, numberOfThreads) * FILES_PER_THREAD;
+      OFVector<DumpFileJob> jobs;
+      jobs.reserve(batchSize);
+      /* the same threads are used for all batches (the calling thread is also working) */
+      OFThreadPool pool((count < numberOfThreads) ? count : OFstatic_cast(size_t, numberOfThreads));
+      DumpFileQueue queue(jobs, pool.getNumberOfThreads(), readMode, xfer, printFlags, loadIntoMemory, stopOnErrors, convertToUTF8, pixelDirectory);
+      while (if_iter != if_last)
+      {
+        /* collect next batch of files */
+        while ((if_iter != if_last) && (jobs.size() < batchSize))
+        {
+          DumpFileJob job;
+          job.Filename = *if_iter++;
+          jobs.push_back(job);
+        }
+        /* dump the files */
+        pool.run(queue, jobs.size(), OFFalse /* stopOnError */);
+        /* print the output in the original order */
+        for (size_t k = 0; k < jobs.size(); ++k)
+        {
+          const DumpFileJob &job = jobs[k];
+          if (printFilename)
+            printFileHeader(COUT, job.Filename.c_str(), count);
+          else if (job.TagFound)
+            printSearchHeader(COUT, job.Filename.c_str());
+          COUT.write(job.Output.c_str(), job.Output.length());
+          errorCount += job.Result;
+        }
+        jobs.clear();
+      }
+    } else
+#endif
     /* iterate over all input filenames */
     while (if_iter != if_last)
     {
       current = (*if_iter++).c_str();
       if (printFilename)
-      {
+        printFileHeader(COUT, current, count);
+      errorCount += dumpFile(COUT, current, readMode, xfer, printFlags, loadIntoMemory, stopOnErrors, convertToUTF8, pixelDirectory, tagNames);
+    }
+
+    return errorCount;
+}
+
+static void printFileHeader(STD_NAMESPACE ostream &out,
+                            const char *ifname,
+                            const size_t count)
+{
+    /* a newline separates two consecutive "dumps" */
+    if (++fileCounter > 1)
+        out << OFendl;
+    /* print header with filename */
+    out << "# " << OFFIS_CONSOLE_APPLICATION << " (" << fileCounter << "/" << count << "): " << ifname << OFendl;
+}
+
+static void printSearchHeader(STD_NAMESPACE ostream &out,
+                              const char *ifname)
+{
+    if (!printFilename)
+    {
         /* a newline separates two consecutive "dumps" */
         if (++fileCounter > 1)
-          COUT << OFendl;
-        /* print header with filename */
-        COUT << "# " << OFFIS_CONSOLE_APPLICATION << " (" << fileCounter << "/" << count << "): " << current << OFendl;
-      }
-      errorCount += dumpFile(COUT, current, readMode, xfer, printFlags, loadIntoMemory, stopOnErrors, convertToUTF8, pixelDirectory);
+            out << OFendl;
     }
+    /* print header with filename */
+    if (printFileSearch)
+        out << "# " << OFFIS_CONSOLE_APPLICATION << " (" << fileCounter << "): " << ifname << OFendl;
+}
 
-    return errorCount;
+/* make sure that the output can grow by the given length (OFString does not reserve in advance) */
+static void reserveSpace(OFString &out,
+                         const size_t length)
+{
+    const size_t required = out.length() + length;
+    if (out.capacity() < required)
+        out.reserve(2 * required);
+}
+
+/* append a value to the output, control characters are quoted as octal numbers */
+static void appendValue(OFString &out,
+                        const char *value,
+                        const size_t length)
+{
+    reserveSpace(out, length);
+    size_t start = 0;
+    for (size_t i = 0; i < length; ++i)
+    {
+        const unsigned char c = OFstatic_cast(unsigned char, value[i]);
+        if ((c < 32) || (c == 127))
+        {
+            char buf[8];
+            out.append(value + start, i - start);
+            sprintf(buf, "\\%03o", OFstatic_cast(unsigned int, c));
+            out += buf;
+            start = i + 1;
+        }
+    }
+    out.append(value + start, length - start);
+}
+
+/* append OB or OW values to the output as hex numbers, returns false for other VRs */
+static OFBool appendBinaryValue(OFString &out,
+                                DcmElement *elem,
+                                const OFBool shorten)
+{
+    static const char hexDigits[] = "0123456789abcdef";
+    const DcmEVR evr = elem->getTag().getEVR();
+    const OFBool isWord = (evr == EVR_OW);
+    if (!isWord && (evr != EVR_OB) && (evr != EVR_UN) && (elem->ident() != EVR_pixelItem))
+        return OFFalse;
+    Uint8 *bytes = NULL;
+    Uint16 *words = NULL;
+    const size_t digits = isWord ? 4 : 2;
+    size_t count = elem->getLength() / (isWord ? 2 : 1);
+    if ((isWord ? elem->getUint16Array(words) : elem->getUint8Array(bytes)).bad())
+        return OFFalse;
+    /* only convert the values that are actually printed */
+    const OFBool truncate = shorten && (count * (digits + 1) > DCM_OptPrintLineLength + 1);
+    if (truncate)
+        count = DCM_OptPrintLineLength / (digits + 1) + 1;
+    const size_t start = out.length();
+    reserveSpace(out, count * (digits + 1));
+    /* the values are converted in chunks that are appended at once */
+    char buf[1024];
+    size_t length = 0;
+    for (size_t i = 0; i < count; ++i)
+    {
+        if (length + digits + 1 > sizeof(buf))
+        {
+            out.append(buf, length);
+            length = 0;
+        }
+        if (i > 0)
+            buf[length++] = '\\';
+        const Uint16 value = isWord ? words[i] : bytes[i];
+        for (size_t j = 0; j < digits; ++j)
+            buf[length++] = hexDigits[(value >> (4 * (digits - 1 - j))) & 0x0f];
+    }
+    out.append(buf, length);
+    if (truncate)
+    {
+        out.erase(start + DCM_OptPrintLineLength - 3);
+        out += "...";
+    }
+    return OFTrue;
+}
+
+/* append the value of a leaf element to the output (shortened if required) */
+static void appendElementValue(OFString &out,
+                               DcmElement *elem,
+                               const size_t printFlags)
+{
+    const OFBool shorten = (printFlags & DCMTypes::PF_shortenLongTagValues) > 0;
+    if (!elem->valueLoaded())
+        out += "(not loaded)";
+    else if (elem->isaString())
+    {
+        char *value = NULL;
+        Uint32 length = 0;
+        if (elem->getString(value, length).good() && (value != NULL))
+        {
+            if (shorten && (length > DCM_OptPrintLineLength))
+            {
+                appendValue(out, value, DCM_OptPrintLineLength - 3);
+                out += "...";
+            } else
+                appendValue(out, value, length);
+        }
+    } else if (!appendBinaryValue(out, elem, shorten)) {
+        /* numeric values are converted one by one */
+        const size_t start = out.length();
+        OFString component;
+        unsigned long pos = 0;
+        while (elem->getOFString(component, pos).good())
+        {
+            reserveSpace(out, component.length() + 1);
+            if (pos++ > 0)
+                out += '\\';
+            out += component;
+            if (shorten && (out.length() - start > DCM_OptPrintLineLength))
+            {
+                out.erase(start + DCM_OptPrintLineLength - 3);
+                out += "...";
+                break;
+            }
+        }
+    }
+}
+
+/* append one line for the given object to the output */
+static void printLine(OFString &out,
+                      const OFString &path,
+                      DcmObject *obj,
+                      const size_t printFlags,
+                      DcmTagNameCache &tagNames,
+                      const OFBool printValue)
+{
+    char buf[64];
+    reserveSpace(out, path.length() + sizeof(buf));
+    out += path;
+    out += '\t';
+    out += obj->getTag().getVRName();
+    const Uint32 length = obj->getLengthField();
+    if (length == DCM_UndefinedLength)
+        sprintf(buf, "\t%lu\tu/l\t", obj->getVM());
+    else
+        sprintf(buf, "\t%lu\t%lu\t", obj->getVM(), OFstatic_cast(unsigned long, length));
+    out += buf;
+    tagNames.appendTagName(out, obj);
+    out += '\t';
+    if (printValue)
+        appendElementValue(out, OFstatic_cast(DcmElement *, obj), printFlags);
+    out += '\n';
+}
+
+/* append one line per element of the given object (and its items) to the output */
+static void printObjectLines(OFString &out,
+                             const OFString &prefix,
+                             DcmObject *obj,
+                             const size_t printFlags,
+                             DcmTagNameCache &tagNames)
+{
+    char buf[32];
+    const DcmEVR evr = obj->ident();
+    sprintf(buf, "(%04x,%04x)", obj->getGTag(), obj->getETag());
+    const OFString path = prefix + buf;
+    if (evr == EVR_SQ)
+    {
+        printLine(out, path, obj, printFlags, tagNames, OFFalse /*printValue*/);
+        DcmSequenceOfItems *seq = OFstatic_cast(DcmSequenceOfItems *, obj);
+        const unsigned long card = seq->card();
+        for (unsigned long i = 0; i < card; ++i)
+        {
+            sprintf(buf, "[%lu].", i);
+            DcmItem *item = seq->getItem(i);
+            DcmObject *elem = NULL;
+            while ((elem = item->nextInContainer(elem)) != NULL)
+                printObjectLines(out, path + buf, elem, printFlags, tagNames);
+        }
+    }
+    else if (evr == EVR_PixelData)
+    {
+        DcmPixelData *pixelData = OFstatic_cast(DcmPixelData *, obj);
+        E_TransferSyntax repType = EXS_Unknown;
+        const DcmRepresentationParameter *repParam = NULL;
+        DcmPixelSequence *pixelSeq = NULL;
+        pixelData->getCurrentRepresentationKey(repType, repParam);
+        /* encapsulated pixel data: one line per fragment */
+        if (DcmXfer(repType).isEncapsulated() &&
+            pixelData->getEncapsulatedRepresentation(repType, repParam, pixelSeq).good() && (pixelSeq != NULL))
+        {
+            printLine(out, path, obj, printFlags, tagNames, OFFalse /*printValue*/);
+            const unsigned long card = pixelSeq->card();
+            for (unsigned long i = 0; i < card; ++i)
+            {
+                DcmPixelItem *fragment = NULL;
+                if (pixelSeq->getItem(fragment, i).good())
+                {
+                    sprintf(buf, "[%lu]", i);
+                    printLine(out, path + buf, fragment, printFlags, tagNames, OFTrue /*printValue*/);
+                }
+            }
+        } else
+            printLine(out, path, obj, printFlags, tagNames, OFTrue /*printValue*/);
+    } else
+        printLine(out, path, obj, printFlags, tagNames, obj->isLeaf() /*printValue*/);
+}
+
+/* append one line per element of the given item (dataset or meta header) to the output */
+static void printItemLines(OFString &out,
+                           DcmItem *item,
+                           const size_t printFlags,
+                           DcmTagNameCache &tagNames)
+{
+    DcmObject *obj = NULL;
+    while ((obj = item->nextInContainer(obj)) != NULL)
+        printObjectLines(out, "", obj, printFlags, tagNames);
+}
+
+/* append the lines for an element found by a search, the path is taken from the stack */
+static void printResultLines(OFString &out,
+                             DcmStack &stack,
+                             const size_t printFlags,
+                             DcmTagNameCache &tagNames)
+{
+    OFString prefix;
+    char buf[48];
+    const unsigned long n = stack.card();
+    for (unsigned long i = n - 1; i >= 1; i--)
+    {
+        DcmObject *dobj = stack.elem(i);
+        if ((dobj != NULL) && (dobj->ident() == EVR_SQ))
+        {
+            /* determine the number of the item that contains the element */
+            DcmSequenceOfItems *seq = OFstatic_cast(DcmSequenceOfItems *, dobj);
+            const DcmObject *item = stack.elem(i - 1);
+            unsigned long pos = 0;
+            const unsigned long card = seq->card();
+            while ((pos < card) && (seq->getItem(pos) != item))
+                ++pos;
+            sprintf(buf, "(%04x,%04x)[%lu].", dobj->getGTag(), dobj->getETag(), pos);
+            prefix += buf;
+        }
+    }
+    printObjectLines(out, prefix, stack.top(), printFlags, tagNames);
 }
 
 static void printResult(STD_NAMESPACE ostream &out,
@@ -720,7 +1186,9 @@ static int dumpFile(STD_NAMESPACE ostream &out,
                     const OFBool loadIntoMemory,
                     const OFBool stopOnErrors,
                     const OFBool convertToUTF8,
-                    const char *pixelDirectory)
+                    const char *pixelDirectory,
+                    DcmTagNameCache &tagNames,
+                    OFBool *tagFound)
 {
     int result = 0;
 
@@ -770,10 +1238,19 @@ static int dumpFile(STD_NAMESPACE ostream &out,
         pixelFileName = pixelFilenameStr.c_str();
     }
 
+    /* the line format is created in memory and written at once */
+    OFString lines;
     /* dump complete file content */
     if (printTagCount == 0)
     {
-        dset->print(out, printFlags, 0 /*level*/, pixelFileName, &pixelCounter);
+        if (!printLines)
+            dset->print(out, printFlags, 0 /*level*/, pixelFileName, &pixelCounter);
+        else if (readMode == ERM_dataset)
+            printItemLines(lines, dfile.getDataset(), printFlags, tagNames);
+        else {
+            printItemLines(lines, dfile.getMetaInfo(), printFlags, tagNames);
+            printItemLines(lines, dfile.getDataset(), printFlags, tagNames);
+        }
     } else {
         OFBool firstTag = OFTrue;
         /* only print specified tags */
@@ -798,25 +1275,30 @@ static int dumpFile(STD_NAMESPACE ostream &out,
             {
                 if (firstTag)
                 {
-                    if (!printFilename)
-                    {
-                        /* a newline separates two consecutive "dumps" */
-                        if (++fileCounter > 1)
-                            COUT << OFendl;
-                    }
-                    /* print header with filename */
-                    if (printFileSearch)
-                        COUT << "# " << OFFIS_CONSOLE_APPLICATION << " (" << fileCounter << "): " << ifname << OFendl;
+                    /* in parallel mode, the header is printed by the caller */
+                    if (tagFound != NULL)
+                        *tagFound = OFTrue;
+                    else
+                        printSearchHeader(out, ifname);
                     firstTag = OFFalse;
                 }
-                printResult(out, stack, printFlags, pixelFileName, &pixelCounter);
+                if (printLines)
+                    printResultLines(lines, stack, printFlags, tagNames);
+                else
+                    printResult(out, stack, printFlags, pixelFileName, &pixelCounter);
                 if (printAllInstances)
                 {
                     while (dset->search(searchKey, stack, ESM_afterStackTop, OFTrue) == EC_Normal)
-                      printResult(out, stack, printFlags, pixelFileName, &pixelCounter);
+                    {
+                        if (printLines)
+                            printResultLines(lines, stack, printFlags, tagNames);
+                        else
+                            printResult(out, stack, printFlags, pixelFileName, &pixelCounter);
+                    }
                 }
             }
         }
     }
+    out.write(lines.c_str(), lines.length());
     return result;
 }
@@ -60,6 +60,7 @@
 #include "dcmtk/ofstd/ofstd.h"         /* for class OFStandard */
 #include "dcmtk/ofstd/ofconapp.h"      /* for class OFConsoleApplication */
 #include "dcmtk/ofstd/ofcond.h"        /* for class OFCondition */
+#include "dcmtk/ofstd/oftimer.h"       /* for class OFTimer */
 
 #ifdef BUILD_DCMGPDIR_AS_DCMMKDIR
 #include "dcmtk/dcmimage/diregist.h"   /* include to support color images */
@@ -181,6 +182,11 @@ int main(int argc, char *argv[])
                                                            "use PGM image 'prefix'+'dcmfile-in' as icon\n(default: create icon from DICOM image)");
         cmd.addOption("--default-icon",          "-Xd", 1, "[f]ilename: string",
                                                            "use specified PGM image if icon cannot be\ncreated automatically (default: black image)");
+#endif
+#ifdef WITH_THREADS
+      cmd.addSubGroup("multi-threading:");
+        cmd.addOption("--threads",               "+th", 1, "[n]umber: integer (default: 1)",
+                                                           "load and check files with n threads in parallel");
 #endif
     cmd.addGroup("output options:");
       cmd.addSubGroup("DICOMDIR file:");
@@ -218,6 +224,7 @@ int main(int argc, char *argv[])
       cmd.addSubGroup("writing:");
         cmd.addOption("--replace",               "-A",     "replace existing DICOMDIR (default)");
         cmd.addOption("--append",                "+A",     "append to existing DICOMDIR");
+        cmd.addOption("--append-in-place",       "+Ai",    "append to existing DICOMDIR without rewriting\nthe existing records (implies +A)");
         cmd.addOption("--update",                "+U",     "update existing DICOMDIR");
         cmd.addOption("--discard",               "-w",     "do not write out DICOMDIR");
         cmd.addOption("--no-backup",             "-nb",    "do not create a backup of existing DICOMDIR");
@@ -353,6 +360,15 @@ int main(int argc, char *argv[])
         }
 #endif
 
+#ifdef WITH_THREADS
+        if (cmd.findOption("--threads"))
+        {
+            OFCmdUnsignedInt numberOfThreads = 1;
+            app.checkValue(cmd.getValueAndCheckMinMax(numberOfThreads, 1, 256));
+            ddir.setNumberOfThreads(OFstatic_cast(unsigned int, numberOfThreads));
+        }
+#endif
+
         /* output options */
         if (cmd.findOption("--output-file"))
             app.checkValue(cmd.getValue(opt_output));
@@ -427,6 +443,13 @@ int main(int argc, char *argv[])
             opt_append = OFTrue;
             opt_update = OFFalse;
         }
+        if (cmd.findOption("--append-in-place"))
+        {
+            opt_write = OFTrue;
+            opt_append = OFTrue;
+            opt_update = OFFalse;
+            ddir.enableInPlaceAppendMode();
+        }
         if (cmd.findOption("--update"))
         {
             opt_write = OFTrue;
@@ -563,26 +586,12 @@ int main(int argc, char *argv[])
         {
             /* collect 'bad' files */
             OFList<OFString> badFiles;
-            unsigned int goodFiles = 0;
-            OFListIterator(OFString) iter = fileNames.begin();
-            OFListIterator(OFString) last = fileNames.end();
-            /* iterate over all input filenames */
-            while ((iter != last) && result.good())
-            {
-                /* add files to the DICOMDIR */
-                result = ddir.addDicomFile((*iter).c_str(), opt_directory);
-                if (result.bad())
-                {
-                    badFiles.push_back(*iter);
-                    if (!ddir.abortMode())
-                    {
-                        /* ignore inconsistent file, just warn (already done inside "ddir") */
-                        result = EC_Normal;
-                    }
-                } else
-                    ++goodFiles;
-                ++iter;
-            }
+            unsigned long goodFiles = 0;
+            OFTimer timer;
+            /* add all input files to the DICOMDIR (inconsistent files are reported inside "ddir") */
+            result = ddir.addDicomFiles(fileNames, opt_directory, badFiles, goodFiles);
+            OFLOG_INFO(dcmgpdirLogger, "processed " << (goodFiles + badFiles.size()) << " file(s) in "
+                << timer.getDiff() << " s using " << ddir.getNumberOfThreads() << " thread(s)");
             /* evaluate result of file checking/adding procedure */
             if (goodFiles == 0)
             {
@@ -593,8 +602,8 @@ int main(int argc, char *argv[])
             {
                 OFOStringStream oss;
                 oss << badFiles.size() << " file(s) cannot be added to DICOMDIR: ";
-                iter = badFiles.begin();
-                last = badFiles.end();
+                OFListIterator(OFString) iter = badFiles.begin();
+                OFListIterator(OFString) last = badFiles.end();
                 while (iter != last)
                 {
                     oss << OFendl << "  " << (*iter);
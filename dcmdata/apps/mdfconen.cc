@@ -26,6 +26,9 @@
 #include "dcmtk/ofstd/ofstd.h"
 #include "dcmtk/dcmdata/dctk.h"
 #include "dcmtk/dcmdata/dcistrmz.h"    /* for dcmZlibExpectRFC1950Encoding */
+#include "dcmtk/ofstd/ofvector.h"
+
+#include "dcmtk/ofstd/ofthpool.h"
 
 #define SHORTCOL 4
 #define LONGCOL 21
@@ -57,9 +60,61 @@ MdfJob &MdfJob::operator=(const MdfJob &j)
 }
 
 
+/** list of files to be modified by a pool of threads in parallel mode
+ */
+class MdfFileQueue : public OFParallelJobs
+{
+public:
+
+    MdfFileQueue(const MdfConsoleEngine &engine,
+                 const OFList<OFString> &fileList)
+      : files(), errors(), engine_(engine)
+    {
+        OFListConstIterator(OFString) it = fileList.begin();
+        while (it != fileList.end())
+            files.push_back(*it++);
+        errors.resize(files.size(), 0);
+    }
+
+    /** modifies the file with the given index
+     *  @param jobNo index of the file to be modified
+     *  @param threadNo index of the calling thread (not used)
+     *  @return EC_Normal if the file was modified without errors, EC_IllegalCall otherwise
+     */
+    virtual OFCondition processJob(const size_t jobNo,
+                                   const size_t /* threadNo */)
+    {
+        errors[jobNo] = engine_.processFile(files[jobNo].c_str());
+        return (errors[jobNo] > 0) ? EC_IllegalCall : EC_Normal;
+    }
+
+    /** get the number of errors in all files processed
+     *  @return total number of errors
+     */
+    int getErrors() const
+    {
+        int result = 0;
+        for (size_t i = 0; i < errors.size(); i++)
+            result += errors[i];
+        return result;
+    }
+
+    /// files to be modified
+    OFVector<OFString> files;
+
+    /// number of errors for each file (0 if not processed)
+    OFVector<int> errors;
+
+private:
+
+    /// engine that modifies a single file
+    const MdfConsoleEngine &engine_;
+};
+
+
 MdfConsoleEngine::MdfConsoleEngine(int argc, char *argv[],
                                    const char *application_name)
-  : app(NULL), cmd(NULL), ds_man(NULL), ignore_errors_option(OFFalse),
+  : app(NULL), cmd(NULL), ignore_errors_option(OFFalse),
     update_metaheader_uids_option(OFTrue), no_backup_option(OFFalse),
     read_mode_option(ERM_autoDetect), input_xfer_option(EXS_Unknown),
     output_dataset_option(OFFalse), output_xfer_option(EXS_Unknown),
@@ -67,7 +122,7 @@ MdfConsoleEngine::MdfConsoleEngine(int argc, char *argv[],
     padenc_option(EPD_withoutPadding), filepad_option(0),
     itempad_option(0), ignore_missing_tags_option(OFFalse),
     no_reservation_checks(OFFalse), ignore_un_modifies(OFFalse),
-    create_if_necessary(OFFalse), was_created(OFFalse), jobs(NULL), files(NULL)
+    create_if_necessary(OFFalse), threads_option(1), jobs(NULL), files(NULL)
 {
     char rcsid[200];
     // print application header
@@ -143,6 +198,11 @@ MdfConsoleEngine::MdfConsoleEngine(int argc, char *argv[],
             cmd->addOption("--ignore-errors",       "-ie",     "continue with file, if modify error occurs");
             cmd->addOption("--ignore-missing-tags", "-imt",    "treat 'tag not found' as success\nwhen modifying or erasing in datasets");
             cmd->addOption("--ignore-un-values",    "-iun",    "do not try writing any values to elements\nhaving a VR of UN");
+#ifdef WITH_THREADS
+        cmd->addSubGroup("multi-threading:");
+            cmd->addOption("--threads",             "+th",  1, "[n]umber: integer (default: 1)",
+                                                               "modify n files in parallel");
+#endif
     cmd->addGroup("output options:");
         cmd->addSubGroup("output file format:");
             cmd->addOption("--write-file",          "+F",      "write file format (default)");
@@ -307,6 +367,11 @@ void MdfConsoleEngine::parseNonJobOptions()
     if (cmd->findOption("--ignore-un-values"))
         ignore_un_modifies = OFTrue;
 
+#ifdef WITH_THREADS
+    if (cmd->findOption("--threads"))
+        app->checkValue(cmd->getValueAndCheckMinMax(threads_option, 1, 256));
+#endif
+
     // output options
     cmd->beginOptionBlock();
     if (cmd->findOption("--write-file"))
@@ -451,8 +516,9 @@ void MdfConsoleEngine::splitPathAndValue(const OFString &whole,
 }
 
 
-int MdfConsoleEngine::executeJob(const MdfJob &job,
-                                 const char *filename)
+int MdfConsoleEngine::executeJob(MdfDatasetManager &ds_man,
+                                 const MdfJob &job,
+                                 const char *filename) const
 {
     OFCondition result;
     int count = 0;
@@ -461,27 +527,27 @@ int MdfConsoleEngine::executeJob(const MdfJob &job,
         << job.option << "|" << job.path << "|" << job.value);
     // start modify operation based on job option
     if (job.option=="i")
-        result = ds_man->modifyOrInsertPath(job.path, job.value, OFFalse, update_metaheader_uids_option, ignore_missing_tags_option, no_reservation_checks);
+        result = ds_man.modifyOrInsertPath(job.path, job.value, OFFalse, update_metaheader_uids_option, ignore_missing_tags_option, no_reservation_checks);
     else if (job.option == "if")
-        result = ds_man->modifyOrInsertFromFile(job.path, job.value /*filename*/, OFFalse, update_metaheader_uids_option, ignore_missing_tags_option, no_reservation_checks);
+        result = ds_man.modifyOrInsertFromFile(job.path, job.value /*filename*/, OFFalse, update_metaheader_uids_option, ignore_missing_tags_option, no_reservation_checks);
     else if (job.option == "m")
-        result = ds_man->modifyOrInsertPath(job.path, job.value, OFTrue, update_metaheader_uids_option, ignore_missing_tags_option, no_reservation_checks);
+        result = ds_man.modifyOrInsertPath(job.path, job.value, OFTrue, update_metaheader_uids_option, ignore_missing_tags_option, no_reservation_checks);
     else if (job.option == "mf")
-        result = ds_man->modifyOrInsertFromFile(job.path, job.value /*filename*/, OFTrue, update_metaheader_uids_option, ignore_missing_tags_option, no_reservation_checks);
+        result = ds_man.modifyOrInsertFromFile(job.path, job.value /*filename*/, OFTrue, update_metaheader_uids_option, ignore_missing_tags_option, no_reservation_checks);
     else if (job.option == "ma")
-        result = ds_man->modifyAllTags(job.path, job.value, update_metaheader_uids_option, count);
+        result = ds_man.modifyAllTags(job.path, job.value, update_metaheader_uids_option, count);
     else if (job.option == "e")
-        result = ds_man->deleteTag(job.path, OFFalse, ignore_missing_tags_option);
+        result = ds_man.deleteTag(job.path, OFFalse, ignore_missing_tags_option);
     else if (job.option == "ea")
-        result = ds_man->deleteTag(job.path, OFTrue, ignore_missing_tags_option);
+        result = ds_man.deleteTag(job.path, OFTrue, ignore_missing_tags_option);
     else if (job.option == "ep")
-        result = ds_man->deletePrivateData();
+        result = ds_man.deletePrivateData();
     else if (job.option == "gst")
-        result = ds_man->generateAndInsertUID(DCM_StudyInstanceUID);
+        result = ds_man.generateAndInsertUID(DCM_StudyInstanceUID);
     else if (job.option == "gse")
-        result = ds_man->generateAndInsertUID(DCM_SeriesInstanceUID);
+        result = ds_man.generateAndInsertUID(DCM_SeriesInstanceUID);
     else if (job.option == "gin")
-        result = ds_man->generateAndInsertUID(DCM_SOPInstanceUID);
+        result = ds_man.generateAndInsertUID(DCM_SOPInstanceUID);
     // no valid job option found:
     else
     {
@@ -503,104 +569,132 @@ int MdfConsoleEngine::executeJob(const MdfJob &job,
 
 int MdfConsoleEngine::startProvidingService()
 {
-    OFCondition result;
-    const char *filename;
-    // return value of this function
-    int errors = 0;
     // parse command line into file and job list
     parseCommandLine();
-    // iterators for job and file loops
-    OFListIterator(MdfJob) job_it;
-    OFListIterator(MdfJob) job_last = jobs->end();;
+#ifdef WITH_THREADS
+    // process files in parallel if requested
+    if ((threads_option > 1) && (files->size() > 1))
+    {
+        MdfFileQueue queue(*this, *files);
+        size_t num_threads = OFstatic_cast(size_t, threads_option);
+        if (num_threads > queue.files.size())
+            num_threads = queue.files.size();
+        // the calling thread also modifies files
+        OFThreadPool pool(num_threads);
+        if (pool.getNumberOfThreads() < num_threads)
+            OFLOG_WARN(dcmodifyLogger, "unable to start worker thread, using fewer threads");
+        OFLOG_INFO(dcmodifyLogger, "Modifying " << queue.files.size() << " files with " << pool.getNumberOfThreads() << " threads");
+        // stop after the first file with errors, unless they are ignored
+        pool.run(queue, queue.files.size(), !ignore_errors_option);
+        return queue.getErrors();
+    }
+#endif
+    // return value of this function
+    int errors = 0;
     OFListIterator(OFString) file_it = files->begin();
-    OFListIterator(OFString) file_last = files->end();;
-    // outer loop: iterate over all files
+    OFListIterator(OFString) file_last = files->end();
+    // iterate over all files
     while (file_it != file_last)
     {
-        filename = (*file_it).c_str();
-        result = loadFile(filename);
+        errors += processFile((*file_it).c_str());
+        file_it++;
+        // stop after the first file with errors, unless they are ignored
+        if ((errors > 0) && !ignore_errors_option)
+            break;
+        // output separator line if required
+        if ((file_it != file_last) || (errors > 0))
+          OFLOG_INFO(dcmodifyLogger, "------------------------------------");
+    }
+    return errors;
+}
 
-        // if file could be loaded:
-        if (result.good())
+
+int MdfConsoleEngine::processFile(const char *filename) const
+{
+    OFCondition result;
+    // number of errors for this file
+    int errors = 0;
+    // each file gets its own dataset manager
+    MdfDatasetManager ds_man;
+    ds_man.setModifyUNValues(!ignore_un_modifies);
+    OFBool was_created = OFFalse;
+    result = loadFile(ds_man, filename, was_created);
+
+    // if file could be loaded:
+    if (result.good())
+    {
+        // iterate over jobs, execute all jobs for current file
+        OFListIterator(MdfJob) job_it = jobs->begin();
+        OFListIterator(MdfJob) job_last = jobs->end();
+        while (job_it != job_last)
         {
-            // for each file, set job iterator back to first entry
-            job_it = jobs->begin();
-            // inner loop: iterate over jobs, execute all jobs for current file
-            while (job_it != job_last)
+            errors += executeJob(ds_man, *job_it, filename);
+            job_it++;
+        }
+        // if there were no errors or user wants to override them, save:
+        if (errors == 0 || ignore_errors_option)
+        {
+            E_TransferSyntax output_xfer = output_xfer_option;
+            if (was_created && (output_xfer == EXS_Unknown))
             {
-                errors += executeJob(*job_it, filename);
-                job_it++;
+              output_xfer = EXS_LittleEndianExplicit;
             }
-            // if there were no errors or user wants to override them, save:
-            if (errors == 0 || ignore_errors_option)
+            result = ds_man.saveFile(filename, output_xfer,
+                                     enctype_option, glenc_option,
+                                     padenc_option, filepad_option,
+                                     itempad_option, output_dataset_option);
+            if (result.bad())
             {
-                if (was_created && (output_xfer_option == EXS_Unknown))
-                {
-                  output_xfer_option = EXS_LittleEndianExplicit;
-                }
-                result = ds_man->saveFile(filename, output_xfer_option,
-                                          enctype_option, glenc_option,
-                                          padenc_option, filepad_option,
-                                          itempad_option, output_dataset_option);
-                if (result.bad())
+                OFLOG_ERROR(dcmodifyLogger, "couldn't save file " << filename << ": " << result.text());
+                errors++;
+                if (!no_backup_option && !was_created)
                 {
-                    OFLOG_ERROR(dcmodifyLogger, "couldn't save file: " << result.text());
-                    errors++;
-                    if (!no_backup_option && !was_created)
+                    result = restoreFile(filename);
+                    if (result.bad())
                     {
-                        result = restoreFile(filename);
-                        if (result.bad())
-                        {
-                            OFLOG_ERROR(dcmodifyLogger, "couldn't restore file: " << result.text());
-                            errors++;
-                        }
+                        OFLOG_ERROR(dcmodifyLogger, "couldn't restore file " << filename << ": " << result.text());
+                        errors++;
                     }
                 }
             }
-            // errors occured and user doesn't want to ignore them:
-            else if (!no_backup_option && !was_created)
-            {
-                result = restoreFile(filename);
-                if (result.bad())
-                {
-                    OFLOG_ERROR(dcmodifyLogger, "couldn't restore file!");
-                    errors++;
-                }
-            }
         }
-        // if loading fails:
-        else
+        // errors occured and user doesn't want to ignore them:
+        else if (!no_backup_option && !was_created)
         {
-            errors++;
-            OFLOG_ERROR(dcmodifyLogger, "unable to load file " << filename <<": " << result.text());
+            result = restoreFile(filename);
+            if (result.bad())
+            {
+                OFLOG_ERROR(dcmodifyLogger, "couldn't restore file " << filename << "!");
+                errors++;
+            }
         }
-        file_it++;
-        // output separator line if required
-        if ((file_it != file_last) || (errors > 0))
-          OFLOG_INFO(dcmodifyLogger, "------------------------------------");
+    }
+    // if loading fails:
+    else
+    {
+        errors++;
+        OFLOG_ERROR(dcmodifyLogger, "unable to load file " << filename <<": " << result.text());
     }
     return errors;
 }
 
 
-OFCondition MdfConsoleEngine::loadFile(const char *filename)
+OFCondition MdfConsoleEngine::loadFile(MdfDatasetManager &ds_man,
+                                       const char *filename,
+                                       OFBool &was_created) const
 {
     OFCondition result;
-    // free memory
-    delete ds_man;
-    ds_man = new MdfDatasetManager();
-    ds_man->setModifyUNValues(!ignore_un_modifies);
     OFLOG_INFO(dcmodifyLogger, "Processing file: " << filename);
     // load file into dataset manager
     was_created = !OFStandard::fileExists(filename);
-    result = ds_man->loadFile(filename, read_mode_option, input_xfer_option, create_if_necessary);
+    result = ds_man.loadFile(filename, read_mode_option, input_xfer_option, create_if_necessary);
     if (result.good() && !no_backup_option && !was_created)
         result = backupFile(filename);
     return result;
 }
 
 
-OFCondition MdfConsoleEngine::backupFile(const char *filename)
+OFCondition MdfConsoleEngine::backupFile(const char *filename) const
 {
     int result;
     OFString backup = filename;
@@ -629,7 +723,7 @@ OFCondition MdfConsoleEngine::backupFile(const char *filename)
 }
 
 
-OFCondition MdfConsoleEngine::restoreFile(const char *filename)
+OFCondition MdfConsoleEngine::restoreFile(const char *filename) const
 {
     int result;
     OFString backup = filename;
@@ -664,5 +758,4 @@ MdfConsoleEngine::~MdfConsoleEngine()
     delete cmd;
     delete files;
     delete jobs;
-    delete ds_man;
 }
@@ -86,6 +86,14 @@ public:
      */
     int startProvidingService();
 
+    /** Loads the given file, executes all jobs on it and saves the result.
+     *  This method does not modify the state of the engine and can be called
+     *  from several threads at the same time for different files.
+     *  @param filename name of the file to be processed
+     *  @return returns 0 if no error occured, else the number of errors
+     */
+    int processFile(const char *filename) const;
+
 protected:
 
     /** Checks for non-job commandline options like --debug etc. and
@@ -118,31 +126,37 @@ protected:
                                   OFString &value);
 
     /** Executes given modify job
+     *  @param ds_man dataset manager holding the file to be modified
      *  @param job job to be executed
      *  @param filename name of the file to be processed (optional)
      *  @return returns 0 if no error occured, else the number of errors
      */
-    int executeJob(const MdfJob &job,
-                   const char *filename = NULL);
+    int executeJob(MdfDatasetManager &ds_man,
+                   const MdfJob &job,
+                   const char *filename = NULL) const;
 
-    /** Backup and load file into internal MdfDatasetManager
+    /** Backup and load file into given MdfDatasetManager
+     *  @param ds_man dataset manager the file is loaded into
      *  @param filename name of file to load
+     *  @param was_created returns whether the file was newly created
      *  @return OFCondition, whether loading/backuping was successful including
      *          error description
      */
-    OFCondition loadFile(const char *filename);
+    OFCondition loadFile(MdfDatasetManager &ds_man,
+                         const char *filename,
+                         OFBool &was_created) const;
 
     /** Backup given file from file to file.bak
      *  @param file_name filename of file, that should be backuped
      *  @return OFCondition, whether backup was successful or not
      */
-    OFCondition backupFile(const char *file_name);
+    OFCondition backupFile(const char *file_name) const;
 
     /** Restore given file from file.bak to original (without .bak)
      *  @param filename restore "filename".bak to original without .bak
      *  @return OFCondition, whether restoring was successful
      */
-    OFCondition restoreFile(const char *filename);
+    OFCondition restoreFile(const char *filename) const;
 
 private:
 
@@ -152,9 +166,6 @@ private:
     /// helper class for commandline parsing
     OFCommandLine *cmd;
 
-    /// dataset manager that is used for modify operations
-    MdfDatasetManager *ds_man;
-
     /// ignore errors option
     OFBool ignore_errors_option;
 
@@ -204,8 +215,8 @@ private:
     /// If enabled, a new dataset is created in memory if a file is not existing.
     OFBool create_if_necessary;
 
-    /// Used to remember, whether a file was newly created.
-    OFBool was_created;
+    /// number of files that are processed in parallel
+    OFCmdUnsignedInt threads_option;
 
     /// list of jobs to be executed
     OFList<MdfJob> *jobs;
@@ -53,6 +53,7 @@ static char rcsid[] = "$dcmtk: " OFFIS_CONSOLE_APPLICATION " v"
 #ifdef WITH_LIBXML
 
 #include <libxml/parser.h>
+#include <libxml/xmlreader.h>
 
 // stores pointer to character encoding handler
 static xmlCharEncodingHandlerPtr EncodingHandler = NULL;
@@ -660,6 +661,325 @@ static OFCondition readXmlFile(const char *ifname,
 }
 
 
+// the following functions convert the XML document while it is read (streaming mode),
+// i.e. only the currently processed "element" node is kept in memory
+
+
+static int skipToElement(xmlTextReaderPtr reader,
+                         int status)
+{
+    /* skip all nodes until the next start or end tag */
+    while ((status == 1) && (xmlTextReaderNodeType(reader) != XML_READER_TYPE_ELEMENT) &&
+           (xmlTextReaderNodeType(reader) != XML_READER_TYPE_END_ELEMENT))
+    {
+        status = xmlTextReaderRead(reader);
+    }
+    return status;
+}
+
+
+static OFCondition checkReaderStatus(const int status)
+{
+    /* status is 1 if a node has been read, 0 at the end of the document and -1 on error */
+    if (status < 0)
+    {
+        OFLOG_ERROR(xml2dcmLogger, "could not parse document");
+        return EC_IllegalCall;
+    }
+    return EC_Normal;
+}
+
+
+static OFCondition parseElementStream(DcmItem *dataset,
+                                      xmlTextReaderPtr reader,
+                                      int &status)
+{
+    /* expand the current "element" node, it remains valid until the next read */
+    xmlNodePtr current = xmlTextReaderExpand(reader);
+    if (current == NULL)
+    {
+        status = -1;
+        return checkReaderStatus(status);
+    }
+    /* errors are ignored in the same way as for the document tree */
+    parseElement(dataset, current);
+    /* proceed with the next sibling (and free the processed node) */
+    status = xmlTextReaderNext(reader);
+    return checkReaderStatus(status);
+}
+
+
+// forward declaration
+static OFCondition parseDataSetStream(DcmItem *dataset,
+                                      xmlTextReaderPtr reader,
+                                      E_TransferSyntax xfer,
+                                      int &status);
+
+
+static OFCondition parseSequenceStream(DcmSequenceOfItems *sequence,
+                                       xmlTextReaderPtr reader,
+                                       E_TransferSyntax xfer,
+                                       int &status)
+{
+    OFCondition result = EC_Normal;
+    /* nothing to do for an empty sequence */
+    if (xmlTextReaderIsEmptyElement(reader) == 1)
+        return result;
+    status = skipToElement(reader, xmlTextReaderRead(reader));
+    while (result.good() && (status == 1) && (xmlTextReaderNodeType(reader) == XML_READER_TYPE_ELEMENT))
+    {
+        /* ignore non-item nodes */
+        if (xmlStrcmp(xmlTextReaderConstName(reader), OFreinterpret_cast(const xmlChar *, "item")) == 0)
+        {
+            /* create new sequence item */
+            DcmItem *newItem = new DcmItem();
+            sequence->insert(newItem);
+            /* proceed parsing the item content */
+            result = parseDataSetStream(newItem, reader, xfer, status);
+            if (result.good())
+                status = xmlTextReaderRead(reader);
+        } else {
+            OFLOG_WARN(xml2dcmLogger, "unexpected node '" << xmlTextReaderConstName(reader) << "', 'item' expected, skipping");
+            status = xmlTextReaderNext(reader);
+        }
+        if (result.good())
+            status = skipToElement(reader, status);
+    }
+    if (result.good())
+        result = checkReaderStatus(status);
+    return result;
+}
+
+
+static OFCondition parsePixelSequenceStream(DcmPixelSequence *sequence,
+                                            xmlTextReaderPtr reader,
+                                            int &status)
+{
+    OFCondition result = EC_Normal;
+    /* nothing to do for an empty pixel sequence */
+    if (xmlTextReaderIsEmptyElement(reader) == 1)
+        return result;
+    status = skipToElement(reader, xmlTextReaderRead(reader));
+    while (result.good() && (status == 1) && (xmlTextReaderNodeType(reader) == XML_READER_TYPE_ELEMENT))
+    {
+        /* ignore non-pixel-item nodes */
+        if (xmlStrcmp(xmlTextReaderConstName(reader), OFreinterpret_cast(const xmlChar *, "pixel-item")) == 0)
+        {
+            xmlNodePtr current = xmlTextReaderExpand(reader);
+            if (current != NULL)
+            {
+                /* create new pixel item */
+                DcmPixelItem *newItem = new DcmPixelItem(DcmTag(DCM_Item, EVR_OB));
+                sequence->insert(newItem);
+                /* put pixel data into the item */
+                putElementContent(current, newItem);
+            }
+        } else
+            OFLOG_WARN(xml2dcmLogger, "unexpected node '" << xmlTextReaderConstName(reader) << "', 'pixel-item' expected, skipping");
+        status = skipToElement(reader, xmlTextReaderNext(reader));
+        result = checkReaderStatus(status);
+    }
+    return result;
+}
+
+
+static OFCondition parseMetaHeaderStream(DcmMetaInfo *metainfo,
+                                         xmlTextReaderPtr reader,
+                                         const OFBool parse,
+                                         int &status)
+{
+    /* check for valid node and correct name */
+    OFCondition result = checkNode(xmlTextReaderCurrentNode(reader), "meta-header");
+    if (result.good())
+    {
+        if (parse && (xmlTextReaderIsEmptyElement(reader) != 1))
+        {
+            status = skipToElement(reader, xmlTextReaderRead(reader));
+            while (result.good() && (status == 1) && (xmlTextReaderNodeType(reader) == XML_READER_TYPE_ELEMENT))
+            {
+                /* ignore non-element nodes */
+                if (xmlStrcmp(xmlTextReaderConstName(reader), OFreinterpret_cast(const xmlChar *, "element")) == 0)
+                    result = parseElementStream(metainfo, reader, status);
+                else {
+                    OFLOG_WARN(xml2dcmLogger, "unexpected node '" << xmlTextReaderConstName(reader) << "', 'element' expected, skipping");
+                    status = xmlTextReaderNext(reader);
+                }
+                status = skipToElement(reader, status);
+            }
+            /* proceed with the node after the end tag */
+            if (result.good() && (status == 1))
+                status = xmlTextReaderRead(reader);
+        } else {
+            /* skip the complete "meta-header" */
+            status = xmlTextReaderNext(reader);
+        }
+        if (result.good())
+            result = checkReaderStatus(status);
+    }
+    return result;
+}
+
+
+static OFCondition parseDataSetStream(DcmItem *dataset,
+                                      xmlTextReaderPtr reader,
+                                      E_TransferSyntax xfer,
+                                      int &status)
+{
+    OFCondition result = EC_Normal;
+    /* nothing to do for an empty data set or item */
+    if (xmlTextReaderIsEmptyElement(reader) == 1)
+        return result;
+    status = skipToElement(reader, xmlTextReaderRead(reader));
+    while (result.good() && (status == 1) && (xmlTextReaderNodeType(reader) == XML_READER_TYPE_ELEMENT))
+    {
+        const xmlChar *name = xmlTextReaderConstName(reader);
+        /* ignore non-element/sequence nodes */
+        if (xmlStrcmp(name, OFreinterpret_cast(const xmlChar *, "element")) == 0)
+            result = parseElementStream(dataset, reader, status);
+        else if (xmlStrcmp(name, OFreinterpret_cast(const xmlChar *, "sequence")) == 0)
+        {
+            DcmElement *newElem = NULL;
+            /* create new sequence element (the attributes are already available) */
+            if (createNewElement(xmlTextReaderCurrentNode(reader), newElem).good())
+            {
+                /* insert new sequence element into the dataset */
+                if (dataset->insert(newElem, OFTrue /*replaceOld*/).good())
+                {
+                    /* special handling for compressed pixel data */
+                    if (newElem->getTag() == DCM_PixelData)
+                    {
+                        /* create new pixel sequence */
+                        DcmPixelSequence *sequence = new DcmPixelSequence(DcmTag(DCM_PixelData, EVR_OB));
+                        /* ... insert it into the dataset and proceed with the pixel items */
+                        OFstatic_cast(DcmPixelData *, newElem)->putOriginalRepresentation(xfer, NULL, sequence);
+                        result = parsePixelSequenceStream(sequence, reader, status);
+                    } else {
+                        /* proceed parsing the items of the sequence */
+                        result = parseSequenceStream(OFstatic_cast(DcmSequenceOfItems *, newElem), reader, xfer, status);
+                    }
+                    /* proceed with the node after the end tag */
+                    if (result.good())
+                        status = xmlTextReaderRead(reader);
+                } else {
+                    /* delete element if insertion failed */
+                    delete newElem;
+                    status = xmlTextReaderNext(reader);
+                }
+            } else
+                status = xmlTextReaderNext(reader);
+        } else {
+            OFLOG_WARN(xml2dcmLogger, "unexpected node '" << name << "', skipping");
+            status = xmlTextReaderNext(reader);
+        }
+        if (result.good())
+            status = skipToElement(reader, status);
+    }
+    if (result.good())
+        result = checkReaderStatus(status);
+    return result;
+}
+
+
+static OFCondition readXmlFileStream(const char *ifname,
+                                     DcmFileFormat &fileformat,
+                                     E_TransferSyntax &xfer,
+                                     const OFBool metaInfo,
+                                     const OFBool checkNamespace,
+                                     const OFBool validateDocument)
+{
+    OFCondition result = EC_Normal;
+    xfer = EXS_Unknown;
+    /* substitute entities, the document is validated while it is read (if required) */
+    int options = XML_PARSE_NOENT;
+#if LIBXML_VERSION >= 20703
+    /* disable the maximum length of XML element values (see readXmlFile) */
+    options |= XML_PARSE_HUGE;
+#endif
+    if (validateDocument)
+    {
+        OFLOG_INFO(xml2dcmLogger, "validating XML document while reading ...");
+        options |= XML_PARSE_DTDVALID;
+    }
+    xmlTextReaderPtr reader = xmlReaderForFile(ifname, NULL /*encoding*/, options);
+    if (reader == NULL)
+    {
+        OFLOG_ERROR(xml2dcmLogger, "could not parse document: " << ifname);
+        return EC_IllegalCall;
+    }
+    xmlGenericError(xmlGenericErrorContext, "--- libxml parsing ------\n");
+    /* move to the root node */
+    int status = skipToElement(reader, xmlTextReaderRead(reader));
+    if (status == 1)
+    {
+        /* check namespace declaration (if required) */
+        if (!checkNamespace || (xmlSearchNsByHref(xmlTextReaderCurrentDoc(reader), xmlTextReaderCurrentNode(reader),
+            OFreinterpret_cast(const xmlChar *, DCMTK_XML_NAMESPACE_URI)) != NULL))
+        {
+            /* check whether to parse a "file-format" or "data-set" */
+            if (xmlStrcmp(xmlTextReaderConstName(reader), OFreinterpret_cast(const xmlChar *, "file-format")) == 0)
+            {
+                OFLOG_INFO(xml2dcmLogger, "parsing file-format ...");
+                if (metaInfo)
+                    OFLOG_INFO(xml2dcmLogger, "parsing meta-header ...");
+                else
+                    OFLOG_INFO(xml2dcmLogger, "skipping meta-header ...");
+                /* parse/skip "meta-header" */
+                status = skipToElement(reader, xmlTextReaderRead(reader));
+                result = parseMetaHeaderStream(fileformat.getMetaInfo(), reader, metaInfo /*parse*/, status);
+                if (result.good())
+                    status = skipToElement(reader, status);
+            }
+            /* there should always be a "data-set" node */
+            if (result.good())
+            {
+                OFLOG_INFO(xml2dcmLogger, "parsing data-set ...");
+                /* parse "data-set" */
+                xmlNodePtr current = (status == 1) ? xmlTextReaderCurrentNode(reader) : NULL;
+                if ((current != NULL) && (xmlTextReaderNodeType(reader) != XML_READER_TYPE_ELEMENT))
+                    current = NULL;
+                result = checkNode(current, "data-set");
+                if (result.good())
+                {
+                    DcmDataset *dataset = fileformat.getDataset();
+                    /* determine stored transfer syntax */
+                    xmlChar *xferUID = xmlTextReaderGetAttribute(reader, OFreinterpret_cast(const xmlChar *, "xfer"));
+                    if (xferUID != NULL)
+                        xfer = DcmXfer(OFreinterpret_cast(char *, xferUID)).getXfer();
+                    result = parseDataSetStream(dataset, reader, xfer, status);
+                    /* free allocated memory */
+                    xmlFree(xferUID);
+                }
+            }
+            /* read the rest of the document (required for the validation) */
+            while (result.good() && (status == 1))
+                status = xmlTextReaderRead(reader);
+            if (result.good())
+                result = checkReaderStatus(status);
+            if (result.good() && validateDocument && (xmlTextReaderIsValid(reader) != 1))
+            {
+                OFLOG_ERROR(xml2dcmLogger, "document does not validate");
+                result = EC_IllegalCall;
+            }
+        } else {
+            OFLOG_ERROR(xml2dcmLogger, "document has wrong type, dcmtk namespace not found");
+            result = EC_IllegalCall;
+        }
+    }
+    else if (status == 0)
+    {
+        OFLOG_ERROR(xml2dcmLogger, "document is empty: " << ifname);
+        result = EC_IllegalCall;
+    } else {
+        OFLOG_ERROR(xml2dcmLogger, "could not parse document: " << ifname);
+        result = EC_IllegalCall;
+    }
+    xmlGenericError(xmlGenericErrorContext, "-------------------------\n");
+    /* free allocated memory */
+    xmlFreeTextReader(reader);
+    return result;
+}
+
+
 #define SHORTCOL 3
 #define LONGCOL 21
 
@@ -667,6 +987,7 @@ static OFCondition readXmlFile(const char *ifname,
 int main(int argc, char *argv[])
 {
     OFBool opt_metaInfo = OFTrue;
+    OFBool opt_streaming = OFFalse;
     OFBool opt_namespace = OFFalse;
     OFBool opt_validate = OFFalse;
     OFBool opt_generateUIDs = OFFalse;
@@ -697,6 +1018,9 @@ int main(int argc, char *argv[])
       cmd.addSubGroup("input file format:");
         cmd.addOption("--read-meta-info",      "+f",     "read meta information if present (default)");
         cmd.addOption("--ignore-meta-info",    "-f",     "ignore file meta information");
+      cmd.addSubGroup("XML document processing:");
+        cmd.addOption("--read-document",       "+Xd",    "parse complete document into a tree\nbefore the conversion (default)");
+        cmd.addOption("--read-stream",         "+Xs",    "convert elements while the document is read\n(requires less memory, faster)");
 
     cmd.addGroup("processing options:");
       cmd.addSubGroup("validation:");
@@ -779,6 +1103,13 @@ int main(int argc, char *argv[])
             opt_metaInfo = OFFalse;
         cmd.endOptionBlock();
 
+        cmd.beginOptionBlock();
+        if (cmd.findOption("--read-document"))
+            opt_streaming = OFFalse;
+        if (cmd.findOption("--read-stream"))
+            opt_streaming = OFTrue;
+        cmd.endOptionBlock();
+
         /* processing options */
 
         if (cmd.findOption("--validate-document"))
@@ -930,7 +1261,10 @@ int main(int argc, char *argv[])
         E_TransferSyntax xfer;
         OFLOG_INFO(xml2dcmLogger, "reading XML input file: " << opt_ifname);
         /* read XML file and feed data into DICOM fileformat */
-        result = readXmlFile(opt_ifname, fileformat, xfer, opt_metaInfo, opt_namespace, opt_validate);
+        if (opt_streaming)
+            result = readXmlFileStream(opt_ifname, fileformat, xfer, opt_metaInfo, opt_namespace, opt_validate);
+        else
+            result = readXmlFile(opt_ifname, fileformat, xfer, opt_metaInfo, opt_namespace, opt_validate);
         if (result.good())
         {
             DcmDataset *dataset = fileformat.getDataset();
@@ -160,6 +160,23 @@ class DCMTK_DCMDATA_EXPORT DcmByteString: public DcmElement
                                     const unsigned long pos,
                                     OFBool normalize = OFTrue);
 
+    /** get a particular string component as a pointer into the stored string value.
+     *  In contrast to getOFString(), the value is not copied, i.e. no memory is allocated.
+     *  This is useful for read-only access, e.g. when matching or comparing values.
+     *  The returned pointer is valid only until the next read, write or put operation,
+     *  and the value is usually not terminated by a NULL byte (but by a backslash).
+     *  An empty value results in a length of 0 (and possibly a NULL pointer).
+     *  @param stringVal variable in which the pointer to the value is stored (might be NULL)
+     *  @param stringLen variable in which the length of the value is stored
+     *  @param pos index of the value in case of multi-valued elements (0..vm-1)
+     *  @param normalize not used since string normalization depends on value representation
+     *  @return status, EC_Normal if successful, an error code otherwise
+     */
+    virtual OFCondition getStringView(const char *&stringVal,
+                                      Uint32 &stringLen,
+                                      const unsigned long pos = 0,
+                                      OFBool normalize = OFTrue);
+
     /** get entire element value as a character string.
      *  In case of VM > 1 the individual values are separated by a backslash ('\').
      *  @param stringVal variable in which the result value is stored
@@ -382,5 +399,19 @@ DCMTK_DCMDATA_EXPORT void normalizeString(OFString &string,
                      const OFBool trailing,
                      const char paddingChar = ' ');
 
+/** normalize the given single string value by adjusting the pointer and length only,
+ *  i.e.\ exclude leading and/or trailing padding without modifying or copying the value
+ *  @param string input and output pointer to the string value to be normalized
+ *  @param length input and output length of the string value
+ *  @param leading exclude leading spaces if OFTrue
+ *  @param trailing exclude trailing spaces if OFTrue
+ *  @param paddingChar padding character to be excluded (usually a space)
+ */
+DCMTK_DCMDATA_EXPORT void normalizeString(const char *&string,
+                     Uint32 &length,
+                     const OFBool leading,
+                     const OFBool trailing,
+                     const char paddingChar = ' ');
+
 
 #endif // DCBYTSTR_H
@@ -27,6 +27,8 @@
 #include "dcmtk/dcmdata/dctypes.h"
 #include "dcmtk/dcmdata/dcxfer.h"
 #include "dcmtk/ofstd/oflist.h"
+#include "dcmtk/ofstd/ofvector.h"
+#include "dcmtk/dcmdata/dcofsetl.h"   /* for class DcmOffsetList */
 
 class DcmStack;
 class DcmRepresentationParameter;
@@ -43,10 +45,10 @@ class DCMTK_DCMDATA_EXPORT DcmCodecParameter
 {
 public:
     /// default constructor
-    DcmCodecParameter() {}
+    DcmCodecParameter() : numberOfThreads_(1) {}
 
     /// copy constructor
-    DcmCodecParameter(const DcmCodecParameter&) {}
+    DcmCodecParameter(const DcmCodecParameter& arg) : numberOfThreads_(arg.numberOfThreads_) {}
 
     /// destructor
     virtual ~DcmCodecParameter() {}
@@ -62,6 +64,114 @@ public:
      */
     virtual const char *className() const = 0;
 
+    /** set the maximum number of threads used for processing the frames of
+     *  a multi-frame image concurrently. Only used if dcmdata has been compiled
+     *  with thread support and if the codec supports multi-threading.
+     *  @param numberOfThreads number of threads, 0 and 1 disable multi-threading
+     */
+    void setNumberOfThreads(Uint32 numberOfThreads)
+    {
+      numberOfThreads_ = numberOfThreads;
+    }
+
+    /** get the maximum number of threads used for processing the frames of
+     *  a multi-frame image concurrently.
+     *  @return number of threads, 0 and 1 mean no multi-threading
+     */
+    Uint32 getNumberOfThreads() const
+    {
+      return numberOfThreads_;
+    }
+
+private:
+
+    /// maximum number of threads used for processing multiple frames
+    Uint32 numberOfThreads_;
+
+};
+
+
+/** compressed fragment of an encapsulated pixel sequence that has been
+ *  loaded into memory, see DcmCodec::loadFragments()
+ */
+struct DcmCompressedFragment
+{
+  /// pointer to the compressed data (owned by the pixel item), may be NULL
+  Uint8 *data;
+
+  /// length of the compressed data in bytes
+  Uint32 length;
+};
+
+
+/** abstract base class for the codec specific processing of a single frame
+ *  of a multi-frame image, see DcmCodec::processFrames().
+ *  If multiple threads are used, processFrame() is called concurrently for
+ *  different frames. Therefore, implementations must not access the dataset
+ *  or the pixel sequence, but only data that has been prepared in advance
+ *  (e.g. the fragments loaded by DcmCodec::loadFragments()) and the part of
+ *  the output buffer belonging to the given frame.
+ */
+class DCMTK_DCMDATA_EXPORT DcmFrameProcessor
+{
+public:
+  /// destructor
+  virtual ~DcmFrameProcessor() {}
+
+  /** process the given frame
+   *  @param frameNo number of the frame, starting with 0 for the first frame
+   *  @param threadNo index of the calling thread, starting with 0 for the
+   *    thread that called DcmCodec::processFrames() and less than the number
+   *    of threads passed to it. Frames with the same index are never processed
+   *    concurrently, so it can be used for selecting per-thread decoder instances.
+   *  @return EC_Normal if successful, an error code otherwise
+   */
+  virtual OFCondition processFrame(Uint32 frameNo, size_t threadNo) = 0;
+};
+
+
+/** abstract base class for the codec specific compression of a single frame
+ *  of a multi-frame image, see DcmCodec::encodeFrames().
+ *  The frames are compressed in batches: prepareFrame() is called for each
+ *  frame of a batch by the calling thread, which may also access the dataset
+ *  (e.g. for rendering the frame). Then, encodeFrame() is called for all
+ *  frames of the batch, concurrently if multiple threads are used.
+ *  Therefore, encodeFrame() must only access data that has been prepared in
+ *  advance. Within a batch, each frame is assigned a different slot number,
+ *  which can be used for selecting per-frame buffers or encoder instances.
+ */
+class DCMTK_DCMDATA_EXPORT DcmFrameEncoder
+{
+public:
+  /// destructor
+  virtual ~DcmFrameEncoder() {}
+
+  /** prepare the compression of the given frame. This method is always
+   *  called by the thread that called DcmCodec::encodeFrames().
+   *  The default implementation does nothing.
+   *  @param frameNo number of the frame, starting with 0 for the first frame
+   *  @param slot slot number of the frame within the current batch
+   *  @return EC_Normal if successful, an error code otherwise
+   */
+  virtual OFCondition prepareFrame(Uint32 /* frameNo */, Uint32 /* slot */)
+  {
+    return EC_Normal;
+  }
+
+  /** compress the given frame
+   *  @param frameNo number of the frame, starting with 0 for the first frame
+   *  @param slot slot number of the frame within the current batch
+   *  @param compressedData compressed frame returned in this parameter on
+   *    success. The buffer must be allocated with new[] and is deleted by
+   *    the caller.
+   *  @param compressedLength length of the compressed frame in bytes
+   *  @return EC_Normal if successful, an error code otherwise
+   */
+  virtual OFCondition encodeFrame(
+    Uint32 frameNo,
+    Uint32 slot,
+    Uint8 *& compressedData,
+    Uint32& compressedLength) = 0;
 };
 
 
@@ -270,7 +380,8 @@ public:
     const char *codeMeaning);
 
   /** determine the index number (starting with zero) of the compressed pixel data fragment
-   *  corresponding to the given frame (also starting with zero)
+   *  corresponding to the given frame (also starting with zero). The index of all frames is
+   *  cached by the pixel sequence, see DcmPixelSequence::createFrameIndex().
    *  @param frameNo frame number
    *  @param numberOfFrames number of frames of this image
    *  @param fromPixSeq compressed pixel sequence
@@ -282,6 +393,77 @@ public:
     Sint32 numberOfFrames,
     DcmPixelSequence * fromPixSeq,
     Uint32& currentItem);
+
+  /** determine the index numbers of the first compressed pixel data fragment
+   *  of all frames at once. This works for single-frame images, for images
+   *  with one fragment per frame, for images with a valid basic offset table
+   *  and for JPEG and JPEG 2000 images (see DcmPixelSequence::createFrameIndex()).
+   *  @param numberOfFrames number of frames of this image
+   *  @param fromPixSeq compressed pixel sequence
+   *  @param startFragments index of the first fragment of each frame returned
+   *    in this parameter on success, followed by the total number of fragments
+   *    (i.e.\ numberOfFrames + 1 entries)
+   *  @return EC_Normal if successful, an error code otherwise
+   */
+  static OFCondition determineFrameFragments(
+    Sint32 numberOfFrames,
+    DcmPixelSequence * fromPixSeq,
+    OFVector<Uint32>& startFragments);
+
+  /** load all fragments of the given pixel sequence into memory (if not yet
+   *  done) and return pointers to their data. This allows for accessing the
+   *  fragments from multiple threads without accessing the pixel sequence.
+   *  @param fromPixSeq compressed pixel sequence
+   *  @param fragments data and length of all fragments (including the offset
+   *    table) returned in this parameter on success
+   *  @return EC_Normal if successful, an error code otherwise
+   */
+  static OFCondition loadFragments(
+    DcmPixelSequence * fromPixSeq,
+    OFVector<DcmCompressedFragment>& fragments);
+
+  /** process all frames of a multi-frame image with the given processor.
+   *  If more than one thread is requested (and dcmdata has been compiled with
+   *  thread support), the frames are distributed to a pool of worker threads
+   *  (including the calling thread), otherwise they are processed in
+   *  ascending order. Processing stops after the first error.
+   *  @param processor codec specific processor for a single frame
+   *  @param numberOfFrames number of frames to be processed
+   *  @param numberOfThreads maximum number of threads to be used
+   *  @return EC_Normal if successful, the error of the failed frame
+   *    with the lowest frame number otherwise
+   */
+  static OFCondition processFrames(
+    DcmFrameProcessor& processor,
+    Uint32 numberOfFrames,
+    Uint32 numberOfThreads);
+
+  /** compress all frames of a multi-frame image with the given encoder and
+   *  append them to the given pixel sequence in ascending order. If more than
+   *  one thread is requested, the frames are compressed concurrently in
+   *  batches of twice the number of threads, so only the compressed data of
+   *  one batch is kept in memory at the same time. The worker threads are
+   *  started once and used for all batches. Processing stops after the
+   *  first error.
+   *  @param encoder codec specific encoder for a single frame
+   *  @param numberOfFrames number of frames to be compressed
+   *  @param numberOfThreads maximum number of threads to be used
+   *  @param pixelSequence pixel sequence to which the compressed frames are added
+   *  @param offsetList list of frame sizes for the offset table, one entry
+   *    is added for each frame
+   *  @param fragmentSize maximum fragment size (in kbytes), 0 for unlimited
+   *  @param compressedSize total size of the compressed frames in bytes
+   *    returned in this parameter
+   *  @return EC_Normal if successful, an error code otherwise
+   */
+  static OFCondition encodeFrames(
+    DcmFrameEncoder& encoder,
+    Uint32 numberOfFrames,
+    Uint32 numberOfThreads,
+    DcmPixelSequence * pixelSequence,
+    DcmOffsetList& offsetList,
+    Uint32 fragmentSize,
+    unsigned long& compressedSize);
 };
 
 
@@ -26,6 +26,8 @@
 #include "dcmtk/config/osconfig.h"
 
 #include "dcmtk/dcmdata/dcdicdir.h"
+#include "dcmtk/ofstd/oflist.h"
+#include "dcmtk/ofstd/ofmap.h"
 
 
 /*-----------------------------------*
@@ -233,6 +235,9 @@ class DCMTK_DCMDATA_EXPORT DicomDirInterface
 
     /** write the current DICOMDIR object to file.
      *  NB: The filename has already been specified for the object creation (see above).
+     *  If the "in-place append" mode is enabled (see enableInPlaceAppendMode()) and the
+     *  DICOMDIR has been opened with appendToDicomDir(), the new records are appended to
+     *  the existing file instead of rewriting it completely (if possible).
      *  @param encodingType flag, specifying the encoding with undefined or explicit length
      *  @param groupLength flag, specifying how to handle the group length tags
      *  @return EC_Normal upon success, an error code otherwise
@@ -286,6 +291,28 @@ class DCMTK_DCMDATA_EXPORT DicomDirInterface
     OFCondition addDicomFile(const char *filename,
                              const char *directory = NULL);
 
+    /** add specified DICOM files to the current DICOMDIR.
+     *  This method has the same effect as calling addDicomFile() for each file of
+     *  the list in the given order.  However, if more than one thread is selected
+     *  (see setNumberOfThreads()), the files are loaded and checked in parallel.
+     *  The insertion of the directory records (including the creation of icon
+     *  images, since DicomImage is not thread-safe) is performed sequentially.  The files are processed
+     *  in batches, so only a few of them are kept in memory at the same time.
+     *  @param filenames list of DICOM files to be added
+     *  @param directory directory where the DICOM files are stored (optional).
+     *    See addDicomFile() for details.
+     *  @param badFiles list to which the names of the files are appended that could
+     *    not be added to the DICOMDIR
+     *  @param goodFiles number of files that have been added to the DICOMDIR
+     *  @return EC_Normal upon success, an error code otherwise.  If the "abort on
+     *    first error" mode is disabled, an error is only returned if the DICOMDIR
+     *    has not been created, i.e. bad files are reported by the list only.
+     */
+    OFCondition addDicomFiles(const OFList<OFString> &filenames,
+                              const char *directory,
+                              OFList<OFString> &badFiles,
+                              unsigned long &goodFiles);
+
     /** set the fileset descriptor file ID and character set.
      *  Prior to any internal modification both 'filename' and 'charset' are checked
      *  using the above checking routines.  Existence of 'filename' is not checked.
@@ -325,6 +352,23 @@ class DCMTK_DCMDATA_EXPORT DicomDirInterface
      */
     OFCondition setDefaultIcon(const char *filename);
 
+    /** set number of threads used for loading and checking DICOM files.
+     *  This setting is only used by addDicomFiles().  If DCMTK is compiled
+     *  without thread support, all files are processed sequentially.
+     *  @param threads number of threads (1..n, initial: 1)
+     *  @return EC_Normal upon success, an error code otherwise
+     */
+    OFCondition setNumberOfThreads(const unsigned int threads);
+
+    /** get number of threads used for loading and checking DICOM files.
+     *  See setNumberOfThreads() for more details.
+     *  @return number of threads
+     */
+    unsigned int getNumberOfThreads() const
+    {
+        return NumberOfThreads;
+    }
+
     /** get current status of the "abort on first error" mode.
      *  See enableAbortMode() for more details.
      *  @return OFTrue if mode is enabled, OFFalse otherwise
@@ -379,6 +423,15 @@ class DCMTK_DCMDATA_EXPORT DicomDirInterface
         return IconImageMode;
     }
 
+    /** get current status of the "in-place append" mode.
+     *  See enableInPlaceAppendMode() for more details.
+     *  @return OFTrue if mode is enabled, OFFalse otherwise
+     */
+    OFBool inPlaceAppendMode() const
+    {
+        return InPlaceAppendMode;
+    }
+
     /** get current status of the "create backup" mode.
      *  See enableBackupMode() for more details.
      *  @return OFTrue if mode is enabled, OFFalse otherwise
@@ -491,6 +544,24 @@ class DCMTK_DCMDATA_EXPORT DicomDirInterface
      */
     OFBool disableBackupMode(const OFBool newMode = OFFalse);
 
+    /** enable/disable the "in-place append" mode.
+     *  If this mode is enabled, writeDicomDir() appends the records that have been
+     *  added to an existing DICOMDIR (see appendToDicomDir()) to the end of the file
+     *  and only updates the offsets of the existing records that refer to them,
+     *  instead of rewriting the complete file.  This is much faster for large
+     *  DICOMDIRs, especially if the backup mode is also disabled, since creating a
+     *  backup always requires a copy of the complete file.  If the existing file
+     *  does not have the expected structure or if existing records have been modified
+     *  (e.g. by inventing missing attribute values, see enableInventMode()), it is
+     *  written completely as usual.  Please note that the new records are not sorted into the Directory Record
+     *  Sequence, which is not required by the DICOM standard.  This mode has no
+     *  effect when updating an existing DICOMDIR (see updateDicomDir()).
+     *  Default: off, always write the complete DICOMDIR
+     *  @param newMode enable mode if OFTrue, disable if OFFalse
+     *  @return previously stored value
+     */
+    OFBool enableInPlaceAppendMode(const OFBool newMode = OFTrue);
+
     /** disable/enable the "pixel encoding check".
      *  If this mode is disabled the pixel encoding is not check for compliance
      *  with the selected application profile.  Please use this switch with care
@@ -574,6 +645,16 @@ class DCMTK_DCMDATA_EXPORT DicomDirInterface
                                       const char *directory,
                                       DcmFileFormat &fileformat);
 
+    /** add previously loaded and checked DICOM file to the current DICOMDIR
+     *  @param filename name of the DICOM file to be added
+     *  @param directory directory where the DICOM file is stored (optional)
+     *  @param fileformat object in which the loaded data is stored
+     *  @return EC_Normal upon success, an error code otherwise
+     */
+    OFCondition insertDicomFile(const char *filename,
+                                const char *directory,
+                                DcmFileFormat &fileformat);
+
     /** check SOP class and transfer syntax for compliance with current profile
      *  @param metainfo object where the DICOM file meta information is stored
      *  @param dataset object where the DICOM dataset is stored
@@ -662,6 +743,36 @@ class DCMTK_DCMDATA_EXPORT DicomDirInterface
                                            const E_DirRecType recordType,
                                            DcmItem* dataset);
 
+    /** get the key under which a directory record is stored in the record index.
+     *  The key consists of the parent record, the record type and the value of the
+     *  unique key attribute (e.g. SOPInstanceUID for IMAGE records).
+     *  @param parent higher-level structure where the record is stored
+     *  @param recordType type of the directory record
+     *  @param item directory record or DICOM dataset of the current file
+     *  @param isRecord flag indicating whether 'item' is a directory record
+     *  @param result string variable in which the resulting key is stored
+     *  @return OFTrue if a key could be determined, OFFalse otherwise (e.g. empty value)
+     */
+    OFBool getRecordIndexKey(DcmDirectoryRecord *parent,
+                             const E_DirRecType recordType,
+                             DcmItem *item,
+                             const OFBool isRecord,
+                             OFString &result);
+
+    /** add all records stored below the given parent record to the record index.
+     *  This speeds up the search for existing records (see findExistingRecord()).
+     *  @param parent higher-level structure where the records are stored
+     *  @return OFTrue if the records are indexed, OFFalse if a linear search is required
+     */
+    OFBool indexRecords(DcmDirectoryRecord *parent);
+
+    /** add a newly created directory record to the record index (if any)
+     *  @param parent higher-level structure where the record is stored
+     *  @param record directory record to be added
+     */
+    void addRecordToIndex(DcmDirectoryRecord *parent,
+                          DcmDirectoryRecord *record);
+
     /** create or update patient record and copy required values from dataset
      *  @param record record to be updated, use NULL to create a new one
      *  @param fileformat DICOM dataset of the current file
@@ -1071,6 +1182,33 @@ class DCMTK_DCMDATA_EXPORT DicomDirInterface
                               const unsigned int width,
                               const unsigned int height);
 
+    /** get the icon image parameters for the current application profile.
+     *  Some application profiles require icon images of a particular size.
+     *  For the others, the icon image mode and size selected by the user is used.
+     *  @param iconSize resolution of the icon images to be created
+     *  @param iconRequired set to OFTrue if the profile requires icon images
+     *  @return OFTrue if icon images are to be created, OFFalse otherwise
+     */
+    OFBool getIconImageMode(unsigned int &iconSize,
+                            OFBool &iconRequired) const;
+
+    /** create pixel data of an icon image.
+     *  If the icon image cannot be created from the DICOM dataset and there is no
+     *  PGM file specified (neither for the particular image not a default one) a
+     *  black image is used instead.
+     *  Please note that the memory buffer has to be allocated by the caller.
+     *  @param dataset DICOM dataset from which the icon image is possibly created
+     *  @param pixel pointer to memory buffer where the pixel data are to be stored
+     *  @param count number of bytes allocated for the 'pixel' memory buffer
+     *  @param size resolution of the icon image to be created (width and height)
+     *  @param sourceFilename name of the source DICOM file
+     */
+    void createIconPixelData(DcmItem *dataset,
+                             Uint8 *pixel,
+                             const unsigned long count,
+                             const unsigned int size,
+                             const OFString &sourceFilename);
+
     /** add icon image sequence to directory record.
      *  If the icon image cannot be created from the DICOM dataset and there is no
      *  PGM file specified (neither for the particular image not a default one) a
@@ -1476,6 +1614,13 @@ class DCMTK_DCMDATA_EXPORT DicomDirInterface
     OFBool IconImageMode;
     /// update existing fileset
     OFBool FilesetUpdateMode;
+    /// append new records to the existing DICOMDIR file
+    OFBool InPlaceAppendMode;
+
+    /// index of the directory records, see getRecordIndexKey() for the key
+    OFMap<OFString, DcmDirectoryRecord *> RecordIndex;
+    /// number of indexed records per parent record plus 1, or 0 if not indexable
+    OFMap<const DcmDirectoryRecord *, unsigned long> IndexedRecords;
 
     /// name of the DICOMDIR backup file
     OFString BackupFilename;
@@ -1489,6 +1634,9 @@ class DCMTK_DCMDATA_EXPORT DicomDirInterface
     /// filename of the default icon (if any)
     OFString DefaultIcon;
 
+    /// number of threads used by addDicomFiles()
+    unsigned int NumberOfThreads;
+
     /// flag indicating whether RLE decompression is supported
     OFBool RLESupport;
     /// flag indicating whether JPEG decompression is supported
@@ -1511,6 +1659,9 @@ class DCMTK_DCMDATA_EXPORT DicomDirInterface
     /// current curve number used to invent missing attribute values
     unsigned long AutoCurveNumber;
 
+    /// the file queue of addDicomFiles() calls loadAndCheckDicomFile()
+    friend class DicomDirFileQueue;
+
     /// private undefined copy constructor
     DicomDirInterface(const DicomDirInterface &obj);
 
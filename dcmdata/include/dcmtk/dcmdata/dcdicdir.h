@@ -26,11 +26,14 @@
 
 #include "dcmtk/dcmdata/dcdirrec.h"
 #include "dcmtk/dcmdata/dcvrulup.h"
+#include "dcmtk/ofstd/offile.h"
+#include "dcmtk/ofstd/ofvector.h"
 
 
 #define DEFAULT_DICOMDIR_NAME    "DICOMDIR"
 #define TEMPNAME_TEMPLATE_PREFIX "DD"
 #define DICOMDIR_BACKUP_SUFFIX   ".$$$"
+#define DICOMDIR_JOURNAL_SUFFIX  ".$J$"
 #define DICOMDIR_DEFAULT_TRANSFERSYNTAX  EXS_LittleEndianExplicit
 
 /** helper structure for item offsets
@@ -43,6 +46,20 @@ typedef struct
     Uint32  fileOffset;
 } ItemOffset;
 
+/** helper structure for offsets that are updated in an existing DICOMDIR file
+ */
+typedef struct
+{
+    /// item (directory record or dataset) containing the offset element
+    DcmItem *item;
+    /// element containing the offset
+    DcmUnsignedLongOffset *element;
+    /// directory record referenced by the new offset (might be NULL)
+    DcmDirectoryRecord *record;
+    /// position of the element value in file
+    offile_off_t position;
+} DirOffsetPatch;
+
 
 /** this class implements support for DICOMDIR files, which are special DICOM files
  *  containing a list of directory records, with a logical tree structure being
@@ -120,6 +137,34 @@ public:
       const E_EncodingType enctype = EET_UndefinedLength,
       const E_GrpLenEncoding glenc = EGL_withoutGL );
 
+    /** writes DICOMDIR to file by appending the new directory records only.
+     *  Directory records that have been added since the DICOMDIR was read (or
+     *  written) are appended to the existing file, and only those references of
+     *  the existing records that have changed are updated in place.  This avoids
+     *  rewriting the complete file, e.g. when adding a few files to a large file
+     *  set.  The existing records must not have been removed.  If an existing
+     *  record has been modified otherwise (e.g. by updating attribute values),
+     *  it has to be marked with DcmDirectoryRecord::setModified(), and the
+     *  complete DICOMDIR is written.  Apart from that, only the records whose
+     *  references are updated are compared with their encoding in the file,
+     *  other modifications that are not marked are not detected.
+     *  If the file structure does not allow for appending or some other
+     *  precondition is not met (e.g. the DICOMDIR has not been read from file,
+     *  the Directory Record Sequence is not the last element of the dataset, a
+     *  new record references an MRDR, or group length elements are requested),
+     *  the complete DICOMDIR is written by calling write().
+     *  Before the existing file is modified, its original size and the bytes to
+     *  be overwritten are stored in a journal file (with DICOMDIR_JOURNAL_SUFFIX).
+     *  If the update fails or is interrupted, the file is restored from the
+     *  journal, at the latest when the DICOMDIR is read the next time.
+     *  @param enctype encoding type for the new directory records
+     *  @param glenc encoding type for group lengths (passed to write() only)
+     *  @return status, EC_Normal if successful, an error code otherwise
+     */
+    virtual OFCondition writeIncremental(
+      const E_EncodingType enctype = EET_UndefinedLength,
+      const E_GrpLenEncoding glenc = EGL_withoutGL );
+
     /** check the currently stored element value
      *  @param autocorrect correct value length if OFTrue
      *  @return status, EC_Normal if value length is correct, an error code otherwise
@@ -174,6 +219,24 @@ public:
                                      ItemOffset *refCounter,         // inout
                                      const unsigned long numCounters );  // in
 
+    // methods used for writing the new directory records only
+    OFBool      collectNewRecords(   DcmDirectoryRecord *startRec,   // in
+                                     OFVector<DcmDirectoryRecord *> &newRecs, // inout
+                                     unsigned long &oldRecs );       // inout
+    OFBool      linkRecordOffset(    DcmItem *item,                  // inout
+                                     offile_off_t itemStart,         // in
+                                     const DcmTagKey &offsetTag,     // in
+                                     DcmDirectoryRecord *record,     // in
+                                     OFVector<DirOffsetPatch> &patches ); // inout
+    OFBool      linkRecords(         DcmDirectoryRecord *startRec,   // inout
+                                     OFVector<DirOffsetPatch> &patches ); // inout
+    OFCondition rollbackIncremental();
+
+    // methods used for replacing the DICOMDIR file
+    OFCondition createTempFile(      OFString &tempfile,             // out
+                                     FILE *&f );                     // out
+    OFCondition moveTempFile(        const OFString &tempfile );     // in
+
     // complete re-organization of the managed directory records (side effect)
     OFCondition convertLinearToTree();
 
@@ -215,6 +278,12 @@ public:
 
     /// container in which all MRDR (multi-reference directory records) for this DICOMDIR are kept
     DcmSequenceOfItems * MRDRSeq;
+
+    /** number of directory records (including MRDRs and unreferenced records) that
+     *  are stored in the DICOMDIR file.  Used by writeIncremental() for checking that
+     *  none of these records has been removed.
+     */
+    unsigned long StoredRecords;
 };
 
 #endif // DCDICDIR_H
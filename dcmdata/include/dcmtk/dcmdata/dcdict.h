@@ -27,6 +27,7 @@
 
 #include "dcmtk/ofstd/ofthread.h"
 #include "dcmtk/dcmdata/dchashdi.h"
+#include "dcmtk/ofstd/ofvector.h"
 
 /// maximum length of a line in the loadable DICOM dictionary
 #define DCM_MAXDICTLINESIZE     2048
@@ -73,7 +74,7 @@ public:
     OFBool isDictionaryLoaded() const { return dictionaryLoaded; }
 
     /// returns the number of normal (non-repeating) tag entries
-    int numberOfNormalTagEntries() const { return hashDict.size(); }
+    int numberOfNormalTagEntries() const;
 
     /// returns the number of repeating tag entries
     int numberOfRepeatingTagEntries() const { return OFstatic_cast(int, repDict.size()); }
@@ -138,13 +139,16 @@ public:
      */
     void addEntry(DcmDictEntry* entry);
 
-    /* Iterators to access the normal and the repeating entries */
+    /* Iterators to access the normal and the repeating entries.
+     * The normal entries of the builtin dictionary (stored in static hash
+     * tables) are visited first, except for those replaced by other entries.
+     */
 
     /// returns an iterator to the start of the normal (non-repeating) dictionary
-    DcmHashDictIterator normalBegin() { return hashDict.begin(); }
+    DcmHashDictIterator normalBegin() { return DcmHashDictIterator(&hashDict, &staticDicts); }
 
     /// returns an iterator to the end of the normal (non-repeating) dictionary
-    DcmHashDictIterator normalEnd() { return hashDict.end(); }
+    DcmHashDictIterator normalEnd() { return DcmHashDictIterator(&hashDict, &staticDicts, OFTrue); }
 
     /// returns an iterator to the start of the repeating tag dictionary
     DcmDictEntryListIterator repeatingBegin() { return repDict.begin(); }
@@ -173,6 +177,21 @@ private:
      */
     void loadBuiltinDictionary();
 
+    /** adds a static hash table of normal entries to the dictionary. The
+     *  entries are searched after the entries added by addEntry(), i.e.\ they
+     *  can be replaced by entries loaded from file.
+     *  @param dict static hash table, not deleted by this dictionary
+     */
+    void addStaticDictionary(const DcmStaticHashDict *dict);
+
+    /** looks up an entry with exactly the given tag key and private creator
+     *  in the static hash tables
+     *  @param key tag key
+     *  @param privCreator private creator name, may be NULL
+     *  @return pointer to entry if found, NULL otherwise
+     */
+    const DcmDictEntry* findStaticEntry(const DcmTagKey& key, const char *privCreator) const;
+
     /** loads the skeleton dictionary (the bare minimum needed to run)
      *  @return true if successful
      */
@@ -196,6 +215,16 @@ private:
      */
     DcmDictEntryList repDict;
 
+    /** static hash tables of normal tags (i.e.\ the builtin dictionary),
+     *  searched after hashDict
+     */
+    OFVector<const DcmStaticHashDict *> staticDicts;
+
+    /** the number of entries in hashDict that replace an entry of the
+     *  static hash tables
+     */
+    int shadowedCount;
+
     /** the number of skeleton entries
      */
     int skeletonCount;
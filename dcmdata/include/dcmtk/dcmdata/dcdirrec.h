@@ -446,6 +446,17 @@ public:
     /// get the offset in file of this directory record
     Uint32 getFileOffset() const;
 
+    /** mark this directory record as modified since it has been read from file.
+     *  DcmDicomDir::writeIncremental() writes the complete DICOMDIR if one of the
+     *  records stored in the file is marked as modified.  The mark is removed when
+     *  the record is written to file.
+     *  @param newFlag OFTrue if the record has been modified, OFFalse otherwise
+     */
+    void setModified(const OFBool newFlag = OFTrue);
+
+    /// check whether this directory record has been marked as modified, see setModified()
+    OFBool isModified() const;
+
 protected:
 
     // side-effect-free conversion routines:
@@ -512,6 +523,9 @@ private:
     /// byte offset at which the start of this directory record resides in the file from which it was read
     Uint32 offsetInFile;
 
+    /// flag indicating whether this directory record has been modified since it was read or written
+    OFBool modified;
+
 };
 
 
@@ -31,6 +31,7 @@
 // forward declarations
 class DcmInputStreamFactory;
 class DcmFileCache;
+class DcmMappedFile;
 class DcmItem;
 
 /** abstract base class for all DICOM elements
@@ -332,6 +333,25 @@ class DCMTK_DCMDATA_EXPORT DcmElement
     virtual OFCondition getString(char *&val,
                                   Uint32 &len);
 
+    /** get a pointer to a particular value of the current element as type string.
+     *  Requires element to be of a string VR, otherwise an error is returned.
+     *  This method does not copy, but returns a pointer into the element value,
+     *  which remains under control of this object and is valid only until the next
+     *  read, write or put operation.  Since the returned value is usually not
+     *  terminated by a NULL byte (e.g. in case of multi-valued elements), the
+     *  length has always to be taken into account.
+     *  @param val pointer to the value returned in this parameter upon success
+     *  @param len length of the returned value (number of characters)
+     *  @param pos index of the value in case of multi-valued elements (0..vm-1)
+     *  @param normalize true if leading and/or trailing padding is to be excluded
+     *    from the returned value (depending on the VR, as done by getOFString())
+     *  @return EC_Normal upon success, an error code otherwise
+     */
+    virtual OFCondition getStringView(const char *&val,
+                                      Uint32 &len,
+                                      const unsigned long pos = 0,
+                                      OFBool normalize = OFTrue);
+
     /** get a pointer to the element value of the current element as type string.
      *  Requires element to be of corresponding VR, otherwise an error is returned.
      *  This method does not copy, but returns a pointer to the element value,
@@ -408,9 +428,12 @@ class DCMTK_DCMDATA_EXPORT DcmElement
      *  heap after use. The DICOM element remains a copy of the value if the
      *  copy parameter is OFTrue; otherwise the value is erased in the DICOM
      *  element.
+     *  A value that references a memory-mapped file (see dcmUseMemoryMappedFiles)
+     *  cannot be detached since it has not been allocated on the heap.
      *  @param copy if true, copy value field before detaching; if false, do not
      *    retain a copy.
-     *  @return EC_Normal upon success, an error code otherwise
+     *  @return EC_Normal upon success, EC_IllegalCall if the value references a
+     *    memory-mapped file, an error code otherwise
      */
     OFCondition detachValueField(OFBool copy = OFFalse);
 
@@ -579,7 +602,9 @@ class DCMTK_DCMDATA_EXPORT DcmElement
      *  to targetBuffer, starting at byte offset offset of the attribute value.
      *  This method does not cause the complete attribute value to be read into
      *  main memory. Subsequent calls for the same partial value may cause repeated
-     *  access to file if the attribute value is kept in file.
+     *  access to file if the attribute value is kept in file. If a file cache is
+     *  passed, the file handle is kept open and the requested range is accessed
+     *  by seeking within the file, also in backward direction (random access).
      *  @param targetBuffer pointer to target buffer, must not be NULL.
      *    Buffer size must be at least numBytes bytes.
      *  @param offset byte offset within the attribute value from where to start
@@ -787,6 +812,15 @@ class DCMTK_DCMDATA_EXPORT DcmElement
      */
     virtual Uint8 *newValueField();
 
+    /** check whether the value field of this element may reference the content
+     *  of a memory-mapped input file (see DcmInputMappedFileStream) instead of
+     *  being copied into a newly allocated value field. This is only possible
+     *  for values that do not require any additional bytes (e.g. a terminating
+     *  zero byte for strings). The default implementation returns OFFalse.
+     *  @return OFTrue if the value may reference a mapped file, OFFalse otherwise
+     */
+    virtual OFBool supportsMappedValue() const;
+
     /** swaps the content of the value field (if loaded) from big-endian to
      *  little-endian or back
      *  @param valueWidth width (in bytes) of each element value
@@ -841,8 +875,18 @@ class DCMTK_DCMDATA_EXPORT DcmElement
     /// required information to load value later
     DcmInputStreamFactory *fLoadValue;
 
+    /** delete the value field (or release the memory-mapped file it references)
+     *  and set fValue to NULL
+     */
+    void freeValueField();
+
     /// value of the element
     Uint8 *fValue;
+
+    /** memory-mapped file referenced by fValue, NULL if the value field
+     *  has been allocated by this element (the usual case)
+     */
+    DcmMappedFile *fValueMapping;
 };
 
 
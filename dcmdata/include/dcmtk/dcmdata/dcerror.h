@@ -123,6 +123,8 @@ extern DCMTK_DCMDATA_EXPORT const OFConditionConst EC_ElemLengthExceeds16BitFiel
 extern DCMTK_DCMDATA_EXPORT const OFConditionConst EC_SequDelimitationItemMissing;
 /// Missing Item Delimitation Item while reading an item
 extern DCMTK_DCMDATA_EXPORT const OFConditionConst EC_ItemDelimitationItemMissing;
+/// Data elements are not written in ascending order of their tags
+extern DCMTK_DCMDATA_EXPORT const OFConditionConst EC_TagOrderViolated;
 
 // status code constants
 
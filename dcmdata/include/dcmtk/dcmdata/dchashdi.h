@@ -24,12 +24,15 @@
 
 #include "dcmtk/config/osconfig.h"    /* make sure OS specific configuration is included first */
 #include "dcmtk/ofstd/oflist.h"
+#include "dcmtk/ofstd/ofvector.h"
 #include "dcmtk/ofstd/ofstream.h"
 #include "dcmtk/dcmdata/dcdefine.h"
+#include "dcmtk/dcmdata/dcvr.h"
 
 class DcmDictEntry;
 class DcmTagKey;
 class DcmHashDict;
+class DcmStaticHashDict;
 
 typedef OFListIterator(DcmDictEntry *) DcmDictEntryListIterator;
 typedef OFListConstIterator(DcmDictEntry *) DcmDictEntryListConstIterator;
@@ -110,7 +113,9 @@ private:
 };
 
 
-/** iterator class for traversing a DcmHashDict
+/** iterator class for traversing a DcmHashDict, optionally preceded by
+ *  the entries of static hash tables that are not replaced by an entry
+ *  of the DcmHashDict
  */
 class DCMTK_DCMDATA_EXPORT DcmHashDictIterator
 {
@@ -118,7 +123,8 @@ public:
 
     /// default constructor
     DcmHashDictIterator()
-      : dict(NULL), hindex(0), iterating(OFFalse), iter()
+      : dict(NULL), hindex(0), iterating(OFFalse), iter(),
+        staticDicts(NULL), sindex(0), eindex(0)
         { init(NULL); }
 
     /** constructor, creates iterator to existing hash dictionary
@@ -127,22 +133,39 @@ public:
      *   of hash dictionary, otherwise iterator points to first element
      */
     DcmHashDictIterator(const DcmHashDict* d, OFBool atEnd = OFFalse)
-      : dict(NULL), hindex(0), iterating(OFFalse), iter()
+      : dict(NULL), hindex(0), iterating(OFFalse), iter(),
+        staticDicts(NULL), sindex(0), eindex(0)
         { init(d, atEnd); }
 
+    /** constructor, creates iterator to the entries of the given static
+     *  hash tables (first) and of the given hash dictionary
+     *  @param d pointer to dictionary
+     *  @param s pointer to list of static hash tables, may be NULL
+     *  @param atEnd if true, iterator points after last element
+     *   of hash dictionary, otherwise iterator points to first element
+     */
+    DcmHashDictIterator(const DcmHashDict* d, const OFVector<const DcmStaticHashDict *> *s, OFBool atEnd = OFFalse)
+      : dict(NULL), hindex(0), iterating(OFFalse), iter(),
+        staticDicts(NULL), sindex(0), eindex(0)
+        { init(d, s, atEnd); }
+
     /// copy constructor
     DcmHashDictIterator(const DcmHashDictIterator& i)
-      : dict(i.dict), hindex(i.hindex), iterating(i.iterating), iter(i.iter)
+      : dict(i.dict), hindex(i.hindex), iterating(i.iterating), iter(i.iter),
+        staticDicts(i.staticDicts), sindex(i.sindex), eindex(i.eindex)
         { }
 
     /// copy assignment operator
     DcmHashDictIterator& operator=(const DcmHashDictIterator& i)
         { dict = i.dict; hindex = i.hindex;
-          iterating = i.iterating; iter = i.iter; return *this; }
+          iterating = i.iterating; iter = i.iter;
+          staticDicts = i.staticDicts; sindex = i.sindex;
+          eindex = i.eindex; return *this; }
 
     /// comparison equality
     OFBool operator==(const DcmHashDictIterator& x) const
-        { return (hindex == x.hindex) && (iter == x.iter); }
+        { return (sindex == x.sindex) && (eindex == x.eindex) &&
+                 (hindex == x.hindex) && (iter == x.iter); }
 
     /// comparison non-equality
     OFBool operator!=(const DcmHashDictIterator& x) const
@@ -150,7 +173,7 @@ public:
 
     /// dereferencing of iterator
     const DcmDictEntry* operator*() const
-        { return (*iter); }
+        { return isStatic() ? staticEntry() : (*iter); }
 
     /// pre-increment operator
     DcmHashDictIterator& operator++()
@@ -169,10 +192,31 @@ private:
      */
     void init(const DcmHashDict *d, OFBool atEnd = OFFalse);
 
+    /** initializes the iterator for the static hash tables and the hash dictionary
+     *  @param d pointer to hash dictionary, may be NULL
+     *  @param s pointer to list of static hash tables, may be NULL
+     *  @param atEnd if true, iterator points after last element
+     *   of hash dictionary, otherwise iterator points to first element
+     */
+    void init(const DcmHashDict *d, const OFVector<const DcmStaticHashDict *> *s, OFBool atEnd);
+
     /** implements increment operator on hash dictionary
      */
     void stepUp();
 
+    /** moves to the next entry of the static hash tables that is not replaced
+     *  by an entry of the hash dictionary (starting with the current one), or
+     *  to the first entry of the hash dictionary if there is none
+     */
+    void skipStaticEntries();
+
+    /// @return true if the iterator currently points into the static hash tables
+    OFBool isStatic() const
+        { return (staticDicts != NULL) && (sindex < staticDicts->size()); }
+
+    /// @return the current entry of the static hash tables
+    const DcmDictEntry* staticEntry() const;
+
     /// pointer to the hash dictionary this iterator traverses
     const DcmHashDict* dict;
 
@@ -184,6 +228,15 @@ private:
 
     /// iterator for traversing a bucket in the hash table
     DcmDictEntryListIterator iter;
+
+    /// pointer to the list of static hash tables traversed first, may be NULL
+    const OFVector<const DcmStaticHashDict *> *staticDicts;
+
+    /// index of current static hash table
+    size_t sindex;
+
+    /// index of current entry in the static hash table
+    unsigned int eindex;
 };
 
 
@@ -301,4 +354,153 @@ private:
 
 };
 
+
+/** plain data representation of a non-repeating dictionary entry, which can
+ *  be constant-initialized by the compiler. Used by the builtin data
+ *  dictionary that is generated by mkdictbi.
+ */
+struct DCMTK_DCMDATA_EXPORT DcmDictStaticEntry
+{
+    /// tag group
+    Uint16 group;
+    /// tag element
+    Uint16 element;
+    /// value representation
+    DcmEVR evr;
+    /// attribute name
+    const char *tagName;
+    /// lower limit for VM
+    int vmMin;
+    /// upper limit for VM
+    int vmMax;
+    /// standard version name
+    const char *standardVersion;
+    /// private creator name, NULL for standard tags
+    const char *privateCreator;
+};
+
+
+/** plain data description of a static hash table, which can be
+ *  constant-initialized by the compiler. Generated by mkdictbi for the
+ *  builtin data dictionary, see DcmStaticHashDict::getTable().
+ */
+struct DCMTK_DCMDATA_EXPORT DcmStaticHashDictData
+{
+    /// array of entries, in the order of the indices stored in the slot table
+    const DcmDictStaticEntry *entries;
+    /// number of entries
+    unsigned int entryCount;
+    /// array of displacement values, one per bucket
+    const Uint16 *displacements;
+    /// number of buckets
+    unsigned int bucketCount;
+    /// array of entry indices (EmptySlot for unused slots)
+    const Uint16 *slots;
+    /// number of slots
+    unsigned int slotCount;
+    /// pointer to the DcmStaticHashDict created on first use, NULL before
+    void * volatile table;
+};
+
+
+/** a read-only hash table of non-repeating dictionary entries that uses a
+ *  perfect hash function computed in advance by mkdictbi. The hash function
+ *  is stored in constant-initialized arrays, i.e.\ only the DcmDictEntry
+ *  objects are created (in a single block of memory) and a lookup requires
+ *  exactly two hash computations and one key comparison (plus a second lookup
+ *  for private tags that are not found with their exact element number). The
+ *  perfect hash function uses the "hash and displace" scheme: the keys are
+ *  first distributed into buckets, then a displacement value is selected for
+ *  each bucket so that all keys of the bucket are mapped to unused slots of
+ *  the table.
+ */
+class DCMTK_DCMDATA_EXPORT DcmStaticHashDict
+{
+public:
+
+    /// value of an unused slot in the slot table
+    static const Uint16 EmptySlot;
+
+    /** get the hash table for the given description, which is created on the
+     *  first call and never deleted. Since the description is initialized by
+     *  the compiler, this also works during the static initialization of other
+     *  objects. If atomic operations are available (see OFAtomic), concurrent
+     *  first calls are safe, otherwise they have to be serialized by the
+     *  caller (like GlobalDcmDataDictionary does).
+     *  @param data description of the hash table, the arrays must remain valid
+     *  @return pointer to the hash table, never NULL
+     */
+    static const DcmStaticHashDict *getTable(DcmStaticHashDictData &data);
+
+    /** constructor. Creates the DcmDictEntry objects for the entries of the
+     *  given description. The arrays must remain valid during the lifetime of
+     *  this object.
+     *  @param data description of the hash table
+     */
+    DcmStaticHashDict(const DcmStaticHashDictData &data);
+
+    /// destructor
+    ~DcmStaticHashDict();
+
+    /// @return the number of entries in this table
+    unsigned int size() const { return entryCount_; }
+
+    /** searches entry for the given tag and private creator
+     *  @param key tag key of the entry to be searched for
+     *  @param privCreator private creator name, may be NULL
+     *  @return pointer to found element, NULL if not found
+     */
+    const DcmDictEntry* get(const DcmTagKey& key, const char *privCreator) const;
+
+    /** searches entry for the given tag and private creator with an exact
+     *  match of the tag key, i.e.\ without considering private tags with
+     *  flexible element number
+     *  @param key tag key of the entry to be searched for
+     *  @param privCreator private creator name, may be NULL
+     *  @return pointer to found element, NULL if not found
+     */
+    const DcmDictEntry* findExact(const DcmTagKey& key, const char *privCreator) const;
+
+    /** get the entry with the given index (for iterating over all entries)
+     *  @param idx index of the entry, must be less than size()
+     *  @return reference to the entry
+     */
+    const DcmDictEntry& getEntry(const unsigned int idx) const;
+
+    /** compute the hash value used for the perfect hash function. The bucket
+     *  of a key is determined with seed 0, the slot with seed (displacement + 1).
+     *  @param key tag key
+     *  @param privCreator private creator name, may be NULL
+     *  @param seed seed value
+     *  @return hash value
+     */
+    static Uint32 hash(const DcmTagKey& key, const char *privCreator, const Uint32 seed);
+
+private:
+
+    /// private undefined copy constructor
+    DcmStaticHashDict(const DcmStaticHashDict &);
+
+    /// private undefined assignment operator
+    DcmStaticHashDict &operator=(const DcmStaticHashDict &);
+
+    /// array of dictionary entries
+    DcmDictEntry *entries_;
+
+    /// number of entries
+    unsigned int entryCount_;
+
+    /// array of displacement values
+    const Uint16 *displacements_;
+
+    /// number of buckets
+    unsigned int bucketCount_;
+
+    /// array of entry indices
+    const Uint16 *slots_;
+
+    /// number of slots
+    unsigned int slotCount_;
+};
+
 #endif /* DCHASHDI_H */
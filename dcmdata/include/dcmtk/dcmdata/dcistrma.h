@@ -29,6 +29,7 @@
 #include "dcmtk/dcmdata/dcxfer.h"   /* for E_StreamCompression */
 
 class DcmInputStream;
+class DcmMappedFile;
 
 /** pure virtual abstract base class for producers, i.e. the initial node 
  *  of a filter chain in an input stream.
@@ -87,6 +88,36 @@ public:
    */
   virtual void putback(offile_off_t num) = 0;
 
+  /** moves the read position back by the given number of bytes. Unlike
+   *  putback(), this is not limited to a putback buffer, but only supported
+   *  by producers that allow for random access (e.g. a file). If the
+   *  operation is not supported, the status of the producer is not changed.
+   *  The default implementation does not support random access.
+   *  @param num number of bytes to move back, must not exceed the number of
+   *    bytes read or skipped so far
+   *  @return OFTrue if successful, OFFalse if not supported or failed
+   */
+  virtual OFBool rewind(offile_off_t /* num */)
+  {
+    return OFFalse;
+  }
+
+  /** returns a pointer to the next bytes of the stream if the producer
+   *  keeps its complete content accessible in memory (e.g. a memory-mapped
+   *  file), so that the caller may reference the data instead of copying it.
+   *  The read position is not changed by this method. The default
+   *  implementation does not support direct access and returns NULL.
+   *  @param buflen number of bytes requested
+   *  @param mapping returns the mapped file the memory belongs to. The caller
+   *    has to increase its reference counter if the memory is referenced
+   *    beyond the lifetime of the producer.
+   *  @return pointer to at least buflen bytes of memory, NULL if not available
+   */
+  virtual Uint8 *mappedData(offile_off_t /* buflen */, DcmMappedFile *& /* mapping */)
+  {
+    return NULL;
+  }
+
 };
 
 
@@ -223,6 +254,26 @@ public:
    */
   virtual void putback();
 
+  /** moves the read position back by the given number of bytes if the
+   *  stream supports random access, see DcmProducer::rewind(). This is not
+   *  supported if a compression filter is installed. Unlike putback(), the
+   *  putback mark is not used and the stream status does not become bad if
+   *  the operation is not supported.
+   *  @param num number of bytes to move back, must not exceed tell()
+   *  @return OFTrue if successful, OFFalse otherwise
+   */
+  virtual OFBool rewind(offile_off_t num);
+
+  /** returns a pointer to the next bytes of the stream if the stream
+   *  content is accessible in memory (e.g. a memory-mapped file) and no
+   *  compression filter is installed. See DcmProducer::mappedData().
+   *  The read position is not changed by this method.
+   *  @param buflen number of bytes requested
+   *  @param mapping returns the mapped file the memory belongs to
+   *  @return pointer to at least buflen bytes of memory, NULL if not available
+   */
+  virtual Uint8 *mappedData(offile_off_t buflen, DcmMappedFile *&mapping);
+
 protected:
 
   /** protected constructor, to be called from derived class constructor
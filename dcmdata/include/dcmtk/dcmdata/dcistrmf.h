@@ -87,6 +87,12 @@ public:
    */
   virtual void putback(offile_off_t num);
 
+  /** moves the read position back by the given number of bytes.
+   *  @param num number of bytes to move back
+   *  @return OFTrue if successful, OFFalse otherwise
+   */
+  virtual OFBool rewind(offile_off_t num);
+
 private:
 
   /// private unimplemented copy constructor
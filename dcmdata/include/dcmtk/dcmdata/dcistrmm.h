@@ -0,0 +1,337 @@
+/*
+ *
+ *  Copyright (C) 2012, OFFIS e.V.
+ *  All rights reserved.  See COPYRIGHT file for details.
+ *
+ *  This software and supporting documentation were developed by
+ *
+ *    OFFIS e.V.
+ *    R&D Division Health
+ *    Escherweg 2
+ *    D-26121 Oldenburg, Germany
+ *
+ *
+ *  Module:  dcmdata
+ *
+ *  Author:  DCMTK team
+ *
+ *  Purpose: DcmInputMappedFileStream and related classes,
+ *    implements streamed input from memory-mapped files.
+ *
+ */
+
+#ifndef DCISTRMM_H
+#define DCISTRMM_H
+
+#include "dcmtk/config/osconfig.h"
+#include "dcmtk/dcmdata/dcistrma.h"
+#include "dcmtk/ofstd/ofthread.h"    /* for class OFMutex */
+
+
+/** class that maintains a (private, i.e. copy-on-write) memory mapping of a
+ *  complete file. It maintains a thread-safe reference counter, and when this
+ *  counter is decreased to zero, unmaps the file and deletes the object itself.
+ *  Since the mapping is private, the mapped memory may be modified without
+ *  affecting the file, e.g. when swapping the byte order of element values
+ *  that reference the mapping.
+ */
+class DCMTK_DCMDATA_EXPORT DcmMappedFile
+{
+public:
+
+  /** static method that permits creation of instances of
+   *  this class (only) on the heap, never on the stack.
+   *  A newly created instance always has a reference counter of 1.
+   *  @param filename name of file to be mapped (may contain wide chars
+   *    if support enabled)
+   *  @return pointer to new instance, never NULL. Use status() to check
+   *    whether the file could be mapped.
+   */
+  static DcmMappedFile *newInstance(const OFFilename &filename);
+
+  /** returns the status of the mapping.
+   *  @return status, EC_Normal if the file has been mapped successfully
+   */
+  OFCondition status() const
+  {
+    return status_;
+  }
+
+  /** returns a pointer to the mapped file content
+   *  @return pointer to mapped memory, NULL if the file is empty or not mapped
+   */
+  Uint8 *data() const
+  {
+    return data_;
+  }
+
+  /** returns the size of the mapped file content
+   *  @return number of bytes mapped
+   */
+  offile_off_t size() const
+  {
+    return size_;
+  }
+
+  /// increase reference counter for this object
+  void increaseRefCount();
+
+  /** decreases reference counter for this object and unmaps the file
+   *  and deletes this object if the reference counter becomes zero.
+   */
+  void decreaseRefCount();
+
+private:
+
+  /** private constructor.
+   *  Instances of this class are always created through newInstance().
+   *  @param filename name of file to be mapped
+   */
+  DcmMappedFile(const OFFilename &filename);
+
+  /** private destructor. Instances of this class
+   *  are always deleted through the reference counting methods
+   */
+  virtual ~DcmMappedFile();
+
+  /// private undefined copy constructor
+  DcmMappedFile(const DcmMappedFile& arg);
+
+  /// private undefined copy assignment operator
+  DcmMappedFile& operator=(const DcmMappedFile& arg);
+
+  /// pointer to mapped memory, NULL if not mapped
+  Uint8 *data_;
+
+  /// number of bytes mapped
+  offile_off_t size_;
+
+  /// status of the mapping
+  OFCondition status_;
+
+  /** number of references to this mapping.
+   *  Default initialized to 1 upon construction of this object
+   */
+  size_t refCount_;
+
+#ifdef WITH_THREADS
+  /// mutex for MT-safe reference counting
+  OFMutex mutex_;
+#endif
+};
+
+
+/** producer class that reads data from a memory-mapped file.
+ *  In addition to copying data with read(), the producer permits direct
+ *  access to the mapped memory, so that element values can reference the
+ *  file content instead of copying it.
+ */
+class DCMTK_DCMDATA_EXPORT DcmMappedFileProducer: public DcmProducer
+{
+public:
+  /** constructor, maps the given file
+   *  @param filename name of file to be mapped (may contain wide chars
+   *    if support enabled)
+   *  @param offset byte offset to skip from the start of file
+   */
+  DcmMappedFileProducer(const OFFilename &filename, offile_off_t offset = 0);
+
+  /** constructor, uses an existing mapping.
+   *  The reference counter of the mapping is increased by this operation.
+   *  @param mapping mapped file, must not be NULL
+   *  @param offset byte offset to skip from the start of file
+   */
+  DcmMappedFileProducer(DcmMappedFile *mapping, offile_off_t offset = 0);
+
+  /// destructor, decreases reference counter of the mapping
+  virtual ~DcmMappedFileProducer();
+
+  /** returns the status of the producer. Unless the status is good,
+   *  the producer will not permit any operation.
+   *  @return status, true if good
+   */
+  virtual OFBool good() const;
+
+  /** returns the status of the producer as an OFCondition object.
+   *  Unless the status is good, the producer will not permit any operation.
+   *  @return status, EC_Normal if good
+   */
+  virtual OFCondition status() const;
+
+  /** returns true if the producer is at the end of stream.
+   *  @return true if end of stream, false otherwise
+   */
+  virtual OFBool eos();
+
+  /** returns the minimum number of bytes that can be read with the
+   *  next call to read(). The DcmObject read methods rely on avail
+   *  to return a value > 0 if there is no I/O suspension since certain
+   *  data such as tag and length are only read "en bloc", i.e. all
+   *  or nothing.
+   *  @return minimum of data available in producer
+   */
+  virtual offile_off_t avail();
+
+  /** reads as many bytes as possible into the given block.
+   *  @param buf pointer to memory block, must not be NULL
+   *  @param buflen length of memory block
+   *  @return number of bytes actually read.
+   */
+  virtual offile_off_t read(void *buf, offile_off_t buflen);
+
+  /** skips over the given number of bytes (or less)
+   *  @param skiplen number of bytes to skip
+   *  @return number of bytes actually skipped.
+   */
+  virtual offile_off_t skip(offile_off_t skiplen);
+
+  /** resets the stream to the position by the given number of bytes.
+   *  @param num number of bytes to putback. If the putback operation
+   *    fails, the producer status becomes bad.
+   */
+  virtual void putback(offile_off_t num);
+
+  /** moves the read position back by the given number of bytes.
+   *  @param num number of bytes to move back
+   *  @return OFTrue if successful, OFFalse otherwise
+   */
+  virtual OFBool rewind(offile_off_t num);
+
+  /** returns a pointer to the mapped memory at the current read position
+   *  if at least the given number of bytes is available.
+   *  The read position is not changed by this method.
+   *  @param buflen number of bytes requested
+   *  @param mapping returns the mapped file the memory belongs to
+   *  @return pointer to mapped memory, NULL if not available
+   */
+  virtual Uint8 *mappedData(offile_off_t buflen, DcmMappedFile *&mapping);
+
+  /** returns the mapped file this producer reads from
+   *  @return pointer to mapped file, never NULL
+   */
+  DcmMappedFile *mapping() const
+  {
+    return mapping_;
+  }
+
+  /** returns the current read position, i.e. the offset from the start of file
+   *  @return current read position
+   */
+  offile_off_t tell() const
+  {
+    return pos_;
+  }
+
+private:
+
+  /// private unimplemented copy constructor
+  DcmMappedFileProducer(const DcmMappedFileProducer&);
+
+  /// private unimplemented copy assignment operator
+  DcmMappedFileProducer& operator=(const DcmMappedFileProducer&);
+
+  /// the mapped file we're actually reading from
+  DcmMappedFile *mapping_;
+
+  /// status
+  OFCondition status_;
+
+  /// current read position
+  offile_off_t pos_;
+};
+
+
+/** input stream factory for memory-mapped files
+ */
+class DCMTK_DCMDATA_EXPORT DcmInputMappedFileStreamFactory: public DcmInputStreamFactory
+{
+public:
+
+  /** constructor
+   *  @param mapping mapped file, must not be NULL.
+   *    Reference counter of the mapping is increased by this operation.
+   *  @param offset byte offset to skip from the start of file
+   */
+  DcmInputMappedFileStreamFactory(DcmMappedFile *mapping, offile_off_t offset);
+
+  /// copy constructor
+  DcmInputMappedFileStreamFactory(const DcmInputMappedFileStreamFactory &arg);
+
+  /// destructor, decreases reference counter of the mapping
+  virtual ~DcmInputMappedFileStreamFactory();
+
+  /** create a new input stream object
+   *  @return pointer to new input stream object
+   */
+  virtual DcmInputStream *create() const;
+
+  /** returns a pointer to a copy of this object
+   */
+  virtual DcmInputStreamFactory *clone() const
+  {
+    return new DcmInputMappedFileStreamFactory(*this);
+  }
+
+private:
+
+  /// private unimplemented copy assignment operator
+  DcmInputMappedFileStreamFactory& operator=(const DcmInputMappedFileStreamFactory&);
+
+  /// mapped file
+  DcmMappedFile *mapping_;
+
+  /// offset in file
+  offile_off_t offset_;
+};
+
+
+/** input stream that reads from a memory-mapped file.
+ *  Large element values (e.g. uncompressed pixel data) read from this
+ *  stream reference the mapped file content until they are modified,
+ *  i.e. they are neither copied nor allocated on the heap.
+ */
+class DCMTK_DCMDATA_EXPORT DcmInputMappedFileStream: public DcmInputStream
+{
+public:
+  /** constructor
+   *  @param filename name of file to be mapped (may contain wide chars
+   *    if support enabled)
+   *  @param offset byte offset to skip from the start of file
+   */
+  DcmInputMappedFileStream(const OFFilename &filename, offile_off_t offset = 0);
+
+  /** constructor
+   *  @param mapping mapped file, must not be NULL.
+   *    Reference counter of the mapping is increased by this operation.
+   *  @param offset byte offset to skip from the start of file
+   */
+  DcmInputMappedFileStream(DcmMappedFile *mapping, offile_off_t offset = 0);
+
+  /// destructor
+  virtual ~DcmInputMappedFileStream();
+
+  /** creates a new factory object for the current stream
+   *  and stream position.  When activated, the factory will be
+   *  able to create new DcmInputStream delivering the same
+   *  data as the current stream.  Used to defer loading of
+   *  value fields until accessed.
+   *  If no factory object can be created (e.g. because a
+   *  compression filter is installed), returns NULL.
+   *  @return pointer to new factory object if successful, NULL otherwise.
+   */
+  virtual DcmInputStreamFactory *newFactory() const;
+
+private:
+
+  /// private unimplemented copy constructor
+  DcmInputMappedFileStream(const DcmInputMappedFileStream&);
+
+  /// private unimplemented copy assignment operator
+  DcmInputMappedFileStream& operator=(const DcmInputMappedFileStream&);
+
+  /// the final producer of the filter chain
+  DcmMappedFileProducer producer_;
+};
+
+
+#endif
@@ -584,6 +584,27 @@ class DCMTK_DCMDATA_EXPORT DcmItem
                                  Uint32 &length,
                                  const OFBool searchIntoSub = OFFalse);
 
+    /** find element and get a particular value as a reference to a C string. NB: The string is not copied!
+     *  Applicable to the following VRs: AE, AS, CS, DA, DS, DT, IS, LO, LT, PN, SH, ST, TM, UI, UT
+     *  Since the getStringView() routine is called internally the resulting string reference is
+     *  normalized, i.e. leading and/or trailing spaces are excluded according to the associated value
+     *  representation (like for findAndGetOFString()).  Since the referenced value is usually not
+     *  terminated by a NULL byte, the returned length has always to be taken into account.
+     *  The result variable 'value' is automatically set to NULL and 'length' is set to 0 if an error
+     *  occurs.
+     *  @param tagKey DICOM tag specifying the attribute to be searched for
+     *  @param value variable in which the reference to the element value is stored (might be NULL)
+     *  @param length length of the referenced value (number of characters)
+     *  @param pos index of the value in case of multi-valued elements (0..vm-1)
+     *  @param searchIntoSub flag indicating whether to search into sequences or not
+     *  @return EC_Normal upon success, an error code otherwise.
+     */
+    OFCondition findAndGetStringView(const DcmTagKey &tagKey,
+                                     const char *&value,
+                                     Uint32 &length,
+                                     const unsigned long pos = 0,
+                                     const OFBool searchIntoSub = OFFalse);
+
     /** find element and get value as a C++ string (only one component).
      *  Applicable to the following VRs: AE, AS, AT, CS, DA, DS, DT, FL, FD, IS, LO, LT, OB, OF, OW,
      *  PN, SH, SL, SS, ST, TM, UI, UL, US, UT
@@ -1099,7 +1120,7 @@ class DCMTK_DCMDATA_EXPORT DcmItem
                                     const OFBool replaceOld = OFTrue);
 
     /** create a new element, put specified value to it and insert the element into the dataset/item.
-     *  Applicable to the following VRs: FD
+     *  Applicable to the following VRs: DS, FD
      *  @param tag DICOM tag specifying the attribute to be created
      *  @param value value to be set for the new element
      *  @param count number of values (not bytes!) to be copied from 'value'
@@ -1172,6 +1193,11 @@ class DCMTK_DCMDATA_EXPORT DcmItem
 
   protected:
 
+    /** invalidate the cached length of this item and of all items and
+     *  sequences that contain this item
+     */
+    virtual void invalidateLengthCache();
+
     /** This function reads tag and length information from inStream and
      *  returns this information to the caller. When reading information,
      *  the transfer syntax which was passed is accounted for. If the
@@ -1283,6 +1309,18 @@ class DCMTK_DCMDATA_EXPORT DcmItem
 
     /// cache for private creator tags and names
     DcmPrivateTagCache privateCreatorCache;
+
+    /// length computed by the last call of getLength(), valid if lengthCacheValid is set
+    Uint32 cachedLength;
+
+    /// transfer syntax for which cachedLength has been computed
+    E_TransferSyntax cachedLengthXfer;
+
+    /// encoding type for which cachedLength has been computed
+    E_EncodingType cachedLengthEncType;
+
+    /// OFTrue if cachedLength is up-to-date, i.e. no element has been modified since
+    OFBool lengthCacheValid;
 };
 
 //
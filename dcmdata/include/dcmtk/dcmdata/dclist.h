@@ -26,6 +26,7 @@
 
 #include "dcmtk/ofstd/ofcast.h"
 #include "dcmtk/ofstd/oftypes.h"
+#include "dcmtk/ofstd/ofvector.h"
 
 #define INCLUDE_CSTDDEF
 #define INCLUDE_CSTDLIB
@@ -93,7 +94,13 @@ typedef enum
 
 /** double-linked list class that maintains pointers to DcmObject instances.
  *  The remove operation does not delete the object pointed to, however,
- *  the destructor will delete all elements pointed to
+ *  the destructor will delete all elements pointed to.
+ *  Optionally, the list maintains an index of all list nodes sorted by the tag
+ *  of the objects pointed to. This index allows for finding an object by its
+ *  tag in logarithmic time (instead of walking through the list), which is
+ *  useful for lists that are sorted by tag anyway (e.g. the elements of an item).
+ *  Please note that the index is only updated when the list is modified, i.e.
+ *  the tag of an object must not be changed while it is contained in the list.
  */
 class DCMTK_DCMDATA_EXPORT DcmList 
 {
@@ -155,6 +162,29 @@ public:
      */  
     void deleteAllElements();
 
+    /** seek within list to the object with the given tag (i.e. set current
+     *  element to this object). The list is expected to be sorted by tag in
+     *  ascending order. If the tag index is enabled, a binary search is
+     *  performed, otherwise the list is walked backwards starting at the end.
+     *  If the object is not found, the current element remains unchanged.
+     *  @param tag tag of the object to be searched for
+     *  @param orPredecessor if OFTrue and no object with the given tag exists,
+     *    seek to the last object with a smaller tag instead (if any). This is
+     *    the position after which an object with the given tag is to be inserted.
+     *  @return pointer to new current object, NULL if not found
+     */
+    DcmObject *seek_tag(const DcmTagKey &tag,
+                        const OFBool orPredecessor = OFFalse);
+
+    /** enable or disable the tag index for this list. Enabling the index
+     *  for a non-empty list creates the index from the current list content.
+     *  @param enable enable tag index if OFTrue, disable (and free) it otherwise
+     */
+    void setTagIndex(const OFBool enable);
+
+    /// return true if the tag index is enabled, false otherwise
+    inline OFBool hasTagIndex() const { return useTagIndex; }
+
     /// return cardinality of list
     inline unsigned long card() const { return cardinality; }
 
@@ -176,6 +206,29 @@ private:
 
     /// number of elements in list
     unsigned long cardinality;
+
+    /// flag indicating whether the tag index is enabled
+    OFBool useTagIndex;
+
+    /// list nodes sorted by the tag of the objects pointed to (if enabled)
+    OFVector<DcmListNode *> tagIndex;
+
+    /** determine the first position in the tag index whose tag is not less
+     *  than the given tag (lower bound)
+     *  @param tag tag to be searched for
+     *  @return index position, equals the size of the index if not found
+     */
+    size_t lowerBoundInIndex(const DcmTagKey &tag) const;
+
+    /** add given node to the tag index (if enabled)
+     *  @param node list node to be added
+     */
+    void addToIndex(DcmListNode *node);
+
+    /** remove given node from the tag index (if enabled)
+     *  @param node list node to be removed
+     */
+    void removeFromIndex(DcmListNode *node);
  
     /// private undefined copy constructor 
     DcmList &operator=(const DcmList &);
@@ -183,6 +183,25 @@ extern DCMTK_DCMDATA_EXPORT OFGlobal<OFBool> dcmIgnoreFileMetaInformationGroupLe
  */
 extern DCMTK_DCMDATA_EXPORT OFGlobal<OFBool> dcmReplaceWrongDelimitationItem; /* default OFFalse */
 
+/** This flag defines whether newly created items and datasets maintain an index
+ *  of their elements sorted by tag. The index allows for finding (and inserting)
+ *  an element in logarithmic time instead of walking through the list of all
+ *  elements, which speeds up access to datasets with many elements (e.g. enhanced
+ *  multi-frame images). The flag is evaluated when an item is created, so changing
+ *  it does not affect existing items. Default is enabled.
+ */
+extern DCMTK_DCMDATA_EXPORT OFGlobal<OFBool> dcmEnableTagIndex; /* default OFTrue */
+
+/** This flag defines whether the loadFile() methods of DcmFileFormat and
+ *  DcmDataset map the file into memory (see DcmInputMappedFileStream) instead
+ *  of reading it with buffered file I/O. In this case, OB and OW element values
+ *  (e.g. uncompressed pixel data) reference the mapped file content until they
+ *  are modified, i.e. they are not copied. If the file cannot be mapped (e.g.
+ *  because it is too large for the address space), normal file I/O is used.
+ *  Default is disabled.
+ */
+extern DCMTK_DCMDATA_EXPORT OFGlobal<OFBool> dcmUseMemoryMappedFiles; /* default OFFalse */
+
 
 /** Abstract base class for most classes in module dcmdata. As a rule of thumb,
  *  everything that is either a dataset or that can be identified with a DICOM
@@ -658,10 +677,17 @@ class DCMTK_DCMDATA_EXPORT DcmObject
      */
     const char *getTagName() { return Tag.getTagName(); }
 
-    /** set the VR for this attribute
+    /** set the VR for this attribute. Since the VR determines the size of the
+     *  attribute header, the cached lengths of the surrounding items and
+     *  sequences are invalidated if the VR changes.
      *  @param vr new VR for this attribute.
      */
-    void setTagVR(DcmEVR vr) { Tag.setVR(vr); }
+    void setTagVR(DcmEVR vr)
+    {
+        if ((Parent != NULL) && (vr != Tag.getEVR()))
+            Parent->invalidateLengthCache();
+        Tag.setVR(vr);
+    }
 
     /** return the current transfer state of this object during serialization/deserialization
      *  @return current transfer state of this object
@@ -688,10 +714,26 @@ class DCMTK_DCMDATA_EXPORT DcmObject
      */
     void incTransferredBytes(Uint32 val) { fTransferredBytes += val; }
 
-    /** set the current value of the Length field
+    /** set the current value of the Length field. If the length of a leaf
+     *  element changes, the cached lengths of the surrounding items and
+     *  sequences are invalidated (see invalidateLengthCache()).
      *  @param val new value of the Length field
      */
-    void setLengthField(Uint32 val) { Length = val; }
+    void setLengthField(Uint32 val)
+    {
+        if ((val != Length) && (Parent != NULL) && isLeaf())
+            Parent->invalidateLengthCache();
+        Length = val;
+    }
+
+    /** invalidate the cached length of this object (if any) and of all items
+     *  and sequences that contain this object. Items and sequences cache the
+     *  result of getLength() since it is needed on each nesting level when
+     *  writing with explicit length. This method is called whenever the
+     *  length of an object might have changed, e.g. when a value is modified
+     *  or an element is inserted or removed.
+     */
+    virtual void invalidateLengthCache();
 
  public:
 
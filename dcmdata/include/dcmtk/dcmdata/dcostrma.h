@@ -172,6 +172,19 @@ public:
    */
   virtual OFCondition installCompressionFilter(E_StreamCompression filterType);
 
+  /** sets the parameters of the compression filter that is installed by a
+   *  subsequent call of installCompressionFilter(), e.g. when a dataset is
+   *  written to this stream in a deflated transfer syntax. If not called,
+   *  the global settings dcmZlibCompressionLevel, dcmZlibCompressionStrategy
+   *  and dcmZlibCompressionThreads are used.
+   *  @param compressionLevel zlib compression level, 0..9 or -1 for default
+   *  @param compressionStrategy zlib compression strategy, 0 for default
+   *  @param numberOfThreads number of threads used for compression
+   */
+  virtual void setCompressionParameters(const int compressionLevel,
+                                        const int compressionStrategy,
+                                        const Uint32 numberOfThreads = 1);
+
 protected:
 
   /** protected constructor, to be called from derived class constructor
@@ -198,6 +211,18 @@ private:
 
   /// counter for number of bytes written so far
   offile_off_t tell_;
+
+  /// true if the compression parameters have been set for this stream
+  OFBool hasCompressionParameters_;
+
+  /// compression level for the compression filter
+  int compressionLevel_;
+
+  /// compression strategy for the compression filter
+  int compressionStrategy_;
+
+  /// number of threads for the compression filter
+  Uint32 compressionThreads_;
 };
 
 
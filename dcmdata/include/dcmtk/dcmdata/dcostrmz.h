@@ -38,15 +38,46 @@ END_EXTERN_C
  */
 extern DCMTK_DCMDATA_EXPORT OFGlobal<int> dcmZlibCompressionLevel;
 
+/** global flag defining the compression strategy for zlib (deflate) compression,
+ *  i.e. one of Z_DEFAULT_STRATEGY, Z_FILTERED, Z_HUFFMAN_ONLY, Z_RLE or Z_FIXED.
+ *  Default is Z_DEFAULT_STRATEGY.
+ */
+extern DCMTK_DCMDATA_EXPORT OFGlobal<int> dcmZlibCompressionStrategy;
+
+/** global flag defining the number of threads used for zlib (deflate) compression.
+ *  If greater than 1, the data is split into blocks of 128 kbytes that are compressed
+ *  independently on multiple threads and then combined into a single deflate bitstream.
+ *  This requires thread support, otherwise a single thread is always used.
+ *  Default is 1, i.e. the data is compressed as a single deflate stream.
+ */
+extern DCMTK_DCMDATA_EXPORT OFGlobal<Uint32> dcmZlibCompressionThreads;
+
+struct DcmZLibBlock;
+class OFThreadPool;
+
 /** zlib compression filter for output streams
  */
 class DCMTK_DCMDATA_EXPORT DcmZLibOutputFilter: public DcmOutputFilter
 {
 public:
 
-  /// default constructor
+  /** default constructor.
+   *  Uses the global settings dcmZlibCompressionLevel, dcmZlibCompressionStrategy
+   *  and dcmZlibCompressionThreads.
+   */
   DcmZLibOutputFilter();
 
+  /** constructor
+   *  @param compressionLevel compression level, 0..9 or Z_DEFAULT_COMPRESSION
+   *  @param compressionStrategy compression strategy, e.g. Z_DEFAULT_STRATEGY or Z_FILTERED
+   *  @param numberOfThreads number of threads used for compression. If greater than 1,
+   *    blocks of the data are compressed in parallel (see dcmZlibCompressionThreads).
+   *    The compressed bitstream is slightly larger than with a single thread.
+   */
+  DcmZLibOutputFilter(const int compressionLevel,
+                      const int compressionStrategy,
+                      const Uint32 numberOfThreads = 1);
+
   /// destructor
   virtual ~DcmZLibOutputFilter();
 
@@ -108,6 +139,33 @@ private:
   /// private unimplemented copy assignment operator
   DcmZLibOutputFilter& operator=(const DcmZLibOutputFilter&);
 
+  /** initializes the compression codec(s), called by the constructors
+   *  @param compressionLevel compression level
+   *  @param compressionStrategy compression strategy
+   *  @param numberOfThreads number of threads used for compression
+   */
+  void init(const int compressionLevel,
+            const int compressionStrategy,
+            Uint32 numberOfThreads);
+
+  /** compresses the content of the block input buffer in parallel,
+   *  one block per thread, and appends the result to the pending output.
+   *  @param finalize true if the content of the block input buffer
+   *    constitutes the end of the input stream
+   */
+  void compressBlocks(OFBool finalize);
+
+  /** appends the given data to the pending output of the parallel compression
+   *  @param buf pointer to compressed data
+   *  @param buflen number of bytes in buf
+   */
+  void appendPendingOutput(const unsigned char *buf, size_t buflen);
+
+  /** writes the pending output of the parallel compression to the next
+   *  filter stage until it becomes empty or the next filter stage becomes full
+   */
+  void flushPendingOutput();
+
   /** writes the content of the output ring buffer
    *  to the next filter stage until the output ring buffer
    *  becomes empty or the next filter stage becomes full
@@ -173,6 +231,39 @@ private:
   /// number of bytes in output ring buffer
   offile_off_t outputBufCount_;
 
+  /// number of blocks compressed in parallel, 0 if a single zlib stream is used
+  Uint32 numberOfBlocks_;
+
+  /// compression codecs, input and output buffers of the blocks, NULL if not parallel
+  DcmZLibBlock *blocks_;
+
+  /// threads compressing the blocks, started once for the lifetime of the filter, NULL if not parallel
+  OFThreadPool *threadPool_;
+
+  /// input buffer for all blocks compressed in parallel
+  unsigned char *blockInputBuf_;
+
+  /// number of bytes in block input buffer
+  size_t blockInputCount_;
+
+  /// last bytes of the input preceding the block input buffer, used as dictionary
+  unsigned char *dictionary_;
+
+  /// number of bytes in dictionary
+  size_t dictionaryLength_;
+
+  /// compressed output of the blocks that has not yet been written
+  unsigned char *pendingBuf_;
+
+  /// size of the pending output buffer
+  size_t pendingBufSize_;
+
+  /// offset of first byte in pending output buffer
+  size_t pendingBufStart_;
+
+  /// number of bytes in pending output buffer
+  size_t pendingBufCount_;
+
 };
 
 #endif
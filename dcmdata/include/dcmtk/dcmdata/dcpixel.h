@@ -556,6 +556,9 @@ public:
     /** access single frame without decompressing or loading a complete
      *  multi-frame object. The frame is copied into the buffer passed by the caller
      *  which must be large enough to contain a complete frame.
+     *  For uncompressed pixel data that has not been loaded into memory, only the
+     *  byte range of the requested frame is read from file (see getPartialValue()),
+     *  so the memory needed does not depend on the number of frames.
      *  @param dataset pointer to DICOM dataset in which this pixel data object is
      *    located. Used to access rows, columns, samples per pixel etc.
      *  @param frameNo number of frame, starting with 0 for the first frame.
@@ -563,12 +566,13 @@ public:
      *    all or the first part of the compressed bitstream for the given frameNo.
      *    Upon successful return this parameter is updated to contain the index
      *    of the first compressed fragment of the next frame.
-     *    When unknown, zero should be passed. In this case the decompression
-     *    algorithm will try to determine the index by itself, which will always
-     *    work if frames are decompressed in increasing order from first to last,
-     *    but may fail if frames are decompressed in random order, multiple fragments
-     *    per frame and multiple frames are present in the dataset, and the offset
-     *    table is empty.
+     *    When unknown, zero should be passed. In this case the index is taken
+     *    from the frame index cached by the pixel sequence (see
+     *    DcmPixelSequence::createFrameIndex()), which is created from the basic
+     *    offset table, the Extended Offset Table (if present in the given dataset)
+     *    or the JPEG markers of the fragments. This may only fail if frames are
+     *    decompressed in random order, multiple fragments per frame and multiple
+     *    frames are present in the dataset, and none of these sources is usable.
      *  @param buffer pointer to buffer allocated by the caller. The buffer
      *    must be large enough for one frame of this image.
      *  @param bufSize size of buffer, in bytes. This number must be even so
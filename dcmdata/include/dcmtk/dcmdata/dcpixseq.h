@@ -27,6 +27,7 @@
 
 #include "dcmtk/dcmdata/dcsequen.h"
 #include "dcmtk/dcmdata/dcofsetl.h"   /* for class DcmOffsetList */
+#include "dcmtk/ofstd/ofvector.h"
 
 class DcmPixelItem;
 
@@ -227,8 +228,62 @@ public:
                                              Uint32 compressedLen,
                                              Uint32 fragmentSize);
 
+    /** determine the index of the first pixel item (fragment) of each frame
+     *  and cache it, so that subsequent accesses to arbitrary frames do not
+     *  require scanning the pixel items again. The index is determined from
+     *  the first of the following sources that is applicable:
+     *  - a single frame or one fragment per frame
+     *  - the given extended offset table (with one 64 bit offset per frame)
+     *  - the basic offset table (the first pixel item)
+     *  - a scan of the fragments for JPEG (SOI) and JPEG 2000 (SOC) markers,
+     *    which only reads the first two bytes of each fragment
+     *  The cached index is discarded whenever a pixel item is inserted,
+     *  removed or changes its length. If the index cannot be determined,
+     *  this is also remembered until the pixel sequence changes (unless an
+     *  extended offset table is passed to a subsequent call).
+     *  @param numberOfFrames number of frames of the image, must be > 0
+     *  @param extendedOffsetTable value of the Extended Offset Table (7FE0,0001)
+     *    in little endian byte order, NULL if not present
+     *  @param extendedOffsetTableLength length of the extended offset table in bytes
+     *  @return EC_Normal if successful, EC_TagNotFound if the fragments of the
+     *    frames cannot be determined, another error code otherwise
+     */
+    OFCondition createFrameIndex(const Uint32 numberOfFrames,
+                                 const Uint8 *extendedOffsetTable = NULL,
+                                 const Uint32 extendedOffsetTableLength = 0);
+
+    /** determine the index of the first pixel item (fragment) of the given
+     *  frame, see createFrameIndex() for details.  The first frame always
+     *  starts with the first fragment, so no frame index is needed for it.
+     *  @param frameNo frame number, starting with 0
+     *  @param numberOfFrames number of frames of the image, must be > 0
+     *  @param startFragment index of the first pixel item of the frame
+     *    (starting with 1, since the basic offset table is index 0) returned
+     *    in this parameter on success
+     *  @return EC_Normal if successful, an error code otherwise
+     */
+    OFCondition getFrameStartFragment(const Uint32 frameNo,
+                                      const Uint32 numberOfFrames,
+                                      Uint32 &startFragment);
+
+    /** determine the index of the first pixel item (fragment) of all frames,
+     *  see createFrameIndex() for details
+     *  @param numberOfFrames number of frames of the image, must be > 0
+     *  @param startFragments index of the first pixel item of each frame
+     *    returned in this parameter on success, followed by the total number
+     *    of pixel items (i.e.\ numberOfFrames + 1 entries)
+     *  @return EC_Normal if successful, an error code otherwise
+     */
+    OFCondition getFrameFragments(const Uint32 numberOfFrames,
+                                  OFVector<Uint32> &startFragments);
+
 protected:
 
+    /** invalidate the cached length and the cached frame index of this
+     *  pixel sequence, see createFrameIndex()
+     */
+    virtual void invalidateLengthCache();
+
     /** helper function for read(). Create sub-object (pixel item) of the
      *  appropriate type depending on the tag.
      *  @param newObject upon success, a pointer to the newly created object is returned in this parameter
@@ -247,6 +302,12 @@ private:
      */
     E_TransferSyntax Xfer;
 
+    /// index of the first pixel item of each frame, followed by the number of pixel items
+    OFVector<Uint32> frameIndex;
+
+    /// number of frames for which frameIndex has been determined (empty if not possible), 0 if none
+    Uint32 frameIndexFrames;
+
     /// method inherited from base class that is useless in this class
     virtual OFCondition insert(DcmItem* /*item*/,
                                unsigned long /*where*/ = DCM_EndOfListIndex,
@@ -543,6 +543,11 @@ protected:
                                           DcmStack &resultStack,              // inout
                                           const OFBool searchIntoSub);        // in
 
+    /** invalidate the cached length of this sequence and of all items and
+     *  sequences that contain this sequence
+     */
+    virtual void invalidateLengthCache();
+
     /// the list of items maintained by this sequence object
     DcmList *itemList;
 
@@ -579,6 +584,18 @@ private:
      */
     OFBool readAsUN_;
 
+    /// length computed by the last call of getLength(), valid if lengthCacheValid is set
+    Uint32 cachedLength;
+
+    /// transfer syntax for which cachedLength has been computed
+    E_TransferSyntax cachedLengthXfer;
+
+    /// encoding type for which cachedLength has been computed
+    E_EncodingType cachedLengthEncType;
+
+    /// OFTrue if cachedLength is up-to-date, i.e. no item has been modified since
+    OFBool lengthCacheValid;
+
 };
 
 
@@ -26,6 +26,7 @@
 #include "dcmtk/config/osconfig.h"
 
 #include "dcmtk/ofstd/ofchrenc.h"
+#include "dcmtk/ofstd/oflist.h"
 #include "dcmtk/ofstd/ofmap.h"
 #include "dcmtk/dcmdata/dcdefine.h"
 
@@ -37,9 +38,17 @@ class DcmItem;
 /** A class for managing and converting between different DICOM character sets.
  *  The conversion relies on the OFCharacterEncoding class, which again relies
  *  on the libiconv toolkit (if available).
+ *  The conversion descriptors used by this class are not closed when they are
+ *  no longer needed, but kept in a process-wide cache, so they can be reused
+ *  by other instances of this class (e.g. when converting the next dataset).
+ *  Strings that only consist of ASCII characters are not passed to libiconv
+ *  if both the source and the destination character set are compatible with
+ *  ASCII (e.g. ISO 8859-x and UTF-8).
  */
 class DCMTK_DCMDATA_EXPORT DcmSpecificCharacterSet
 {
+    // allow the process-wide cache of conversion descriptors to access protected types
+    friend class DcmDescriptorCache;
 
   public:
 
@@ -199,6 +208,21 @@ class DCMTK_DCMDATA_EXPORT DcmSpecificCharacterSet
                               OFString &toString,
                               const OFString &delimiters = "");
 
+    /** check whether the given string would be changed by convertString().
+     *  A string is never changed if it only consists of ASCII characters
+     *  (without escape sequences) and both of the currently selected character
+     *  sets are compatible with ASCII.  This check is much faster than the
+     *  conversion, so it can be used to skip the conversion of most element
+     *  values, e.g. when converting a complete dataset.
+     *  @param  fromString  input string to be checked
+     *  @param  fromLength  length of the input string (number of bytes without
+     *                      the trailing NULL byte)
+     *  @return OFTrue if the string has to be converted (or if no character
+     *    sets are selected), OFFalse if the conversion can be skipped
+     */
+    OFBool isConversionNeeded(const char *fromString,
+                              const size_t fromLength) const;
+
     // --- static helper functions ---
 
     /** check whether the underlying character set conversion library is
@@ -218,6 +242,13 @@ class DCMTK_DCMDATA_EXPORT DcmSpecificCharacterSet
      */
     static size_t countCharactersInUTF8String(const OFString &utf8String);
 
+    /** close all conversion descriptors in the process-wide cache that are
+     *  currently not used by any instance of this class.  Usually, there is
+     *  no need to call this function since the cache is cleared automatically
+     *  on program termination.
+     */
+    static void clearDescriptorCache();
+
 
   protected:
 
@@ -225,6 +256,13 @@ class DCMTK_DCMDATA_EXPORT DcmSpecificCharacterSet
     /// set and the associated conversion descriptor
     typedef OFMap<OFString, OFCharacterEncoding::T_Descriptor> T_DescriptorMap;
 
+    /// type definition of a list entry storing the name of a character encoding
+    /// (or another identifier) and the associated conversion descriptor
+    typedef OFPair<OFString, OFCharacterEncoding::T_Descriptor> T_DescriptorEntry;
+
+    /// type definition of a list of conversion descriptors
+    typedef OFList<T_DescriptorEntry> T_DescriptorList;
+
     /** determine the destination character encoding (as used by libiconv) from
      *  the given DICOM defined term (specific character set), and set the
      *  member variables accordingly.
@@ -253,6 +291,18 @@ class DCMTK_DCMDATA_EXPORT DcmSpecificCharacterSet
      */
     OFCondition selectCharacterSetWithCodeExtensions(const unsigned long sourceVM);
 
+    /** open a conversion descriptor from the given character encoding to the
+     *  destination encoding.  If available, a descriptor from the process-wide
+     *  cache is reused.  The descriptor is closed (i.e. returned to the cache)
+     *  by closeConversionDescriptors().
+     *  @param  descriptor    reference to variable where the descriptor is stored
+     *  @param  fromEncoding  name of the source character encoding (as used by
+     *                        the libiconv toolkit)
+     *  @return status, EC_Normal if successful, an error code otherwise
+     */
+    OFCondition openConversionDescriptor(OFCharacterEncoding::T_Descriptor &descriptor,
+                                         const OFString &fromEncoding);
+
     /** close any currently open character set conversion descriptor(s).
      *  Afterwards, no conversion descriptor is selected, pretty much like
      *  after the initialization with the constructor.
@@ -304,6 +354,14 @@ class DCMTK_DCMDATA_EXPORT DcmSpecificCharacterSet
     /// map of character set conversion descriptors
     /// (only used if multiple character sets are needed)
     T_DescriptorMap ConversionDescriptors;
+
+    /// list of all conversion descriptors opened by openConversionDescriptor(),
+    /// together with the name of the source encoding
+    T_DescriptorList OpenDescriptors;
+
+    /// OFTrue if ASCII characters are not changed by the conversion, i.e. both
+    /// the default source and the destination character set are compatible with ASCII
+    OFBool KeepASCIICharacters;
 };
 
 
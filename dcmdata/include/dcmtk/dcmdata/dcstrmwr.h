@@ -0,0 +1,342 @@
+/*
+ *
+ *  Copyright (C) 2012, OFFIS e.V.
+ *  All rights reserved.  See COPYRIGHT file for details.
+ *
+ *  This software and supporting documentation were developed by
+ *
+ *    OFFIS e.V.
+ *    R&D Division Health
+ *    Escherweg 2
+ *    D-26121 Oldenburg, Germany
+ *
+ *
+ *  Module:  dcmdata
+ *
+ *  Author:  DCMTK team
+ *
+ *  Purpose: Interface of class DcmStreamWriter
+ *
+ */
+
+#ifndef DCSTRMWR_H
+#define DCSTRMWR_H
+
+#include "dcmtk/config/osconfig.h"    /* make sure OS specific configuration is included first */
+
+#include "dcmtk/ofstd/offile.h"       /* for class OFFilename */
+#include "dcmtk/ofstd/ofvector.h"
+#include "dcmtk/dcmdata/dctagkey.h"
+#include "dcmtk/dcmdata/dcxfer.h"
+#include "dcmtk/dcmdata/dcerror.h"
+#include "dcmtk/dcmdata/dctypes.h"
+#include "dcmtk/dcmdata/dcwcache.h"
+
+class DcmOutputStream;
+class DcmObject;
+class DcmElement;
+class DcmItem;
+
+
+/** class that writes a DICOM file or dataset incrementally, i.e.\ without
+ *  creating the complete dataset in memory first. The caller emits the data
+ *  elements in ascending tag order; sequences and items are opened and closed
+ *  explicitly and are always encoded with undefined length, so no length has
+ *  to be computed in advance. Each element is written to the stream as soon
+ *  as it is passed to the writer and can be deleted by the caller afterwards.
+ *  This is useful for creating large objects (e.g. structured reports or RT
+ *  structure sets with many items) with a small memory footprint.
+ *  If the output stream cannot take all data at once (e.g. a
+ *  DcmOutputBufferStream whose buffer is full), the writing methods return
+ *  EC_StreamNotifyClient. The operation has been accepted in this case, but
+ *  part of its output is still pending: the caller has to empty the buffer
+ *  (see DcmOutputBufferStream::flushBuffer()) and call writePending() until
+ *  it returns another value. While output is pending, all other writing
+ *  methods return EC_IllegalCall. File streams never cause pending output.
+ *  Example:
+ *  <pre>
+ *    DcmStreamWriter writer;
+ *    writer.open("test.dcm", EXS_LittleEndianExplicit, sopClass, sopInstance);
+ *    writer.writeString(DCM_SOPClassUID, sopClass);
+ *    writer.writeString(DCM_SOPInstanceUID, sopInstance);
+ *    writer.beginSequence(DCM_ROIContourSequence);
+ *    for (...)
+ *    {
+ *      writer.beginItem();
+ *      writer.writeString(DCM_ReferencedROINumber, "1");
+ *      writer.endItem();
+ *    }
+ *    writer.endSequence();
+ *    writer.close();
+ *  </pre>
+ */
+class DCMTK_DCMDATA_EXPORT DcmStreamWriter
+{
+public:
+
+  /// default constructor
+  DcmStreamWriter();
+
+  /// destructor, closes the output if still open
+  virtual ~DcmStreamWriter();
+
+  /** create the given file and write the preamble and the file meta
+   *  information header (unless only the dataset should be written).
+   *  @param fileName name of the file to be created
+   *  @param xfer transfer syntax of the dataset. Big Endian Implicit and
+   *    unknown transfer syntaxes are not supported. For deflated transfer
+   *    syntaxes, the compression filter is installed after the meta header.
+   *  @param sopClassUID SOP Class UID stored in the meta header
+   *  @param sopInstanceUID SOP Instance UID stored in the meta header
+   *  @param writeMode EWM_dataset in order to write the dataset only (the
+   *    UIDs are ignored in this case), any other value in order to write a
+   *    file with meta header
+   *  @return EC_Normal if successful, an error code otherwise
+   */
+  OFCondition open(const OFFilename &fileName,
+                   const E_TransferSyntax xfer,
+                   const char *sopClassUID,
+                   const char *sopInstanceUID,
+                   const E_FileWriteMode writeMode = EWM_fileformat);
+
+  /** start writing to the given output stream, see above open() method for
+   *  details. The stream is not deleted by this writer.
+   *  @param outStream output stream to be written to
+   *  @param xfer transfer syntax of the dataset
+   *  @param sopClassUID SOP Class UID stored in the meta header
+   *  @param sopInstanceUID SOP Instance UID stored in the meta header
+   *  @param writeMode EWM_dataset in order to write the dataset only
+   *  @return EC_Normal if successful, EC_StreamNotifyClient if the meta header
+   *    does not fit into the buffer of the stream (see writePending()), an
+   *    error code otherwise
+   */
+  OFCondition open(DcmOutputStream &outStream,
+                   const E_TransferSyntax xfer,
+                   const char *sopClassUID,
+                   const char *sopInstanceUID,
+                   const E_FileWriteMode writeMode = EWM_fileformat);
+
+  /** write the given element to the current dataset or item. The element
+   *  may also be a complete sequence, which is written with undefined length
+   *  (including all nested sequences and items), or pixel data, which must
+   *  be available in a representation that matches the transfer syntax.
+   *  Group length elements are ignored since the length of the group is not
+   *  known in advance.
+   *  @param element element to be written, not modified apart from its
+   *    transfer state. It must not be deleted while its output is pending.
+   *  @return EC_Normal if successful, EC_StreamNotifyClient if part of the
+   *    output is pending (see writePending()), EC_TagOrderViolated if the tag is not
+   *    greater than the tag of the previous element on this level,
+   *    EC_IllegalCall if no dataset or item is open, another error code otherwise
+   */
+  OFCondition writeElement(DcmElement &element);
+
+  /** create an element with the given tag and string value and write it to
+   *  the current dataset or item, see writeElement()
+   *  @param tag tag of the element, the VR is taken from the data dictionary
+   *  @param value string value, may be multi-valued (separated by backslash)
+   *  @return EC_Normal if successful, an error code otherwise
+   */
+  OFCondition writeString(const DcmTagKey &tag,
+                          const char *value);
+
+  /** write the given item as a whole to the current sequence. The item is
+   *  written with undefined length, also all nested sequences and items.
+   *  @param item item to be written, not modified apart from its transfer
+   *    state. It must not be deleted while its output is pending.
+   *  @return EC_Normal if successful, EC_StreamNotifyClient if part of the
+   *    output is pending (see writePending()), EC_IllegalCall if no sequence
+   *    is open, another error code otherwise
+   */
+  OFCondition writeItem(DcmItem &item);
+
+  /** start a sequence with the given tag in the current dataset or item.
+   *  The sequence is written with undefined length.
+   *  @param tag tag of the sequence
+   *  @return EC_Normal if successful, EC_TagOrderViolated if the tag is not
+   *    greater than the tag of the previous element on this level,
+   *    EC_IllegalCall if no dataset or item is open, another error code otherwise
+   */
+  OFCondition beginSequence(const DcmTagKey &tag);
+
+  /** start a new item in the current sequence. The item is written with
+   *  undefined length.
+   *  @return EC_Normal if successful, EC_IllegalCall if no sequence is open,
+   *    another error code otherwise
+   */
+  OFCondition beginItem();
+
+  /** finish the current item, i.e.\ write the item delimitation item
+   *  @return EC_Normal if successful, EC_IllegalCall if no item is open,
+   *    another error code otherwise
+   */
+  OFCondition endItem();
+
+  /** finish the current sequence, i.e.\ write the sequence delimitation item
+   *  @return EC_Normal if successful, EC_IllegalCall if no sequence is open
+   *    (or an item of the sequence is still open), another error code otherwise
+   */
+  OFCondition endSequence();
+
+  /** continue writing the output that is pending after a method returned
+   *  EC_StreamNotifyClient. The caller has to empty the buffer of the output
+   *  stream before each call.
+   *  @return EC_Normal if all pending output has been written,
+   *    EC_StreamNotifyClient if there is still output pending, EC_IllegalCall
+   *    if the writer is not open, another error code otherwise
+   */
+  OFCondition writePending();
+
+  /** check whether there is output pending, see writePending()
+   *  @return OFTrue if output is pending, OFFalse otherwise
+   */
+  OFBool hasPendingOutput() const
+  {
+    return (pendingObject_ != NULL) || (pendingLength_ > 0) || (pendingCompression_ != ESC_none);
+  }
+
+  /** finish writing and close the file (if opened by this writer) or flush
+   *  the stream. All sequences and items must have been finished before.
+   *  Pending output is written first.
+   *  @return EC_Normal if successful, EC_StreamNotifyClient if the remaining
+   *    output does not fit into the buffer of the stream (the caller has to
+   *    empty the buffer and call this method again), EC_IllegalCall if
+   *    sequences or items are still open (the output is closed anyway),
+   *    another error code otherwise
+   */
+  OFCondition close();
+
+  /** check whether the writer is open
+   *  @return OFTrue if open, OFFalse otherwise
+   */
+  OFBool isOpen() const
+  {
+    return stream_ != NULL;
+  }
+
+  /** get the current nesting level
+   *  @return 0 for the top-level dataset, increased by one for each open
+   *    sequence and item
+   */
+  size_t getNestingLevel() const
+  {
+    return levels_.empty() ? 0 : levels_.size() - 1;
+  }
+
+private:
+
+  /// private undefined copy constructor
+  DcmStreamWriter(const DcmStreamWriter &);
+
+  /// private undefined assignment operator
+  DcmStreamWriter &operator=(const DcmStreamWriter &);
+
+  /// state of one nesting level
+  struct Level
+  {
+    /// OFTrue for a sequence, OFFalse for a dataset or item
+    OFBool isSequence;
+    /// tag of the last element written on this level
+    DcmTagKey lastTag;
+    /// OFTrue if an element has been written on this level
+    OFBool hasElement;
+  };
+
+  /** write the given element to the current dataset or item
+   *  @param element element to be written
+   *  @param owner object to be deleted after the element has been written
+   *    (or could not be written), might be NULL
+   *  @return EC_Normal if successful, an error code otherwise
+   */
+  OFCondition writeElement(DcmElement &element,
+                           DcmObject *owner);
+
+  /** start writing the given object. If the object cannot be written
+   *  completely, it becomes the pending object.
+   *  @param object object to be written
+   *  @param owner object to be deleted after the object has been written,
+   *    might be NULL
+   *  @return EC_Normal if successful, EC_StreamNotifyClient if output is
+   *    pending, an error code otherwise
+   */
+  OFCondition writeObject(DcmObject &object,
+                          DcmObject *owner);
+
+  /// finish the transfer of the pending object and delete its owner (if any)
+  void finishPendingObject();
+
+  /** install the compression filter for deflated transfer syntaxes once the
+   *  meta header has been written
+   *  @return EC_Normal if successful, an error code otherwise
+   */
+  OFCondition installCompression();
+
+  /// release the output stream (if owned) and discard all pending output
+  void release();
+
+  /** check whether an element with the given tag may be written on the
+   *  current level and update the last tag of this level
+   *  @param tag tag of the element to be written
+   *  @return EC_Normal if the element may be written, an error code otherwise
+   */
+  OFCondition checkElementTag(const DcmTagKey &tag);
+
+  /** push a new nesting level
+   *  @param isSequence OFTrue for a sequence, OFFalse for an item
+   */
+  void pushLevel(const OFBool isSequence);
+
+  /** write the tag, the VR (for explicit VR sequences only) and the
+   *  length field
+   *  @param tag tag to be written
+   *  @param isSequence OFTrue if the header of a sequence is written
+   *  @param length value of the length field
+   *  @return EC_Normal if successful, an error code otherwise
+   */
+  OFCondition writeHeader(const DcmTagKey &tag,
+                          const OFBool isSequence,
+                          const Uint32 length);
+
+  /** write the given bytes to the stream. The bytes that do not fit into
+   *  the stream become pending output.
+   *  @param buffer bytes to be written, at most 12
+   *  @param length number of bytes
+   *  @return EC_Normal if successful, EC_StreamNotifyClient if output is
+   *    pending, an error code otherwise
+   */
+  OFCondition writeBytes(const void *buffer,
+                         const size_t length);
+
+  /// output stream, NULL if not open
+  DcmOutputStream *stream_;
+
+  /// OFTrue if the output stream has been created by this writer
+  OFBool ownStream_;
+
+  /// transfer syntax of the dataset
+  E_TransferSyntax xfer_;
+
+  /// nesting levels, the first one is the top-level dataset
+  OFVector<Level> levels_;
+
+  /// write cache used for writing pixel data
+  DcmWriteCache wcache_;
+
+  /// object whose output is pending, NULL if none
+  DcmObject *pendingObject_;
+
+  /// object to be deleted after the pending object has been written, might be NULL
+  DcmObject *pendingOwner_;
+
+  /// header bytes whose output is pending
+  Uint8 pendingBytes_[12];
+
+  /// number of pending header bytes
+  size_t pendingLength_;
+
+  /// compression filter to be installed after the pending meta header
+  E_StreamCompression pendingCompression_;
+};
+
+
+#endif
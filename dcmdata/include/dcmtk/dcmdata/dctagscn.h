@@ -0,0 +1,269 @@
+/*
+ *
+ *  Copyright (C) 2012, OFFIS e.V.
+ *  All rights reserved.  See COPYRIGHT file for details.
+ *
+ *  This software and supporting documentation were developed by
+ *
+ *    OFFIS e.V.
+ *    R&D Division Health
+ *    Escherweg 2
+ *    D-26121 Oldenburg, Germany
+ *
+ *
+ *  Module:  dcmdata
+ *
+ *  Author:  DCMTK team
+ *
+ *  Purpose: Interface of classes DcmTagScanner and DcmTagScanHandler
+ *
+ */
+
+#ifndef DCTAGSCN_H
+#define DCTAGSCN_H
+
+#include "dcmtk/config/osconfig.h"    /* make sure OS specific configuration is included first */
+
+#include "dcmtk/ofstd/offile.h"       /* for class OFFilename */
+#include "dcmtk/dcmdata/dctagkey.h"
+#include "dcmtk/dcmdata/dcvr.h"
+#include "dcmtk/dcmdata/dcxfer.h"
+#include "dcmtk/dcmdata/dcerror.h"
+
+class DcmInputStream;
+
+
+/** abstract base class for handlers that receive the elements found by
+ *  DcmTagScanner. The handler is called once for each data element in the
+ *  order of the elements in the stream.
+ */
+class DCMTK_DCMDATA_EXPORT DcmTagScanHandler
+{
+public:
+
+  /// destructor
+  virtual ~DcmTagScanHandler();
+
+  /** called by the scanner for each data element found in the stream.
+   *  For sequences, this method is called for the sequence element itself
+   *  (with VR SQ and without a value) and, unless sequences are skipped, for
+   *  each element of the contained items (with an increased nesting level).
+   *  @param tag tag of the element
+   *  @param vr VR of the element, either read from the stream (explicit VR)
+   *    or determined from the data dictionary (implicit VR)
+   *  @param length length of the element value as stored in the stream
+   *    (might be DCM_UndefinedLength for sequences and encapsulated pixel data)
+   *  @param value pointer to the element value, which is terminated by an
+   *    additional zero byte for convenience. NULL if the value has not been
+   *    read (e.g. because it is longer than the maximum value length or the
+   *    element is a sequence). The value is only valid during this call.
+   *  @param byteOrder byte order of binary element values
+   *  @param level nesting level of the element, 0 for the top-level dataset
+   *    (and the meta header)
+   *  @return OFTrue to continue scanning, OFFalse to stop the scanner
+   */
+  virtual OFBool handleElement(const DcmTagKey &tag,
+                               const DcmEVR vr,
+                               const Uint32 length,
+                               const Uint8 *value,
+                               const E_ByteOrder byteOrder,
+                               const Uint32 level) = 0;
+};
+
+
+/** class that scans a DICOM file or stream and reports each data element to
+ *  a handler, without creating any DcmElement objects. This is much faster
+ *  than loading a complete dataset if only a few attributes of the header are
+ *  needed (e.g. for indexing a large number of files). By default, scanning
+ *  stops before the pixel data element, and only values up to a certain
+ *  length are read into memory.
+ */
+class DCMTK_DCMDATA_EXPORT DcmTagScanner
+{
+public:
+
+  /// default constructor
+  DcmTagScanner();
+
+  /// destructor
+  virtual ~DcmTagScanner();
+
+  /** set the tag before which scanning stops. Scanning stops at the first
+   *  top-level element with a tag greater than or equal to the given tag,
+   *  i.e. this element is not reported to the handler any more.
+   *  @param tag tag at which scanning should stop (default: PixelData).
+   *    Use (FFFF,FFFF) in order to scan up to the end of the dataset.
+   */
+  void setStopTag(const DcmTagKey &tag);
+
+  /** specify whether the content of sequences should be reported to the
+   *  handler or skipped. The sequence element itself is always reported.
+   *  @param skip skip the content of all sequences if OFTrue (default: OFFalse)
+   */
+  void setSkipSequences(const OFBool skip);
+
+  /** set the maximum length of element values that are read into memory
+   *  and passed to the handler. Longer values are skipped.
+   *  @param maxLength maximum value length in bytes (default: 4096)
+   */
+  void setMaxValueLength(const Uint32 maxLength);
+
+  /** scan the given DICOM file. The file may start with a preamble and meta
+   *  header, or contain a dataset only. Elements of the meta header are also
+   *  reported to the handler.
+   *  @param fileName name of the file to be scanned
+   *  @param handler handler called for each element
+   *  @param readXfer transfer syntax of the dataset if the file does not
+   *    contain a meta header. EXS_Unknown means auto detection.
+   *  @return EC_Normal if successful (also if the scanning has been stopped),
+   *    an error code otherwise
+   */
+  OFCondition scanFile(const OFFilename &fileName,
+                       DcmTagScanHandler &handler,
+                       const E_TransferSyntax readXfer = EXS_Unknown);
+
+  /** scan the given input stream. See scanFile() for details.
+   *  The stream is expected to provide all data without suspension (e.g. a
+   *  file stream). If scanning has been stopped at the stop tag, the stream
+   *  is positioned at the beginning of this element.
+   *  @param inStream input stream to be scanned, positioned at the start of
+   *    file or dataset
+   *  @param handler handler called for each element
+   *  @param readXfer transfer syntax of the dataset if the stream does not
+   *    contain a meta header. EXS_Unknown means auto detection.
+   *  @return EC_Normal if successful (also if the scanning has been stopped),
+   *    an error code otherwise
+   */
+  OFCondition scanStream(DcmInputStream &inStream,
+                         DcmTagScanHandler &handler,
+                         const E_TransferSyntax readXfer = EXS_Unknown);
+
+  /** get the transfer syntax of the dataset scanned last
+   *  @return transfer syntax of the dataset, EXS_Unknown if not yet scanned
+   */
+  E_TransferSyntax getDatasetXfer() const
+  {
+    return datasetXfer_;
+  }
+
+  /** check whether the last scan has been stopped, i.e.\ either by the
+   *  handler or by reaching the stop tag
+   *  @return OFTrue if stopped, OFFalse if the end of the dataset has been reached
+   */
+  OFBool stopped() const
+  {
+    return stopped_;
+  }
+
+private:
+
+  /// private undefined copy constructor
+  DcmTagScanner(const DcmTagScanner &);
+
+  /// private undefined assignment operator
+  DcmTagScanner &operator=(const DcmTagScanner &);
+
+  /** scan the elements of the meta header (group 0002)
+   *  @param inStream input stream positioned at the first meta header element
+   *  @param handler handler called for each element
+   *  @param metaXfer returns the transfer syntax specified in the meta header
+   *  @return status, EC_Normal if successful
+   */
+  OFCondition scanMetaHeader(DcmInputStream &inStream,
+                             DcmTagScanHandler &handler,
+                             E_TransferSyntax &metaXfer);
+
+  /** scan the elements of a dataset or item
+   *  @param inStream input stream positioned at the first element
+   *  @param handler handler called for each element, NULL if skipping
+   *  @param xfer transfer syntax of the stream content
+   *  @param level nesting level of the elements
+   *  @param length length of the dataset or item, DCM_UndefinedLength if
+   *    undefined (i.e. up to the delimitation item or the end of stream)
+   *  @return status, EC_Normal if successful
+   */
+  OFCondition scanElements(DcmInputStream &inStream,
+                           DcmTagScanHandler *handler,
+                           const E_TransferSyntax xfer,
+                           const Uint32 level,
+                           const Uint32 length);
+
+  /** scan the items of a sequence or the fragments of encapsulated pixel data
+   *  @param inStream input stream positioned at the first item
+   *  @param handler handler called for each element, NULL if skipping
+   *  @param xfer transfer syntax of the stream content
+   *  @param level nesting level of the elements in the items
+   *  @param length length of the sequence, DCM_UndefinedLength if undefined
+   *  @param fragments OFTrue if the items are pixel data fragments, which are
+   *    always skipped
+   *  @return status, EC_Normal if successful
+   */
+  OFCondition scanItems(DcmInputStream &inStream,
+                        DcmTagScanHandler *handler,
+                        const E_TransferSyntax xfer,
+                        const Uint32 level,
+                        const Uint32 length,
+                        const OFBool fragments);
+
+  /** read tag, VR and length of the next element from the stream
+   *  @param inStream input stream
+   *  @param xfer transfer syntax of the stream content
+   *  @param tag returns the tag of the element
+   *  @param vr returns the VR of the element (EVR_na for items and delimiters)
+   *  @param length returns the value length of the element
+   *  @return status, EC_Normal if successful
+   */
+  OFCondition readTagAndLength(DcmInputStream &inStream,
+                               const DcmXfer &xfer,
+                               DcmTagKey &tag,
+                               DcmEVR &vr,
+                               Uint32 &length);
+
+  /** read the given number of bytes into the value buffer, which is enlarged
+   *  if required and terminated by an additional zero byte
+   *  @param inStream input stream
+   *  @param length number of bytes to be read
+   *  @return status, EC_Normal if successful
+   */
+  OFCondition readValue(DcmInputStream &inStream,
+                        const Uint32 length);
+
+  /** skip the given number of bytes
+   *  @param inStream input stream
+   *  @param length number of bytes to be skipped
+   *  @return status, EC_Normal if successful
+   */
+  OFCondition skipValue(DcmInputStream &inStream,
+                        const Uint32 length);
+
+  /** determine the transfer syntax of a dataset without meta header
+   *  from the first bytes of the stream
+   *  @param inStream input stream positioned at the start of the dataset
+   *  @return transfer syntax that is most likely
+   */
+  static E_TransferSyntax detectXfer(DcmInputStream &inStream);
+
+  /// tag at which scanning stops
+  DcmTagKey stopTag_;
+
+  /// skip the content of sequences if true
+  OFBool skipSequences_;
+
+  /// maximum length of element values that are read into memory
+  Uint32 maxValueLength_;
+
+  /// buffer for element values
+  Uint8 *buffer_;
+
+  /// size of the value buffer
+  Uint32 bufferSize_;
+
+  /// transfer syntax of the dataset scanned last
+  E_TransferSyntax datasetXfer_;
+
+  /// true if the last scan has been stopped
+  OFBool stopped_;
+};
+
+
+#endif
@@ -121,6 +121,67 @@ extern DCMTK_DCMDATA_EXPORT const int numberOfDcmImageSOPClassUIDs;
  */
 DCMTK_DCMDATA_EXPORT char *dcmGenerateUniqueIdentifier(char *uid, const char* prefix=NULL);
 
+/** class for creating a large number of Unique Identifiers efficiently.
+ *  The UIDs have the same structure as those created by
+ *  dcmGenerateUniqueIdentifier(), i.e. prefix, host id, process id, time and
+ *  counter.  However, the first part is only determined once, and the values
+ *  of the counter are reserved in blocks from the counter that is shared with
+ *  dcmGenerateUniqueIdentifier().  A block is reserved by an atomic operation
+ *  (see OFAtomic) or, if not available, with the global mutex locked, and the
+ *  UIDs created by all instances of this class and by
+ *  dcmGenerateUniqueIdentifier() are unique within the process.
+ *  The UIDs are formatted without any memory allocation.
+ *  An instance of this class should not be shared by multiple threads, i.e.
+ *  each thread should use its own instance.
+ */
+class DCMTK_DCMDATA_EXPORT DcmUIDGenerator
+{
+  public:
+
+    /** constructor
+     *  @param prefix prefix for UID creation.  If NULL, SITE_INSTANCE_UID_ROOT
+     *    is used (like for dcmGenerateUniqueIdentifier()).
+     *  @param blockSize number of counter values that are reserved at once
+     *    (should be greater than 0)
+     */
+    DcmUIDGenerator(const char *prefix = NULL,
+                    const unsigned int blockSize = 4096);
+
+    /** creates a Unique Identifier in uid and returns uid.
+     *  Care is taken to make sure that the generated UID is 64 characters
+     *  or less.
+     *  @param uid pointer to buffer of 65 or more characters in which the UID
+     *    is returned
+     *  @return pointer to UID, identical to uid parameter
+     */
+    char *generate(char *uid);
+
+  private:
+
+    /// private undefined copy constructor
+    DcmUIDGenerator(const DcmUIDGenerator &);
+
+    /// private undefined copy assignment operator
+    DcmUIDGenerator &operator=(const DcmUIDGenerator &);
+
+    /// prefix, host id and process id
+    char Prefix[65];
+    /// length of the prefix
+    size_t PrefixLength;
+    /// number of counter values that are reserved at once
+    const unsigned int BlockSize;
+    /// next counter value to be used
+    unsigned int Counter;
+    /// number of counter values left in the current block
+    unsigned int CounterLeft;
+    /// time that has been formatted last
+    unsigned long LastTime;
+    /// the formatted time (with leading period, empty if not yet formatted)
+    char TimeString[24];
+    /// length of the formatted time
+    size_t TimeLength;
+};
+
 /** performs a table lookup and returns a short modality identifier
  *  that can be used for building file names etc.
  *  Identifiers are defined for all storage SOP classes.
@@ -139,6 +200,34 @@ DCMTK_DCMDATA_EXPORT const char *dcmSOPClassUIDToModality(const char *sopClassUI
  */
 DCMTK_DCMDATA_EXPORT unsigned long dcmGuessModalityBytes(const char *sopClassUID);
 
+/** properties of a well-known UID, as determined by dcmFindUIDProperties()
+ */
+struct DCMTK_DCMDATA_EXPORT DcmUIDProperties
+{
+    /// name of the UID (NULL if unknown)
+    const char *name;
+    /// short modality identifier (NULL if none defined)
+    const char *modality;
+    /// guessed average size of an object (0 if unknown)
+    unsigned long averageSize;
+    /// true if the UID is one of the Storage SOP Classes in dcmAllStorageSOPClassUIDs
+    OFBool isStorageSOPClass;
+};
+
+/** determines all properties of a well-known UID with a single lookup, i.e.
+ *  the information returned by dcmFindNameOfUID(), dcmSOPClassUIDToModality(),
+ *  dcmGuessModalityBytes() and dcmIsaStorageSOPClassUID().  This is useful for
+ *  applications that need this information for each presentation context or
+ *  each received object.  Like the other lookup functions, it uses a hash
+ *  table that is created once on program startup, i.e. the time needed does
+ *  not depend on the number of well-known UIDs.
+ *  @param uid UID string for which the properties are to be looked up
+ *  @param properties reference to variable where the result is stored.  All
+ *    members are set to NULL, 0 or OFFalse if the UID is not known.
+ *  @return true if the UID is known, false otherwise
+ */
+DCMTK_DCMDATA_EXPORT OFBool dcmFindUIDProperties(const char *uid, DcmUIDProperties &properties);
+
 /*
 ** String Constants
 */
@@ -105,6 +105,19 @@ class DCMTK_DCMDATA_EXPORT DcmApplicationEntity
 	                                const unsigned long pos,
 	                                OFBool normalize = OFTrue);
 
+    /** get a particular value as a pointer into the stored string, i.e. without copying it.
+     *  See DcmByteString::getStringView() for details on the validity of the returned pointer.
+     *  @param stringVal variable in which the pointer to the value is stored (might be NULL)
+     *  @param stringLen variable in which the length of the value is stored
+     *  @param pos index of the value in case of multi-valued elements (0..vm-1)
+     *  @param normalize delete leading and trailing spaces if OFTrue
+     *  @return status, EC_Normal if successful, an error code otherwise
+     */
+    virtual OFCondition getStringView(const char *&stringVal,
+                                      Uint32 &stringLen,
+                                      const unsigned long pos = 0,
+                                      OFBool normalize = OFTrue);
+
     /* --- static helper functions --- */
 
     /** check whether given string value conforms to the VR "AE" (Application Entity)
@@ -105,6 +105,19 @@ class DCMTK_DCMDATA_EXPORT DcmDate
                                     const unsigned long pos,
                                     OFBool normalize = OFTrue);
 
+    /** get a particular value as a pointer into the stored string, i.e. without copying it.
+     *  See DcmByteString::getStringView() for details on the validity of the returned pointer.
+     *  @param stringVal variable in which the pointer to the value is stored (might be NULL)
+     *  @param stringLen variable in which the length of the value is stored
+     *  @param pos index of the value in case of multi-valued elements (0..vm-1)
+     *  @param normalize delete trailing spaces if OFTrue
+     *  @return status, EC_Normal if successful, an error code otherwise
+     */
+    virtual OFCondition getStringView(const char *&stringVal,
+                                      Uint32 &stringLen,
+                                      const unsigned long pos = 0,
+                                      OFBool normalize = OFTrue);
+
     /** set the element value to the current system date.
      *  The DICOM DA format supported by this function is "YYYYMMDD". If the current
      *  system date is unavailable the date is set to "19000101" and an error code is
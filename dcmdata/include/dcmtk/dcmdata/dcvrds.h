@@ -115,6 +115,18 @@ class DCMTK_DCMDATA_EXPORT DcmDecimalString
      */
     virtual OFCondition getFloat64Vector(OFVector<Float64> &doubleVals);
 
+    /** replace the element value by the given float values (which are possibly multi-valued).
+     *  Each value is converted to a string with the highest precision that fits into the
+     *  maximum length of a DS value (16 characters), and the string value of the element is
+     *  created in a single step.  This is much faster than calling putString() with a string
+     *  that has been composed by the caller, e.g. for large contour data.
+     *  @param doubleVals new attribute values
+     *  @param numDoubles number of values in array doubleVals
+     *  @return status, EC_Normal if successful, an error code otherwise
+     */
+    virtual OFCondition putFloat64Array(const Float64 *doubleVals,
+                                        const unsigned long numDoubles);
+
     /** get a particular value as a character string
      *  @param stringVal variable in which the result value is stored
      *  @param pos index of the value in case of multi-valued elements (0..vm-1)
@@ -125,6 +137,19 @@ class DCMTK_DCMDATA_EXPORT DcmDecimalString
                                     const unsigned long pos,
                                     OFBool normalize = OFTrue);
 
+    /** get a particular value as a pointer into the stored string, i.e. without copying it.
+     *  See DcmByteString::getStringView() for details on the validity of the returned pointer.
+     *  @param stringVal variable in which the pointer to the value is stored (might be NULL)
+     *  @param stringLen variable in which the length of the value is stored
+     *  @param pos index of the value in case of multi-valued elements (0..vm-1)
+     *  @param normalize delete leading and trailing spaces if OFTrue
+     *  @return status, EC_Normal if successful, an error code otherwise
+     */
+    virtual OFCondition getStringView(const char *&stringVal,
+                                      Uint32 &stringLen,
+                                      const unsigned long pos = 0,
+                                      OFBool normalize = OFTrue);
+
     /** write object in XML format
      *  @param out output stream to which the XML document is written
      *  @param flags optional flag used to customize the output (see DCMTypes::XF_xxx)
@@ -144,6 +169,16 @@ class DCMTK_DCMDATA_EXPORT DcmDecimalString
      */
     static OFCondition checkStringValue(const OFString &value,
                                         const OFString &vm = "1-n");
+
+    /** convert the given float value to a DS string with the highest possible precision.
+     *  The conversion is locale independent and the resulting string is not terminated.
+     *  @param stringVal buffer in which the result is stored, must be able to hold at least
+     *    16 characters (the maximum length of a DS value)
+     *  @param doubleVal value to be converted
+     *  @return number of characters stored in the buffer
+     */
+    static size_t formatFloat64(char *stringVal,
+                                const Float64 doubleVal);
 };
 
 
@@ -24,6 +24,7 @@
 
 #include "dcmtk/config/osconfig.h"    /* make sure OS specific configuration is included first */
 
+#include "dcmtk/ofstd/ofvector.h"
 #include "dcmtk/dcmdata/dcbytstr.h"
 
 
@@ -102,6 +103,26 @@ class DCMTK_DCMDATA_EXPORT DcmIntegerString
     virtual OFCondition getSint32(Sint32 &sintVal,
                                   const unsigned long pos = 0);
 
+    /** get stored integer values as a vector.
+     *  The values are converted directly from the stored string, i.e. without copying each
+     *  of them first.  Please note that only an element value consisting of zero or more
+     *  spaces is considered as being empty and, therefore, results in an empty vector with
+     *  status ".good()".
+     *  @param sintVals reference to result variable
+     *    (cleared automatically before entries are added)
+     *  @return status, EC_Normal if successful, an error code otherwise
+     */
+    virtual OFCondition getSint32Vector(OFVector<Sint32> &sintVals);
+
+    /** replace the element value by the given integer values (which are possibly multi-valued).
+     *  The string value of the element is created in a single step.
+     *  @param sintVals new attribute values
+     *  @param numSints number of values in array sintVals
+     *  @return status, EC_Normal if successful, an error code otherwise
+     */
+    virtual OFCondition putSint32Array(const Sint32 *sintVals,
+                                       const unsigned long numSints);
+
     /** get a particular value as a character string
      *  @param stringVal variable in which the result value is stored
      *  @param pos index of the value in case of multi-valued elements (0..vm-1)
@@ -112,6 +133,19 @@ class DCMTK_DCMDATA_EXPORT DcmIntegerString
                                     const unsigned long pos,
                                     OFBool normalize = OFTrue);
 
+    /** get a particular value as a pointer into the stored string, i.e. without copying it.
+     *  See DcmByteString::getStringView() for details on the validity of the returned pointer.
+     *  @param stringVal variable in which the pointer to the value is stored (might be NULL)
+     *  @param stringLen variable in which the length of the value is stored
+     *  @param pos index of the value in case of multi-valued elements (0..vm-1)
+     *  @param normalize delete leading and trailing spaces if OFTrue
+     *  @return status, EC_Normal if successful, an error code otherwise
+     */
+    virtual OFCondition getStringView(const char *&stringVal,
+                                      Uint32 &stringLen,
+                                      const unsigned long pos = 0,
+                                      OFBool normalize = OFTrue);
+
     /* --- static helper functions --- */
 
     /** check whether given string value conforms to the VR "IS" (Integer String)
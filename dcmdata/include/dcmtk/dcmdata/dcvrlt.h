@@ -109,6 +109,20 @@ class DCMTK_DCMDATA_EXPORT DcmLongText
                                     const unsigned long pos,
                                     OFBool normalize = OFTrue);
 
+    /** get the value as a pointer into the stored string, i.e. without copying it.
+     *  The backslash is treated as a normal character.  See DcmByteString::getStringView()
+     *  for details on the validity of the returned pointer.
+     *  @param stringVal variable in which the pointer to the value is stored (might be NULL)
+     *  @param stringLen variable in which the length of the value is stored
+     *  @param pos not used since value multiplicity is always 1
+     *  @param normalize delete trailing spaces if OFTrue
+     *  @return status, EC_Normal if successful, an error code otherwise
+     */
+    virtual OFCondition getStringView(const char *&stringVal,
+                                      Uint32 &stringLen,
+                                      const unsigned long pos = 0,
+                                      OFBool normalize = OFTrue);
+
     /** get the string value (all compenents)
      *  @param stringVal string variable in which the result value is stored
      *  @param normalize remove trailing spaces if OFTrue
@@ -295,6 +295,12 @@ class DCMTK_DCMDATA_EXPORT DcmOtherByteOtherWord
      */
     virtual void postLoadValue();
 
+    /** check whether the value field of this element may reference the content
+     *  of a memory-mapped input file. This is always the case for OB and OW values.
+     *  @return always returns OFTrue
+     */
+    virtual OFBool supportsMappedValue() const;
+
     /** align the element value to an even length (padding)
      *  @return status, EC_Normal if successful, an error code otherwise
      */
@@ -314,6 +320,26 @@ class DCMTK_DCMDATA_EXPORT DcmOtherByteOtherWord
                     const char *pixelFileName,
                     size_t *pixelCounter);
 
+    /** write 8 bit values as backslash-separated hex numbers (two lower case digits
+     *  each) to the given stream.  Used for the XML output of binary data.
+     *  @param out output stream
+     *  @param byteValues values to be written
+     *  @param count number of values to be written
+     */
+    static void writeHexValues(STD_NAMESPACE ostream&out,
+                               const Uint8 *byteValues,
+                               const unsigned long count);
+
+    /** write 16 bit values as backslash-separated hex numbers (four lower case digits
+     *  each) to the given stream.  Used for the XML output of binary data.
+     *  @param out output stream
+     *  @param wordValues values to be written
+     *  @param count number of values to be written
+     */
+    static void writeHexValues(STD_NAMESPACE ostream&out,
+                               const Uint16 *wordValues,
+                               const unsigned long count);
+
 private:
 
     /** this flag is used during write operations and indicates that compact() should be
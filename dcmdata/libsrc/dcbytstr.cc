@@ -324,6 +324,54 @@ OFCondition DcmByteString::getOFString(OFString &stringVal,
 }
 
 
+OFCondition DcmByteString::getStringView(const char *&stringVal,
+                                         Uint32 &stringLen,
+                                         const unsigned long pos,
+                                         OFBool /*normalize*/)
+{
+    stringVal = NULL;
+    stringLen = 0;
+    /* get string data */
+    char *str = NULL;
+    Uint32 len = 0;
+    errorFlag = getString(str, len);
+    if (errorFlag.good())
+    {
+        /* check whether string value is present */
+        if ((str != NULL) && (len > 0))
+        {
+            /* search for beginning of specified string component */
+            const char *p = str;
+            const char *endVal = str + len;
+            unsigned long i = 0;
+            while ((i < pos) && (p != NULL))
+            {
+                p = OFstatic_cast(const char *, memchr(p, '\\', endVal - p));
+                if (p != NULL)
+                {
+                    ++p;
+                    ++i;
+                }
+            }
+            if (p != NULL)
+            {
+                /* search for end of specified string component */
+                const char *q = OFstatic_cast(const char *, memchr(p, '\\', endVal - p));
+                stringVal = p;
+                stringLen = OFstatic_cast(Uint32, ((q != NULL) ? q : endVal) - p);
+            } else {
+                /* specified component index not found in string */
+                errorFlag = EC_IllegalParameter;
+            }
+        }
+        /* treat an empty string as a special case */
+        else if (pos > 0)
+            errorFlag = EC_IllegalParameter;
+    }
+    return errorFlag;
+}
+
+
 OFCondition DcmByteString::getOFStringArray(OFString &stringVal,
                                             OFBool normalize)
 {
@@ -722,6 +770,34 @@ void normalizeString(OFString &string,
 }
 
 
+void normalizeString(const char *&string,
+                     Uint32 &length,
+                     const OFBool leading,
+                     const OFBool trailing,
+                     const char paddingChar)
+{
+    /* check for non-empty string */
+    if ((string != NULL) && (length > 0))
+    {
+        // exclude leading spaces
+        if (leading)
+        {
+            while ((length > 0) && (*string == paddingChar))
+            {
+                ++string;
+                --length;
+            }
+        }
+        // exclude trailing spaces
+        if (trailing)
+        {
+            while ((length > 0) && (string[length - 1] == paddingChar))
+                --length;
+        }
+    }
+}
+
+
 // ********************************
 
 
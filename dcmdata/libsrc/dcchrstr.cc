@@ -173,8 +173,8 @@ OFCondition DcmCharString::convertCharacterSet(DcmSpecificCharacterSet &converte
     char *str = NULL;
     Uint32 len = 0;
     OFCondition status = getString(str, len);
-    // do nothing if string value is empty
-    if (status.good() && (str != NULL) && (len > 0))
+    // do nothing if string value is empty or would not be changed anyway (e.g. ASCII only)
+    if (status.good() && (str != NULL) && (len > 0) && converter.isConversionNeeded(str, len))
     {
         OFString resultStr;
         // convert string to selected character string and replace the element value
@@ -23,13 +23,13 @@
 #include "dcmtk/dcmdata/dccodec.h"
 #include "dcmtk/ofstd/oflist.h"
 #include "dcmtk/ofstd/ofthread.h"
+#include "dcmtk/ofstd/ofthpool.h"
 #include "dcmtk/dcmdata/dcdeftag.h"  /* for tag constants */
 #include "dcmtk/dcmdata/dcuid.h"     /* for dcmGenerateUniqueIdentifer()*/
 #include "dcmtk/dcmdata/dcitem.h"    /* for class DcmItem */
 #include "dcmtk/dcmdata/dcsequen.h"  /* for DcmSequenceOfItems */
 #include "dcmtk/dcmdata/dcpixseq.h"  /* for DcmPixelSequence */
 #include "dcmtk/dcmdata/dcpxitem.h"  /* for DcmPixelItem */
-#include "dcmtk/dcmdata/dcswap.h"    /* for swapIfNecessary */
 #include "dcmtk/dcmdata/dcvrui.h"    /* for DcmUniqueIdentifier */
 
 // static member variables
@@ -230,74 +230,184 @@ OFCondition DcmCodec::determineStartFragment(
   DcmPixelSequence * fromPixSeq,
   Uint32& currentItem)
 {
-  Uint32 numberOfFragments = fromPixSeq->card();
-  if (numberOfFrames < 1 || numberOfFragments <= OFstatic_cast(Uint32, numberOfFrames) || frameNo >= OFstatic_cast(Uint32, numberOfFrames)) return EC_IllegalCall;
+  if (fromPixSeq == NULL || numberOfFrames < 1) return EC_IllegalCall;
 
-  if (frameNo == 0)
+  // the pixel sequence caches the index of all frames, so that random access
+  // to an arbitrary frame does not require scanning the fragments again
+  return fromPixSeq->getFrameStartFragment(frameNo, OFstatic_cast(Uint32, numberOfFrames), currentItem);
+}
+
+
+OFCondition DcmCodec::determineFrameFragments(
+  Sint32 numberOfFrames,
+  DcmPixelSequence * fromPixSeq,
+  OFVector<Uint32>& startFragments)
+{
+  startFragments.clear();
+  if (fromPixSeq == NULL || numberOfFrames < 1) return EC_IllegalCall;
+  return fromPixSeq->getFrameFragments(OFstatic_cast(Uint32, numberOfFrames), startFragments);
+}
+
+
+OFCondition DcmCodec::loadFragments(
+  DcmPixelSequence * fromPixSeq,
+  OFVector<DcmCompressedFragment>& fragments)
+{
+  fragments.clear();
+  const unsigned long numberOfFragments = fromPixSeq->card();
+  fragments.reserve(numberOfFragments);
+  OFCondition result = EC_Normal;
+  DcmPixelItem *pixItem = NULL;
+  DcmCompressedFragment fragment;
+  for (unsigned long idx = 0; (idx < numberOfFragments) && result.good(); ++idx)
+  {
+    // iterate the list of fragments instead of searching each one from the beginning
+    pixItem = OFstatic_cast(DcmPixelItem *, fromPixSeq->nextInContainer(pixItem));
+    if (pixItem == NULL) result = EC_IllegalCall;
+    else
+    {
+      fragment.data = NULL;
+      fragment.length = pixItem->getLength();
+      result = pixItem->getUint8Array(fragment.data);
+      fragments.push_back(fragment);
+    }
+  }
+  if (result.bad()) fragments.clear();
+  return result;
+}
+
+
+/* list of jobs processing the frames of an image with a thread pool */
+class DcmFrameJobs : public OFParallelJobs
+{
+public:
+  DcmFrameJobs(DcmFrameProcessor &processor)
+  : processor_(processor)
   {
-    // simple case: first frame is always at second fragment
-    currentItem = 1;
-    return EC_Normal;
   }
 
-  if (numberOfFragments == OFstatic_cast(Uint32, numberOfFrames) + 1)
+  virtual OFCondition processJob(const size_t jobNo, const size_t threadNo)
   {
-    // standard case: there is one fragment per frame.
-    currentItem = frameNo + 1;
-    return EC_Normal;
+    return processor_.processFrame(OFstatic_cast(Uint32, jobNo), threadNo);
   }
 
-  // non-standard case: multiple fragments per frame.
-  // We now try to consult the offset table.
-  DcmPixelItem *pixItem = NULL;
-  Uint8 * rawOffsetTable = NULL;
+private:
+  DcmFrameProcessor &processor_;
+};
 
-  // get first pixel item, i.e. the fragment containing the offset table
-  OFCondition result = fromPixSeq->getItem(pixItem, 0);
-  if (result.good())
+/* determine the number of threads for processing the given number of frames */
+static size_t getFrameThreads(Uint32 numberOfFrames, Uint32 numberOfThreads)
+{
+#ifndef WITH_THREADS
+  numberOfThreads = 1;
+#endif
+  return (numberOfThreads > numberOfFrames) ? numberOfFrames : numberOfThreads;
+}
+
+/* report the number of threads actually used for processing the frames */
+static void logFrameThreads(const OFThreadPool &pool, Uint32 numberOfFrames, size_t numberOfThreads)
+{
+  if (pool.getNumberOfThreads() < numberOfThreads)
+    DCMDATA_WARN("unable to start worker thread, using fewer threads");
+  if (pool.getNumberOfThreads() > 1)
+    DCMDATA_DEBUG("processing " << numberOfFrames << " frames with " << pool.getNumberOfThreads() << " threads");
+}
+
+
+OFCondition DcmCodec::processFrames(
+  DcmFrameProcessor& processor,
+  Uint32 numberOfFrames,
+  Uint32 numberOfThreads)
+{
+  const size_t threads = getFrameThreads(numberOfFrames, numberOfThreads);
+  OFThreadPool pool(threads);
+  logFrameThreads(pool, numberOfFrames, threads);
+  DcmFrameJobs jobs(processor);
+  return pool.run(jobs, numberOfFrames);
+}
+
+
+/* compresses the frames of one batch for DcmCodec::encodeFrames() */
+class DcmFrameBatchEncoder : public DcmFrameProcessor
+{
+public:
+  DcmFrameBatchEncoder(DcmFrameEncoder &encoder, Uint32 batchSize)
+  : encoder_(encoder)
+  , firstFrame_(0)
+  , frames_(batchSize)
   {
-    Uint32 tableLength = pixItem->getLength();
-    result = pixItem->getUint8Array(rawOffsetTable);
-    if (result.good())
+    for (Uint32 i = 0; i < batchSize; ++i)
     {
-      // check if the offset table has the right size: 4 bytes for each frame (not fragment!)
-      if (tableLength != 4* OFstatic_cast(Uint32, numberOfFrames)) return EC_IllegalCall;
-
-      // byte swap offset table into local byte order. In file, the offset table is always in little endian
-      swapIfNecessary(gLocalByteOrder, EBO_LittleEndian, rawOffsetTable, tableLength, sizeof(Uint32));
+      frames_[i].data = NULL;
+      frames_[i].length = 0;
+    }
+  }
 
-      // cast offset table to Uint32.
-      Uint32 *offsetTable = OFreinterpret_cast(Uint32 *, rawOffsetTable);
+  virtual ~DcmFrameBatchEncoder()
+  {
+    clear();
+  }
 
-      // now access offset of the frame we're looking for
-      Uint32 offset = offsetTable[frameNo];
+  virtual OFCondition processFrame(Uint32 slot, size_t /* threadNo */)
+  {
+    return encoder_.encodeFrame(firstFrame_ + slot, slot, frames_[slot].data, frames_[slot].length);
+  }
 
-      // OK, now let's look if we can find a fragment that actually corresponds to that offset.
-      // In counter we compute the offset for each frame by adding all fragment lenghts
-      Uint32 counter = 0;
-      // now iterate over all fragments except the index table. The start of the first fragment
-      // is defined as zero.
-      for (Uint32 idx = 1; idx < numberOfFragments; ++idx)
-      {
-        if (counter == offset)
-        {
-          // hooray, we are lucky. We have found the fragment we're looking for
-          currentItem = idx;
-          return EC_Normal;
-        }
+  /* delete the compressed frames of the current batch */
+  void clear()
+  {
+    for (size_t i = 0; i < frames_.size(); ++i)
+    {
+      delete[] frames_[i].data;
+      frames_[i].data = NULL;
+      frames_[i].length = 0;
+    }
+  }
 
-        // access pixel item in order to determine its length
-        result = fromPixSeq->getItem(pixItem, idx);
-        if (result.bad()) return result;
+  DcmFrameEncoder &encoder_;
+  Uint32 firstFrame_;
+  OFVector<DcmCompressedFragment> frames_;
+};
 
-        // add pixel item length plus 8 bytes overhead for the item tag and length field
-        counter += pixItem->getLength() + 8;
-      }
 
-      // bad luck. We have not found a fragment corresponding to the offset in the offset table.
-      // Either we cannot correctly add numbers, or they cannot :-)
-      return EC_TagNotFound;
+OFCondition DcmCodec::encodeFrames(
+  DcmFrameEncoder& encoder,
+  Uint32 numberOfFrames,
+  Uint32 numberOfThreads,
+  DcmPixelSequence * pixelSequence,
+  DcmOffsetList& offsetList,
+  Uint32 fragmentSize,
+  unsigned long& compressedSize)
+{
+  compressedSize = 0;
+  if (pixelSequence == NULL) return EC_IllegalCall;
+#ifndef WITH_THREADS
+  numberOfThreads = 1;
+#endif
+  // use more frames than threads per batch, since the frames may take different times
+  const Uint32 batchSize = (numberOfThreads > 1) ? 2 * numberOfThreads : 1;
+  DcmFrameBatchEncoder batch(encoder, batchSize);
+  // the same worker threads are used for all batches
+  const size_t threads = getFrameThreads(numberOfFrames, numberOfThreads);
+  OFThreadPool pool(threads);
+  logFrameThreads(pool, numberOfFrames, threads);
+  DcmFrameJobs jobs(batch);
+  OFCondition result = EC_Normal;
+  for (Uint32 firstFrame = 0; (firstFrame < numberOfFrames) && result.good(); firstFrame += batchSize)
+  {
+    const Uint32 count = (numberOfFrames - firstFrame < batchSize) ? numberOfFrames - firstFrame : batchSize;
+    batch.firstFrame_ = firstFrame;
+    for (Uint32 slot = 0; (slot < count) && result.good(); ++slot)
+      result = encoder.prepareFrame(firstFrame + slot, slot);
+    if (result.good())
+      result = pool.run(jobs, count);
+    // store the compressed frames in ascending order
+    for (Uint32 slot = 0; (slot < count) && result.good(); ++slot)
+    {
+      result = pixelSequence->storeCompressedFrame(offsetList, batch.frames_[slot].data, batch.frames_[slot].length, fragmentSize);
+      compressedSize += batch.frames_[slot].length;
     }
+    batch.clear();
   }
   return result;
 }
@@ -40,6 +40,7 @@
 #include "dcmtk/dcmdata/dcostrmf.h"    /* for class DcmOutputFileStream */
 #include "dcmtk/dcmdata/dcistrma.h"    /* for class DcmInputStream */
 #include "dcmtk/dcmdata/dcistrmf.h"    /* for class DcmInputFileStream */
+#include "dcmtk/dcmdata/dcistrmm.h"    /* for class DcmInputMappedFileStream */
 #include "dcmtk/dcmdata/dcwcache.h"    /* for class DcmWriteCache */
 
 
@@ -603,11 +604,23 @@ OFCondition DcmDataset::loadFile(const OFFilename &fileName,
     /* check parameters first */
     if (!fileName.isEmpty())
     {
-        /* open file for input */
-        DcmInputFileStream fileStream(fileName);
+        /* open file for input (memory-mapped if requested and possible) */
+        DcmInputStream *fileStream = NULL;
+        if (dcmUseMemoryMappedFiles.get())
+        {
+            fileStream = new DcmInputMappedFileStream(fileName);
+            if (fileStream->status().bad())
+            {
+                DCMDATA_DEBUG("DcmDataset::loadFile() cannot map file into memory, using normal file I/O instead");
+                delete fileStream;
+                fileStream = NULL;
+            }
+        }
+        if (fileStream == NULL)
+            fileStream = new DcmInputFileStream(fileName);
 
         /* check stream status */
-        l_error = fileStream.status();
+        l_error = fileStream->status();
 
         if (l_error.good())
         {
@@ -617,10 +630,11 @@ OFCondition DcmDataset::loadFile(const OFFilename &fileName,
             {
                 /* read data from file */
                 transferInit();
-                l_error = read(fileStream, readXfer, groupLength, maxReadLength);
+                l_error = read(*fileStream, readXfer, groupLength, maxReadLength);
                 transferEnd();
             }
         }
+        delete fileStream;
     }
     return l_error;
 }
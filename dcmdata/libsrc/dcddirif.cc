@@ -43,6 +43,9 @@
 #include "dcmtk/ofstd/ofstream.h"
 #include "dcmtk/ofstd/ofbmanip.h"     /* for class OFBitmanipTemplate */
 #include "dcmtk/ofstd/ofcast.h"
+#include "dcmtk/ofstd/ofvector.h"
+
+#include "dcmtk/ofstd/ofthpool.h"
 
 
 /*------------------------*
@@ -61,6 +64,8 @@
 #define AUTO_PATIENTID_PREFIX "DCMTKPAT"
 // prefix used to automatically create study IDs (+ 6 digits)
 #define AUTO_STUDYID_PREFIX "DCMTKSTUDY"
+// number of files per thread loaded in advance by addDicomFiles()
+#define PREPARED_FILES_PER_THREAD 4
 
 
 /*------------------------*
@@ -1052,11 +1057,15 @@ DicomDirInterface::DicomDirInterface()
     ConsistencyCheck(OFTrue),
     IconImageMode(OFFalse),
     FilesetUpdateMode(OFFalse),
+    InPlaceAppendMode(OFFalse),
+    RecordIndex(),
+    IndexedRecords(),
     BackupFilename(),
     BackupCreated(OFFalse),
     IconSize(64),
     IconPrefix(),
     DefaultIcon(),
+    NumberOfThreads(1),
     RLESupport(OFFalse),
     JPEGSupport(OFFalse),
     JP2KSupport(OFFalse),
@@ -1092,6 +1101,8 @@ void DicomDirInterface::cleanup()
     delete DicomDir;
     /* invalidate references */
     DicomDir = NULL;
+    RecordIndex.clear();
+    IndexedRecords.clear();
 }
 
 
@@ -1280,7 +1291,10 @@ OFCondition DicomDirInterface::writeDicomDir(const E_EncodingType encodingType,
     {
         DCMDATA_INFO("writing file: " << DicomDir->getDirFileName());
         /* write DICOMDIR as Little Endian Explicit as required by the standard */
-        result = DicomDir->write(DICOMDIR_DEFAULT_TRANSFERSYNTAX, encodingType, groupLength);
+        if (InPlaceAppendMode && !FilesetUpdateMode)
+            result = DicomDir->writeIncremental(encodingType, groupLength);
+        else
+            result = DicomDir->write(DICOMDIR_DEFAULT_TRANSFERSYNTAX, encodingType, groupLength);
         /* delete backup copy in case the new file could be written without any errors */
         if (result.good())
             deleteDicomDirBackup();
@@ -2814,17 +2828,123 @@ DcmDirectoryRecord *DicomDirInterface::findExistingRecord(DcmDirectoryRecord *pa
     DcmDirectoryRecord *record = NULL;
     if (parent != NULL)
     {
-        /* iterate over all records */
-        while (!found && ((record = parent->nextSub(record)) != NULL))
+        OFString key;
+        /* use the record index if possible */
+        if (getRecordIndexKey(parent, recordType, dataset, OFFalse /*isRecord*/, key) && indexRecords(parent))
         {
-            if (record->getRecordType() == recordType)
+            OFMap<OFString, DcmDirectoryRecord *>::iterator it = RecordIndex.find(key);
+            if (it != RecordIndex.end())
+            {
+                record = it->second;
                 found = recordMatchesDataset(record, dataset);
+            }
+        } else {
+            /* iterate over all records */
+            while (!found && ((record = parent->nextSub(record)) != NULL))
+            {
+                if (record->getRecordType() == recordType)
+                    found = recordMatchesDataset(record, dataset);
+            }
         }
     }
     return (found) ? record : NULL;
 }
 
 
+// get the key under which a record is stored in the record index
+OFBool DicomDirInterface::getRecordIndexKey(DcmDirectoryRecord *parent,
+                                            const E_DirRecType recordType,
+                                            DcmItem *item,
+                                            const OFBool isRecord,
+                                            OFString &result)
+{
+    OFString value;
+    /* determine unique key attribute (see recordMatchesDataset()) */
+    DcmTagKey key;
+    switch (recordType)
+    {
+        case ERT_Patient:
+            key = DCM_PatientID;
+            break;
+        case ERT_Study:
+            key = DCM_StudyInstanceUID;
+            break;
+        case ERT_Series:
+            key = DCM_SeriesInstanceUID;
+            break;
+        default:
+            key = isRecord ? DCM_ReferencedSOPInstanceUIDInFile : DCM_SOPInstanceUID;
+            break;
+    }
+    /* missing or empty values never match (see compare()), so do not report an error */
+    if (item->findAndGetOFStringArray(key, value).bad() || value.empty())
+        return OFFalse;
+    char buffer[64];
+    sprintf(buffer, "%p:%i:", OFstatic_cast(void *, parent), OFstatic_cast(int, recordType));
+    result = buffer;
+    result += value;
+    return OFTrue;
+}
+
+
+// add all records below the given parent record to the record index
+OFBool DicomDirInterface::indexRecords(DcmDirectoryRecord *parent)
+{
+    const unsigned long count = parent->cardSub();
+    OFMap<const DcmDirectoryRecord *, unsigned long>::iterator it = IndexedRecords.find(parent);
+    if (it != IndexedRecords.end())
+    {
+        /* records are not indexable or index is up-to-date */
+        if ((it->second == 0) || (it->second == count + 1))
+            return (it->second > 0);
+    }
+    DcmDirectoryRecord *record = NULL;
+    OFString key;
+    while ((record = parent->nextSub(record)) != NULL)
+    {
+        const E_DirRecType recordType = record->getRecordType();
+        /* a study record might refer to the file containing the unique key */
+        if ((recordType == ERT_Study) && !checkExistsWithValue(record, DCM_StudyInstanceUID))
+        {
+            IndexedRecords[parent] = 0;
+            return OFFalse;
+        }
+        /* records with an empty key never match, and the first record with a key is found first */
+        if (getRecordIndexKey(parent, recordType, record, OFTrue /*isRecord*/, key) &&
+            (RecordIndex.find(key) == RecordIndex.end()))
+        {
+            RecordIndex[key] = record;
+        }
+    }
+    IndexedRecords[parent] = count + 1;
+    return OFTrue;
+}
+
+
+// add a newly created record to the record index
+void DicomDirInterface::addRecordToIndex(DcmDirectoryRecord *parent,
+                                         DcmDirectoryRecord *record)
+{
+    OFMap<const DcmDirectoryRecord *, unsigned long>::iterator it = IndexedRecords.find(parent);
+    /* only update an existing index, it is created on demand */
+    if ((it != IndexedRecords.end()) && (it->second > 0))
+    {
+        const E_DirRecType recordType = record->getRecordType();
+        OFString key;
+        if ((recordType == ERT_Study) && !checkExistsWithValue(record, DCM_StudyInstanceUID))
+            it->second = 0;
+        else {
+            if (getRecordIndexKey(parent, recordType, record, OFTrue /*isRecord*/, key) &&
+                (RecordIndex.find(key) == RecordIndex.end()))
+            {
+                RecordIndex[key] = record;
+            }
+            ++(it->second);
+        }
+    }
+}
+
+
 // create or update patient record and copy required values from dataset
 DcmDirectoryRecord *DicomDirInterface::buildPatientRecord(DcmDirectoryRecord *record,
                                                           DcmFileFormat *fileformat,
@@ -3905,10 +4025,6 @@ DcmDirectoryRecord *DicomDirInterface::buildImageRecord(DcmDirectoryRecord *reco
         if (record->error().good())
         {
             DcmDataset *dataset = fileformat->getDataset();
-            OFBool iconImage = IconImageMode;
-            unsigned int iconSize = (IconSize == 0) ? 64 : IconSize;
-            /* Icon Image Sequence required for particular profiles */
-            OFBool iconRequired = OFFalse;
             /* copy attribute values from dataset to image record */
             copyElementType1(dataset, DCM_InstanceNumber, record, sourceFilename);
             /* application profile specific attributes */
@@ -3968,10 +4084,6 @@ DcmDirectoryRecord *DicomDirInterface::buildImageRecord(DcmDirectoryRecord *reco
                         }
                         /* additional type 2 keys specified by specific profiles (type 3 in image IOD) */
                         copyStringWithDefault(dataset, DCM_CalibrationImage, record, sourceFilename);
-                        /* icon images */
-                        iconImage = OFTrue;
-                        iconRequired = OFTrue;
-                        iconSize = 128;
                     }
                     break;
                 case AP_CTandMR:
@@ -3982,16 +4094,15 @@ DcmDirectoryRecord *DicomDirInterface::buildImageRecord(DcmDirectoryRecord *reco
                     copyElementType1C(dataset, DCM_ImageOrientationPatient, record, sourceFilename);
                     copyElementType1C(dataset, DCM_FrameOfReferenceUID, record, sourceFilename);
                     copyElementType1C(dataset, DCM_PixelSpacing, record, sourceFilename);
-                    /* icon images */
-                    iconImage = OFTrue;
-                    iconSize = 64;
                     break;
                 default:
                     /* no additional keys */
                     break;
             }
-            /* create icon images */
-            if (iconImage)
+            /* create icon images (size and requirement depend on the profile) */
+            unsigned int iconSize = 0;
+            OFBool iconRequired = OFFalse;
+            if (getIconImageMode(iconSize, iconRequired))
             {
                 OFCondition status = addIconImage(record, dataset, iconSize, sourceFilename);
                 if (status.bad())
@@ -4125,6 +4236,62 @@ OFBool DicomDirInterface::getIconFromDataset(DcmItem *dataset,
 }
 
 
+// get size and requirement of icon images for the current application profile
+OFBool DicomDirInterface::getIconImageMode(unsigned int &iconSize,
+                                           OFBool &iconRequired) const
+{
+    OFBool iconImage = IconImageMode;
+    iconSize = (IconSize == 0) ? 64 : IconSize;
+    iconRequired = OFFalse;
+    switch (ApplicationProfile)
+    {
+        case AP_XrayAngiographic:
+        case AP_XrayAngiographicDVD:
+        case AP_BasicCardiac:
+            /* Icon Image Sequence required for particular profiles */
+            iconImage = OFTrue;
+            iconRequired = OFTrue;
+            iconSize = 128;
+            break;
+        case AP_CTandMR:
+            iconImage = OFTrue;
+            iconSize = 64;
+            break;
+        default:
+            break;
+    }
+    return iconImage;
+}
+
+
+// create pixel data of icon image (from PGM file, DICOM dataset or default)
+void DicomDirInterface::createIconPixelData(DcmItem *dataset,
+                                            Uint8 *pixel,
+                                            const unsigned long count,
+                                            const unsigned int size,
+                                            const OFString &sourceFilename)
+{
+    OFBool iconOk = OFFalse;
+    /* prefix for external icons specified? */
+    if (!IconPrefix.empty())
+    {
+        /* try to load external pgm icon */
+        iconOk = getIconFromFile(IconPrefix + sourceFilename, pixel, count, size, size);
+    } else {
+        /* try to create icon from dataset */
+        iconOk = getIconFromDataset(dataset, pixel, count, size, size);
+        if (!iconOk)
+            DCMDATA_WARN("cannot create monochrome icon from image file, using default");
+    }
+    /* could not create icon so far: use default icon (if specified) */
+    if (!iconOk && !DefaultIcon.empty())
+        iconOk = getIconFromFile(DefaultIcon, pixel, count, size, size);
+    /* default not available: use black image */
+    if (!iconOk)
+        OFBitmanipTemplate<Uint8>::zeroMem(pixel, count);
+}
+
+
 // add icon image sequence to record
 OFCondition DicomDirInterface::addIconImage(DcmDirectoryRecord *record,
                                             DcmItem *dataset,
@@ -4156,24 +4323,7 @@ OFCondition DicomDirInterface::addIconImage(DcmDirectoryRecord *record,
             Uint8 *pixel = new Uint8[count];
             if (pixel != NULL)
             {
-                OFBool iconOk = OFFalse;
-                /* prefix for external icons specified? */
-                if (!IconPrefix.empty())
-                {
-                    /* try to load external pgm icon */
-                    iconOk = getIconFromFile(IconPrefix + sourceFilename, pixel, count, width, height);
-                } else {
-                    /* try to create icon from dataset */
-                    iconOk = getIconFromDataset(dataset, pixel, count, width, height);
-                    if (!iconOk)
-                        DCMDATA_WARN("cannot create monochrome icon from image file, using default");
-                }
-                /* could not create icon so far: use default icon (if specified) */
-                if (!iconOk && !DefaultIcon.empty())
-                    iconOk = getIconFromFile(DefaultIcon, pixel, count, width, height);
-                /* default not available: use black image */
-                if (!iconOk)
-                    OFBitmanipTemplate<Uint8>::zeroMem(pixel, count);
+                createIconPixelData(dataset, pixel, count, size, sourceFilename);
                 /* create Pixel Data element and set pixel data */
                 result = ditem->putAndInsertUint8Array(DCM_PixelData, pixel, count);
                 /* free pixel data after it has been copied */
@@ -4319,8 +4469,11 @@ DcmDirectoryRecord *DicomDirInterface::addRecord(DcmDirectoryRecord *parent,
                 /* type 1C: required if an extended character set is used in one of the record keys */
                 if (record->isAffectedBySpecificCharacterSet())
                     copyElementType1C(dataset, DCM_SpecificCharacterSet, record, sourceFilename);
+                /* an updated record cannot be kept in the existing file */
+                if (record == oldRecord)
+                    record->setModified();
                 /* in case a new record has been created */
-                if (record != oldRecord)
+                else
                 {
                     /* insert it below parent record */
                     OFCondition status = insertSortedUnder(parent, record);
@@ -4330,7 +4483,8 @@ DcmDirectoryRecord *DicomDirInterface::addRecord(DcmDirectoryRecord *parent,
                         /* free memory */
                         delete record;
                         record = NULL;
-                    }
+                    } else
+                        addRecordToIndex(parent, record);
                 }
             }
         } else {
@@ -4400,7 +4554,11 @@ void DicomDirInterface::inventMissingAttributes(DcmDirectoryRecord *parent,
             if (record->getRecordType() == ERT_Patient)
             {
                 if (!record->tagExistsWithValue(DCM_PatientID))
+                {
                     setDefaultValue(record, DCM_PatientID, AutoPatientNumber++, AUTO_PATIENTID_PREFIX);
+                    /* the record index has to be updated */
+                    IndexedRecords.erase(parent);
+                }
                 if (recurse)
                     inventMissingStudyLevelAttributes(record);
             }
@@ -4509,88 +4667,250 @@ OFCondition DicomDirInterface::addDicomFile(const char *filename,
     /* first, make sure that a DICOMDIR object exists */
     if (DicomDir != NULL)
     {
-        /* create fully qualified pathname of the DICOM file to be added */
-        OFString pathname;
-        OFStandard::combineDirAndFilename(pathname, OFSTRING_GUARD(directory), OFSTRING_GUARD(filename), OFTrue /*allowEmptyDirName*/);
         /* then check the file name, load the file and check the content */
         DcmFileFormat fileformat;
         result = loadAndCheckDicomFile(filename, directory, fileformat);
         if (result.good())
+            result = insertDicomFile(filename, directory, fileformat);
+    }
+    return result;
+}
+
+
+// add previously loaded and checked DICOM file to the current DICOMDIR object
+OFCondition DicomDirInterface::insertDicomFile(const char *filename,
+                                               const char *directory,
+                                               DcmFileFormat &fileformat)
+{
+    OFCondition result = EC_IllegalParameter;
+    /* first, make sure that a DICOMDIR object exists */
+    if (DicomDir != NULL)
+    {
+        /* create fully qualified pathname of the DICOM file to be added */
+        OFString pathname;
+        OFStandard::combineDirAndFilename(pathname, OFSTRING_GUARD(directory), OFSTRING_GUARD(filename), OFTrue /*allowEmptyDirName*/);
+        result = EC_Normal;
+        DCMDATA_INFO("adding file: " << pathname);
+        /* start creating the DICOMDIR directory structure */
+        DcmDirectoryRecord *rootRecord = &(DicomDir->getRootRecord());
+        DcmMetaInfo *metainfo = fileformat.getMetaInfo();
+        /* massage filename into DICOM format (DOS conventions for path separators, uppercase) */
+        OFString fileID;
+        hostToDicomFilename(filename, fileID);
+        /* what kind of object (SOP Class) is stored in the file */
+        OFString sopClass;
+        metainfo->findAndGetOFString(DCM_MediaStorageSOPClassUID, sopClass);
+        /* if hanging protocol, palette or implant file then attach it to the root record and stop */
+        if (compare(sopClass, UID_HangingProtocolStorage))
         {
-            DCMDATA_INFO("adding file: " << pathname);
-            /* start creating the DICOMDIR directory structure */
-            DcmDirectoryRecord *rootRecord = &(DicomDir->getRootRecord());
-            DcmMetaInfo *metainfo = fileformat.getMetaInfo();
-            /* massage filename into DICOM format (DOS conventions for path separators, uppercase) */
-            OFString fileID;
-            hostToDicomFilename(filename, fileID);
-            /* what kind of object (SOP Class) is stored in the file */
-            OFString sopClass;
-            metainfo->findAndGetOFString(DCM_MediaStorageSOPClassUID, sopClass);
-            /* if hanging protocol, palette or implant file then attach it to the root record and stop */
-            if (compare(sopClass, UID_HangingProtocolStorage))
-            {
-                /* add a hanging protocol record below the root */
-                if (addRecord(rootRecord, ERT_HangingProtocol, &fileformat, fileID, pathname) == NULL)
-                    result = EC_CorruptedData;
-            }
-            else if (compare(sopClass, UID_ColorPaletteStorage))
-            {
-                /* add a palette record below the root */
-                if (addRecord(rootRecord, ERT_Palette, &fileformat, fileID, pathname) == NULL)
-                    result = EC_CorruptedData;
-            }
-            else if (compare(sopClass, UID_GenericImplantTemplateStorage))
+            /* add a hanging protocol record below the root */
+            if (addRecord(rootRecord, ERT_HangingProtocol, &fileformat, fileID, pathname) == NULL)
+                result = EC_CorruptedData;
+        }
+        else if (compare(sopClass, UID_ColorPaletteStorage))
+        {
+            /* add a palette record below the root */
+            if (addRecord(rootRecord, ERT_Palette, &fileformat, fileID, pathname) == NULL)
+                result = EC_CorruptedData;
+        }
+        else if (compare(sopClass, UID_GenericImplantTemplateStorage))
+        {
+            /* add an implant record below the root */
+            if (addRecord(rootRecord, ERT_Implant, &fileformat, fileID, pathname) == NULL)
+                result = EC_CorruptedData;
+        }
+        else if (compare(sopClass, UID_ImplantAssemblyTemplateStorage))
+        {
+            /* add an implant group record below the root */
+            if (addRecord(rootRecord, ERT_ImplantGroup, &fileformat, fileID, pathname) == NULL)
+                result = EC_CorruptedData;
+        }
+        else if (compare(sopClass, UID_ImplantTemplateGroupStorage))
+        {
+            /* add an implant assy record below the root */
+            if (addRecord(rootRecord, ERT_ImplantAssy, &fileformat, fileID, pathname) == NULL)
+                result = EC_CorruptedData;
+        } else {
+            /* add a patient record below the root */
+            DcmDirectoryRecord *patientRecord = addRecord(rootRecord, ERT_Patient, &fileformat, fileID, pathname);
+            if (patientRecord != NULL)
             {
-                /* add an implant record below the root */
-                if (addRecord(rootRecord, ERT_Implant, &fileformat, fileID, pathname) == NULL)
-                    result = EC_CorruptedData;
-            }
-            else if (compare(sopClass, UID_ImplantAssemblyTemplateStorage))
+                /* if patient management file then attach it to patient record and stop */
+                if (compare(sopClass, UID_RETIRED_DetachedPatientManagementMetaSOPClass))
+                {
+                    result = patientRecord->assignToSOPFile(fileID.c_str(), pathname.c_str());
+                    DCMDATA_ERROR(result.text() << ": cannot assign patient record to file: " << pathname);
+                } else {
+                    /* add a study record below the current patient record */
+                    DcmDirectoryRecord *studyRecord = addRecord(patientRecord, ERT_Study, &fileformat, fileID, pathname);;
+                    if (studyRecord != NULL)
+                    {
+                        /* add a series record below the current study record */
+                        DcmDirectoryRecord *seriesRecord = addRecord(studyRecord, ERT_Series, &fileformat, fileID, pathname);;
+                        if (seriesRecord != NULL)
+                        {
+                            /* add one of the instance record below the current series record */
+                            if (addRecord(seriesRecord, sopClassToRecordType(sopClass), &fileformat, fileID, pathname) == NULL)
+                                result = EC_CorruptedData;
+                        } else
+                            result = EC_CorruptedData;
+                    } else
+                        result = EC_CorruptedData;
+                }
+            } else
+                result = EC_CorruptedData;
+            /* invent missing attributes on all levels or PatientID only */
+            if (InventMode)
+                inventMissingAttributes(rootRecord);
+            else if (InventPatientIDMode)
+                inventMissingAttributes(rootRecord, OFFalse /*recurse*/);
+        }
+    }
+    return result;
+}
+
+
+/* DICOM file loaded and checked in advance by addDicomFiles() */
+struct DicomDirPreparedFile
+{
+    DicomDirPreparedFile(const OFString &filename)
+      : Filename(filename),
+        FileFormat(),
+        Result(EC_Normal)
+    {
+    }
+
+    /// name of the DICOM file
+    OFString Filename;
+    /// loaded DICOM file
+    DcmFileFormat FileFormat;
+    /// result of loading and checking the DICOM file
+    OFCondition Result;
+
+  private:
+
+    /// private undefined copy constructor
+    DicomDirPreparedFile(const DicomDirPreparedFile &);
+
+    /// private undefined assignment operator
+    DicomDirPreparedFile &operator=(const DicomDirPreparedFile &);
+};
+
+
+/* list of DICOM files processed by the thread pool of addDicomFiles() */
+class DicomDirFileQueue : public OFParallelJobs
+{
+  public:
+
+    DicomDirFileQueue(DicomDirInterface &ddir,
+                      OFVector<DicomDirPreparedFile *> &files,
+                      const char *directory)
+      : Interface(ddir),
+        Files(files),
+        Directory(directory)
+    {
+    }
+
+    /// load and check the DICOM file with the given index (result is stored in the file).
+    /// Icon images are not created here, since DicomImage (used by the image plugin)
+    /// is not thread-safe; addIconImage() creates them on the calling thread.
+    virtual OFCondition processJob(const size_t jobNo,
+                                   const size_t /*threadNo*/)
+    {
+        DicomDirPreparedFile *file = Files[jobNo];
+        file->Result = Interface.loadAndCheckDicomFile(file->Filename.c_str(), Directory, file->FileFormat);
+        return EC_Normal;
+    }
+
+  private:
+
+    /// DICOMDIR interface used to prepare the files
+    DicomDirInterface &Interface;
+    /// DICOM files to be processed
+    OFVector<DicomDirPreparedFile *> &Files;
+    /// directory where the DICOM files are stored (might be NULL)
+    const char *Directory;
+
+    /// private undefined copy constructor
+    DicomDirFileQueue(const DicomDirFileQueue &);
+
+    /// private undefined assignment operator
+    DicomDirFileQueue &operator=(const DicomDirFileQueue &);
+};
+
+
+// add DICOM files to the current DICOMDIR object (load and check them in parallel)
+OFCondition DicomDirInterface::addDicomFiles(const OFList<OFString> &filenames,
+                                             const char *directory,
+                                             OFList<OFString> &badFiles,
+                                             unsigned long &goodFiles)
+{
+    OFCondition result = EC_IllegalParameter;
+    goodFiles = 0;
+    /* first, make sure that a DICOMDIR object exists */
+    if (DicomDir != NULL)
+    {
+        result = EC_Normal;
+        OFListConstIterator(OFString) iter = filenames.begin();
+        OFListConstIterator(OFString) last = filenames.end();
+#ifdef WITH_THREADS
+        const unsigned int numberOfThreads = NumberOfThreads;
+#else
+        const unsigned int numberOfThreads = 1;
+#endif
+        if (numberOfThreads <= 1)
+        {
+            /* no need to load the files in advance */
+            while ((iter != last) && result.good())
             {
-                /* add an implant group record below the root */
-                if (addRecord(rootRecord, ERT_ImplantGroup, &fileformat, fileID, pathname) == NULL)
-                    result = EC_CorruptedData;
+                result = addDicomFile((*iter).c_str(), directory);
+                if (result.bad())
+                {
+                    badFiles.push_back(*iter);
+                    /* ignore inconsistent file, just warn (already reported) */
+                    if (!AbortMode)
+                        result = EC_Normal;
+                } else
+                    ++goodFiles;
+                ++iter;
             }
-            else if (compare(sopClass, UID_ImplantTemplateGroupStorage))
+        } else {
+            const size_t batchSize = numberOfThreads * PREPARED_FILES_PER_THREAD;
+            OFVector<DicomDirPreparedFile *> files;
+            files.reserve(batchSize);
+            /* the same threads are used for all batches (the calling thread is also working) */
+            OFThreadPool pool((filenames.size() < numberOfThreads) ? filenames.size() : numberOfThreads);
+            DicomDirFileQueue queue(*this, files, directory);
+            while ((iter != last) && result.good())
             {
-                /* add an implant assy record below the root */
-                if (addRecord(rootRecord, ERT_ImplantAssy, &fileformat, fileID, pathname) == NULL)
-                    result = EC_CorruptedData;
-            } else {
-                /* add a patient record below the root */
-                DcmDirectoryRecord *patientRecord = addRecord(rootRecord, ERT_Patient, &fileformat, fileID, pathname);
-                if (patientRecord != NULL)
+                /* collect next batch of files */
+                while ((iter != last) && (files.size() < batchSize))
+                    files.push_back(new DicomDirPreparedFile(*iter++));
+                /* load and check the files */
+                pool.run(queue, files.size(), OFFalse /*stopOnError*/);
+                /* add the files to the DICOMDIR in the original order (sequentially) */
+                for (size_t k = 0; k < files.size(); ++k)
                 {
-                    /* if patient management file then attach it to patient record and stop */
-                    if (compare(sopClass, UID_RETIRED_DetachedPatientManagementMetaSOPClass))
+                    DicomDirPreparedFile *file = files[k];
+                    /* in abort mode, the remaining files of the batch are discarded */
+                    if (result.good())
                     {
-                        result = patientRecord->assignToSOPFile(fileID.c_str(), pathname.c_str());
-                        DCMDATA_ERROR(result.text() << ": cannot assign patient record to file: " << pathname);
-                    } else {
-                        /* add a study record below the current patient record */
-                        DcmDirectoryRecord *studyRecord = addRecord(patientRecord, ERT_Study, &fileformat, fileID, pathname);;
-                        if (studyRecord != NULL)
+                        if (file->Result.good())
+                            result = insertDicomFile(file->Filename.c_str(), directory, file->FileFormat);
+                        else
+                            result = file->Result;
+                        if (result.bad())
                         {
-                            /* add a series record below the current study record */
-                            DcmDirectoryRecord *seriesRecord = addRecord(studyRecord, ERT_Series, &fileformat, fileID, pathname);;
-                            if (seriesRecord != NULL)
-                            {
-                                /* add one of the instance record below the current series record */
-                                if (addRecord(seriesRecord, sopClassToRecordType(sopClass), &fileformat, fileID, pathname) == NULL)
-                                    result = EC_CorruptedData;
-                            } else
-                                result = EC_CorruptedData;
+                            badFiles.push_back(file->Filename);
+                            /* ignore inconsistent file, just warn (already reported) */
+                            if (!AbortMode)
+                                result = EC_Normal;
                         } else
-                            result = EC_CorruptedData;
+                            ++goodFiles;
                     }
-                } else
-                    result = EC_CorruptedData;
-                /* invent missing attributes on all levels or PatientID only */
-                if (InventMode)
-                    inventMissingAttributes(rootRecord);
-                else if (InventPatientIDMode)
-                    inventMissingAttributes(rootRecord, OFFalse /*recurse*/);
+                    delete file;
+                }
+                files.clear();
             }
         }
     }
@@ -4678,6 +4998,20 @@ OFCondition DicomDirInterface::setDefaultIcon(const char *filename)
 }
 
 
+// set number of threads used for loading and checking DICOM files
+OFCondition DicomDirInterface::setNumberOfThreads(const unsigned int threads)
+{
+    OFCondition result = EC_IllegalParameter;
+    /* check parameter */
+    if (threads > 0)
+    {
+        NumberOfThreads = threads;
+        result = EC_Normal;
+    }
+    return result;
+}
+
+
 // enable/disable the abort mode, i.e. abort on first inconsistent file (otherwise warn)
 OFBool DicomDirInterface::enableAbortMode(const OFBool newMode)
 {
@@ -4762,6 +5096,18 @@ OFBool DicomDirInterface::disableBackupMode(const OFBool newMode)
 }
 
 
+// enable/disable the in-place append mode, i.e. whether new records are appended to the existing file
+OFBool DicomDirInterface::enableInPlaceAppendMode(const OFBool newMode)
+{
+    /* save current mode */
+    OFBool oldMode = InPlaceAppendMode;
+    /* set new mode */
+    InPlaceAppendMode = newMode;
+    /* return old mode */
+    return oldMode;
+}
+
+
 // enable/disable pixel encoding check, i.e. whether the pixel encoding is checked
 // for particular application profiles
 OFBool DicomDirInterface::disableEncodingCheck(const OFBool newMode)
@@ -5478,6 +5824,8 @@ void DicomDirInterface::setDefaultValue(DcmDirectoryRecord *record,
             sprintf(buffer, "%lu", number);
         }
         record->putAndInsertString(key, buffer);
+        /* the record might have been read from the existing DICOMDIR file */
+        record->setModified();
         /* create warning message */
         DCMDATA_WARN(recordTypeToName(record->getRecordType()) << " Record (origin: "
             << OFSTRING_GUARD(record->getRecordsOriginFile()) << ") inventing " << DcmTag(key).getTagName()
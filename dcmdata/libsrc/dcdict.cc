@@ -111,6 +111,8 @@ OFBool DcmDataDictionary::loadSkeletonDictionary()
 DcmDataDictionary::DcmDataDictionary(OFBool loadBuiltin, OFBool loadExternal)
   : hashDict(),
     repDict(),
+    staticDicts(),
+    shadowedCount(0),
     skeletonCount(0),
     dictionaryLoaded(OFFalse)
 {
@@ -123,10 +125,47 @@ DcmDataDictionary::~DcmDataDictionary()
 }
 
 
+int DcmDataDictionary::numberOfNormalTagEntries() const
+{
+    int count = hashDict.size() - shadowedCount;
+    for (size_t i = 0; i < staticDicts.size(); ++i)
+        count += OFstatic_cast(int, staticDicts[i]->size());
+    return count;
+}
+
+
+void DcmDataDictionary::addStaticDictionary(const DcmStaticHashDict *dict)
+{
+    if (dict != NULL) {
+        /* entries that have already been added (e.g. the skeleton) replace the static ones */
+        DcmHashDictIterator iter(hashDict.begin());
+        DcmHashDictIterator last(hashDict.end());
+        for (; iter != last; ++iter) {
+            if ((findStaticEntry(**iter, (*iter)->getPrivateCreator()) == NULL) &&
+                (dict->findExact(**iter, (*iter)->getPrivateCreator()) != NULL))
+                ++shadowedCount;
+        }
+        staticDicts.push_back(dict);
+    }
+}
+
+
+const DcmDictEntry*
+DcmDataDictionary::findStaticEntry(const DcmTagKey& key, const char *privCreator) const
+{
+    const DcmDictEntry* e = NULL;
+    for (size_t i = 0; (e == NULL) && (i < staticDicts.size()); ++i)
+        e = staticDicts[i]->findExact(key, privCreator);
+    return e;
+}
+
+
 void DcmDataDictionary::clear()
 {
    hashDict.clear();
    repDict.clear();
+   staticDicts.clear();
+   shadowedCount = 0;
    skeletonCount = 0;
    dictionaryLoaded = OFFalse;
 }
@@ -674,6 +713,12 @@ DcmDataDictionary::addEntry(DcmDictEntry* e)
             inserted = OFTrue;
         }
     } else {
+        /* an entry that replaces a static entry does not increase the number of entries */
+        if (findStaticEntry(*e, e->getPrivateCreator()) != NULL) {
+            const DcmDictEntry* old = hashDict.get(*e, e->getPrivateCreator());
+            if ((old == NULL) || (old->getKey() != e->getKey()))
+                ++shadowedCount;
+        }
         hashDict.put(e);
     }
 }
@@ -688,6 +733,8 @@ DcmDataDictionary::deleteEntry(const DcmDictEntry& entry)
             repDict.remove(e);
             delete e;
         } else {
+            if (findStaticEntry(entry, entry.getPrivateCreator()) != NULL)
+                --shadowedCount;
             hashDict.del(entry.getKey(), entry.getPrivateCreator());
         }
     }
@@ -717,12 +764,14 @@ DcmDataDictionary::findEntry(const DcmDictEntry& entry) const
 const DcmDictEntry*
 DcmDataDictionary::findEntry(const DcmTagKey& key, const char *privCreator) const
 {
-    /* search first in the normal tags dictionary and if not found
-     * then search in the repeating tags list.
+    /* search first in the normal tags dictionary, then in the static
+     * hash tables and if not found then search in the repeating tags list.
      */
     const DcmDictEntry* e = NULL;
 
     e = hashDict.get(key, privCreator);
+    for (size_t i = 0; (e == NULL) && (i < staticDicts.size()); ++i)
+        e = staticDicts[i]->get(key, privCreator);
     if (e == NULL) {
         /* search in the repeating tags dictionary */
         OFBool found = OFFalse;
@@ -760,6 +809,22 @@ DcmDataDictionary::findEntry(const char *name) const
         }
     }
 
+    /* then search in the static hash tables */
+    for (size_t i = 0; (e == NULL) && (i < staticDicts.size()); ++i) {
+        const DcmStaticHashDict *dict = staticDicts[i];
+        for (unsigned int j = 0; (e == NULL) && (j < dict->size()); ++j) {
+            if (dict->getEntry(j).contains(name)) {
+                e = &dict->getEntry(j);
+                if (e->getGroup() % 2)
+                {
+                    /* tag is a private tag - continue search to be sure to find non-private keys first */
+                    if (!ePrivate) ePrivate = e;
+                    e = NULL;
+                }
+            }
+        }
+    }
+
     if (e == NULL) {
         /* search in the repeating tags dictionary */
         OFBool found = OFFalse;
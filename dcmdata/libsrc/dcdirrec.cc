@@ -116,7 +116,8 @@ DcmDirectoryRecord::DcmDirectoryRecord()
     DirRecordType(ERT_Private),
     referencedMRDR(NULL),
     numberOfReferences(0),
-    offsetInFile(0)
+    offsetInFile(0),
+    modified(OFFalse)
 {
 }
 
@@ -132,7 +133,8 @@ DcmDirectoryRecord::DcmDirectoryRecord(const DcmTag &tag,
     DirRecordType(ERT_Private),
     referencedMRDR(NULL),
     numberOfReferences(0),
-    offsetInFile(0)
+    offsetInFile(0),
+    modified(OFFalse)
 {
 }
 
@@ -150,7 +152,8 @@ DcmDirectoryRecord::DcmDirectoryRecord(const E_DirRecType recordType,
     DirRecordType(recordType),
     referencedMRDR(NULL),
     numberOfReferences(0),
-    offsetInFile(0)
+    offsetInFile(0),
+    modified(OFFalse)
 {
     setRecordsOriginFile(sourceFilename);
 
@@ -172,7 +175,8 @@ DcmDirectoryRecord::DcmDirectoryRecord(const char *recordTypeName,
     DirRecordType(ERT_Private),
     referencedMRDR(NULL),
     numberOfReferences(0),
-    offsetInFile(0)
+    offsetInFile(0),
+    modified(OFFalse)
 {
     DirRecordType = recordNameToType(recordTypeName);
     setRecordsOriginFile(sourceFilename);
@@ -192,7 +196,8 @@ DcmDirectoryRecord::DcmDirectoryRecord(const DcmDirectoryRecord &old)
     DirRecordType(old.DirRecordType),
     referencedMRDR(old.referencedMRDR),
     numberOfReferences(old.numberOfReferences),
-    offsetInFile(old.offsetInFile)
+    offsetInFile(old.offsetInFile),
+    modified(old.modified)
 {
 }
 
@@ -213,6 +218,7 @@ DcmDirectoryRecord& DcmDirectoryRecord::operator=(const DcmDirectoryRecord& obj)
     referencedMRDR = obj.referencedMRDR;
     numberOfReferences = obj.numberOfReferences;
     offsetInFile = obj.offsetInFile;
+    modified = obj.modified;
   }
   return *this;
 }
@@ -765,6 +771,8 @@ Uint32 DcmDirectoryRecord::getFileOffset() const
 Uint32 DcmDirectoryRecord::setFileOffset(Uint32 position)
 {
     offsetInFile = position;
+    /* the record is (about to be) stored at the new position as it is */
+    modified = OFFalse;
     return position;
 }
 
@@ -772,6 +780,24 @@ Uint32 DcmDirectoryRecord::setFileOffset(Uint32 position)
 // ********************************
 
 
+void DcmDirectoryRecord::setModified(const OFBool newFlag)
+{
+    modified = newFlag;
+}
+
+
+// ********************************
+
+
+OFBool DcmDirectoryRecord::isModified() const
+{
+    return modified;
+}
+
+
+// ********************************
+
+
 OFCondition DcmDirectoryRecord::setNumberOfReferences(Uint32 newRefNum)
 {
     OFCondition l_error = EC_Normal;
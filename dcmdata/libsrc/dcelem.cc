@@ -35,6 +35,7 @@
 #include "dcmtk/dcmdata/dcobject.h"
 #include "dcmtk/dcmdata/dcswap.h"
 #include "dcmtk/dcmdata/dcistrma.h"    /* for class DcmInputStream */
+#include "dcmtk/dcmdata/dcistrmm.h"    /* for class DcmMappedFile */
 #include "dcmtk/dcmdata/dcostrma.h"    /* for class DcmOutputStream */
 #include "dcmtk/dcmdata/dcfcache.h"    /* for class DcmFileCache */
 #include "dcmtk/dcmdata/dcwcache.h"    /* for class DcmWriteCache */
@@ -54,7 +55,8 @@ DcmElement::DcmElement(const DcmTag &tag,
   : DcmObject(tag, len),
     fByteOrder(gLocalByteOrder),
     fLoadValue(NULL),
-    fValue(NULL)
+    fValue(NULL),
+    fValueMapping(NULL)
 {
 }
 
@@ -63,7 +65,8 @@ DcmElement::DcmElement(const DcmElement &elem)
   : DcmObject(elem),
     fByteOrder(elem.fByteOrder),
     fLoadValue(NULL),
-    fValue(NULL)
+    fValue(NULL),
+    fValueMapping(NULL)
 {
     if (elem.fValue)
     {
@@ -118,16 +121,9 @@ DcmElement &DcmElement::operator=(const DcmElement &obj)
 {
   if (this != &obj)
   {
-#if defined(HAVE_STD__NOTHROW) && defined(HAVE_NOTHROW_DELETE)
-    // if created with the nothrow version it must also be deleted with
-    // the nothrow version else memory error.
-    operator delete[] (fValue, std::nothrow);
-#else
-    delete[] fValue;
-#endif
+    freeValueField();
     delete fLoadValue;
     fLoadValue = NULL;
-    fValue = NULL;
 
     DcmObject::operator=(obj);
     fByteOrder = obj.fByteOrder;
@@ -198,13 +194,7 @@ OFCondition DcmElement::copyFrom(const DcmObject& rhs)
 
 DcmElement::~DcmElement()
 {
-#if defined(HAVE_STD__NOTHROW) && defined(HAVE_NOTHROW_DELETE)
-    // if created with the nothrow version it must also be deleted with
-    // the nothrow version else memory error.
-    operator delete[] (fValue, std::nothrow);
-#else
-    delete[] fValue;
-#endif
+    freeValueField();
     delete fLoadValue;
 }
 
@@ -215,14 +205,7 @@ DcmElement::~DcmElement()
 OFCondition DcmElement::clear()
 {
     errorFlag = EC_Normal;
-#if defined(HAVE_STD__NOTHROW) && defined(HAVE_NOTHROW_DELETE)
-    // if created with the nothrow version it must also be deleted with
-    // the nothrow version else memory error.
-    operator delete[] (fValue, std::nothrow);
-#else
-    delete[] fValue;
-#endif
-    fValue = NULL;
+    freeValueField();
     delete fLoadValue;
     fLoadValue = NULL;
     setLengthField(0);
@@ -286,7 +269,10 @@ OFCondition DcmElement::detachValueField(OFBool copy)
     OFCondition l_error = EC_Normal;
     if (getLengthField() != 0)
     {
-        if (copy)
+        /* the caller cannot take over a value field that references a mapped file */
+        if (fValueMapping)
+            l_error = EC_IllegalCall;
+        else if (copy)
         {
             if (!fValue)
                 l_error = loadValue();
@@ -398,6 +384,16 @@ OFCondition DcmElement::getString(char * & /*val*/,
 }
 
 
+OFCondition DcmElement::getStringView(const char * & /*val*/,
+                                      Uint32 & /*len*/,
+                                      const unsigned long /*pos*/,
+                                      OFBool /*normalize*/)
+{
+    errorFlag = EC_IllegalCall;
+    return errorFlag;
+}
+
+
 OFCondition DcmElement::getOFStringArray(OFString &value,
                                          OFBool normalize)
 {
@@ -566,6 +562,25 @@ OFCondition DcmElement::loadValue(DcmInputStream *inStream)
             /* if we did not encounter the end of the stream and no error occured so far, go ahead */
             else if (errorFlag.good())
             {
+                /* if the stream content is mapped into memory, the value field may simply */
+                /* reference the mapped memory instead of being allocated and copied */
+                if (!fValue && (getTransferredBytes() == 0) && !(getLengthField() & 1) && supportsMappedValue())
+                {
+                    DcmMappedFile *mapping = NULL;
+                    Uint8 *mappedValue = readStream->mappedData(getLengthField(), mapping);
+                    /* make sure that the value is properly aligned for 16-bit access */
+                    if (mappedValue && mapping && !(OFreinterpret_cast(size_t, mappedValue) & 1))
+                    {
+                        if (readStream->skip(getLengthField()) == getLengthField())
+                        {
+                            mapping->increaseRefCount();
+                            fValueMapping = mapping;
+                            fValue = mappedValue;
+                            setTransferredBytes(getLengthField());
+                        }
+                    }
+                }
+
                 /* if the object which holds this element's value does not yet exist, create it */
                 if (!fValue)
                     fValue = newValueField(); /* also set errorFlag in case of error */
@@ -673,6 +688,37 @@ Uint8 *DcmElement::newValueField()
 // ********************************
 
 
+OFBool DcmElement::supportsMappedValue() const
+{
+    return OFFalse;
+}
+
+
+void DcmElement::freeValueField()
+{
+    if (fValueMapping)
+    {
+        // the value field references a memory-mapped file, i.e. is not owned by this element
+        fValueMapping->decreaseRefCount();
+        fValueMapping = NULL;
+    }
+    else
+    {
+#if defined(HAVE_STD__NOTHROW) && defined(HAVE_NOTHROW_DELETE)
+        // if created with the nothrow version it must also be deleted with
+        // the nothrow version else memory error.
+        operator delete[] (fValue, std::nothrow);
+#else
+        delete[] fValue;
+#endif
+    }
+    fValue = NULL;
+}
+
+
+// ********************************
+
+
 void DcmElement::postLoadValue()
 {
     if (dcmEnableAutomaticInputDataCorrection.get())
@@ -727,13 +773,7 @@ OFCondition DcmElement::changeValue(const void *value,
                 memcpy(newValue, fValue, size_t(getLengthField()));
                 // set parameter value in the extension
                 memcpy(&newValue[getLengthField()], OFstatic_cast(const Uint8 *, value), size_t(num));
-#if defined(HAVE_STD__NOTHROW) && defined(HAVE_NOTHROW_DELETE)
-                // if created with the nothrow version it must also be deleted with
-                // the nothrow version else memory error.
-                operator delete[] (fValue, std::nothrow);
-#else
-                delete[] fValue;
-#endif
+                freeValueField();
                 fValue = newValue;
                 setLengthField(getLengthField() + num);
             }
@@ -895,17 +935,7 @@ OFCondition DcmElement::putValue(const void * newValue,
 {
     errorFlag = EC_Normal;
 
-    if (fValue)
-    {
-#if defined(HAVE_STD__NOTHROW) && defined(HAVE_NOTHROW_DELETE)
-        // if created with the nothrow version it must also be deleted with
-        // the nothrow version else memory error.
-        operator delete[] (fValue, std::nothrow);
-#else
-        delete[] fValue;
-#endif
-    }
-    fValue = NULL;
+    freeValueField();
 
     if (fLoadValue)
         delete fLoadValue;
@@ -958,17 +988,7 @@ OFCondition DcmElement::createUint16Array(const Uint32 /*numWords*/,
 OFCondition DcmElement::createEmptyValue(const Uint32 length)
 {
     errorFlag = EC_Normal;
-    if (fValue)
-    {
-#if defined(HAVE_STD__NOTHROW) && defined(HAVE_NOTHROW_DELETE)
-        // if created with the nothrow version it must also be deleted with
-        // the nothrow version else memory error.
-        operator delete[] (fValue, std::nothrow);
-#else
-        delete[] fValue;
-#endif
-    }
-    fValue = NULL;
+    freeValueField();
     if (fLoadValue)
         delete fLoadValue;
     fLoadValue = NULL;
@@ -1052,13 +1072,7 @@ OFCondition DcmElement::read(DcmInputStream &inStream,
                     }
                 }
                 /* if there is already a value for this element, delete this value */
-#if defined(HAVE_STD__NOTHROW) && defined(HAVE_NOTHROW_DELETE)
-                // if created with the nothrow version it must also be deleted with
-                // the nothrow version else memory error.
-                operator delete[] (fValue, std::nothrow);
-#else
-                delete[] fValue;
-#endif
+                freeValueField();
                 /* set the transfer state to ERW_inWork */
                 setTransferState(ERW_inWork);
             }
@@ -1511,9 +1525,11 @@ OFCondition DcmElement::getPartialValue(void *targetBuffer,
     {
       readStream = cache->getStream();
 
-      // since we cannot seek back in the stream (only forward), check if the stream
-      // is already past our needed start position
-      if (readStream->tell() - cache->getOffset() > seekoffset)
+      // check if the stream is already past our needed start position. In this
+      // case, move back if the stream supports random access (e.g. a plain file),
+      // otherwise a new stream has to be created.
+      const offile_off_t currentoffset = readStream->tell() - cache->getOffset();
+      if ((currentoffset > seekoffset) && !readStream->rewind(currentoffset - seekoffset))
       {
         readStream = NULL;
       }
@@ -1660,8 +1676,7 @@ void DcmElement::compact()
   {
     DCMDATA_DEBUG("DcmElement::compact() removed element value of " << getTag()
         << " with " << getTransferredBytes() << " bytes");
-    delete[] fValue;
-    fValue = NULL;
+    freeValueField();
     setTransferredBytes(0);
   }
 }
@@ -1673,14 +1688,7 @@ OFCondition DcmElement::createValueFromTempFile(DcmInputStreamFactory *factory,
 {
     if (factory && !(length & 1))
     {
-#if defined(HAVE_STD__NOTHROW) && defined(HAVE_NOTHROW_DELETE)
-        // if created with the nothrow version it must also be deleted with
-        // the nothrow version else memory error.
-        operator delete[] (fValue, std::nothrow);
-#else
-        delete[] fValue;
-#endif
-        fValue = 0;
+        freeValueField();
         delete fLoadValue;
         fLoadValue = factory;
         fByteOrder = byteOrder;
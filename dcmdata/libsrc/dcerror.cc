@@ -61,6 +61,7 @@ makeOFConditionConst(EC_SequDelimitationItemMissing, OFM_dcmdata, 34, OF_error,
 // error codes 35..36 are reserved for specific character set error messages (see below)
 // error code 37 is reserved for XML conversion error messages (see below)
 makeOFConditionConst(EC_ItemDelimitationItemMissing, OFM_dcmdata, 38, OF_error, "Item Delimitation Item missing"             );
+makeOFConditionConst(EC_TagOrderViolated,            OFM_dcmdata, 39, OF_error, "Data elements not in ascending tag order"   );
 
 const unsigned short EC_CODE_CannotSelectCharacterSet  = 35;
 const unsigned short EC_CODE_CannotConvertCharacterSet = 36;
@@ -47,6 +47,7 @@
 #include "dcmtk/dcmdata/dcostrmf.h"    /* for class DcmOutputFileStream */
 #include "dcmtk/dcmdata/dcistrma.h"    /* for class DcmInputStream */
 #include "dcmtk/dcmdata/dcistrmf.h"    /* for class DcmInputFileStream */
+#include "dcmtk/dcmdata/dcistrmm.h"    /* for class DcmInputMappedFileStream */
 #include "dcmtk/dcmdata/dcwcache.h"    /* for class DcmWriteCache */
 
 
@@ -644,6 +645,7 @@ OFCondition DcmFileFormat::read(DcmInputStream &inStream,
                 itemList->insert(metaInfo, ELP_first);
                 // remember the parent
                 metaInfo->setParent(this);
+                invalidateLengthCache();
             }
             if (metaInfo && metaInfo->transferState() != ERW_ready)
             {
@@ -669,6 +671,7 @@ OFCondition DcmFileFormat::read(DcmInputStream &inStream,
                     itemList->insert(dataset, ELP_next);
                     // remember the parent
                     dataset->setParent(this);
+                    invalidateLengthCache();
                 }
                 // check whether to read the dataset at all
                 if (FileReadMode != ERM_metaOnly)
@@ -813,10 +816,22 @@ OFCondition DcmFileFormat::loadFile(const OFFilename &fileName,
     /* check parameters first */
     if (!fileName.isEmpty())
     {
-        /* open file for input */
-        DcmInputFileStream fileStream(fileName);
+        /* open file for input (memory-mapped if requested and possible) */
+        DcmInputStream *fileStream = NULL;
+        if (dcmUseMemoryMappedFiles.get())
+        {
+            fileStream = new DcmInputMappedFileStream(fileName);
+            if (fileStream->status().bad())
+            {
+                DCMDATA_DEBUG("DcmFileFormat::loadFile() cannot map file into memory, using normal file I/O instead");
+                delete fileStream;
+                fileStream = NULL;
+            }
+        }
+        if (fileStream == NULL)
+            fileStream = new DcmInputFileStream(fileName);
         /* check stream status */
-        l_error = fileStream.status();
+        l_error = fileStream->status();
         if (l_error.good())
         {
             /* clear this object */
@@ -828,12 +843,13 @@ OFCondition DcmFileFormat::loadFile(const OFFilename &fileName,
                 FileReadMode = readMode;
                 /* read data from file */
                 transferInit();
-                l_error = read(fileStream, readXfer, groupLength, maxReadLength);
+                l_error = read(*fileStream, readXfer, groupLength, maxReadLength);
                 transferEnd();
                 /* restore old value */
                 FileReadMode = oldMode;
             }
         }
+        delete fileStream;
     }
     return l_error;
 }
@@ -977,6 +993,7 @@ DcmDataset *DcmFileFormat::getAndRemoveDataset()
         DcmSequenceOfItems::itemList->insert(Dataset, ELP_last);
         // remember the parent
         Dataset->setParent(this);
+        invalidateLengthCache();
     }
     else
         errorFlag = EC_IllegalCall;
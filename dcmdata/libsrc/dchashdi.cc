@@ -23,9 +23,11 @@
 #include "dcmtk/dcmdata/dchashdi.h"
 #include "dcmtk/dcmdata/dcdicent.h"
 #include "dcmtk/dcmdata/dctypes.h"
+#include "dcmtk/ofstd/ofatomic.h"
 
 #define INCLUDE_CSTDIO
 #define INCLUDE_CASSERT
+#define INCLUDE_NEW
 #include "dcmtk/ofstd/ofstdinc.h"
 
 /*
@@ -188,9 +190,59 @@ DcmHashDictIterator::init(const DcmHashDict* d, OFBool atEnd)
     }
 }
 
+void
+DcmHashDictIterator::init(const DcmHashDict* d, const OFVector<const DcmStaticHashDict *> *s, OFBool atEnd)
+{
+    staticDicts = s;
+    sindex = 0;
+    eindex = 0;
+    if (atEnd || (s == NULL)) {
+        if (s != NULL)
+            sindex = s->size();
+        init(d, atEnd);
+    } else {
+        /* the hash dictionary is traversed after the static hash tables */
+        init(NULL);
+        dict = d;
+        skipStaticEntries();
+    }
+}
+
+void
+DcmHashDictIterator::skipStaticEntries()
+{
+    while (sindex < staticDicts->size()) {
+        const DcmStaticHashDict *table = (*staticDicts)[sindex];
+        if (eindex >= table->size()) {
+            sindex++;
+            eindex = 0;
+        } else {
+            /* skip entries that are replaced by an entry of the hash dictionary */
+            const DcmDictEntry& e = table->getEntry(eindex);
+            const DcmDictEntry* h = (dict != NULL) ? dict->get(e, e.getPrivateCreator()) : NULL;
+            if ((h == NULL) || (h->getGroup() != e.getGroup()) || (h->getElement() != e.getElement()))
+                return;
+            eindex++;
+        }
+    }
+    init(dict);
+}
+
+const DcmDictEntry*
+DcmHashDictIterator::staticEntry() const
+{
+    return &(*staticDicts)[sindex]->getEntry(eindex);
+}
+
 void
 DcmHashDictIterator::stepUp()
 {
+    if (isStatic()) {
+        eindex++;
+        skipStaticEntries();
+        return;
+    }
+
     assert(dict != NULL);
 
     while (hindex <= dict->highestBucket) {
@@ -408,3 +460,119 @@ DcmHashDict::loadSummary(STD_NAMESPACE ostream& out)
 
     return out;
 }
+
+
+/*
+** DcmStaticHashDict
+*/
+
+const Uint16 DcmStaticHashDict::EmptySlot = 0xffff;
+
+const DcmStaticHashDict*
+DcmStaticHashDict::getTable(DcmStaticHashDictData &data)
+{
+    DcmStaticHashDict *table = OFstatic_cast(DcmStaticHashDict *, data.table);
+    if (table == NULL)
+    {
+        table = new DcmStaticHashDict(data);
+#ifdef OFATOMIC_AVAILABLE
+        // another thread might have created the table in the meantime
+        if (!OFAtomic::compareAndSwap(data.table, NULL, table))
+        {
+            delete table;
+            table = OFstatic_cast(DcmStaticHashDict *, data.table);
+        }
+#else
+        data.table = table;
+#endif
+    }
+    return table;
+}
+
+DcmStaticHashDict::DcmStaticHashDict(const DcmStaticHashDictData &data)
+  : entries_(OFstatic_cast(DcmDictEntry *, ::operator new(data.entryCount * sizeof(DcmDictEntry))))
+  , entryCount_(data.entryCount)
+  , displacements_(data.displacements)
+  , bucketCount_(data.bucketCount)
+  , slots_(data.slots)
+  , slotCount_(data.slotCount)
+{
+    // the strings are not copied, so the entries do not allocate any memory
+    for (unsigned int i = 0; i < entryCount_; ++i)
+    {
+        const DcmDictStaticEntry &e = data.entries[i];
+        new (entries_ + i) DcmDictEntry(e.group, e.element, e.evr, e.tagName,
+            e.vmMin, e.vmMax, e.standardVersion, OFFalse, e.privateCreator);
+    }
+}
+
+DcmStaticHashDict::~DcmStaticHashDict()
+{
+    for (unsigned int i = 0; i < entryCount_; ++i)
+        entries_[i].~DcmDictEntry();
+    ::operator delete(entries_);
+}
+
+const DcmDictEntry&
+DcmStaticHashDict::getEntry(const unsigned int idx) const
+{
+    return entries_[idx];
+}
+
+Uint32
+DcmStaticHashDict::hash(const DcmTagKey& key, const char *privCreator, const Uint32 seed)
+{
+    // FNV-1a hash over the tag key and the private creator name
+    Uint32 h = OFstatic_cast(Uint32, 2166136261UL) ^ (seed * OFstatic_cast(Uint32, 0x9e3779b9UL));
+    const Uint16 g = key.getGroup();
+    const Uint16 e = key.getElement();
+    h = (h ^ (g >> 8)) * 16777619UL;
+    h = (h ^ (g & 0xff)) * 16777619UL;
+    h = (h ^ (e >> 8)) * 16777619UL;
+    h = (h ^ (e & 0xff)) * 16777619UL;
+    if (privCreator)
+    {
+        while (*privCreator)
+            h = (h ^ OFstatic_cast(unsigned char, *privCreator++)) * 16777619UL;
+    }
+    // final mixing, so that different seeds result in independent hash values
+    h ^= h >> 16;
+    h *= OFstatic_cast(Uint32, 0x85ebca6bUL);
+    h ^= h >> 13;
+    h *= OFstatic_cast(Uint32, 0xc2b2ae35UL);
+    h ^= h >> 16;
+    return h;
+}
+
+const DcmDictEntry*
+DcmStaticHashDict::findExact(const DcmTagKey& key, const char *privCreator) const
+{
+    if (entryCount_ == 0)
+        return NULL;
+    const Uint32 displacement = displacements_[hash(key, privCreator, 0) % bucketCount_];
+    const Uint16 idx = slots_[hash(key, privCreator, displacement + 1) % slotCount_];
+    if (idx == EmptySlot)
+        return NULL;
+    // the perfect hash function maps unknown keys to arbitrary slots, so check the key
+    const DcmDictEntry *entry = entries_ + idx;
+    if ((entry->getGroup() == key.getGroup()) && (entry->getElement() == key.getElement()) &&
+        entry->privateCreatorMatch(privCreator))
+    {
+        return entry;
+    }
+    return NULL;
+}
+
+const DcmDictEntry*
+DcmStaticHashDict::get(const DcmTagKey& key, const char *privCreator) const
+{
+    // first we look for an entry that exactly matches the given tag key
+    const DcmDictEntry* entry = findExact(key, privCreator);
+    if ((entry == NULL) && privCreator)
+    {
+        // As a second guess, we look for a private tag with flexible element number.
+        DcmTagKey tk(key.getGroup(), OFstatic_cast(unsigned short, key.getElement() & 0xff));
+        entry = findExact(tk, privCreator);
+    }
+    return entry;
+}
@@ -89,6 +89,20 @@ void DcmInputStream::putback()
   tell_ = mark_;
 }
 
+OFBool DcmInputStream::rewind(offile_off_t num)
+{
+  // the compression filter (if any) does not support random access
+  if ((num > tell_) || (current_ == compressionFilter_) || !current_->rewind(num)) return OFFalse;
+  tell_ -= num;
+  return OFTrue;
+}
+
+Uint8 *DcmInputStream::mappedData(offile_off_t buflen, DcmMappedFile *&mapping)
+{
+  // the compression filter (if any) does not support direct access
+  return current_->mappedData(buflen, mapping);
+}
+
 const DcmProducer *DcmInputStream::currentProducer() const
 {
   return current_;
@@ -128,6 +128,12 @@ void DcmFileProducer::putback(offile_off_t num)
   }
 }
 
+OFBool DcmFileProducer::rewind(offile_off_t num)
+{
+  // in contrast to putback(), a failure does not affect the status
+  return status_.good() && file_.open() && (num <= file_.ftell()) && (file_.fseek(-num, SEEK_CUR) == 0);
+}
+
 
 /* ======================================================================= */
 
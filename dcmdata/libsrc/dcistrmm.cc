@@ -0,0 +1,312 @@
+/*
+ *
+ *  Copyright (C) 2012, OFFIS e.V.
+ *  All rights reserved.  See COPYRIGHT file for details.
+ *
+ *  This software and supporting documentation were developed by
+ *
+ *    OFFIS e.V.
+ *    R&D Division Health
+ *    Escherweg 2
+ *    D-26121 Oldenburg, Germany
+ *
+ *
+ *  Module:  dcmdata
+ *
+ *  Author:  DCMTK team
+ *
+ *  Purpose: DcmInputMappedFileStream and related classes,
+ *    implements streamed input from memory-mapped files.
+ *
+ */
+
+#include "dcmtk/config/osconfig.h"
+#include "dcmtk/dcmdata/dcistrmm.h"
+#include "dcmtk/dcmdata/dcerror.h"
+#include "dcmtk/ofstd/ofstd.h"
+
+#define INCLUDE_CSTDIO
+#define INCLUDE_CSTRING
+#define INCLUDE_CERRNO
+#include "dcmtk/ofstd/ofstdinc.h"
+
+#ifdef HAVE_WINDOWS_H
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#include <io.h>        /* for _get_osfhandle() */
+#endif
+
+BEGIN_EXTERN_C
+#ifdef HAVE_SYS_TYPES_H
+#include <sys/types.h>
+#endif
+#ifdef HAVE_SYS_MMAN_H
+#include <sys/mman.h>
+#endif
+END_EXTERN_C
+
+
+DcmMappedFile::DcmMappedFile(const OFFilename &filename)
+: data_(NULL)
+, size_(0)
+, status_(EC_Normal)
+#ifdef WITH_THREADS
+, refCount_(1)
+, mutex_()
+#else
+, refCount_(1)
+#endif
+{
+  OFFile file;
+  if (file.fopen(filename, "rb"))
+  {
+    // Get number of bytes in file
+    file.fseek(0L, SEEK_END);
+    size_ = file.ftell();
+    if (size_ > 0)
+    {
+      if (OFstatic_cast(offile_off_t, OFstatic_cast(size_t, size_)) != size_)
+      {
+        // the file does not fit into the address space
+        status_ = makeOFCondition(OFM_dcmdata, 18, OF_error, "File too large for memory mapping");
+      }
+      else
+      {
+#if defined(HAVE_WINDOWS_H)
+        // a copy-on-write mapping permits modification of the mapped memory
+        HANDLE hFile = OFreinterpret_cast(HANDLE, _get_osfhandle(file.fileNo()));
+        HANDLE hMapping = CreateFileMapping(hFile, NULL, PAGE_WRITECOPY, 0, 0, NULL);
+        if (hMapping != NULL)
+        {
+          data_ = OFstatic_cast(Uint8 *, MapViewOfFile(hMapping, FILE_MAP_COPY, 0, 0, 0));
+          // the view keeps a reference to the mapping object
+          CloseHandle(hMapping);
+        }
+        if (data_ == NULL)
+          status_ = makeOFCondition(OFM_dcmdata, 18, OF_error, "Cannot create memory mapping of file");
+#elif defined(HAVE_SYS_MMAN_H)
+        // a private mapping permits modification of the mapped memory (copy-on-write)
+        void *addr = mmap(NULL, OFstatic_cast(size_t, size_), PROT_READ | PROT_WRITE, MAP_PRIVATE, file.fileNo(), 0);
+        if (addr != MAP_FAILED)
+          data_ = OFstatic_cast(Uint8 *, addr);
+        else
+        {
+          // the error code of OFFile does not reflect the failed call of mmap()
+          char buf[256];
+          status_ = makeOFCondition(OFM_dcmdata, 18, OF_error, OFStandard::strerror(errno, buf, sizeof(buf)));
+        }
+#else
+        status_ = makeOFCondition(OFM_dcmdata, 18, OF_error, "Memory mapping of files not supported");
+#endif
+      }
+      if (data_ == NULL)
+        size_ = 0;
+    }
+    // the mapping remains valid after the file has been closed
+    file.fclose();
+  }
+  else
+  {
+    OFString s("(unknown error code)");
+    file.getLastErrorString(s);
+    status_ = makeOFCondition(OFM_dcmdata, 18, OF_error, s.c_str());
+  }
+}
+
+DcmMappedFile::~DcmMappedFile()
+{
+  if (data_)
+  {
+#if defined(HAVE_WINDOWS_H)
+    UnmapViewOfFile(data_);
+#elif defined(HAVE_SYS_MMAN_H)
+    munmap(data_, OFstatic_cast(size_t, size_));
+#endif
+  }
+}
+
+DcmMappedFile *DcmMappedFile::newInstance(const OFFilename &filename)
+{
+  return new DcmMappedFile(filename);
+}
+
+void DcmMappedFile::increaseRefCount()
+{
+#ifdef WITH_THREADS
+  mutex_.lock();
+#endif
+  ++refCount_;
+#ifdef WITH_THREADS
+  mutex_.unlock();
+#endif
+}
+
+void DcmMappedFile::decreaseRefCount()
+{
+#ifdef WITH_THREADS
+  mutex_.lock();
+#endif
+  size_t result = --refCount_;
+#ifdef WITH_THREADS
+  mutex_.unlock();
+#endif
+  if (result == 0) delete this;
+}
+
+/* ======================================================================= */
+
+DcmMappedFileProducer::DcmMappedFileProducer(const OFFilename &filename, offile_off_t offset)
+: DcmProducer()
+, mapping_(DcmMappedFile::newInstance(filename)) // adopts the initial reference
+, status_(EC_Normal)
+, pos_(offset)
+{
+  status_ = mapping_->status();
+  if (status_.good() && (offset > mapping_->size()))
+    status_ = EC_InvalidOffset;
+}
+
+DcmMappedFileProducer::DcmMappedFileProducer(DcmMappedFile *mapping, offile_off_t offset)
+: DcmProducer()
+, mapping_(mapping)
+, status_(EC_Normal)
+, pos_(offset)
+{
+  mapping_->increaseRefCount();
+  status_ = mapping_->status();
+  if (status_.good() && (offset > mapping_->size()))
+    status_ = EC_InvalidOffset;
+}
+
+DcmMappedFileProducer::~DcmMappedFileProducer()
+{
+  mapping_->decreaseRefCount();
+}
+
+OFBool DcmMappedFileProducer::good() const
+{
+  return status_.good();
+}
+
+OFCondition DcmMappedFileProducer::status() const
+{
+  return status_;
+}
+
+OFBool DcmMappedFileProducer::eos()
+{
+  return (pos_ >= mapping_->size());
+}
+
+offile_off_t DcmMappedFileProducer::avail()
+{
+  if (status_.good()) return mapping_->size() - pos_; else return 0;
+}
+
+offile_off_t DcmMappedFileProducer::read(void *buf, offile_off_t buflen)
+{
+  offile_off_t result = 0;
+  if (status_.good() && buf && buflen)
+  {
+    result = (mapping_->size() - pos_ < buflen) ? (mapping_->size() - pos_) : buflen;
+    memcpy(buf, mapping_->data() + pos_, OFstatic_cast(size_t, result));
+    pos_ += result;
+  }
+  return result;
+}
+
+offile_off_t DcmMappedFileProducer::skip(offile_off_t skiplen)
+{
+  offile_off_t result = 0;
+  if (status_.good() && skiplen)
+  {
+    result = (mapping_->size() - pos_ < skiplen) ? (mapping_->size() - pos_) : skiplen;
+    pos_ += result;
+  }
+  return result;
+}
+
+void DcmMappedFileProducer::putback(offile_off_t num)
+{
+  if (status_.good() && num)
+  {
+    if (num <= pos_) pos_ -= num;
+    else status_ = EC_PutbackFailed; // tried to putback before start of file
+  }
+}
+
+OFBool DcmMappedFileProducer::rewind(offile_off_t num)
+{
+  if (status_.bad() || (num > pos_)) return OFFalse;
+  pos_ -= num;
+  return OFTrue;
+}
+
+Uint8 *DcmMappedFileProducer::mappedData(offile_off_t buflen, DcmMappedFile *&mapping)
+{
+  Uint8 *result = NULL;
+  if (status_.good() && (mapping_->size() - pos_ >= buflen))
+  {
+    result = mapping_->data() + pos_;
+    mapping = mapping_;
+  }
+  return result;
+}
+
+/* ======================================================================= */
+
+DcmInputMappedFileStreamFactory::DcmInputMappedFileStreamFactory(DcmMappedFile *mapping, offile_off_t offset)
+: DcmInputStreamFactory()
+, mapping_(mapping)
+, offset_(offset)
+{
+  mapping_->increaseRefCount();
+}
+
+DcmInputMappedFileStreamFactory::DcmInputMappedFileStreamFactory(const DcmInputMappedFileStreamFactory& arg)
+: DcmInputStreamFactory(arg)
+, mapping_(arg.mapping_)
+, offset_(arg.offset_)
+{
+  mapping_->increaseRefCount();
+}
+
+DcmInputMappedFileStreamFactory::~DcmInputMappedFileStreamFactory()
+{
+  mapping_->decreaseRefCount();
+}
+
+DcmInputStream *DcmInputMappedFileStreamFactory::create() const
+{
+  return new DcmInputMappedFileStream(mapping_, offset_);
+}
+
+/* ======================================================================= */
+
+DcmInputMappedFileStream::DcmInputMappedFileStream(const OFFilename &filename, offile_off_t offset)
+: DcmInputStream(&producer_) // safe because DcmInputStream only stores pointer
+, producer_(filename, offset)
+{
+}
+
+DcmInputMappedFileStream::DcmInputMappedFileStream(DcmMappedFile *mapping, offile_off_t offset)
+: DcmInputStream(&producer_) // safe because DcmInputStream only stores pointer
+, producer_(mapping, offset)
+{
+}
+
+DcmInputMappedFileStream::~DcmInputMappedFileStream()
+{
+}
+
+DcmInputStreamFactory *DcmInputMappedFileStream::newFactory() const
+{
+  DcmInputStreamFactory *result = NULL;
+  if (currentProducer() == &producer_)
+  {
+    // no filter installed, can create factory object.
+    // The position of the producer is relative to the start of file.
+    result = new DcmInputMappedFileStreamFactory(producer_.mapping(), producer_.tell());
+  }
+  return result;
+}
@@ -81,9 +81,14 @@ DcmItem::DcmItem()
     elementList(NULL),
     lastElementComplete(OFTrue),
     fStartPosition(0),
-    privateCreatorCache()
+    privateCreatorCache(),
+    cachedLength(0),
+    cachedLengthXfer(EXS_Unknown),
+    cachedLengthEncType(EET_UndefinedLength),
+    lengthCacheValid(OFFalse)
 {
     elementList = new DcmList;
+    elementList->setTagIndex(dcmEnableTagIndex.get());
 }
 
 
@@ -93,9 +98,14 @@ DcmItem::DcmItem(const DcmTag &tag,
     elementList(NULL),
     lastElementComplete(OFTrue),
     fStartPosition(0),
-    privateCreatorCache()
+    privateCreatorCache(),
+    cachedLength(0),
+    cachedLengthXfer(EXS_Unknown),
+    cachedLengthEncType(EET_UndefinedLength),
+    lengthCacheValid(OFFalse)
 {
     elementList = new DcmList;
+    elementList->setTagIndex(dcmEnableTagIndex.get());
 }
 
 
@@ -104,8 +114,13 @@ DcmItem::DcmItem(const DcmItem &old)
     elementList(new DcmList),
     lastElementComplete(old.lastElementComplete),
     fStartPosition(old.fStartPosition),
-    privateCreatorCache()
+    privateCreatorCache(),
+    cachedLength(0),
+    cachedLengthXfer(EXS_Unknown),
+    cachedLengthEncType(EET_UndefinedLength),
+    lengthCacheValid(OFFalse)
 {
+    elementList->setTagIndex(dcmEnableTagIndex.get());
     if (!old.elementList->empty())
     {
         elementList->seek(ELP_first);
@@ -130,6 +145,7 @@ DcmItem& DcmItem::operator=(const DcmItem& obj)
 
     // delete any existing elements
     elementList->deleteAllElements();
+    lengthCacheValid = OFFalse;
 
     // copy DcmItem's member variables
     lastElementComplete = obj.lastElementComplete;
@@ -528,6 +544,11 @@ Uint32 DcmItem::calcElementLength(const E_TransferSyntax xfer,
 Uint32 DcmItem::getLength(const E_TransferSyntax xfer,
                           const E_EncodingType enctype)
 {
+    /* the length is needed on each nesting level when writing with explicit
+     * length, so avoid computing it again as long as nothing has changed
+     */
+    if (lengthCacheValid && (cachedLengthXfer == xfer) && (cachedLengthEncType == enctype))
+        return cachedLength;
     Uint32 itemlen = 0;
     Uint32 sublen = 0;
     if (!elementList->empty())
@@ -561,10 +582,26 @@ Uint32 DcmItem::getLength(const E_TransferSyntax xfer,
               itemlen += sublen;
         } while (elementList->seek(ELP_next));
     }
+    /* lengths exceeding the length field are never cached (see above) */
+    cachedLength = itemlen;
+    cachedLengthXfer = xfer;
+    cachedLengthEncType = enctype;
+    lengthCacheValid = OFTrue;
     return itemlen;
 }
 
 
+void DcmItem::invalidateLengthCache()
+{
+    /* if the cache is already invalid, so are the caches of all parent objects */
+    if (lengthCacheValid)
+    {
+        lengthCacheValid = OFFalse;
+        DcmObject::invalidateLengthCache();
+    }
+}
+
+
 // ********************************
 
 
@@ -643,6 +680,7 @@ OFCondition DcmItem::computeGroupLengthAndPadding(const E_GrpLenEncoding glenc,
                     (padenc != EPD_noChange && dO->getTag() == DCM_DataSetTrailingPadding))
                 {
                     delete elementList->remove();
+                    invalidateLengthCache();
                     seekmode = ELP_atpos; // remove advances 1 element forward -> make next seek() work
                     dO = NULL;
                 }
@@ -673,6 +711,7 @@ OFCondition DcmItem::computeGroupLengthAndPadding(const E_GrpLenEncoding glenc,
                             dO = dUL;
                             // remember the parent
                             dO->setParent(this);
+                            invalidateLengthCache();
                             DCMDATA_WARN("DcmItem: Group Length with VR other than UL found, corrected");
                         }
                         /* if the above mentioned condition is not met but the caller specified */
@@ -687,6 +726,7 @@ OFCondition DcmItem::computeGroupLengthAndPadding(const E_GrpLenEncoding glenc,
                             dO = dUL;
                             // remember the parent
                             dO->setParent(this);
+                            invalidateLengthCache();
                         }
 
                         /* in case we want to add padding elements and the current element is a */
@@ -1555,132 +1595,122 @@ OFCondition DcmItem::insert(DcmElement *elem,
     /* do something only if the pointer which was passed does not equal NULL */
     if (elem != NULL)
     {
-        DcmElement *dE;
-        E_ListPos seekmode = ELP_last;
-        /* iterate through elementList (from the last element to the first) */
-        do {
-            /* get current element from elementList */
-            dE = OFstatic_cast(DcmElement *, elementList->seek(seekmode));
-            /* if there is no element, i.e. elementList is empty */
-            if (dE == NULL)
+        /* determine the position in elementList where the new element shall be inserted, */
+        /* i.e. the element with the same tag or the last element with a smaller tag */
+        DcmElement *dE = OFstatic_cast(DcmElement *, elementList->seek_tag(elem->getTag(), OFTrue));
+        if (dE == NULL)
+        {
+            /* insert new element at the beginning of elementList */
+            elementList->insert(elem, ELP_first);
+            if (checkInsertOrder)
             {
-                /* insert new element at the beginning of elementList */
-                elementList->insert(elem, ELP_first);
-                if (checkInsertOrder)
+                // check if we have inserted at the end of the list
+                if (elem != OFstatic_cast(DcmElement *, elementList->seek(ELP_last)))
                 {
-                    // check if we have inserted at the end of the list
-                    if (elem != OFstatic_cast(DcmElement *, elementList->seek(ELP_last)))
-                    {
-                        // produce diagnostics
-                        DCMDATA_WARN("DcmItem: Dataset not in ascending tag order, at element " << elem->getTag());
-                    }
+                    // produce diagnostics
+                    DCMDATA_WARN("DcmItem: Dataset not in ascending tag order, at element " << elem->getTag());
                 }
-                /* dump some information if required */
-                DCMDATA_TRACE("DcmItem::insert() Element " << elem->getTag()
-                    << " VR=\"" << DcmVR(elem->getVR()).getVRName() << "\" inserted at beginning");
-                /* check whether the new element already has a parent */
-                if (elem->getParent() != NULL)
-                {
-                    DCMDATA_DEBUG("DcmItem::insert() Element " << elem->getTag() << " already has a parent: "
-                      << elem->getParent()->getTag() << " VR=" << DcmVR(elem->getParent()->getVR()).getVRName());
-                }
-                /* remember the parent (i.e. the surrounding item/dataset) */
-                elem->setParent(this);
-                /* terminate do-while-loop */
-                break;
             }
-            /* else if the new element's tag is greater than the current element's tag */
-            /* (i.e. we have found the position where the new element shall be inserted) */
-            else if (elem->getTag() > dE->getTag())
+            /* dump some information if required */
+            DCMDATA_TRACE("DcmItem::insert() Element " << elem->getTag()
+                << " VR=\"" << DcmVR(elem->getVR()).getVRName() << "\" inserted at beginning");
+            /* check whether the new element already has a parent */
+            if (elem->getParent() != NULL)
             {
-                /* insert the new element after the current element */
-                elementList->insert(elem, ELP_next);
-                if (checkInsertOrder)
-                {
-                    // check if we have inserted at the end of the list
-                    if (elem != OFstatic_cast(DcmElement *, elementList->seek(ELP_last)))
-                    {
-                        // produce diagnostics
-                        DCMDATA_WARN("DcmItem: Dataset not in ascending tag order, at element " << elem->getTag());
-                    }
-                }
-                /* dump some information if required */
-                DCMDATA_TRACE("DcmItem::insert() Element " << elem->getTag()
-                    << " VR=\"" << DcmVR(elem->getVR()).getVRName() << "\" inserted");
-                /* check whether the new element already has a parent */
-                if (elem->getParent() != NULL)
+                DCMDATA_DEBUG("DcmItem::insert() Element " << elem->getTag() << " already has a parent: "
+                  << elem->getParent()->getTag() << " VR=" << DcmVR(elem->getParent()->getVR()).getVRName());
+            }
+            /* remember the parent (i.e. the surrounding item/dataset) */
+            elem->setParent(this);
+        }
+        /* else if the new element's tag is greater than the current element's tag */
+        /* (i.e. we have found the position where the new element shall be inserted) */
+        else if (elem->getTag() > dE->getTag())
+        {
+            /* insert the new element after the current element */
+            elementList->insert(elem, ELP_next);
+            if (checkInsertOrder)
+            {
+                // check if we have inserted at the end of the list
+                if (elem != OFstatic_cast(DcmElement *, elementList->seek(ELP_last)))
                 {
-                    DCMDATA_DEBUG("DcmItem::insert() Element " << elem->getTag() << " already has a parent: "
-                        << elem->getParent()->getTag() << " VR=" << DcmVR(elem->getParent()->getVR()).getVRName());
+                    // produce diagnostics
+                    DCMDATA_WARN("DcmItem: Dataset not in ascending tag order, at element " << elem->getTag());
                 }
-                /* remember the parent (i.e. the surrounding item/dataset) */
-                elem->setParent(this);
-                /* terminate do-while-loop */
-                break;
             }
-            /* else if the current element and the new element show the same tag */
-            else if (elem->getTag() == dE->getTag())
+            /* dump some information if required */
+            DCMDATA_TRACE("DcmItem::insert() Element " << elem->getTag()
+                << " VR=\"" << DcmVR(elem->getVR()).getVRName() << "\" inserted");
+            /* check whether the new element already has a parent */
+            if (elem->getParent() != NULL)
             {
-                /* if new and current element are not identical */
-                if (elem != dE)
+                DCMDATA_DEBUG("DcmItem::insert() Element " << elem->getTag() << " already has a parent: "
+                    << elem->getParent()->getTag() << " VR=" << DcmVR(elem->getParent()->getVR()).getVRName());
+            }
+            /* remember the parent (i.e. the surrounding item/dataset) */
+            elem->setParent(this);
+        }
+        /* else if the current element and the new element show the same tag */
+        else if (elem->getTag() == dE->getTag())
+        {
+            /* if new and current element are not identical */
+            if (elem != dE)
+            {
+                /* if the current (old) element shall be replaced */
+                if (replaceOld)
                 {
-                    /* if the current (old) element shall be replaced */
-                    if (replaceOld)
-                    {
-                        /* remove current element from list */
-                        DcmObject *remObj = elementList->remove();
+                    /* remove current element from list */
+                    DcmObject *remObj = elementList->remove();
 
-                        /* now the following holds: remObj == dE and elementList */
-                        /* points to the element after the former current element. */
+                    /* now the following holds: remObj == dE and elementList */
+                    /* points to the element after the former current element. */
 
-                        /* if the pointer to the removed object does not */
-                        /* equal NULL (the usual case), delete this object */
-                        /* and dump some information if required */
-                        if (remObj != NULL)
-                        {
-                            /* dump some information if required */
-                            DCMDATA_TRACE("DcmItem::insert() Element " << remObj->getTag()
-                                << " VR=\"" << DcmVR(remObj->getVR()).getVRName()
-                                << "\" p=" << OFstatic_cast(void *, remObj) << " removed and deleted");
-                            delete remObj;
-                        }
-                        /* insert the new element before the current element */
-                        elementList->insert(elem, ELP_prev);
+                    /* if the pointer to the removed object does not */
+                    /* equal NULL (the usual case), delete this object */
+                    /* and dump some information if required */
+                    if (remObj != NULL)
+                    {
                         /* dump some information if required */
-                        DCMDATA_TRACE("DcmItem::insert() Element " << elem->getTag()
-                            << " VR=\"" << DcmVR(elem->getVR()).getVRName()
-                            << "\" p=" << OFstatic_cast(void *, elem) << " replaced older one");
-                        /* check whether the new element already has a parent */
-                        if (elem->getParent() != NULL)
-                        {
-                            DCMDATA_DEBUG("DcmItem::insert() Element " << elem->getTag() << " already has a parent: "
-                                << elem->getParent()->getTag() << " VR=" << DcmVR(elem->getParent()->getVR()).getVRName());
-                        }
-                        /* remember the parent (i.e. the surrounding item/dataset) */
-                        elem->setParent(this);
-                    }   // if (replaceOld)
-                    /* or else, i.e. the current element shall not be replaced by the new element */
-                    else {
-                        /* set the error flag correspondingly; we do not */
-                        /* allow two elements with the same tag in elementList */
-                        errorFlag = EC_DoubledTag;
-                    }   // if (!replaceOld)
-                }   // if (elem != dE)
-                /* if the new and the current element are identical, the caller tries to insert */
-                /* one element twice. Most probably an application error. */
+                        DCMDATA_TRACE("DcmItem::insert() Element " << remObj->getTag()
+                            << " VR=\"" << DcmVR(remObj->getVR()).getVRName()
+                            << "\" p=" << OFstatic_cast(void *, remObj) << " removed and deleted");
+                        delete remObj;
+                    }
+                    /* insert the new element before the current element */
+                    elementList->insert(elem, ELP_prev);
+                    /* dump some information if required */
+                    DCMDATA_TRACE("DcmItem::insert() Element " << elem->getTag()
+                        << " VR=\"" << DcmVR(elem->getVR()).getVRName()
+                        << "\" p=" << OFstatic_cast(void *, elem) << " replaced older one");
+                    /* check whether the new element already has a parent */
+                    if (elem->getParent() != NULL)
+                    {
+                        DCMDATA_DEBUG("DcmItem::insert() Element " << elem->getTag() << " already has a parent: "
+                            << elem->getParent()->getTag() << " VR=" << DcmVR(elem->getParent()->getVR()).getVRName());
+                    }
+                    /* remember the parent (i.e. the surrounding item/dataset) */
+                    elem->setParent(this);
+                }   // if (replaceOld)
+                /* or else, i.e. the current element shall not be replaced by the new element */
                 else {
+                    /* set the error flag correspondingly; we do not */
+                    /* allow two elements with the same tag in elementList */
                     errorFlag = EC_DoubledTag;
-                }
-                /* terminate do-while-loop */
-                break;
+                }   // if (!replaceOld)
+            }   // if (elem != dE)
+            /* if the new and the current element are identical, the caller tries to insert */
+            /* one element twice. Most probably an application error. */
+            else {
+                errorFlag = EC_DoubledTag;
             }
-            /* set the seek mode to "get the previous element" */
-            seekmode = ELP_prev;
-        } while (dE);
+        }
     }
     /* if the pointer which was passed equals NULL, this is an illegal call */
     else
         errorFlag = EC_IllegalCall;
+    /* the length of this item has changed */
+    if (errorFlag.good())
+        invalidateLengthCache();
     /* return result value */
     return errorFlag;
 }
@@ -1778,6 +1808,7 @@ DcmElement *DcmItem::remove(const unsigned long num)
     {
         elementList->remove();          // removes element from list but does not delete it
         elem->setParent(NULL);          // forget about the parent
+        invalidateLengthCache();
     } else
         errorFlag = EC_IllegalCall;
     return elem;
@@ -1790,7 +1821,14 @@ DcmElement *DcmItem::remove(const unsigned long num)
 DcmElement *DcmItem::remove(DcmObject *elem)
 {
     errorFlag = EC_IllegalCall;
-    if (!elementList->empty() && elem != NULL)
+    /* use the tag index (if any) to find the element, fall back to walking the list */
+    if (elem != NULL && elementList->hasTagIndex() && (elementList->seek_tag(elem->getTag()) == elem))
+    {
+        elementList->remove();         // removes element from list but does not delete it
+        elem->setParent(NULL);         // forget about the parent
+        errorFlag = EC_Normal;
+    }
+    else if (!elementList->empty() && elem != NULL)
     {
         DcmObject *dO;
         elementList->seek(ELP_first);
@@ -1807,8 +1845,8 @@ DcmElement *DcmItem::remove(DcmObject *elem)
     }
     if (errorFlag == EC_IllegalCall)
         return NULL;
-    else
-        return OFstatic_cast(DcmElement *, elem);
+    invalidateLengthCache();
+    return OFstatic_cast(DcmElement *, elem);
 }
 
 
@@ -1819,7 +1857,18 @@ DcmElement *DcmItem::remove(const DcmTagKey &tag)
 {
     errorFlag = EC_TagNotFound;
     DcmObject *dO = NULL;
-    if (!elementList->empty())
+    if (elementList->hasTagIndex())
+    {
+        /* use the tag index instead of walking through the element list */
+        dO = elementList->seek_tag(tag);
+        if (dO != NULL)
+        {
+            elementList->remove();         // removes element from list but does not delete it
+            dO->setParent(NULL);           // forget about the parent
+            errorFlag = EC_Normal;
+        }
+    }
+    else if (!elementList->empty())
     {
         elementList->seek(ELP_first);
         do {
@@ -1836,8 +1885,8 @@ DcmElement *DcmItem::remove(const DcmTagKey &tag)
 
     if (errorFlag == EC_TagNotFound)
         return NULL;
-    else
-        return OFstatic_cast(DcmElement *, dO);
+    invalidateLengthCache();
+    return OFstatic_cast(DcmElement *, dO);
 }
 
 
@@ -1850,6 +1899,7 @@ OFCondition DcmItem::clear()
     // remove all elements from item and delete them from memory
     elementList->deleteAllElements();
     setLengthField(0);
+    invalidateLengthCache();
 
     return errorFlag;
 }
@@ -1899,7 +1949,18 @@ OFCondition DcmItem::searchSubFromHere(const DcmTagKey &tag,
 {
     DcmObject *dO;
     OFCondition l_error = EC_TagNotFound;
-    if (!elementList->empty())
+    if (!searchIntoSub && elementList->hasTagIndex())
+    {
+        /* use the tag index instead of walking through the element list */
+        dO = elementList->seek_tag(tag);
+        if (dO != NULL)
+        {
+            resultStack.push(dO);
+            l_error = EC_Normal;
+            DCMDATA_TRACE("DcmItem::searchSubFromHere() Element " << tag << " found");
+        }
+    }
+    else if (!elementList->empty())
     {
         elementList->seek(ELP_first);
         do {
@@ -2454,6 +2515,30 @@ OFCondition DcmItem::findAndGetString(const DcmTagKey& tagKey,
 }
 
 
+OFCondition DcmItem::findAndGetStringView(const DcmTagKey& tagKey,
+                                          const char *&value,
+                                          Uint32 &length,
+                                          const unsigned long pos,
+                                          const OFBool searchIntoSub)
+{
+    DcmElement *elem;
+    /* find the element */
+    OFCondition status = findAndGetElement(tagKey, elem, searchIntoSub);
+    if (status.good())
+    {
+        /* get the value (without copying it) */
+        status = elem->getStringView(value, length, pos);
+    }
+    /* reset values */
+    if (status.bad())
+    {
+        value = NULL;
+        length = 0;
+    }
+    return status;
+}
+
+
 OFCondition DcmItem::findAndGetOFString(const DcmTagKey& tagKey,
                                         OFString &value,
                                         const unsigned long pos,
@@ -3719,24 +3804,33 @@ OFCondition DcmItem::putAndInsertFloat64Array(const DcmTag& tag,
                                               const unsigned long count,
                                               const OFBool replaceOld)
 {
-    OFCondition status = EC_IllegalCall;
+    OFCondition status = EC_Normal;
     /* create new element */
-    if (tag.getEVR() == EVR_FD)
+    DcmElement *elem = NULL;
+    switch(tag.getEVR())
     {
-        DcmElement *elem = new DcmFloatingPointDouble(tag);
-        if (elem != NULL)
-        {
-            /* put value */
-            status = elem->putFloat64Array(value, count);
-            /* insert into dataset/item */
-            if (status.good())
-                status = insert(elem, replaceOld);
-            /* could not be inserted, therefore, delete it immediately */
-            if (status.bad())
-                delete elem;
-        } else
-            status = EC_MemoryExhausted;
+        case EVR_DS:
+            elem = new DcmDecimalString(tag);
+            break;
+        case EVR_FD:
+            elem = new DcmFloatingPointDouble(tag);
+            break;
+        default:
+            status = EC_IllegalCall;
+            break;
     }
+    if (elem != NULL)
+    {
+        /* put value */
+        status = elem->putFloat64Array(value, count);
+        /* insert into dataset/item */
+        if (status.good())
+            status = insert(elem, replaceOld);
+        /* could not be inserted, therefore, delete it immediately */
+        if (status.bad())
+            delete elem;
+    } else if (status.good())
+        status = EC_MemoryExhausted;
     return status;
 }
 
@@ -55,7 +55,9 @@ DcmList::DcmList()
   : firstNode(NULL),
     lastNode(NULL),
     currentNode(NULL),
-    cardinality(0)
+    cardinality(0),
+    useTagIndex(OFFalse),
+    tagIndex()
 {
 }
 
@@ -95,6 +97,7 @@ DcmObject *DcmList::append( DcmObject *obj )
             node->prevNode = lastNode;
             currentNode = lastNode = node;
         }
+        addToIndex(lastNode);
         cardinality++;
     } // obj == NULL
     return obj;
@@ -117,6 +120,7 @@ DcmObject *DcmList::prepend( DcmObject *obj )
             firstNode->prevNode = node;
             currentNode = firstNode = node;
         }
+        addToIndex(firstNode);
         cardinality++;
     } // obj == NULL
     return obj;
@@ -133,6 +137,7 @@ DcmObject *DcmList::insert( DcmObject *obj, E_ListPos pos )
         if ( DcmList::empty() )                 // list is empty !
         {
             currentNode = firstNode = lastNode = new DcmListNode(obj);
+            addToIndex(currentNode);
             cardinality++;
         }
         else {
@@ -155,6 +160,7 @@ DcmObject *DcmList::insert( DcmObject *obj, E_ListPos pos )
                 node->nextNode = currentNode;
                 currentNode->prevNode = node;
                 currentNode = node;
+                addToIndex(node);
                 cardinality++;
             }
             else //( pos==ELP_next || pos==ELP_atpos )
@@ -169,6 +175,7 @@ DcmObject *DcmList::insert( DcmObject *obj, E_ListPos pos )
                 node->prevNode = currentNode;
                 currentNode->nextNode = node;
                 currentNode = node;
+                addToIndex(node);
                 cardinality++;
             }
         }
@@ -204,6 +211,7 @@ DcmObject *DcmList::remove()
             currentNode->nextNode->prevNode = currentNode->prevNode;
 
         currentNode = currentNode->nextNode;
+        removeFromIndex(tempnode);
         tempobj = tempnode->value();
         delete tempnode;
         cardinality--;
@@ -292,4 +300,115 @@ void DcmList::deleteAllElements()
     lastNode = NULL;
     currentNode = NULL;
     cardinality = 0;
+    tagIndex.clear();
+}
+
+
+// ********************************
+
+
+DcmObject *DcmList::seek_tag(const DcmTagKey &tag, const OFBool orPredecessor)
+{
+    DcmListNode *node = NULL;
+    if (useTagIndex)
+    {
+        // binary search for the first node whose tag is not less than the given one
+        const size_t pos = lowerBoundInIndex(tag);
+        if ((pos < tagIndex.size()) && (tagIndex[pos]->value()->getTag() == tag))
+            node = tagIndex[pos];
+        else if (orPredecessor && (pos > 0))
+            node = tagIndex[pos - 1];
+    } else {
+        // walk backwards since new elements are usually added at the end
+        node = lastNode;
+        while ((node != NULL) && (tag < node->value()->getTag()))
+            node = node->prevNode;
+        if ((node != NULL) && !orPredecessor && (node->value()->getTag() != tag))
+            node = NULL;
+    }
+    if (node != NULL)
+        currentNode = node;
+    return (node != NULL) ? node->value() : NULL;
+}
+
+
+// ********************************
+
+
+void DcmList::setTagIndex(const OFBool enable)
+{
+    tagIndex.clear();
+    useTagIndex = enable;
+    if (useTagIndex)
+    {
+        tagIndex.reserve(cardinality);
+        for (DcmListNode *node = firstNode; node != NULL; node = node->nextNode)
+            addToIndex(node);
+    }
+}
+
+
+// ********************************
+
+
+size_t DcmList::lowerBoundInIndex(const DcmTagKey &tag) const
+{
+    size_t first = 0;
+    size_t count = tagIndex.size();
+    while (count > 0)
+    {
+        const size_t step = count / 2;
+        if (tagIndex[first + step]->value()->getTag() < tag)
+        {
+            first += step + 1;
+            count -= step + 1;
+        } else
+            count = step;
+    }
+    return first;
+}
+
+
+// ********************************
+
+
+void DcmList::addToIndex(DcmListNode *node)
+{
+    if (useTagIndex)
+    {
+        const DcmTagKey &tag = node->value()->getTag();
+        // elements are usually added in ascending order, so check the end first
+        if (tagIndex.empty() || !(tag < tagIndex[tagIndex.size() - 1]->value()->getTag()))
+            tagIndex.push_back(node);
+        else
+            tagIndex.insert(tagIndex.begin() + lowerBoundInIndex(tag), node);
+    }
+}
+
+
+// ********************************
+
+
+void DcmList::removeFromIndex(DcmListNode *node)
+{
+    if (useTagIndex)
+    {
+        size_t pos = lowerBoundInIndex(node->value()->getTag());
+        // there might be more than one node with the same tag
+        while ((pos < tagIndex.size()) && (tagIndex[pos] != node))
+        {
+            if (tagIndex[pos]->value()->getTag() != node->value()->getTag())
+            {
+                // should never happen (unless the tag has been modified),
+                // so fall back to a linear search
+                pos = 0;
+                while ((pos < tagIndex.size()) && (tagIndex[pos] != node))
+                    ++pos;
+                break;
+            }
+            ++pos;
+        }
+        if (pos < tagIndex.size())
+            tagIndex.erase(tagIndex.begin() + pos);
+    }
 }
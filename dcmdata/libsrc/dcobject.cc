@@ -54,6 +54,8 @@ OFGlobal<DcmTagKey> dcmStopParsingAfterElement(DCM_UndefinedTagKey); // (0xffff,
 OFGlobal<OFBool>    dcmWriteOversizedSeqsAndItemsUndefined(OFTrue);
 OFGlobal<OFBool>    dcmIgnoreFileMetaInformationGroupLength(OFFalse);
 OFGlobal<OFBool>    dcmReplaceWrongDelimitationItem(OFFalse);
+OFGlobal<OFBool>    dcmEnableTagIndex(OFTrue);
+OFGlobal<OFBool>    dcmUseMemoryMappedFiles(OFFalse);
 
 
 // ****** public methods **********************************
@@ -96,6 +98,9 @@ DcmObject &DcmObject::operator=(const DcmObject &obj)
         errorFlag = obj.errorFlag;
         fTransferState = obj.fTransferState;
         fTransferredBytes = obj.fTransferredBytes;
+        /* the object is no longer the same as the one the parent has seen */
+        if (Parent != NULL)
+            Parent->invalidateLengthCache();
         Parent = NULL;
     }
     return *this;
@@ -105,6 +110,17 @@ DcmObject &DcmObject::operator=(const DcmObject &obj)
 // ********************************
 
 
+void DcmObject::invalidateLengthCache()
+{
+    /* objects without cached length just pass the notification on */
+    if (Parent != NULL)
+        Parent->invalidateLengthCache();
+}
+
+
+// ********************************
+
+
 void DcmObject::transferInit()
 {
     fTransferState = ERW_init;
@@ -28,6 +28,10 @@ DcmOutputStream::DcmOutputStream(DcmConsumer *initial)
 : current_(initial)
 , compressionFilter_(NULL)
 , tell_(0)
+, hasCompressionParameters_(OFFalse)
+, compressionLevel_(-1)
+, compressionStrategy_(0)
+, compressionThreads_(1)
 {
 }
 
@@ -48,7 +52,10 @@ OFCondition DcmOutputStream::installCompressionFilter(E_StreamCompression filter
     {
 #ifdef WITH_ZLIB
       case ESC_zlib:
-        compressionFilter_ = new DcmZLibOutputFilter();
+        if (hasCompressionParameters_)
+          compressionFilter_ = new DcmZLibOutputFilter(compressionLevel_, compressionStrategy_, compressionThreads_);
+        else
+          compressionFilter_ = new DcmZLibOutputFilter();
         if (compressionFilter_) 
         {
           compressionFilter_->append(*current_);
@@ -65,6 +72,16 @@ OFCondition DcmOutputStream::installCompressionFilter(E_StreamCompression filter
   return result;
 }
 
+void DcmOutputStream::setCompressionParameters(const int compressionLevel,
+                                               const int compressionStrategy,
+                                               const Uint32 numberOfThreads)
+{
+  hasCompressionParameters_ = OFTrue;
+  compressionLevel_ = compressionLevel;
+  compressionStrategy_ = compressionStrategy;
+  compressionThreads_ = numberOfThreads;
+}
+
 OFBool DcmOutputStream::good() const
 {
   return current_->good();
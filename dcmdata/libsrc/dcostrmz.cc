@@ -26,8 +26,16 @@
 #include "dcmtk/dcmdata/dcostrmz.h"
 #include "dcmtk/dcmdata/dcerror.h"
 
+#include "dcmtk/ofstd/ofthpool.h"
+
 #define DCMZLIBOUTPUTFILTER_BUFSIZE 4096
 
+/* size of the blocks that are compressed in parallel (as used by pigz) */
+#define DCMZLIBOUTPUTFILTER_BLOCKSIZE 131072
+
+/* size of the dictionary, i.e. the maximum distance of a deflate match */
+#define DCMZLIBOUTPUTFILTER_DICTSIZE 32768
+
 /* taken from zutil.h */
 #if MAX_MEM_LEVEL >= 8
 #define DEF_MEM_LEVEL 8
@@ -36,21 +44,188 @@
 #endif
 
 OFGlobal<int> dcmZlibCompressionLevel(Z_DEFAULT_COMPRESSION);
+OFGlobal<int> dcmZlibCompressionStrategy(Z_DEFAULT_STRATEGY);
+OFGlobal<Uint32> dcmZlibCompressionThreads(1);
+
+
+/* a block of data that is compressed independently from the other blocks.
+ * Each block except for the last one is terminated with a sync flush, i.e.
+ * an empty stored block, so that the compressed blocks can be concatenated
+ * to a single raw deflate bitstream.
+ */
+struct DcmZLibBlock
+{
+  /// zlib codec used for this block
+  z_stream zstream;
+  /// input data of this block
+  const unsigned char *input;
+  /// number of bytes of input data
+  size_t inputLength;
+  /// preceding input data used as dictionary, NULL if none
+  const unsigned char *dictionary;
+  /// number of bytes in dictionary
+  size_t dictionaryLength;
+  /// output buffer for compressed data
+  unsigned char *output;
+  /// size of output buffer
+  size_t outputSize;
+  /// number of bytes of compressed data
+  size_t outputLength;
+  /// true if this is the last block of the bitstream
+  OFBool last;
+  /// zlib status after compression
+  int zstatus;
+};
+
+/* compress the given block, called by the worker threads */
+static void compressBlock(DcmZLibBlock &block)
+{
+  z_streamp zstream = &block.zstream;
+  block.outputLength = 0;
+  block.zstatus = deflateReset(zstream);
+  if ((block.zstatus == Z_OK) && (block.dictionaryLength > 0))
+  {
+    block.zstatus = deflateSetDictionary(zstream, OFconst_cast(Bytef *, block.dictionary),
+      OFstatic_cast(uInt, block.dictionaryLength));
+  }
+  if (block.zstatus == Z_OK)
+  {
+    zstream->next_in = OFconst_cast(Bytef *, block.input);
+    zstream->avail_in = OFstatic_cast(uInt, block.inputLength);
+    zstream->next_out = block.output;
+    zstream->avail_out = OFstatic_cast(uInt, block.outputSize);
+    block.zstatus = deflate(zstream, block.last ? Z_FINISH : Z_SYNC_FLUSH);
+    // the output buffer is large enough for the complete block, so everything must be processed
+    if ((block.zstatus == (block.last ? Z_STREAM_END : Z_OK)) && (zstream->avail_in == 0) && (zstream->avail_out > 0))
+    {
+      block.outputLength = block.outputSize - zstream->avail_out;
+      block.zstatus = Z_OK;
+    }
+    else if (block.zstatus == Z_OK)
+      block.zstatus = Z_BUF_ERROR;
+  }
+}
+
+/* list of blocks compressed by the thread pool, errors are reported in the blocks */
+class DcmZLibBlockJobs : public OFParallelJobs
+{
+public:
+  DcmZLibBlockJobs(DcmZLibBlock *blocks)
+  : blocks_(blocks)
+  {
+  }
+
+  virtual OFCondition processJob(const size_t jobNo, const size_t /* threadNo */)
+  {
+    compressBlock(blocks_[jobNo]);
+    return EC_Normal;
+  }
+
+private:
+  DcmZLibBlock *blocks_;
+};
 
 
 DcmZLibOutputFilter::DcmZLibOutputFilter()
 : DcmOutputFilter()
 , current_(NULL)
-, zstream_(new z_stream)
+, zstream_(NULL)
 , status_(EC_MemoryExhausted)
 , flushed_(OFFalse)
-, inputBuf_(new unsigned char[DCMZLIBOUTPUTFILTER_BUFSIZE])
+, inputBuf_(NULL)
 , inputBufStart_(0)
 , inputBufCount_(0)
-, outputBuf_(new unsigned char[DCMZLIBOUTPUTFILTER_BUFSIZE])
+, outputBuf_(NULL)
 , outputBufStart_(0)
 , outputBufCount_(0)
+, numberOfBlocks_(0)
+, blocks_(NULL)
+, threadPool_(NULL)
+, blockInputBuf_(NULL)
+, blockInputCount_(0)
+, dictionary_(NULL)
+, dictionaryLength_(0)
+, pendingBuf_(NULL)
+, pendingBufSize_(0)
+, pendingBufStart_(0)
+, pendingBufCount_(0)
 {
+  init(dcmZlibCompressionLevel.get(), dcmZlibCompressionStrategy.get(), dcmZlibCompressionThreads.get());
+}
+
+DcmZLibOutputFilter::DcmZLibOutputFilter(const int compressionLevel,
+                                         const int compressionStrategy,
+                                         const Uint32 numberOfThreads)
+: DcmOutputFilter()
+, current_(NULL)
+, zstream_(NULL)
+, status_(EC_MemoryExhausted)
+, flushed_(OFFalse)
+, inputBuf_(NULL)
+, inputBufStart_(0)
+, inputBufCount_(0)
+, outputBuf_(NULL)
+, outputBufStart_(0)
+, outputBufCount_(0)
+, numberOfBlocks_(0)
+, blocks_(NULL)
+, threadPool_(NULL)
+, blockInputBuf_(NULL)
+, blockInputCount_(0)
+, dictionary_(NULL)
+, dictionaryLength_(0)
+, pendingBuf_(NULL)
+, pendingBufSize_(0)
+, pendingBufStart_(0)
+, pendingBufCount_(0)
+{
+  init(compressionLevel, compressionStrategy, numberOfThreads);
+}
+
+void DcmZLibOutputFilter::init(const int compressionLevel,
+                               const int compressionStrategy,
+                               Uint32 numberOfThreads)
+{
+#if defined(ZLIB_ENCODE_RFC1950_HEADER) || !defined(WITH_THREADS)
+  // the blocks of the zlib format cannot be compressed independently (checksum)
+  numberOfThreads = 1;
+#endif
+  if (numberOfThreads > 1)
+  {
+    // compress the blocks with a separate zlib stream each
+    blocks_ = new DcmZLibBlock[numberOfThreads];
+    // some extra space makes sure that avail() never reports less than a tag header
+    blockInputBuf_ = new unsigned char[numberOfThreads * DCMZLIBOUTPUTFILTER_BLOCKSIZE + DCMZLIBOUTPUTFILTER_BUFSIZE];
+    dictionary_ = new unsigned char[DCMZLIBOUTPUTFILTER_DICTSIZE];
+    status_ = EC_Normal;
+    for (Uint32 i = 0; i < numberOfThreads; ++i)
+    {
+      z_streamp zstream = &blocks_[i].zstream;
+      zstream->zalloc = Z_NULL;
+      zstream->zfree = Z_NULL;
+      zstream->opaque = Z_NULL;
+      blocks_[i].output = NULL;
+      if ((status_.good()) && (Z_OK == deflateInit2(zstream, compressionLevel, Z_DEFLATED, -MAX_WBITS, DEF_MEM_LEVEL, compressionStrategy)))
+      {
+        ++numberOfBlocks_;
+        // reserve space for the sync flush marker and the empty last block
+        blocks_[i].outputSize = deflateBound(zstream, DCMZLIBOUTPUTFILTER_BLOCKSIZE) + 64;
+        blocks_[i].output = new unsigned char[blocks_[i].outputSize];
+      }
+      else if (status_.good())
+      {
+        OFString etext = "ZLib Error: ";
+        if (zstream->msg) etext += zstream->msg;
+        status_ = makeOFCondition(OFM_dcmdata, 16, OF_error, etext.c_str());
+      }
+    }
+    // the worker threads are started once and used for all calls of compressBlocks()
+    threadPool_ = new OFThreadPool(numberOfBlocks_);
+    return;
+  }
+  zstream_ = new z_stream;
+  inputBuf_ = new unsigned char[DCMZLIBOUTPUTFILTER_BUFSIZE];
+  outputBuf_ = new unsigned char[DCMZLIBOUTPUTFILTER_BUFSIZE];
   if (zstream_ && inputBuf_ && outputBuf_)
   {
     zstream_->zalloc = Z_NULL;
@@ -62,11 +237,12 @@ DcmZLibOutputFilter::DcmZLibOutputFilter()
      * THE RESULTING BITSTREAM IS NOT DICOM COMPLIANT!
      * Use only for testing, and use with care.
      */
-    if (Z_OK == deflateInit(zstream_, dcmZlibCompressionLevel.get()))
+    if (Z_OK == deflateInit2(zstream_, compressionLevel,
+        Z_DEFLATED, MAX_WBITS, DEF_MEM_LEVEL, compressionStrategy))
 #else
     /* windowBits is passed < 0 to suppress zlib header */
-    if (Z_OK == deflateInit2(zstream_, dcmZlibCompressionLevel.get(),
-        Z_DEFLATED, -MAX_WBITS, DEF_MEM_LEVEL, Z_DEFAULT_STRATEGY))
+    if (Z_OK == deflateInit2(zstream_, compressionLevel,
+        Z_DEFLATED, -MAX_WBITS, DEF_MEM_LEVEL, compressionStrategy))
 #endif
     {
         status_ = EC_Normal;
@@ -89,6 +265,16 @@ DcmZLibOutputFilter::~DcmZLibOutputFilter()
   }
   delete[] inputBuf_;
   delete[] outputBuf_;
+  for (Uint32 i = 0; i < numberOfBlocks_; ++i)
+  {
+    deflateEnd(&blocks_[i].zstream);
+    delete[] blocks_[i].output;
+  }
+  delete threadPool_;
+  delete[] blocks_;
+  delete[] blockInputBuf_;
+  delete[] dictionary_;
+  delete[] pendingBuf_;
 }
 
 
@@ -105,15 +291,103 @@ OFCondition DcmZLibOutputFilter::status() const
 OFBool DcmZLibOutputFilter::isFlushed() const
 {
   if (status_.bad() || (current_ == NULL)) return OFTrue;
+  if (blocks_) return (blockInputCount_ == 0) && (pendingBufCount_ == 0) && flushed_ && current_->isFlushed();
   return (inputBufCount_ == 0) && (outputBufCount_ == 0) && flushed_ && current_->isFlushed();
 }
 
 
 offile_off_t DcmZLibOutputFilter::avail() const
 {
+  if (status_.bad()) return 0;
+  if (blocks_)
+  {
+    // the blocks are compressed as soon as they are full, so at least the extra space
+    // is always available. Do not accept more data while compressed output is pending
+    // and the next filter stage is full.
+    if ((pendingBufCount_ > 0) && current_ && (current_->avail() == 0)) return 0;
+    return numberOfBlocks_ * DCMZLIBOUTPUTFILTER_BLOCKSIZE + DCMZLIBOUTPUTFILTER_BUFSIZE - blockInputCount_;
+  }
   // compute number of bytes available in input buffer
-  if (status_.good() ) return DCMZLIBOUTPUTFILTER_BUFSIZE - inputBufCount_;
-    else return 0;
+  return DCMZLIBOUTPUTFILTER_BUFSIZE - inputBufCount_;
+}
+
+void DcmZLibOutputFilter::compressBlocks(OFBool finalize)
+{
+  // compress all full blocks, or all remaining data when finalizing
+  const size_t capacity = numberOfBlocks_ * DCMZLIBOUTPUTFILTER_BLOCKSIZE;
+  const size_t length = (finalize || (blockInputCount_ < capacity)) ? blockInputCount_ : capacity;
+  // the last block may be empty, e.g. if the size of the input is a multiple of the block size
+  Uint32 count = OFstatic_cast(Uint32, (length + DCMZLIBOUTPUTFILTER_BLOCKSIZE - 1) / DCMZLIBOUTPUTFILTER_BLOCKSIZE);
+  if (finalize && (count == 0)) count = 1;
+  for (Uint32 i = 0; i < count; ++i)
+  {
+    DcmZLibBlock &block = blocks_[i];
+    block.input = blockInputBuf_ + i * DCMZLIBOUTPUTFILTER_BLOCKSIZE;
+    block.inputLength = (i + 1 < count) ? DCMZLIBOUTPUTFILTER_BLOCKSIZE : length - i * DCMZLIBOUTPUTFILTER_BLOCKSIZE;
+    // use the end of the preceding block as dictionary in order to keep the compression ratio
+    block.dictionary = (i == 0) ? dictionary_ : block.input - DCMZLIBOUTPUTFILTER_DICTSIZE;
+    block.dictionaryLength = (i == 0) ? dictionaryLength_ : DCMZLIBOUTPUTFILTER_DICTSIZE;
+    block.last = finalize && (i + 1 == count);
+  }
+  DcmZLibBlockJobs jobs(blocks_);
+  threadPool_->run(jobs, count, OFFalse /* stopOnError */);
+  // append the compressed blocks in the original order
+  for (Uint32 i = 0; (i < count) && status_.good(); ++i)
+  {
+    if (blocks_[i].zstatus == Z_OK)
+      appendPendingOutput(blocks_[i].output, blocks_[i].outputLength);
+    else
+    {
+      OFString etext = "ZLib Error: ";
+      if (blocks_[i].zstream.msg) etext += blocks_[i].zstream.msg;
+      status_ = makeOFCondition(OFM_dcmdata, 16, OF_error, etext.c_str());
+    }
+  }
+  // keep the end of the input as dictionary for the next block
+  if (length > 0)
+  {
+    dictionaryLength_ = (length < DCMZLIBOUTPUTFILTER_DICTSIZE) ? length : DCMZLIBOUTPUTFILTER_DICTSIZE;
+    memcpy(dictionary_, blockInputBuf_ + length - dictionaryLength_, dictionaryLength_);
+  }
+  // move the data that did not fit into the blocks to the start of the buffer
+  blockInputCount_ -= length;
+  if (blockInputCount_ > 0) memmove(blockInputBuf_, blockInputBuf_ + length, blockInputCount_);
+  if (finalize) flushed_ = OFTrue;
+}
+
+void DcmZLibOutputFilter::appendPendingOutput(const unsigned char *buf, size_t buflen)
+{
+  if (pendingBufStart_ + pendingBufCount_ + buflen > pendingBufSize_)
+  {
+    if (pendingBufCount_ + buflen > pendingBufSize_)
+    {
+      // enlarge the buffer
+      const size_t newSize = (2 * pendingBufSize_ > pendingBufCount_ + buflen) ? 2 * pendingBufSize_ : pendingBufCount_ + buflen;
+      unsigned char *newBuf = new unsigned char[newSize];
+      memcpy(newBuf, pendingBuf_ + pendingBufStart_, pendingBufCount_);
+      delete[] pendingBuf_;
+      pendingBuf_ = newBuf;
+      pendingBufSize_ = newSize;
+    }
+    else
+      memmove(pendingBuf_, pendingBuf_ + pendingBufStart_, pendingBufCount_);
+    pendingBufStart_ = 0;
+  }
+  memcpy(pendingBuf_ + pendingBufStart_ + pendingBufCount_, buf, buflen);
+  pendingBufCount_ += buflen;
+}
+
+void DcmZLibOutputFilter::flushPendingOutput()
+{
+  while (pendingBufCount_ > 0)
+  {
+    const offile_off_t written = current_->write(pendingBuf_ + pendingBufStart_, pendingBufCount_);
+    if (written <= 0) break;
+    pendingBufStart_ += OFstatic_cast(size_t, written);
+    pendingBufCount_ -= OFstatic_cast(size_t, written);
+  }
+  // reset buffer start to make things faster
+  if (pendingBufCount_ == 0) pendingBufStart_ = 0;
 }
 
 void DcmZLibOutputFilter::flushOutputBuffer()
@@ -279,6 +553,32 @@ offile_off_t DcmZLibOutputFilter::write(const void *buf, offile_off_t buflen)
 {
   if (status_.bad() || (current_ == NULL)) return 0;
 
+  if (blocks_)
+  {
+    flushPendingOutput();
+    const unsigned char *data = OFstatic_cast(const unsigned char *, buf);
+    const size_t capacity = numberOfBlocks_ * DCMZLIBOUTPUTFILTER_BLOCKSIZE;
+    offile_off_t result = 0;
+    while (status_.good() && (buflen > result))
+    {
+      // fill the input buffer including the extra space, as reported by avail()
+      size_t len = capacity + DCMZLIBOUTPUTFILTER_BUFSIZE - blockInputCount_;
+      if (OFstatic_cast(offile_off_t, len) > buflen - result) len = OFstatic_cast(size_t, buflen - result);
+      memcpy(blockInputBuf_ + blockInputCount_, data + result, len);
+      blockInputCount_ += len;
+      result += len;
+      if (blockInputCount_ >= capacity)
+      {
+        // compress immediately, so that the extra space of the input buffer is always available
+        compressBlocks(OFFalse);
+        flushPendingOutput();
+        // stop if the next filter stage is full
+        if (pendingBufCount_ > 0) break;
+      }
+    }
+    return result;
+  }
+
   // flush output buffer if necessary
   if (outputBufCount_ == DCMZLIBOUTPUTFILTER_BUFSIZE) flushOutputBuffer();
 
@@ -312,7 +612,13 @@ offile_off_t DcmZLibOutputFilter::write(const void *buf, offile_off_t buflen)
 
 void DcmZLibOutputFilter::flush()
 {
-  if (status_.good() && current_)
+  if (status_.good() && current_ && blocks_)
+  {
+    flushPendingOutput();
+    if (!flushed_) compressBlocks(OFTrue);
+    flushPendingOutput();
+  }
+  else if (status_.good() && current_)
   {
     // flush output buffer first
     if (outputBufCount_ == DCMZLIBOUTPUTFILTER_BUFSIZE) flushOutputBuffer();
@@ -26,6 +26,11 @@
 #include "dcmtk/dcmdata/dcdeftag.h"
 #include "dcmtk/dcmdata/dcitem.h"
 
+/* Extended Offset Table (7FE0,0001), which is not yet part of the data dictionary.
+ * It is therefore read with VR UN (or OB), which is fine for accessing its value.
+ */
+static const DcmTagKey DCM_ExtendedOffsetTableTag(0x7fe0, 0x0001);
+
 //
 // class DcmRepresentationEntry
 //
@@ -287,6 +292,7 @@ DcmPixelData::chooseRepresentation(
         // representation found
         current = result;
         recalcVR();
+        invalidateLengthCache();
         l_error = EC_Normal;
     }
     else
@@ -332,6 +338,8 @@ DcmPixelData::clearRepresentationList(
         else
             ++it;
     }
+    /* the length of the pixel data depends on the available representations */
+    invalidateLengthCache();
 }
 
 OFCondition
@@ -355,6 +363,7 @@ DcmPixelData::decode(
         DcmPolymorphOBOW::putUint16Array(NULL,0);
         existUnencapsulated = OFFalse;
     }
+    invalidateLengthCache();
     return l_error;
 }
 
@@ -489,6 +498,8 @@ DcmPixelData::getEncapsulatedRepresentation(
     if (findRepresentationEntry(findEntry, found) == EC_Normal)
     {
         pixSeq = (*found)->pixSeq;
+        /* the caller might modify the pixel sequence */
+        invalidateLengthCache();
         return EC_Normal;
     }
 
@@ -590,6 +601,7 @@ DcmPixelData::insertRepresentationEntry(
     }
     else
         insertedEntry = repList.insert(result,repEntry);
+    invalidateLengthCache();
     return insertedEntry;
 }
 
@@ -642,6 +654,7 @@ DcmPixelData::createUint8Array(
 {
     OFCondition l_error = DcmPolymorphOBOW::createUint8Array(numBytes, bytes);
     existUnencapsulated = OFTrue;
+    invalidateLengthCache();
     return l_error;
 }
 
@@ -652,6 +665,7 @@ DcmPixelData::createUint16Array(
 {
     OFCondition l_error = DcmPolymorphOBOW::createUint16Array(numWords, words);
     existUnencapsulated = OFTrue;
+    invalidateLengthCache();
     return l_error;
 }
 
@@ -663,6 +677,7 @@ DcmPixelData::createValueFromTempFile(
 {
     OFCondition l_error = DcmPolymorphOBOW::createValueFromTempFile(factory, length, byteOrder);
     existUnencapsulated = OFTrue;
+    invalidateLengthCache();
     return l_error;
 }
 
@@ -775,6 +790,7 @@ DcmPixelData::read(
             errorFlag =
                 DcmPolymorphOBOW::read(inStream, ixfer, glenc, maxReadLength);
         }
+        invalidateLengthCache();
     }
 
     /* return result value */
@@ -859,6 +875,7 @@ DcmPixelData::removeOriginalRepresentation(
         else
             l_error = EC_RepresentationNotFound;
     }
+    invalidateLengthCache();
     return l_error;
 }
 
@@ -893,6 +910,7 @@ DcmPixelData::removeRepresentation(
         else
             l_error = EC_RepresentationNotFound;
     }
+    invalidateLengthCache();
     return l_error;
 }
 
@@ -933,6 +951,9 @@ void
 DcmPixelData::transferInit()
 {
     DcmPolymorphOBOW::transferInit();
+    /* the pixel sequences do not notify this object about changes */
+    if (!repList.empty())
+        invalidateLengthCache();
     for (DcmRepresentationListIterator it(repList.begin());
          it != repListEnd;
          ++it)
@@ -1048,6 +1069,7 @@ OFCondition DcmPixelData::loadAllDataIntoMemory(void)
 void DcmPixelData::setNonEncapsulationFlag(OFBool flag)
 {
     alwaysUnencapsulated = flag;
+    invalidateLengthCache();
 }
 
 OFCondition DcmPixelData::getUncompressedFrame(
@@ -1092,6 +1114,18 @@ OFCondition DcmPixelData::getUncompressedFrame(
     else
     {
       // we only have a compressed version of the pixel data.
+      // If the caller does not know the first fragment of the frame, let the pixel sequence
+      // create its frame index, taking the Extended Offset Table into account (if present).
+      DcmPixelSequence *pixSeq = (*original)->pixSeq;
+      if ((startFragment == 0) && (pixSeq != NULL))
+      {
+        DcmElement *extendedOffsetTable = NULL;
+        Uint8 *extendedOffsets = NULL;
+        if (dataset->findAndGetElement(DCM_ExtendedOffsetTableTag, extendedOffsetTable).good())
+          extendedOffsetTable->getUint8Array(extendedOffsets);
+        if (extendedOffsets != NULL)
+          pixSeq->createFrameIndex(OFstatic_cast(Uint32, numberOfFrames), extendedOffsets, extendedOffsetTable->getLength());
+      }
       // Identify a codec for decompressing the frame.
       result = DcmCodecList::decodeFrame(
         (*original)->repType, (*original)->repParam, (*original)->pixSeq,
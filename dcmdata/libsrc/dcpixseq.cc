@@ -33,6 +33,7 @@
 #include "dcmtk/dcmdata/dcpxitem.h"
 #include "dcmtk/dcmdata/dcitem.h"
 #include "dcmtk/dcmdata/dcvr.h"
+#include "dcmtk/dcmdata/dcfcache.h"
 
 #include "dcmtk/dcmdata/dcdeftag.h"
 
@@ -43,7 +44,9 @@
 DcmPixelSequence::DcmPixelSequence(const DcmTag &tag,
                                    const Uint32 len)
   : DcmSequenceOfItems(tag, len),
-    Xfer(EXS_Unknown)
+    Xfer(EXS_Unknown),
+    frameIndex(),
+    frameIndexFrames(0)
 {
     setTagVR(EVR_OB);
     setLengthField(DCM_UndefinedLength); // pixel sequences always use undefined length
@@ -52,7 +55,9 @@ DcmPixelSequence::DcmPixelSequence(const DcmTag &tag,
 
 DcmPixelSequence::DcmPixelSequence(const DcmPixelSequence &old)
   : DcmSequenceOfItems(old),
-    Xfer(old.Xfer)
+    Xfer(old.Xfer),
+    frameIndex(),
+    frameIndexFrames(0)
 {
     /* everything gets handled in DcmSequenceOfItems constructor */
 }
@@ -69,6 +74,8 @@ DcmPixelSequence &DcmPixelSequence::operator=(const DcmPixelSequence &obj)
   {
     DcmSequenceOfItems::operator=(obj);
     Xfer = obj.Xfer;
+    frameIndex.clear();
+    frameIndexFrames = 0;
   }
   return *this;
 }
@@ -236,6 +243,7 @@ OFCondition DcmPixelSequence::insert(DcmPixelItem *item,
         }
         // remember the parent (i.e. the surrounding sequence)
         item->setParent(this);
+        invalidateLengthCache();
     } else
         errorFlag = EC_IllegalCall;
     return errorFlag;
@@ -268,6 +276,7 @@ OFCondition DcmPixelSequence::remove(DcmPixelItem *&item,
     {
         itemList->remove();
         item->setParent(NULL);          // forget about the parent
+        invalidateLengthCache();
     } else
         errorFlag = EC_IllegalCall;
     return errorFlag;
@@ -290,6 +299,7 @@ OFCondition DcmPixelSequence::remove(DcmPixelItem *item)
             {
                 itemList->remove();         // remove element from list, but do no delete it
                 item->setParent(NULL);      // forget about the parent
+                invalidateLengthCache();
                 errorFlag = EC_Normal;
                 break;
             }
@@ -420,3 +430,206 @@ OFCondition DcmPixelSequence::storeCompressedFrame(DcmOffsetList &offsetList,
     offsetList.push_back(currentSize);
     return result;
 }
+
+
+// ********************************
+
+
+/* get the offset of the given frame from an offset table in little endian byte order
+ * with entries of 4 (basic offset table) or 8 bytes (extended offset table)
+ */
+static offile_off_t getFrameOffset(const Uint8 *offsetTable,
+                                   const Uint32 entrySize,
+                                   const Uint32 frameNo)
+{
+    const Uint8 *entry = offsetTable + entrySize * frameNo;
+    offile_off_t offset = OFstatic_cast(offile_off_t, OFstatic_cast(Uint32, entry[0]) | (OFstatic_cast(Uint32, entry[1]) << 8) |
+        (OFstatic_cast(Uint32, entry[2]) << 16) | (OFstatic_cast(Uint32, entry[3]) << 24));
+    if (entrySize == 8)
+    {
+        const Uint32 high = OFstatic_cast(Uint32, entry[4]) | (OFstatic_cast(Uint32, entry[5]) << 8) |
+            (OFstatic_cast(Uint32, entry[6]) << 16) | (OFstatic_cast(Uint32, entry[7]) << 24);
+        if (high != 0)
+        {
+            // offsets beyond 4 GB cannot be represented without large file support
+            if (sizeof(offile_off_t) <= 4) return -1;
+            offset += (OFstatic_cast(offile_off_t, high) << 16) << 16;
+        }
+    }
+    return offset;
+}
+
+
+/* determine the first fragment of each frame from the given offset table. The offsets
+ * are relative to the first byte of the item tag of the first fragment.
+ */
+static OFBool indexFramesByOffset(DcmPixelSequence &pixSeq,
+                                  const Uint8 *offsetTable,
+                                  const Uint32 entrySize,
+                                  const Uint32 numberOfFrames,
+                                  OFVector<Uint32> &frameIndex)
+{
+    frameIndex.clear();
+    // skip the basic offset table
+    DcmObject *pixItem = pixSeq.nextInContainer(NULL);
+    offile_off_t position = 0;
+    Uint32 frame = 0;
+    Uint32 idx = 1;
+    while ((frame < numberOfFrames) && ((pixItem = pixSeq.nextInContainer(pixItem)) != NULL))
+    {
+        const offile_off_t offset = getFrameOffset(offsetTable, entrySize, frame);
+        if (position == offset)
+        {
+            frameIndex.push_back(idx);
+            ++frame;
+        }
+        else if (position > offset)
+        {
+            // offset does not match the start of a fragment (or the table is not ascending)
+            break;
+        }
+        // add the (padded) fragment length plus 8 bytes for the item tag and length field
+        const Uint32 length = pixItem->getLength();
+        position += OFstatic_cast(offile_off_t, length) + (length & 1) + 8;
+        ++idx;
+    }
+    return (frame == numberOfFrames);
+}
+
+
+/* determine the first fragment of each frame by checking which fragments start with
+ * a JPEG start of image (SOI) or JPEG 2000 start of codestream (SOC) marker. Only the
+ * first two bytes of each fragment are read, i.e. the fragments are not loaded.
+ */
+static OFBool indexFramesByMarker(DcmPixelSequence &pixSeq,
+                                  const Uint32 numberOfFrames,
+                                  OFVector<Uint32> &frameIndex)
+{
+    frameIndex.clear();
+    DcmFileCache cache;
+    Uint8 marker[2];
+    // skip the basic offset table
+    DcmObject *pixItem = pixSeq.nextInContainer(NULL);
+    Uint32 idx = 1;
+    while ((pixItem = pixSeq.nextInContainer(pixItem)) != NULL)
+    {
+        OFBool isStart = OFFalse;
+        if ((pixItem->getLength() >= 2) &&
+            OFstatic_cast(DcmPixelItem *, pixItem)->getPartialValue(marker, 0, 2, &cache).good())
+        {
+            isStart = (marker[0] == 0xff) && ((marker[1] == 0xd8) || (marker[1] == 0x4f));
+        }
+        if (isStart)
+        {
+            // more markers than frames, e.g. because of embedded JPEG thumbnails
+            if (frameIndex.size() == numberOfFrames) break;
+            frameIndex.push_back(idx);
+        }
+        // the first fragment must always start a frame
+        else if (idx == 1) break;
+        ++idx;
+    }
+    return (pixItem == NULL) && (frameIndex.size() == numberOfFrames);
+}
+
+
+OFCondition DcmPixelSequence::createFrameIndex(const Uint32 numberOfFrames,
+                                               const Uint8 *extendedOffsetTable,
+                                               const Uint32 extendedOffsetTableLength)
+{
+    const unsigned long numberOfFragments = card();
+    if ((numberOfFrames == 0) || (numberOfFragments <= numberOfFrames))
+        return EC_IllegalCall;
+    /* the index (or the fact that it cannot be determined) is cached, but
+     * another attempt is made if an extended offset table is given
+     */
+    if ((frameIndexFrames != numberOfFrames) || (frameIndex.empty() && (extendedOffsetTable != NULL)))
+    {
+        frameIndex.clear();
+        if (numberOfFrames == 1)
+        {
+            // single frame: all fragments belong to this frame
+            frameIndex.push_back(1);
+        }
+        else if (numberOfFragments == numberOfFrames + 1)
+        {
+            // standard case: there is one fragment per frame
+            for (Uint32 frame = 0; frame < numberOfFrames; ++frame)
+                frameIndex.push_back(frame + 1);
+        }
+        else
+        {
+            // multiple fragments per frame: consult the extended offset table first
+            OFBool found = OFFalse;
+            if ((extendedOffsetTable != NULL) && (extendedOffsetTableLength == 8 * numberOfFrames))
+            {
+                found = indexFramesByOffset(*this, extendedOffsetTable, 8, numberOfFrames, frameIndex);
+                if (!found)
+                    DCMDATA_WARN("DcmPixelSequence: Extended Offset Table does not match the fragments, ignoring it");
+            }
+            // then the basic offset table, which is always in little endian byte order
+            if (!found)
+            {
+                DcmPixelItem *pixItem = NULL;
+                Uint8 *offsetTable = NULL;
+                if (getItem(pixItem, 0).good() && (pixItem->getLength() == 4 * numberOfFrames) &&
+                    pixItem->getUint8Array(offsetTable).good() && (offsetTable != NULL))
+                {
+                    found = indexFramesByOffset(*this, offsetTable, 4, numberOfFrames, frameIndex);
+                }
+            }
+            // finally, scan the fragments for the start of a JPEG or JPEG 2000 stream
+            if (!found)
+            {
+                found = indexFramesByMarker(*this, numberOfFrames, frameIndex);
+                if (found)
+                    DCMDATA_DEBUG("DcmPixelSequence: determined start of " << numberOfFrames << " frames from JPEG markers");
+            }
+            if (!found)
+                frameIndex.clear();
+        }
+        if (!frameIndex.empty())
+            frameIndex.push_back(OFstatic_cast(Uint32, numberOfFragments));
+        frameIndexFrames = numberOfFrames;
+    }
+    return frameIndex.empty() ? EC_TagNotFound : EC_Normal;
+}
+
+
+OFCondition DcmPixelSequence::getFrameStartFragment(const Uint32 frameNo,
+                                                    const Uint32 numberOfFrames,
+                                                    Uint32 &startFragment)
+{
+    if (frameNo >= numberOfFrames)
+        return EC_IllegalCall;
+    /* the first frame always starts with the first fragment after the offset table */
+    if ((frameNo == 0) && (card() > 1))
+    {
+        startFragment = 1;
+        return EC_Normal;
+    }
+    OFCondition result = createFrameIndex(numberOfFrames);
+    if (result.good())
+        startFragment = frameIndex[frameNo];
+    return result;
+}
+
+
+OFCondition DcmPixelSequence::getFrameFragments(const Uint32 numberOfFrames,
+                                                OFVector<Uint32> &startFragments)
+{
+    startFragments.clear();
+    OFCondition result = createFrameIndex(numberOfFrames);
+    if (result.good())
+        startFragments = frameIndex;
+    return result;
+}
+
+
+void DcmPixelSequence::invalidateLengthCache()
+{
+    /* the frame index depends on the number and length of the pixel items */
+    frameIndex.clear();
+    frameIndexFrames = 0;
+    DcmSequenceOfItems::invalidateLengthCache();
+}
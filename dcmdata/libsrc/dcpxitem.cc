@@ -238,14 +238,8 @@ OFCondition DcmPixelItem::writeXML(STD_NAMESPACE ostream&out,
             Uint8 *byteValues = NULL;
             if (getUint8Array(byteValues).good() && (byteValues != NULL))
             {
-                const unsigned long count = getLengthField();
-                out << STD_NAMESPACE hex << STD_NAMESPACE setfill('0');
                 /* print byte values in hex mode */
-                out << STD_NAMESPACE setw(2) << OFstatic_cast(int, *(byteValues++));
-                for (unsigned long i = 1; i < count; i++)
-                    out << "\\" << STD_NAMESPACE setw(2) << OFstatic_cast(int, *(byteValues++));
-                /* reset i/o manipulators */
-                out << STD_NAMESPACE dec << STD_NAMESPACE setfill(' ');
+                writeHexValues(out, byteValues, getLengthField());
             }
         }
     }
@@ -58,6 +58,285 @@ OFBool DcmRLECodecDecoder::canChangeCoding(
 }
 
 
+/* decompresses single frames of an RLE compressed image, see DcmCodec::processFrames() */
+class DcmRLEFrameDecoder : public DcmFrameProcessor
+{
+public:
+  DcmRLEFrameDecoder(const OFVector<DcmCompressedFragment>& aFragments,
+                     const OFVector<Uint32>& aStartFragments,
+                     Uint8 *aImageData,
+                     Uint32 aFrameSize,
+                     Uint16 aColumns,
+                     Uint16 aRows,
+                     Uint16 aSamplesPerPixel,
+                     Uint16 aBytesAllocated,
+                     Uint16 aPlanarConfiguration,
+                     OFBool aReverseByteOrder)
+  : fragments(aFragments)
+  , startFragments(aStartFragments)
+  , imageData(aImageData)
+  , frameSize(aFrameSize)
+  , imageColumns(aColumns)
+  , imageRows(aRows)
+  , imageSamplesPerPixel(aSamplesPerPixel)
+  , imageBytesAllocated(aBytesAllocated)
+  , imagePlanarConfiguration(aPlanarConfiguration)
+  , enableReverseByteOrder(aReverseByteOrder)
+  , nextItem(1) // ignore offset table
+  {
+  }
+
+  virtual OFCondition processFrame(Uint32 frameNo, size_t threadNo);
+
+private:
+
+  /* get the data of the given fragment if it belongs to the current frame */
+  OFCondition getFragment(Uint32 item, Uint32 endItem, Uint8 *&data, Uint32 &length) const
+  {
+    if (item >= endItem) return EC_IllegalCall;
+    data = fragments[item].data;
+    length = fragments[item].length;
+    return EC_Normal;
+  }
+
+  const OFVector<DcmCompressedFragment>& fragments;
+  /* first fragment of each frame, empty if the frames are decompressed in ascending order */
+  const OFVector<Uint32>& startFragments;
+  Uint8 *imageData;
+  const Uint32 frameSize;
+  const Uint32 imageColumns;
+  const Uint32 imageRows;
+  const Uint32 imageSamplesPerPixel;
+  const Uint32 imageBytesAllocated;
+  const Uint16 imagePlanarConfiguration;
+  const OFBool enableReverseByteOrder;
+  /* first fragment of the next frame if the frames are decompressed in ascending order */
+  Uint32 nextItem;
+};
+
+
+OFCondition DcmRLEFrameDecoder::processFrame(Uint32 frameNo, size_t /* threadNo */)
+{
+  // without a list of start fragments, each frame starts after the previous one
+  Uint32 currentItem = startFragments.empty() ? nextItem : startFragments[frameNo];
+  const Uint32 endItem = startFragments.empty() ? OFstatic_cast(Uint32, fragments.size()) : startFragments[frameNo + 1];
+  Uint8 *imageData8 = imageData + frameNo * frameSize;
+  Uint8 *rleData = NULL;
+  const size_t bytesPerStripe = imageColumns * imageRows;
+  Uint32 rleHeader[16];
+  Uint32 numberOfStripes = 0;
+  Uint32 fragmentLength = 0;
+  Uint32 i;
+  OFCondition result = EC_Normal;
+
+  // each thread needs its own RLE decoder
+  DcmRLEDecoder rledecoder(bytesPerStripe);
+  if (rledecoder.fail()) return EC_MemoryExhausted;  // RLE decoder failed to initialize
+
+  DCMDATA_DEBUG("RLE decoder processes frame " << frameNo);
+  DCMDATA_DEBUG("RLE decoder processes pixel item " << currentItem);
+  // get first pixel item of this frame
+  result = getFragment(currentItem++, endItem, rleData, fragmentLength);
+  if (result.good())
+  {
+    // we require that the RLE header must be completely
+    // contained in the first fragment; otherwise bail out
+    if (fragmentLength < 64) result = EC_CannotChangeRepresentation;
+  }
+
+  if (result.good())
+  {
+    // copy RLE header to buffer and adjust byte order
+    memcpy(rleHeader, rleData, 64);
+    swapIfNecessary(gLocalByteOrder, EBO_LittleEndian, rleHeader, 16*sizeof(Uint32), sizeof(Uint32));
+
+    // determine number of stripes.
+    numberOfStripes = rleHeader[0];
+
+    // check that number of stripes in RLE header matches our expectation
+    if ((numberOfStripes < 1) || (numberOfStripes > 15) ||
+        (numberOfStripes != OFstatic_cast(Uint32, imageBytesAllocated) * imageSamplesPerPixel))
+        result = EC_CannotChangeRepresentation;
+  }
+
+  if (result.good())
+  {
+    // this variable keeps the number of bytes we have processed
+    // for the current frame in earlier pixel fragments
+    Uint32 fragmentOffset = 0;
+
+    // this variable keeps the current position within the current fragment
+    Uint32 byteOffset = 0;
+
+    OFBool lastStripe = OFFalse;
+    Uint32 inputBytes = 0;
+
+    // pointers for buffer copy operations
+    Uint8 *outputBuffer = NULL;
+    Uint8 *pixelPointer = NULL;
+
+    // byte offset for first sample in frame
+    Uint32 sampleOffset = 0;
+
+    // byte offset between samples
+    Uint32 offsetBetweenSamples = 0;
+
+    // temporary variables
+    Uint32 sample = 0;
+    Uint32 byte = 0;
+    register Uint32 pixel = 0;
+
+    // for each stripe in stripe set
+    for (i=0; (i<numberOfStripes) && result.good(); ++i)
+    {
+      // reset RLE codec
+      rledecoder.clear();
+
+      // adjust start point for RLE stripe, ignoring trailing garbage from the last run
+      byteOffset = rleHeader[i+1];
+      if (byteOffset < fragmentOffset) result = EC_CannotChangeRepresentation;
+      else
+      {
+        byteOffset -= fragmentOffset; // now byteOffset is correct but may point to next fragment
+        while ((byteOffset > fragmentLength) && result.good())
+        {
+          DCMDATA_DEBUG("RLE decoder processes pixel item " << currentItem);
+          byteOffset -= fragmentLength;
+          fragmentOffset += fragmentLength;
+          result = getFragment(currentItem++, endItem, rleData, fragmentLength);
+        }
+      }
+
+      // byteOffset now points to the first byte of the new RLE stripe
+      // check if the current stripe is the last one for this frame
+      if (i+1 == numberOfStripes) lastStripe = OFTrue; else lastStripe = OFFalse;
+
+      if (lastStripe)
+      {
+        // the last stripe needs special handling because we cannot use the
+        // offset table to determine the number of bytes to feed to the codec
+        // if the RLE data is split in multiple fragments. We need to feed
+        // data fragment by fragment until the RLE codec has produced
+        // sufficient output.
+        while ((rledecoder.size() < bytesPerStripe) && result.good())
+        {
+          // feed complete remaining content of fragment to RLE codec and
+          // switch to next fragment
+          result = rledecoder.decompress(rleData + byteOffset, OFstatic_cast(size_t, fragmentLength - byteOffset));
+
+          // special handling for zero pad byte at the end of the RLE stream
+          // which results in an EC_StreamNotifyClient return code
+          // or trailing garbage data which results in EC_CorruptedData
+          if (rledecoder.size() == bytesPerStripe) result = EC_Normal;
+
+          // Check if we're already done. If yes, don't change fragment
+          if (result.good() || result == EC_StreamNotifyClient)
+          {
+            if (rledecoder.size() < bytesPerStripe)
+            {
+              DCMDATA_WARN("RLE decoder is finished but has produced insufficient data for this stripe, will continue with next pixel item");
+              DCMDATA_DEBUG("RLE decoder processes pixel item " << currentItem);
+              byteOffset = 0;
+              fragmentOffset += fragmentLength;
+              result = getFragment(currentItem++, endItem, rleData, fragmentLength);
+            }
+            else byteOffset = fragmentLength;
+          }
+        } /* while */
+      }
+      else
+      {
+        // not the last stripe. We can use the offset table to determine
+        // the number of bytes to feed to the RLE codec.
+        inputBytes = rleHeader[i+2];
+        if (inputBytes < rleHeader[i+1]) result = EC_CannotChangeRepresentation;
+        else
+        {
+          inputBytes -= rleHeader[i+1]; // number of bytes to feed to codec
+          while ((inputBytes > (fragmentLength - byteOffset)) && result.good())
+          {
+            // feed complete remaining content of fragment to RLE codec and
+            // switch to next fragment
+            result = rledecoder.decompress(rleData + byteOffset, OFstatic_cast(size_t, fragmentLength - byteOffset));
+
+            if (result.good() || result == EC_StreamNotifyClient)
+            {
+              DCMDATA_DEBUG("RLE decoder processes pixel item " << currentItem);
+              inputBytes -= fragmentLength - byteOffset;
+              byteOffset = 0;
+              fragmentOffset += fragmentLength;
+              result = getFragment(currentItem++, endItem, rleData, fragmentLength);
+            }
+          } /* while */
+
+          // last fragment for this RLE stripe
+          result = rledecoder.decompress(rleData + byteOffset, OFstatic_cast(size_t, inputBytes));
+
+          // special handling for zero pad byte at the end of the RLE stream
+          // which results in an EC_StreamNotifyClient return code
+          // or trailing garbage data which results in EC_CorruptedData
+          if (rledecoder.size() == bytesPerStripe) result = EC_Normal;
+
+          byteOffset += inputBytes;
+        }
+      }
+
+      // make sure the RLE decoder has produced the right amount of data
+      if (result.good() && (rledecoder.size() != bytesPerStripe))
+      {
+          DCMDATA_ERROR("RLE decoder is finished but has produced insufficient data for this stripe");
+          result = EC_CannotChangeRepresentation;
+      }
+
+      // distribute decompressed bytes into output image array
+      if (result.good())
+      {
+        // which sample and byte are we currently compressing?
+        sample = i / imageBytesAllocated;
+        byte = i % imageBytesAllocated;
+
+        // raw buffer containing bytesPerStripe bytes of uncompressed data
+        outputBuffer = OFstatic_cast(Uint8 *, rledecoder.getOutputBuffer());
+
+        // compute byte offsets
+        if (imagePlanarConfiguration == 0)
+        {
+           sampleOffset = sample * imageBytesAllocated;
+           offsetBetweenSamples = imageSamplesPerPixel * imageBytesAllocated;
+        }
+        else
+        {
+           sampleOffset = sample * imageBytesAllocated * imageColumns * imageRows;
+           offsetBetweenSamples = imageBytesAllocated;
+        }
+
+        // initialize pointer to output data
+        if (enableReverseByteOrder)
+        {
+          // assume incorrect LSB to MSB order of RLE segments as produced by some tools
+          pixelPointer = imageData8 + sampleOffset + byte;
+        }
+        else
+        {
+          pixelPointer = imageData8 + sampleOffset + imageBytesAllocated - byte - 1;
+        }
+
+        // loop through all pixels of the frame
+        for (pixel = 0; pixel < bytesPerStripe; ++pixel)
+        {
+          *pixelPointer = *outputBuffer++;
+          pixelPointer += offsetBetweenSamples;
+        }
+      }
+    } /* for */
+  }
+
+  // the next frame starts with the next fragment
+  if (result.good()) nextItem = currentItem;
+  return result;
+}
+
+
 OFCondition DcmRLECodecDecoder::decode(
     const DcmRepresentationParameter * /* fromRepParam */,
     DcmPixelSequence * pixSeq,
@@ -85,7 +364,6 @@ OFCondition DcmRLECodecDecoder::decode(
     Uint16 imageBitsAllocated = 0;
     Uint16 imageBytesAllocated = 0;
     Uint16 imagePlanarConfiguration = 0;
-    Uint32 rleHeader[16];
     DcmItem *ditem = OFstatic_cast(DcmItem *, dataset);
     OFBool numberOfFramesPresent = OFFalse;
 
@@ -116,268 +394,44 @@ OFCondition DcmRLECodecDecoder::decode(
 
     if (result.good())
     {
-      DcmPixelItem *pixItem = NULL;
-      Uint8 * rleData = NULL;
-      const size_t bytesPerStripe = imageColumns * imageRows;
-
-      DcmRLEDecoder rledecoder(bytesPerStripe);
-      if (rledecoder.fail()) result = EC_MemoryExhausted;  // RLE decoder failed to initialize
-      else
+      Uint32 frameSize = imageBytesAllocated * imageRows * imageColumns * imageSamplesPerPixel;
+      Uint32 totalSize = frameSize * imageFrames;
+      if (totalSize & 1) totalSize++; // align on 16-bit word boundary
+      Uint16 *imageData16 = NULL;
+      OFVector<DcmCompressedFragment> fragments;
+      OFVector<Uint32> startFragments;
+      Uint32 numberOfThreads = djcp->getNumberOfThreads();
+
+      // load all fragments, so that they can be accessed by multiple threads
+      result = loadFragments(pixSeq, fragments);
+
+      // frames can only be decompressed concurrently if their first fragments are known in advance
+      if (result.good() && (numberOfThreads > 1) && (imageFrames > 1))
       {
-        Uint32 frameSize = imageBytesAllocated * imageRows * imageColumns * imageSamplesPerPixel;
-        Uint32 totalSize = frameSize * imageFrames;
-        if (totalSize & 1) totalSize++; // align on 16-bit word boundary
-        Uint16 *imageData16 = NULL;
-        Sint32 currentFrame = 0;
-        Uint32 currentItem = 1; // ignore offset table
-        Uint32 numberOfStripes = 0;
-        Uint32 fragmentLength = 0;
-        Uint32 i;
-
-        result = uncompressedPixelData.createUint16Array(totalSize/sizeof(Uint16), imageData16);
-        if (result.good())
+        if (determineFrameFragments(imageFrames, pixSeq, startFragments).bad())
         {
-          Uint8 *imageData8 = OFreinterpret_cast(Uint8 *, imageData16);
-
-          while ((currentFrame < imageFrames) && result.good())
-          {
-            DCMDATA_DEBUG("RLE decoder processes frame " << currentFrame);
-            DCMDATA_DEBUG("RLE decoder processes pixel item " << currentItem);
-            // get first pixel item of this frame
-            result = pixSeq->getItem(pixItem, currentItem++);
-            if (result.good())
-            {
-              fragmentLength = pixItem->getLength();
-              result = pixItem->getUint8Array(rleData);
-              if (result.good())
-              {
-                // we require that the RLE header must be completely
-                // contained in the first fragment; otherwise bail out
-                if (fragmentLength < 64) result = EC_CannotChangeRepresentation;
-              }
-            }
-
-            if (result.good())
-            {
-              // copy RLE header to buffer and adjust byte order
-              memcpy(rleHeader, rleData, 64);
-              swapIfNecessary(gLocalByteOrder, EBO_LittleEndian, rleHeader, 16*sizeof(Uint32), sizeof(Uint32));
-
-              // determine number of stripes.
-              numberOfStripes = rleHeader[0];
-
-              // check that number of stripes in RLE header matches our expectation
-              if ((numberOfStripes < 1) || (numberOfStripes > 15) ||
-                  (numberOfStripes != OFstatic_cast(Uint32, imageBytesAllocated) * imageSamplesPerPixel))
-                  result = EC_CannotChangeRepresentation;
-            }
-
-            if (result.good())
-            {
-              // this variable keeps the number of bytes we have processed
-              // for the current frame in earlier pixel fragments
-              Uint32 fragmentOffset = 0;
-
-              // this variable keeps the current position within the current fragment
-              Uint32 byteOffset = 0;
-
-              OFBool lastStripe = OFFalse;
-              Uint32 inputBytes = 0;
-
-              // pointers for buffer copy operations
-              Uint8 *outputBuffer = NULL;
-              Uint8 *pixelPointer = NULL;
-
-              // byte offset for first sample in frame
-              Uint32 sampleOffset = 0;
-
-              // byte offset between samples
-              Uint32 offsetBetweenSamples = 0;
-
-              // temporary variables
-              Uint32 sample = 0;
-              Uint32 byte = 0;
-              register Uint32 pixel = 0;
-
-              // for each stripe in stripe set
-              for (i=0; (i<numberOfStripes) && result.good(); ++i)
-              {
-                // reset RLE codec
-                rledecoder.clear();
-
-                // adjust start point for RLE stripe, ignoring trailing garbage from the last run
-                byteOffset = rleHeader[i+1];
-                if (byteOffset < fragmentOffset) result = EC_CannotChangeRepresentation;
-                else
-                {
-                  byteOffset -= fragmentOffset; // now byteOffset is correct but may point to next fragment
-                  while ((byteOffset > fragmentLength) && result.good())
-                  {
-                    DCMDATA_DEBUG("RLE decoder processes pixel item " << currentItem);
-                    result = pixSeq->getItem(pixItem, currentItem++);
-                    if (result.good())
-                    {
-                      byteOffset -= fragmentLength;
-                      fragmentOffset += fragmentLength;
-                      fragmentLength = pixItem->getLength();
-                      result = pixItem->getUint8Array(rleData);
-                    }
-                  }
-                }
-
-                // byteOffset now points to the first byte of the new RLE stripe
-                // check if the current stripe is the last one for this frame
-                if (i+1 == numberOfStripes) lastStripe = OFTrue; else lastStripe = OFFalse;
-
-                if (lastStripe)
-                {
-                  // the last stripe needs special handling because we cannot use the
-                  // offset table to determine the number of bytes to feed to the codec
-                  // if the RLE data is split in multiple fragments. We need to feed
-                  // data fragment by fragment until the RLE codec has produced
-                  // sufficient output.
-                  while ((rledecoder.size() < bytesPerStripe) && result.good())
-                  {
-                    // feed complete remaining content of fragment to RLE codec and
-                    // switch to next fragment
-                    result = rledecoder.decompress(rleData + byteOffset, OFstatic_cast(size_t, fragmentLength - byteOffset));
-
-                    // special handling for zero pad byte at the end of the RLE stream
-                    // which results in an EC_StreamNotifyClient return code
-                    // or trailing garbage data which results in EC_CorruptedData
-                    if (rledecoder.size() == bytesPerStripe) result = EC_Normal;
-
-                    // Check if we're already done. If yes, don't change fragment
-                    if (result.good() || result == EC_StreamNotifyClient)
-                    {
-                      if (rledecoder.size() < bytesPerStripe)
-                      {
-                        DCMDATA_WARN("RLE decoder is finished but has produced insufficient data for this stripe, will continue with next pixel item");
-                        DCMDATA_DEBUG("RLE decoder processes pixel item " << currentItem);
-                        result = pixSeq->getItem(pixItem, currentItem++);
-                        if (result.good())
-                        {
-                          byteOffset = 0;
-                          fragmentOffset += fragmentLength;
-                          fragmentLength = pixItem->getLength();
-                          result = pixItem->getUint8Array(rleData);
-                        }
-                      }
-                      else byteOffset = fragmentLength;
-                    }
-                  } /* while */
-                }
-                else
-                {
-                  // not the last stripe. We can use the offset table to determine
-                  // the number of bytes to feed to the RLE codec.
-                  inputBytes = rleHeader[i+2];
-                  if (inputBytes < rleHeader[i+1]) result = EC_CannotChangeRepresentation;
-                  else
-                  {
-                    inputBytes -= rleHeader[i+1]; // number of bytes to feed to codec
-                    while ((inputBytes > (fragmentLength - byteOffset)) && result.good())
-                    {
-                      // feed complete remaining content of fragment to RLE codec and
-                      // switch to next fragment
-                      result = rledecoder.decompress(rleData + byteOffset, OFstatic_cast(size_t, fragmentLength - byteOffset));
-
-                      if (result.good() || result == EC_StreamNotifyClient)
-                      {
-                        DCMDATA_DEBUG("RLE decoder processes pixel item " << currentItem);
-                        result = pixSeq->getItem(pixItem, currentItem++);
-                      }
-                      if (result.good())
-                      {
-                        inputBytes -= fragmentLength - byteOffset;
-                        byteOffset = 0;
-                        fragmentOffset += fragmentLength;
-                        fragmentLength = pixItem->getLength();
-                        result = pixItem->getUint8Array(rleData);
-                      }
-                    } /* while */
-
-                    // last fragment for this RLE stripe
-                    result = rledecoder.decompress(rleData + byteOffset, OFstatic_cast(size_t, inputBytes));
-
-                    // special handling for zero pad byte at the end of the RLE stream
-                    // which results in an EC_StreamNotifyClient return code
-                    // or trailing garbage data which results in EC_CorruptedData
-                    if (rledecoder.size() == bytesPerStripe) result = EC_Normal;
-
-                    byteOffset += inputBytes;
-                  }
-                }
-
-                // make sure the RLE decoder has produced the right amount of data
-                if (result.good() && (rledecoder.size() != bytesPerStripe))
-                {
-                    DCMDATA_ERROR("RLE decoder is finished but has produced insufficient data for this stripe");
-                    result = EC_CannotChangeRepresentation;
-                }
-
-                // distribute decompressed bytes into output image array
-                if (result.good())
-                {
-                  // which sample and byte are we currently compressing?
-                  sample = i / imageBytesAllocated;
-                  byte = i % imageBytesAllocated;
-
-                  // raw buffer containing bytesPerStripe bytes of uncompressed data
-                  outputBuffer = OFstatic_cast(Uint8 *, rledecoder.getOutputBuffer());
-
-                  // compute byte offsets
-                  if (imagePlanarConfiguration == 0)
-                  {
-                     sampleOffset = sample * imageBytesAllocated;
-                     offsetBetweenSamples = imageSamplesPerPixel * imageBytesAllocated;
-                  }
-                  else
-                  {
-                     sampleOffset = sample * imageBytesAllocated * imageColumns * imageRows;
-                     offsetBetweenSamples = imageBytesAllocated;
-                  }
-
-                  // initialize pointer to output data
-                  if (enableReverseByteOrder)
-                  {
-                    // assume incorrect LSB to MSB order of RLE segments as produced by some tools
-                    pixelPointer = imageData8 + sampleOffset + byte;
-                  }
-                  else
-                  {
-                    pixelPointer = imageData8 + sampleOffset + imageBytesAllocated - byte - 1;
-                  }
-
-                  // loop through all pixels of the frame
-                  for (pixel = 0; pixel < bytesPerStripe; ++pixel)
-                  {
-                    *pixelPointer = *outputBuffer++;
-                    pixelPointer += offsetBetweenSamples;
-                  }
-                }
-              } /* for */
-            }
-
-            // advance by one frame
-            if (result.good())
-            {
-              currentFrame++;
-              imageData8 += frameSize;
-            }
+          DCMDATA_DEBUG("RLE decoder cannot determine the fragments of each frame, decompressing frames sequentially");
+          numberOfThreads = 1;
+        }
+      }
 
-          } /* while still frames to process */
+      if (result.good()) result = uncompressedPixelData.createUint16Array(totalSize/sizeof(Uint16), imageData16);
+      if (result.good())
+      {
+        DcmRLEFrameDecoder frameDecoder(fragments, startFragments, OFreinterpret_cast(Uint8 *, imageData16),
+          frameSize, imageColumns, imageRows, imageSamplesPerPixel, imageBytesAllocated,
+          imagePlanarConfiguration, enableReverseByteOrder);
+        result = processFrames(frameDecoder, imageFrames, numberOfThreads);
 
-          // adjust byte order for uncompressed image to little endian
-          swapIfNecessary(EBO_LittleEndian, gLocalByteOrder, imageData16, totalSize, sizeof(Uint16));
+        // adjust byte order for uncompressed image to little endian
+        swapIfNecessary(EBO_LittleEndian, gLocalByteOrder, imageData16, totalSize, sizeof(Uint16));
 
-          // Number of Frames might have changed in case the previous value was wrong
-          if (result.good() && (numberOfFramesPresent || (imageFrames > 1)))
-          {
-            char numBuf[20];
-            sprintf(numBuf, "%ld", OFstatic_cast(long, imageFrames));
-            result = OFstatic_cast(DcmItem *, dataset)->putAndInsertString(DCM_NumberOfFrames, numBuf);
-          }
+        // Number of Frames might have changed in case the previous value was wrong
+        if (result.good() && (numberOfFramesPresent || (imageFrames > 1)))
+        {
+          char numBuf[20];
+          sprintf(numBuf, "%ld", OFstatic_cast(long, imageFrames));
+          result = OFstatic_cast(DcmItem *, dataset)->putAndInsertString(DCM_NumberOfFrames, numBuf);
         }
       }
     }
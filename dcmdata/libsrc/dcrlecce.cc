@@ -39,6 +39,171 @@ typedef OFList<DcmRLEEncoder *> DcmRLEEncoderList;
 typedef OFListIterator(DcmRLEEncoder *) DcmRLEEncoderListIterator;
 
 
+/* compresses a single frame of an image with the RLE encoder */
+class DcmRLEFrameEncoder : public DcmFrameEncoder
+{
+public:
+  DcmRLEFrameEncoder(
+    const Uint8 *aPixelData,
+    Uint16 aColumns,
+    Uint16 aRows,
+    Uint16 aSamplesPerPixel,
+    Uint16 aBytesAllocated,
+    Uint16 aPlanarConfiguration)
+  : pixelData(aPixelData)
+  , columns(aColumns)
+  , rows(aRows)
+  , samplesPerPixel(aSamplesPerPixel)
+  , bytesAllocated(aBytesAllocated)
+  , planarConfiguration(aPlanarConfiguration)
+  {
+  }
+
+  virtual OFCondition encodeFrame(Uint32 frameNo, Uint32 slot, Uint8 *& compressedData, Uint32& compressedLength);
+
+private:
+  /* uncompressed pixel data of all frames (little endian) */
+  const Uint8 *pixelData;
+  Uint16 columns;
+  Uint16 rows;
+  Uint16 samplesPerPixel;
+  Uint16 bytesAllocated;
+  Uint16 planarConfiguration;
+};
+
+
+OFCondition DcmRLEFrameEncoder::encodeFrame(
+  Uint32 frameNo,
+  Uint32 /* slot */,
+  Uint8 *& compressedData,
+  Uint32& compressedLength)
+{
+  OFCondition result = EC_Normal;
+  DcmRLEEncoderList rleEncoderList;
+  DcmRLEEncoderListIterator first = rleEncoderList.begin();
+  DcmRLEEncoderListIterator last = rleEncoderList.end();
+  Uint32 rleHeader[16];
+  Uint32 i;
+  const Uint32 bytesPerStripe = columns * rows;
+  const Uint32 frameSize = columns * rows * samplesPerPixel * bytesAllocated;
+  Uint32 sampleOffset = 0;
+  Uint32 offsetBetweenSamples = 0;
+  Uint32 sample = 0;
+  Uint32 byte = 0;
+  register Uint32 pixel = 0;
+  register Uint32 columnCounter = 0;
+  const Uint8 *pixelPointer = NULL;
+
+  DcmRLEEncoder *rleEncoder = NULL;
+  Uint32 rleSize = 0;
+  Uint8 *rleData = NULL;
+  Uint8 *rleData2 = NULL;
+
+  compressedData = NULL;
+  compressedLength = 0;
+
+  // compute byte offset between samples
+  if (planarConfiguration == 0)
+     offsetBetweenSamples = samplesPerPixel * bytesAllocated;
+     else offsetBetweenSamples = bytesAllocated;
+
+  // offset to start of frame, in bytes
+  const Uint32 frameOffset = frameSize * frameNo;
+
+  // loop through all samples of one frame
+  for (sample = 0; (sample < samplesPerPixel) && result.good(); sample++)
+  {
+    // compute byte offset for first sample in frame
+    if (planarConfiguration == 0)
+       sampleOffset = sample * bytesAllocated;
+       else sampleOffset = sample * bytesAllocated * columns * rows;
+
+    // loop through the bytes of one sample
+    for (byte = 0; (byte < bytesAllocated) && result.good(); byte++)
+    {
+      pixelPointer = pixelData + frameOffset + sampleOffset + bytesAllocated - byte - 1;
+
+      // initialize new RLE codec for this stripe
+      rleEncoder = new DcmRLEEncoder(1 /* DICOM padding required */);
+      if (rleEncoder)
+      {
+        rleEncoderList.push_back(rleEncoder);
+        columnCounter = columns;
+
+        // loop through all pixels of the frame
+        for (pixel = 0; pixel < bytesPerStripe; ++pixel)
+        {
+          rleEncoder->add(*pixelPointer);
+
+          // enforce DICOM rule that "Each row of the image shall be encoded
+          // separately and not cross a row boundary."
+          // (see DICOM part 5 section G.3.1)
+          if (--columnCounter == 0)
+          {
+            rleEncoder->flush();
+            columnCounter = columns;
+          }
+          pixelPointer += offsetBetweenSamples;
+        }
+
+        rleEncoder->flush();
+        if (rleEncoder->fail()) result = EC_MemoryExhausted;
+      } else result = EC_MemoryExhausted;
+    }
+  }
+
+  // create compressed frame
+  if (result.good() && (rleEncoderList.size() > 0) && (rleEncoderList.size() < 16))
+  {
+    // compute size of compressed frame including RLE header
+    // and populate RLE header
+    for (i=0; i<16; i++) rleHeader[i] = 0;
+    rleHeader[0] = rleEncoderList.size();
+    rleSize = 64;
+    i = 1;
+    first = rleEncoderList.begin();
+    while (first != last)
+    {
+      rleHeader[i++] = rleSize;
+      rleSize += (*first)->size();
+      ++first;
+    }
+
+    // allocate buffer for compressed frame
+    rleData = new Uint8[rleSize];
+
+    if (rleData)
+    {
+      // copy RLE header to compressed frame buffer
+      swapIfNecessary(EBO_LittleEndian, gLocalByteOrder, rleHeader, 16*sizeof(Uint32), sizeof(Uint32));
+      memcpy(rleData, rleHeader, 64);
+
+      // store RLE stripe sets in compressed frame buffer
+      rleData2 = rleData + 64;
+      first = rleEncoderList.begin();
+      while (first != last)
+      {
+        (*first)->write(rleData2);
+        rleData2 += (*first)->size();
+        ++first;
+      }
+      compressedData = rleData;
+      compressedLength = rleSize;
+    } else result = EC_MemoryExhausted;
+  }
+  else if (result.good()) result = EC_CannotChangeRepresentation;
+
+  // erase RLE codec list
+  first = rleEncoderList.begin();
+  while (first != last)
+  {
+    delete *first;
+    first = rleEncoderList.erase(first);
+  }
+  return result;
+}
+
+
 // =======================================================================
 
 DcmRLECodecEncoder::DcmRLECodecEncoder()
@@ -124,13 +289,7 @@ OFCondition DcmRLECodecEncoder::encode(
   (void)localStack.pop();             // pop pixel data element from stack
   DcmObject *dataset = localStack.pop(); // this is the item in which the pixel data is located
   Uint8 *pixelData8 = OFreinterpret_cast(Uint8 *, OFconst_cast(Uint16 *, pixelData));
-  Uint8 *pixelPointer = NULL;
   DcmOffsetList offsetList;
-  DcmRLEEncoderList rleEncoderList;
-  DcmRLEEncoderListIterator first = rleEncoderList.begin();
-  DcmRLEEncoderListIterator last = rleEncoderList.end();
-  Uint32 rleHeader[16];
-  Uint32 i;
   OFBool byteSwapped = OFFalse;  // true if we have byte-swapped the original pixel data
 
   if ((!dataset)||((dataset->ident()!= EVR_dataset) && (dataset->ident()!= EVR_item))) result = EC_InvalidTag;
@@ -145,7 +304,7 @@ OFCondition DcmRLECodecEncoder::encode(
     Uint16 rows = 0;
     Sint32 numberOfFrames = 1;
     Uint32 numberOfStripes = 0;
-    Uint32 compressedSize = 0;
+    unsigned long compressedSize = 0;
 
     result = ditem->findAndGetUint16(DCM_BitsAllocated, bitsAllocated);
     if (result.good()) result = ditem->findAndGetUint16(DCM_SamplesPerPixel, samplesPerPixel);
@@ -205,133 +364,9 @@ OFCondition DcmRLECodecEncoder::encode(
     // create RLE stripe sets
     if (result.good())
     {
-      const Uint32 bytesPerStripe = columns * rows;
-      const Uint32 frameSize = columns * rows * samplesPerPixel * bytesAllocated;
-      Uint32 frameOffset = 0;
-      Uint32 sampleOffset = 0;
-      Uint32 offsetBetweenSamples = 0;
-      Uint32 sample = 0;
-      Uint32 byte = 0;
-      register Uint32 pixel = 0;
-      register Uint32 columnCounter = 0;
-
-      DcmRLEEncoder *rleEncoder = NULL;
-      Uint32 rleSize = 0;
-      Uint8 *rleData = NULL;
-      Uint8 *rleData2 = NULL;
-
-      // compute byte offset between samples
-      if (planarConfiguration == 0)
-         offsetBetweenSamples = samplesPerPixel * bytesAllocated;
-         else offsetBetweenSamples = bytesAllocated;
-
-      // loop through all frames of the image
-      for (Uint32 currentFrame = 0; ((currentFrame < OFstatic_cast(Uint32, numberOfFrames)) && result.good()); currentFrame++)
-      {
-        // offset to start of frame, in bytes
-        frameOffset = frameSize * currentFrame;
-
-        // loop through all samples of one frame
-        for (sample = 0; sample < samplesPerPixel; sample++)
-        {
-          // compute byte offset for first sample in frame
-          if (planarConfiguration == 0)
-             sampleOffset = sample * bytesAllocated;
-             else sampleOffset = sample * bytesAllocated * columns * rows;
-
-          // loop through the bytes of one sample
-          for (byte = 0; byte < bytesAllocated; byte++)
-          {
-            pixelPointer = pixelData8 + frameOffset + sampleOffset + bytesAllocated - byte - 1;
-
-            // initialize new RLE codec for this stripe
-            rleEncoder = new DcmRLEEncoder(1 /* DICOM padding required */);
-            if (rleEncoder)
-            {
-              rleEncoderList.push_back(rleEncoder);
-              columnCounter = columns;
-
-              // loop through all pixels of the frame
-              for (pixel = 0; pixel < bytesPerStripe; ++pixel)
-              {
-                rleEncoder->add(*pixelPointer);
-
-                // enforce DICOM rule that "Each row of the image shall be encoded
-                // separately and not cross a row boundary."
-                // (see DICOM part 5 section G.3.1)
-                if (--columnCounter == 0)
-                {
-                  rleEncoder->flush();
-                  columnCounter = columns;
-                }
-                pixelPointer += offsetBetweenSamples;
-              }
-
-              rleEncoder->flush();
-              if (rleEncoder->fail()) result = EC_MemoryExhausted;
-            } else result = EC_MemoryExhausted;
-          }
-        }
-
-        // store frame and erase RLE codec list
-        if (result.good() && (rleEncoderList.size() > 0) && (rleEncoderList.size() < 16))
-        {
-          // compute size of compressed frame including RLE header
-          // and populate RLE header
-          for (i=0; i<16; i++) rleHeader[i] = 0;
-          rleHeader[0] = rleEncoderList.size();
-          rleSize = 64;
-          i = 1;
-          first = rleEncoderList.begin();
-          while (first != last)
-          {
-            rleHeader[i++] = rleSize;
-            rleSize += (*first)->size();
-            ++first;
-          }
-
-          // allocate buffer for compressed frame
-          rleData = new Uint8[rleSize];
-
-          if (rleData)
-          {
-            // copy RLE header to compressed frame buffer
-            swapIfNecessary(EBO_LittleEndian, gLocalByteOrder, rleHeader, 16*sizeof(Uint32), sizeof(Uint32));
-            memcpy(rleData, rleHeader, 64);
-
-            // store RLE stripe sets in compressed frame buffer
-            rleData2 = rleData + 64;
-            first = rleEncoderList.begin();
-            while (first != last)
-            {
-              (*first)->write(rleData2);
-              rleData2 += (*first)->size();
-              delete *first;
-              first = rleEncoderList.erase(first);
-            }
-
-            // store compressed frame, breaking into segments if necessary
-            result = pixelSequence->storeCompressedFrame(offsetList, rleData, rleSize, djcp->getFragmentSize());
-            compressedSize += rleSize;
-
-            // erase buffer for compressed frame
-            delete[] rleData;
-          } else result = EC_MemoryExhausted;
-        }
-        else
-        {
-          // erase RLE codec list
-          first = rleEncoderList.begin();
-          while (first != last)
-          {
-            delete *first;
-            first = rleEncoderList.erase(first);
-          }
-          if (result.good()) result = EC_CannotChangeRepresentation;
-        }
-
-      }
-
+      DcmRLEFrameEncoder frameEncoder(pixelData8, columns, rows, samplesPerPixel, bytesAllocated, planarConfiguration);
+      result = DcmCodec::encodeFrames(frameEncoder, OFstatic_cast(Uint32, numberOfFrames), djcp->getNumberOfThreads(),
+        pixelSequence, offsetList, djcp->getFragmentSize(), compressedSize);
     }
 
     // store pixel sequence if everything went well.
@@ -33,7 +33,8 @@ DcmRLECodecDecoder *DcmRLEDecoderRegistration::codec          = NULL;
 
 void DcmRLEDecoderRegistration::registerCodecs(
     OFBool pCreateSOPInstanceUID,
-    OFBool pReverseDecompressionByteOrder)
+    OFBool pReverseDecompressionByteOrder,
+    Uint32 pNumberOfThreads)
 {
   if (! registered)
   {
@@ -44,6 +45,7 @@ void DcmRLEDecoderRegistration::registerCodecs(
       
     if (cp)
     {
+      cp->setNumberOfThreads(pNumberOfThreads);
       codec = new DcmRLECodecDecoder();
       if (codec) DcmCodecList::registerCodec(codec, NULL, cp);
       registered = OFTrue;
@@ -35,7 +35,8 @@ void DcmRLEEncoderRegistration::registerCodecs(
     OFBool pCreateSOPInstanceUID,
     Uint32 pFragmentSize,
     OFBool pCreateOffsetTable,
-    OFBool pConvertToSC)
+    OFBool pConvertToSC,
+    Uint32 pNumberOfThreads)
 {
   if (! registered)
   {
@@ -47,6 +48,7 @@ void DcmRLEEncoderRegistration::registerCodecs(
 
     if (cp)
     {
+      cp->setNumberOfThreads(pNumberOfThreads);
       codec = new DcmRLECodecEncoder();
       if (codec) DcmCodecList::registerCodec(codec, NULL, cp);
       registered = OFTrue;
@@ -53,7 +53,11 @@ DcmSequenceOfItems::DcmSequenceOfItems(
   itemList(new DcmList),
   lastItemComplete(OFTrue),
   fStartPosition(0),
-  readAsUN_(readAsUN)
+  readAsUN_(readAsUN),
+  cachedLength(0),
+  cachedLengthXfer(EXS_Unknown),
+  cachedLengthEncType(EET_UndefinedLength),
+  lengthCacheValid(OFFalse)
 {
 }
 
@@ -66,7 +70,11 @@ DcmSequenceOfItems::DcmSequenceOfItems(const DcmSequenceOfItems &old)
     itemList(new DcmList),
     lastItemComplete(old.lastItemComplete),
     fStartPosition(old.fStartPosition),
-    readAsUN_(old.readAsUN_)
+    readAsUN_(old.readAsUN_),
+    cachedLength(0),
+    cachedLengthXfer(EXS_Unknown),
+    cachedLengthEncType(EET_UndefinedLength),
+    lengthCacheValid(OFFalse)
 {
     if (!old.itemList->empty())
     {
@@ -157,6 +165,7 @@ DcmSequenceOfItems &DcmSequenceOfItems::operator=(const DcmSequenceOfItems &obj)
     // ...and delete the list itself
     delete itemList;
     itemList = newList;
+    lengthCacheValid = OFFalse;
   }
   return *this;
 }
@@ -361,6 +370,9 @@ Uint32 DcmSequenceOfItems::calcElementLength(const E_TransferSyntax xfer,
 Uint32 DcmSequenceOfItems::getLength(const E_TransferSyntax xfer,
                                      const E_EncodingType enctype)
 {
+    /* avoid computing the length of all items again as long as nothing has changed */
+    if (lengthCacheValid && (cachedLengthXfer == xfer) && (cachedLengthEncType == enctype))
+        return cachedLength;
     Uint32 seqlen = 0;
     Uint32 sublen = 0;
     if (!itemList->empty())
@@ -393,10 +405,26 @@ Uint32 DcmSequenceOfItems::getLength(const E_TransferSyntax xfer,
             seqlen += sublen;
         } while (itemList->seek(ELP_next));
     }
+    /* lengths exceeding the length field are never cached (see above) */
+    cachedLength = seqlen;
+    cachedLengthXfer = xfer;
+    cachedLengthEncType = enctype;
+    lengthCacheValid = OFTrue;
     return seqlen;
 }
 
 
+void DcmSequenceOfItems::invalidateLengthCache()
+{
+    /* if the cache is already invalid, so are the caches of all parent objects */
+    if (lengthCacheValid)
+    {
+        lengthCacheValid = OFFalse;
+        DcmElement::invalidateLengthCache();
+    }
+}
+
+
 // ********************************
 
 
@@ -531,6 +559,7 @@ OFCondition DcmSequenceOfItems::readSubItem(DcmInputStream &inStream,
         DCMDATA_TRACE("DcmSequenceOfItems::readSubItem() Sub Item " << newTag << " inserted");
         // remember the parent (i.e. the surrounding sequence)
         subObject->setParent(this);
+        invalidateLengthCache();
         // read sub-item
         l_error = subObject->read(inStream, xfer, glenc, maxReadLength);
         // prevent subObject from getting deleted
@@ -919,6 +948,7 @@ OFCondition DcmSequenceOfItems::prepend(DcmItem *item)
         itemList->prepend(item);
         // remember the parent (i.e. the surrounding sequence)
         item->setParent(this);
+        invalidateLengthCache();
     } else
         errorFlag = EC_IllegalCall;
 
@@ -956,6 +986,7 @@ OFCondition DcmSequenceOfItems::insert(DcmItem *item,
         }
         // remember the parent (i.e. the surrounding sequence)
         item->setParent(this);
+        invalidateLengthCache();
     } else
         errorFlag = EC_IllegalCall;
     return errorFlag;
@@ -982,6 +1013,7 @@ OFCondition DcmSequenceOfItems::insertAtCurrentPos(DcmItem *item,
         }
         // remember the parent (i.e. the surrounding sequence)
         item->setParent(this);
+        invalidateLengthCache();
     } else
         errorFlag = EC_IllegalCall;
     return errorFlag;
@@ -1005,6 +1037,7 @@ OFCondition DcmSequenceOfItems::append(DcmItem *item)
         }
         // remember the parent (i.e. the surrounding sequence)
         item->setParent(this);
+        invalidateLengthCache();
     } else
         errorFlag = EC_IllegalCall;
     return errorFlag;
@@ -1100,6 +1133,7 @@ DcmItem *DcmSequenceOfItems::remove(const unsigned long num)
     {
         itemList->remove();
         item->setParent(NULL);              // forget about the parent
+        invalidateLengthCache();
     } else
         errorFlag = EC_IllegalCall;
     return item;
@@ -1123,6 +1157,7 @@ DcmItem *DcmSequenceOfItems::remove(DcmItem *item)
             {
                 itemList->remove();         // removes element from list but does not delete it
                 item->setParent(NULL);      // forget about the parent
+                invalidateLengthCache();
                 errorFlag = EC_Normal;
                 break;
             }
@@ -1145,6 +1180,7 @@ OFCondition DcmSequenceOfItems::clear()
     // remove all items from sequence and delete them from memory
     itemList->deleteAllElements();
     setLengthField(0);
+    invalidateLengthCache();
     return errorFlag;
 }
 
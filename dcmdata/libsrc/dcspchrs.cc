@@ -29,9 +29,120 @@
 #include "dcmtk/ofstd/ofstream.h"
 #include "dcmtk/ofstd/ofstd.h"
 
+#define INCLUDE_CSTRING
+#include "dcmtk/ofstd/ofstdinc.h"
+
+#ifdef WITH_THREADS
+#include "dcmtk/ofstd/ofthread.h"
+#endif
+
 
 #define MAX_OUTPUT_STRING_LENGTH 60
 
+// maximum number of unused conversion descriptors kept in the cache
+#define MAX_CACHED_DESCRIPTORS 64
+
+// value of an unused conversion descriptor (same as in class OFCharacterEncoding)
+#define ILLEGAL_DESCRIPTOR OFreinterpret_cast(OFCharacterEncoding::T_Descriptor, -1)
+
+
+/*------------------*
+ *  local helpers   *
+ *------------------*/
+
+/* process-wide cache of unused conversion descriptors, the key of each entry
+ * consists of the names of the source and the destination encoding
+ */
+class DcmDescriptorCache
+{
+public:
+    DcmDescriptorCache();
+    ~DcmDescriptorCache();
+
+    /// list of cached conversion descriptors (most recently used first)
+    DcmSpecificCharacterSet::T_DescriptorList Descriptors;
+#ifdef WITH_THREADS
+    /// mutex protecting access to the list of cached descriptors
+    OFMutex Mutex;
+#endif
+};
+
+// set when the cache is destroyed on program termination, afterwards descriptors are closed directly
+static OFBool descriptorCacheDestroyed = OFFalse;
+
+static DcmDescriptorCache descriptorCache;
+
+
+DcmDescriptorCache::DcmDescriptorCache()
+  : Descriptors()
+#ifdef WITH_THREADS
+  , Mutex()
+#endif
+{
+}
+
+
+DcmDescriptorCache::~DcmDescriptorCache()
+{
+    DcmSpecificCharacterSet::clearDescriptorCache();
+    descriptorCacheDestroyed = OFTrue;
+}
+
+
+// get the key of a cached conversion descriptor
+static OFString getDescriptorKey(const OFString &fromEncoding,
+                                 const OFString &toEncoding)
+{
+    OFString key;
+    key.reserve(fromEncoding.length() + toEncoding.length() + 1);
+    key = fromEncoding;
+    key += '\\';
+    key += toEncoding;
+    return key;
+}
+
+
+// check whether all ASCII characters are represented by the same byte values in the given encoding
+static OFBool isASCIICompatibleEncoding(const OFString &encoding)
+{
+    // e.g. "JIS_X0201" maps the backslash to the yen sign
+    return (encoding == "ASCII") || (encoding == "UTF-8") || (encoding == "GB18030") ||
+           (encoding == "ISO-IR-166") || (encoding.compare(0, 9, "ISO-8859-") == 0);
+}
+
+
+// check whether the given string only consists of ASCII characters (except ESC)
+static OFBool isASCIIStringWithoutEscape(const char *str, const size_t len)
+{
+    // check a complete machine word at a time, i.e. 8 characters on 64-bit systems
+    const size_t lowBits = ~OFstatic_cast(size_t, 0) / 255;     // 0x0101...01
+    const size_t highBits = lowBits * 0x80;                     // 0x8080...80
+    const size_t escBits = lowBits * 0x1b;                      // 0x1b1b...1b
+    size_t pos = 0;
+    while (pos + sizeof(size_t) <= len)
+    {
+        size_t word;
+        // the string is not necessarily aligned
+        memcpy(&word, str + pos, sizeof(size_t));
+        // any byte with the most significant bit set?
+        if (word & highBits)
+            return OFFalse;
+        // any byte equal to ESC, i.e. any zero byte after the XOR?
+        const size_t value = word ^ escBits;
+        if ((value - lowBits) & ~value & highBits)
+            return OFFalse;
+        pos += sizeof(size_t);
+    }
+    // check the remaining characters one by one
+    while (pos < len)
+    {
+        const unsigned char c = OFstatic_cast(unsigned char, str[pos++]);
+        if ((c >= 0x80) || (c == 0x1b))
+            return OFFalse;
+    }
+    return OFTrue;
+}
+
 
 /*------------------*
  *  implementation  *
@@ -42,7 +153,9 @@ DcmSpecificCharacterSet::DcmSpecificCharacterSet()
     DestinationCharacterSet(),
     DestinationEncoding(),
     EncodingConverter(),
-    ConversionDescriptors()
+    ConversionDescriptors(),
+    OpenDescriptors(),
+    KeepASCIICharacters(OFFalse)
 {
 }
 
@@ -103,7 +216,7 @@ OFCondition DcmSpecificCharacterSet::selectCharacterSet(const OFString &fromChar
         if (sourceVM == 0)
         {
             // no character set specified, use ASCII
-            status = EncodingConverter.selectEncoding("ASCII", DestinationEncoding);
+            status = openConversionDescriptor(EncodingConverter.ConversionDescriptor, "ASCII");
             // output some useful debug information
             if (status.good())
             {
@@ -136,6 +249,16 @@ OFCondition DcmSpecificCharacterSet::selectCharacterSet(const OFString &fromChar
                 }
             }
         }
+        // check whether strings with ASCII characters only can be copied without conversion
+        if (status.good() && isASCIICompatibleEncoding(DestinationEncoding))
+        {
+            OFListConstIterator(T_DescriptorEntry) iter = OpenDescriptors.begin();
+            OFListConstIterator(T_DescriptorEntry) last = OpenDescriptors.end();
+            // determine the encoding of the default descriptor
+            while ((iter != last) && (iter->second != EncodingConverter.ConversionDescriptor))
+                ++iter;
+            KeepASCIICharacters = (iter != last) && isASCIICompatibleEncoding(iter->first);
+        }
     }
     return status;
 }
@@ -257,7 +380,7 @@ OFCondition DcmSpecificCharacterSet::selectCharacterSetWithoutCodeExtensions()
     // check whether an appropriate character encoding has been found
     if (!fromEncoding.empty())
     {
-        status = EncodingConverter.selectEncoding(fromEncoding, DestinationEncoding);
+        status = openConversionDescriptor(EncodingConverter.ConversionDescriptor, fromEncoding);
         // output some useful debug information
         if (status.good())
         {
@@ -384,7 +507,7 @@ OFCondition DcmSpecificCharacterSet::selectCharacterSetWithCodeExtensions(const
             // but first check whether this encoding has already been added before
             if (ConversionDescriptors.find(definedTerm) == ConversionDescriptors.end())
             {
-                status = EncodingConverter.openDescriptor(descriptor, encodingName, DestinationEncoding);
+                status = openConversionDescriptor(descriptor, encodingName);
                 if (status.good())
                 {
                     ConversionDescriptors[definedTerm] = descriptor;
@@ -411,7 +534,7 @@ OFCondition DcmSpecificCharacterSet::selectCharacterSetWithCodeExtensions(const
         // add ASCII to the map if needed but not already there
         if (needsASCII && (ConversionDescriptors.find("ISO 2022 IR 6") == ConversionDescriptors.end()))
         {
-            status = EncodingConverter.openDescriptor(descriptor, "ASCII", DestinationEncoding);
+            status = openConversionDescriptor(descriptor, "ASCII");
             if (status.good())
             {
                 ConversionDescriptors["ISO 2022 IR 6"] = descriptor;
@@ -441,8 +564,15 @@ OFCondition DcmSpecificCharacterSet::convertString(const char *fromString,
                                                    const OFString &delimiters)
 {
     OFCondition status = EC_Normal;
+    // check whether the string would not be changed by the conversion anyway
+    if (!isConversionNeeded(fromString, fromLength))
+    {
+        DCMDATA_TRACE("DcmSpecificCharacterSet: Copying '"
+            << convertToLengthLimitedOctalString(fromString, fromLength) << "' (ASCII characters only)");
+        toString.assign(fromString, fromLength);
+    }
     // check whether there are any code extensions at all
-    if ((ConversionDescriptors.size() == 0) || !checkForEscapeCharacter(fromString, fromLength))
+    else if ((ConversionDescriptors.size() == 0) || !checkForEscapeCharacter(fromString, fromLength))
     {
         DCMDATA_DEBUG("DcmSpecificCharacterSet: Converting '"
             << convertToLengthLimitedOctalString(fromString, fromLength) << "'");
@@ -672,6 +802,15 @@ OFCondition DcmSpecificCharacterSet::convertString(const char *fromString,
 }
 
 
+OFBool DcmSpecificCharacterSet::isConversionNeeded(const char *fromString,
+                                                   const size_t fromLength) const
+{
+    // strings with ASCII characters only (and without escape sequences) are never changed,
+    // but only if all ASCII characters are mapped to themselves
+    return !KeepASCIICharacters || !isASCIIStringWithoutEscape(fromString, fromLength);
+}
+
+
 OFBool DcmSpecificCharacterSet::isConversionLibraryAvailable()
 {
     // just call the appropriate function from the underlying class
@@ -686,30 +825,107 @@ size_t DcmSpecificCharacterSet::countCharactersInUTF8String(const OFString &utf8
 }
 
 
+void DcmSpecificCharacterSet::clearDescriptorCache()
+{
+    OFCharacterEncoding encodingConverter;
+#ifdef WITH_THREADS
+    descriptorCache.Mutex.lock();
+#endif
+    OFListIterator(T_DescriptorEntry) iter = descriptorCache.Descriptors.begin();
+    OFListConstIterator(T_DescriptorEntry) last = descriptorCache.Descriptors.end();
+    // close all cached descriptors (errors are ignored since there is nothing we could do about it)
+    while (iter != last)
+    {
+        encodingConverter.closeDescriptor(iter->second);
+        ++iter;
+    }
+    descriptorCache.Descriptors.clear();
+#ifdef WITH_THREADS
+    descriptorCache.Mutex.unlock();
+#endif
+}
+
+
+OFCondition DcmSpecificCharacterSet::openConversionDescriptor(OFCharacterEncoding::T_Descriptor &descriptor,
+                                                              const OFString &fromEncoding)
+{
+    OFCondition status = EC_Normal;
+    descriptor = ILLEGAL_DESCRIPTOR;
+    if (!descriptorCacheDestroyed)
+    {
+        const OFString key = getDescriptorKey(fromEncoding, DestinationEncoding);
+#ifdef WITH_THREADS
+        descriptorCache.Mutex.lock();
+#endif
+        // check whether there is an unused descriptor for this conversion in the cache
+        OFListIterator(T_DescriptorEntry) iter = descriptorCache.Descriptors.begin();
+        OFListConstIterator(T_DescriptorEntry) last = descriptorCache.Descriptors.end();
+        while (iter != last)
+        {
+            if (iter->first == key)
+            {
+                descriptor = iter->second;
+                descriptorCache.Descriptors.erase(iter);
+                break;
+            }
+            ++iter;
+        }
+#ifdef WITH_THREADS
+        descriptorCache.Mutex.unlock();
+#endif
+    }
+    if (descriptor != ILLEGAL_DESCRIPTOR)
+    {
+        DCMDATA_TRACE("DcmSpecificCharacterSet: Reusing cached conversion descriptor from "
+            << fromEncoding << " to " << DestinationEncoding);
+    } else {
+        // if not, open a new descriptor
+        status = EncodingConverter.openDescriptor(descriptor, fromEncoding, DestinationEncoding);
+    }
+    // remember the descriptor, so it can be returned to the cache later on
+    if (status.good())
+        OpenDescriptors.push_back(OFMake_pair(fromEncoding, descriptor));
+    return status;
+}
+
+
 void DcmSpecificCharacterSet::closeConversionDescriptors()
 {
-    T_DescriptorMap::iterator iter = ConversionDescriptors.begin();
-    T_DescriptorMap::const_iterator last = ConversionDescriptors.end();
-    // iterate over the map of conversion descriptors
+    OFListIterator(T_DescriptorEntry) iter = OpenDescriptors.begin();
+    OFListConstIterator(T_DescriptorEntry) last = OpenDescriptors.end();
+    // iterate over the list of open conversion descriptors
     while (iter != last)
     {
-        // make sure that the default descriptor is not closed multiple times
-        if (iter->second != EncodingConverter.ConversionDescriptor)
+        OFBool cached = OFFalse;
+        if (!descriptorCacheDestroyed)
         {
-            // and close the descriptor
-            if (EncodingConverter.closeDescriptor(iter->second).bad())
+#ifdef WITH_THREADS
+            descriptorCache.Mutex.lock();
+#endif
+            // return the descriptor to the cache (if not full)
+            if (descriptorCache.Descriptors.size() < MAX_CACHED_DESCRIPTORS)
             {
-                DCMDATA_ERROR("DcmSpecificCharacterSet: Cannot close previously allocated "
-                    << "conversion descriptor for '" << iter->first << "'");
+                descriptorCache.Descriptors.push_front(OFMake_pair(getDescriptorKey(iter->first, DestinationEncoding), iter->second));
+                cached = OFTrue;
             }
+#ifdef WITH_THREADS
+            descriptorCache.Mutex.unlock();
+#endif
+        }
+        // otherwise, close the descriptor
+        if (!cached && EncodingConverter.closeDescriptor(iter->second).bad())
+        {
+            DCMDATA_ERROR("DcmSpecificCharacterSet: Cannot close previously allocated "
+                << "conversion descriptor for '" << iter->first << "'");
         }
         ++iter;
     }
-    // clear the map
+    // clear the list and the map
+    OpenDescriptors.clear();
     ConversionDescriptors.clear();
-    // and close the default descriptor
-    if (EncodingConverter.closeDescriptor(EncodingConverter.ConversionDescriptor).bad())
-        DCMDATA_ERROR("DcmSpecificCharacterSet: Cannot close currently selected conversion descriptor");
+    // the default descriptor is also contained in the list
+    EncodingConverter.ConversionDescriptor = ILLEGAL_DESCRIPTOR;
+    KeepASCIICharacters = OFFalse;
     // also clear the various character set and encoding name variables
     SourceCharacterSet.clear();
     DestinationCharacterSet.clear();
@@ -0,0 +1,388 @@
+/*
+ *
+ *  Copyright (C) 2012, OFFIS e.V.
+ *  All rights reserved.  See COPYRIGHT file for details.
+ *
+ *  This software and supporting documentation were developed by
+ *
+ *    OFFIS e.V.
+ *    R&D Division Health
+ *    Escherweg 2
+ *    D-26121 Oldenburg, Germany
+ *
+ *
+ *  Module:  dcmdata
+ *
+ *  Author:  DCMTK team
+ *
+ *  Purpose: Implementation of class DcmStreamWriter
+ *
+ */
+
+
+#include "dcmtk/config/osconfig.h"    /* make sure OS specific configuration is included first */
+
+#include "dcmtk/dcmdata/dcstrmwr.h"
+#include "dcmtk/dcmdata/dcostrma.h"
+#include "dcmtk/dcmdata/dcostrmf.h"
+#include "dcmtk/dcmdata/dcfilefo.h"
+#include "dcmtk/dcmdata/dcmetinf.h"
+#include "dcmtk/dcmdata/dcdatset.h"
+#include "dcmtk/dcmdata/dcelem.h"
+#include "dcmtk/dcmdata/dcitem.h"
+#include "dcmtk/dcmdata/dcdeftag.h"
+#include "dcmtk/dcmdata/dcswap.h"
+
+#define INCLUDE_CSTRING
+#include "dcmtk/ofstd/ofstdinc.h"
+
+
+DcmStreamWriter::DcmStreamWriter()
+  : stream_(NULL)
+  , ownStream_(OFFalse)
+  , xfer_(EXS_Unknown)
+  , levels_()
+  , wcache_()
+  , pendingObject_(NULL)
+  , pendingOwner_(NULL)
+  , pendingLength_(0)
+  , pendingCompression_(ESC_none)
+{
+}
+
+
+DcmStreamWriter::~DcmStreamWriter()
+{
+    /* the remaining output is discarded if the buffer has not been emptied */
+    if (close() == EC_StreamNotifyClient)
+        release();
+}
+
+
+OFCondition DcmStreamWriter::open(const OFFilename &fileName,
+                                  const E_TransferSyntax xfer,
+                                  const char *sopClassUID,
+                                  const char *sopInstanceUID,
+                                  const E_FileWriteMode writeMode)
+{
+    if (isOpen())
+        return EC_IllegalCall;
+    if (fileName.isEmpty())
+        return EC_InvalidFilename;
+    DcmOutputFileStream *fileStream = new DcmOutputFileStream(fileName);
+    OFCondition status = fileStream->status();
+    if (status.good())
+    {
+        status = open(*fileStream, xfer, sopClassUID, sopInstanceUID, writeMode);
+        if (status.good() || (status == EC_StreamNotifyClient))
+            ownStream_ = OFTrue;
+    }
+    if (!ownStream_)
+        delete fileStream;
+    return status;
+}
+
+
+OFCondition DcmStreamWriter::open(DcmOutputStream &outStream,
+                                  const E_TransferSyntax xfer,
+                                  const char *sopClassUID,
+                                  const char *sopInstanceUID,
+                                  const E_FileWriteMode writeMode)
+{
+    if (isOpen() || (xfer == EXS_Unknown) || (xfer == EXS_BigEndianImplicit))
+        return EC_IllegalCall;
+    OFCondition status = outStream.status();
+    if (status.good())
+    {
+        /* the compression filter is installed after the meta header */
+        pendingCompression_ = DcmXfer(xfer).getStreamCompression();
+        if (pendingCompression_ == ESC_unsupported)
+        {
+            pendingCompression_ = ESC_none;
+            status = EC_UnsupportedEncoding;
+        }
+    }
+    if (status.bad())
+        return status;
+    stream_ = &outStream;
+    ownStream_ = OFFalse;
+    xfer_ = xfer;
+    levels_.clear();
+    pushLevel(OFFalse /* dataset */);
+    if (writeMode != EWM_dataset)
+    {
+        /* create the meta header from a dataset that only contains the UIDs */
+        DcmFileFormat *fileformat = new DcmFileFormat();
+        DcmDataset *dataset = fileformat->getDataset();
+        if ((sopClassUID != NULL) && (sopClassUID[0] != '\0'))
+            status = dataset->putAndInsertString(DCM_SOPClassUID, sopClassUID);
+        if (status.good() && (sopInstanceUID != NULL) && (sopInstanceUID[0] != '\0'))
+            status = dataset->putAndInsertString(DCM_SOPInstanceUID, sopInstanceUID);
+        if (status.good())
+            status = fileformat->validateMetaInfo(xfer, EWM_createNewMeta);
+        if (status.good())
+            status = writeObject(*fileformat->getMetaInfo(), fileformat);
+        else
+            delete fileformat;
+    }
+    if (status.good())
+        status = installCompression();
+    if (status.bad() && (status != EC_StreamNotifyClient))
+        release();
+    return status;
+}
+
+
+OFCondition DcmStreamWriter::writeElement(DcmElement &element)
+{
+    return writeElement(element, NULL /* owner */);
+}
+
+
+OFCondition DcmStreamWriter::writeString(const DcmTagKey &tag,
+                                         const char *value)
+{
+    DcmElement *element = newDicomElement(tag);
+    if (element == NULL)
+        return EC_MemoryExhausted;
+    OFCondition status = element->putString(value);
+    if (status.bad())
+    {
+        delete element;
+        return status;
+    }
+    /* the element is deleted when it has been written */
+    return writeElement(*element, element);
+}
+
+
+OFCondition DcmStreamWriter::writeItem(DcmItem &item)
+{
+    if (!isOpen() || hasPendingOutput() || !levels_[levels_.size() - 1].isSequence)
+        return EC_IllegalCall;
+    return writeObject(item, NULL /* owner */);
+}
+
+
+OFCondition DcmStreamWriter::beginSequence(const DcmTagKey &tag)
+{
+    OFCondition status = checkElementTag(tag);
+    if (status.good())
+        status = writeHeader(tag, OFTrue /* sequence */, DCM_UndefinedLength);
+    /* a pending header is written before anything else */
+    if (status.good() || (status == EC_StreamNotifyClient))
+        pushLevel(OFTrue /* sequence */);
+    return status;
+}
+
+
+OFCondition DcmStreamWriter::beginItem()
+{
+    if (!isOpen() || hasPendingOutput() || !levels_[levels_.size() - 1].isSequence)
+        return EC_IllegalCall;
+    OFCondition status = writeHeader(DCM_Item, OFFalse, DCM_UndefinedLength);
+    if (status.good() || (status == EC_StreamNotifyClient))
+        pushLevel(OFFalse /* item */);
+    return status;
+}
+
+
+OFCondition DcmStreamWriter::endItem()
+{
+    /* the top-level dataset cannot be finished by this method */
+    if (!isOpen() || hasPendingOutput() || (levels_.size() < 2) || levels_[levels_.size() - 1].isSequence)
+        return EC_IllegalCall;
+    levels_.pop_back();
+    return writeHeader(DCM_ItemDelimitationItem, OFFalse, 0);
+}
+
+
+OFCondition DcmStreamWriter::endSequence()
+{
+    if (!isOpen() || hasPendingOutput() || !levels_[levels_.size() - 1].isSequence)
+        return EC_IllegalCall;
+    levels_.pop_back();
+    return writeHeader(DCM_SequenceDelimitationItem, OFFalse, 0);
+}
+
+
+OFCondition DcmStreamWriter::writePending()
+{
+    if (!isOpen())
+        return EC_IllegalCall;
+    OFCondition status = stream_->status();
+    if (status.good() && (pendingLength_ > 0))
+    {
+        const offile_off_t written = stream_->write(pendingBytes_, pendingLength_);
+        pendingLength_ -= OFstatic_cast(size_t, written);
+        if (pendingLength_ > 0)
+        {
+            memmove(pendingBytes_, pendingBytes_ + written, pendingLength_);
+            return stream_->good() ? EC_StreamNotifyClient : stream_->status();
+        }
+    }
+    if (status.good() && (pendingObject_ != NULL))
+    {
+        status = pendingObject_->write(*stream_, xfer_, EET_UndefinedLength, &wcache_);
+        if (status == EC_StreamNotifyClient)
+            return status;
+        finishPendingObject();
+    }
+    if (status.good())
+        status = installCompression();
+    return status;
+}
+
+
+OFCondition DcmStreamWriter::close()
+{
+    if (!isOpen())
+        return EC_Normal;
+    OFCondition status = EC_Normal;
+    if (hasPendingOutput())
+    {
+        status = writePending();
+        if (status == EC_StreamNotifyClient)
+            return status;
+    }
+    if (status.good() && (levels_.size() != 1))
+        status = EC_IllegalCall;
+    /* the buffer of the stream might have to be emptied more than once */
+    stream_->flush();
+    if (status.good() && stream_->good() && !stream_->isFlushed())
+        return EC_StreamNotifyClient;
+    if (status.good())
+        status = stream_->status();
+    release();
+    return status;
+}
+
+
+OFCondition DcmStreamWriter::writeElement(DcmElement &element,
+                                          DcmObject *owner)
+{
+    OFCondition status = EC_Normal;
+    /* group length elements are not written since the length is not known */
+    if (element.getTag().getElement() == 0x0000)
+        status = (isOpen() && !hasPendingOutput()) ? EC_Normal : EC_IllegalCall;
+    else
+    {
+        status = checkElementTag(element.getTag());
+        if (status.good())
+            return writeObject(element, owner);
+    }
+    delete owner;
+    return status;
+}
+
+
+OFCondition DcmStreamWriter::writeObject(DcmObject &object,
+                                         DcmObject *owner)
+{
+    object.transferInit();
+    pendingObject_ = &object;
+    pendingOwner_ = owner;
+    OFCondition status = object.write(*stream_, xfer_, EET_UndefinedLength, &wcache_);
+    if (status != EC_StreamNotifyClient)
+        finishPendingObject();
+    return status;
+}
+
+
+void DcmStreamWriter::finishPendingObject()
+{
+    if (pendingObject_ != NULL)
+        pendingObject_->transferEnd();
+    delete pendingOwner_;
+    pendingObject_ = NULL;
+    pendingOwner_ = NULL;
+}
+
+
+OFCondition DcmStreamWriter::installCompression()
+{
+    OFCondition status = EC_Normal;
+    if (pendingCompression_ != ESC_none)
+        status = stream_->installCompressionFilter(pendingCompression_);
+    pendingCompression_ = ESC_none;
+    return status;
+}
+
+
+void DcmStreamWriter::release()
+{
+    finishPendingObject();
+    pendingLength_ = 0;
+    pendingCompression_ = ESC_none;
+    if (ownStream_)
+        delete stream_;
+    stream_ = NULL;
+    ownStream_ = OFFalse;
+    levels_.clear();
+}
+
+
+OFCondition DcmStreamWriter::checkElementTag(const DcmTagKey &tag)
+{
+    if (!isOpen() || hasPendingOutput() || levels_[levels_.size() - 1].isSequence)
+        return EC_IllegalCall;
+    Level &level = levels_[levels_.size() - 1];
+    if (level.hasElement && (tag <= level.lastTag))
+        return EC_TagOrderViolated;
+    level.lastTag = tag;
+    level.hasElement = OFTrue;
+    return EC_Normal;
+}
+
+
+void DcmStreamWriter::pushLevel(const OFBool isSequence)
+{
+    Level level;
+    level.isSequence = isSequence;
+    level.lastTag = DcmTagKey();
+    level.hasElement = OFFalse;
+    levels_.push_back(level);
+}
+
+
+OFCondition DcmStreamWriter::writeHeader(const DcmTagKey &tag,
+                                         const OFBool isSequence,
+                                         const Uint32 length)
+{
+    const DcmXfer xfer(xfer_);
+    const E_ByteOrder byteOrder = xfer.getByteOrder();
+    Uint8 header[12];
+    size_t headerLength = 0;
+    Uint16 value16 = tag.getGroup();
+    swapIfNecessary(byteOrder, gLocalByteOrder, &value16, 2, 2);
+    memcpy(header, &value16, 2);
+    value16 = tag.getElement();
+    swapIfNecessary(byteOrder, gLocalByteOrder, &value16, 2, 2);
+    memcpy(header + 2, &value16, 2);
+    headerLength = 4;
+    /* items and delimitation items never have a VR */
+    if (isSequence && xfer.isExplicitVR())
+    {
+        memcpy(header + 4, "SQ\0\0", 4);
+        headerLength = 8;
+    }
+    Uint32 value32 = length;
+    swapIfNecessary(byteOrder, gLocalByteOrder, &value32, 4, 4);
+    memcpy(header + headerLength, &value32, 4);
+    headerLength += 4;
+    return writeBytes(header, headerLength);
+}
+
+
+OFCondition DcmStreamWriter::writeBytes(const void *buffer,
+                                        const size_t length)
+{
+    if (!stream_->good())
+        return stream_->status();
+    const offile_off_t written = stream_->write(buffer, length);
+    pendingLength_ = length - OFstatic_cast(size_t, written);
+    if (pendingLength_ == 0)
+        return EC_Normal;
+    memcpy(pendingBytes_, OFstatic_cast(const Uint8 *, buffer) + written, pendingLength_);
+    return stream_->good() ? EC_StreamNotifyClient : stream_->status();
+}
@@ -22,6 +22,32 @@
 #include "dcmtk/config/osconfig.h"    /* make sure OS specific configuration is included first */
 #include "dcmtk/dcmdata/dcswap.h"
 
+/*
+** Vectorized swap kernels.  SSE2 and NEON are used whenever the target
+** platform guarantees their availability (e.g. on x86_64 and AArch64).
+** AVX2 is only used if the compiler supports per-function target
+** attributes and the CPU reports AVX2 support at run time.
+*/
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#define DCMTK_SWAP_SSE2
+#include <emmintrin.h>
+#endif
+
+#if defined(DCMTK_SWAP_SSE2) && (defined(__x86_64__) || defined(__i386__)) && \
+    ((defined(__clang__) && (__clang_major__ >= 4)) || \
+     (!defined(__clang__) && defined(__GNUC__) && ((__GNUC__ > 4) || ((__GNUC__ == 4) && (__GNUC_MINOR__ >= 9)))))
+#define DCMTK_SWAP_AVX2
+#include <immintrin.h>
+#endif
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define DCMTK_SWAP_NEON
+#include <arm_neon.h>
+#endif
+
+/* minimum number of bytes for which the vectorized code is used */
+#define SWAP_VECTOR_MIN_LENGTH 64
+
 OFCondition swapIfNecessary(const E_ByteOrder newByteOrder,
                             const E_ByteOrder oldByteOrder,
                             void * value, const Uint32 byteLength,
@@ -67,8 +93,8 @@ OFCondition swapIfNecessary(const E_ByteOrder newByteOrder,
 
 
 
-void swapBytes(void * value, const Uint32 byteLength,
-               const size_t valWidth)
+static void swapBytesScalar(void * value, const Uint32 byteLength,
+                            const size_t valWidth)
     /*
      * This function swaps byteLength bytes in value. These bytes are seperated
      * in valWidth elements which will be swapped seperately.
@@ -126,6 +152,131 @@ void swapBytes(void * value, const Uint32 byteLength,
 }
 
 
+#ifdef DCMTK_SWAP_AVX2
+
+static OFBool cpuSupportsAVX2()
+{
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2") ? OFTrue : OFFalse;
+}
+
+/* determined during static initialization, i.e. AVX2 is not used before */
+static const OFBool swapUseAVX2 = cpuSupportsAVX2();
+
+__attribute__((target("avx2")))
+static Uint32 swapBytesAVX2(Uint8 *base, const Uint32 byteLength, const size_t valWidth)
+{
+    __m256i mask;
+    if (valWidth == 2)
+        mask = _mm256_setr_epi8(1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14,
+                                1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14);
+    else if (valWidth == 4)
+        mask = _mm256_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12,
+                                3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+    else
+        mask = _mm256_setr_epi8(7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8,
+                                7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8);
+    const Uint32 blocks = byteLength / 32;
+    for (Uint32 i = 0; i < blocks; ++i)
+    {
+        __m256i *p = OFreinterpret_cast(__m256i *, base + i * 32);
+        _mm256_storeu_si256(p, _mm256_shuffle_epi8(_mm256_loadu_si256(p), mask));
+    }
+    return blocks * 32;
+}
+
+#endif
+
+#ifdef DCMTK_SWAP_SSE2
+
+static Uint32 swapBytesSSE2(Uint8 *base, const Uint32 byteLength, const size_t valWidth)
+{
+    const Uint32 blocks = byteLength / 16;
+    for (Uint32 i = 0; i < blocks; ++i)
+    {
+        __m128i *p = OFreinterpret_cast(__m128i *, base + i * 16);
+        __m128i v = _mm_loadu_si128(p);
+        /* SSE2 cannot shuffle bytes, so reverse the order of the 16-bit words first */
+        if (valWidth == 4)
+            v = _mm_shufflehi_epi16(_mm_shufflelo_epi16(v, _MM_SHUFFLE(2, 3, 0, 1)), _MM_SHUFFLE(2, 3, 0, 1));
+        else if (valWidth == 8)
+            v = _mm_shufflehi_epi16(_mm_shufflelo_epi16(v, _MM_SHUFFLE(0, 1, 2, 3)), _MM_SHUFFLE(0, 1, 2, 3));
+        /* then swap the two bytes of each 16-bit word */
+        _mm_storeu_si128(p, _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8)));
+    }
+    return blocks * 16;
+}
+
+#endif
+
+#ifdef DCMTK_SWAP_NEON
+
+static Uint32 swapBytesNEON(Uint8 *base, const Uint32 byteLength, const size_t valWidth)
+{
+    const Uint32 blocks = byteLength / 16;
+    for (Uint32 i = 0; i < blocks; ++i)
+    {
+        Uint8 *p = base + i * 16;
+        const uint8x16_t v = vld1q_u8(p);
+        if (valWidth == 2)
+            vst1q_u8(p, vrev16q_u8(v));
+        else if (valWidth == 4)
+            vst1q_u8(p, vrev32q_u8(v));
+        else
+            vst1q_u8(p, vrev64q_u8(v));
+    }
+    return blocks * 16;
+}
+
+#endif
+
+static Uint32 swapBytesVector(Uint8 *base, const Uint32 byteLength, const size_t valWidth)
+    /*
+     * This function swaps the bytes of as many complete vector registers as
+     * possible and returns the number of bytes processed, i.e. the remaining
+     * bytes have to be swapped by the scalar code.  valWidth must be 2, 4 or 8.
+     */
+{
+#ifdef DCMTK_SWAP_AVX2
+    if (swapUseAVX2)
+        return swapBytesAVX2(base, byteLength, valWidth);
+#endif
+#if defined(DCMTK_SWAP_SSE2)
+    return swapBytesSSE2(base, byteLength, valWidth);
+#elif defined(DCMTK_SWAP_NEON)
+    return swapBytesNEON(base, byteLength, valWidth);
+#else
+    (void) base;
+    (void) byteLength;
+    (void) valWidth;
+    return 0;
+#endif
+}
+
+
+void swapBytes(void * value, const Uint32 byteLength,
+               const size_t valWidth)
+    /*
+     * This function swaps byteLength bytes in value. These bytes are seperated
+     * in valWidth elements which will be swapped seperately.  Large blocks of
+     * 2, 4 or 8 byte values (e.g. pixel data) are swapped with vector instructions
+     * if available.
+     *
+     * Parameters:
+     *   value        - [in] Array that contains the actual bytes which might have to be swapped.
+     *   byteLength   - [in] Length of the above array.
+     *   valWidth     - [in] Specifies how many bytes shall be treated together as one element.
+     */
+{
+    Uint8 *base = OFstatic_cast(Uint8 *, value);
+    Uint32 done = 0;
+    if ((byteLength >= SWAP_VECTOR_MIN_LENGTH) && ((valWidth == 2) || (valWidth == 4) || (valWidth == 8)))
+        done = swapBytesVector(base, byteLength, valWidth);
+    if (done < byteLength)
+        swapBytesScalar(base + done, byteLength - done, valWidth);
+}
+
+
 Uint16 swapShort(const Uint16 toSwap)
 {
     Uint8 *swapped = OFreinterpret_cast(Uint8 *, OFconst_cast(Uint16 *, &toSwap));
@@ -0,0 +1,433 @@
+/*
+ *
+ *  Copyright (C) 2012, OFFIS e.V.
+ *  All rights reserved.  See COPYRIGHT file for details.
+ *
+ *  This software and supporting documentation were developed by
+ *
+ *    OFFIS e.V.
+ *    R&D Division Health
+ *    Escherweg 2
+ *    D-26121 Oldenburg, Germany
+ *
+ *
+ *  Module:  dcmdata
+ *
+ *  Author:  DCMTK team
+ *
+ *  Purpose: Implementation of classes DcmTagScanner and DcmTagScanHandler
+ *
+ */
+
+
+#include "dcmtk/config/osconfig.h"    /* make sure OS specific configuration is included first */
+
+#define INCLUDE_CSTRING
+#define INCLUDE_NEW
+#include "dcmtk/ofstd/ofstdinc.h"
+
+#include "dcmtk/dcmdata/dctagscn.h"
+#include "dcmtk/dcmdata/dcistrma.h"    /* for class DcmInputStream */
+#include "dcmtk/dcmdata/dcistrmf.h"    /* for class DcmInputFileStream */
+#include "dcmtk/dcmdata/dcdeftag.h"
+#include "dcmtk/dcmdata/dctag.h"
+#include "dcmtk/dcmdata/dcswap.h"
+#include "dcmtk/dcmdata/dcmetinf.h"    /* for DCM_PreambleLen and DCM_Magic */
+#include "dcmtk/dcmdata/dcobject.h"    /* for DCM_UndefinedLength */
+
+
+DcmTagScanHandler::~DcmTagScanHandler()
+{
+}
+
+
+// ********************************
+
+
+DcmTagScanner::DcmTagScanner()
+  : stopTag_(DCM_PixelData),
+    skipSequences_(OFFalse),
+    maxValueLength_(4096),
+    buffer_(NULL),
+    bufferSize_(0),
+    datasetXfer_(EXS_Unknown),
+    stopped_(OFFalse)
+{
+}
+
+
+DcmTagScanner::~DcmTagScanner()
+{
+    delete[] buffer_;
+}
+
+
+void DcmTagScanner::setStopTag(const DcmTagKey &tag)
+{
+    stopTag_ = tag;
+}
+
+
+void DcmTagScanner::setSkipSequences(const OFBool skip)
+{
+    skipSequences_ = skip;
+}
+
+
+void DcmTagScanner::setMaxValueLength(const Uint32 maxLength)
+{
+    maxValueLength_ = maxLength;
+}
+
+
+OFCondition DcmTagScanner::scanFile(const OFFilename &fileName,
+                                    DcmTagScanHandler &handler,
+                                    const E_TransferSyntax readXfer)
+{
+    OFCondition l_error = EC_InvalidFilename;
+    /* check parameters first */
+    if (!fileName.isEmpty())
+    {
+        /* open file for input */
+        DcmInputFileStream fileStream(fileName);
+        l_error = fileStream.status();
+        if (l_error.good())
+            l_error = scanStream(fileStream, handler, readXfer);
+    }
+    return l_error;
+}
+
+
+OFCondition DcmTagScanner::scanStream(DcmInputStream &inStream,
+                                      DcmTagScanHandler &handler,
+                                      const E_TransferSyntax readXfer)
+{
+    OFCondition l_error = inStream.status();
+    datasetXfer_ = EXS_Unknown;
+    stopped_ = OFFalse;
+    if (l_error.bad())
+        return l_error;
+    /* check for preamble and DICOM prefix */
+    OFBool hasMetaHeader = OFFalse;
+    Uint8 preamble[DCM_PreambleLen + DCM_MagicLen];
+    inStream.mark();
+    if ((inStream.read(preamble, sizeof(preamble)) == sizeof(preamble)) &&
+        (memcmp(preamble + DCM_PreambleLen, DCM_Magic, DCM_MagicLen) == 0))
+    {
+        hasMetaHeader = OFTrue;
+    } else {
+        inStream.putback();
+        /* the meta header might also be present without preamble */
+        Uint8 group[2];
+        inStream.mark();
+        if ((inStream.read(group, 2) == 2) && (group[0] == 0x02) && (group[1] == 0x00))
+            hasMetaHeader = OFTrue;
+        inStream.putback();
+    }
+    E_TransferSyntax xfer = readXfer;
+    if (hasMetaHeader)
+    {
+        E_TransferSyntax metaXfer = EXS_Unknown;
+        l_error = scanMetaHeader(inStream, handler, metaXfer);
+        if (l_error.bad() || stopped_)
+            return l_error;
+        /* the transfer syntax in the meta header takes precedence */
+        if (metaXfer != EXS_Unknown)
+            xfer = metaXfer;
+    }
+    if (inStream.eos())
+        return EC_Normal;
+    if (xfer == EXS_Unknown)
+        xfer = detectXfer(inStream);
+    datasetXfer_ = xfer;
+    /* install decompression filter for deflated transfer syntax */
+    const DcmXfer xferSyn(xfer);
+    if (xferSyn.getStreamCompression() != ESC_none)
+    {
+        l_error = inStream.installCompressionFilter(xferSyn.getStreamCompression());
+        if (l_error.bad())
+            return l_error;
+    }
+    return scanElements(inStream, &handler, xfer, 0, DCM_UndefinedLength);
+}
+
+
+OFCondition DcmTagScanner::scanMetaHeader(DcmInputStream &inStream,
+                                          DcmTagScanHandler &handler,
+                                          E_TransferSyntax &metaXfer)
+{
+    OFCondition l_error = EC_Normal;
+    /* the meta header is always encoded with explicit VR little endian */
+    const DcmXfer xferSyn(EXS_LittleEndianExplicit);
+    while (l_error.good() && !inStream.eos())
+    {
+        DcmTagKey tag;
+        DcmEVR vr = EVR_UNKNOWN;
+        Uint32 length = 0;
+        inStream.mark();
+        l_error = readTagAndLength(inStream, xferSyn, tag, vr, length);
+        if (l_error.good())
+        {
+            /* check for end of meta header */
+            if ((tag.getGroup() != 0x0002) || (length == DCM_UndefinedLength))
+            {
+                inStream.putback();
+                break;
+            }
+            if (tag >= stopTag_)
+            {
+                inStream.putback();
+                stopped_ = OFTrue;
+                break;
+            }
+            l_error = readValue(inStream, length);
+            if (l_error.good())
+            {
+                if (tag == DCM_TransferSyntaxUID)
+                {
+                    /* remove trailing padding before looking up the transfer syntax */
+                    OFString xferUID(OFreinterpret_cast(const char *, buffer_), length);
+                    const size_t pos = xferUID.find_last_not_of(OFString(" \0", 2));
+                    xferUID.erase((pos == OFString_npos) ? 0 : pos + 1);
+                    metaXfer = DcmXfer(xferUID.c_str()).getXfer();
+                }
+                if (!handler.handleElement(tag, vr, length, buffer_, EBO_LittleEndian, 0))
+                {
+                    stopped_ = OFTrue;
+                    break;
+                }
+            }
+        }
+    }
+    return l_error;
+}
+
+
+OFCondition DcmTagScanner::scanElements(DcmInputStream &inStream,
+                                        DcmTagScanHandler *handler,
+                                        const E_TransferSyntax xfer,
+                                        const Uint32 level,
+                                        const Uint32 length)
+{
+    OFCondition l_error = EC_Normal;
+    const DcmXfer xferSyn(xfer);
+    const E_ByteOrder byteOrder = xferSyn.getByteOrder();
+    const offile_off_t endPos = inStream.tell() + length;
+    while (l_error.good() && !stopped_)
+    {
+        /* check for end of dataset or item */
+        if ((length != DCM_UndefinedLength) && (inStream.tell() >= endPos))
+            break;
+        if (inStream.eos())
+        {
+            /* only the top-level dataset may end without delimitation item */
+            if (level > 0)
+                l_error = EC_ItemDelimitationItemMissing;
+            break;
+        }
+        DcmTagKey tag;
+        DcmEVR vr = EVR_UNKNOWN;
+        Uint32 valueLength = 0;
+        inStream.mark();
+        l_error = readTagAndLength(inStream, xferSyn, tag, vr, valueLength);
+        if (l_error.bad())
+            break;
+        if (tag == DCM_ItemDelimitationItem)
+        {
+            /* end of item with undefined length */
+            if (length == DCM_UndefinedLength)
+                break;
+            continue;
+        }
+        /* stop before the given tag (in the top-level dataset only) */
+        if ((level == 0) && (tag >= stopTag_))
+        {
+            inStream.putback();
+            stopped_ = OFTrue;
+            break;
+        }
+        if ((vr == EVR_SQ) || ((valueLength == DCM_UndefinedLength) && ((vr == EVR_UN) || (vr == EVR_UNKNOWN))))
+        {
+            /* sequence (undefined length UN is a sequence with implicit VR little endian content) */
+            if (handler && !handler->handleElement(tag, EVR_SQ, valueLength, NULL, byteOrder, level))
+            {
+                stopped_ = OFTrue;
+                break;
+            }
+            const E_TransferSyntax itemXfer = (vr == EVR_SQ) ? xfer : EXS_LittleEndianImplicit;
+            l_error = scanItems(inStream, skipSequences_ ? NULL : handler, itemXfer, level + 1, valueLength, OFFalse);
+        }
+        else if (valueLength == DCM_UndefinedLength)
+        {
+            /* encapsulated pixel data */
+            if (handler && !handler->handleElement(tag, vr, valueLength, NULL, byteOrder, level))
+            {
+                stopped_ = OFTrue;
+                break;
+            }
+            l_error = scanItems(inStream, NULL, xfer, level + 1, valueLength, OFTrue);
+        }
+        else if (handler && (valueLength <= maxValueLength_))
+        {
+            l_error = readValue(inStream, valueLength);
+            if (l_error.good() && !handler->handleElement(tag, vr, valueLength, buffer_, byteOrder, level))
+                stopped_ = OFTrue;
+        } else {
+            if (handler && !handler->handleElement(tag, vr, valueLength, NULL, byteOrder, level))
+                stopped_ = OFTrue;
+            else
+                l_error = skipValue(inStream, valueLength);
+        }
+    }
+    return l_error;
+}
+
+
+OFCondition DcmTagScanner::scanItems(DcmInputStream &inStream,
+                                     DcmTagScanHandler *handler,
+                                     const E_TransferSyntax xfer,
+                                     const Uint32 level,
+                                     const Uint32 length,
+                                     const OFBool fragments)
+{
+    /* sequences of defined length can be skipped at once */
+    if ((handler == NULL) && (length != DCM_UndefinedLength))
+        return skipValue(inStream, length);
+    OFCondition l_error = EC_Normal;
+    const DcmXfer xferSyn(xfer);
+    const offile_off_t endPos = inStream.tell() + length;
+    while (l_error.good() && !stopped_)
+    {
+        /* check for end of sequence */
+        if ((length != DCM_UndefinedLength) && (inStream.tell() >= endPos))
+            break;
+        if (inStream.eos())
+        {
+            l_error = EC_SequDelimitationItemMissing;
+            break;
+        }
+        DcmTagKey tag;
+        DcmEVR vr = EVR_UNKNOWN;
+        Uint32 itemLength = 0;
+        l_error = readTagAndLength(inStream, xferSyn, tag, vr, itemLength);
+        if (l_error.bad())
+            break;
+        if (tag == DCM_SequenceDelimitationItem)
+            break;
+        if (tag != DCM_Item)
+            l_error = EC_CorruptedData;
+        else if (fragments || ((handler == NULL) && (itemLength != DCM_UndefinedLength)))
+            l_error = skipValue(inStream, itemLength);
+        else
+            l_error = scanElements(inStream, handler, xfer, level, itemLength);
+    }
+    return l_error;
+}
+
+
+OFCondition DcmTagScanner::readTagAndLength(DcmInputStream &inStream,
+                                            const DcmXfer &xfer,
+                                            DcmTagKey &tag,
+                                            DcmEVR &vr,
+                                            Uint32 &length)
+{
+    const E_ByteOrder byteOrder = xfer.getByteOrder();
+    Uint16 tagValues[2];
+    if (inStream.read(tagValues, 4) != 4)
+        return EC_InvalidStream;
+    swapIfNecessary(gLocalByteOrder, byteOrder, tagValues, 4, 2);
+    tag.set(tagValues[0], tagValues[1]);
+    /* items and delimitation items never have a VR */
+    if (tagValues[0] == 0xfffe)
+        vr = EVR_na;
+    else if (xfer.isExplicitVR())
+    {
+        char vrstr[3];
+        vrstr[2] = '\0';
+        if (inStream.read(vrstr, 2) != 2)
+            return EC_InvalidStream;
+        const DcmVR dcmvr(vrstr);
+        vr = dcmvr.getEVR();
+        if (dcmvr.usesExtendedLengthEncoding())
+        {
+            Uint16 reserved;
+            if (inStream.read(&reserved, 2) != 2)
+                return EC_InvalidStream;
+        } else {
+            Uint16 shortLength;
+            if (inStream.read(&shortLength, 2) != 2)
+                return EC_InvalidStream;
+            swapIfNecessary(gLocalByteOrder, byteOrder, &shortLength, 2, 2);
+            length = shortLength;
+            return EC_Normal;
+        }
+    } else {
+        /* determine VR from the data dictionary */
+        vr = DcmTag(tag).getEVR();
+        if (vr == EVR_UNKNOWN)
+            vr = EVR_UN;
+    }
+    if (inStream.read(&length, 4) != 4)
+        return EC_InvalidStream;
+    swapIfNecessary(gLocalByteOrder, byteOrder, &length, 4, 4);
+    return EC_Normal;
+}
+
+
+OFCondition DcmTagScanner::readValue(DcmInputStream &inStream,
+                                     const Uint32 length)
+{
+    /* enlarge the buffer if required (one more byte for the terminating zero) */
+    if ((buffer_ == NULL) || (length >= bufferSize_))
+    {
+        delete[] buffer_;
+        bufferSize_ = (length < 256) ? 256 : length + 1;
+#ifdef HAVE_STD__NOTHROW
+        // we want to use a non-throwing new here if available
+        buffer_ = new (std::nothrow) Uint8[bufferSize_];
+#else
+        buffer_ = new Uint8[bufferSize_];
+#endif
+        if (buffer_ == NULL)
+        {
+            bufferSize_ = 0;
+            return EC_MemoryExhausted;
+        }
+    }
+    if (OFstatic_cast(Uint32, inStream.read(buffer_, length)) != length)
+        return EC_InvalidStream;
+    buffer_[length] = 0;
+    return EC_Normal;
+}
+
+
+OFCondition DcmTagScanner::skipValue(DcmInputStream &inStream,
+                                     const Uint32 length)
+{
+    if (OFstatic_cast(Uint32, inStream.skip(length)) != length)
+        return EC_InvalidStream;
+    return EC_Normal;
+}
+
+
+E_TransferSyntax DcmTagScanner::detectXfer(DcmInputStream &inStream)
+{
+    Uint8 tagAndVR[6];
+    inStream.mark();
+    const offile_off_t count = inStream.read(tagAndVR, 6);
+    inStream.putback();
+    if (count < 6)
+        return EXS_LittleEndianImplicit;
+    /* check whether the bytes following the tag form a standard VR */
+    char vrstr[3];
+    vrstr[0] = OFstatic_cast(char, tagAndVR[4]);
+    vrstr[1] = OFstatic_cast(char, tagAndVR[5]);
+    vrstr[2] = '\0';
+    const OFBool explicitVR = DcmVR(vrstr).isStandard();
+    /* the first group number is usually small, e.g. 0008 rather than 0800 */
+    const Uint16 groupLittle = OFstatic_cast(Uint16, tagAndVR[0] | (tagAndVR[1] << 8));
+    const Uint16 groupBig = OFstatic_cast(Uint16, tagAndVR[1] | (tagAndVR[0] << 8));
+    if (groupBig < groupLittle)
+        return explicitVR ? EXS_BigEndianExplicit : EXS_BigEndianImplicit;
+    return explicitVR ? EXS_LittleEndianExplicit : EXS_LittleEndianImplicit;
+}
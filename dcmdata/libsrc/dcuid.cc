@@ -35,6 +35,7 @@
 #define INCLUDE_CSTDIO
 #define INCLUDE_CSTRING
 #define INCLUDE_CTIME
+#define INCLUDE_CLIMITS
 #define INCLUDE_LIBC
 #define INCLUDE_UNISTD
 #include "dcmtk/ofstd/ofstdinc.h"
@@ -76,6 +77,7 @@ END_EXTERN_C
 #include "dcmtk/dcmdata/dcuid.h"
 #include "dcmtk/dcmdata/dctypes.h"
 #include "dcmtk/ofstd/ofthread.h"
+#include "dcmtk/ofstd/ofatomic.h"
 #include "dcmtk/ofstd/ofcrc32.h"
 #include "dcmtk/ofstd/ofdefine.h"
 #include "dcmtk/ofstd/ofstd.h"
@@ -1114,6 +1116,211 @@ static const DcmModalityTable modalities[] = {
 static const int numberOfDcmModalityTableEntries = (sizeof(modalities) / sizeof(DcmModalityTable));
 
 
+/*
+ * Hash tables for the lookup of well-known UIDs and their names
+ */
+
+/* an entry of the UID hash table, combines the information of all of the above tables */
+struct DcmUIDIndexEntry
+{
+    const char *uid;
+    const char *name;
+    const DcmModalityTable *modality;
+    OFBool isStorageSOPClass;
+};
+
+/* hash tables that are created on program startup (from the static tables above)
+ * and are only read afterwards, i.e. no locking is required.  Since the tables
+ * are not available during the initialization of other static objects, the
+ * lookup functions fall back to a linear search if necessary.
+ */
+class DcmUIDIndex
+{
+  public:
+
+    DcmUIDIndex()
+      : UIDTable(NULL)
+      , NameTable(NULL)
+      , UIDMask(0)
+      , NameMask(0)
+    {
+        const size_t maxEntries = uidNameMap_size + numberOfAllDcmStorageSOPClassUIDs + numberOfDcmModalityTableEntries;
+        /* the hash tables are at most half full */
+        UIDMask = tableSize(maxEntries) - 1;
+        NameMask = tableSize(uidNameMap_size) - 1;
+        DcmUIDIndexEntry *uidTable = new DcmUIDIndexEntry[UIDMask + 1];
+        const UIDNameMap **nameTable = new const UIDNameMap *[NameMask + 1];
+        memset(uidTable, 0, (UIDMask + 1) * sizeof(DcmUIDIndexEntry));
+        memset(nameTable, 0, (NameMask + 1) * sizeof(const UIDNameMap *));
+        int i;
+        /* the first matching entry of each table is used (as with a linear search) */
+        for (i = 0; i < uidNameMap_size; i++)
+        {
+            if (uidNameMap[i].uid != NULL)
+            {
+                DcmUIDIndexEntry &entry = insertUID(uidTable, uidNameMap[i].uid);
+                if (entry.name == NULL)
+                    entry.name = uidNameMap[i].name;
+            }
+            if (uidNameMap[i].name != NULL)
+            {
+                size_t pos = hash(uidNameMap[i].name) & NameMask;
+                while ((nameTable[pos] != NULL) && (strcmp(nameTable[pos]->name, uidNameMap[i].name) != 0))
+                    pos = (pos + 1) & NameMask;
+                if (nameTable[pos] == NULL)
+                    nameTable[pos] = &uidNameMap[i];
+            }
+        }
+        for (i = 0; i < numberOfAllDcmStorageSOPClassUIDs; i++)
+        {
+            if (dcmAllStorageSOPClassUIDs[i] != NULL)
+                insertUID(uidTable, dcmAllStorageSOPClassUIDs[i]).isStorageSOPClass = OFTrue;
+        }
+        for (i = 0; i < numberOfDcmModalityTableEntries; i++)
+        {
+            DcmUIDIndexEntry &entry = insertUID(uidTable, modalities[i].sopClass);
+            if (entry.modality == NULL)
+                entry.modality = &modalities[i];
+        }
+        UIDTable = uidTable;
+        NameTable = nameTable;
+    }
+
+    ~DcmUIDIndex()
+    {
+        /* other static objects might still use the lookup functions */
+        const DcmUIDIndexEntry *uidTable = UIDTable;
+        const UIDNameMap **nameTable = NameTable;
+        UIDTable = NULL;
+        NameTable = NULL;
+        delete[] uidTable;
+        delete[] nameTable;
+    }
+
+    /** find the given UID in the hash table
+     *  @param uid UID to be searched for (not NULL)
+     *  @param entry reference to variable where the result is stored
+     *  @return true if the UID has been found, false otherwise
+     */
+    OFBool findUID(const char *uid, DcmUIDIndexEntry &entry) const
+    {
+        if (UIDTable == NULL)
+            return findUIDLinear(uid, entry);
+        size_t pos = hash(uid) & UIDMask;
+        while (UIDTable[pos].uid != NULL)
+        {
+            if (strcmp(UIDTable[pos].uid, uid) == 0)
+            {
+                entry = UIDTable[pos];
+                return OFTrue;
+            }
+            pos = (pos + 1) & UIDMask;
+        }
+        return OFFalse;
+    }
+
+    /** find the UID with the given name
+     *  @param name name to be searched for (not NULL)
+     *  @return UID or NULL if the name is unknown
+     */
+    const char *findName(const char *name) const
+    {
+        if (NameTable == NULL)
+        {
+            for (int i = 0; i < uidNameMap_size; i++)
+            {
+                if ((uidNameMap[i].name != NULL) && (strcmp(name, uidNameMap[i].name) == 0))
+                    return uidNameMap[i].uid;
+            }
+            return NULL;
+        }
+        size_t pos = hash(name) & NameMask;
+        while (NameTable[pos] != NULL)
+        {
+            if (strcmp(NameTable[pos]->name, name) == 0)
+                return NameTable[pos]->uid;
+            pos = (pos + 1) & NameMask;
+        }
+        return NULL;
+    }
+
+  private:
+
+    /// compute the hash value of the given string (FNV-1a)
+    static size_t hash(const char *str)
+    {
+        Uint32 value = 2166136261UL;
+        while (*str != '\0')
+        {
+            value ^= OFstatic_cast(unsigned char, *str++);
+            value *= 16777619UL;
+        }
+        return OFstatic_cast(size_t, value);
+    }
+
+    /// compute the size of a hash table for the given number of entries (power of two)
+    static size_t tableSize(const size_t entries)
+    {
+        size_t size = 16;
+        while (size < 2 * entries)
+            size *= 2;
+        return size;
+    }
+
+    /// get the entry for the given UID from the hash table, a new entry is inserted if necessary
+    DcmUIDIndexEntry &insertUID(DcmUIDIndexEntry *table, const char *uid) const
+    {
+        size_t pos = hash(uid) & UIDMask;
+        while ((table[pos].uid != NULL) && (strcmp(table[pos].uid, uid) != 0))
+            pos = (pos + 1) & UIDMask;
+        table[pos].uid = uid;
+        return table[pos];
+    }
+
+    /// find the given UID by searching all tables (used before the hash table is available)
+    static OFBool findUIDLinear(const char *uid, DcmUIDIndexEntry &entry)
+    {
+        int i;
+        entry.uid = NULL;
+        entry.name = NULL;
+        entry.modality = NULL;
+        entry.isStorageSOPClass = OFFalse;
+        for (i = 0; (entry.name == NULL) && (i < uidNameMap_size); i++)
+        {
+            if ((uidNameMap[i].uid != NULL) && (strcmp(uid, uidNameMap[i].uid) == 0))
+                entry.name = uidNameMap[i].name;
+        }
+        for (i = 0; !entry.isStorageSOPClass && (i < numberOfAllDcmStorageSOPClassUIDs); i++)
+        {
+            if ((dcmAllStorageSOPClassUIDs[i] != NULL) && (strcmp(uid, dcmAllStorageSOPClassUIDs[i]) == 0))
+                entry.isStorageSOPClass = OFTrue;
+        }
+        for (i = 0; (entry.modality == NULL) && (i < numberOfDcmModalityTableEntries); i++)
+        {
+            if (strcmp(uid, modalities[i].sopClass) == 0)
+                entry.modality = &modalities[i];
+        }
+        if ((entry.name != NULL) || entry.isStorageSOPClass || (entry.modality != NULL))
+        {
+            entry.uid = uid;
+            return OFTrue;
+        }
+        return OFFalse;
+    }
+
+    /// hash table of all known UIDs
+    const DcmUIDIndexEntry *UIDTable;
+    /// hash table of the names in uidNameMap
+    const UIDNameMap **NameTable;
+    /// mask for the hash values used with UIDTable (size - 1)
+    size_t UIDMask;
+    /// mask for the hash values used with NameTable (size - 1)
+    size_t NameMask;
+};
+
+static const DcmUIDIndex uidIndex;
+
+
 /*
  * Public Function Prototypes
  */
@@ -1124,10 +1331,9 @@ const char *dcmSOPClassUIDToModality(const char *sopClassUID,
 {
     if (sopClassUID == NULL) return NULL;
     /* check for known SOP class */
-    for (int i = 0; i < numberOfDcmModalityTableEntries; i++)
-    {
-      if (strcmp(modalities[i].sopClass, sopClassUID) == 0) return modalities[i].modality;
-    }
+    DcmUIDIndexEntry entry;
+    if (uidIndex.findUID(sopClassUID, entry) && (entry.modality != NULL))
+        return entry.modality->modality;
     /* SOP class not found */
     return defaultValue;
 }
@@ -1138,12 +1344,9 @@ unsigned long dcmGuessModalityBytes(const char *sopClassUID)
 
     if (sopClassUID == NULL) return nbytes;
 
-    int found=0;
-    for (int i = 0; (!found && (i < numberOfDcmModalityTableEntries)); i++)
-    {
-      found = (strcmp(modalities[i].sopClass, sopClassUID) == 0);
-      if (found) nbytes = modalities[i].averageSize;
-    }
+    DcmUIDIndexEntry entry;
+    if (uidIndex.findUID(sopClassUID, entry) && (entry.modality != NULL))
+        nbytes = entry.modality->averageSize;
 
     return nbytes;
 }
@@ -1159,13 +1362,10 @@ unsigned long dcmGuessModalityBytes(const char *sopClassUID)
 const char*
 dcmFindNameOfUID(const char* uid, const char* defaultValue)
 {
-    int i = 0;
     if (uid == NULL) return defaultValue;
-    for (i=0; i<uidNameMap_size; i++) {
-      if (uidNameMap[i].uid != NULL && strcmp(uid, uidNameMap[i].uid) == 0) {
-        return uidNameMap[i].name;
-      }
-    }
+    DcmUIDIndexEntry entry;
+    if (uidIndex.findUID(uid, entry) && (entry.name != NULL))
+        return entry.name;
     return defaultValue;
 }
 
@@ -1180,12 +1380,7 @@ const char *
 dcmFindUIDFromName(const char * name)
 {
     if (name == NULL) return NULL;
-    for(int i = 0; i < uidNameMap_size; i++)
-    {
-      if (uidNameMap[i].name != NULL && strcmp(name, uidNameMap[i].name) == 0)
-        return uidNameMap[i].uid;
-    }
-    return NULL;
+    return uidIndex.findName(name);
 }
 
 
@@ -1197,14 +1392,35 @@ dcmFindUIDFromName(const char * name)
 OFBool
 dcmIsaStorageSOPClassUID(const char* uid)
 {
-    int i = 0;
     if (uid == NULL) return OFFalse;
-    for (i=0; i<numberOfAllDcmStorageSOPClassUIDs; i++) {
-      if (dcmAllStorageSOPClassUIDs[i] != NULL && strcmp(uid, dcmAllStorageSOPClassUIDs[i]) == 0) {
-        return OFTrue;
-      }
+    DcmUIDIndexEntry entry;
+    return uidIndex.findUID(uid, entry) && entry.isStorageSOPClass;
+}
+
+
+/*
+** dcmFindUIDProperties(const char *uid, DcmUIDProperties &properties)
+** Determines the name, modality, average size and storage flag of a UID.
+** Performs a single lookup in the hash table of all known UIDs.
+*/
+OFBool
+dcmFindUIDProperties(const char *uid, DcmUIDProperties &properties)
+{
+    properties.name = NULL;
+    properties.modality = NULL;
+    properties.averageSize = 0;
+    properties.isStorageSOPClass = OFFalse;
+    DcmUIDIndexEntry entry;
+    if ((uid == NULL) || !uidIndex.findUID(uid, entry))
+        return OFFalse;
+    properties.name = entry.name;
+    if (entry.modality != NULL)
+    {
+        properties.modality = entry.modality->modality;
+        properties.averageSize = entry.modality->averageSize;
     }
-    return OFFalse;
+    properties.isStorageSOPClass = entry.isStorageSOPClass;
+    return OFTrue;
 }
 
 // ********************************
@@ -1579,26 +1795,33 @@ static unsigned long hostIdentifier = 0;
 static OFMutex uidCounterMutex;  // mutex protecting access to counterOfCurrentUID and hostIdentifier
 #endif
 
-static unsigned int counterOfCurrentUID = 0;
+/* The counter is stored as a long, so that it can be modified by atomic operations
+ * (if available, see reserveCounterBlock()).  Its value is always used as an
+ * unsigned int.
+ */
+static volatile long counterOfCurrentUID = 0;
 
 static const unsigned int maxUIDLen = 64;    /* A UID may be 64 chars or less */
 
+/* must be called while uidCounterMutex is locked */
 static void
 initCounterOfCurrentUID()
 {
+    unsigned int counter = 0;
     /* Code taken from oftime.cc */
 #ifdef HAVE_WINDOWS_H
     /* Windows: no microseconds available, use milliseconds instead */
     SYSTEMTIME timebuf;
     GetSystemTime(&timebuf);
-    counterOfCurrentUID = timebuf.wMilliseconds; /* This is in the range 0 - 999 */
+    counter = timebuf.wMilliseconds; /* This is in the range 0 - 999 */
 #else /* Unix */
     struct timeval tv;
     if (gettimeofday(&tv, NULL) == 0)
-        counterOfCurrentUID = tv.tv_usec; /* This is in the range 0 - 999999 */
+        counter = OFstatic_cast(unsigned int, tv.tv_usec); /* This is in the range 0 - 999999 */
 #endif
-    /* Do not ever use "0" for the counter */
-    counterOfCurrentUID++;
+    /* Do not ever use "0" for the counter.  The value is stored at once, since
+       it might be read concurrently by reserveCounterBlock(). */
+    counterOfCurrentUID = OFstatic_cast(long, counter + 1);
 }
 
 
@@ -1632,28 +1855,91 @@ forcePositive(long i)
     return (i < 0) ? OFstatic_cast(unsigned long, -i) : OFstatic_cast(unsigned long, i);
 }
 
-char* dcmGenerateUniqueIdentifier(char* uid, const char* prefix)
+/* must be called while uidCounterMutex is locked */
+static void
+initHostIdentifier()
 {
-    char buf[128]; /* be very safe */
-
-    uid[0] = '\0'; /* initialise */
-
-#ifdef WITH_THREADS
-    uidCounterMutex.lock();
-#endif
     if (hostIdentifier == 0)
     {
         /* On 64-bit Linux, the "32-bit identifier" returned by gethostid() is
            sign-extended to a 64-bit long, so we need to blank the upper 32 bits */
         hostIdentifier = OFstatic_cast(unsigned long, gethostid() & 0xffffffff);
     }
+}
+
+/* reserve a block of values of the UID counter, returns the first value.
+ * If atomic operations are available, the mutex is only locked for the
+ * initialization of the counter.
+ */
+static unsigned int
+reserveCounterBlock(unsigned int size)
+{
+    unsigned int counter;
+#ifdef OFATOMIC_AVAILABLE
+    if (counterOfCurrentUID == 0)
+    {
+        uidCounterMutex.lock();
+        if (counterOfCurrentUID == 0)
+            initCounterOfCurrentUID();
+        uidCounterMutex.unlock();
+    }
+    long oldValue;
+    do {
+        oldValue = counterOfCurrentUID;
+        counter = OFstatic_cast(unsigned int, oldValue);
+        /* do not wrap around within a block (and never use "0" for the counter) */
+        if (counter > UINT_MAX - size)
+            counter = 1;
+    } while (!OFAtomic::compareAndSwap(counterOfCurrentUID, oldValue, OFstatic_cast(long, counter + size)));
+#else
+#ifdef WITH_THREADS
+    uidCounterMutex.lock();
+#endif
     if (counterOfCurrentUID == 0)
         initCounterOfCurrentUID();
+    counter = OFstatic_cast(unsigned int, counterOfCurrentUID);
+    /* do not wrap around within a block (and never use "0" for the counter) */
+    if (counter > UINT_MAX - size)
+        counter = 1;
+    counterOfCurrentUID = OFstatic_cast(long, counter + size);
+#ifdef WITH_THREADS
+    uidCounterMutex.unlock();
+#endif
+#endif
+    return counter;
+}
+
+/* format a number with a leading period (without sprintf), returns the length */
+static size_t
+formatUIDComponent(char *buf, unsigned long value)
+{
+    char digits[24];
+    size_t count = 0;
+    do {
+        digits[count++] = OFstatic_cast(char, '0' + value % 10);
+        value /= 10;
+    } while (value > 0);
+    buf[0] = '.';
+    for (size_t i = 0; i < count; i++)
+        buf[i + 1] = digits[count - i - 1];
+    buf[count + 1] = '\0';
+    return count + 1;
+}
+
+char* dcmGenerateUniqueIdentifier(char* uid, const char* prefix)
+{
+    char buf[128]; /* be very safe */
 
-    unsigned int counter = counterOfCurrentUID++;
+    uid[0] = '\0'; /* initialise */
+
+#ifdef WITH_THREADS
+    uidCounterMutex.lock();
+#endif
+    initHostIdentifier();
 #ifdef WITH_THREADS
     uidCounterMutex.unlock();
 #endif
+    const unsigned int counter = reserveCounterBlock(1);
 
     if (prefix != NULL ) {
         addUIDComponent(uid, prefix);
@@ -1676,3 +1962,67 @@ char* dcmGenerateUniqueIdentifier(char* uid, const char* prefix)
 
     return uid;
 }
+
+
+DcmUIDGenerator::DcmUIDGenerator(const char *prefix,
+                                 const unsigned int blockSize)
+  : PrefixLength(0)
+  , BlockSize((blockSize > 0) ? blockSize : 1)
+  , Counter(0)
+  , CounterLeft(0)
+  , LastTime(0)
+  , TimeLength(0)
+{
+    char buf[32];
+    Prefix[0] = '\0';
+    TimeString[0] = '\0';
+    addUIDComponent(Prefix, (prefix != NULL) ? prefix : SITE_INSTANCE_UID_ROOT);
+#ifdef WITH_THREADS
+    uidCounterMutex.lock();
+#endif
+    initHostIdentifier();
+    const unsigned long hostId = hostIdentifier;
+#ifdef WITH_THREADS
+    uidCounterMutex.unlock();
+#endif
+    formatUIDComponent(buf, hostId);
+    addUIDComponent(Prefix, buf);
+    formatUIDComponent(buf, forcePositive(OFStandard::getProcessID()));
+    addUIDComponent(Prefix, buf);
+    PrefixLength = strlen(Prefix);
+}
+
+
+char *DcmUIDGenerator::generate(char *uid)
+{
+    /* reserve a new block of counter values if required */
+    if (CounterLeft == 0)
+    {
+        Counter = reserveCounterBlock(BlockSize);
+        CounterLeft = BlockSize;
+    }
+    const unsigned int counter = Counter++;
+    --CounterLeft;
+    /* the time is only formatted if it has changed */
+    const unsigned long now = forcePositive(OFstatic_cast(long, time(NULL)));
+    if ((TimeLength == 0) || (now != LastTime))
+    {
+        TimeLength = formatUIDComponent(TimeString, now);
+        LastTime = now;
+    }
+    char buf[24];
+    const size_t counterLength = formatUIDComponent(buf, counter);
+    if (PrefixLength + TimeLength + counterLength <= maxUIDLen)
+    {
+        memcpy(uid, Prefix, PrefixLength);
+        memcpy(uid + PrefixLength, TimeString, TimeLength);
+        memcpy(uid + PrefixLength + TimeLength, buf, counterLength + 1);
+    } else {
+        /* the UID is too long, truncate it like dcmGenerateUniqueIdentifier() does */
+        uid[0] = '\0';
+        addUIDComponent(uid, Prefix);
+        addUIDComponent(uid, TimeString);
+        addUIDComponent(uid, buf);
+    }
+    return uid;
+}
@@ -107,6 +107,18 @@ OFCondition DcmCodeString::getOFString(OFString &stringVal,
 }
 
 
+OFCondition DcmCodeString::getStringView(const char *&stringVal,
+                                         Uint32 &stringLen,
+                                         const unsigned long pos,
+                                         OFBool normalize)
+{
+    OFCondition l_error = DcmByteString::getStringView(stringVal, stringLen, pos, normalize);
+    if (l_error.good() && normalize)
+        normalizeString(stringVal, stringLen, DELETE_LEADING, DELETE_TRAILING);
+    return l_error;
+}
+
+
 // ********************************
 
 
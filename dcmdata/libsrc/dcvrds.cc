@@ -26,6 +26,9 @@
 #include "dcmtk/ofstd/ofstring.h"
 #include "dcmtk/ofstd/ofstd.h"
 
+#define INCLUDE_CSTRING
+#include "dcmtk/ofstd/ofstdinc.h"
+
 
 #define MAX_DS_LENGTH 16
 
@@ -98,16 +101,36 @@ OFCondition DcmDecimalString::checkValue(const OFString &vm,
 OFCondition DcmDecimalString::getFloat64(Float64 &doubleVal,
                                          const unsigned long pos)
 {
-    /* get decimal string value */
-    OFString str;
-    OFCondition l_error = getOFString(str, pos, OFTrue /*normalize*/);
+    /* get stored value */
+    char *strVal = NULL;
+    Uint32 strLen = 0;
+    OFCondition l_error = getString(strVal, strLen);
     if (l_error.good())
     {
-        OFBool success = OFFalse;
-        /* convert string to float value */
-        doubleVal = OFStandard::atof(str.c_str(), &success);
-        if (!success)
-            l_error = EC_CorruptedData;
+        if ((strVal != NULL) && (strLen > 0))
+        {
+            /* search for the specified value (without copying the preceding ones) */
+            const char *p = strVal;
+            const char *endVal = strVal + strLen;
+            unsigned long i = 0;
+            while ((i < pos) && (p < endVal))
+            {
+                if (*p++ == '\\')
+                    ++i;
+            }
+            if (i == pos)
+            {
+                OFBool success = OFFalse;
+                /* convert string to float value (stops at the next delimiter) */
+                doubleVal = OFStandard::atof(p, &success, NULL);
+                if (!success)
+                    l_error = EC_CorruptedData;
+            } else
+                l_error = EC_IllegalParameter;
+        } else {
+            /* an empty value cannot be converted */
+            l_error = (pos == 0) ? EC_CorruptedData : EC_IllegalParameter;
+        }
     }
     return l_error;
 }
@@ -127,33 +150,28 @@ OFCondition DcmDecimalString::getFloat64Vector(OFVector<Float64> &doubleVals)
         const unsigned long vm = getVM();
         if (vm > 0)
         {
-            Float64 doubleVal;
-            OFString doubleStr;
-            char *p = strVal;
+            const char *p = strVal;
+            const char *next = NULL;
+            const char *endVal = strVal + strLen;
             OFBool success = OFFalse;
             /* avoid memory re-allocations by specifying the expected size */
             doubleVals.reserve(vm);
-            /* iterate over the string value and search for delimiters */
-            for (Uint32 i = 0; i <= strLen; i++)
+            for (unsigned long i = 0; i < vm; i++)
             {
-                if ((i == strLen) || (*p == '\\'))
+                /* convert single value directly from the string buffer */
+                const Float64 doubleVal = OFStandard::atof(p, &success, &next);
+                if (success)
                 {
-                    /* extract single value and convert it to floating point */
-                    doubleStr.assign(strVal, p - strVal);
-                    doubleVal = OFStandard::atof(doubleStr.c_str(), &success);
-                    if (success)
-                    {
-                        /* store floating point value in result variable */
-                        doubleVals.push_back(doubleVal);
-                        strVal = p + 1;
-                    }
-                    else
-                    {
-                        l_error = EC_CorruptedData;
-                        break;
-                    }
+                    /* store floating point value in result variable */
+                    doubleVals.push_back(doubleVal);
+                    /* skip any trailing characters and the delimiter */
+                    while ((next < endVal) && (*next != '\\'))
+                        ++next;
+                    p = next + 1;
+                } else {
+                    l_error = EC_CorruptedData;
+                    break;
                 }
-                ++p;
             }
         }
     }
@@ -164,6 +182,37 @@ OFCondition DcmDecimalString::getFloat64Vector(OFVector<Float64> &doubleVals)
 // ********************************
 
 
+OFCondition DcmDecimalString::putFloat64Array(const Float64 *doubleVals,
+                                              const unsigned long numDoubles)
+{
+    errorFlag = EC_Normal;
+    if (numDoubles > 0)
+    {
+        /* check for valid data */
+        if (doubleVals != NULL)
+        {
+            /* create the string value in a single buffer (including the delimiters) */
+            char *strVal = new char[numDoubles * (MAX_DS_LENGTH + 1)];
+            char *p = strVal;
+            for (unsigned long i = 0; i < numDoubles; i++)
+            {
+                if (i > 0)
+                    *p++ = '\\';
+                p += formatFloat64(p, doubleVals[i]);
+            }
+            errorFlag = putString(strVal, OFstatic_cast(Uint32, p - strVal));
+            delete[] strVal;
+        } else
+            errorFlag = EC_CorruptedData;
+    } else
+        putValue(NULL, 0);
+    return errorFlag;
+}
+
+
+// ********************************
+
+
 OFCondition DcmDecimalString::getOFString(OFString &stringVal,
                                           const unsigned long pos,
                                           OFBool normalize)
@@ -177,6 +226,18 @@ OFCondition DcmDecimalString::getOFString(OFString &stringVal,
 }
 
 
+OFCondition DcmDecimalString::getStringView(const char *&stringVal,
+                                            Uint32 &stringLen,
+                                            const unsigned long pos,
+                                            OFBool normalize)
+{
+    OFCondition l_error = DcmByteString::getStringView(stringVal, stringLen, pos, normalize);
+    if (l_error.good() && normalize)
+        normalizeString(stringVal, stringLen, DELETE_LEADING, DELETE_TRAILING);
+    return l_error;
+}
+
+
 // ********************************
 
 
@@ -220,6 +281,27 @@ OFCondition DcmDecimalString::writeXML(STD_NAMESPACE ostream &out,
 // ********************************
 
 
+size_t DcmDecimalString::formatFloat64(char *stringVal,
+                                       const Float64 doubleVal)
+{
+    char buffer[64];
+    size_t length = 0;
+    /* use the highest precision that still fits into the maximum value length */
+    for (int precision = MAX_DS_LENGTH; precision > 0; --precision)
+    {
+        OFStandard::ftoa(buffer, sizeof(buffer), doubleVal, 0, 0, precision);
+        length = strlen(buffer);
+        if (length <= MAX_DS_LENGTH)
+            break;
+    }
+    /* should never happen, but make sure that the given buffer is not exceeded */
+    if (length > MAX_DS_LENGTH)
+        length = MAX_DS_LENGTH;
+    memcpy(stringVal, buffer, length);
+    return length;
+}
+
+
 OFCondition DcmDecimalString::checkStringValue(const OFString &value,
                                                const OFString &vm)
 {
@@ -25,6 +25,7 @@
 #include "dcmtk/ofstd/ofstring.h"
 
 #define INCLUDE_CSTDIO
+#define INCLUDE_CCTYPE
 #include "dcmtk/ofstd/ofstdinc.h"
 
 
@@ -34,6 +35,42 @@
 // ********************************
 
 
+/* convert the integer value at the given position (optionally preceded by white space
+ * and a sign) and move the position behind the last digit
+ */
+static OFBool parseSint32(const char *&p, Sint32 &sintVal)
+{
+    while (isspace(OFstatic_cast(unsigned char, *p)))
+        ++p;
+    const OFBool negative = (*p == '-');
+    if ((*p == '-') || (*p == '+'))
+        ++p;
+    /* the absolute value of the smallest negative number is one more than the largest one */
+    const Uint32 limit = negative ? 2147483648UL : 2147483647UL;
+    Uint32 value = 0;
+    const char *start = p;
+    while ((*p >= '0') && (*p <= '9'))
+    {
+        const Uint32 digit = *p - '0';
+        /* check for overflow */
+        if (value > (limit - digit) / 10)
+            return OFFalse;
+        value = value * 10 + digit;
+        ++p;
+    }
+    if (p == start)
+        return OFFalse;
+    if (negative)
+        sintVal = (value > 0) ? -OFstatic_cast(Sint32, value - 1) - 1 : 0;
+    else
+        sintVal = OFstatic_cast(Sint32, value);
+    return OFTrue;
+}
+
+
+// ********************************
+
+
 DcmIntegerString::DcmIntegerString(const DcmTag &tag,
                                    const Uint32 len)
   : DcmByteString(tag, len)
@@ -99,18 +136,75 @@ OFCondition DcmIntegerString::checkValue(const OFString &vm,
 OFCondition DcmIntegerString::getSint32(Sint32 &sintVal,
                                         const unsigned long pos)
 {
-    /* get integer string value */
-    OFString str;
-    OFCondition l_error = getOFString(str, pos, OFTrue);
+    /* get stored value */
+    char *strVal = NULL;
+    Uint32 strLen = 0;
+    OFCondition l_error = getString(strVal, strLen);
     if (l_error.good())
     {
-        /* convert string to integer value */
-#if SIZEOF_LONG == 8
-        if (sscanf(str.c_str(), "%d", &sintVal) != 1)
-#else
-        if (sscanf(str.c_str(), "%ld", &sintVal) != 1)
-#endif
-            l_error = EC_CorruptedData;
+        if ((strVal != NULL) && (strLen > 0))
+        {
+            /* search for the specified value (without copying the preceding ones) */
+            const char *p = strVal;
+            const char *endVal = strVal + strLen;
+            unsigned long i = 0;
+            while ((i < pos) && (p < endVal))
+            {
+                if (*p++ == '\\')
+                    ++i;
+            }
+            if (i == pos)
+            {
+                /* convert string to integer value (stops at the next delimiter) */
+                if (!parseSint32(p, sintVal))
+                    l_error = EC_CorruptedData;
+            } else
+                l_error = EC_IllegalParameter;
+        } else {
+            /* an empty value cannot be converted */
+            l_error = (pos == 0) ? EC_CorruptedData : EC_IllegalParameter;
+        }
+    }
+    return l_error;
+}
+
+
+OFCondition DcmIntegerString::getSint32Vector(OFVector<Sint32> &sintVals)
+{
+    /* get stored value */
+    char *strVal = NULL;
+    Uint32 strLen = 0;
+    OFCondition l_error = getString(strVal, strLen);
+    /* clear result variable */
+    sintVals.clear();
+    if (l_error.good() && (strVal != NULL))
+    {
+        /* determine number of stored values */
+        const unsigned long vm = getVM();
+        if (vm > 0)
+        {
+            const char *p = strVal;
+            const char *endVal = strVal + strLen;
+            Sint32 sintVal = 0;
+            /* avoid memory re-allocations by specifying the expected size */
+            sintVals.reserve(vm);
+            for (unsigned long i = 0; i < vm; i++)
+            {
+                /* convert single value directly from the string buffer */
+                if (parseSint32(p, sintVal))
+                {
+                    /* store integer value in result variable */
+                    sintVals.push_back(sintVal);
+                    /* skip any trailing characters and the delimiter */
+                    while ((p < endVal) && (*p != '\\'))
+                        ++p;
+                    ++p;
+                } else {
+                    l_error = EC_CorruptedData;
+                    break;
+                }
+            }
+        }
     }
     return l_error;
 }
@@ -119,6 +213,37 @@ OFCondition DcmIntegerString::getSint32(Sint32 &sintVal,
 // ********************************
 
 
+OFCondition DcmIntegerString::putSint32Array(const Sint32 *sintVals,
+                                             const unsigned long numSints)
+{
+    errorFlag = EC_Normal;
+    if (numSints > 0)
+    {
+        /* check for valid data */
+        if (sintVals != NULL)
+        {
+            /* create the string value in a single buffer (including the delimiters) */
+            char *strVal = new char[numSints * (MAX_IS_LENGTH + 1) + 1];
+            char *p = strVal;
+            for (unsigned long i = 0; i < numSints; i++)
+            {
+                if (i > 0)
+                    *p++ = '\\';
+                p += sprintf(p, "%ld", OFstatic_cast(long, sintVals[i]));
+            }
+            errorFlag = putString(strVal, OFstatic_cast(Uint32, p - strVal));
+            delete[] strVal;
+        } else
+            errorFlag = EC_CorruptedData;
+    } else
+        putValue(NULL, 0);
+    return errorFlag;
+}
+
+
+// ********************************
+
+
 OFCondition DcmIntegerString::getOFString(OFString &stringVal,
                                           const unsigned long pos,
                                           OFBool normalize)
@@ -132,6 +257,18 @@ OFCondition DcmIntegerString::getOFString(OFString &stringVal,
 }
 
 
+OFCondition DcmIntegerString::getStringView(const char *&stringVal,
+                                            Uint32 &stringLen,
+                                            const unsigned long pos,
+                                            OFBool normalize)
+{
+    OFCondition l_error = DcmByteString::getStringView(stringVal, stringLen, pos, normalize);
+    if (l_error.good() && normalize)
+        normalizeString(stringVal, stringLen, DELETE_LEADING, DELETE_TRAILING);
+    return l_error;
+}
+
+
 // ********************************
 
 
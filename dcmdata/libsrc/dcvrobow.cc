@@ -269,6 +269,12 @@ void DcmOtherByteOtherWord::postLoadValue()
 }
 
 
+OFBool DcmOtherByteOtherWord::supportsMappedValue() const
+{
+    return OFTrue;
+}
+
+
 // ********************************
 
 
@@ -716,28 +722,16 @@ OFCondition DcmOtherByteOtherWord::writeXML(STD_NAMESPACE ostream &out,
                     Uint16 *wordValues = NULL;
                     if (getUint16Array(wordValues).good() && (wordValues != NULL))
                     {
-                        const unsigned long count = getLengthField() / sizeof(Uint16);
-                        out << STD_NAMESPACE hex << STD_NAMESPACE setfill('0');
                         /* print word values in hex mode */
-                        out << STD_NAMESPACE setw(4) << (*(wordValues++));
-                        for (unsigned long i = 1; i < count; i++)
-                            out << "\\" << STD_NAMESPACE setw(4) << (*(wordValues++));
-                        /* reset i/o manipulators */
-                        out << STD_NAMESPACE dec << STD_NAMESPACE setfill(' ');
+                        writeHexValues(out, wordValues, getLengthField() / sizeof(Uint16));
                     }
                 } else {
                     /* get and check 8 bit data */
                     Uint8 *byteValues = NULL;
                     if (getUint8Array(byteValues).good() && (byteValues != NULL))
                     {
-                        const unsigned long count = getLengthField();
-                        out << STD_NAMESPACE hex << STD_NAMESPACE setfill('0');
                         /* print byte values in hex mode */
-                        out << STD_NAMESPACE setw(2) << OFstatic_cast(int, *(byteValues++));
-                        for (unsigned long i = 1; i < count; i++)
-                            out << "\\" << STD_NAMESPACE setw(2) << OFstatic_cast(int, *(byteValues++));
-                        /* reset i/o manipulators */
-                        out << STD_NAMESPACE dec << STD_NAMESPACE setfill(' ');
+                        writeHexValues(out, byteValues, getLengthField());
                     }
                 }
             }
@@ -748,3 +742,63 @@ OFCondition DcmOtherByteOtherWord::writeXML(STD_NAMESPACE ostream &out,
     /* always report success */
     return EC_Normal;
 }
+
+
+// ********************************
+
+
+// hex digits used for the XML output of binary data
+static const char hex_digits[] = "0123456789abcdef";
+
+// size of the buffer used for writing hex numbers to the output stream
+#define HEX_BUFFER_SIZE 4096
+
+
+void DcmOtherByteOtherWord::writeHexValues(STD_NAMESPACE ostream&out,
+                                           const Uint8 *byteValues,
+                                           const unsigned long count)
+{
+    /* hex numbers are collected in a buffer, each value requires at most 3 characters */
+    char buffer[HEX_BUFFER_SIZE];
+    size_t n = 0;
+    for (unsigned long i = 0; i < count; i++)
+    {
+        if (n > HEX_BUFFER_SIZE - 3)
+        {
+            out.write(buffer, OFstatic_cast(STD_NAMESPACE streamsize, n));
+            n = 0;
+        }
+        if (i > 0)
+            buffer[n++] = '\\';
+        buffer[n++] = hex_digits[(byteValues[i] >> 4) & 0x0f];
+        buffer[n++] = hex_digits[byteValues[i] & 0x0f];
+    }
+    if (n > 0)
+        out.write(buffer, OFstatic_cast(STD_NAMESPACE streamsize, n));
+}
+
+
+void DcmOtherByteOtherWord::writeHexValues(STD_NAMESPACE ostream&out,
+                                           const Uint16 *wordValues,
+                                           const unsigned long count)
+{
+    /* hex numbers are collected in a buffer, each value requires at most 5 characters */
+    char buffer[HEX_BUFFER_SIZE];
+    size_t n = 0;
+    for (unsigned long i = 0; i < count; i++)
+    {
+        if (n > HEX_BUFFER_SIZE - 5)
+        {
+            out.write(buffer, OFstatic_cast(STD_NAMESPACE streamsize, n));
+            n = 0;
+        }
+        if (i > 0)
+            buffer[n++] = '\\';
+        buffer[n++] = hex_digits[(wordValues[i] >> 12) & 0x0f];
+        buffer[n++] = hex_digits[(wordValues[i] >> 8) & 0x0f];
+        buffer[n++] = hex_digits[(wordValues[i] >> 4) & 0x0f];
+        buffer[n++] = hex_digits[wordValues[i] & 0x0f];
+    }
+    if (n > 0)
+        out.write(buffer, OFstatic_cast(STD_NAMESPACE streamsize, n));
+}
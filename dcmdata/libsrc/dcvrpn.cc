@@ -102,6 +102,18 @@ OFCondition DcmPersonName::getOFString(OFString &stringVal,
 }
 
 
+OFCondition DcmPersonName::getStringView(const char *&stringVal,
+                                         Uint32 &stringLen,
+                                         const unsigned long pos,
+                                         OFBool normalize)
+{
+    OFCondition l_error = DcmCharString::getStringView(stringVal, stringLen, pos, normalize);
+    if (l_error.good() && normalize)
+        normalizeString(stringVal, stringLen, !DELETE_LEADING, DELETE_TRAILING);
+    return l_error;
+}
+
+
 OFCondition DcmPersonName::writeXML(STD_NAMESPACE ostream &out,
                                     const size_t flags)
 {
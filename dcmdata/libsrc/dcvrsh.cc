@@ -102,6 +102,18 @@ OFCondition DcmShortString::getOFString(OFString &stringVal,
 }
 
 
+OFCondition DcmShortString::getStringView(const char *&stringVal,
+                                          Uint32 &stringLen,
+                                          const unsigned long pos,
+                                          OFBool normalize)
+{
+    OFCondition l_error = DcmCharString::getStringView(stringVal, stringLen, pos, normalize);
+    if (l_error.good() && normalize)
+        normalizeString(stringVal, stringLen, DELETE_LEADING, DELETE_TRAILING);
+    return l_error;
+}
+
+
 // ********************************
 
 
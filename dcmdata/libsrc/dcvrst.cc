@@ -105,6 +105,21 @@ OFCondition DcmShortText::getOFString(OFString &stringVal,
 }
 
 
+OFCondition DcmShortText::getStringView(const char *&stringVal,
+                                        Uint32 &stringLen,
+                                        const unsigned long /*pos*/,
+                                        OFBool normalize)
+{
+    /* get string value without handling the "\" as a delimiter */
+    char *strVal = NULL;
+    OFCondition l_error = getString(strVal, stringLen);
+    stringVal = strVal;
+    if (l_error.good() && normalize)
+        normalizeString(stringVal, stringLen, !DELETE_LEADING, DELETE_TRAILING);
+    return l_error;
+}
+
+
 OFCondition DcmShortText::getOFStringArray(OFString &stringVal,
                                            OFBool normalize)
 {
@@ -160,6 +160,18 @@ OFCondition DcmUniqueIdentifier::getOFString(OFString &stringVal,
 }
 
 
+OFCondition DcmUniqueIdentifier::getStringView(const char *&stringVal,
+                                               Uint32 &stringLen,
+                                               const unsigned long pos,
+                                               OFBool normalize)
+{
+    OFCondition l_error = DcmByteString::getStringView(stringVal, stringLen, pos, normalize);
+    if (l_error.good() && normalize)
+        normalizeString(stringVal, stringLen, !DELETE_LEADING, DELETE_TRAILING, getPaddingChar() /* NULL-byte */);
+    return l_error;
+}
+
+
 // ********************************
 
 
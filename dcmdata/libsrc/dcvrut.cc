@@ -106,6 +106,21 @@ OFCondition DcmUnlimitedText::getOFString(OFString &strValue,
 }
 
 
+OFCondition DcmUnlimitedText::getStringView(const char *&stringVal,
+                                            Uint32 &stringLen,
+                                            const unsigned long /*pos*/,
+                                            OFBool normalize)
+{
+    /* get string value without handling the "\" as a delimiter */
+    char *strVal = NULL;
+    OFCondition l_error = getString(strVal, stringLen);
+    stringVal = strVal;
+    if (l_error.good() && normalize)
+        normalizeString(stringVal, stringLen, !DELETE_LEADING, DELETE_TRAILING);
+    return l_error;
+}
+
+
 OFCondition DcmUnlimitedText::getOFStringArray(OFString &strValue,
                                                OFBool normalize)
 {
@@ -51,6 +51,7 @@
 #include "dcmtk/ofstd/ofstring.h"
 #include "dcmtk/ofstd/ofdatime.h"
 #include "dcmtk/dcmdata/dcdicent.h"
+#include "dcmtk/ofstd/ofvector.h"
 
 #define PRIVATE_TAGS_IFNAME "WITH_PRIVATE_TAGS"
 
@@ -115,6 +116,163 @@ printSimpleEntry(FILE* fout, const DcmDictEntry* e, OFBool& isFirst, OFBool& isP
       fprintf(fout, "      NULL }\n");
 }
 
+/*
+** Compute a perfect hash function for the given entries with the
+** "hash and displace" scheme: The entries are distributed into buckets,
+** and for each bucket (largest first) a displacement value is searched
+** that maps all entries of the bucket to unused slots.
+*/
+static OFBool
+computePerfectHash(const OFVector<const DcmDictEntry *>& entries,
+                   OFVector<Uint16>& displacements,
+                   OFVector<Uint16>& slots)
+{
+    const size_t n = entries.size();
+    if (n >= DcmStaticHashDict::EmptySlot)
+        return OFFalse;
+    const size_t bucketCount = n / 2 + 1;
+    size_t slotCount = n + n / 4 + 1;
+
+    /* distribute the entries into buckets */
+    OFVector<OFVector<size_t> > buckets(bucketCount);
+    size_t largestBucket = 0;
+    size_t i, j;
+    for (i = 0; i < n; ++i)
+    {
+        const DcmDictEntry *e = entries[i];
+        const size_t b = DcmStaticHashDict::hash(*e, e->getPrivateCreator(), 0) % bucketCount;
+        buckets[b].push_back(i);
+        if (buckets[b].size() > largestBucket)
+            largestBucket = buckets[b].size();
+    }
+
+    /* try to find displacement values, enlarge the table if not successful */
+    OFVector<size_t> candidates;
+    while (slotCount < DcmStaticHashDict::EmptySlot)
+    {
+        OFBool success = OFTrue;
+        displacements.clear();
+        displacements.resize(bucketCount, 0);
+        slots.clear();
+        slots.resize(slotCount, DcmStaticHashDict::EmptySlot);
+        for (size_t bucketSize = largestBucket; success && (bucketSize > 0); --bucketSize)
+        {
+            for (size_t b = 0; success && (b < bucketCount); ++b)
+            {
+                const OFVector<size_t>& bucket = buckets[b];
+                if (bucket.size() != bucketSize)
+                    continue;
+                OFBool found = OFFalse;
+                for (Uint32 d = 0; !found && (d < DcmStaticHashDict::EmptySlot); ++d)
+                {
+                    found = OFTrue;
+                    candidates.clear();
+                    for (j = 0; found && (j < bucketSize); ++j)
+                    {
+                        const DcmDictEntry *e = entries[bucket[j]];
+                        const size_t slot = DcmStaticHashDict::hash(*e, e->getPrivateCreator(), d + 1) % slotCount;
+                        if (slots[slot] != DcmStaticHashDict::EmptySlot)
+                            found = OFFalse;
+                        for (size_t k = 0; found && (k < candidates.size()); ++k)
+                        {
+                            if (candidates[k] == slot)
+                                found = OFFalse;
+                        }
+                        candidates.push_back(slot);
+                    }
+                    if (found)
+                    {
+                        displacements[b] = OFstatic_cast(Uint16, d);
+                        for (j = 0; j < bucketSize; ++j)
+                            slots[candidates[j]] = OFstatic_cast(Uint16, bucket[j]);
+                    }
+                }
+                if (!found)
+                    success = OFFalse;
+            }
+        }
+        if (success)
+            return OFTrue;
+        slotCount += slotCount / 8 + 1;
+    }
+    return OFFalse;
+}
+
+static void
+printUint16Array(FILE* fout, const OFVector<Uint16>& values, const char *name)
+{
+    fprintf(fout, "static const Uint16 %s[] = {", name);
+    for (size_t i = 0; i < values.size(); ++i)
+    {
+        if (i % 12 == 0)
+            fprintf(fout, "\n   ");
+        fprintf(fout, " 0x%04x%s", values[i], (i + 1 < values.size()) ? "," : "");
+    }
+    fprintf(fout, "\n};\n\n");
+}
+
+static OFBool
+printStaticHashDict(FILE* fout, const OFVector<const DcmDictEntry *>& entries, const char *name)
+{
+    OFVector<Uint16> displacements;
+    OFVector<Uint16> slots;
+    if (entries.empty())
+    {
+        /* a table with a single empty slot */
+        displacements.push_back(0);
+        slots.push_back(DcmStaticHashDict::EmptySlot);
+    }
+    else if (!computePerfectHash(entries, displacements, slots))
+    {
+        fprintf(stderr, "mkdictbi: cannot compute perfect hash function for %s\n", name);
+        return OFFalse;
+    }
+
+    /* the entries in the order of the indices in the slot table */
+    fprintf(fout, "static const DcmDictStaticEntry %s[] = {\n", name);
+    for (size_t i = 0; i < entries.size(); ++i)
+    {
+        const DcmDictEntry *e = entries[i];
+        const char *c = e->getPrivateCreator();
+        fprintf(fout, "%s{ 0x%04x, 0x%04x, EVR_%s, \"%s\", %d, %d, \"%s\",\n",
+                (i == 0) ? "    " : "  , ",
+                e->getGroup(), e->getElement(),
+                e->getVR().getVRName(),
+                e->getTagName(),
+                e->getVMMin(), e->getVMMax(),
+                OFSTRING_GUARD(e->getStandardVersion()));
+        if (c)
+          fprintf(fout, "      \"%s\" }\n", c);
+        else
+          fprintf(fout, "      NULL }\n");
+    }
+    if (entries.empty())
+        fprintf(fout, "    { 0, 0, EVR_UNKNOWN, NULL, 0, 0, NULL, NULL }\n");
+    fprintf(fout, "};\n\n");
+    fprintf(fout, "static const unsigned int %s_count = %lu;\n\n", name, OFstatic_cast(unsigned long, entries.size()));
+
+    OFString arrayName(name);
+    printUint16Array(fout, displacements, (arrayName + "_displacements").c_str());
+    printUint16Array(fout, slots, (arrayName + "_slots").c_str());
+
+    /* the description of the hash table is initialized by the compiler, the
+       table itself is created on first use (see DcmStaticHashDict::getTable()),
+       i.e. it can also be used during the static initialization of other objects */
+    fprintf(fout, "static DcmStaticHashDictData %sData = {\n", name);
+    fprintf(fout, "    %s, %s_count,\n", name, name);
+    fprintf(fout, "    %s_displacements, sizeof(%s_displacements)/sizeof(Uint16),\n", name, name);
+    fprintf(fout, "    %s_slots, sizeof(%s_slots)/sizeof(Uint16),\n", name, name);
+    fprintf(fout, "    NULL\n");
+    fprintf(fout, "};\n\n");
+    return OFTrue;
+}
+
+static void
+printStaticHashDictLoad(FILE* fout, const char *name)
+{
+    fprintf(fout, "    addStaticDictionary(DcmStaticHashDict::getTable(%sData));\n", name);
+}
+
 #ifdef HAVE_CUSERID
 static char*
 getUserName(char* userString, int /* maxLen */)
@@ -260,6 +418,43 @@ main(int argc, char* argv[])
     fprintf(fout, "\n");
     fprintf(fout, "const char* dcmBuiltinDictBuildDate = \"%s\";\n", dateString.c_str());
     fprintf(fout, "\n");
+
+    /*
+    ** the hash table does not maintain ordering so we must put
+    ** all the entries into a sorted list.
+    */
+    DcmDictEntryList list;
+    DcmHashDictIterator iter(globalDataDict.normalBegin());
+    DcmHashDictIterator last(globalDataDict.normalEnd());
+    for (; iter != last; ++iter) {
+        e = new DcmDictEntry(*(*iter));
+        list.insertAndReplace(e);
+    }
+
+    /* non-repeating standard and private elements are stored in separate tables */
+    OFVector<const DcmDictEntry *> standardEntries;
+    OFVector<const DcmDictEntry *> privateEntries;
+    DcmDictEntryListIterator listIter(list.begin());
+    DcmDictEntryListIterator listLast(list.end());
+    for (; listIter != listLast; ++listIter)
+    {
+        if ((*listIter)->getPrivateCreator())
+            privateEntries.push_back(*listIter);
+        else
+            standardEntries.push_back(*listIter);
+    }
+    if (!printStaticHashDict(fout, standardEntries, "standardBuiltinDict"))
+        return 1;
+    if (!privateEntries.empty())
+    {
+        fprintf(fout, "#ifdef %s\n", PRIVATE_TAGS_IFNAME);
+        fprintf(fout, "\n");
+        if (!printStaticHashDict(fout, privateEntries, "privateBuiltinDict"))
+            return 1;
+        fprintf(fout, "#endif\n");
+        fprintf(fout, "\n");
+    }
+
     fprintf(fout, "struct DBI_SimpleEntry {\n");
     fprintf(fout, "    Uint16 group;\n");
     fprintf(fout, "    Uint16 element;\n");
@@ -280,27 +475,6 @@ main(int argc, char* argv[])
     OFBool isFirst = OFTrue;
     OFBool isPrivate = OFFalse;
 
-    /*
-    ** the hash table does not maintain ordering so we must put
-    ** all the entries into a sorted list.
-    */
-    DcmDictEntryList list;
-    DcmHashDictIterator iter(globalDataDict.normalBegin());
-    DcmHashDictIterator last(globalDataDict.normalEnd());
-    for (; iter != last; ++iter) {
-        e = new DcmDictEntry(*(*iter));
-        list.insertAndReplace(e);
-    }
-    /* output the list contents */
-
-    /* non-repeating standard elements */
-    DcmDictEntryListIterator listIter(list.begin());
-    DcmDictEntryListIterator listLast(list.end());
-    for (; listIter != listLast; ++listIter)
-    {
-        printSimpleEntry(fout, *listIter, isFirst, isPrivate);
-    }
-
     /* repeating standard elements */
     DcmDictEntryListIterator repIter(globalDataDict.repeatingBegin());
     DcmDictEntryListIterator repLast(globalDataDict.repeatingEnd());
@@ -324,6 +498,19 @@ main(int argc, char* argv[])
     fprintf(fout, "void\n");
     fprintf(fout, "DcmDataDictionary::loadBuiltinDictionary()\n");
     fprintf(fout, "{\n");
+    fprintf(fout, "    /*\n");
+    fprintf(fout, "    ** the static hash tables of non-repeating elements are created\n");
+    fprintf(fout, "    ** on first use and shared by all dictionaries\n");
+    fprintf(fout, "    */\n");
+    printStaticHashDictLoad(fout, "standardBuiltinDict");
+    if (!privateEntries.empty())
+    {
+        fprintf(fout, "#ifdef %s\n", PRIVATE_TAGS_IFNAME);
+        printStaticHashDictLoad(fout, "privateBuiltinDict");
+        fprintf(fout, "#endif\n");
+    }
+    fprintf(fout, "\n");
+    fprintf(fout, "    /* repeating elements are added to the list of repeating tags */\n");
     fprintf(fout, "    DcmDictEntry* e = NULL;\n");
     fprintf(fout, "    const DBI_SimpleEntry *b = simpleBuiltinDict;\n");
     fprintf(fout, "    for (int i=0; i<simpleBuiltinDict_count; i++) {\n");
@@ -0,0 +1,319 @@
+/*
+ *
+ *  Copyright (C) 2012, OFFIS e.V.
+ *  All rights reserved.  See COPYRIGHT file for details.
+ *
+ *  This software and supporting documentation were developed by
+ *
+ *    OFFIS e.V.
+ *    R&D Division Health
+ *    Escherweg 2
+ *    D-26121 Oldenburg, Germany
+ *
+ *
+ *  Module:  dcmdata
+ *
+ *  Author:  DCMTK team
+ *
+ *  Purpose: test program for appending records to an existing DICOMDIR in place
+ *
+ */
+
+
+#include "dcmtk/config/osconfig.h"    /* make sure OS specific configuration is included first */
+
+#include "dcmtk/ofstd/oftest.h"
+#include "dcmtk/ofstd/oftempf.h"
+#include "dcmtk/ofstd/oftimer.h"
+#include "dcmtk/ofstd/offile.h"
+#include "dcmtk/dcmdata/dctk.h"
+
+
+/* number of patients in the DICOMDIR used for measuring the performance */
+#define NUMBER_OF_PATIENTS 100
+
+/* number of images per series */
+#define NUMBER_OF_IMAGES 4
+
+
+// add a directory record with the given unique key below the parent record
+static DcmDirectoryRecord *addRecord(DcmDirectoryRecord *parent, const E_DirRecType recordType,
+                                     const DcmTagKey &key, const OFString &value)
+{
+    DcmDirectoryRecord *record = new DcmDirectoryRecord(recordType, NULL, NULL);
+    OFCHECK(record->putAndInsertString(key, value.c_str()).good());
+    OFCHECK(parent->insertSub(record).good());
+    return record;
+}
+
+// add a patient with one study and one series to the given root record
+static DcmDirectoryRecord *addPatient(DcmDirectoryRecord &root, const int patient, const int numberOfImages)
+{
+    char buf[64];
+    sprintf(buf, "PAT%i", patient);
+    DcmDirectoryRecord *patientRec = addRecord(&root, ERT_Patient, DCM_PatientID, buf);
+    patientRec->putAndInsertString(DCM_PatientName, "Doe^John");
+    sprintf(buf, "1.2.276.0.7230010.3.4.%i", patient);
+    DcmDirectoryRecord *study = addRecord(patientRec, ERT_Study, DCM_StudyInstanceUID, buf);
+    sprintf(buf, "1.2.276.0.7230010.3.4.%i.1", patient);
+    DcmDirectoryRecord *series = addRecord(study, ERT_Series, DCM_SeriesInstanceUID, buf);
+    for (int i = 0; i < numberOfImages; ++i)
+    {
+        sprintf(buf, "1.2.276.0.7230010.3.4.%i.1.%i", patient, i);
+        addRecord(series, ERT_Image, DCM_ReferencedSOPInstanceUIDInFile, buf);
+    }
+    return patientRec;
+}
+
+// add new records to an existing DICOMDIR (or to the reference in memory)
+static void addNewRecords(DcmDicomDir &dicomdir, const int numberOfPatients)
+{
+    DcmDirectoryRecord &root = dicomdir.getRootRecord();
+    // new image in the last series of the first patient
+    DcmDirectoryRecord *series = root.getSub(0)->getSub(0)->getSub(0);
+    OFCHECK(series != NULL);
+    if (series == NULL) return;
+    addRecord(series, ERT_Image, DCM_ReferencedSOPInstanceUIDInFile, "1.2.276.0.7230010.3.4.0.1.999");
+    // new series below the existing study of the second patient
+    DcmDirectoryRecord *study = root.getSub(1)->getSub(0);
+    series = addRecord(study, ERT_Series, DCM_SeriesInstanceUID, "1.2.276.0.7230010.3.4.1.2");
+    addRecord(series, ERT_Image, DCM_ReferencedSOPInstanceUIDInFile, "1.2.276.0.7230010.3.4.1.2.0");
+    // new patients at the end of the root directory entity
+    addPatient(root, numberOfPatients, 2);
+    addPatient(root, numberOfPatients + 1, 1);
+}
+
+// create a DICOMDIR with the given number of patients
+static void createDicomDir(const OFString &filename, const int numberOfPatients, const E_EncodingType enctype)
+{
+    // otherwise, the records would be added to the existing DICOMDIR
+    OFStandard::deleteFile(filename);
+    DcmDicomDir dicomdir(filename.c_str(), "TEST");
+    for (int i = 0; i < numberOfPatients; ++i)
+        addPatient(dicomdir.getRootRecord(), i, NUMBER_OF_IMAGES);
+    OFCHECK(dicomdir.write(DICOMDIR_DEFAULT_TRANSFERSYNTAX, enctype).good());
+}
+
+// get the directory records in preorder as a string, one line per record
+static void getRecords(DcmDirectoryRecord *parent, OFString &result)
+{
+    DcmDirectoryRecord *record = NULL;
+    while ((record = parent->nextSub(record)) != NULL)
+    {
+        char buf[16];
+        OFString value;
+        const E_DirRecType recordType = record->getRecordType();
+        switch (recordType)
+        {
+            case ERT_Patient:
+                record->findAndGetOFString(DCM_PatientID, value);
+                break;
+            case ERT_Study:
+                record->findAndGetOFString(DCM_StudyInstanceUID, value);
+                break;
+            case ERT_Series:
+                record->findAndGetOFString(DCM_SeriesInstanceUID, value);
+                break;
+            default:
+                record->findAndGetOFString(DCM_ReferencedSOPInstanceUIDInFile, value);
+                break;
+        }
+        sprintf(buf, "%i ", OFstatic_cast(int, recordType));
+        result += buf;
+        result += value;
+        result += "\n";
+        getRecords(record, result);
+    }
+}
+
+// load the given DICOMDIR and get its directory records
+static OFString loadRecords(const OFString &filename)
+{
+    OFString result;
+    DcmDicomDir dicomdir(filename.c_str());
+    OFCHECK(dicomdir.error().good());
+    OFCHECK(dicomdir.verify().good());
+    getRecords(&dicomdir.getRootRecord(), result);
+    return result;
+}
+
+// create a reference DICOMDIR that is written completely
+static OFString createReference(const OFString &filename, const int numberOfPatients, const E_EncodingType enctype)
+{
+    createDicomDir(filename, numberOfPatients, enctype);
+    {
+        DcmDicomDir dicomdir(filename.c_str());
+        addNewRecords(dicomdir, numberOfPatients);
+        OFCHECK(dicomdir.write(DICOMDIR_DEFAULT_TRANSFERSYNTAX, enctype).good());
+    }
+    return loadRecords(filename);
+}
+
+// append to an existing DICOMDIR in place and compare the result with the reference
+static void checkAppend(const OFString &filename, const OFString &refFilename, const E_EncodingType enctype)
+{
+    const int numberOfPatients = 5;
+    const OFString expected = createReference(refFilename, numberOfPatients, enctype);
+    createDicomDir(filename, numberOfPatients, enctype);
+    const size_t oldSize = OFStandard::getFileSize(filename);
+    Uint32 offset = 0;
+    {
+        DcmDicomDir dicomdir(filename.c_str());
+        offset = dicomdir.getRootRecord().getSub(2)->getFileOffset();
+        addNewRecords(dicomdir, numberOfPatients);
+        OFCHECK(dicomdir.writeIncremental(enctype).good());
+        // a second call without any changes does not modify the file
+        OFCHECK(dicomdir.writeIncremental(enctype).good());
+    }
+    OFCHECK(OFStandard::getFileSize(filename) > oldSize);
+    OFCHECK(loadRecords(filename) == expected);
+    // the existing records are not moved
+    DcmDicomDir dicomdir(filename.c_str());
+    OFCHECK_EQUAL(dicomdir.getRootRecord().getSub(2)->getFileOffset(), offset);
+}
+
+// read the content of the given file
+static OFString readFile(const OFString &filename)
+{
+    OFString result;
+    OFFile file;
+    if (file.fopen(filename.c_str(), "rb"))
+    {
+        char buf[4096];
+        size_t count;
+        while ((count = file.fread(buf, 1, sizeof(buf))) > 0)
+            result.append(buf, count);
+    }
+    return result;
+}
+
+// store a little endian 32-bit value
+static void appendUint32(OFString &result, const size_t value)
+{
+    for (int i = 0; i < 4; ++i)
+        result += OFstatic_cast(char, (value >> (8 * i)) & 0xff);
+}
+
+// write a journal file that restores the original content from the modified one,
+// i.e. as if writeIncremental() had been interrupted after modifying the file
+static OFBool writeJournal(const OFString &journal, const OFString &original, const OFString &modified)
+{
+    OFString ranges;
+    size_t count = 0;
+    for (size_t pos = 0; pos < original.size(); pos += 8)
+    {
+        const size_t length = (original.size() - pos < 8) ? original.size() - pos : 8;
+        if (original.compare(pos, length, modified, pos, length) != 0)
+        {
+            appendUint32(ranges, pos);
+            appendUint32(ranges, length);
+            ranges += original.substr(pos, length);
+            ++count;
+        }
+    }
+    OFString content("DDJ1");
+    appendUint32(content, original.size());
+    appendUint32(content, count);
+    content += ranges;
+    OFFile file;
+    return (count > 0) && file.fopen(journal.c_str(), "wb") &&
+        (file.fwrite(content.data(), 1, content.size()) == content.size()) && (file.fclose() == 0);
+}
+
+
+OFTEST(dcmdata_dicomdirAppendInPlace)
+{
+    OFTempFile tempFile(O_RDWR, "", "tdcmdir", ".dcm");
+    OFTempFile refFile(O_RDWR, "", "tdcmdir", ".dcm");
+    OFCHECK(tempFile.getStatus().good());
+    OFCHECK(refFile.getStatus().good());
+    const OFString filename(tempFile.getFilename());
+    const OFString refFilename(refFile.getFilename());
+    // the record types of a DICOMDIR read from file (padded to even length) are
+    // only recognized with automatic input data correction, which other tests disable
+    const OFBool inputDataCorrection = dcmEnableAutomaticInputDataCorrection.get();
+    dcmEnableAutomaticInputDataCorrection.set(OFTrue);
+
+    checkAppend(filename, refFilename, EET_UndefinedLength);
+    checkAppend(filename, refFilename, EET_ExplicitLength);
+
+    // a modified record whose offsets are updated requires the complete DICOMDIR to be written
+    createDicomDir(filename, 3, EET_UndefinedLength);
+    {
+        DcmDicomDir dicomdir(filename.c_str());
+        OFCHECK(dicomdir.getRootRecord().getSub(2)->putAndInsertString(DCM_PatientName, "Doe^Jane").good());
+        addPatient(dicomdir.getRootRecord(), 3, 1);
+        OFCHECK(dicomdir.writeIncremental().good());
+    }
+    {
+        DcmDicomDir dicomdir(filename.c_str());
+        OFString value;
+        OFCHECK_EQUAL(dicomdir.getRootRecord().cardSub(), 4);
+        OFCHECK(dicomdir.getRootRecord().getSub(2)->findAndGetOFString(DCM_PatientName, value).good());
+        OFCHECK_EQUAL(value, "Doe^Jane");
+        OFCHECK(dicomdir.verify().good());
+    }
+
+    // other modified records have to be marked in order to write the complete DICOMDIR
+    createDicomDir(filename, 3, EET_UndefinedLength);
+    {
+        DcmDicomDir dicomdir(filename.c_str());
+        DcmDirectoryRecord *study = dicomdir.getRootRecord().getSub(0)->getSub(0);
+        OFCHECK(study->putAndInsertString(DCM_StudyID, "STUDY1").good());
+        study->setModified();
+        addPatient(dicomdir.getRootRecord(), 3, 1);
+        OFCHECK(dicomdir.writeIncremental().good());
+        OFCHECK(!study->isModified());
+    }
+    {
+        DcmDicomDir dicomdir(filename.c_str());
+        OFString value;
+        OFCHECK_EQUAL(dicomdir.getRootRecord().cardSub(), 4);
+        OFCHECK(dicomdir.getRootRecord().getSub(0)->getSub(0)->findAndGetOFString(DCM_StudyID, value).good());
+        OFCHECK_EQUAL(value, "STUDY1");
+        OFCHECK(dicomdir.verify().good());
+    }
+
+    // an interrupted update is undone when the DICOMDIR is read the next time
+    createDicomDir(filename, 3, EET_UndefinedLength);
+    const OFString original = readFile(filename);
+    {
+        DcmDicomDir dicomdir(filename.c_str());
+        addPatient(dicomdir.getRootRecord(), 3, 1);
+        OFCHECK(dicomdir.writeIncremental().good());
+    }
+    const OFString journal = filename + DICOMDIR_JOURNAL_SUFFIX;
+    OFCHECK(!OFStandard::fileExists(journal));
+    OFCHECK(writeJournal(journal, original, readFile(filename)));
+    {
+        DcmDicomDir dicomdir(filename.c_str());
+        OFCHECK_EQUAL(dicomdir.getRootRecord().cardSub(), 3);
+    }
+    OFCHECK(!OFStandard::fileExists(journal));
+    OFCHECK(readFile(filename) == original);
+
+    // compare the performance with writing the complete DICOMDIR
+    createDicomDir(filename, NUMBER_OF_PATIENTS, EET_UndefinedLength);
+    createDicomDir(refFilename, NUMBER_OF_PATIENTS, EET_UndefinedLength);
+    double timeComplete = 0;
+    double timeInPlace = 0;
+    {
+        DcmDicomDir dicomdir(refFilename.c_str());
+        addPatient(dicomdir.getRootRecord(), NUMBER_OF_PATIENTS, 1);
+        OFTimer timer;
+        OFCHECK(dicomdir.write().good());
+        timeComplete = timer.getDiff();
+    }
+    {
+        DcmDicomDir dicomdir(filename.c_str());
+        addPatient(dicomdir.getRootRecord(), NUMBER_OF_PATIENTS, 1);
+        OFTimer timer;
+        OFCHECK(dicomdir.writeIncremental().good());
+        timeInPlace = timer.getDiff();
+    }
+    OFCHECK(loadRecords(filename) == loadRecords(refFilename));
+    OFTEST_LOG_VERBOSE("Adding a patient to a DICOMDIR with " << NUMBER_OF_PATIENTS * (NUMBER_OF_IMAGES + 3)
+        << " records: " << timeComplete << " s when writing the complete file, "
+        << timeInPlace << " s when appending in place");
+    dcmEnableAutomaticInputDataCorrection.set(inputDataCorrection);
+}
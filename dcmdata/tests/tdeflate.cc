@@ -0,0 +1,258 @@
+/*
+ *
+ *  Copyright (C) 2012, OFFIS e.V.
+ *  All rights reserved.  See COPYRIGHT file for details.
+ *
+ *  This software and supporting documentation were developed by
+ *
+ *    OFFIS e.V.
+ *    R&D Division Health
+ *    Escherweg 2
+ *    D-26121 Oldenburg, Germany
+ *
+ *
+ *  Module:  dcmdata
+ *
+ *  Author:  DCMTK team
+ *
+ *  Purpose: test program for the (parallel) deflate compression of datasets
+ *
+ */
+
+
+#include "dcmtk/config/osconfig.h"    /* make sure OS specific configuration is included first */
+
+#include "dcmtk/ofstd/oftest.h"
+
+#ifdef WITH_ZLIB
+
+#include "dcmtk/ofstd/oftempf.h"
+#include "dcmtk/ofstd/oftimer.h"
+#include "dcmtk/dcmdata/dctk.h"
+#include "dcmtk/dcmdata/dcostrmb.h"
+#include "dcmtk/dcmdata/dcostrmf.h"
+#include "dcmtk/dcmdata/dcostrmz.h"
+
+
+/* number of content items in the SR test dataset */
+#define NUMBER_OF_CONTENT_ITEMS 5000
+
+/* number of ROI contours in the RT test dataset */
+#define NUMBER_OF_CONTOURS 40
+
+/* number of contour items per ROI contour */
+#define NUMBER_OF_ITEMS 50
+
+/* number of points per contour */
+#define NUMBER_OF_POINTS 100
+
+/* size of the buffer used for writing to memory */
+#define BUFFER_SIZE 4096
+
+
+// create an SR document like dataset with a flat list of text content items
+static void createSRDataset(DcmDataset &dset)
+{
+    char buf[64];
+    OFCHECK(dset.putAndInsertString(DCM_SOPClassUID, UID_ComprehensiveSRStorage).good());
+    OFCHECK(dset.putAndInsertString(DCM_SOPInstanceUID, "1.2.276.0.7230010.3.1.4.4712").good());
+    OFCHECK(dset.putAndInsertString(DCM_ValueType, "CONTAINER").good());
+    for (int i = 0; i < NUMBER_OF_CONTENT_ITEMS; ++i)
+    {
+        DcmItem *item = NULL;
+        OFCHECK(dset.findOrCreateSequenceItem(DCM_ContentSequence, item, -2 /* append */).good());
+        if (item == NULL) return;
+        item->putAndInsertString(DCM_RelationshipType, "CONTAINS");
+        item->putAndInsertString(DCM_ValueType, "TEXT");
+        DcmItem *code = NULL;
+        OFCHECK(item->findOrCreateSequenceItem(DCM_ConceptNameCodeSequence, code).good());
+        if (code == NULL) return;
+        code->putAndInsertString(DCM_CodeValue, "121071");
+        code->putAndInsertString(DCM_CodingSchemeDesignator, "DCM");
+        code->putAndInsertString(DCM_CodeMeaning, "Finding");
+        sprintf(buf, "Finding number %i with some text, measured %i.%i mm", i, (i * 7) % 100, i % 10);
+        item->putAndInsertString(DCM_TextValue, buf);
+    }
+}
+
+// create an RT structure set like dataset with large contour data
+static void createRTDataset(DcmDataset &dset)
+{
+    char buf[32];
+    OFCHECK(dset.putAndInsertString(DCM_SOPClassUID, UID_RTStructureSetStorage).good());
+    OFCHECK(dset.putAndInsertString(DCM_SOPInstanceUID, "1.2.276.0.7230010.3.1.4.4713").good());
+    for (int i = 0; i < NUMBER_OF_CONTOURS; ++i)
+    {
+        DcmItem *roi = NULL;
+        OFCHECK(dset.findOrCreateSequenceItem(DCM_ROIContourSequence, roi, -2 /* append */).good());
+        if (roi == NULL) return;
+        for (int j = 0; j < NUMBER_OF_ITEMS; ++j)
+        {
+            DcmItem *contour = NULL;
+            OFCHECK(roi->findOrCreateSequenceItem(DCM_ContourSequence, contour, -2 /* append */).good());
+            if (contour == NULL) return;
+            contour->putAndInsertString(DCM_ContourGeometricType, "CLOSED_PLANAR");
+            sprintf(buf, "%i", NUMBER_OF_POINTS);
+            contour->putAndInsertString(DCM_NumberOfContourPoints, buf);
+            OFString data;
+            for (int k = 0; k < NUMBER_OF_POINTS; ++k)
+            {
+                sprintf(buf, "%s%.2f\\%.2f\\%.1f", (k > 0) ? "\\" : "", 100.0 + ((i + k) * 37) % 1000 / 10.0,
+                    -50.0 + ((j + k) * 53) % 1000 / 10.0, 2.5 * j);
+                data += buf;
+            }
+            contour->putAndInsertOFStringArray(DCM_ContourData, data);
+        }
+        sprintf(buf, "%i", i);
+        roi->putAndInsertString(DCM_ReferencedROINumber, buf);
+    }
+}
+
+// encode the given dataset uncompressed, for comparing the content
+static OFString encodeDataset(DcmDataset &dset)
+{
+    const Uint32 length = dset.getLength(EXS_LittleEndianExplicit, EET_ExplicitLength);
+    char *buffer = new char[length];
+    DcmOutputBufferStream outStream(buffer, length);
+    dset.transferInit();
+    OFCHECK(dset.write(outStream, EXS_LittleEndianExplicit, EET_ExplicitLength, NULL).good());
+    dset.transferEnd();
+    void *data = NULL;
+    offile_off_t written = 0;
+    outStream.flushBuffer(data, written);
+    const OFString result(buffer, OFstatic_cast(size_t, written));
+    delete[] buffer;
+    return result;
+}
+
+// write the given dataset with the given compression parameters to file
+static offile_off_t writeDeflated(DcmDataset &dset, const OFString &filename, const int level,
+                                  const int strategy, const Uint32 numberOfThreads, double &elapsed)
+{
+    OFTimer timer;
+    {
+        DcmOutputFileStream outStream(filename.c_str());
+        OFCHECK(outStream.status().good());
+        outStream.setCompressionParameters(level, strategy, numberOfThreads);
+        dset.transferInit();
+        OFCHECK(dset.write(outStream, EXS_DeflatedLittleEndianExplicit, EET_UndefinedLength, NULL).good());
+        dset.transferEnd();
+        outStream.flush();
+        OFCHECK(outStream.isFlushed());
+    }
+    elapsed = timer.getDiff();
+    return OFStandard::getFileSize(filename);
+}
+
+// read the given file and compare it with the original dataset
+static void checkDeflated(const OFString &filename, const OFString &expected)
+{
+    DcmDataset dset;
+    OFCHECK(dset.loadFile(filename.c_str(), EXS_DeflatedLittleEndianExplicit).good());
+    OFCHECK(encodeDataset(dset) == expected);
+}
+
+// write the given dataset to a small memory buffer, i.e. with I/O suspension
+static OFString writeToBuffer(DcmDataset &dset, const Uint32 numberOfThreads)
+{
+    OFString result;
+    char buffer[BUFFER_SIZE];
+    DcmOutputBufferStream outStream(buffer, BUFFER_SIZE);
+    outStream.setCompressionParameters(Z_DEFAULT_COMPRESSION, Z_DEFAULT_STRATEGY, numberOfThreads);
+    void *data = NULL;
+    offile_off_t length = 0;
+    dset.transferInit();
+    OFCondition status = EC_StreamNotifyClient;
+    while (status == EC_StreamNotifyClient)
+    {
+        status = dset.write(outStream, EXS_DeflatedLittleEndianExplicit, EET_UndefinedLength, NULL);
+        outStream.flushBuffer(data, length);
+        result.append(OFstatic_cast(const char *, data), OFstatic_cast(size_t, length));
+    }
+    OFCHECK(status.good());
+    dset.transferEnd();
+    while (!outStream.isFlushed())
+    {
+        outStream.flush();
+        outStream.flushBuffer(data, length);
+        result.append(OFstatic_cast(const char *, data), OFstatic_cast(size_t, length));
+    }
+    return result;
+}
+
+// read the content of the given file
+static OFString readFile(const OFString &filename)
+{
+    OFString result;
+    FILE *file = fopen(filename.c_str(), "rb");
+    OFCHECK(file != NULL);
+    if (file == NULL) return result;
+    char buffer[BUFFER_SIZE];
+    size_t length;
+    while ((length = fread(buffer, 1, BUFFER_SIZE, file)) > 0)
+        result.append(buffer, length);
+    fclose(file);
+    return result;
+}
+
+// compress the given dataset with various parameters and compare the result
+static void checkDataset(DcmDataset &dset, const char *name, const OFString &filename)
+{
+    const OFString expected = encodeDataset(dset);
+    double timeSequential = 0;
+    double timeParallel = 0;
+    double elapsed = 0;
+    const offile_off_t sizeSequential = writeDeflated(dset, filename, Z_DEFAULT_COMPRESSION, Z_DEFAULT_STRATEGY, 1, timeSequential);
+    checkDeflated(filename, expected);
+    const offile_off_t sizeParallel = writeDeflated(dset, filename, Z_DEFAULT_COMPRESSION, Z_DEFAULT_STRATEGY, 4, timeParallel);
+    checkDeflated(filename, expected);
+    // the result of the parallel compression does not depend on the consumer
+    OFCHECK(writeToBuffer(dset, 4) == readFile(filename));
+    // other compression levels and strategies
+    writeDeflated(dset, filename, 9, Z_FILTERED, 3, elapsed);
+    checkDeflated(filename, expected);
+    writeDeflated(dset, filename, 1, Z_RLE, 2, elapsed);
+    checkDeflated(filename, expected);
+    writeDeflated(dset, filename, 0, Z_DEFAULT_STRATEGY, 1, elapsed);
+    checkDeflated(filename, expected);
+    const double size = OFstatic_cast(double, expected.size()) / (1024.0 * 1024.0);
+    OFTEST_LOG_VERBOSE("Deflating " << name << " dataset with " << expected.size() << " bytes: "
+        << (timeSequential > 0 ? size / timeSequential : 0) << " MB/s and " << sizeSequential << " bytes with 1 thread, "
+        << (timeParallel > 0 ? size / timeParallel : 0) << " MB/s and " << sizeParallel << " bytes with 4 threads");
+}
+
+
+OFTEST(dcmdata_parallelDeflate)
+{
+    OFTempFile tempFile(O_RDWR, "", "tdeflate", ".dcm");
+    OFCHECK(tempFile.getStatus().good());
+    const OFString filename(tempFile.getFilename());
+
+    DcmDataset srDataset;
+    createSRDataset(srDataset);
+    checkDataset(srDataset, "SR", filename);
+    DcmDataset rtDataset;
+    createRTDataset(rtDataset);
+    checkDataset(rtDataset, "RT", filename);
+
+    // datasets smaller than a single block and the global settings
+    DcmFileFormat fileformat;
+    OFCHECK(fileformat.getDataset()->putAndInsertString(DCM_PatientName, "Doe^John").good());
+    dcmZlibCompressionThreads.set(4);
+    OFCHECK(fileformat.saveFile(filename.c_str(), EXS_DeflatedLittleEndianExplicit).good());
+    dcmZlibCompressionThreads.set(1);
+    DcmFileFormat readFileformat;
+    OFCHECK(readFileformat.loadFile(filename.c_str()).good());
+    OFString value;
+    OFCHECK(readFileformat.getDataset()->findAndGetOFString(DCM_PatientName, value).good());
+    OFCHECK_EQUAL(value, "Doe^John");
+}
+
+#else /* WITH_ZLIB */
+
+OFTEST(dcmdata_parallelDeflate)
+{
+    // nothing to test without zlib
+}
+
+#endif /* WITH_ZLIB */
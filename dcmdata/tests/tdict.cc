@@ -23,11 +23,25 @@
 #include "dcmtk/config/osconfig.h"    /* make sure OS specific configuration is included first */
 
 #include "dcmtk/ofstd/oftest.h"
+#include "dcmtk/ofstd/oftimer.h"
 #include "dcmtk/dcmdata/dcdict.h"
 #include "dcmtk/dcmdata/dctagkey.h"
 #include "dcmtk/dcmdata/dcvr.h"
 #include "dcmtk/dcmdata/dcdicent.h"
 
+// look up a builtin entry in a new dictionary, also used during static initialization
+static OFBool lookupBuiltinEntry()
+{
+    DcmDataDictionary localDict(OFTrue, OFFalse);
+    if (!localDict.isDictionaryLoaded())
+        return OFTrue;
+    const DcmDictEntry *entry = localDict.findEntry(DcmTagKey(0x0010, 0x0010), NULL);
+    return (entry != NULL) && (OFString(entry->getTagName()) == "PatientName");
+}
+
+// the initialization order relative to the builtin dictionary is unspecified
+static const OFBool staticLookupResult = lookupBuiltinEntry();
+
 OFTEST(dcmdata_readingDataDictionary)
 {
     // Does loading the global data dictionary work?
@@ -106,3 +120,82 @@ OFTEST(dcmdata_usingDataDictionary)
 
 #undef checkDictionary
 }
+
+OFTEST(dcmdata_builtinDataDictionary)
+{
+    DcmDataDictionary localDict(OFTrue, OFFalse);
+    // Nothing to check if the builtin dictionary is not compiled in
+    if (!localDict.isDictionaryLoaded())
+        return;
+
+    // The builtin entries are found by tag key and by name
+    const DcmTagKey key(0x0010, 0x0010);
+    const DcmDictEntry *entry = localDict.findEntry(key, NULL);
+    OFCHECK(entry != NULL);
+    if (entry != NULL)
+    {
+        OFCHECK_EQUAL(entry->getEVR(), EVR_PN);
+        OFCHECK_EQUAL(OFString(entry->getTagName()), "PatientName");
+    }
+    OFCHECK(localDict.findEntry("PatientName") == entry);
+    OFCHECK(localDict.findEntry(DcmTagKey(0x0010, 0x0011), NULL) == NULL);
+    OFCHECK(localDict.findEntry(key, "Test") == NULL);
+    // Repeating and skeleton entries are still available
+    OFCHECK(localDict.findEntry(DcmTagKey(0x6002, 0x0010), NULL) != NULL);
+    OFCHECK(localDict.findEntry(DcmTagKey(0xfffe, 0xe000), NULL) != NULL);
+#ifdef WITH_PRIVATE_TAGS
+    // Private entries are also found with the element number of a private block
+    entry = localDict.findEntry(DcmTagKey(0x0019, 0x1003), "GEMS_ACQU_01");
+    OFCHECK(entry != NULL && entry->getEVR() == EVR_DS);
+    OFCHECK(localDict.findEntry(DcmTagKey(0x0019, 0x1003), "Test") == NULL);
+#endif
+
+    // The builtin entries can also be used during static initialization
+    OFCHECK(staticLookupResult);
+
+    // Skeleton entries that are also part of the builtin dictionary are counted once
+    const int entries = localDict.numberOfEntries();
+    OFCHECK_EQUAL(localDict.numberOfNormalTagEntries() + localDict.numberOfRepeatingTagEntries(),
+        entries + localDict.numberOfSkeletonEntries());
+
+    // The iterator visits the builtin entries and the skeleton entries
+    int count = 0;
+    OFBool found = OFFalse;
+    for (DcmHashDictIterator iter(localDict.normalBegin()); iter != localDict.normalEnd(); ++iter)
+    {
+        ++count;
+        if ((*iter)->getGroup() == 0x0010 && (*iter)->getElement() == 0x0010 && (*iter)->getPrivateCreator() == NULL)
+            found = OFTrue;
+    }
+    OFCHECK_EQUAL(count, localDict.numberOfNormalTagEntries());
+    OFCHECK(found);
+
+    // Entries added later replace the builtin ones
+    DcmDictEntry *replaced = new DcmDictEntry(0x0010, 0x0010, DcmVR(EVR_LO), "ReplacedName", 1, 1,
+        "test", OFTrue, NULL);
+    localDict.addEntry(replaced);
+    OFCHECK(localDict.findEntry(key, NULL) == replaced);
+    OFCHECK(localDict.findEntry("ReplacedName") == replaced);
+    OFCHECK_EQUAL(localDict.numberOfEntries(), entries);
+    // ... and are visited instead of them
+    int replacedCount = 0;
+    for (DcmHashDictIterator iter(localDict.normalBegin()); iter != localDict.normalEnd(); ++iter)
+    {
+        ++replacedCount;
+        if ((*iter)->getGroup() == 0x0010 && (*iter)->getElement() == 0x0010 && (*iter)->getPrivateCreator() == NULL)
+            OFCHECK(*iter == replaced);
+    }
+    OFCHECK_EQUAL(replacedCount, count);
+
+    // The builtin entries are removed together with all others
+    localDict.clear();
+    OFCHECK(localDict.findEntry(key, NULL) == NULL);
+    OFCHECK(localDict.findEntry("PatientName") == NULL);
+    OFCHECK_EQUAL(localDict.numberOfNormalTagEntries(), 0);
+
+    // Measure the time needed to load the builtin dictionary (only reported in verbose mode)
+    OFTimer timer;
+    for (int i = 0; i < 100; ++i)
+        localDict.reloadDictionaries(OFTrue, OFFalse);
+    OFTEST_LOG_VERBOSE("Loading builtin dictionary 100 times: " << timer.getDiff() << " s");
+}
@@ -0,0 +1,217 @@
+/*
+ *
+ *  Copyright (C) 2012, OFFIS e.V.
+ *  All rights reserved.  See COPYRIGHT file for details.
+ *
+ *  This software and supporting documentation were developed by
+ *
+ *    OFFIS e.V.
+ *    R&D Division Health
+ *    Escherweg 2
+ *    D-26121 Oldenburg, Germany
+ *
+ *
+ *  Module:  dcmdata
+ *
+ *  Author:  DCMTK team
+ *
+ *  Purpose: test program for concurrent access to the global data dictionary
+ *
+ */
+
+
+#include "dcmtk/config/osconfig.h"    /* make sure OS specific configuration is included first */
+
+#include "dcmtk/ofstd/oftest.h"
+#include "dcmtk/ofstd/oftempf.h"
+#include "dcmtk/ofstd/oftimer.h"
+#include "dcmtk/dcmdata/dctk.h"
+
+#ifdef WITH_THREADS
+
+#include "dcmtk/ofstd/ofthread.h"
+
+
+/* number of threads used for the tests */
+#define NUMBER_OF_THREADS 4
+
+/* number of dictionary lookups per thread */
+#define NUMBER_OF_LOOKUPS 200000
+
+/* number of items in the dataset that is parsed by each thread */
+#define NUMBER_OF_ITEMS 2000
+
+/* private creator of the entries added while the readers are running */
+#define PRIVATE_CREATOR "TDICTMT"
+
+
+// thread that looks up dictionary entries
+class LookupThread : public OFThread
+{
+public:
+    LookupThread()
+      : OFThread(), errors(0)
+    {
+    }
+
+    virtual void run()
+    {
+        for (int i = 0; i < NUMBER_OF_LOOKUPS; ++i)
+        {
+            const DcmDataDictionary &dict = dcmDataDict.rdlock();
+            const DcmDictEntry *entry = dict.findEntry((i & 1) ? DCM_PatientName : DCM_Rows, NULL);
+            if ((entry == NULL) || ((i & 1) ? (entry->getEVR() != EVR_PN) : (entry->getEVR() != EVR_US)))
+                ++errors;
+            dcmDataDict.unlock();
+        }
+    }
+
+    int errors;
+};
+
+
+// thread that parses a given file a couple of times
+class ParseThread : public OFThread
+{
+public:
+    ParseThread(const OFString &filename, const int rounds)
+      : OFThread(), errors(0), filename_(filename), rounds_(rounds)
+    {
+    }
+
+    virtual void run()
+    {
+        for (int i = 0; i < rounds_; ++i)
+        {
+            DcmFileFormat fileformat;
+            DcmSequenceOfItems *seq = NULL;
+            if (fileformat.loadFile(filename_.c_str()).bad() ||
+                fileformat.getDataset()->findAndGetSequence(DCM_ROIContourSequence, seq).bad() ||
+                (seq->card() != NUMBER_OF_ITEMS))
+            {
+                ++errors;
+            }
+        }
+    }
+
+    int errors;
+
+private:
+    OFString filename_;
+    int rounds_;
+};
+
+
+// create a file with many small elements, so that the parsing is dominated by creating tags
+static OFBool createTestFile(const OFString &filename)
+{
+    DcmFileFormat fileformat;
+    DcmDataset *dset = fileformat.getDataset();
+    OFCHECK(dset->putAndInsertString(DCM_PatientName, "Doe^John").good());
+    for (unsigned long i = 0; i < NUMBER_OF_ITEMS; ++i)
+    {
+        DcmItem *item = NULL;
+        OFCHECK(dset->findOrCreateSequenceItem(DCM_ROIContourSequence, item, -2 /* append */).good());
+        if (item != NULL)
+        {
+            OFCHECK(item->putAndInsertString(DCM_ReferencedROINumber, "1").good());
+            OFCHECK(item->putAndInsertString(DCM_ROIDisplayColor, "255\\0\\0").good());
+            OFCHECK(item->putAndInsertString(DCM_ContourGeometricType, "POINT").good());
+            OFCHECK(item->putAndInsertString(DCM_NumberOfContourPoints, "1").good());
+            OFCHECK(item->putAndInsertString(DCM_ContourData, "0.5\\1.5\\2.5").good());
+        }
+    }
+    return fileformat.saveFile(filename.c_str(), EXS_LittleEndianImplicit).good();
+}
+
+// run the given threads and return the elapsed time
+template<class T>
+static double runThreads(T **threads, const int count)
+{
+    OFTimer timer;
+    for (int i = 0; i < count; ++i)
+        OFCHECK_EQUAL(threads[i]->start(), 0);
+    for (int i = 0; i < count; ++i)
+    {
+        OFCHECK_EQUAL(threads[i]->join(), 0);
+        OFCHECK_EQUAL(threads[i]->errors, 0);
+    }
+    return timer.getDiff();
+}
+
+// add a private dictionary entry with the given element number
+static void addPrivateEntry(const Uint16 element)
+{
+    DcmDataDictionary &dict = dcmDataDict.wrlock();
+    dict.addEntry(new DcmDictEntry(0x0029, element, EVR_LO, "TestEntry", 1, 1, "private", OFTrue, PRIVATE_CREATOR));
+    dcmDataDict.unlock();
+}
+
+
+OFTEST(dcmdata_dictionaryThreads)
+{
+    // modifications are visible to subsequent readers
+    const DcmTagKey key(0x0029, 0x1000);
+    OFCHECK(dcmDataDict.rdlock().findEntry(key, PRIVATE_CREATOR) == NULL);
+    dcmDataDict.unlock();
+    addPrivateEntry(0x1000);
+    OFCHECK(dcmDataDict.rdlock().findEntry(key, PRIVATE_CREATOR) != NULL);
+    dcmDataDict.unlock();
+    OFCHECK(dcmDataDict.isDictionaryLoaded());
+
+    // modify the dictionary while other threads are reading it
+    LookupThread *lookups[NUMBER_OF_THREADS];
+    for (int i = 0; i < NUMBER_OF_THREADS; ++i)
+        lookups[i] = new LookupThread();
+    for (int i = 0; i < NUMBER_OF_THREADS; ++i)
+        OFCHECK_EQUAL(lookups[i]->start(), 0);
+    for (Uint16 elem = 0x1001; elem <= 0x1004; ++elem)
+        addPrivateEntry(elem);
+    for (int i = 0; i < NUMBER_OF_THREADS; ++i)
+    {
+        OFCHECK_EQUAL(lookups[i]->join(), 0);
+        OFCHECK_EQUAL(lookups[i]->errors, 0);
+        delete lookups[i];
+    }
+    DcmTag tag(0x0029, 0x1004, PRIVATE_CREATOR);
+    OFCHECK_EQUAL(tag.getEVR(), EVR_LO);
+    OFCHECK_EQUAL(OFString(tag.getTagName()), "TestEntry");
+
+    // look up entries on one and on several threads (only reported in verbose mode)
+    LookupThread *lookup = new LookupThread();
+    const double timeLookupSingle = runThreads(&lookup, 1);
+    delete lookup;
+    for (int i = 0; i < NUMBER_OF_THREADS; ++i)
+        lookups[i] = new LookupThread();
+    const double timeLookupParallel = runThreads(lookups, NUMBER_OF_THREADS);
+    for (int i = 0; i < NUMBER_OF_THREADS; ++i)
+        delete lookups[i];
+    OFTEST_LOG_VERBOSE(NUMBER_OF_LOOKUPS << " dictionary lookups: " << timeLookupSingle << " s on one thread, "
+        << timeLookupParallel << " s in each of " << NUMBER_OF_THREADS << " threads");
+
+    // parse a dataset on one and on several threads (only reported in verbose mode)
+    OFTempFile tempFile(O_RDWR, "", "tdictmt", ".dcm");
+    OFCHECK(tempFile.getStatus().good());
+    const OFString filename(tempFile.getFilename());
+    OFCHECK(createTestFile(filename));
+    ParseThread *single = new ParseThread(filename, NUMBER_OF_THREADS);
+    const double timeSingle = runThreads(&single, 1);
+    delete single;
+    ParseThread *parsers[NUMBER_OF_THREADS];
+    for (int i = 0; i < NUMBER_OF_THREADS; ++i)
+        parsers[i] = new ParseThread(filename, 1);
+    const double timeParallel = runThreads(parsers, NUMBER_OF_THREADS);
+    for (int i = 0; i < NUMBER_OF_THREADS; ++i)
+        delete parsers[i];
+    OFTEST_LOG_VERBOSE("Parsing dataset " << NUMBER_OF_THREADS << " times: " << timeSingle
+        << " s on one thread, " << timeParallel << " s on " << NUMBER_OF_THREADS << " threads");
+}
+
+#else
+
+OFTEST(dcmdata_dictionaryThreads)
+{
+    // without thread support, there is nothing to test here
+}
+
+#endif
@@ -24,16 +24,22 @@
 #include "dcmtk/ofstd/oftest.h"
 
 OFTEST_REGISTER(dcmdata_partialElementAccess);
+OFTEST_REGISTER(dcmdata_partialFrameAccess);
 OFTEST_REGISTER(dcmdata_i2d_bmp);
 OFTEST_REGISTER(dcmdata_checkStringValue);
 OFTEST_REGISTER(dcmdata_determineVM);
 OFTEST_REGISTER(dcmdata_getValueFromString);
+OFTEST_REGISTER(dcmdata_getStringView);
 OFTEST_REGISTER(dcmdata_pathAccess);
 OFTEST_REGISTER(dcmdata_dateTime);
 OFTEST_REGISTER(dcmdata_decimalString_1);
 OFTEST_REGISTER(dcmdata_decimalString_2);
 OFTEST_REGISTER(dcmdata_decimalString_3);
 OFTEST_REGISTER(dcmdata_decimalString_4);
+OFTEST_REGISTER(dcmdata_decimalString_5);
+OFTEST_REGISTER(dcmdata_decimalString_6);
+OFTEST_REGISTER(dcmdata_integerString_1);
+OFTEST_REGISTER(dcmdata_integerString_2);
 OFTEST_REGISTER(dcmdata_personName);
 OFTEST_REGISTER(dcmdata_uniqueIdentifier_1);
 OFTEST_REGISTER(dcmdata_uniqueIdentifier_2);
@@ -88,9 +94,26 @@ OFTEST_REGISTER(dcmdata_parser_wrongExplicitVRinDataset_preferDataDict);
 OFTEST_REGISTER(dcmdata_parser_undefinedLengthUNSequence);
 OFTEST_REGISTER(dcmdata_readingDataDictionary);
 OFTEST_REGISTER(dcmdata_usingDataDictionary);
+OFTEST_REGISTER(dcmdata_builtinDataDictionary);
 OFTEST_REGISTER(dcmdata_specificCharacterSet_1);
 OFTEST_REGISTER(dcmdata_specificCharacterSet_2);
 OFTEST_REGISTER(dcmdata_specificCharacterSet_3);
 OFTEST_REGISTER(dcmdata_specificCharacterSet_4);
+OFTEST_REGISTER(dcmdata_specificCharacterSet_5);
 OFTEST_REGISTER(dcmdata_attribute_filter);
+OFTEST_REGISTER(dcmdata_tagIndex);
+OFTEST_REGISTER(dcmdata_memoryMappedFile);
+OFTEST_REGISTER(dcmdata_tagScanner);
+OFTEST_REGISTER(dcmdata_dictionaryThreads);
+OFTEST_REGISTER(dcmdata_swapBytes);
+OFTEST_REGISTER(dcmdata_streamWriter);
+OFTEST_REGISTER(dcmdata_sequenceLengthCache);
+OFTEST_REGISTER(dcmdata_frameDecoding);
+OFTEST_REGISTER(dcmdata_frameEncoding);
+OFTEST_REGISTER(dcmdata_frameIndex);
+OFTEST_REGISTER(dcmdata_parallelDeflate);
+OFTEST_REGISTER(dcmdata_dicomdirAppendInPlace);
+OFTEST_REGISTER(dcmdata_uidRegistry);
+OFTEST_REGISTER(dcmdata_uidGenerator);
+OFTEST_REGISTER(dcmdata_writeXML);
 OFTEST_MAIN("dcmdata")
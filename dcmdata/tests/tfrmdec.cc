@@ -0,0 +1,317 @@
+/*
+ *
+ *  Copyright (C) 2012, OFFIS e.V.
+ *  All rights reserved.  See COPYRIGHT file for details.
+ *
+ *  This software and supporting documentation were developed by
+ *
+ *    OFFIS e.V.
+ *    R&D Division Health
+ *    Escherweg 2
+ *    D-26121 Oldenburg, Germany
+ *
+ *
+ *  Module:  dcmdata
+ *
+ *  Author:  DCMTK team
+ *
+ *  Purpose: test program for the compression and decompression of
+ *           multi-frame images with multiple threads
+ *
+ */
+
+
+#include "dcmtk/config/osconfig.h"    /* make sure OS specific configuration is included first */
+
+#include "dcmtk/ofstd/oftest.h"
+#include "dcmtk/ofstd/oftimer.h"
+#include "dcmtk/dcmdata/dctk.h"
+#include "dcmtk/dcmdata/dccodec.h"
+#include "dcmtk/dcmdata/dcrleerg.h"
+#include "dcmtk/dcmdata/dcrledrg.h"
+#include "dcmtk/dcmdata/dcpixseq.h"
+#include "dcmtk/dcmdata/dcpxitem.h"
+
+#define INCLUDE_CSTRING
+#include "dcmtk/ofstd/ofstdinc.h"
+
+
+/* number of frames of the test image */
+#define NUMBER_OF_FRAMES 24
+
+/* number of rows and columns of the test image */
+#define IMAGE_SIZE 256
+
+/* number of threads used for the parallel compression and decompression */
+#define NUMBER_OF_THREADS 4
+
+
+// frame processor that records the processed frames and fails for some of them
+class TestFrameProcessor : public DcmFrameProcessor
+{
+public:
+    TestFrameProcessor(const Uint32 numberOfFrames)
+    : processed(numberOfFrames, 0)
+    {
+    }
+
+    virtual OFCondition processFrame(Uint32 frameNo, size_t threadNo)
+    {
+        // each frame is only written by the thread processing it
+        ++processed[frameNo];
+        if (threadNo >= NUMBER_OF_THREADS)
+            return EC_MemoryExhausted;
+        if (frameNo == 13)
+            return EC_IllegalCall;
+        if (frameNo == 17)
+            return EC_CorruptedData;
+        return EC_Normal;
+    }
+
+    OFVector<int> processed;
+};
+
+// frame encoder that stores the frame number and fails for one frame
+class TestFrameEncoder : public DcmFrameEncoder
+{
+public:
+    TestFrameEncoder()
+    : prepared(0)
+    {
+    }
+
+    virtual OFCondition prepareFrame(Uint32 /* frameNo */, Uint32 /* slot */)
+    {
+        ++prepared;
+        return EC_Normal;
+    }
+
+    virtual OFCondition encodeFrame(Uint32 frameNo, Uint32 /* slot */, Uint8 *& compressedData, Uint32& compressedLength)
+    {
+        if (frameNo == 11)
+            return EC_CorruptedData;
+        compressedData = new Uint8[2];
+        compressedData[0] = OFstatic_cast(Uint8, frameNo);
+        compressedData[1] = 0;
+        compressedLength = 2;
+        return EC_Normal;
+    }
+
+    int prepared;
+};
+
+// create a 16 bit monochrome multi-frame image
+static void createTestImage(DcmDataset &dset, Uint16 *pixelData)
+{
+    const unsigned long frameSize = IMAGE_SIZE * IMAGE_SIZE;
+    for (unsigned long f = 0; f < NUMBER_OF_FRAMES; ++f)
+    {
+        for (unsigned long i = 0; i < frameSize; ++i)
+        {
+            // short runs of identical values make the image compressible
+            pixelData[f * frameSize + i] = OFstatic_cast(Uint16, ((i / 8) * 7 + f * 131) & 0xfff);
+        }
+    }
+    OFCHECK(dset.putAndInsertString(DCM_SOPClassUID, UID_MultiframeGrayscaleWordSecondaryCaptureImageStorage).good());
+    OFCHECK(dset.putAndInsertString(DCM_SOPInstanceUID, "1.2.276.0.7230010.3.1.4.4712").good());
+    OFCHECK(dset.putAndInsertUint16(DCM_SamplesPerPixel, 1).good());
+    OFCHECK(dset.putAndInsertString(DCM_PhotometricInterpretation, "MONOCHROME2").good());
+    OFCHECK(dset.putAndInsertString(DCM_NumberOfFrames, "24").good());
+    OFCHECK(dset.putAndInsertUint16(DCM_Rows, IMAGE_SIZE).good());
+    OFCHECK(dset.putAndInsertUint16(DCM_Columns, IMAGE_SIZE).good());
+    OFCHECK(dset.putAndInsertUint16(DCM_BitsAllocated, 16).good());
+    OFCHECK(dset.putAndInsertUint16(DCM_BitsStored, 12).good());
+    OFCHECK(dset.putAndInsertUint16(DCM_HighBit, 11).good());
+    OFCHECK(dset.putAndInsertUint16(DCM_PixelRepresentation, 0).good());
+    OFCHECK(dset.putAndInsertUint16Array(DCM_PixelData, pixelData, NUMBER_OF_FRAMES * frameSize).good());
+}
+
+// compress the given image with the RLE encoder, discard the uncompressed pixel data and return the elapsed time
+static double compressTestImage(DcmDataset &dset, const Uint32 fragmentSize, const OFBool createOffsetTable,
+                                const Uint32 numberOfThreads = 1)
+{
+    DcmRLEEncoderRegistration::registerCodecs(OFFalse, fragmentSize, createOffsetTable, OFFalse, numberOfThreads);
+    OFTimer timer;
+    OFCHECK(dset.chooseRepresentation(EXS_RLELossless, NULL).good());
+    const double elapsed = timer.getDiff();
+    OFCHECK(dset.canWriteXfer(EXS_RLELossless));
+    DcmRLEEncoderRegistration::cleanup();
+    DcmElement *elem = NULL;
+    OFCHECK(dset.findAndGetElement(DCM_PixelData, elem).good());
+    if (elem != NULL)
+        OFstatic_cast(DcmPixelData *, elem)->removeAllButCurrentRepresentations();
+    return elapsed;
+}
+
+// get the pixel sequence of the given compressed image
+static DcmPixelSequence *getPixelSequence(DcmDataset &dset)
+{
+    DcmElement *elem = NULL;
+    DcmPixelSequence *pixSeq = NULL;
+    OFCHECK(dset.findAndGetElement(DCM_PixelData, elem).good());
+    if (elem != NULL)
+        OFCHECK(OFstatic_cast(DcmPixelData *, elem)->getEncapsulatedRepresentation(EXS_RLELossless, NULL, pixSeq).good());
+    return pixSeq;
+}
+
+// check whether the given pixel sequences contain the same fragments
+static void compareFragments(DcmPixelSequence *pixSeq1, DcmPixelSequence *pixSeq2)
+{
+    OFCHECK((pixSeq1 != NULL) && (pixSeq2 != NULL));
+    if ((pixSeq1 == NULL) || (pixSeq2 == NULL)) return;
+    OFCHECK_EQUAL(pixSeq1->card(), pixSeq2->card());
+    for (unsigned long i = 0; (i < pixSeq1->card()) && (i < pixSeq2->card()); ++i)
+    {
+        DcmPixelItem *item1 = NULL;
+        DcmPixelItem *item2 = NULL;
+        OFCHECK(pixSeq1->getItem(item1, i).good());
+        OFCHECK(pixSeq2->getItem(item2, i).good());
+        if ((item1 == NULL) || (item2 == NULL)) return;
+        Uint8 *data1 = NULL;
+        Uint8 *data2 = NULL;
+        OFCHECK_EQUAL(item1->getLength(), item2->getLength());
+        item1->getUint8Array(data1);
+        item2->getUint8Array(data2);
+        OFCHECK((item1->getLength() == 0) || ((data1 != NULL) && (data2 != NULL) &&
+            (memcmp(data1, data2, item1->getLength()) == 0)));
+    }
+}
+
+// decompress a copy of the given image with the given number of threads, compare the result and return the elapsed time
+static double decompressTestImage(const DcmDataset &compressed, const Uint16 *expected, const Uint32 numberOfThreads)
+{
+    DcmDataset dset(compressed);
+    DcmRLEDecoderRegistration::registerCodecs(OFFalse, OFFalse, numberOfThreads);
+    OFTimer timer;
+    OFCHECK(dset.chooseRepresentation(EXS_LittleEndianExplicit, NULL).good());
+    const double elapsed = timer.getDiff();
+    DcmRLEDecoderRegistration::cleanup();
+    const Uint16 *pixelData = NULL;
+    unsigned long count = 0;
+    OFCHECK(dset.findAndGetUint16Array(DCM_PixelData, pixelData, &count).good());
+    OFCHECK_EQUAL(count, OFstatic_cast(unsigned long, NUMBER_OF_FRAMES * IMAGE_SIZE * IMAGE_SIZE));
+    OFCHECK((pixelData != NULL) && (memcmp(pixelData, expected, count * sizeof(Uint16)) == 0));
+    return elapsed;
+}
+
+
+OFTEST(dcmdata_frameDecoding)
+{
+    const unsigned long pixelCount = NUMBER_OF_FRAMES * IMAGE_SIZE * IMAGE_SIZE;
+    Uint16 *pixelData = new Uint16[pixelCount];
+    DcmDataset original;
+    createTestImage(original, pixelData);
+
+    // single fragment per frame with offset table
+    DcmDataset oneFragment(original);
+    compressTestImage(oneFragment, 0, OFTrue);
+    DcmPixelSequence *pixSeq = getPixelSequence(oneFragment);
+    OFVector<Uint32> startFragments;
+    OFCHECK(DcmCodec::determineFrameFragments(NUMBER_OF_FRAMES, pixSeq, startFragments).good());
+    OFCHECK_EQUAL(startFragments.size(), OFstatic_cast(size_t, NUMBER_OF_FRAMES + 1));
+    OFCHECK_EQUAL(startFragments[0], 1);
+    OFCHECK_EQUAL(startFragments[NUMBER_OF_FRAMES], NUMBER_OF_FRAMES + 1);
+    decompressTestImage(oneFragment, pixelData, 1);
+    const double timeSequential = decompressTestImage(oneFragment, pixelData, 1);
+    const double timeParallel = decompressTestImage(oneFragment, pixelData, NUMBER_OF_THREADS);
+
+    // multiple fragments per frame with and without offset table
+    // (the RLE decoder warns about segments that span several fragments, which is expected here)
+    DCM_dcmdataLogger.setLogLevel(OFLogger::ERROR_LOG_LEVEL);
+    DcmDataset withOffsetTable(original);
+    compressTestImage(withOffsetTable, 8 /* kbytes */, OFTrue);
+    pixSeq = getPixelSequence(withOffsetTable);
+    OFCHECK(DcmCodec::determineFrameFragments(NUMBER_OF_FRAMES, pixSeq, startFragments).good());
+    OFCHECK_EQUAL(startFragments.size(), OFstatic_cast(size_t, NUMBER_OF_FRAMES + 1));
+    OFCHECK((pixSeq != NULL) && (startFragments[NUMBER_OF_FRAMES] == pixSeq->card()));
+    for (size_t i = 0; i < NUMBER_OF_FRAMES; ++i)
+        OFCHECK(startFragments[i] < startFragments[i + 1]);
+    decompressTestImage(withOffsetTable, pixelData, 1);
+    decompressTestImage(withOffsetTable, pixelData, NUMBER_OF_THREADS);
+    DcmDataset withoutOffsetTable(original);
+    compressTestImage(withoutOffsetTable, 8 /* kbytes */, OFFalse);
+    pixSeq = getPixelSequence(withoutOffsetTable);
+    // the fragments of the frames cannot be determined in advance, so only one thread is used
+    OFCHECK(DcmCodec::determineFrameFragments(NUMBER_OF_FRAMES, pixSeq, startFragments).bad());
+    decompressTestImage(withoutOffsetTable, pixelData, NUMBER_OF_THREADS);
+    DCM_dcmdataLogger.setLogLevel(dcmtk::log4cplus::NOT_SET_LOG_LEVEL);
+
+    // the fragments can be accessed without the pixel sequence
+    OFVector<DcmCompressedFragment> fragments;
+    OFCHECK(DcmCodec::loadFragments(pixSeq, fragments).good());
+    OFCHECK((pixSeq != NULL) && (fragments.size() == pixSeq->card()));
+    OFCHECK((fragments.size() > 1) && (fragments[0].length == 0) && (fragments[1].data != NULL));
+
+    // processing stops after the first error, the lowest failed frame is reported
+    TestFrameProcessor sequential(NUMBER_OF_FRAMES);
+    OFCHECK(DcmCodec::processFrames(sequential, NUMBER_OF_FRAMES, 1) == EC_IllegalCall);
+    for (size_t i = 0; i < NUMBER_OF_FRAMES; ++i)
+        OFCHECK_EQUAL(sequential.processed[i], (i <= 13) ? 1 : 0);
+    TestFrameProcessor parallel(NUMBER_OF_FRAMES);
+    OFCHECK(DcmCodec::processFrames(parallel, NUMBER_OF_FRAMES, NUMBER_OF_THREADS) == EC_IllegalCall);
+    for (size_t i = 0; i < NUMBER_OF_FRAMES; ++i)
+        OFCHECK(parallel.processed[i] <= 1);
+    OFCHECK(DcmCodec::processFrames(parallel, 0, NUMBER_OF_THREADS).good());
+
+    // the decompression time is only reported in verbose mode
+    OFTEST_LOG_VERBOSE("Decompressing " << NUMBER_OF_FRAMES << " RLE frames of " << IMAGE_SIZE << "x" << IMAGE_SIZE
+        << " pixels: " << timeSequential << " s with 1 thread, " << timeParallel << " s with "
+        << NUMBER_OF_THREADS << " threads");
+
+    delete[] pixelData;
+}
+
+
+OFTEST(dcmdata_frameEncoding)
+{
+    const unsigned long pixelCount = NUMBER_OF_FRAMES * IMAGE_SIZE * IMAGE_SIZE;
+    Uint16 *pixelData = new Uint16[pixelCount];
+    DcmDataset original;
+    createTestImage(original, pixelData);
+
+    // parallel compression creates the same fragments and offset table as sequential compression
+    DcmDataset sequential(original);
+    const double timeSequential = compressTestImage(sequential, 0, OFTrue);
+    DcmDataset parallel(original);
+    const double timeParallel = compressTestImage(parallel, 0, OFTrue, NUMBER_OF_THREADS);
+    compareFragments(getPixelSequence(sequential), getPixelSequence(parallel));
+    decompressTestImage(parallel, pixelData, 1);
+
+    // the same with multiple fragments per frame
+    DcmDataset sequentialFragments(original);
+    compressTestImage(sequentialFragments, 8 /* kbytes */, OFTrue);
+    DcmDataset parallelFragments(original);
+    compressTestImage(parallelFragments, 8 /* kbytes */, OFTrue, NUMBER_OF_THREADS);
+    compareFragments(getPixelSequence(sequentialFragments), getPixelSequence(parallelFragments));
+    DCM_dcmdataLogger.setLogLevel(OFLogger::ERROR_LOG_LEVEL);
+    decompressTestImage(parallelFragments, pixelData, NUMBER_OF_THREADS);
+    DCM_dcmdataLogger.setLogLevel(dcmtk::log4cplus::NOT_SET_LOG_LEVEL);
+
+    // the frames are stored in ascending order, encoding stops after the first batch with an error
+    DcmPixelSequence pixSeq(DcmTag(DCM_PixelData, EVR_OB));
+    DcmOffsetList offsetList;
+    unsigned long compressedSize = 0;
+    TestFrameEncoder encoder;
+    OFCHECK(DcmCodec::encodeFrames(encoder, 10, NUMBER_OF_THREADS, &pixSeq, offsetList, 0, compressedSize).good());
+    OFCHECK_EQUAL(pixSeq.card(), 10);
+    OFCHECK_EQUAL(offsetList.size(), OFstatic_cast(size_t, 10));
+    OFCHECK_EQUAL(compressedSize, 20);
+    for (unsigned long i = 0; i < pixSeq.card(); ++i)
+    {
+        DcmPixelItem *item = NULL;
+        Uint8 *data = NULL;
+        OFCHECK(pixSeq.getItem(item, i).good());
+        OFCHECK((item != NULL) && item->getUint8Array(data).good() && (data != NULL) && (data[0] == i));
+    }
+    OFCHECK(DcmCodec::encodeFrames(encoder, NUMBER_OF_FRAMES, NUMBER_OF_THREADS, &pixSeq, offsetList, 0, compressedSize) == EC_CorruptedData);
+    OFCHECK(pixSeq.card() < 10 + NUMBER_OF_FRAMES);
+    OFCHECK(encoder.prepared < 10 + NUMBER_OF_FRAMES);
+    OFCHECK(DcmCodec::encodeFrames(encoder, 1, 1, NULL, offsetList, 0, compressedSize) == EC_IllegalCall);
+
+    // the compression time is only reported in verbose mode
+    OFTEST_LOG_VERBOSE("Compressing " << NUMBER_OF_FRAMES << " RLE frames of " << IMAGE_SIZE << "x" << IMAGE_SIZE
+        << " pixels: " << timeSequential << " s with 1 thread, " << timeParallel << " s with "
+        << NUMBER_OF_THREADS << " threads");
+
+    delete[] pixelData;
+}
@@ -0,0 +1,256 @@
+/*
+ *
+ *  Copyright (C) 2012, OFFIS e.V.
+ *  All rights reserved.  See COPYRIGHT file for details.
+ *
+ *  This software and supporting documentation were developed by
+ *
+ *    OFFIS e.V.
+ *    R&D Division Health
+ *    Escherweg 2
+ *    D-26121 Oldenburg, Germany
+ *
+ *
+ *  Module:  dcmdata
+ *
+ *  Author:  DCMTK team
+ *
+ *  Purpose: test program for the frame index of encapsulated pixel data
+ *
+ */
+
+
+#include "dcmtk/config/osconfig.h"    /* make sure OS specific configuration is included first */
+
+#include "dcmtk/ofstd/oftest.h"
+#include "dcmtk/ofstd/oftimer.h"
+#include "dcmtk/dcmdata/dctk.h"
+#include "dcmtk/dcmdata/dccodec.h"
+#include "dcmtk/dcmdata/dcpixseq.h"
+#include "dcmtk/dcmdata/dcpxitem.h"
+#include "dcmtk/dcmdata/dcrleerg.h"
+#include "dcmtk/dcmdata/dcrledrg.h"
+
+#define INCLUDE_CSTRING
+#include "dcmtk/ofstd/ofstdinc.h"
+
+
+/* number of frames of the JPEG-like pixel sequence */
+#define NUMBER_OF_FRAMES 2000
+
+/* number of frames of the RLE test image */
+#define NUMBER_OF_RLE_FRAMES 16
+
+/* number of rows and columns of the RLE test image */
+#define IMAGE_SIZE 128
+
+
+// create a pixel sequence with JPEG-like frames consisting of one to three fragments
+static void createJPEGSequence(DcmPixelSequence &pixSeq, DcmOffsetList &offsetList)
+{
+    OFCHECK(pixSeq.insert(new DcmPixelItem(DcmTag(DCM_Item, EVR_OB))).good());
+    Uint8 fragmentData[32];
+    for (Uint32 i = 0; i < NUMBER_OF_FRAMES; ++i)
+    {
+        const Uint32 numberOfFragments = i % 3 + 1;
+        for (Uint32 j = 0; j < numberOfFragments; ++j)
+        {
+            // only the first fragment of a frame starts with a SOI marker
+            memset(fragmentData, OFstatic_cast(Uint8, i), sizeof(fragmentData));
+            if (j == 0)
+            {
+                fragmentData[0] = 0xff;
+                fragmentData[1] = 0xd8;
+            }
+            DcmPixelItem *fragment = new DcmPixelItem(DcmTag(DCM_Item, EVR_OB));
+            OFCHECK(fragment->putUint8Array(fragmentData, sizeof(fragmentData)).good());
+            OFCHECK(pixSeq.insert(fragment).good());
+        }
+        // 8 bytes for the item tag and length of each fragment
+        offsetList.push_back(numberOfFragments * (sizeof(fragmentData) + 8));
+    }
+}
+
+// encode the given offsets as basic (4 bytes) or extended (8 bytes) offset table
+static void createOffsetTable(const DcmOffsetList &offsetList, const Uint32 entrySize, Uint8 *table)
+{
+    Uint32 offset = 0;
+    OFListConstIterator(Uint32) it = offsetList.begin();
+    for (Uint32 i = 0; it != offsetList.end(); ++i, ++it)
+    {
+        memset(table + i * entrySize, 0, entrySize);
+        for (Uint32 j = 0; j < 4; ++j)
+            table[i * entrySize + j] = OFstatic_cast(Uint8, offset >> (8 * j));
+        offset += *it;
+    }
+}
+
+// check the start fragment of all frames of the JPEG-like pixel sequence
+static void checkJPEGFrames(DcmPixelSequence &pixSeq)
+{
+    OFVector<Uint32> startFragments;
+    OFCHECK(pixSeq.getFrameFragments(NUMBER_OF_FRAMES, startFragments).good());
+    OFCHECK_EQUAL(startFragments.size(), OFstatic_cast(size_t, NUMBER_OF_FRAMES + 1));
+    if (startFragments.size() != NUMBER_OF_FRAMES + 1) return;
+    Uint32 fragment = 1;
+    for (Uint32 i = 0; i < NUMBER_OF_FRAMES; ++i)
+    {
+        OFCHECK_EQUAL(startFragments[i], fragment);
+        fragment += i % 3 + 1;
+    }
+    OFCHECK_EQUAL(startFragments[NUMBER_OF_FRAMES], pixSeq.card());
+}
+
+// create a multi-frame image compressed with RLE
+static void createRLEImage(DcmDataset &dset, Uint8 *pixelData)
+{
+    const unsigned long frameSize = IMAGE_SIZE * IMAGE_SIZE;
+    for (unsigned long i = 0; i < NUMBER_OF_RLE_FRAMES * frameSize; ++i)
+        pixelData[i] = OFstatic_cast(Uint8, (i / 5) * 3 + i / frameSize);
+    OFCHECK(dset.putAndInsertString(DCM_SOPClassUID, UID_MultiframeGrayscaleByteSecondaryCaptureImageStorage).good());
+    OFCHECK(dset.putAndInsertUint16(DCM_SamplesPerPixel, 1).good());
+    OFCHECK(dset.putAndInsertString(DCM_PhotometricInterpretation, "MONOCHROME2").good());
+    OFCHECK(dset.putAndInsertString(DCM_NumberOfFrames, "16").good());
+    OFCHECK(dset.putAndInsertUint16(DCM_Rows, IMAGE_SIZE).good());
+    OFCHECK(dset.putAndInsertUint16(DCM_Columns, IMAGE_SIZE).good());
+    OFCHECK(dset.putAndInsertUint16(DCM_BitsAllocated, 8).good());
+    OFCHECK(dset.putAndInsertUint16(DCM_BitsStored, 8).good());
+    OFCHECK(dset.putAndInsertUint16(DCM_HighBit, 7).good());
+    OFCHECK(dset.putAndInsertUint16(DCM_PixelRepresentation, 0).good());
+    OFCHECK(dset.putAndInsertUint8Array(DCM_PixelData, pixelData, NUMBER_OF_RLE_FRAMES * frameSize).good());
+    DcmRLEEncoderRegistration::registerCodecs(OFFalse, 0, OFTrue);
+    OFCHECK(dset.chooseRepresentation(EXS_RLELossless, NULL).good());
+    DcmRLEEncoderRegistration::cleanup();
+    DcmElement *elem = NULL;
+    OFCHECK(dset.findAndGetElement(DCM_PixelData, elem).good());
+    if (elem != NULL)
+        OFstatic_cast(DcmPixelData *, elem)->removeAllButCurrentRepresentations();
+}
+
+// decompress the given frame of the RLE image, starting from an unknown fragment
+static void checkRLEFrame(DcmDataset &dset, const Uint8 *pixelData, const Uint32 frameNo)
+{
+    DcmElement *elem = NULL;
+    OFCHECK(dset.findAndGetElement(DCM_PixelData, elem).good());
+    if (elem == NULL) return;
+    const Uint32 frameSize = IMAGE_SIZE * IMAGE_SIZE;
+    Uint8 *buffer = new Uint8[frameSize];
+    Uint32 startFragment = 0;
+    OFString colorModel;
+    OFCHECK(OFstatic_cast(DcmPixelData *, elem)->getUncompressedFrame(&dset, frameNo, startFragment, buffer, frameSize, colorModel).good());
+    OFCHECK(memcmp(buffer, pixelData + frameNo * frameSize, frameSize) == 0);
+    // the first fragment of the next frame is returned
+    OFCHECK_EQUAL(startFragment, 2 * frameNo + 2);
+    delete[] buffer;
+}
+
+
+OFTEST(dcmdata_frameIndex)
+{
+    DcmPixelSequence pixSeq(DcmTag(DCM_PixelData, EVR_OB));
+    DcmOffsetList offsetList;
+    createJPEGSequence(pixSeq, offsetList);
+
+    // without offset table, the frames are found by their JPEG markers
+    OFTimer timer;
+    Uint32 startFragment = 0;
+    OFCHECK(pixSeq.getFrameStartFragment(NUMBER_OF_FRAMES - 1, NUMBER_OF_FRAMES, startFragment).good());
+    const double timeScan = timer.getDiff();
+    OFCHECK_EQUAL(startFragment, pixSeq.card() - (NUMBER_OF_FRAMES - 1) % 3 - 1);
+    timer.reset();
+    for (Uint32 i = 0; i < NUMBER_OF_FRAMES; ++i)
+        OFCHECK(pixSeq.getFrameStartFragment((i * 997) % NUMBER_OF_FRAMES, NUMBER_OF_FRAMES, startFragment).good());
+    const double timeRandomAccess = timer.getDiff();
+    checkJPEGFrames(pixSeq);
+    OFCHECK(DcmCodec::determineStartFragment(1, NUMBER_OF_FRAMES, &pixSeq, startFragment).good());
+    OFCHECK_EQUAL(startFragment, 2);
+    OFCHECK(pixSeq.getFrameStartFragment(NUMBER_OF_FRAMES, NUMBER_OF_FRAMES, startFragment) == EC_IllegalCall);
+
+    // the index is discarded when a fragment is added, so the number of markers does not match any longer
+    Uint8 marker[2] = { 0xff, 0xd8 };
+    DcmPixelItem *fragment = new DcmPixelItem(DcmTag(DCM_Item, EVR_OB));
+    OFCHECK(fragment->putUint8Array(marker, 2).good());
+    OFCHECK(pixSeq.insert(fragment, 5).good());
+    OFCHECK(pixSeq.createFrameIndex(NUMBER_OF_FRAMES) == EC_TagNotFound);
+    OFCHECK(pixSeq.remove(fragment).good());
+    delete fragment;
+    OFCHECK(pixSeq.createFrameIndex(NUMBER_OF_FRAMES).good());
+
+    // frames without markers are found from the basic offset table
+    DcmPixelItem *offsetTable = NULL;
+    OFCHECK(pixSeq.getItem(offsetTable, 0).good());
+    if (offsetTable == NULL) return;
+    Uint8 *table = new Uint8[8 * NUMBER_OF_FRAMES];
+    createOffsetTable(offsetList, 4, table);
+    OFCHECK(offsetTable->putUint8Array(table, 4 * NUMBER_OF_FRAMES).good());
+    for (unsigned long i = 1; i < pixSeq.card(); ++i)
+    {
+        Uint8 *data = NULL;
+        OFCHECK(pixSeq.getItem(fragment, i).good());
+        OFCHECK(fragment->getUint8Array(data).good());
+        data[0] = 0;
+    }
+    checkJPEGFrames(pixSeq);
+
+    // an extended offset table takes precedence over an invalid basic offset table
+    OFCHECK(offsetTable->putUint8Array(table, 4 * (NUMBER_OF_FRAMES - 1)).good());
+    OFCHECK(pixSeq.getFrameStartFragment(1, NUMBER_OF_FRAMES, startFragment) == EC_TagNotFound);
+    createOffsetTable(offsetList, 8, table);
+    OFCHECK(pixSeq.createFrameIndex(NUMBER_OF_FRAMES, table, 8 * (NUMBER_OF_FRAMES - 1)) == EC_TagNotFound);
+    OFCHECK(pixSeq.createFrameIndex(NUMBER_OF_FRAMES, table, 8 * NUMBER_OF_FRAMES).good());
+    checkJPEGFrames(pixSeq);
+
+    // random access to the frames of an RLE image with an extended offset table only
+    const unsigned long pixelCount = NUMBER_OF_RLE_FRAMES * IMAGE_SIZE * IMAGE_SIZE;
+    Uint8 *pixelData = new Uint8[pixelCount];
+    DcmDataset dset;
+    createRLEImage(dset, pixelData);
+    DcmElement *elem = NULL;
+    DcmPixelSequence *rleSeq = NULL;
+    OFCHECK(dset.findAndGetElement(DCM_PixelData, elem).good());
+    if (elem != NULL)
+        OFCHECK(OFstatic_cast(DcmPixelData *, elem)->getEncapsulatedRepresentation(EXS_RLELossless, NULL, rleSeq).good());
+    if (rleSeq != NULL)
+    {
+        // the RLE decoder only reads the first fragment of a frame, so add a fragment with padding after each frame
+        OFCHECK_EQUAL(rleSeq->card(), NUMBER_OF_RLE_FRAMES + 1);
+        Uint32 offset = 0;
+        for (Uint32 i = 0; i < NUMBER_OF_RLE_FRAMES; ++i)
+        {
+            memset(table + 8 * i, 0, 8);
+            for (Uint32 j = 0; j < 4; ++j)
+                table[8 * i + j] = OFstatic_cast(Uint8, offset >> (8 * j));
+            OFCHECK(rleSeq->getItem(fragment, 2 * i + 1).good());
+            // odd length fragments are padded when written
+            offset += ((fragment->getLength() + 1) & ~1) + 8 + 2 + 8;
+            fragment = new DcmPixelItem(DcmTag(DCM_Item, EVR_OB));
+            OFCHECK(fragment->putUint8Array(marker, 2).good());
+            // the fragment is inserted after the given position
+            OFCHECK(rleSeq->insert(fragment, 2 * i + 1).good());
+        }
+        OFCHECK(rleSeq->getItem(offsetTable, 0).good());
+        OFCHECK(offsetTable->putUint8Array(NULL, 0).good());
+        // without offset table, the frames cannot be found since RLE has no markers
+        OFCHECK(rleSeq->getFrameStartFragment(1, NUMBER_OF_RLE_FRAMES, startFragment) == EC_TagNotFound);
+        // ... except for the first frame, which always starts with the first fragment
+        startFragment = 0;
+        OFCHECK(rleSeq->getFrameStartFragment(0, NUMBER_OF_RLE_FRAMES, startFragment).good());
+        OFCHECK_EQUAL(startFragment, 1);
+        // the Extended Offset Table (7FE0,0001) is not part of the data dictionary, so use OB
+        DcmOtherByteOtherWord *extendedOffsetTable = new DcmOtherByteOtherWord(DcmTag(0x7fe0, 0x0001, EVR_OB));
+        OFCHECK(extendedOffsetTable->putUint8Array(table, 8 * NUMBER_OF_RLE_FRAMES).good());
+        OFCHECK(dset.insert(extendedOffsetTable).good());
+        DcmRLEDecoderRegistration::registerCodecs();
+        checkRLEFrame(dset, pixelData, 11);
+        checkRLEFrame(dset, pixelData, 3);
+        checkRLEFrame(dset, pixelData, NUMBER_OF_RLE_FRAMES - 1);
+        DcmRLEDecoderRegistration::cleanup();
+    }
+
+    // the time for creating the index and for random access is only reported in verbose mode
+    OFTEST_LOG_VERBOSE("Frame index for " << NUMBER_OF_FRAMES << " frames: " << timeScan << " s for marker scan, "
+        << timeRandomAccess << " s for accessing all frames in random order");
+
+    delete[] table;
+    delete[] pixelData;
+}
@@ -0,0 +1,163 @@
+/*
+ *
+ *  Copyright (C) 2012, OFFIS e.V.
+ *  All rights reserved.  See COPYRIGHT file for details.
+ *
+ *  This software and supporting documentation were developed by
+ *
+ *    OFFIS e.V.
+ *    R&D Division Health
+ *    Escherweg 2
+ *    D-26121 Oldenburg, Germany
+ *
+ *
+ *  Module:  dcmdata
+ *
+ *  Author:  DCMTK team
+ *
+ *  Purpose: test program for reading from memory-mapped files
+ *
+ */
+
+
+#include "dcmtk/config/osconfig.h"    /* make sure OS specific configuration is included first */
+
+#include "dcmtk/ofstd/oftest.h"
+#include "dcmtk/ofstd/oftempf.h"
+#include "dcmtk/ofstd/oftimer.h"
+#include "dcmtk/dcmdata/dctk.h"
+#include "dcmtk/dcmdata/dcistrmm.h"
+
+
+/* number of 16-bit pixel values in the test dataset */
+#define NUMBER_OF_PIXELS (1024 * 1024)
+/* maximum read length that causes all element values to be loaded immediately */
+#define LOAD_ALL_VALUES (NUMBER_OF_PIXELS * 2)
+
+
+// create a file with a pixel data element of known content
+static OFBool createTestFile(const OFString &filename, const E_TransferSyntax xfer)
+{
+    DcmFileFormat fileformat;
+    DcmDataset *dset = fileformat.getDataset();
+    DcmItem *item = NULL;
+    Uint16 *pixels = NULL;
+    OFCHECK(dset->putAndInsertString(DCM_PatientName, "Doe^John").good());
+    OFCHECK(dset->putAndInsertUint16(DCM_BitsAllocated, 16).good());
+    OFCHECK(dset->findOrCreateSequenceItem(DCM_ReferencedImageSequence, item).good());
+    DcmPixelData *pixelData = new DcmPixelData(DCM_PixelData);
+    OFCHECK(pixelData->createUint16Array(NUMBER_OF_PIXELS, pixels).good());
+    if (pixels != NULL)
+    {
+        for (Uint32 i = 0; i < NUMBER_OF_PIXELS; ++i)
+            pixels[i] = OFstatic_cast(Uint16, i);
+    }
+    OFCHECK(dset->insert(pixelData).good());
+    return fileformat.saveFile(filename.c_str(), xfer).good();
+}
+
+// check the content of a file created by createTestFile()
+static void checkPixelData(DcmDataset &dset)
+{
+    OFString name;
+    const Uint16 *pixels = NULL;
+    unsigned long count = 0;
+    OFCHECK(dset.findAndGetOFString(DCM_PatientName, name).good());
+    OFCHECK_EQUAL(name, "Doe^John");
+    OFCHECK(dset.findAndGetUint16Array(DCM_PixelData, pixels, &count).good());
+    OFCHECK_EQUAL(count, NUMBER_OF_PIXELS);
+    if (pixels != NULL)
+    {
+        Uint32 i = 0;
+        while ((i < NUMBER_OF_PIXELS) && (pixels[i] == OFstatic_cast(Uint16, i)))
+            ++i;
+        OFCHECK_EQUAL(i, NUMBER_OF_PIXELS);
+    }
+}
+
+// load the given file with or without memory mapping
+static OFCondition loadTestFile(DcmFileFormat &fileformat, const OFString &filename, const OFBool useMapping, const Uint32 maxReadLength)
+{
+    const OFBool oldValue = dcmUseMemoryMappedFiles.get();
+    dcmUseMemoryMappedFiles.set(useMapping);
+    OFCondition status = fileformat.loadFile(filename.c_str(), EXS_Unknown, EGL_noChange, maxReadLength);
+    dcmUseMemoryMappedFiles.set(oldValue);
+    return status;
+}
+
+
+OFTEST(dcmdata_memoryMappedFile)
+{
+    OFTempFile tempLE(O_RDWR, "", "tmapfile", ".dcm");
+    OFTempFile tempBE(O_RDWR, "", "tmapfile", ".dcm");
+    OFCHECK(tempLE.getStatus().good() && tempBE.getStatus().good());
+    const OFString filenameLE(tempLE.getFilename());
+    const OFString filenameBE(tempBE.getFilename());
+    OFCHECK(createTestFile(filenameLE, EXS_LittleEndianExplicit));
+    OFCHECK(createTestFile(filenameBE, EXS_BigEndianExplicit));
+
+    // check the stream itself
+    DcmInputMappedFileStream stream(filenameLE.c_str());
+    OFCHECK(stream.good());
+    Uint8 preamble[132];
+    OFCHECK_EQUAL(stream.read(preamble, 132), 132);
+    OFCHECK(memcmp(preamble + 128, "DICM", 4) == 0);
+    DcmMappedFile *mapping = NULL;
+    OFCHECK(stream.mappedData(4, mapping) != NULL);
+    OFCHECK(mapping != NULL);
+    stream.mark();
+    OFCHECK_EQUAL(stream.skip(10), 10);
+    stream.putback();
+    OFCHECK_EQUAL(stream.tell(), 132);
+    DcmInputMappedFileStream missing("non-existing-file.dcm");
+    OFCHECK(!missing.good());
+
+    // load both files (immediately and deferred) and compare their content
+    DcmFileFormat fileformat;
+    OFCHECK(loadTestFile(fileformat, filenameLE, OFTrue, LOAD_ALL_VALUES).good());
+    checkPixelData(*fileformat.getDataset());
+    OFCHECK(loadTestFile(fileformat, filenameLE, OFTrue, 4096).good());
+    checkPixelData(*fileformat.getDataset());
+    OFCHECK(loadTestFile(fileformat, filenameBE, OFTrue, LOAD_ALL_VALUES).good());
+    checkPixelData(*fileformat.getDataset());
+    OFCHECK(loadTestFile(fileformat, filenameBE, OFTrue, 4096).good());
+    checkPixelData(*fileformat.getDataset());
+
+    // modifying a value that references the mapping must not modify the file
+    OFCHECK(loadTestFile(fileformat, filenameLE, OFTrue, LOAD_ALL_VALUES).good());
+    DcmElement *elem = NULL;
+    OFCHECK(fileformat.getDataset()->findAndGetElement(DCM_PixelData, elem).good());
+    if (elem != NULL)
+    {
+        Uint16 *pixels = NULL;
+        OFCHECK(elem->getUint16Array(pixels).good());
+        if (pixels != NULL)
+            pixels[0] = 0xffff;
+        // a copy of the element must have its own value
+        DcmElement *copy = OFstatic_cast(DcmElement *, elem->clone());
+        Uint16 *copiedPixels = NULL;
+        OFCHECK(copy->getUint16Array(copiedPixels).good());
+        OFCHECK(copiedPixels != NULL && copiedPixels != pixels && copiedPixels[0] == 0xffff);
+        delete copy;
+        // the mapped value field cannot be detached (it is not on the heap)
+        OFCHECK(elem->detachValueField(OFTrue /*copy*/) == EC_IllegalCall);
+    }
+    DcmFileFormat reference;
+    OFCHECK(loadTestFile(reference, filenameLE, OFFalse, LOAD_ALL_VALUES).good());
+    checkPixelData(*reference.getDataset());
+
+    // the mapped values must remain valid after the file has been deleted
+    OFCHECK(loadTestFile(fileformat, filenameBE, OFTrue, LOAD_ALL_VALUES).good());
+    OFStandard::deleteFile(filenameBE);
+    checkPixelData(*fileformat.getDataset());
+
+    // compare the load performance (only reported in verbose mode)
+    OFTimer timer;
+    OFCHECK(loadTestFile(fileformat, filenameLE, OFTrue, LOAD_ALL_VALUES).good());
+    const double timeMapped = timer.getDiff();
+    timer.reset();
+    OFCHECK(loadTestFile(reference, filenameLE, OFFalse, LOAD_ALL_VALUES).good());
+    const double timeRead = timer.getDiff();
+    OFTEST_LOG_VERBOSE("Loading file with " << NUMBER_OF_PIXELS * 2 << " bytes of pixel data: "
+        << timeMapped << " s with memory mapping, " << timeRead << " s without");
+}
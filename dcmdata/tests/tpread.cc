@@ -31,6 +31,8 @@
 #endif
 
 #include "dcmtk/ofstd/oftest.h"
+#include "dcmtk/ofstd/oftempf.h"
+#include "dcmtk/ofstd/oftimer.h"
 #include "dcmtk/dcmdata/dctk.h"
 #include "dcmtk/dcmdata/dcuid.h"       /* for dcmtk version name */
 #include "dcmtk/dcmdata/dcostrmz.h"    /* for dcmZlibCompressionLevel */
@@ -420,3 +422,98 @@ OFTEST(dcmdata_partialElementAccess)
 #endif
     delete[] buffer;
 }
+
+// ********************************************
+
+#define NUMBER_OF_FRAMES 64
+#define FRAME_ROWS 255
+#define FRAME_COLUMNS 256
+
+static void createMultiframeImage(DcmDataset *dset)
+{
+  OFCHECK(dset->putAndInsertString(DCM_SOPClassUID, UID_MultiframeGrayscaleWordSecondaryCaptureImageStorage).good());
+  OFCHECK(dset->putAndInsertUint16(DCM_Rows, FRAME_ROWS).good());
+  OFCHECK(dset->putAndInsertUint16(DCM_Columns, FRAME_COLUMNS).good());
+  OFCHECK(dset->putAndInsertUint16(DCM_SamplesPerPixel, 1).good());
+  OFCHECK(dset->putAndInsertUint16(DCM_BitsAllocated, 16).good());
+  OFCHECK(dset->putAndInsertUint16(DCM_BitsStored, 16).good());
+  OFCHECK(dset->putAndInsertUint16(DCM_HighBit, 15).good());
+  OFCHECK(dset->putAndInsertUint16(DCM_PixelRepresentation, 0).good());
+  OFCHECK(dset->putAndInsertString(DCM_PhotometricInterpretation, "MONOCHROME2").good());
+  char buf[16];
+  sprintf(buf, "%i", NUMBER_OF_FRAMES);
+  OFCHECK(dset->putAndInsertString(DCM_NumberOfFrames, buf).good());
+  // each pixel contains its frame number in the high byte
+  const unsigned long count = NUMBER_OF_FRAMES * FRAME_ROWS * FRAME_COLUMNS;
+  Uint16 *pixels = new Uint16[count];
+  for (unsigned long i = 0; i < count; ++i)
+    pixels[i] = OFstatic_cast(Uint16, ((i / (FRAME_ROWS * FRAME_COLUMNS)) << 8) | (i & 0xff));
+  OFCHECK(dset->putAndInsertUint16Array(DCM_PixelData, pixels, count).good());
+  delete[] pixels;
+}
+
+static OFBool checkFrame(const Uint16 *frame, const Uint32 frameNo)
+{
+  for (unsigned long i = 0; i < FRAME_ROWS * FRAME_COLUMNS; ++i)
+  {
+    if (frame[i] != (((frameNo << 8) | (i & 0xff)) & 0xffff)) return OFFalse;
+  }
+  return OFTrue;
+}
+
+static void randomFrameRead(const char *filename, double &elapsed)
+{
+  DcmFileFormat dfile;
+  OFCHECK(dfile.loadFile(filename).good());
+  DcmDataset *dset = dfile.getDataset();
+  DcmElement *delem = NULL;
+  OFCHECK(dset->findAndGetElement(DCM_PixelData, delem).good());
+  if (delem == NULL) return;
+  DcmPixelData *pixelData = OFstatic_cast(DcmPixelData *, delem);
+
+  Uint32 frameSize = 0;
+  OFCHECK(pixelData->getUncompressedFrameSize(dset, frameSize).good());
+  OFCHECK_EQUAL(frameSize, FRAME_ROWS * FRAME_COLUMNS * 2);
+  Uint16 *frame = new Uint16[FRAME_ROWS * FRAME_COLUMNS];
+  DcmFileCache cache;
+  OFString colorModel;
+  OFTimer timer;
+  for (Uint32 i = 0; i < NUMBER_OF_FRAMES; ++i)
+  {
+    // access the frames in (pseudo) random order, also in backward direction
+    const Uint32 frameNo = (i * 37) % NUMBER_OF_FRAMES;
+    Uint32 startFragment = 0;
+    OFCHECK(pixelData->getUncompressedFrame(dset, frameNo, startFragment, frame, frameSize, colorModel, &cache).good());
+    OFCHECK(checkFrame(frame, frameNo));
+  }
+  elapsed = timer.getDiff();
+  OFCHECK_EQUAL(colorModel, "MONOCHROME2");
+  // the pixel data has never been loaded completely into memory
+  OFCHECK(!pixelData->valueLoaded());
+  Uint32 startFragment = 0;
+  OFCHECK(pixelData->getUncompressedFrame(dset, NUMBER_OF_FRAMES, startFragment, frame, frameSize, colorModel, &cache) == EC_IllegalCall);
+
+  // the same without file cache
+  startFragment = 0;
+  OFCHECK(pixelData->getUncompressedFrame(dset, NUMBER_OF_FRAMES / 2, startFragment, frame, frameSize, colorModel, NULL).good());
+  OFCHECK(checkFrame(frame, NUMBER_OF_FRAMES / 2));
+  OFCHECK(!pixelData->valueLoaded());
+  delete[] frame;
+}
+
+OFTEST(dcmdata_partialFrameAccess)
+{
+  DcmFileFormat dfile;
+  createMultiframeImage(dfile.getDataset());
+  OFTempFile tempFile(O_RDWR, "", "tpread", ".dcm");
+  OFCHECK(tempFile.getStatus().good());
+  double elapsed = 0;
+
+  // frames are read in the byte order of the file
+  OFCHECK(dfile.saveFile(tempFile.getFilename(), EXS_BigEndianExplicit).good());
+  randomFrameRead(tempFile.getFilename(), elapsed);
+  OFCHECK(dfile.saveFile(tempFile.getFilename(), EXS_LittleEndianExplicit).good());
+  randomFrameRead(tempFile.getFilename(), elapsed);
+  OFTEST_LOG_VERBOSE("Reading " << NUMBER_OF_FRAMES << " frames of " << FRAME_ROWS * FRAME_COLUMNS * 2
+    << " bytes in random order: " << elapsed << " s");
+}
@@ -0,0 +1,191 @@
+/*
+ *
+ *  Copyright (C) 2012, OFFIS e.V.
+ *  All rights reserved.  See COPYRIGHT file for details.
+ *
+ *  This software and supporting documentation were developed by
+ *
+ *    OFFIS e.V.
+ *    R&D Division Health
+ *    Escherweg 2
+ *    D-26121 Oldenburg, Germany
+ *
+ *
+ *  Module:  dcmdata
+ *
+ *  Author:  DCMTK team
+ *
+ *  Purpose: test program for the cached length of items and sequences
+ *
+ */
+
+
+#include "dcmtk/config/osconfig.h"    /* make sure OS specific configuration is included first */
+
+#include "dcmtk/ofstd/oftest.h"
+#include "dcmtk/ofstd/oftempf.h"
+#include "dcmtk/ofstd/oftimer.h"
+#include "dcmtk/dcmdata/dctk.h"
+
+
+/* number of ROI contours in the test dataset */
+#define NUMBER_OF_CONTOURS 50
+
+/* number of contour items per ROI contour */
+#define NUMBER_OF_ITEMS 50
+
+/* nesting depth of the additional sequence in the test dataset */
+#define NESTING_DEPTH 100
+
+
+// create an RT structure set like dataset with an additional deeply nested sequence
+static void createTestDataset(DcmDataset &dset)
+{
+    char buf[32];
+    OFCHECK(dset.putAndInsertString(DCM_SOPClassUID, UID_RTStructureSetStorage).good());
+    OFCHECK(dset.putAndInsertString(DCM_PatientName, "Doe^John").good());
+    for (int i = 0; i < NUMBER_OF_CONTOURS; ++i)
+    {
+        DcmItem *roi = NULL;
+        OFCHECK(dset.findOrCreateSequenceItem(DCM_ROIContourSequence, roi, -2 /* append */).good());
+        if (roi == NULL) return;
+        sprintf(buf, "%i", i);
+        roi->putAndInsertString(DCM_ReferencedROINumber, buf);
+        for (int j = 0; j < NUMBER_OF_ITEMS; ++j)
+        {
+            DcmItem *contour = NULL;
+            OFCHECK(roi->findOrCreateSequenceItem(DCM_ContourSequence, contour, -2 /* append */).good());
+            if (contour == NULL) return;
+            DcmItem *image = NULL;
+            OFCHECK(contour->findOrCreateSequenceItem(DCM_ContourImageSequence, image, -2 /* append */).good());
+            if (image == NULL) return;
+            image->putAndInsertString(DCM_ReferencedSOPClassUID, UID_CTImageStorage);
+            image->putAndInsertString(DCM_ReferencedSOPInstanceUID, "1.2.276.0.7230010.3.1.4.815");
+            contour->putAndInsertString(DCM_ContourGeometricType, "CLOSED_PLANAR");
+            contour->putAndInsertString(DCM_NumberOfContourPoints, "3");
+            contour->putAndInsertString(DCM_ContourData, "0.5\\1.5\\2.5\\3.5\\4.5\\5.5\\6.5\\7.5\\8.5");
+        }
+    }
+    DcmItem *item = &dset;
+    for (int k = 0; (item != NULL) && (k < NESTING_DEPTH); ++k)
+    {
+        DcmItem *nested = NULL;
+        OFCHECK(item->findOrCreateSequenceItem(DCM_ContentSequence, nested, -2 /* append */).good());
+        if (nested != NULL)
+        {
+            nested->putAndInsertString(DCM_RelationshipType, "CONTAINS");
+            nested->putAndInsertString(DCM_ValueType, "CONTAINER");
+        }
+        item = nested;
+    }
+}
+
+// compare the length of the given dataset with the length of a copy (which has no cached length)
+static void checkLength(DcmDataset &dset, const E_TransferSyntax xfer, const E_EncodingType enctype)
+{
+    DcmDataset copy(dset);
+    OFCHECK_EQUAL(dset.getLength(xfer, enctype), copy.getLength(xfer, enctype));
+}
+
+// compare the length for some combinations of transfer syntax and encoding type
+static void checkLengths(DcmDataset &dset)
+{
+    checkLength(dset, EXS_LittleEndianExplicit, EET_ExplicitLength);
+    checkLength(dset, EXS_LittleEndianImplicit, EET_ExplicitLength);
+    checkLength(dset, EXS_LittleEndianExplicit, EET_UndefinedLength);
+    checkLength(dset, EXS_LittleEndianExplicit, EET_ExplicitLength);
+}
+
+// write the given dataset and return the elapsed time
+static double measureWrite(DcmFileFormat &fileformat, const OFString &filename, const E_EncodingType enctype)
+{
+    OFTimer timer;
+    OFCHECK(fileformat.saveFile(filename.c_str(), EXS_LittleEndianExplicit, enctype).good());
+    return timer.getDiff();
+}
+
+
+OFTEST(dcmdata_sequenceLengthCache)
+{
+    DcmFileFormat fileformat;
+    DcmDataset *dset = fileformat.getDataset();
+    createTestDataset(*dset);
+    checkLengths(*dset);
+
+    // modify an element value deep inside the dataset
+    DcmItem *item = NULL;
+    OFCHECK(dset->findAndGetSequenceItem(DCM_ROIContourSequence, item, 10).good());
+    DcmItem *contour = NULL;
+    OFCHECK(item != NULL && item->findAndGetSequenceItem(DCM_ContourSequence, contour, 20).good());
+    DcmItem *image = NULL;
+    OFCHECK(contour != NULL && contour->findAndGetSequenceItem(DCM_ContourImageSequence, image, 0).good());
+    if (image == NULL) return;
+    const Uint32 oldLength = dset->getLength(EXS_LittleEndianExplicit, EET_ExplicitLength);
+    OFCHECK(image->putAndInsertString(DCM_ReferencedSOPInstanceUID, "1.2.276.0.7230010.3.1.4.815.4711").good());
+    OFCHECK_EQUAL(dset->getLength(EXS_LittleEndianExplicit, EET_ExplicitLength), oldLength + 4);
+    checkLengths(*dset);
+
+    // the same via the element itself
+    DcmElement *elem = NULL;
+    OFCHECK(contour->findAndGetElement(DCM_ContourData, elem).good());
+    if (elem == NULL) return;
+    OFCHECK(elem->putString("0.5\\1.5\\2.5").good());
+    checkLengths(*dset);
+    OFCHECK(elem->putString("").good());
+    checkLengths(*dset);
+
+    // insert and remove elements
+    OFCHECK(image->putAndInsertString(DCM_ReferencedFrameNumber, "1").good());
+    checkLengths(*dset);
+    delete image->remove(DCM_ReferencedSOPClassUID);
+    checkLengths(*dset);
+    OFCHECK(image->clear().good());
+    checkLengths(*dset);
+
+    // insert and remove items
+    DcmSequenceOfItems *seq = NULL;
+    OFCHECK(item->findAndGetSequence(DCM_ContourSequence, seq).good());
+    if (seq == NULL) return;
+    OFCHECK(seq->insert(new DcmItem(*contour), 5).good());
+    checkLengths(*dset);
+    delete seq->remove(OFstatic_cast(unsigned long, 0));
+    checkLengths(*dset);
+    delete seq->remove(contour);
+    checkLengths(*dset);
+
+    // modify the deepest item
+    item = dset;
+    while (item != NULL)
+    {
+        DcmItem *nested = NULL;
+        if (item->findAndGetSequenceItem(DCM_ContentSequence, nested, 0).bad())
+            break;
+        item = nested;
+    }
+    OFCHECK(item != NULL && item->putAndInsertString(DCM_ContinuityOfContent, "SEPARATE").good());
+    checkLengths(*dset);
+
+    // group length and padding elements are taken into account
+    OFCHECK(dset->computeGroupLengthAndPadding(EGL_withGL, EPD_withPadding, EXS_LittleEndianExplicit,
+        EET_ExplicitLength, 256, 64).good());
+    checkLengths(*dset);
+
+    // the written file can be read again
+    OFTempFile tempFile(O_RDWR, "", "tseqlen", ".dcm");
+    OFCHECK(tempFile.getStatus().good());
+    const OFString filename(tempFile.getFilename());
+    OFCHECK(fileformat.saveFile(filename.c_str(), EXS_LittleEndianExplicit, EET_ExplicitLength).good());
+    DcmFileFormat readFile;
+    OFCHECK(readFile.loadFile(filename.c_str()).good());
+    checkLength(*readFile.getDataset(), EXS_LittleEndianExplicit, EET_ExplicitLength);
+    OFCHECK_EQUAL(readFile.getDataset()->getLength(EXS_LittleEndianExplicit, EET_ExplicitLength),
+        dset->getLength(EXS_LittleEndianExplicit, EET_ExplicitLength));
+
+    // compare the time for writing with explicit and undefined length (only reported in verbose mode)
+    DcmFileFormat benchmark;
+    createTestDataset(*benchmark.getDataset());
+    const double timeExplicit = measureWrite(benchmark, filename, EET_ExplicitLength);
+    const double timeUndefined = measureWrite(benchmark, filename, EET_UndefinedLength);
+    OFTEST_LOG_VERBOSE("Writing dataset with " << NUMBER_OF_CONTOURS * NUMBER_OF_ITEMS << " contour items and nesting depth "
+        << NESTING_DEPTH << ": " << timeExplicit << " s with explicit length, " << timeUndefined << " s with undefined length");
+}
@@ -23,8 +23,15 @@
 #include "dcmtk/config/osconfig.h"    /* make sure OS specific configuration is included first */
 
 #include "dcmtk/ofstd/oftest.h"
+#include "dcmtk/ofstd/oftimer.h"
 #include "dcmtk/dcmdata/dcspchrs.h"
 #include "dcmtk/dcmdata/dctypes.h"
+#include "dcmtk/dcmdata/dcdatset.h"
+#include "dcmtk/dcmdata/dcdeftag.h"
+
+
+/* number of datasets converted for measuring the performance */
+#define NUMBER_OF_DATASETS 1000
 
 
 OFTEST(dcmdata_specificCharacterSet_1)
@@ -186,3 +193,85 @@ OFTEST(dcmdata_specificCharacterSet_4)
         DCMDATA_WARN("Cannot test DcmSpecificCharacterSet since the underlying character set conversion library is not available");
     }
 }
+
+
+OFTEST(dcmdata_specificCharacterSet_5)
+{
+    DcmSpecificCharacterSet converter;
+    // without a selected character set, a conversion is always needed
+    OFCHECK(converter.isConversionNeeded("Doe^John", 8));
+    if (converter.isConversionLibraryAvailable())
+    {
+        OFString resultStr;
+        // strings with ASCII characters only are not changed by the conversion from Latin-1 to UTF-8
+        OFCHECK(converter.selectCharacterSet("ISO_IR 100").good());
+        OFCHECK(!converter.isConversionNeeded("", 0));
+        OFCHECK(!converter.isConversionNeeded("Doe^John", 8));
+        OFCHECK(!converter.isConversionNeeded("Some rather long text with 8-byte words", 39));
+        OFCHECK(converter.isConversionNeeded("J\366rg", 4));
+        OFCHECK(converter.isConversionNeeded("Some rather long text with a J\366rg", 35));
+        OFCHECK(converter.isConversionNeeded("Some rather long text with an \033 (ESC)", 39));
+        OFCHECK(converter.isConversionNeeded("\033(B", 3));
+        // but they are still copied to the result variable
+        resultStr = "old value";
+        OFCHECK(converter.convertString("Some Text", resultStr).good());
+        OFCHECK_EQUAL(resultStr, "Some Text");
+        OFCHECK(converter.convertString("J\366rg", resultStr).good());
+        OFCHECK_EQUAL(resultStr, "J\303\266rg");
+        // the same applies to code extensions (unless escape sequences are used)
+        OFCHECK(converter.selectCharacterSet("ISO 2022 IR 6\\ISO 2022 IR 100", "ISO_IR 100").good());
+        OFCHECK(!converter.isConversionNeeded("Doe^John", 8));
+        OFCHECK(converter.isConversionNeeded("\033-AJ\366rg", 7));
+        // Japanese (JIS X 0201) is not compatible with ASCII, e.g. the backslash is mapped to the yen sign
+        OFCHECK(converter.selectCharacterSet("ISO_IR 13").good());
+        OFCHECK(converter.isConversionNeeded("Doe^John", 8));
+        OFCHECK(converter.selectCharacterSet("ISO_IR 100", "ISO_IR 13").good());
+        OFCHECK(converter.isConversionNeeded("Doe^John", 8));
+        // after clearing the converter, the conversion fails again
+        converter.clear();
+        OFCHECK(converter.isConversionNeeded("Doe^John", 8));
+        OFCHECK(converter.convertString("Some Text", resultStr).bad());
+
+        // the conversion descriptors are reused by other converters
+        DcmSpecificCharacterSet converter1;
+        DcmSpecificCharacterSet converter2;
+        OFCHECK(converter1.selectCharacterSet("ISO_IR 100").good());
+        OFCHECK(converter2.selectCharacterSet("ISO_IR 100").good());
+        OFCHECK(converter1.convertString("J\366rg", resultStr).good());
+        OFCHECK_EQUAL(resultStr, "J\303\266rg");
+        OFCHECK(converter2.convertString("J\351r\364me", resultStr).good());
+        OFCHECK_EQUAL(resultStr, "J\303\251r\303\264me");
+        converter1.clear();
+        OFCHECK(converter2.selectCharacterSet("ISO 2022 IR 100\\ISO 2022 IR 126").good());
+        OFCHECK(converter2.convertString("J\366rg", resultStr).good());
+        OFCHECK_EQUAL(resultStr, "J\303\266rg");
+        DcmSpecificCharacterSet::clearDescriptorCache();
+        OFCHECK(converter2.convertString("J\351r\364me", resultStr).good());
+        OFCHECK_EQUAL(resultStr, "J\303\251r\303\264me");
+
+        // measure the performance of converting many small datasets (one converter per dataset)
+        DcmDataset dataset;
+        OFCHECK(dataset.putAndInsertString(DCM_SpecificCharacterSet, "ISO_IR 100").good());
+        OFCHECK(dataset.putAndInsertString(DCM_PatientName, "Doe^John").good());
+        OFCHECK(dataset.putAndInsertString(DCM_PatientID, "12345678").good());
+        OFCHECK(dataset.putAndInsertString(DCM_StudyDescription, "CT Thorax with contrast media").good());
+        OFCHECK(dataset.putAndInsertString(DCM_InstitutionName, "Klinikum J\366rgensstra\337e").good());
+        OFTimer timer;
+        for (int i = 0; i < NUMBER_OF_DATASETS; ++i)
+        {
+            DcmDataset copy(dataset);
+            OFCHECK(copy.convertToUTF8().good());
+        }
+        OFTEST_LOG_VERBOSE("Converting " << NUMBER_OF_DATASETS << " datasets from Latin-1 to UTF-8: " << timer.getDiff() << " s");
+        OFCHECK(dataset.convertToUTF8().good());
+        OFCHECK(dataset.findAndGetOFString(DCM_InstitutionName, resultStr).good());
+        OFCHECK_EQUAL(resultStr, "Klinikum J\303\266rgensstra\303\237e");
+        OFCHECK(dataset.findAndGetOFString(DCM_PatientName, resultStr).good());
+        OFCHECK_EQUAL(resultStr, "Doe^John");
+        OFCHECK(dataset.findAndGetOFString(DCM_SpecificCharacterSet, resultStr).good());
+        OFCHECK_EQUAL(resultStr, "ISO_IR 192");
+    } else {
+        // in case there is no libiconv, report a warning but do not fail
+        DCMDATA_WARN("Cannot test DcmSpecificCharacterSet since the underlying character set conversion library is not available");
+    }
+}
@@ -0,0 +1,309 @@
+/*
+ *
+ *  Copyright (C) 2012, OFFIS e.V.
+ *  All rights reserved.  See COPYRIGHT file for details.
+ *
+ *  This software and supporting documentation were developed by
+ *
+ *    OFFIS e.V.
+ *    R&D Division Health
+ *    Escherweg 2
+ *    D-26121 Oldenburg, Germany
+ *
+ *
+ *  Module:  dcmdata
+ *
+ *  Author:  DCMTK team
+ *
+ *  Purpose: test program for class DcmStreamWriter
+ *
+ */
+
+
+#include "dcmtk/config/osconfig.h"    /* make sure OS specific configuration is included first */
+
+#include "dcmtk/ofstd/oftest.h"
+#include "dcmtk/ofstd/oftempf.h"
+#include "dcmtk/ofstd/oftimer.h"
+#include "dcmtk/ofstd/offile.h"
+#include "dcmtk/dcmdata/dctk.h"
+#include "dcmtk/dcmdata/dcstrmwr.h"
+#include "dcmtk/dcmdata/dcostrmb.h"
+
+
+/* number of ROI contours in the test dataset */
+#define NUMBER_OF_CONTOURS 200
+
+/* number of contour items per ROI contour */
+#define NUMBER_OF_ITEMS 20
+
+/* SOP Instance UID of the test dataset */
+#define TEST_INSTANCE_UID "1.2.276.0.7230010.3.1.4.4711"
+
+/* size of the buffer used for testing the output to a buffer stream */
+#define TEST_BUFFER_SIZE 256
+
+
+// buffer stream with a small buffer, whose content is collected in a string
+struct TestBufferSink
+{
+    TestBufferSink() : stream(buffer, TEST_BUFFER_SIZE), data() { }
+
+    // empty the buffer of the stream
+    void drain()
+    {
+        void *bytes = NULL;
+        offile_off_t length = 0;
+        stream.flushBuffer(bytes, length);
+        data.append(OFstatic_cast(const char *, bytes), OFstatic_cast(size_t, length));
+    }
+
+    char buffer[TEST_BUFFER_SIZE];
+    DcmOutputBufferStream stream;
+    OFString data;
+};
+
+// write the pending output of the stream writer (if any), emptying the buffer whenever it is full
+static OFCondition complete(DcmStreamWriter &writer, OFCondition status, TestBufferSink *sink)
+{
+    while ((sink != NULL) && (status == EC_StreamNotifyClient))
+    {
+        sink->drain();
+        status = writer.writePending();
+    }
+    return status;
+}
+
+// write an RT structure set like dataset with an opened stream writer
+static OFCondition writeTestDataset(DcmStreamWriter &writer, TestBufferSink *sink)
+{
+    OFCondition status = complete(writer, writer.writeString(DCM_SOPClassUID, UID_RTStructureSetStorage), sink);
+    if (status.good()) status = complete(writer, writer.writeString(DCM_SOPInstanceUID, TEST_INSTANCE_UID), sink);
+    if (status.good()) status = complete(writer, writer.writeString(DCM_PatientName, "Doe^John"), sink);
+    // this value does not fit into the buffer of the test sink
+    const OFString comments(1000, 'x');
+    if (status.good()) status = complete(writer, writer.writeString(DCM_PatientComments, comments.c_str()), sink);
+    if (status.good()) status = complete(writer, writer.beginSequence(DCM_ROIContourSequence), sink);
+    char buf[32];
+    for (int i = 0; status.good() && (i < NUMBER_OF_CONTOURS); ++i)
+    {
+        status = complete(writer, writer.beginItem(), sink);
+        if (status.good()) status = complete(writer, writer.writeString(DCM_ROIDisplayColor, "255\\0\\0"), sink);
+        if (status.good()) status = complete(writer, writer.beginSequence(DCM_ContourSequence), sink);
+        for (int j = 0; status.good() && (j < NUMBER_OF_ITEMS); ++j)
+        {
+            // items can also be written as a whole
+            DcmItem item;
+            sprintf(buf, "%i", j);
+            item.putAndInsertString(DCM_ContourNumber, buf);
+            item.putAndInsertString(DCM_ContourGeometricType, "CLOSED_PLANAR");
+            item.putAndInsertString(DCM_NumberOfContourPoints, "3");
+            item.putAndInsertString(DCM_ContourData, "0.5\\1.5\\2.5\\3.5\\4.5\\5.5\\6.5\\7.5\\8.5");
+            status = complete(writer, writer.writeItem(item), sink);
+        }
+        if (status.good()) status = complete(writer, writer.endSequence(), sink);
+        sprintf(buf, "%i", i);
+        if (status.good()) status = complete(writer, writer.writeString(DCM_ReferencedROINumber, buf), sink);
+        if (status.good()) status = complete(writer, writer.endItem(), sink);
+    }
+    if (status.good()) status = complete(writer, writer.endSequence(), sink);
+    if (status.good()) status = complete(writer, writer.writeString(DCM_DataSetTrailingPadding, ""), sink);
+    if (status.good())
+    {
+        status = writer.close();
+        // the remaining output might need more than one buffer
+        while ((sink != NULL) && (status == EC_StreamNotifyClient))
+        {
+            sink->drain();
+            status = writer.close();
+        }
+    }
+    if (sink != NULL)
+        sink->drain();
+    return status;
+}
+
+// write the test dataset to a file with the stream writer
+static OFCondition streamTestFile(const OFString &filename, const E_TransferSyntax xfer)
+{
+    DcmStreamWriter writer;
+    OFCondition status = writer.open(filename.c_str(), xfer, UID_RTStructureSetStorage, TEST_INSTANCE_UID);
+    if (status.good())
+        status = writeTestDataset(writer, NULL);
+    return status;
+}
+
+// write the test dataset to a buffer stream with the stream writer and store the result in a file
+static OFCondition streamTestBuffer(const OFString &filename, const E_TransferSyntax xfer)
+{
+    TestBufferSink sink;
+    DcmStreamWriter writer;
+    OFCondition status = complete(writer, writer.open(sink.stream, xfer, UID_RTStructureSetStorage, TEST_INSTANCE_UID), &sink);
+    if (status.good())
+        status = writeTestDataset(writer, &sink);
+    OFFile file;
+    OFCHECK(file.fopen(filename.c_str(), "wb"));
+    OFCHECK_EQUAL(file.fwrite(sink.data.data(), 1, sink.data.length()), sink.data.length());
+    file.fclose();
+    return status;
+}
+
+// create the same dataset in memory
+static void createTestDataset(DcmDataset &dset)
+{
+    char buf[32];
+    OFCHECK(dset.putAndInsertString(DCM_SOPClassUID, UID_RTStructureSetStorage).good());
+    OFCHECK(dset.putAndInsertString(DCM_SOPInstanceUID, TEST_INSTANCE_UID).good());
+    OFCHECK(dset.putAndInsertString(DCM_PatientName, "Doe^John").good());
+    OFCHECK(dset.putAndInsertString(DCM_PatientComments, OFString(1000, 'x').c_str()).good());
+    for (int i = 0; i < NUMBER_OF_CONTOURS; ++i)
+    {
+        DcmItem *roi = NULL;
+        OFCHECK(dset.findOrCreateSequenceItem(DCM_ROIContourSequence, roi, -2 /* append */).good());
+        if (roi == NULL) return;
+        roi->putAndInsertString(DCM_ROIDisplayColor, "255\\0\\0");
+        for (int j = 0; j < NUMBER_OF_ITEMS; ++j)
+        {
+            DcmItem *item = NULL;
+            OFCHECK(roi->findOrCreateSequenceItem(DCM_ContourSequence, item, -2 /* append */).good());
+            if (item == NULL) return;
+            sprintf(buf, "%i", j);
+            item->putAndInsertString(DCM_ContourNumber, buf);
+            item->putAndInsertString(DCM_ContourGeometricType, "CLOSED_PLANAR");
+            item->putAndInsertString(DCM_NumberOfContourPoints, "3");
+            item->putAndInsertString(DCM_ContourData, "0.5\\1.5\\2.5\\3.5\\4.5\\5.5\\6.5\\7.5\\8.5");
+        }
+        sprintf(buf, "%i", i);
+        roi->putAndInsertString(DCM_ReferencedROINumber, buf);
+    }
+}
+
+// encode the given dataset with explicit length, which is the same for both variants
+static OFString encodeDataset(DcmDataset &dset)
+{
+    const Uint32 length = dset.getLength(EXS_LittleEndianExplicit, EET_ExplicitLength);
+    char *buffer = new char[length];
+    DcmOutputBufferStream outStream(buffer, length);
+    dset.transferInit();
+    OFCHECK(dset.write(outStream, EXS_LittleEndianExplicit, EET_ExplicitLength, NULL).good());
+    dset.transferEnd();
+    void *data = NULL;
+    offile_off_t written = 0;
+    outStream.flushBuffer(data, written);
+    OFCHECK_EQUAL(written, OFstatic_cast(offile_off_t, length));
+    const OFString result(buffer, OFstatic_cast(size_t, written));
+    delete[] buffer;
+    return result;
+}
+
+// check the content of a file written by streamTestFile() or streamTestBuffer()
+static void checkTestFile(const OFString &filename, const E_TransferSyntax xfer)
+{
+    DcmFileFormat fileformat;
+    OFCHECK(fileformat.loadFile(filename.c_str()).good());
+    OFString value;
+    OFCHECK(fileformat.getMetaInfo()->findAndGetOFString(DCM_MediaStorageSOPInstanceUID, value).good());
+    OFCHECK_EQUAL(value, TEST_INSTANCE_UID);
+    OFCHECK_EQUAL(fileformat.getDataset()->getOriginalXfer(), xfer);
+    DcmDataset expected;
+    createTestDataset(expected);
+    OFCHECK(expected.putAndInsertString(DCM_DataSetTrailingPadding, "").good());
+    OFCHECK(encodeDataset(*fileformat.getDataset()) == encodeDataset(expected));
+}
+
+
+OFTEST(dcmdata_streamWriter)
+{
+    OFTempFile tempFile(O_RDWR, "", "tstrmwr", ".dcm");
+    OFCHECK(tempFile.getStatus().good());
+    const OFString filename(tempFile.getFilename());
+
+    // write and read the dataset in all supported transfer syntaxes
+    OFCHECK(streamTestFile(filename, EXS_LittleEndianExplicit).good());
+    checkTestFile(filename, EXS_LittleEndianExplicit);
+    OFCHECK(streamTestFile(filename, EXS_LittleEndianImplicit).good());
+    checkTestFile(filename, EXS_LittleEndianImplicit);
+    OFCHECK(streamTestFile(filename, EXS_BigEndianExplicit).good());
+    checkTestFile(filename, EXS_BigEndianExplicit);
+#ifdef WITH_ZLIB
+    OFCHECK(streamTestFile(filename, EXS_DeflatedLittleEndianExplicit).good());
+    checkTestFile(filename, EXS_DeflatedLittleEndianExplicit);
+#endif
+
+    // write to a buffer stream whose buffer is smaller than the output
+    OFCHECK(streamTestBuffer(filename, EXS_LittleEndianExplicit).good());
+    checkTestFile(filename, EXS_LittleEndianExplicit);
+    OFCHECK(streamTestBuffer(filename, EXS_BigEndianExplicit).good());
+    checkTestFile(filename, EXS_BigEndianExplicit);
+#ifdef WITH_ZLIB
+    OFCHECK(streamTestBuffer(filename, EXS_DeflatedLittleEndianExplicit).good());
+    checkTestFile(filename, EXS_DeflatedLittleEndianExplicit);
+#endif
+
+    // check the detection of invalid calls
+    DcmStreamWriter writer;
+    OFCHECK(writer.writeString(DCM_PatientName, "Doe^John") == EC_IllegalCall);
+    OFCHECK(writer.open(filename.c_str(), EXS_BigEndianImplicit, NULL, NULL) == EC_IllegalCall);
+    OFCHECK(writer.open(filename.c_str(), EXS_LittleEndianImplicit, NULL, NULL, EWM_dataset).good());
+    OFCHECK(writer.isOpen());
+    OFCHECK(writer.writeString(DCM_PatientName, "Doe^John").good());
+    OFCHECK(writer.writeString(DCM_PatientID, "12345").good());
+    OFCHECK(writer.writeString(DCM_PatientID, "12345") == EC_TagOrderViolated);
+    OFCHECK(writer.writeString(DCM_StudyDate, "20121102") == EC_TagOrderViolated);
+    OFCHECK(writer.beginItem() == EC_IllegalCall);
+    OFCHECK(writer.endSequence() == EC_IllegalCall);
+    OFCHECK(writer.beginSequence(DCM_ReferencedStudySequence) == EC_TagOrderViolated);
+    OFCHECK(writer.beginSequence(DCM_OtherPatientIDsSequence).good());
+    OFCHECK_EQUAL(writer.getNestingLevel(), 1);
+    OFCHECK(writer.writeString(DCM_PatientID, "12345") == EC_IllegalCall);
+    OFCHECK(writer.beginItem().good());
+    // tags are checked separately on each level
+    OFCHECK(writer.writeString(DCM_PatientID, "67890").good());
+    OFCHECK(writer.endSequence() == EC_IllegalCall);
+    OFCHECK(writer.close() == EC_IllegalCall);
+    OFCHECK(!writer.isOpen());
+
+    // write the dataset only
+    OFCHECK(writer.open(filename.c_str(), EXS_LittleEndianImplicit, NULL, NULL, EWM_dataset).good());
+    OFCHECK(writer.writeString(DCM_PatientName, "Doe^John").good());
+    OFCHECK(writer.writeString(DCM_PatientID, "12345").good());
+    OFCHECK(writer.close().good());
+    DcmFileFormat fileformat;
+    OFCHECK(fileformat.loadFile(filename.c_str(), EXS_LittleEndianImplicit, EGL_noChange, DCM_MaxReadLength, ERM_dataset).good());
+    OFString value;
+    OFCHECK(fileformat.getDataset()->findAndGetOFString(DCM_PatientID, value).good());
+    OFCHECK_EQUAL(value, "12345");
+
+    // check the handling of pending output
+    TestBufferSink sink;
+    OFCHECK(writer.open(sink.stream, EXS_LittleEndianExplicit, NULL, NULL, EWM_dataset).good());
+    OFCHECK(!writer.hasPendingOutput());
+    OFCHECK(writer.writeString(DCM_PatientComments, OFString(1000, 'x').c_str()) == EC_StreamNotifyClient);
+    OFCHECK(writer.hasPendingOutput());
+    OFCHECK(writer.writeString(DCM_StudyID, "STUDY1") == EC_IllegalCall);
+    // the buffer has not been emptied yet
+    OFCHECK(writer.writePending() == EC_StreamNotifyClient);
+    OFCHECK(complete(writer, EC_StreamNotifyClient, &sink).good());
+    OFCHECK(!writer.hasPendingOutput());
+    OFCHECK(writer.writeString(DCM_StudyID, "STUDY1").good());
+    OFCHECK(writer.close() == EC_StreamNotifyClient);
+    OFCHECK(writer.isOpen());
+    sink.drain();
+    OFCHECK(writer.close().good());
+    OFCHECK(!writer.isOpen());
+    // tag (4), VR (2), length (2) and value of each element
+    OFCHECK_EQUAL(sink.data.length(), 1008 + 14);
+
+    // compare the performance with creating and saving the dataset (only reported in verbose mode)
+    OFTimer timer;
+    OFCHECK(streamTestFile(filename, EXS_LittleEndianExplicit).good());
+    const double timeStream = timer.getDiff();
+    timer.reset();
+    DcmFileFormat *memoryFile = new DcmFileFormat();
+    createTestDataset(*memoryFile->getDataset());
+    OFCHECK(memoryFile->saveFile(filename.c_str(), EXS_LittleEndianExplicit, EET_ExplicitLength).good());
+    delete memoryFile;
+    const double timeSave = timer.getDiff();
+    OFTEST_LOG_VERBOSE("Writing dataset with " << NUMBER_OF_CONTOURS * NUMBER_OF_ITEMS << " contour items: "
+        << timeStream << " s with stream writer, " << timeSave << " s with saveFile()");
+}
@@ -23,7 +23,8 @@
 #include "dcmtk/config/osconfig.h"    /* make sure OS specific configuration is included first */
 
 #include "dcmtk/ofstd/oftest.h"
-#include "dcmtk/dcmdata/dcelem.h"
+#include "dcmtk/ofstd/oftimer.h"
+#include "dcmtk/dcmdata/dctk.h"
 
 
 OFTEST(dcmdata_determineVM)
@@ -65,3 +66,98 @@ OFTEST(dcmdata_getValueFromString)
     OFCHECK_EQUAL(DcmElement::getValueFromString("\\aa\\b\0bb\\", 4, 9, str), 9);
     OFCHECK_EQUAL(str, OFString("b\0bb", 4));
 }
+
+// compare the string view of each value with the copy returned by getOFString()
+static void checkStringView(DcmElement *elem, const char *value, const unsigned long vm, const Uint32 len = 0)
+{
+    OFCHECK(((len > 0) ? elem->putString(value, len) : elem->putString(value)).good());
+    OFString expected;
+    const char *view = NULL;
+    Uint32 length = 0;
+    for (unsigned long pos = 0; pos < vm; ++pos)
+    {
+        OFCHECK(elem->getOFString(expected, pos, OFTrue).good());
+        OFCHECK(elem->getStringView(view, length, pos, OFTrue).good());
+        OFCHECK_EQUAL(OFString(view, length), expected);
+        OFCHECK(elem->getOFString(expected, pos, OFFalse).good());
+        OFCHECK(elem->getStringView(view, length, pos, OFFalse).good());
+        OFCHECK_EQUAL(OFString(view, length), expected);
+    }
+    delete elem;
+}
+
+OFTEST(dcmdata_getStringView)
+{
+    /* leading and trailing spaces */
+    checkStringView(new DcmApplicationEntity(DCM_RetrieveAETitle), " AE1 \\\\AE3  ", 3);
+    checkStringView(new DcmCodeString(DCM_ImageType), "ORIGINAL\\ PRIMARY \\AXIAL", 3);
+    checkStringView(new DcmDecimalString(DCM_PixelSpacing), " 0.5 \\0.25", 2);
+    checkStringView(new DcmIntegerString(DCM_ReferencedFrameNumber), "1\\ 2 \\3 ", 3);
+    checkStringView(new DcmLongString(DCM_StudyDescription), "  Head  ", 1);
+    checkStringView(new DcmShortString(DCM_AccessionNumber), "\\ A12", 2);
+    /* trailing spaces only */
+    checkStringView(new DcmDate(DCM_StudyDate), "20121024\\ 20121025 ", 2);
+    checkStringView(new DcmDateTime(DCM_AcquisitionDateTime), "20121024101010 ", 1);
+    checkStringView(new DcmTime(DCM_StudyTime), " 101010\\101011", 2);
+    checkStringView(new DcmPersonName(DCM_PatientName), " Doe^John \\Doe^Jane", 2);
+    checkStringView(new DcmAgeString(DCM_PatientAge), "042Y", 1);
+    /* padding with NULL byte */
+    checkStringView(new DcmUniqueIdentifier(DCM_SOPClassUID), UID_CTImageStorage "\\1.2.3", 2);
+    checkStringView(new DcmUniqueIdentifier(DCM_SOPClassUID), "1.2.3\0\\1.2.4\0", 2, 13);
+    /* backslash is a normal character */
+    checkStringView(new DcmLongText(DCM_AdditionalPatientHistory), " some\\text  ", 1);
+    checkStringView(new DcmShortText(DCM_InstitutionAddress), "Escherweg 2\\ ", 1);
+    checkStringView(new DcmUnlimitedText(DCM_TextValue), "\\text\\ ", 1);
+
+    /* empty values */
+    DcmLongString empty(DCM_StudyDescription);
+    const char *view = "invalid";
+    Uint32 length = 1;
+    OFCHECK(empty.getStringView(view, length).good());
+    OFCHECK_EQUAL(length, 0);
+    OFCHECK(empty.getStringView(view, length, 1) == EC_IllegalParameter);
+    OFCHECK(empty.putString("   ").good());
+    OFCHECK(empty.getStringView(view, length).good());
+    OFCHECK_EQUAL(length, 0);
+
+    /* non-string VRs are not supported */
+    DcmUnsignedShort us(DCM_Rows);
+    OFCHECK(us.putUint16(512).good());
+    OFCHECK(us.getStringView(view, length) == EC_IllegalCall);
+
+    /* access via the item */
+    DcmItem item;
+    OFCHECK(item.putAndInsertString(DCM_ImageType, "ORIGINAL\\PRIMARY \\AXIAL").good());
+    OFCHECK(item.findAndGetStringView(DCM_ImageType, view, length, 1).good());
+    OFCHECK_EQUAL(OFString(view, length), "PRIMARY");
+    OFCHECK(item.findAndGetStringView(DCM_PatientName, view, length).bad());
+    OFCHECK(view == NULL);
+    OFCHECK_EQUAL(length, 0);
+
+    /* compare the time for accessing all values of a multi-valued element (only reported in verbose mode) */
+    const unsigned long count = 1000;
+    OFString value;
+    for (unsigned long i = 0; i < count; ++i)
+        value += (i > 0) ? "\\ORIGINAL" : "ORIGINAL";
+    DcmCodeString cs(DCM_ImageType);
+    OFCHECK(cs.putOFStringArray(value).good());
+    unsigned long matches = 0;
+    OFTimer timer;
+    for (unsigned long j = 0; j < count; ++j)
+    {
+        if (cs.getOFString(value, j).good() && (value == "ORIGINAL"))
+            ++matches;
+    }
+    const double timeCopy = timer.getDiff();
+    timer.reset();
+    for (unsigned long k = 0; k < count; ++k)
+    {
+        if (cs.getStringView(view, length, k).good() && (length == 8) && (strncmp(view, "ORIGINAL", 8) == 0))
+            ++matches;
+    }
+    const double timeView = timer.getDiff();
+    OFCHECK_EQUAL(matches, 2 * count);
+    OFCHECK(cs.getStringView(view, length, count) == EC_IllegalParameter);
+    OFTEST_LOG_VERBOSE("Accessing " << count << " values: " << timeCopy << " s with getOFString(), "
+        << timeView << " s with getStringView()");
+}
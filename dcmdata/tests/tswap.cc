@@ -0,0 +1,128 @@
+/*
+ *
+ *  Copyright (C) 2012, OFFIS e.V.
+ *  All rights reserved.  See COPYRIGHT file for details.
+ *
+ *  This software and supporting documentation were developed by
+ *
+ *    OFFIS e.V.
+ *    R&D Division Health
+ *    Escherweg 2
+ *    D-26121 Oldenburg, Germany
+ *
+ *
+ *  Module:  dcmdata
+ *
+ *  Author:  DCMTK team
+ *
+ *  Purpose: test program for the byte swapping functions
+ *
+ */
+
+
+#include "dcmtk/config/osconfig.h"    /* make sure OS specific configuration is included first */
+
+#include "dcmtk/ofstd/oftest.h"
+#include "dcmtk/ofstd/oftimer.h"
+#include "dcmtk/dcmdata/dcswap.h"
+
+#define INCLUDE_CSTRING
+#include "dcmtk/ofstd/ofstdinc.h"
+
+
+/* size of the largest buffer used for the performance comparison (32 MB) */
+#define MAX_BENCHMARK_SIZE (32 * 1024 * 1024)
+
+
+// straightforward byte swapping, used as reference
+static void referenceSwap(Uint8 *data, const Uint32 byteLength, const size_t valWidth)
+{
+    const Uint32 count = OFstatic_cast(Uint32, byteLength / valWidth);
+    for (Uint32 i = 0; i < count; ++i)
+    {
+        Uint8 *value = data + i * valWidth;
+        for (size_t j = 0; j < valWidth / 2; ++j)
+        {
+            const Uint8 tmp = value[j];
+            value[j] = value[valWidth - 1 - j];
+            value[valWidth - 1 - j] = tmp;
+        }
+    }
+}
+
+// fill the given buffer with a byte pattern
+static void fillBuffer(Uint8 *data, const size_t length)
+{
+    for (size_t i = 0; i < length; ++i)
+        data[i] = OFstatic_cast(Uint8, (i * 7 + 3) & 0xff);
+}
+
+// best time of a few runs of swapBytes() or the reference implementation
+static double measureSwap(Uint8 *data, const Uint32 byteLength, const size_t valWidth, const OFBool reference)
+{
+    double best = 0;
+    for (int i = 0; i < 5; ++i)
+    {
+        OFTimer timer;
+        if (reference)
+            referenceSwap(data, byteLength, valWidth);
+        else
+            swapBytes(data, byteLength, valWidth);
+        const double t = timer.getDiff();
+        if ((i == 0) || (t < best)) best = t;
+    }
+    return best;
+}
+
+
+OFTEST(dcmdata_swapBytes)
+{
+    const size_t widths[] = { 2, 4, 8 };
+    Uint8 *buffer = new Uint8[MAX_BENCHMARK_SIZE + 16];
+    Uint8 *expected = new Uint8[1024 + 16];
+
+    // compare with the reference for various lengths and (unaligned) start addresses
+    for (size_t w = 0; w < sizeof(widths) / sizeof(widths[0]); ++w)
+    {
+        const size_t valWidth = widths[w];
+        for (size_t offset = 0; offset < 8; ++offset)
+        {
+            for (Uint32 length = 0; length <= 1024; length += (length < 160) ? 1 : 97)
+            {
+                Uint8 *data = buffer + offset;
+                fillBuffer(data, length + 8);
+                memcpy(expected, data, length + 8);
+                referenceSwap(expected, length, valWidth);
+                swapBytes(data, length, valWidth);
+                // the bytes behind the buffer are not modified either
+                OFCHECK(memcmp(data, expected, length + 8) == 0);
+            }
+        }
+    }
+
+    // swapIfNecessary() only swaps if the byte order differs
+    fillBuffer(buffer, 256);
+    memcpy(expected, buffer, 256);
+    OFCHECK(swapIfNecessary(EBO_LittleEndian, EBO_LittleEndian, buffer, 256, 2).good());
+    OFCHECK(memcmp(buffer, expected, 256) == 0);
+    OFCHECK(swapIfNecessary(EBO_BigEndian, EBO_LittleEndian, buffer, 256, 4).good());
+    referenceSwap(expected, 256, 4);
+    OFCHECK(memcmp(buffer, expected, 256) == 0);
+    OFCHECK(swapIfNecessary(EBO_unknown, EBO_LittleEndian, buffer, 256, 2).bad());
+
+    // compare the performance for typical OW sizes (only reported in verbose mode)
+    fillBuffer(buffer, MAX_BENCHMARK_SIZE);
+    for (Uint32 size = 512 * 1024; size <= MAX_BENCHMARK_SIZE; size *= 8)
+    {
+        for (size_t w = 0; w < sizeof(widths) / sizeof(widths[0]); ++w)
+        {
+            const double timeSwap = measureSwap(buffer, size, widths[w], OFFalse);
+            const double timeReference = measureSwap(buffer, size, widths[w], OFTrue);
+            OFTEST_LOG_VERBOSE("Swapping " << size / 1024 << " KB of " << widths[w] << "-byte values: "
+                << timeSwap << " s with swapBytes(), " << timeReference << " s with plain loop");
+        }
+    }
+
+    delete[] buffer;
+    delete[] expected;
+}
@@ -0,0 +1,139 @@
+/*
+ *
+ *  Copyright (C) 2012, OFFIS e.V.
+ *  All rights reserved.  See COPYRIGHT file for details.
+ *
+ *  This software and supporting documentation were developed by
+ *
+ *    OFFIS e.V.
+ *    R&D Division Health
+ *    Escherweg 2
+ *    D-26121 Oldenburg, Germany
+ *
+ *
+ *  Module:  dcmdata
+ *
+ *  Author:  DCMTK team
+ *
+ *  Purpose: test program for the tag index of class DcmItem
+ *
+ */
+
+
+#include "dcmtk/config/osconfig.h"    /* make sure OS specific configuration is included first */
+
+#include "dcmtk/ofstd/oftest.h"
+#include "dcmtk/ofstd/oftimer.h"
+#include "dcmtk/dcmdata/dctk.h"
+
+
+/* number of elements in the test datasets, i.e. roughly an enhanced multi-frame header */
+#define NUMBER_OF_ELEMENTS 2000
+/* number of lookup rounds for the performance comparison */
+#define NUMBER_OF_ROUNDS 10
+
+
+// create the n-th (distinct) tag used for the test datasets
+static DcmTag makeTag(const unsigned long n)
+{
+    return DcmTag(OFstatic_cast(Uint16, 0x0010 + 2 * (n / 1000)), OFstatic_cast(Uint16, 0x1000 + (n % 1000)), EVR_LO);
+}
+
+// fill the given dataset in pseudo-random order (i.e. not in ascending tag order)
+static void fillDataset(DcmDataset &dset)
+{
+    for (unsigned long i = 0; i < NUMBER_OF_ELEMENTS; ++i)
+    {
+        // 997 is prime and does not divide NUMBER_OF_ELEMENTS
+        const unsigned long n = (i * 997) % NUMBER_OF_ELEMENTS;
+        OFCHECK(dset.putAndInsertString(makeTag(n), "VALUE").good());
+    }
+}
+
+// create a dataset with or without tag index
+static DcmDataset *createDataset(const OFBool useIndex)
+{
+    const OFBool oldValue = dcmEnableTagIndex.get();
+    dcmEnableTagIndex.set(useIndex);
+    DcmDataset *dset = new DcmDataset();
+    dcmEnableTagIndex.set(oldValue);
+    return dset;
+}
+
+// look up all elements of the given dataset a number of times
+static double measureLookup(DcmDataset &dset)
+{
+    OFTimer timer;
+    DcmElement *elem = NULL;
+    for (unsigned long r = 0; r < NUMBER_OF_ROUNDS; ++r)
+    {
+        for (unsigned long n = 0; n < NUMBER_OF_ELEMENTS; ++n)
+            dset.findAndGetElement(makeTag(n), elem);
+    }
+    return timer.getDiff();
+}
+
+
+OFTEST(dcmdata_tagIndex)
+{
+    DcmDataset *indexed = createDataset(OFTrue);
+    DcmDataset *walked = createDataset(OFFalse);
+    fillDataset(*indexed);
+    fillDataset(*walked);
+    OFCHECK_EQUAL(indexed->card(), NUMBER_OF_ELEMENTS);
+    OFCHECK_EQUAL(walked->card(), NUMBER_OF_ELEMENTS);
+
+    // both datasets should contain the elements in ascending tag order
+    for (unsigned long i = 0; i < NUMBER_OF_ELEMENTS; ++i)
+    {
+        OFCHECK_EQUAL(indexed->getElement(i)->getTag(), makeTag(i));
+        OFCHECK_EQUAL(walked->getElement(i)->getTag(), makeTag(i));
+    }
+
+    // check lookup of existing and non-existing elements
+    DcmElement *elem = NULL;
+    OFCHECK(indexed->findAndGetElement(makeTag(0), elem).good());
+    OFCHECK(elem != NULL && elem->getTag() == makeTag(0));
+    OFCHECK(indexed->findAndGetElement(makeTag(NUMBER_OF_ELEMENTS - 1), elem).good());
+    OFCHECK(elem != NULL && elem->getTag() == makeTag(NUMBER_OF_ELEMENTS - 1));
+    OFCHECK(indexed->findAndGetElement(DCM_PatientName, elem) == EC_TagNotFound);
+    OFCHECK(elem == NULL);
+    OFCHECK(walked->findAndGetElement(DCM_PatientName, elem) == EC_TagNotFound);
+    OFCHECK(!indexed->tagExists(makeTag(NUMBER_OF_ELEMENTS)));
+
+    // replace an existing element and insert a duplicate
+    OFCHECK(indexed->putAndInsertString(makeTag(42), "OTHER").good());
+    OFCHECK(indexed->insert(new DcmLongString(makeTag(42)), OFFalse /*replaceOld*/) == EC_DoubledTag);
+    OFString value;
+    OFCHECK(indexed->findAndGetOFString(makeTag(42), value).good());
+    OFCHECK_EQUAL(value, "OTHER");
+    OFCHECK_EQUAL(indexed->card(), NUMBER_OF_ELEMENTS);
+
+    // remove elements by tag and by pointer
+    delete indexed->remove(makeTag(100));
+    OFCHECK(!indexed->tagExists(makeTag(100)));
+    OFCHECK(indexed->findAndGetElement(makeTag(101), elem).good());
+    OFCHECK(indexed->remove(elem) == elem);
+    delete elem;
+    OFCHECK(!indexed->tagExists(makeTag(101)));
+    OFCHECK(indexed->remove(makeTag(101)) == NULL);
+    OFCHECK(indexed->findAndDeleteElement(makeTag(102)).good());
+    OFCHECK(!indexed->tagExists(makeTag(102)));
+    OFCHECK(indexed->tagExists(makeTag(103)));
+    OFCHECK_EQUAL(indexed->card(), NUMBER_OF_ELEMENTS - 3);
+
+    // copies should also be indexed and contain the same elements
+    DcmDataset copy(*indexed);
+    OFCHECK_EQUAL(copy.card(), indexed->card());
+    OFCHECK(copy.tagExists(makeTag(103)));
+    OFCHECK(!copy.tagExists(makeTag(102)));
+
+    // compare the lookup performance (only reported in verbose mode)
+    const double timeIndexed = measureLookup(*indexed);
+    const double timeWalked = measureLookup(*walked);
+    OFTEST_LOG_VERBOSE("Lookup of " << NUMBER_OF_ROUNDS << " x " << NUMBER_OF_ELEMENTS
+        << " elements: " << timeIndexed << " s with tag index, " << timeWalked << " s without");
+
+    delete indexed;
+    delete walked;
+}
@@ -0,0 +1,212 @@
+/*
+ *
+ *  Copyright (C) 2012, OFFIS e.V.
+ *  All rights reserved.  See COPYRIGHT file for details.
+ *
+ *  This software and supporting documentation were developed by
+ *
+ *    OFFIS e.V.
+ *    R&D Division Health
+ *    Escherweg 2
+ *    D-26121 Oldenburg, Germany
+ *
+ *
+ *  Module:  dcmdata
+ *
+ *  Author:  DCMTK team
+ *
+ *  Purpose: test program for class DcmTagScanner
+ *
+ */
+
+
+#include "dcmtk/config/osconfig.h"    /* make sure OS specific configuration is included first */
+
+#include "dcmtk/ofstd/oftest.h"
+#include "dcmtk/ofstd/oftempf.h"
+#include "dcmtk/ofstd/oftimer.h"
+#include "dcmtk/dcmdata/dctk.h"
+#include "dcmtk/dcmdata/dctagscn.h"
+
+
+/* number of scan rounds for the performance comparison */
+#define NUMBER_OF_ROUNDS 20
+
+
+// handler that records all elements reported by the scanner
+class TestScanHandler : public DcmTagScanHandler
+{
+public:
+    TestScanHandler(const DcmTagKey &stopAt = DcmTagKey(0xffff, 0xffff))
+      : tags(), levels(), patientName(), studyDate(), rows(0), stopTag(stopAt)
+    {
+    }
+
+    virtual OFBool handleElement(const DcmTagKey &tag,
+                                 const DcmEVR vr,
+                                 const Uint32 length,
+                                 const Uint8 *value,
+                                 const E_ByteOrder byteOrder,
+                                 const Uint32 level)
+    {
+        if (tag == stopTag)
+            return OFFalse;
+        tags.push_back(tag);
+        levels.push_back(level);
+        if (value != NULL)
+        {
+            if (tag == DCM_PatientName)
+                patientName = OFreinterpret_cast(const char *, value);
+            else if (tag == DCM_StudyDate)
+                studyDate = OFreinterpret_cast(const char *, value);
+            else if ((tag == DCM_Rows) && (vr == EVR_US) && (length == 2))
+            {
+                Uint16 val = *OFreinterpret_cast(const Uint16 *, value);
+                swapIfNecessary(gLocalByteOrder, byteOrder, &val, 2, 2);
+                rows = val;
+            }
+        }
+        return OFTrue;
+    }
+
+    OFBool contains(const DcmTagKey &tag) const
+    {
+        for (size_t i = 0; i < tags.size(); ++i)
+        {
+            if (tags[i] == tag)
+                return OFTrue;
+        }
+        return OFFalse;
+    }
+
+    OFVector<DcmTagKey> tags;
+    OFVector<Uint32> levels;
+    OFString patientName;
+    OFString studyDate;
+    Uint16 rows;
+    DcmTagKey stopTag;
+};
+
+
+// create a file with a nested sequence and pixel data
+static OFBool createTestFile(const OFString &filename, const E_TransferSyntax xfer, const E_EncodingType encType)
+{
+    DcmFileFormat fileformat;
+    DcmDataset *dset = fileformat.getDataset();
+    DcmItem *item = NULL;
+    OFCHECK(dset->putAndInsertString(DCM_SOPClassUID, UID_SecondaryCaptureImageStorage).good());
+    OFCHECK(dset->putAndInsertString(DCM_SOPInstanceUID, "1.2.3.4.5").good());
+    OFCHECK(dset->putAndInsertString(DCM_StudyDate, "20121102").good());
+    OFCHECK(dset->putAndInsertString(DCM_PatientName, "Doe^John").good());
+    OFCHECK(dset->findOrCreateSequenceItem(DCM_ReferencedImageSequence, item, -2).good());
+    if (item != NULL)
+    {
+        OFCHECK(item->putAndInsertString(DCM_ReferencedSOPClassUID, UID_SecondaryCaptureImageStorage).good());
+        OFCHECK(item->putAndInsertString(DCM_ReferencedSOPInstanceUID, "1.2.3.4.6").good());
+    }
+    OFCHECK(dset->findOrCreateSequenceItem(DCM_ReferencedImageSequence, item, -2).good());
+    OFCHECK(dset->putAndInsertString(DCM_StudyInstanceUID, "1.2.3.4").good());
+    OFCHECK(dset->putAndInsertUint16(DCM_Rows, 256).good());
+    OFCHECK(dset->putAndInsertUint16(DCM_Columns, 256).good());
+    Uint16 *pixels = NULL;
+    DcmPixelData *pixelData = new DcmPixelData(DCM_PixelData);
+    OFCHECK(pixelData->createUint16Array(256 * 256, pixels).good());
+    if (pixels != NULL)
+        memset(pixels, 0, 256 * 256 * 2);
+    OFCHECK(dset->insert(pixelData).good());
+    OFCHECK(dset->putAndInsertString(DCM_DataSetTrailingPadding, "").good());
+    return fileformat.saveFile(filename.c_str(), xfer, encType).good();
+}
+
+// check the elements reported by a default scanner (stop before pixel data)
+static void checkDefaultScan(const OFString &filename, const E_TransferSyntax xfer, const OFBool metaHeader = OFTrue)
+{
+    DcmTagScanner scanner;
+    TestScanHandler handler;
+    OFCHECK(scanner.scanFile(filename.c_str(), handler).good());
+    OFCHECK(scanner.stopped());
+    OFCHECK_EQUAL(scanner.getDatasetXfer(), xfer);
+    OFCHECK_EQUAL(handler.contains(DCM_TransferSyntaxUID), metaHeader);
+    OFCHECK(handler.contains(DCM_ReferencedSOPInstanceUID));
+    OFCHECK(handler.contains(DCM_Columns));
+    OFCHECK(!handler.contains(DCM_PixelData));
+    OFCHECK(!handler.contains(DCM_DataSetTrailingPadding));
+    OFCHECK_EQUAL(handler.patientName, "Doe^John");
+    OFCHECK_EQUAL(handler.studyDate, "20121102");
+    OFCHECK_EQUAL(handler.rows, 256);
+    // the elements of the sequence items are reported with level 1
+    for (size_t i = 0; i < handler.tags.size(); ++i)
+    {
+        const Uint32 level = (handler.tags[i] == DCM_ReferencedSOPClassUID) ||
+                             (handler.tags[i] == DCM_ReferencedSOPInstanceUID) ? 1 : 0;
+        OFCHECK_EQUAL(handler.levels[i], level);
+    }
+}
+
+
+OFTEST(dcmdata_tagScanner)
+{
+    OFTempFile tempFile(O_RDWR, "", "ttagscn", ".dcm");
+    OFCHECK(tempFile.getStatus().good());
+    const OFString filename(tempFile.getFilename());
+
+    // check all uncompressed transfer syntaxes and sequence encodings
+    OFCHECK(createTestFile(filename, EXS_LittleEndianExplicit, EET_ExplicitLength));
+    checkDefaultScan(filename, EXS_LittleEndianExplicit);
+    OFCHECK(createTestFile(filename, EXS_LittleEndianImplicit, EET_UndefinedLength));
+    checkDefaultScan(filename, EXS_LittleEndianImplicit);
+    OFCHECK(createTestFile(filename, EXS_BigEndianExplicit, EET_UndefinedLength));
+    checkDefaultScan(filename, EXS_BigEndianExplicit);
+#ifdef WITH_ZLIB
+    OFCHECK(createTestFile(filename, EXS_DeflatedLittleEndianExplicit, EET_ExplicitLength));
+    checkDefaultScan(filename, EXS_DeflatedLittleEndianExplicit);
+#endif
+
+    // scan up to the end of the dataset, skipping sequences and large values
+    OFCHECK(createTestFile(filename, EXS_LittleEndianExplicit, EET_UndefinedLength));
+    DcmTagScanner scanner;
+    TestScanHandler fullHandler;
+    scanner.setStopTag(DcmTagKey(0xffff, 0xffff));
+    scanner.setSkipSequences(OFTrue);
+    scanner.setMaxValueLength(4);
+    OFCHECK(scanner.scanFile(filename.c_str(), fullHandler).good());
+    OFCHECK(!scanner.stopped());
+    OFCHECK(fullHandler.contains(DCM_ReferencedImageSequence));
+    OFCHECK(!fullHandler.contains(DCM_ReferencedSOPInstanceUID));
+    OFCHECK(fullHandler.contains(DCM_PixelData));
+    OFCHECK(fullHandler.contains(DCM_DataSetTrailingPadding));
+    OFCHECK(fullHandler.patientName.empty());
+    OFCHECK_EQUAL(fullHandler.rows, 256);
+
+    // the handler can stop the scanner
+    TestScanHandler stopHandler(DCM_PatientName);
+    OFCHECK(scanner.scanFile(filename.c_str(), stopHandler).good());
+    OFCHECK(scanner.stopped());
+    OFCHECK(stopHandler.contains(DCM_StudyDate));
+    OFCHECK(!stopHandler.contains(DCM_StudyInstanceUID));
+
+    // check a dataset without meta header and a missing file
+    DcmFileFormat fileformat;
+    OFCHECK(fileformat.loadFile(filename.c_str()).good());
+    OFCHECK(fileformat.getDataset()->saveFile(filename.c_str(), EXS_LittleEndianImplicit).good());
+    checkDefaultScan(filename, EXS_LittleEndianImplicit, OFFalse /*metaHeader*/);
+    TestScanHandler missingHandler;
+    OFCHECK(scanner.scanFile("non-existing-file.dcm", missingHandler).bad());
+
+    // compare the performance with loading the dataset (only reported in verbose mode)
+    OFCHECK(createTestFile(filename, EXS_LittleEndianExplicit, EET_ExplicitLength));
+    OFTimer timer;
+    for (int i = 0; i < NUMBER_OF_ROUNDS; ++i)
+    {
+        DcmTagScanner defaultScanner;
+        TestScanHandler handler;
+        defaultScanner.scanFile(filename.c_str(), handler);
+    }
+    const double timeScan = timer.getDiff();
+    timer.reset();
+    for (int i = 0; i < NUMBER_OF_ROUNDS; ++i)
+        fileformat.loadFile(filename.c_str());
+    const double timeLoad = timer.getDiff();
+    OFTEST_LOG_VERBOSE("Reading header of file " << NUMBER_OF_ROUNDS << " times: "
+        << timeScan << " s with tag scanner, " << timeLoad << " s with loadFile()");
+}
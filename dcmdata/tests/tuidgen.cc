@@ -0,0 +1,197 @@
+/*
+ *
+ *  Copyright (C) 2012, OFFIS e.V.
+ *  All rights reserved.  See COPYRIGHT file for details.
+ *
+ *  This software and supporting documentation were developed by
+ *
+ *    OFFIS e.V.
+ *    R&D Division Health
+ *    Escherweg 2
+ *    D-26121 Oldenburg, Germany
+ *
+ *
+ *  Module:  dcmdata
+ *
+ *  Author:  DCMTK team
+ *
+ *  Purpose: test program for the creation of Unique Identifiers
+ *
+ */
+
+
+#include "dcmtk/config/osconfig.h"    /* make sure OS specific configuration is included first */
+
+#include "dcmtk/ofstd/oftest.h"
+#include "dcmtk/ofstd/oftimer.h"
+#include "dcmtk/ofstd/ofvector.h"
+#include "dcmtk/dcmdata/dcuid.h"
+#include "dcmtk/dcmdata/dcvrui.h"
+
+#define INCLUDE_CSTDLIB
+#define INCLUDE_CSTRING
+#include "dcmtk/ofstd/ofstdinc.h"
+
+#ifdef WITH_THREADS
+#include "dcmtk/ofstd/ofthread.h"
+#endif
+
+
+/* number of threads used for the tests */
+#define NUMBER_OF_THREADS 8
+
+/* number of UIDs created by each thread */
+#define NUMBER_OF_UIDS 20000
+
+/* prefix of the UIDs created by the tests */
+#define UID_PREFIX "1.2.276.0.7230010.3.9.9"
+
+
+// create UIDs with the given generator (or the global function if NULL)
+static void createUIDs(DcmUIDGenerator *generator, OFVector<OFString> &uids, const size_t count)
+{
+    char uid[65];
+    for (size_t i = 0; i < count; ++i)
+    {
+        if (generator != NULL)
+            generator->generate(uid);
+        else
+            dcmGenerateUniqueIdentifier(uid, UID_PREFIX);
+        uids.push_back(uid);
+    }
+}
+
+#ifdef WITH_THREADS
+
+// thread that creates UIDs with its own generator (or the global function)
+class UIDThread : public OFThread
+{
+public:
+    UIDThread(const OFBool useGenerator, const unsigned int blockSize)
+      : OFThread(), uids(), generator_(UID_PREFIX, blockSize), useGenerator_(useGenerator)
+    {
+        uids.reserve(NUMBER_OF_UIDS);
+    }
+
+    virtual void run()
+    {
+        createUIDs(useGenerator_ ? &generator_ : NULL, uids, NUMBER_OF_UIDS);
+    }
+
+    OFVector<OFString> uids;
+
+private:
+    DcmUIDGenerator generator_;
+    OFBool useGenerator_;
+};
+
+#endif
+
+// check that all UIDs are valid and add them to the list of all UIDs
+static void checkUIDs(const OFVector<OFString> &uids, OFVector<OFString> &allUIDs)
+{
+    const OFString prefix = UID_PREFIX ".";
+    for (size_t i = 0; i < uids.size(); ++i)
+    {
+        const OFString &uid = uids[i];
+        OFCHECK(uid.compare(0, prefix.length(), prefix) == 0);
+        OFCHECK(DcmUniqueIdentifier::checkStringValue(uid, "1").good());
+        allUIDs.push_back(uid);
+    }
+}
+
+// compare two UIDs, used for sorting
+static int compareUIDs(const void *uid1, const void *uid2)
+{
+    return strcmp(*OFstatic_cast(const char * const *, uid1), *OFstatic_cast(const char * const *, uid2));
+}
+
+// check that the given UIDs are unique
+static void checkUnique(const OFVector<OFString> &allUIDs)
+{
+    const size_t count = allUIDs.size();
+    const char **uids = new const char *[count];
+    for (size_t i = 0; i < count; ++i)
+        uids[i] = allUIDs[i].c_str();
+    qsort(uids, count, sizeof(const char *), compareUIDs);
+    size_t duplicates = 0;
+    for (size_t j = 1; j < count; ++j)
+    {
+        if (strcmp(uids[j - 1], uids[j]) == 0)
+            ++duplicates;
+    }
+    OFCHECK_EQUAL(duplicates, 0);
+    delete[] uids;
+}
+
+
+OFTEST(dcmdata_uidGenerator)
+{
+    // OFVector only grows by a few elements at a time, so reserve enough space
+    OFVector<OFString> allUIDs;
+    allUIDs.reserve(800 + (NUMBER_OF_THREADS + 2) * NUMBER_OF_UIDS);
+    char uid[65];
+    // the structure of the UIDs is the same as with dcmGenerateUniqueIdentifier()
+    DcmUIDGenerator defaultGenerator;
+    OFCHECK(OFString(defaultGenerator.generate(uid)).compare(0, strlen(SITE_INSTANCE_UID_ROOT), SITE_INSTANCE_UID_ROOT) == 0);
+    OFString expected = dcmGenerateUniqueIdentifier(uid, UID_PREFIX);
+    DcmUIDGenerator generator(UID_PREFIX "." /* trailing period is removed */, 1);
+    OFString value = generator.generate(uid);
+    // compare without time and counter
+    value.erase(value.rfind('.'));
+    expected.erase(expected.rfind('.'));
+    OFCHECK_EQUAL(value.substr(0, value.rfind('.')), expected.substr(0, expected.rfind('.')));
+    // a long prefix results in truncated UIDs
+    const char *longPrefix = "1.2.276.0.7230010.3.9.9.1234567890.1234567890.1234567890";
+    OFCHECK_EQUAL(strlen(DcmUIDGenerator(longPrefix).generate(uid)), 64);
+
+    // single thread, mixed with the global function and a small block size
+    OFVector<OFString> uids;
+    uids.reserve(800);
+    DcmUIDGenerator smallBlocks(UID_PREFIX, 3);
+    for (int i = 0; i < 100; ++i)
+    {
+        createUIDs(&smallBlocks, uids, 5);
+        createUIDs(&generator, uids, 1);
+        createUIDs(NULL, uids, 2);
+    }
+    checkUIDs(uids, allUIDs);
+
+    // compare the performance of the global function and the generator
+    uids.clear();
+    uids.reserve(NUMBER_OF_UIDS);
+    OFTimer timer;
+    createUIDs(NULL, uids, NUMBER_OF_UIDS);
+    const double timeFunction = timer.getDiff();
+    checkUIDs(uids, allUIDs);
+    uids.clear();
+    uids.reserve(NUMBER_OF_UIDS);
+    DcmUIDGenerator blockGenerator(UID_PREFIX);
+    timer.reset();
+    createUIDs(&blockGenerator, uids, NUMBER_OF_UIDS);
+    const double timeGenerator = timer.getDiff();
+    checkUIDs(uids, allUIDs);
+    OFTEST_LOG_VERBOSE("Creating " << NUMBER_OF_UIDS << " UIDs: " << timeFunction << " s with dcmGenerateUniqueIdentifier(), "
+        << timeGenerator << " s with DcmUIDGenerator");
+
+#ifdef WITH_THREADS
+    // many threads with different block sizes, some using the global function
+    OFVector<UIDThread *> threads;
+    for (int i = 0; i < NUMBER_OF_THREADS; ++i)
+        threads.push_back(new UIDThread(i != 0, (i % 2) ? 1 : 4096));
+    timer.reset();
+    for (int j = 0; j < NUMBER_OF_THREADS; ++j)
+        OFCHECK(threads[j]->start() == 0);
+    for (int k = 0; k < NUMBER_OF_THREADS; ++k)
+        threads[k]->join();
+    const double timeThreads = timer.getDiff();
+    for (int l = 0; l < NUMBER_OF_THREADS; ++l)
+    {
+        OFCHECK_EQUAL(threads[l]->uids.size(), NUMBER_OF_UIDS);
+        checkUIDs(threads[l]->uids, allUIDs);
+        delete threads[l];
+    }
+    OFTEST_LOG_VERBOSE("Creating " << NUMBER_OF_UIDS << " UIDs in each of " << NUMBER_OF_THREADS << " threads: " << timeThreads << " s");
+#endif
+    checkUnique(allUIDs);
+}
@@ -0,0 +1,146 @@
+/*
+ *
+ *  Copyright (C) 2012, OFFIS e.V.
+ *  All rights reserved.  See COPYRIGHT file for details.
+ *
+ *  This software and supporting documentation were developed by
+ *
+ *    OFFIS e.V.
+ *    R&D Division Health
+ *    Escherweg 2
+ *    D-26121 Oldenburg, Germany
+ *
+ *
+ *  Module:  dcmdata
+ *
+ *  Author:  DCMTK team
+ *
+ *  Purpose: test program for the lookup of well-known UIDs
+ *
+ */
+
+
+#include "dcmtk/config/osconfig.h"    /* make sure OS specific configuration is included first */
+
+#include "dcmtk/ofstd/oftest.h"
+#include "dcmtk/ofstd/oftimer.h"
+#include "dcmtk/ofstd/ofvector.h"
+#include "dcmtk/dcmdata/dcuid.h"
+
+
+/* number of simulated association negotiations used for measuring the performance */
+#define NUMBER_OF_ASSOCIATIONS 200
+
+
+// check whether the given UID is a storage SOP class by a linear search (as before)
+static OFBool isStorageSOPClassLinear(const char *uid)
+{
+    for (int i = 0; i < numberOfAllDcmStorageSOPClassUIDs; i++)
+    {
+        if ((dcmAllStorageSOPClassUIDs[i] != NULL) && (strcmp(uid, dcmAllStorageSOPClassUIDs[i]) == 0))
+            return OFTrue;
+    }
+    return OFFalse;
+}
+
+// get the abstract syntaxes proposed by a typical storage and query/retrieve SCU
+static void getAbstractSyntaxes(OFVector<OFString> &syntaxes)
+{
+    for (int i = 0; i < numberOfDcmLongSCUStorageSOPClassUIDs; i++)
+        syntaxes.push_back(dcmLongSCUStorageSOPClassUIDs[i]);
+    syntaxes.push_back(UID_FINDPatientRootQueryRetrieveInformationModel);
+    syntaxes.push_back(UID_MOVEPatientRootQueryRetrieveInformationModel);
+    syntaxes.push_back(UID_FINDStudyRootQueryRetrieveInformationModel);
+    syntaxes.push_back(UID_MOVEStudyRootQueryRetrieveInformationModel);
+    syntaxes.push_back(UID_GETStudyRootQueryRetrieveInformationModel);
+    syntaxes.push_back(UID_FINDModalityWorklistInformationModel);
+    syntaxes.push_back(UID_VerificationSOPClass);
+    // private SOP classes are not known
+    syntaxes.push_back("1.2.276.0.7230010.3.1.0.1");
+}
+
+
+OFTEST(dcmdata_uidRegistry)
+{
+    // names of well-known UIDs
+    OFCHECK_EQUAL(OFString(dcmFindNameOfUID(UID_VerificationSOPClass, "")), "VerificationSOPClass");
+    OFCHECK_EQUAL(OFString(dcmFindNameOfUID(UID_CTImageStorage, "")), "CTImageStorage");
+    OFCHECK_EQUAL(OFString(dcmFindUIDFromName("CTImageStorage")), UID_CTImageStorage);
+    OFCHECK(dcmFindNameOfUID("1.2.3.4") == NULL);
+    OFCHECK_EQUAL(OFString(dcmFindNameOfUID("1.2.3.4", "unknown")), "unknown");
+    OFCHECK(dcmFindNameOfUID(NULL) == NULL);
+    OFCHECK(dcmFindUIDFromName("UnknownSOPClass") == NULL);
+    OFCHECK(dcmFindUIDFromName(NULL) == NULL);
+    // prefixes of well-known UIDs are not known
+    OFCHECK(dcmFindNameOfUID("1.2.840.10008.5.1.4.1.1") == NULL);
+
+    // storage SOP classes and modalities
+    for (int i = 0; i < numberOfAllDcmStorageSOPClassUIDs; i++)
+    {
+        const char *uid = dcmAllStorageSOPClassUIDs[i];
+        OFCHECK(dcmIsaStorageSOPClassUID(uid));
+        const char *name = dcmFindNameOfUID(uid);
+        OFCHECK(name != NULL);
+        if (name != NULL)
+            OFCHECK_EQUAL(OFString(dcmFindUIDFromName(name)), uid);
+    }
+    OFCHECK(!dcmIsaStorageSOPClassUID(UID_VerificationSOPClass));
+    OFCHECK(!dcmIsaStorageSOPClassUID("1.2.3.4"));
+    OFCHECK(!dcmIsaStorageSOPClassUID(NULL));
+    OFCHECK_EQUAL(OFString(dcmSOPClassUIDToModality(UID_CTImageStorage)), "CT");
+    OFCHECK_EQUAL(OFString(dcmSOPClassUIDToModality("1.2.3.4", "OT")), "OT");
+    OFCHECK_EQUAL(dcmGuessModalityBytes(UID_CTImageStorage), 512 * 512 * 2);
+    OFCHECK_EQUAL(dcmGuessModalityBytes("1.2.3.4"), 1048576);
+
+    // all properties at once
+    DcmUIDProperties properties;
+    OFCHECK(dcmFindUIDProperties(UID_CTImageStorage, properties));
+    OFCHECK_EQUAL(OFString(properties.name), "CTImageStorage");
+    OFCHECK_EQUAL(OFString(properties.modality), "CT");
+    OFCHECK_EQUAL(properties.averageSize, 512 * 512 * 2);
+    OFCHECK(properties.isStorageSOPClass);
+    OFCHECK(dcmFindUIDProperties(UID_VerificationSOPClass, properties));
+    OFCHECK(properties.modality == NULL);
+    OFCHECK(!properties.isStorageSOPClass);
+    OFCHECK(!dcmFindUIDProperties("1.2.3.4", properties));
+    OFCHECK(properties.name == NULL);
+
+    // compare the performance with a linear search when negotiating many presentation contexts
+    OFVector<OFString> syntaxes;
+    getAbstractSyntaxes(syntaxes);
+    const size_t count = syntaxes.size();
+    size_t found = 0;
+    size_t foundLinear = 0;
+    OFTimer timer;
+    for (int i = 0; i < NUMBER_OF_ASSOCIATIONS; i++)
+    {
+        for (size_t j = 0; j < count; j++)
+        {
+            if (isStorageSOPClassLinear(syntaxes[j].c_str()))
+                ++foundLinear;
+        }
+    }
+    const double timeLinear = timer.getDiff();
+    timer.reset();
+    for (int i = 0; i < NUMBER_OF_ASSOCIATIONS; i++)
+    {
+        for (size_t j = 0; j < count; j++)
+        {
+            if (dcmIsaStorageSOPClassUID(syntaxes[j].c_str()))
+                ++found;
+        }
+    }
+    const double timeHashed = timer.getDiff();
+    timer.reset();
+    for (int i = 0; i < NUMBER_OF_ASSOCIATIONS; i++)
+    {
+        for (size_t j = 0; j < count; j++)
+            dcmFindUIDProperties(syntaxes[j].c_str(), properties);
+    }
+    const double timeProperties = timer.getDiff();
+    OFCHECK_EQUAL(found, foundLinear);
+    OFCHECK_EQUAL(found, NUMBER_OF_ASSOCIATIONS * OFstatic_cast(size_t, numberOfDcmLongSCUStorageSOPClassUIDs));
+    OFTEST_LOG_VERBOSE("Checking " << count << " presentation contexts of " << NUMBER_OF_ASSOCIATIONS
+        << " associations for storage SOP classes: " << timeLinear << " s with a linear search, "
+        << timeHashed << " s with the hash table, " << timeProperties << " s for looking up all properties");
+}
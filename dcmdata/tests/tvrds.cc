@@ -23,9 +23,14 @@
 #include "dcmtk/config/osconfig.h"    /* make sure OS specific configuration is included first */
 
 #include "dcmtk/ofstd/oftest.h"
+#include "dcmtk/ofstd/oftimer.h"
 #include "dcmtk/dcmdata/dcvrds.h"
+#include "dcmtk/dcmdata/dcitem.h"
 #include "dcmtk/dcmdata/dcdeftag.h"
 
+#define INCLUDE_CMATH
+#include "dcmtk/ofstd/ofstdinc.h"
+
 
 OFTEST(dcmdata_decimalString_1)
 {
@@ -89,3 +94,114 @@ OFTEST(dcmdata_decimalString_4)
     OFCHECK(decStr.getFloat64Vector(doubleVals).bad());
     OFCHECK_EQUAL(doubleVals.size(), 4);
 }
+
+OFTEST(dcmdata_decimalString_5)
+{
+    /* compare the conversion of the element value with the conversion of the single values */
+    const char *values[] = { "0", "-0", "+1", "1.", ".5", "-.5", "  12.75", "3.14159265358979", "-1.5e-3", "6.02E+23",
+                             "1e300", "-2.5E-300", "1234567890123456", "0.000000001", "7E", "8e-", "9abc", "+.1e1 " };
+    const size_t count = sizeof(values) / sizeof(values[0]);
+    OFString strVal;
+    for (size_t i = 0; i < count; ++i)
+    {
+        if (i > 0) strVal += '\\';
+        strVal += values[i];
+    }
+    DcmDecimalString decStr(DCM_ContourData);
+    OFVector<Float64> doubleVals;
+    OFCHECK(decStr.putOFStringArray(strVal).good());
+    OFCHECK(decStr.getFloat64Vector(doubleVals).good());
+    OFCHECK_EQUAL(doubleVals.size(), count);
+    for (size_t j = 0; (j < count) && (j < doubleVals.size()); ++j)
+    {
+        OFBool success = OFFalse;
+        const Float64 expected = OFStandard::atof(values[j], &success);
+        OFCHECK(success);
+        OFCHECK_EQUAL(doubleVals[j], expected);
+        Float64 doubleVal = 0;
+        OFCHECK(decStr.getFloat64(doubleVal, OFstatic_cast(unsigned long, j)).good());
+        OFCHECK_EQUAL(doubleVal, expected);
+    }
+    Float64 doubleVal = 0;
+    OFCHECK(decStr.getFloat64(doubleVal, OFstatic_cast(unsigned long, count)) == EC_IllegalParameter);
+    /* the position after the converted number is reported */
+    const char *next = NULL;
+    OFCHECK_EQUAL(OFStandard::atof("-1.25e2\\3", NULL, &next), -125.0);
+    OFCHECK_EQUAL(*next, '\\');
+    OFCHECK_EQUAL(OFStandard::atof("7E\\3", NULL, &next), 7.0);
+    OFCHECK_EQUAL(*next, 'E');
+    OFBool success = OFTrue;
+    const char *invalid = " \\1";
+    OFStandard::atof(invalid, &success, &next);
+    OFCHECK(!success);
+    OFCHECK(next == invalid);
+    /* empty values cannot be converted */
+    OFCHECK(decStr.putString("1\\\\3").good());
+    OFCHECK(decStr.getFloat64(doubleVal, 1) == EC_CorruptedData);
+    OFCHECK(decStr.getFloat64Vector(doubleVals) == EC_CorruptedData);
+    OFCHECK(decStr.putString("").good());
+    OFCHECK(decStr.getFloat64(doubleVal) == EC_CorruptedData);
+    OFCHECK(decStr.getFloat64(doubleVal, 1) == EC_IllegalParameter);
+    OFCHECK(decStr.getFloat64Vector(doubleVals).good());
+    OFCHECK(doubleVals.empty());
+}
+
+OFTEST(dcmdata_decimalString_6)
+{
+    /* create large contour data and convert it in both directions */
+    const unsigned long count = 300000;
+    Float64 *values = new Float64[count];
+    for (unsigned long i = 0; i < count; ++i)
+        values[i] = (OFstatic_cast(Float64, (i * 7919) % 100000) - 50000.0) / 7.0;
+    values[0] = 1.0 / 3.0;
+    values[1] = -123456789.0123456;
+    values[2] = 1.0e-20;
+    values[3] = -9.87654321e200;
+    DcmDecimalString decStr(DCM_ContourData);
+    OFTimer timer;
+    OFCHECK(decStr.putFloat64Array(values, count).good());
+    const double timePut = timer.getDiff();
+    OFCHECK_EQUAL(decStr.getVM(), count);
+    OFCHECK(decStr.checkValue("3-3n").good());
+    /* the values are stored with the maximum precision that fits into a DS value */
+    OFString strVal;
+    OFCHECK(decStr.getOFString(strVal, 0).good());
+    OFCHECK_EQUAL(strVal, "0.33333333333333");
+    OFCHECK(decStr.getOFString(strVal, 1).good());
+    OFCHECK_EQUAL(strVal, "-123456789.01235");
+    OFCHECK(decStr.getOFString(strVal, 3).good());
+    OFCHECK_EQUAL(strVal, "-9.87654321e+200");
+    OFVector<Float64> doubleVals;
+    timer.reset();
+    OFCHECK(decStr.getFloat64Vector(doubleVals).good());
+    const double timeVector = timer.getDiff();
+    OFCHECK_EQUAL(doubleVals.size(), count);
+    /* compare with the conversion of each single value (as done before) */
+    OFString allVals;
+    OFCHECK(decStr.getOFStringArray(allVals, OFFalse /*normalize*/).good());
+    timer.reset();
+    size_t pos = 0;
+    unsigned long mismatches = 0;
+    for (unsigned long j = 0; j < count; ++j)
+    {
+        size_t end = allVals.find('\\', pos);
+        if (end == OFString_npos) end = allVals.length();
+        const Float64 expected = OFStandard::atof(allVals.substr(pos, end - pos).c_str());
+        if ((j >= doubleVals.size()) || (doubleVals[j] != expected)) ++mismatches;
+        /* the precision of a DS value is limited, so just check the magnitude */
+        if (fabs(expected - values[j]) > fabs(values[j]) * 1e-10) ++mismatches;
+        pos = end + 1;
+    }
+    const double timeSingle = timer.getDiff();
+    OFCHECK_EQUAL(mismatches, 0);
+    /* the same via the item interface */
+    DcmItem item;
+    OFCHECK(item.putAndInsertFloat64Array(DCM_ContourData, values, count).good());
+    DcmElement *elem = NULL;
+    OFCHECK(item.findAndGetElement(DCM_ContourData, elem).good());
+    OFCHECK(elem != NULL && elem->getOFStringArray(strVal, OFFalse /*normalize*/).good());
+    OFCHECK(strVal == allVals);
+    delete[] values;
+    OFTEST_LOG_VERBOSE("Converting " << count << " DS values: " << timePut << " s for putFloat64Array(), "
+        << timeVector << " s for getFloat64Vector(), " << timeSingle << " s for copying and converting each value");
+}
@@ -0,0 +1,92 @@
+/*
+ *
+ *  Copyright (C) 2012, OFFIS e.V.
+ *  All rights reserved.  See COPYRIGHT file for details.
+ *
+ *  This software and supporting documentation were developed by
+ *
+ *    OFFIS e.V.
+ *    R&D Division Health
+ *    Escherweg 2
+ *    D-26121 Oldenburg, Germany
+ *
+ *
+ *  Module:  dcmdata
+ *
+ *  Author:  DCMTK team
+ *
+ *  Purpose: test program for class DcmIntegerString
+ *
+ */
+
+
+#include "dcmtk/config/osconfig.h"    /* make sure OS specific configuration is included first */
+
+#include "dcmtk/ofstd/oftest.h"
+#include "dcmtk/dcmdata/dcvris.h"
+#include "dcmtk/dcmdata/dcdeftag.h"
+
+
+OFTEST(dcmdata_integerString_1)
+{
+    DcmIntegerString intStr(DCM_ReferencedFrameNumber);
+    OFVector<Sint32> sintVals;
+    Sint32 sintVal = 0;
+    OFCHECK(intStr.putString("1\\ 22\\-333 \\+4444\\2147483647\\-2147483648\\0").good());
+    OFCHECK(intStr.getSint32Vector(sintVals).good());
+    OFCHECK_EQUAL(sintVals.size(), 7);
+    if (sintVals.size() == 7)
+    {
+        OFCHECK_EQUAL(sintVals[0], 1);
+        OFCHECK_EQUAL(sintVals[1], 22);
+        OFCHECK_EQUAL(sintVals[2], -333);
+        OFCHECK_EQUAL(sintVals[3], 4444);
+        OFCHECK_EQUAL(sintVals[4], 2147483647);
+        OFCHECK_EQUAL(sintVals[5], -2147483647 - 1);
+        OFCHECK_EQUAL(sintVals[6], 0);
+    }
+    for (unsigned long i = 0; i < sintVals.size(); ++i)
+    {
+        OFCHECK(intStr.getSint32(sintVal, i).good());
+        OFCHECK_EQUAL(sintVal, sintVals[i]);
+    }
+    OFCHECK(intStr.getSint32(sintVal, 7) == EC_IllegalParameter);
+    /* values that do not fit into 32 bits are rejected */
+    OFCHECK(intStr.putString("1\\2147483648").good());
+    OFCHECK(intStr.getSint32(sintVal, 0).good());
+    OFCHECK(intStr.getSint32(sintVal, 1) == EC_CorruptedData);
+    OFCHECK(intStr.getSint32Vector(sintVals) == EC_CorruptedData);
+    OFCHECK_EQUAL(sintVals.size(), 1);
+    OFCHECK(intStr.putString("-2147483649").good());
+    OFCHECK(intStr.getSint32(sintVal) == EC_CorruptedData);
+    /* empty and invalid values */
+    OFCHECK(intStr.putString("1\\\\3").good());
+    OFCHECK(intStr.getSint32(sintVal, 1) == EC_CorruptedData);
+    OFCHECK(intStr.putString("1\\-\\3").good());
+    OFCHECK(intStr.getSint32(sintVal, 1) == EC_CorruptedData);
+    OFCHECK(intStr.putString("").good());
+    OFCHECK(intStr.getSint32(sintVal) == EC_CorruptedData);
+    OFCHECK(intStr.getSint32Vector(sintVals).good());
+    OFCHECK(sintVals.empty());
+}
+
+OFTEST(dcmdata_integerString_2)
+{
+    const Sint32 values[] = { 0, -1, 42, 2147483647, -2147483647 - 1, 100000 };
+    const unsigned long count = sizeof(values) / sizeof(values[0]);
+    DcmIntegerString intStr(DCM_ReferencedFrameNumber);
+    OFCHECK(intStr.putSint32Array(values, count).good());
+    OFString strVal;
+    OFCHECK(intStr.getOFStringArray(strVal).good());
+    OFCHECK_EQUAL(strVal, "0\\-1\\42\\2147483647\\-2147483648\\100000");
+    OFCHECK(intStr.checkValue("1-n").good());
+    OFVector<Sint32> sintVals;
+    OFCHECK(intStr.getSint32Vector(sintVals).good());
+    OFCHECK_EQUAL(sintVals.size(), count);
+    for (unsigned long i = 0; (i < count) && (i < sintVals.size()); ++i)
+        OFCHECK_EQUAL(sintVals[i], values[i]);
+    /* an empty array results in an empty value */
+    OFCHECK(intStr.putSint32Array(NULL, 0).good());
+    OFCHECK(intStr.isEmpty());
+    OFCHECK(intStr.putSint32Array(NULL, 1).bad());
+}
@@ -0,0 +1,126 @@
+/*
+ *
+ *  Copyright (C) 2012, OFFIS e.V.
+ *  All rights reserved.  See COPYRIGHT file for details.
+ *
+ *  This software and supporting documentation were developed by
+ *
+ *    OFFIS e.V.
+ *    R&D Division Health
+ *    Escherweg 2
+ *    D-26121 Oldenburg, Germany
+ *
+ *
+ *  Module:  dcmdata
+ *
+ *  Author:  DCMTK team
+ *
+ *  Purpose: test program for the XML output of datasets
+ *
+ */
+
+
+#include "dcmtk/config/osconfig.h"    /* make sure OS specific configuration is included first */
+
+#include "dcmtk/ofstd/oftest.h"
+#include "dcmtk/ofstd/ofbufout.h"
+#include "dcmtk/ofstd/oftempf.h"
+#include "dcmtk/ofstd/oftimer.h"
+#include "dcmtk/dcmdata/dctk.h"
+
+
+/* number of items in the sequence of the dataset used for measuring the performance */
+#define NUMBER_OF_ITEMS 4000
+
+/* number of 16 bit values in the binary element of this dataset */
+#define NUMBER_OF_VALUES 500000
+
+
+// write the given dataset in XML format to a string
+static OFString writeXMLString(DcmDataset &dataset, const size_t flags)
+{
+    OFOStringStream stream;
+    OFCHECK(dataset.writeXML(stream, flags).good());
+    OFSTRINGSTREAM_GETOFSTRING(stream, result)
+    return result;
+}
+
+// create a dataset with a large sequence and a large binary element
+static void createDataset(DcmDataset &dataset)
+{
+    char buf[64];
+    DcmItem *item = NULL;
+    for (int i = 0; i < NUMBER_OF_ITEMS; ++i)
+    {
+        OFCHECK(dataset.findOrCreateSequenceItem(DCM_ReferencedImageSequence, item, -2 /* append */).good());
+        if (item != NULL)
+        {
+            sprintf(buf, "1.2.276.0.7230010.3.1.4.%i", i);
+            item->putAndInsertString(DCM_ReferencedSOPInstanceUID, buf);
+            item->putAndInsertString(DCM_ReferencedSOPClassUID, UID_CTImageStorage);
+            item->putAndInsertString(DCM_PatientName, "Doe^John <Jr.> & \"Sons\"");
+        }
+    }
+    Uint16 *values = new Uint16[NUMBER_OF_VALUES];
+    for (Uint32 j = 0; j < NUMBER_OF_VALUES; ++j)
+        values[j] = OFstatic_cast(Uint16, j * 7);
+    OFCHECK(dataset.putAndInsertUint16Array(DCM_RedPaletteColorLookupTableData, values, NUMBER_OF_VALUES).good());
+    delete[] values;
+}
+
+// write the given dataset in XML format to a file, optionally using a buffered stream
+static double writeXMLFile(DcmDataset &dataset, const size_t flags, const char *filename, const OFBool buffered)
+{
+    OFTimer timer;
+    STD_NAMESPACE ofstream file(filename);
+    if (buffered)
+    {
+        OFBufferedOutputStream stream(file);
+        OFCHECK(dataset.writeXML(stream, flags).good());
+        OFCHECK(stream.flushBuffer());
+    } else
+        OFCHECK(dataset.writeXML(file, flags).good());
+    file.close();
+    return timer.getDiff();
+}
+
+
+OFTEST(dcmdata_writeXML)
+{
+    // binary data is written as hex numbers with leading zeros
+    DcmDataset dataset;
+    const Uint16 words[] = { 0x0001, 0xabcd, 0xffff, 0x0a00 };
+    const Uint8 bytes[] = { 0x00, 0x7f, 0x80, 0xff };
+    OFCHECK(dataset.putAndInsertUint16Array(DCM_RedPaletteColorLookupTableData, words, 4).good());
+    OFCHECK(dataset.putAndInsertUint8Array(DCM_ICCProfile, bytes, 4).good());
+    OFCHECK(dataset.putAndInsertString(DCM_PatientName, "Doe^John <Jr.> & \"Sons\"").good());
+    OFString xml = writeXMLString(dataset, DCMTypes::XF_writeBinaryData);
+    OFCHECK(xml.find("binary=\"yes\">0001\\abcd\\ffff\\0a00</element>") != OFString_npos);
+    OFCHECK(xml.find("binary=\"yes\">00\\7f\\80\\ff</element>") != OFString_npos);
+    OFCHECK(xml.find(">Doe^John &lt;Jr.&gt; &amp; &quot;Sons&quot;</element>") != OFString_npos);
+    // the same data encoded as Base64 (16 bit values in big endian byte order)
+    xml = writeXMLString(dataset, DCMTypes::XF_writeBinaryData | DCMTypes::XF_encodeBase64);
+    OFCHECK(xml.find("binary=\"base64\">AAGrzf//CgA=</element>") != OFString_npos);
+    OFCHECK(xml.find("binary=\"base64\">AH+A/w==</element>") != OFString_npos);
+
+    // compare the performance of writing a large dataset with and without output buffer
+    DcmDataset largeDataset;
+    createDataset(largeDataset);
+    OFTempFile tempFile(O_RDWR, "", "txmlout", ".xml");
+    OFTempFile bufferedFile(O_RDWR, "", "txmlout", ".xml");
+    OFCHECK(tempFile.getStatus().good());
+    OFCHECK(bufferedFile.getStatus().good());
+    const size_t flags[] = { 0, DCMTypes::XF_writeBinaryData, DCMTypes::XF_writeBinaryData | DCMTypes::XF_encodeBase64 };
+    const char *names[] = { "without binary data", "with hex numbers", "with Base64 data" };
+    for (size_t i = 0; i < 3; ++i)
+    {
+        const double timeDirect = writeXMLFile(largeDataset, flags[i], tempFile.getFilename(), OFFalse);
+        const double timeBuffered = writeXMLFile(largeDataset, flags[i], bufferedFile.getFilename(), OFTrue);
+        // the output is the same in both cases
+        const size_t fileSize = OFStandard::getFileSize(tempFile.getFilename());
+        OFCHECK(fileSize > 0);
+        OFCHECK_EQUAL(OFStandard::getFileSize(bufferedFile.getFilename()), fileSize);
+        OFTEST_LOG_VERBOSE("Writing " << fileSize << " bytes of XML " << names[i] << ": " << timeDirect
+            << " s directly to the file, " << timeBuffered << " s with OFBufferedOutputStream");
+    }
+}
@@ -103,6 +103,7 @@ int main(int argc, char *argv[])
   OFBool           opt_usePixelValues = OFTrue;
   OFBool           opt_useModalityRescale = OFFalse;
   OFBool           opt_trueLossless = OFTrue;
+  OFCmdUnsignedInt opt_threads = 1;
   OFBool           lossless = OFTrue;  /* see opt_oxfer */
 
   OFConsoleApplication app(OFFIS_CONSOLE_APPLICATION, "Encode DICOM file to JPEG transfer syntax", rcsid);
@@ -229,6 +230,11 @@ int main(int argc, char *argv[])
       cmd.addOption("--uid-default",         "+ud",    "assign new UID if lossy compression (default)");
       cmd.addOption("--uid-always",          "+ua",    "always assign new UID");
       cmd.addOption("--uid-never",           "+un",    "never assign new UID");
+#ifdef WITH_THREADS
+    cmd.addSubGroup("multi-threading:");
+      cmd.addOption("--threads",             "+th", 1, "[n]umber: integer (default: 1)",
+                                                       "compress up to n frames in parallel");
+#endif
 
   cmd.addGroup("output options:");
     cmd.addSubGroup("post-1993 value representations:");
@@ -557,6 +563,11 @@ int main(int argc, char *argv[])
       if (cmd.findOption("--uid-never")) opt_uidcreation = EUC_never;
       cmd.endOptionBlock();
 
+#ifdef WITH_THREADS
+      if (cmd.findOption("--threads"))
+        app.checkValue(cmd.getValueAndCheckMinMax(opt_threads, 1, 256));
+#endif
+
       cmd.beginOptionBlock();
       if (cmd.findOption("--enable-new-vr"))
       {
@@ -626,7 +637,8 @@ int main(int argc, char *argv[])
       opt_useModalityRescale,
       opt_acceptWrongPaletteTags,
       opt_acrNemaCompatibility,
-      opt_trueLossless);
+      opt_trueLossless,
+      OFstatic_cast(Uint32, opt_threads));
 
     /* make sure data dictionary is loaded */
     if (!dcmDataDict.isDictionaryLoaded())
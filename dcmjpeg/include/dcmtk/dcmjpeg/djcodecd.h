@@ -35,6 +35,7 @@ class DcmDataset;
 class DcmItem;
 class DJCodecParameter;
 class DJDecoder;
+class DJCodecFrameDecoder;
 
 /** abstract codec class for JPEG decoders.
  *  This abstract class contains most of the application logic
@@ -261,6 +262,9 @@ private:
   static OFBool requiresPlanarConfiguration(
     const char *sopClassUID,
     EP_Interpretation photometricInterpretation);
+
+  /// the frame decoder used by decode() calls the above private methods
+  friend class DJCodecFrameDecoder;
 };
 
 #endif
@@ -38,6 +38,7 @@ class DcmItem;
 class DcmPixelItem;
 class DicomImage;
 class DcmTagKey;
+class DJCodecFrameEncoder;
 
 
 /** abstract codec class for JPEG encoders.
@@ -379,6 +380,9 @@ private:
   OFCondition updatePlanarConfiguration(
     DcmItem *item,
     const Uint16 newPlanConf) const;
+
+  /// the frame encoder used by the encode methods calls the above private methods
+  friend class DJCodecFrameEncoder;
 };
 
 #endif
@@ -60,6 +60,194 @@ OFBool DJCodecDecoder::canChangeCoding(
 }
 
 
+/* decompresses single frames of a JPEG compressed image, see DcmCodec::processFrames() */
+class DJCodecFrameDecoder : public DcmFrameProcessor
+{
+public:
+  DJCodecFrameDecoder(const DJCodecDecoder& aCodec,
+                      const DcmRepresentationParameter *aFromRepParam,
+                      const DJCodecParameter *aCodecParameter,
+                      const OFVector<DcmCompressedFragment>& aFragments,
+                      const OFVector<Uint32>& aStartFragments,
+                      Uint8 *aImageData,
+                      Uint32 aFrameSize,
+                      Uint8 aPrecision,
+                      OFBool aIsYBR,
+                      OFBool aIsSigned,
+                      Uint16 aColumns,
+                      Uint16 aRows,
+                      Uint16 aSamplesPerPixel,
+                      const char *aSOPClassUID,
+                      EP_Interpretation aDicomPI,
+                      Uint32 aNumberOfThreads)
+  : colorModel(EPI_Unknown)
+  , createPlanarConfiguration(OFFalse)
+  , bytesPerSample(0)
+  , codec(aCodec)
+  , fromRepParam(aFromRepParam)
+  , djcp(aCodecParameter)
+  , fragments(aFragments)
+  , startFragments(aStartFragments)
+  , imageData(aImageData)
+  , frameSize(aFrameSize)
+  , precision(aPrecision)
+  , isYBR(aIsYBR)
+  , isSigned(aIsSigned)
+  , imageColumns(aColumns)
+  , imageRows(aRows)
+  , imageSamplesPerPixel(aSamplesPerPixel)
+  , sopClassUID(aSOPClassUID)
+  , dicomPI(aDicomPI)
+  , nextItem(1) // ignore offset table
+  , decoders((aNumberOfThreads > 0) ? aNumberOfThreads : 1, OFstatic_cast(DJDecoder *, NULL))
+  {
+  }
+
+  virtual ~DJCodecFrameDecoder()
+  {
+    for (size_t i = 0; i < decoders.size(); ++i)
+      delete decoders[i];
+  }
+
+  /* decompress the first frame, which determines the attributes of the decompressed
+   * image (e.g. the planar configuration). Must be called before processFrames().
+   */
+  OFCondition decodeFirstFrame();
+
+  virtual OFCondition processFrame(Uint32 frameNo, size_t threadNo);
+
+  /* decompressed color model of the first frame */
+  EP_Interpretation colorModel;
+  /* flag indicating whether the frames are converted to color-by-plane */
+  OFBool createPlanarConfiguration;
+  /* number of bytes per sample written by the JPEG decoder for the first frame */
+  Uint16 bytesPerSample;
+
+private:
+  /* decompress the given frame with the given decoder instance */
+  OFCondition decodeFrame(Uint32 frameNo, DJDecoder *jpeg);
+
+  /* get the decoder instance of the given thread, create it if necessary */
+  DJDecoder *getDecoder(size_t threadNo);
+
+  const DJCodecDecoder& codec;
+  const DcmRepresentationParameter *fromRepParam;
+  const DJCodecParameter *djcp;
+  const OFVector<DcmCompressedFragment>& fragments;
+  /* first fragment of each frame, empty if the frames are decompressed in ascending order */
+  const OFVector<Uint32>& startFragments;
+  Uint8 *imageData;
+  const Uint32 frameSize;
+  const Uint8 precision;
+  const OFBool isYBR;
+  const OFBool isSigned;
+  const Uint16 imageColumns;
+  const Uint16 imageRows;
+  const Uint16 imageSamplesPerPixel;
+  const char *sopClassUID;
+  const EP_Interpretation dicomPI;
+  /* first fragment of the next frame if the frames are decompressed in ascending order */
+  Uint32 nextItem;
+  /* instances of the compression library, one per thread (created on first use) */
+  OFVector<DJDecoder *> decoders;
+};
+
+
+DJDecoder *DJCodecFrameDecoder::getDecoder(size_t threadNo)
+{
+  // each thread needs its own instance of the compression library,
+  // which is reused for all frames decompressed by this thread
+  if (decoders[threadNo] == NULL)
+    decoders[threadNo] = codec.createDecoderInstance(fromRepParam, djcp, precision, isYBR);
+  return decoders[threadNo];
+}
+
+
+OFCondition DJCodecFrameDecoder::decodeFirstFrame()
+{
+  DJDecoder *jpeg = getDecoder(0);
+  if (jpeg == NULL) return EC_MemoryExhausted;
+  return decodeFrame(0, jpeg);
+}
+
+
+OFCondition DJCodecFrameDecoder::processFrame(Uint32 frameNo, size_t threadNo)
+{
+  // the first frame has already been decompressed by decodeFirstFrame()
+  if (frameNo == 0) return EC_Normal;
+  if (threadNo >= decoders.size()) return EC_IllegalCall;
+  DJDecoder *jpeg = getDecoder(threadNo);
+  if (jpeg == NULL) return EC_MemoryExhausted;
+  return decodeFrame(frameNo, jpeg);
+}
+
+
+OFCondition DJCodecFrameDecoder::decodeFrame(Uint32 frameNo, DJDecoder *jpeg)
+{
+  // without a list of start fragments, each frame starts after the previous one
+  Uint32 currentItem = startFragments.empty() ? nextItem : startFragments[frameNo];
+  const Uint32 endItem = startFragments.empty() ? OFstatic_cast(Uint32, fragments.size()) : startFragments[frameNo + 1];
+  Uint8 *imageData8 = imageData + frameNo * frameSize;
+
+  OFCondition result = jpeg->init();
+  if (result.good())
+  {
+    result = EJ_Suspension;
+    while (EJ_Suspension == result)
+    {
+      if (currentItem >= endItem) result = EC_IllegalCall;
+      else
+      {
+        const DcmCompressedFragment& fragment = fragments[currentItem++];
+        result = jpeg->decode(fragment.data, fragment.length, imageData8, frameSize, isSigned);
+      }
+    }
+    if (result.good())
+    {
+      if (frameNo == 0)
+      {
+        // we need to know the decompressed photometric interpretation in order
+        // to determine the final planar configuration.  However, this is only
+        // known after the first call to jpeg->decode(), i.e. here.
+        colorModel = jpeg->getDecompressedColorModel();
+        if (colorModel == EPI_Unknown)
+        {
+          // derive color model from DICOM photometric interpretation
+          if ((dicomPI == EPI_YBR_Full_422)||(dicomPI == EPI_YBR_Partial_422)) colorModel = EPI_YBR_Full;
+          else colorModel = dicomPI;
+        }
+
+        switch (djcp->getPlanarConfiguration())
+        {
+          case EPC_default:
+            createPlanarConfiguration = DJCodecDecoder::requiresPlanarConfiguration(sopClassUID, colorModel);
+            break;
+          case EPC_colorByPixel:
+            createPlanarConfiguration = OFFalse;
+            break;
+          case EPC_colorByPlane:
+            createPlanarConfiguration = OFTrue;
+            break;
+        }
+        bytesPerSample = jpeg->bytesPerSample();
+      }
+
+      // convert planar configuration if necessary
+      if ((imageSamplesPerPixel == 3) && createPlanarConfiguration)
+      {
+        if (precision > 8)
+          result = DJCodecDecoder::createPlanarConfigurationWord((Uint16 *)imageData8, imageColumns, imageRows);
+          else result = DJCodecDecoder::createPlanarConfigurationByte(imageData8, imageColumns, imageRows);
+      }
+    }
+  }
+
+  // the next frame starts with the next fragment
+  if (result.good() && startFragments.empty()) nextItem = currentItem;
+  return result;
+}
+
+
 OFCondition DJCodecDecoder::decode(
     const DcmRepresentationParameter * fromRepParam,
     DcmPixelSequence * pixSeq,
@@ -86,7 +274,6 @@ OFCondition DJCodecDecoder::decode(
     Uint16 imageHighBit = 0;
     const char *sopClassUID = NULL;
     OFBool createPlanarConfiguration = OFFalse;
-    OFBool createPlanarConfigurationInitialized = OFFalse;
     EP_Interpretation colorModel = EPI_Unknown;
     OFBool isSigned = OFFalse;
     Uint16 pixelRep = 0; // needed to decline color conversion of signed pixel data to RGB
@@ -139,181 +326,137 @@ OFCondition DJCodecDecoder::decode(
             if (precision == 0) result = EC_CannotChangeRepresentation; // something has gone wrong, bail out
             else
             {
-              DJDecoder *jpeg = createDecoderInstance(fromRepParam, djcp, precision, isYBR);
-              if (jpeg == NULL) result = EC_MemoryExhausted;
-              else
+              Uint32 frameSize = ((precision > 8) ? sizeof(Uint16) : sizeof(Uint8)) * imageRows * imageColumns * imageSamplesPerPixel;
+              Uint32 totalSize = frameSize * imageFrames;
+              if (totalSize & 1) totalSize++; // align on 16-bit word boundary
+              Uint16 *imageData16 = NULL;
+              OFVector<DcmCompressedFragment> fragments;
+              OFVector<Uint32> startFragments;
+              Uint32 numberOfThreads = djcp->getNumberOfThreads();
+
+              if (isYBR && (imageBitsStored < imageBitsAllocated)) // check for a special case that is currently not handled properly
+              {
+                if (djcp->getDecompressionColorSpaceConversion() != EDC_never)
+                {
+                  DCMJPEG_WARN("BitsStored < BitsAllocated for JPEG compressed image with YCbCr color model, color space conversion will probably not work properly");
+                  DCMJPEG_DEBUG("workaround: use option --conv-never (for command line tools) or EDC_never (for the DJDecoderRegistration::registerCodecs() call)");
+                }
+              }
+
+              // load all fragments, so that they can be accessed by multiple threads
+              result = loadFragments(pixSeq, fragments);
+
+              // frames can only be decompressed concurrently if their first fragments are known in advance
+              if (result.good() && (numberOfThreads > 1) && (imageFrames > 1))
               {
-                Uint32 frameSize = ((precision > 8) ? sizeof(Uint16) : sizeof(Uint8)) * imageRows * imageColumns * imageSamplesPerPixel;
-                Uint32 totalSize = frameSize * imageFrames;
-                if (totalSize & 1) totalSize++; // align on 16-bit word boundary
-                Uint16 *imageData16 = NULL;
-                Sint32 currentFrame = 0;
-                Uint32 currentItem = 1; // ignore offset table
+                if (determineFrameFragments(imageFrames, pixSeq, startFragments).bad())
+                {
+                  DCMJPEG_DEBUG("JPEG decoder cannot determine the fragments of each frame, decompressing frames sequentially");
+                  numberOfThreads = 1;
+                }
+              }
 
-                if (isYBR && (imageBitsStored < imageBitsAllocated)) // check for a special case that is currently not handled properly
+              if (result.good()) result = uncompressedPixelData.createUint16Array(totalSize / sizeof(Uint16), imageData16);
+              if (result.good())
+              {
+                DJCodecFrameDecoder frameDecoder(*this, fromRepParam, djcp, fragments, startFragments,
+                  OFreinterpret_cast(Uint8 *, imageData16), frameSize, precision, isYBR, isSigned,
+                  imageColumns, imageRows, imageSamplesPerPixel, sopClassUID, dicomPI, numberOfThreads);
+                // the first frame determines the color model and planar configuration of all frames
+                result = frameDecoder.decodeFirstFrame();
+                if (result.good() && (imageFrames > 1))
+                  result = processFrames(frameDecoder, imageFrames, numberOfThreads);
+
+                // the color model and planar configuration have been determined from the first frame
+                colorModel = frameDecoder.colorModel;
+                createPlanarConfiguration = frameDecoder.createPlanarConfiguration;
+
+                if (result.good())
                 {
-                  if (djcp->getDecompressionColorSpaceConversion() != EDC_never)
+                  // decompression is complete, finally adjust byte order if necessary
+                  if (frameDecoder.bytesPerSample == 1) // we're writing bytes into words
                   {
-                    DCMJPEG_WARN("BitsStored < BitsAllocated for JPEG compressed image with YCbCr color model, color space conversion will probably not work properly");
-                    DCMJPEG_DEBUG("workaround: use option --conv-never (for command line tools) or EDC_never (for the DJDecoderRegistration::registerCodecs() call)");
+                    result = swapIfNecessary(gLocalByteOrder, EBO_LittleEndian, imageData16,
+                      totalSize, sizeof(Uint16));
                   }
                 }
 
-                result = uncompressedPixelData.createUint16Array(totalSize / sizeof(Uint16), imageData16);
+                // adjust photometric interpretation depending on what conversion has taken place
                 if (result.good())
                 {
-                  Uint8 *imageData8 = (Uint8 *)imageData16;
-
-                  while ((currentFrame < imageFrames)&&(result.good()))
+                  switch (colorModel)
                   {
-                    result = jpeg->init();
-                    if (result.good())
-                    {
-                      result = EJ_Suspension;
-                      while (EJ_Suspension == result)
+                    case EPI_Monochrome2:
+                      result = ((DcmItem *)dataset)->putAndInsertString(DCM_PhotometricInterpretation, "MONOCHROME2");
+                      if (result.good())
                       {
-                        result = pixSeq->getItem(pixItem, currentItem++);
-                        if (result.good())
-                        {
-                          fragmentLength = pixItem->getLength();
-                          result = pixItem->getUint8Array(jpegData);
-                          if (result.good())
-                          {
-                            result = jpeg->decode(jpegData, fragmentLength, imageData8, frameSize, isSigned);
-                          }
-                        }
+                        imageSamplesPerPixel = 1;
+                        result = ((DcmItem *)dataset)->putAndInsertUint16(DCM_SamplesPerPixel, imageSamplesPerPixel);
                       }
+                      break;
+                    case EPI_YBR_Full:
+                      result = ((DcmItem *)dataset)->putAndInsertString(DCM_PhotometricInterpretation, "YBR_FULL");
                       if (result.good())
                       {
-                        if (! createPlanarConfigurationInitialized)
-                        {
-                          // we need to know the decompressed photometric interpretation in order
-                          // to determine the final planar configuration.  However, this is only
-                          // known after the first call to jpeg->decode(), i.e. here.
-                          colorModel = jpeg->getDecompressedColorModel();
-                          if (colorModel == EPI_Unknown)
-                          {
-                            // derive color model from DICOM photometric interpretation
-                            if ((dicomPI == EPI_YBR_Full_422)||(dicomPI == EPI_YBR_Partial_422)) colorModel = EPI_YBR_Full;
-                            else colorModel = dicomPI;
-                          }
-
-                          switch (djcp->getPlanarConfiguration())
-                          {
-                            case EPC_default:
-                              createPlanarConfiguration = requiresPlanarConfiguration(sopClassUID, colorModel);
-                              break;
-                            case EPC_colorByPixel:
-                              createPlanarConfiguration = OFFalse;
-                              break;
-                            case EPC_colorByPlane:
-                              createPlanarConfiguration = OFTrue;
-                              break;
-                          }
-                          createPlanarConfigurationInitialized = OFTrue;
-                        }
-
-                        // convert planar configuration if necessary
-                        if ((imageSamplesPerPixel == 3) && createPlanarConfiguration)
-                        {
-                          if (precision > 8)
-                            result = createPlanarConfigurationWord((Uint16 *)imageData8, imageColumns, imageRows);
-                            else result = createPlanarConfigurationByte(imageData8, imageColumns, imageRows);
-                        }
-                        currentFrame++;
-                        imageData8 += frameSize;
+                        imageSamplesPerPixel = 3;
+                        result = ((DcmItem *)dataset)->putAndInsertUint16(DCM_SamplesPerPixel, imageSamplesPerPixel);
                       }
-                    }
-                  }
-
-                  if (result.good())
-                  {
-                    // decompression is complete, finally adjust byte order if necessary
-                    if (jpeg->bytesPerSample() == 1) // we're writing bytes into words
-                    {
-                      result = swapIfNecessary(gLocalByteOrder, EBO_LittleEndian, imageData16,
-                        totalSize, sizeof(Uint16));
-                    }
-                  }
-
-                  // adjust photometric interpretation depending on what conversion has taken place
-                  if (result.good())
-                  {
-                    switch (colorModel)
-                    {
-                      case EPI_Monochrome2:
-                        result = ((DcmItem *)dataset)->putAndInsertString(DCM_PhotometricInterpretation, "MONOCHROME2");
-                        if (result.good())
-                        {
-                          imageSamplesPerPixel = 1;
-                          result = ((DcmItem *)dataset)->putAndInsertUint16(DCM_SamplesPerPixel, imageSamplesPerPixel);
-                        }
-                        break;
-                      case EPI_YBR_Full:
+                      break;
+                    case EPI_RGB:
+                      result = ((DcmItem *)dataset)->putAndInsertString(DCM_PhotometricInterpretation, "RGB");
+                      if (result.good())
+                      {
+                        imageSamplesPerPixel = 3;
+                        result = ((DcmItem *)dataset)->putAndInsertUint16(DCM_SamplesPerPixel, imageSamplesPerPixel);
+                      }
+                      break;
+                    default:
+                      /* leave photometric interpretation untouched unless it is YBR_FULL_422
+                       * or YBR_PARTIAL_422. In this case, replace by YBR_FULL since decompression
+                       * eliminates the subsampling.
+                       */
+                      if ((dicomPI == EPI_YBR_Full_422)||(dicomPI == EPI_YBR_Partial_422))
+                      {
                         result = ((DcmItem *)dataset)->putAndInsertString(DCM_PhotometricInterpretation, "YBR_FULL");
-                        if (result.good())
-                        {
-                          imageSamplesPerPixel = 3;
-                          result = ((DcmItem *)dataset)->putAndInsertUint16(DCM_SamplesPerPixel, imageSamplesPerPixel);
-                        }
-                        break;
-                      case EPI_RGB:
-                        result = ((DcmItem *)dataset)->putAndInsertString(DCM_PhotometricInterpretation, "RGB");
-                        if (result.good())
-                        {
-                          imageSamplesPerPixel = 3;
-                          result = ((DcmItem *)dataset)->putAndInsertUint16(DCM_SamplesPerPixel, imageSamplesPerPixel);
-                        }
-                        break;
-                      default:
-                        /* leave photometric interpretation untouched unless it is YBR_FULL_422
-                         * or YBR_PARTIAL_422. In this case, replace by YBR_FULL since decompression
-                         * eliminates the subsampling.
-                         */
-                        if ((dicomPI == EPI_YBR_Full_422)||(dicomPI == EPI_YBR_Partial_422))
-                        {
-                          result = ((DcmItem *)dataset)->putAndInsertString(DCM_PhotometricInterpretation, "YBR_FULL");
-                        }
-                        break;
-                    }
-                  }
-
-                  // Bits Allocated is now either 8 or 16
-                  if (result.good())
-                  {
-                    if (precision > 8) result = ((DcmItem *)dataset)->putAndInsertUint16(DCM_BitsAllocated, 16);
-                    else result = ((DcmItem *)dataset)->putAndInsertUint16(DCM_BitsAllocated, 8);
+                      }
+                      break;
                   }
+                }
 
-                  // Planar Configuration depends on the createPlanarConfiguration flag
-                  if ((result.good()) && (imageSamplesPerPixel > 1))
-                  {
-                    result = ((DcmItem *)dataset)->putAndInsertUint16(DCM_PlanarConfiguration, (createPlanarConfiguration ? 1 : 0));
-                  }
+                // Bits Allocated is now either 8 or 16
+                if (result.good())
+                {
+                  if (precision > 8) result = ((DcmItem *)dataset)->putAndInsertUint16(DCM_BitsAllocated, 16);
+                  else result = ((DcmItem *)dataset)->putAndInsertUint16(DCM_BitsAllocated, 8);
+                }
 
-                  // Bits Stored cannot be larger than precision
-                  if ((result.good()) && (imageBitsStored > precision))
-                  {
-                    result = ((DcmItem *)dataset)->putAndInsertUint16(DCM_BitsStored, precision);
-                  }
+                // Planar Configuration depends on the createPlanarConfiguration flag
+                if ((result.good()) && (imageSamplesPerPixel > 1))
+                {
+                  result = ((DcmItem *)dataset)->putAndInsertUint16(DCM_PlanarConfiguration, (createPlanarConfiguration ? 1 : 0));
+                }
 
-                  // High Bit cannot be larger than precision - 1
-                  if ((result.good()) && ((unsigned long)(imageHighBit+1) > (unsigned long)precision))
-                  {
-                    result = ((DcmItem *)dataset)->putAndInsertUint16(DCM_HighBit, precision-1);
-                  }
+                // Bits Stored cannot be larger than precision
+                if ((result.good()) && (imageBitsStored > precision))
+                {
+                  result = ((DcmItem *)dataset)->putAndInsertUint16(DCM_BitsStored, precision);
+                }
 
-                  // Number of Frames might have changed in case the previous value was wrong
-                  if (result.good() && (numberOfFramesPresent || (imageFrames > 1)))
-                  {
-                    char numBuf[20];
-                    sprintf(numBuf, "%ld", OFstatic_cast(long, imageFrames));
-                    result = ((DcmItem *)dataset)->putAndInsertString(DCM_NumberOfFrames, numBuf);
-                  }
+                // High Bit cannot be larger than precision - 1
+                if ((result.good()) && ((unsigned long)(imageHighBit+1) > (unsigned long)precision))
+                {
+                  result = ((DcmItem *)dataset)->putAndInsertUint16(DCM_HighBit, precision-1);
+                }
 
-                  // Pixel Representation could be signed if lossless JPEG. For now, we just believe what we get.
+                // Number of Frames might have changed in case the previous value was wrong
+                if (result.good() && (numberOfFramesPresent || (imageFrames > 1)))
+                {
+                  char numBuf[20];
+                  sprintf(numBuf, "%ld", OFstatic_cast(long, imageFrames));
+                  result = ((DcmItem *)dataset)->putAndInsertString(DCM_NumberOfFrames, numBuf);
                 }
-                delete jpeg;
+
+                // Pixel Representation could be signed if lossless JPEG. For now, we just believe what we get.
               }
             }
           }
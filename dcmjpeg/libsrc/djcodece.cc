@@ -51,6 +51,123 @@
 #include "dcmtk/ofstd/ofstdinc.h"
 
 
+/* compresses a single frame of an image with the JPEG encoder, either from
+ * the raw pixel data or from the frames rendered by a DicomImage. Since the
+ * encoder instances and the rendered frames cannot be shared between threads,
+ * each slot of a batch uses its own encoder instance and frame buffer.
+ */
+class DJCodecFrameEncoder : public DcmFrameEncoder
+{
+public:
+  DJCodecFrameEncoder(
+    const DJCodecEncoder& aCodec,
+    const DcmRepresentationParameter *aRepParam,
+    const DJCodecParameter *aCodecParameter,
+    DJEncoder *aFirstEncoder,
+    Uint8 aBitsPerSample,
+    Uint16 aColumns,
+    Uint16 aRows,
+    EP_Interpretation aInterpretation,
+    Uint16 aSamplesPerPixel,
+    Uint16 aBytesPerSample)
+  : codec(aCodec)
+  , repParam(aRepParam)
+  , cp(aCodecParameter)
+  , bitsPerSample(aBitsPerSample)
+  , columns(aColumns)
+  , rows(aRows)
+  , interpr(aInterpretation)
+  , samplesPerPixel(aSamplesPerPixel)
+  , bytesPerSample(aBytesPerSample)
+  , pixelData(NULL)
+  , dimage(NULL)
+  , renderBits(0)
+  , encoders(1, aFirstEncoder)
+  , buffers(1, OFstatic_cast(Uint8 *, NULL))
+  {
+  }
+
+  virtual ~DJCodecFrameEncoder()
+  {
+    // the encoder of the first slot is owned by the caller
+    for (size_t i = 1; i < encoders.size(); ++i) delete encoders[i];
+    for (size_t i = 0; i < buffers.size(); ++i) delete[] buffers[i];
+  }
+
+  /* compress the given raw pixel data of all frames */
+  void setRawImage(const Uint8 *aPixelData)
+  {
+    pixelData = aPixelData;
+  }
+
+  /* compress the frames rendered by the given image with the given depth */
+  void setRenderedImage(DicomImage *aImage, int aRenderBits)
+  {
+    dimage = aImage;
+    renderBits = aRenderBits;
+  }
+
+  virtual OFCondition prepareFrame(Uint32 frameNo, Uint32 slot)
+  {
+    if (slot >= encoders.size())
+    {
+      encoders.resize(slot + 1, NULL);
+      buffers.resize(slot + 1, NULL);
+    }
+    if (encoders[slot] == NULL)
+    {
+      encoders[slot] = codec.createEncoderInstance(repParam, cp, bitsPerSample);
+      if (encoders[slot] == NULL) return EC_MemoryExhausted;
+    }
+    // the image is rendered by the calling thread only
+    if (dimage != NULL)
+    {
+      const unsigned long size = dimage->getOutputDataSize(renderBits);
+      if (buffers[slot] == NULL) buffers[slot] = new Uint8[size];
+      if (!dimage->getOutputData(buffers[slot], size, renderBits, frameNo, 0)) return EC_MemoryExhausted;
+    }
+    return EC_Normal;
+  }
+
+  virtual OFCondition encodeFrame(Uint32 frameNo, Uint32 slot, Uint8 *& compressedData, Uint32& compressedLength)
+  {
+    Uint8 *frame = buffers[slot];
+    if (dimage == NULL)
+      frame = OFconst_cast(Uint8 *, pixelData) + OFstatic_cast(unsigned long, columns) * rows * samplesPerPixel * bytesPerSample * frameNo;
+    OFCondition result;
+    if (bytesPerSample == 1)
+      result = encoders[slot]->encode(columns, rows, interpr, samplesPerPixel, frame, compressedData, compressedLength);
+    else
+      result = encoders[slot]->encode(columns, rows, interpr, samplesPerPixel, OFreinterpret_cast(Uint16 *, frame), compressedData, compressedLength);
+    if (result.good() && (compressedLength == 0))
+    {
+      DCMJPEG_ERROR("JPEG encoder: Error encoding frame " << (frameNo + 1));
+      result = EC_CannotChangeRepresentation;
+    }
+    return result;
+  }
+
+private:
+  const DJCodecEncoder& codec;
+  const DcmRepresentationParameter *repParam;
+  const DJCodecParameter *cp;
+  Uint8 bitsPerSample;
+  Uint16 columns;
+  Uint16 rows;
+  EP_Interpretation interpr;
+  Uint16 samplesPerPixel;
+  Uint16 bytesPerSample;
+  /* raw pixel data of all frames, NULL if the frames are rendered */
+  const Uint8 *pixelData;
+  /* image from which the frames are rendered, NULL for raw pixel data */
+  DicomImage *dimage;
+  int renderBits;
+  /* encoder instance and rendered frame of each slot */
+  OFVector<DJEncoder *> encoders;
+  OFVector<Uint8 *> buffers;
+};
+
+
 DJCodecEncoder::DJCodecEncoder()
 : DcmCodec()
 {
@@ -340,38 +457,16 @@ OFCondition DJCodecEncoder::encodeColorImage(
       unsigned short bytesPerSample = jpeg->bytesPerSample();
       unsigned short columns = (unsigned short) dimage->getWidth();
       unsigned short rows = (unsigned short) dimage->getHeight();
-      Uint8 *jpegData = NULL;
-      Uint32 jpegLen  = 0;
-      const void *frame = NULL;
 
       // compute original image size in bytes, ignoring any padding bits.
       uncompressedSize = columns * rows * dimage->getDepth() * frameCount * samplesPerPixel / 8.0;
-      for (unsigned long i=0; (i<frameCount) && (result.good()); i++)
-      {
-        frame = dimage->getOutputData(bitsPerSample, i, 0);
-        if (frame == NULL) result = EC_MemoryExhausted;
-        else
-        {
-          // compress frame
-          jpegData = NULL;
-          if (bytesPerSample == 1)
-          {
-            result = jpeg->encode(columns, rows, interpr, samplesPerPixel, (Uint8 *)frame, jpegData, jpegLen);
-          } else {
-            result = jpeg->encode(columns, rows, interpr, samplesPerPixel, (Uint16 *)frame, jpegData, jpegLen);
-          }
-
-          // store frame
-          if (result.good())
-          {
-            result = pixelSequence->storeCompressedFrame(offsetList, jpegData, jpegLen, cp->getFragmentSize());
-          }
 
-          // delete block of JPEG data
-          delete[] jpegData;
-          compressedSize += jpegLen;
-        }
-      }
+      // the frames are rendered one after another, but possibly compressed in parallel
+      DJCodecFrameEncoder frameEncoder(*this, toRepParam, cp, jpeg, (Uint8) compressedBits,
+        columns, rows, interpr, samplesPerPixel, bytesPerSample);
+      frameEncoder.setRenderedImage(dimage, bitsPerSample);
+      result = DcmCodec::encodeFrames(frameEncoder, OFstatic_cast(Uint32, frameCount), cp->getNumberOfThreads(),
+        pixelSequence, offsetList, cp->getFragmentSize(), compressedSize);
       delete jpeg;
     } else result = EC_MemoryExhausted;
   }
@@ -466,8 +561,6 @@ OFCondition DJCodecEncoder::encodeTrueLossless(
     Uint16 rows = 0;
     Sint32 numberOfFrames = 1;
     EP_Interpretation interpr = EPI_Unknown;
-    Uint8 *jpegData = NULL;
-    Uint32 jpegLen  = 0;
     OFBool byteSwapped = OFFalse;      // true if we have byte-swapped the original pixel data
     OFBool planConfSwitched = OFFalse; // true if planar configuration was toggled
     DcmOffsetList offsetList;
@@ -593,40 +686,18 @@ OFCondition DJCodecEncoder::encodeTrueLossless(
 
     // prepare some variables for encoding
     unsigned long frameCount = OFstatic_cast(unsigned long, numberOfFrames);
-    unsigned long frameSize = columns * rows * samplesPerPixel * bytesAllocated;
-    const Uint8 *framePointer = OFreinterpret_cast(const Uint8 *, pixelData);
     unsigned long compressedSize = 0;
 
     // create encoder corresponding to bit depth (8 or 16 bit)
     DJEncoder *jpeg = createEncoderInstance(toRepParam, djcp, OFstatic_cast(Uint8, bitsAllocated));
     if (jpeg)
     {
-      // main loop for compression: compress each frame
-      for (unsigned int i=0; i<frameCount && result.good(); i++)
-      {
-        if (bitsAllocated == 8)
-        {
-          jpeg->encode(columns, rows, interpr, samplesPerPixel, (Uint8*)framePointer, jpegData, jpegLen);
-        }
-        else if (bitsAllocated == 16)
-        {
-          jpeg->encode(columns, rows, interpr, samplesPerPixel, (Uint16*)framePointer, jpegData, jpegLen);
-        }
-        // update variables
-        compressedSize+=jpegLen;
-        framePointer+=frameSize;
-        if (jpegLen == 0)
-        {
-          DCMJPEG_ERROR("True lossless encoder: Error encoding frame");
-          result = EC_CannotChangeRepresentation;
-        }
-        else
-        {
-          result = pixelSequence->storeCompressedFrame(offsetList, jpegData, jpegLen, djcp->getFragmentSize());
-        }
-        // free memory
-        delete[] jpegData;
-      }
+      // main loop for compression: compress each frame, possibly in parallel
+      DJCodecFrameEncoder frameEncoder(*this, toRepParam, djcp, jpeg, OFstatic_cast(Uint8, bitsAllocated),
+        columns, rows, interpr, samplesPerPixel, bytesAllocated);
+      frameEncoder.setRawImage(OFreinterpret_cast(const Uint8 *, pixelData));
+      result = DcmCodec::encodeFrames(frameEncoder, OFstatic_cast(Uint32, frameCount), djcp->getNumberOfThreads(),
+        pixelSequence, offsetList, djcp->getFragmentSize(), compressedSize);
     }
     else
     {
@@ -1131,40 +1202,18 @@ OFCondition DJCodecEncoder::encodeMonochromeImage(
       unsigned short bytesPerSample = jpeg->bytesPerSample();
       unsigned short columns = (unsigned short) dimage.getWidth();
       unsigned short rows = (unsigned short) dimage.getHeight();
-      Uint8 *jpegData = NULL;
-      Uint32 jpegLen  = 0;
-      const void *frame = NULL;
 
       // compute original image size in bytes, ignoring any padding bits.
       Uint16 samplesPerPixel = 0;
       if ((dataset->findAndGetUint16(DCM_SamplesPerPixel, samplesPerPixel)).bad()) samplesPerPixel = 1;
       uncompressedSize = columns * rows * pixelDepth * frameCount * samplesPerPixel / 8.0;
-      for (unsigned long i=0; (i<frameCount) && (result.good()); i++)
-      {
-        frame = dimage.getOutputData(bitsPerSample, i, 0);
-        if (frame == NULL) result = EC_MemoryExhausted;
-        else
-        {
-          // compress frame
-          jpegData = NULL;
-          if (bytesPerSample == 1)
-          {
-            result = jpeg->encode(columns, rows, EPI_Monochrome2, 1, (Uint8 *)frame, jpegData, jpegLen);
-          } else {
-            result = jpeg->encode(columns, rows, EPI_Monochrome2, 1, (Uint16 *)frame, jpegData, jpegLen);
-          }
-
-          // store frame
-          if (result.good())
-          {
-            result = pixelSequence->storeCompressedFrame(offsetList, jpegData, jpegLen, cp->getFragmentSize());
-          }
 
-          // delete block of JPEG data
-          delete[] jpegData;
-          compressedSize += jpegLen;
-        }
-      }
+      // the frames are rendered one after another, but possibly compressed in parallel
+      DJCodecFrameEncoder frameEncoder(*this, toRepParam, cp, jpeg, (Uint8) compressedBits,
+        columns, rows, EPI_Monochrome2, 1, bytesPerSample);
+      frameEncoder.setRenderedImage(&dimage, bitsPerSample);
+      result = DcmCodec::encodeFrames(frameEncoder, OFstatic_cast(Uint32, frameCount), cp->getNumberOfThreads(),
+        pixelSequence, offsetList, cp->getFragmentSize(), compressedSize);
       delete jpeg;
     } else result = EC_MemoryExhausted;
   }
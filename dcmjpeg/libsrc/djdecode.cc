@@ -45,7 +45,8 @@ void DJDecoderRegistration::registerCodecs(
     E_DecompressionColorSpaceConversion pDecompressionCSConversion,
     E_UIDCreation pCreateSOPInstanceUID,
     E_PlanarConfiguration pPlanarConfiguration,
-    OFBool predictor6WorkaroundEnable)
+    OFBool predictor6WorkaroundEnable,
+    Uint32 pNumberOfThreads)
 {
   if (! registered)
   {
@@ -57,6 +58,8 @@ void DJDecoderRegistration::registerCodecs(
       predictor6WorkaroundEnable);
     if (cp)
     {
+      cp->setNumberOfThreads(pNumberOfThreads);
+
       // baseline JPEG
       decbas = new DJDecoderBaseline();
       if (decbas) DcmCodecList::registerCodec(decbas, NULL, cp);
@@ -64,7 +64,8 @@ void DJEncoderRegistration::registerCodecs(
     OFBool pUseModalityRescale,
     OFBool pAcceptWrongPaletteTags,
     OFBool pAcrNemaCompatibility,
-    OFBool pRealLossless)
+    OFBool pRealLossless,
+    Uint32 pNumberOfThreads)
 {
   if (! registered)
   {
@@ -97,6 +98,8 @@ void DJEncoderRegistration::registerCodecs(
       pRealLossless);
     if (cp)
     {
+      cp->setNumberOfThreads(pNumberOfThreads);
+
       // baseline JPEG
       encbas = new DJEncoderBaseline();
       if (encbas) DcmCodecList::registerCodec(encbas, NULL, cp);
@@ -100,6 +100,7 @@ int main(int argc, char *argv[])
   OFBool           opt_createOffsetTable = OFTrue;
   JLS_UIDCreation  opt_uidcreation = EJLSUC_default;
   OFBool           opt_secondarycapture = OFFalse;
+  OFCmdUnsignedInt opt_threads = 1;
 
   // output options
   E_GrpLenEncoding opt_oglenc = EGL_recalcGL;
@@ -184,6 +185,11 @@ LICENSE_FILE_DECLARE_COMMAND_LINE_OPTIONS
       cmd.addOption("--uid-default",            "+ud",    "assign new UID if lossy compression (default)");
       cmd.addOption("--uid-always",             "+ua",    "always assign new UID");
       cmd.addOption("--uid-never",             "+un",    "never assign new UID");
+#ifdef WITH_THREADS
+    cmd.addSubGroup("multi-threading:");
+      cmd.addOption("--threads",                "+th", 1, "[n]umber: integer (default: 1)",
+                                                          "compress up to n frames in parallel");
+#endif
 
   cmd.addGroup("output options:");
     cmd.addSubGroup("post-1993 value representations:");
@@ -376,6 +382,11 @@ LICENSE_FILE_EVALUATE_COMMAND_LINE_OPTIONS
       if (cmd.findOption("--uid-never")) opt_uidcreation = EJLSUC_never;
       cmd.endOptionBlock();
 
+#ifdef WITH_THREADS
+      if (cmd.findOption("--threads"))
+        app.checkValue(cmd.getValueAndCheckMinMax(opt_threads, 1, 256));
+#endif
+
       // output options
       // post-1993 value representations
       cmd.beginOptionBlock();
@@ -425,7 +436,8 @@ LICENSE_FILE_EVALUATE_COMMAND_LINE_OPTIONS
       OFstatic_cast(Uint16, opt_t1), OFstatic_cast(Uint16, opt_t2), OFstatic_cast(Uint16, opt_t3),
       OFstatic_cast(Uint16, opt_reset), OFstatic_cast(Uint16, opt_limit),
       opt_prefer_cooked, opt_fragmentSize, opt_createOffsetTable,
-      opt_uidcreation, opt_secondarycapture, opt_interleaveMode);
+      opt_uidcreation, opt_secondarycapture, opt_interleaveMode,
+      OFstatic_cast(Uint32, opt_threads));
 
     /* make sure data dictionary is loaded */
     if (!dcmDataDict.isDictionaryLoaded())
@@ -29,6 +29,7 @@
 
 /* forward declaration */
 class DJLSCodecParameter;
+class DJLSFrameDecoder;
 
 /** abstract codec class for JPEG-LS decoders.
  *  This abstract class contains most of the application logic
@@ -218,6 +219,43 @@ private:
     Uint16 imageSamplesPerPixel,
     Uint16 bytesPerSample);
 
+  /** decompresses a single frame from the given JPEG-LS bitstream and
+   *  stores the result in the given buffer. This method does not access the
+   *  dataset and can, therefore, be called by multiple threads concurrently.
+   *  @param jlsData pointer to the complete JPEG-LS bitstream of the frame
+   *  @param compressedSize size of the JPEG-LS bitstream in bytes
+   *  @param buffer pointer to buffer where frame is to be stored
+   *  @param bufSize size of buffer in bytes
+   *  @param imageColumns number of columns for each frame
+   *  @param imageRows number of rows for each frame
+   *  @param imageSamplesPerPixel number of samples per pixel
+   *  @param bytesPerSample number of bytes per sample
+   *  @param imagePlanarConfiguration planar configuration of the decompressed frame
+   *  @return EC_Normal if successful, an error code otherwise.
+   */
+  static OFCondition decodeFrame(
+    const Uint8 *jlsData,
+    size_t compressedSize,
+    void *buffer,
+    Uint32 bufSize,
+    Uint16 imageColumns,
+    Uint16 imageRows,
+    Uint16 imageSamplesPerPixel,
+    Uint16 bytesPerSample,
+    Uint16 imagePlanarConfiguration);
+
+  /** determines the planar configuration of the decompressed image depending
+   *  on the codec parameters and the given dataset.
+   *  @param cp codec parameters for this codec
+   *  @param dataset pointer to dataset in which pixel data element is contained
+   *  @param imageSamplesPerPixel number of samples per pixel
+   *  @return planar configuration, 0 for color-by-pixel, 1 for color-by-plane
+   */
+  static Uint16 determinePlanarConfiguration(
+    const DJLSCodecParameter *cp,
+    DcmItem *dataset,
+    Uint16 imageSamplesPerPixel);
+
   /** determines if a given image requires color-by-plane planar configuration
    *  depending on SOP Class UID (DICOM IOD) and photometric interpretation.
    *  All SOP classes defined in the 2003 edition of the DICOM standard or earlier
@@ -308,6 +346,9 @@ private:
     Uint16 *imageFrame,
     Uint16 columns,
     Uint16 rows);
+
+  /// the frame decoder used by decode() calls the above private methods
+  friend class DJLSFrameDecoder;
 };
 
 /** codec class for JPEG-LS lossless only TS decoding
@@ -31,6 +31,7 @@
 class DJLSRepresentationParameter;
 class DJLSCodecParameter;
 class DicomImage;
+class DJLSFrameEncoder;
 
 /** abstract codec class for JPEG-LS encoders.
  *  This abstract class contains most of the application logic
@@ -270,8 +271,8 @@ private:
    *  @param samplesPerPixel image samples per pixel
    *  @param planarConfiguration image planar configuration
    *  @param photometricInterpretation photometric interpretation of the DICOM dataset
-   *  @param pixelSequence object in which the compressed frame is stored
-   *  @param offsetList list of frame offsets updated in this parameter
+   *  @param compressedData compressed frame returned in this parameter (allocated
+   *    with new[], to be deleted by the caller)
    *  @param compressedSize size of compressed frame returned in this parameter
    *  @param djcp parameters for the codec
    *  @return EC_Normal if successful, an error code otherwise
@@ -284,16 +285,17 @@ private:
     Uint16 samplesPerPixel,
     Uint16 planarConfiguration,
     const OFString& photometricInterpretation,
-    DcmPixelSequence *pixelSequence,
-    DcmOffsetList &offsetList,
-    unsigned long &compressedSize,
+    Uint8 *&compressedData,
+    Uint32 &compressedSize,
     const DJLSCodecParameter *djcp) const;
 
-  /** perform the lossless cooked compression of a single frame
-   *  @param pixelSequence object in which the compressed frame is stored
+  /** perform the lossless cooked compression of a single frame.
+   *  The DicomImage is not modified, so different frames can be compressed
+   *  concurrently.
    *  @param dimage DicomImage instance used to process frame
    *  @param photometricInterpretation photometric interpretation of the DICOM dataset
-   *  @param offsetList list of frame offsets updated in this parameter
+   *  @param compressedData compressed frame returned in this parameter (allocated
+   *    with new[], to be deleted by the caller)
    *  @param compressedSize size of compressed frame returned in this parameter
    *  @param djcp parameters for the codec
    *  @param frame frame index
@@ -301,11 +303,10 @@ private:
    *  @return EC_Normal if successful, an error code otherwise
    */
   OFCondition compressCookedFrame(
-    DcmPixelSequence *pixelSequence,
     DicomImage *dimage,
     const OFString& photometricInterpretation,
-    DcmOffsetList &offsetList,
-    unsigned long &compressedSize,
+    Uint8 *&compressedData,
+    Uint32 &compressedSize,
     const DJLSCodecParameter *djcp,
     Uint32 frame,
     Uint16 nearLosslessDeviation) const;
@@ -343,6 +344,9 @@ private:
     Uint32 width,
     Uint32 height,
     Uint16 bitsAllocated) const;
+
+  /// the frame encoder used by the encode methods calls the above private methods
+  friend class DJLSFrameEncoder;
 };
 
 
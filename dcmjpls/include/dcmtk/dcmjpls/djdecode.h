@@ -44,11 +44,14 @@ public:
    *  @param planarconfig flag indicating how planar configuration
    *    of color images should be encoded upon decompression.
    *  @param ignoreOffsetTable flag indicating whether to ignore the offset table when decompressing multiframe images
+   *  @param numberOfThreads maximum number of threads used for decompressing the
+   *    frames of multiframe images concurrently (only with thread support)
    */
   static void registerCodecs(
     JLS_UIDCreation uidcreation = EJLSUC_default,
     JLS_PlanarConfiguration planarconfig = EJLSPC_restore,
-    OFBool ignoreOffsetTable = OFFalse);
+    OFBool ignoreOffsetTable = OFFalse,
+    Uint32 numberOfThreads = 1);
 
   /** deregisters decoders.
    *  Attention: Must not be called while other threads might still use
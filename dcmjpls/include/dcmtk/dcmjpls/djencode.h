@@ -53,6 +53,8 @@ public:
    *  @param uidCreation               mode for SOP Instance UID creation
    *  @param convertToSC               flag indicating whether image should be converted to Secondary Capture upon compression
    *  @param jplsInterleaveMode        flag describing which interleave the JPEG-LS datastream should use
+   *  @param numberOfThreads           maximum number of threads used for compressing the frames of multiframe
+   *                                   images concurrently (only with thread support)
    */
   static void registerCodecs(
     OFBool jpls_optionsEnabled = OFFalse,
@@ -66,7 +68,8 @@ public:
     OFBool createOffsetTable = OFTrue,
     JLS_UIDCreation uidCreation = EJLSUC_default,
     OFBool convertToSC = OFFalse,
-    DJLSCodecParameter::interleaveMode jplsInterleaveMode = DJLSCodecParameter::interleaveDefault);
+    DJLSCodecParameter::interleaveMode jplsInterleaveMode = DJLSCodecParameter::interleaveDefault,
+    Uint32 numberOfThreads = 1);
 
   /** deregisters encoders.
    *  Attention: Must not be called while other threads might still use
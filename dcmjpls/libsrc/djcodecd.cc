@@ -77,6 +77,81 @@ OFBool DJLSDecoderBase::canChangeCoding(
 }
 
 
+/* decompresses single frames of a JPEG-LS compressed image, see DcmCodec::processFrames() */
+class DJLSFrameDecoder : public DcmFrameProcessor
+{
+public:
+  DJLSFrameDecoder(const OFVector<DcmCompressedFragment>& aFragments,
+                   const OFVector<Uint32>& aStartFragments,
+                   Uint8 *aImageData,
+                   Uint32 aFrameSize,
+                   Uint16 aColumns,
+                   Uint16 aRows,
+                   Uint16 aSamplesPerPixel,
+                   Uint16 aBytesPerSample,
+                   Uint16 aPlanarConfiguration)
+  : fragments(aFragments)
+  , startFragments(aStartFragments)
+  , imageData(aImageData)
+  , frameSize(aFrameSize)
+  , imageColumns(aColumns)
+  , imageRows(aRows)
+  , imageSamplesPerPixel(aSamplesPerPixel)
+  , bytesPerSample(aBytesPerSample)
+  , imagePlanarConfiguration(aPlanarConfiguration)
+  {
+  }
+
+  virtual OFCondition processFrame(Uint32 frameNo, size_t /* threadNo */)
+  {
+    DCMJPLS_DEBUG("JPEG-LS decoder processes frame " << (frameNo+1));
+    const Uint32 firstItem = startFragments[frameNo];
+    const Uint32 endItem = startFragments[frameNo + 1];
+    if ((firstItem >= endItem) || (endItem > fragments.size())) return EC_JLSCannotComputeNumberOfFragments;
+    Uint8 *frameData = imageData + frameNo * frameSize;
+
+    // a frame consisting of a single fragment can be decoded without copying the data
+    if (endItem == firstItem + 1)
+    {
+      return DJLSDecoderBase::decodeFrame(fragments[firstItem].data, fragments[firstItem].length, frameData, frameSize,
+          imageColumns, imageRows, imageSamplesPerPixel, bytesPerSample, imagePlanarConfiguration);
+    }
+
+    // otherwise, the fragments are copied into a single buffer
+    size_t compressedSize = 0;
+    Uint32 item;
+    for (item = firstItem; item < endItem; ++item)
+      compressedSize += fragments[item].length;
+    Uint8 *jlsData = new Uint8[compressedSize];
+    size_t offset = 0;
+    for (item = firstItem; item < endItem; ++item)
+    {
+      if (fragments[item].data)
+      {
+        memcpy(&jlsData[offset], fragments[item].data, fragments[item].length);
+        offset += fragments[item].length;
+      }
+    }
+    OFCondition result = DJLSDecoderBase::decodeFrame(jlsData, offset, frameData, frameSize,
+        imageColumns, imageRows, imageSamplesPerPixel, bytesPerSample, imagePlanarConfiguration);
+    delete[] jlsData;
+    return result;
+  }
+
+private:
+  const OFVector<DcmCompressedFragment>& fragments;
+  /* first fragment of each frame, followed by the total number of fragments */
+  const OFVector<Uint32>& startFragments;
+  Uint8 *imageData;
+  const Uint32 frameSize;
+  const Uint16 imageColumns;
+  const Uint16 imageRows;
+  const Uint16 imageSamplesPerPixel;
+  const Uint16 bytesPerSample;
+  const Uint16 imagePlanarConfiguration;
+};
+
+
 OFCondition DJLSDecoderBase::decode(
     const DcmRepresentationParameter * /* fromRepParam */,
     DcmPixelSequence * pixSeq,
@@ -154,23 +229,29 @@ OFCondition DJLSDecoderBase::decode(
   if (result.bad()) return result;
 
   Uint8 *pixeldata8 = OFreinterpret_cast(Uint8 *, pixeldata16);
-  Sint32 currentFrame = 0;
-  Uint32 currentItem = 1; // item 0 contains the offset table
-  OFBool done = OFFalse;
+  Uint16 imagePlanarConfiguration = determinePlanarConfiguration(djcp, dataset, imageSamplesPerPixel);
 
-  while (result.good() && !done)
+  // determine the fragments of all frames in advance, so that the frames can be decompressed independently
+  OFVector<Uint32> startFragments;
+  Uint32 currentItem = 1; // item 0 contains the offset table
+  for (Sint32 currentFrame = 0; result.good() && (currentFrame < imageFrames); ++currentFrame)
   {
-      DCMJPLS_DEBUG("JPEG-LS decoder processes frame " << (currentFrame+1));
+    Uint32 fragmentsForThisFrame = computeNumberOfFragments(imageFrames, OFstatic_cast(Uint32, currentFrame), currentItem, djcp->ignoreOffsetTable(), pixSeq);
+    if (fragmentsForThisFrame == 0) result = EC_JLSCannotComputeNumberOfFragments;
+    startFragments.push_back(currentItem);
+    currentItem += fragmentsForThisFrame;
+  }
+  startFragments.push_back(currentItem);
 
-      result = decodeFrame(pixSeq, djcp, dataset, currentFrame, currentItem, pixeldata8, frameSize,
-          imageFrames, imageColumns, imageRows, imageSamplesPerPixel, bytesPerSample);
+  // load all fragments, so that they can be accessed by multiple threads
+  OFVector<DcmCompressedFragment> fragments;
+  if (result.good()) result = loadFragments(pixSeq, fragments);
 
-      if (result.good())
-      {
-        // increment frame number, check if we're finished
-        if (++currentFrame == imageFrames) done = OFTrue;
-        pixeldata8 += frameSize;
-      }
+  if (result.good())
+  {
+    DJLSFrameDecoder frameDecoder(fragments, startFragments, pixeldata8, frameSize,
+        imageColumns, imageRows, imageSamplesPerPixel, bytesPerSample, imagePlanarConfiguration);
+    result = processFrames(frameDecoder, imageFrames, djcp->getNumberOfThreads());
   }
 
   // Number of Frames might have changed in case the previous value was wrong
@@ -303,35 +384,7 @@ OFCondition DJLSDecoderBase::decodeFrame(
   if (fragmentsForThisFrame == 0) result = EC_JLSCannotComputeNumberOfFragments;
 
   // determine planar configuration for uncompressed data
-  OFString imageSopClass;
-  OFString imagePhotometricInterpretation;
-  dataset->findAndGetOFString(DCM_SOPClassUID, imageSopClass);
-  dataset->findAndGetOFString(DCM_PhotometricInterpretation, imagePhotometricInterpretation);
-  Uint16 imagePlanarConfiguration = 0; // 0 is color-by-pixel, 1 is color-by-plane
-
-  if (imageSamplesPerPixel > 1)
-  {
-    switch (cp->getPlanarConfiguration())
-    {
-      case EJLSPC_restore:
-        // get planar configuration from dataset
-        imagePlanarConfiguration = 2; // invalid value
-        dataset->findAndGetUint16(DCM_PlanarConfiguration, imagePlanarConfiguration);
-        // determine auto default if not found or invalid
-        if (imagePlanarConfiguration > 1)
-          imagePlanarConfiguration = determinePlanarConfiguration(imageSopClass, imagePhotometricInterpretation);
-        break;
-      case EJLSPC_auto:
-        imagePlanarConfiguration = determinePlanarConfiguration(imageSopClass, imagePhotometricInterpretation);
-        break;
-      case EJLSPC_colorByPixel:
-        imagePlanarConfiguration = 0;
-        break;
-      case EJLSPC_colorByPlane:
-        imagePlanarConfiguration = 1;
-        break;
-    }
-  }
+  Uint16 imagePlanarConfiguration = determinePlanarConfiguration(cp, dataset, imageSamplesPerPixel);
 
   // get the size of all the fragments
   if (result.good())
@@ -376,64 +429,79 @@ OFCondition DJLSDecoderBase::decodeFrame(
 
   if (result.good())
   {
-    JlsParameters params;
-    JLS_ERROR err;
+    result = decodeFrame(jlsData, compressedSize, buffer, bufSize, imageColumns, imageRows,
+        imageSamplesPerPixel, bytesPerSample, imagePlanarConfiguration);
+  }
+  delete[] jlsData;
+
+  return result;
+}
+
+
+OFCondition DJLSDecoderBase::decodeFrame(
+    const Uint8 *jlsData,
+    size_t compressedSize,
+    void * buffer,
+    Uint32 bufSize,
+    Uint16 imageColumns,
+    Uint16 imageRows,
+    Uint16 imageSamplesPerPixel,
+    Uint16 bytesPerSample,
+    Uint16 imagePlanarConfiguration)
+{
+  OFCondition result = EC_Normal;
+  JlsParameters params;
+  JLS_ERROR err;
+
+  err = JpegLsReadHeader(jlsData, compressedSize, &params);
+  result = DJLSError::convert(err);
+
+  if (result.good())
+  {
+    if (params.width != imageColumns) result = EC_JLSImageDataMismatch;
+    else if (params.height != imageRows) result = EC_JLSImageDataMismatch;
+    else if (params.components != imageSamplesPerPixel) result = EC_JLSImageDataMismatch;
+    else if ((bytesPerSample == 1) && (params.bitspersample > 8)) result = EC_JLSImageDataMismatch;
+    else if ((bytesPerSample == 2) && (params.bitspersample <= 8)) result = EC_JLSImageDataMismatch;
+  }
 
-    err = JpegLsReadHeader(jlsData, compressedSize, &params);
+  if (result.good())
+  {
+    err = JpegLsDecode(buffer, bufSize, jlsData, compressedSize, &params);
     result = DJLSError::convert(err);
 
-    if (result.good())
+    if (result.good() && imageSamplesPerPixel == 3)
     {
-      if (params.width != imageColumns) result = EC_JLSImageDataMismatch;
-      else if (params.height != imageRows) result = EC_JLSImageDataMismatch;
-      else if (params.components != imageSamplesPerPixel) result = EC_JLSImageDataMismatch;
-      else if ((bytesPerSample == 1) && (params.bitspersample > 8)) result = EC_JLSImageDataMismatch;
-      else if ((bytesPerSample == 2) && (params.bitspersample <= 8)) result = EC_JLSImageDataMismatch;
+      if (imagePlanarConfiguration == 1 && params.ilv != ILV_NONE)
+      {
+        // The dataset says this should be planarConfiguration == 1, but
+        // it isn't -> convert it.
+        DCMJPLS_WARN("different planar configuration in JPEG stream, converting to \"1\"");
+        if (bytesPerSample == 1)
+          result = createPlanarConfiguration1Byte(OFreinterpret_cast(Uint8*, buffer), imageColumns, imageRows);
+        else
+          result = createPlanarConfiguration1Word(OFreinterpret_cast(Uint16*, buffer), imageColumns, imageRows);
+      }
+      else if (imagePlanarConfiguration == 0 && params.ilv != ILV_SAMPLE && params.ilv != ILV_LINE)
+      {
+        // The dataset says this should be planarConfiguration == 0, but
+        // it isn't -> convert it.
+        DCMJPLS_WARN("different planar configuration in JPEG stream, converting to \"0\"");
+        if (bytesPerSample == 1)
+          result = createPlanarConfiguration0Byte(OFreinterpret_cast(Uint8*, buffer), imageColumns, imageRows);
+        else
+          result = createPlanarConfiguration0Word(OFreinterpret_cast(Uint16*, buffer), imageColumns, imageRows);
+      }
     }
 
-    if (!result.good())
-    {
-      delete[] jlsData;
-    }
-    else
+    if (result.good())
     {
-      err = JpegLsDecode(buffer, bufSize, jlsData, compressedSize, &params);
-      result = DJLSError::convert(err);
-      delete[] jlsData;
-
-      if (result.good() && imageSamplesPerPixel == 3)
-      {
-        if (imagePlanarConfiguration == 1 && params.ilv != ILV_NONE)
+        // decompression is complete, finally adjust byte order if necessary
+        if (bytesPerSample == 1) // we're writing bytes into words
         {
-          // The dataset says this should be planarConfiguration == 1, but
-          // it isn't -> convert it.
-          DCMJPLS_WARN("different planar configuration in JPEG stream, converting to \"1\"");
-          if (bytesPerSample == 1)
-            result = createPlanarConfiguration1Byte(OFreinterpret_cast(Uint8*, buffer), imageColumns, imageRows);
-          else
-            result = createPlanarConfiguration1Word(OFreinterpret_cast(Uint16*, buffer), imageColumns, imageRows);
+            result = swapIfNecessary(gLocalByteOrder, EBO_LittleEndian, buffer,
+                    bufSize, sizeof(Uint16));
         }
-        else if (imagePlanarConfiguration == 0 && params.ilv != ILV_SAMPLE && params.ilv != ILV_LINE)
-        {
-          // The dataset says this should be planarConfiguration == 0, but
-          // it isn't -> convert it.
-          DCMJPLS_WARN("different planar configuration in JPEG stream, converting to \"0\"");
-          if (bytesPerSample == 1)
-            result = createPlanarConfiguration0Byte(OFreinterpret_cast(Uint8*, buffer), imageColumns, imageRows);
-          else
-            result = createPlanarConfiguration0Word(OFreinterpret_cast(Uint16*, buffer), imageColumns, imageRows);
-        }
-      }
-
-      if (result.good())
-      {
-          // decompression is complete, finally adjust byte order if necessary
-          if (bytesPerSample == 1) // we're writing bytes into words
-          {
-              result = swapIfNecessary(gLocalByteOrder, EBO_LittleEndian, buffer,
-                      bufSize, sizeof(Uint16));
-          }
-      }
     }
   }
 
@@ -503,6 +571,45 @@ Uint16 DJLSDecoderBase::determinePlanarConfiguration(
   return 0;
 }
 
+
+Uint16 DJLSDecoderBase::determinePlanarConfiguration(
+  const DJLSCodecParameter *cp,
+  DcmItem *dataset,
+  Uint16 imageSamplesPerPixel)
+{
+  // determine planar configuration for uncompressed data
+  OFString imageSopClass;
+  OFString imagePhotometricInterpretation;
+  dataset->findAndGetOFString(DCM_SOPClassUID, imageSopClass);
+  dataset->findAndGetOFString(DCM_PhotometricInterpretation, imagePhotometricInterpretation);
+  Uint16 imagePlanarConfiguration = 0; // 0 is color-by-pixel, 1 is color-by-plane
+
+  if (imageSamplesPerPixel > 1)
+  {
+    switch (cp->getPlanarConfiguration())
+    {
+      case EJLSPC_restore:
+        // get planar configuration from dataset
+        imagePlanarConfiguration = 2; // invalid value
+        dataset->findAndGetUint16(DCM_PlanarConfiguration, imagePlanarConfiguration);
+        // determine auto default if not found or invalid
+        if (imagePlanarConfiguration > 1)
+          imagePlanarConfiguration = determinePlanarConfiguration(imageSopClass, imagePhotometricInterpretation);
+        break;
+      case EJLSPC_auto:
+        imagePlanarConfiguration = determinePlanarConfiguration(imageSopClass, imagePhotometricInterpretation);
+        break;
+      case EJLSPC_colorByPixel:
+        imagePlanarConfiguration = 0;
+        break;
+      case EJLSPC_colorByPlane:
+        imagePlanarConfiguration = 1;
+        break;
+    }
+  }
+  return imagePlanarConfiguration;
+}
+
 Uint32 DJLSDecoderBase::computeNumberOfFragments(
   Sint32 numberOfFrames,
   Uint32 currentFrame,
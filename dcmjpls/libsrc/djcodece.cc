@@ -82,6 +82,88 @@ E_TransferSyntax DJLSNearLosslessEncoder::supportedTransferSyntax() const
 
 // --------------------------------------------------------------------------
 
+/* compresses a single frame of an image with the JPEG-LS encoder, either
+ * from the raw pixel data or from the intermediate data of a DicomImage
+ */
+class DJLSFrameEncoder : public DcmFrameEncoder
+{
+public:
+  DJLSFrameEncoder(
+    const DJLSEncoderBase& aCodec,
+    const DJLSCodecParameter *aCodecParameter,
+    const OFString& aPhotometricInterpretation,
+    unsigned long aFrameCount)
+  : codec(aCodec)
+  , djcp(aCodecParameter)
+  , photometricInterpretation(aPhotometricInterpretation)
+  , frameCount(aFrameCount)
+  , pixelData(NULL)
+  , bitsAllocated(0)
+  , columns(0)
+  , rows(0)
+  , samplesPerPixel(0)
+  , planarConfiguration(0)
+  , dimage(NULL)
+  , nearLosslessDeviation(0)
+  {
+  }
+
+  /* compress the given raw pixel data of all frames */
+  void setRawImage(
+    const Uint8 *aPixelData,
+    Uint16 aBitsAllocated,
+    Uint16 aColumns,
+    Uint16 aRows,
+    Uint16 aSamplesPerPixel,
+    Uint16 aPlanarConfiguration)
+  {
+    pixelData = aPixelData;
+    bitsAllocated = aBitsAllocated;
+    columns = aColumns;
+    rows = aRows;
+    samplesPerPixel = aSamplesPerPixel;
+    planarConfiguration = aPlanarConfiguration;
+  }
+
+  /* compress the intermediate data of the given image, which is not modified */
+  void setCookedImage(DicomImage *aImage, Uint16 aNearLosslessDeviation)
+  {
+    dimage = aImage;
+    nearLosslessDeviation = aNearLosslessDeviation;
+  }
+
+  virtual OFCondition encodeFrame(Uint32 frameNo, Uint32 /* slot */, Uint8 *& compressedData, Uint32& compressedLength)
+  {
+    DCMJPLS_DEBUG("JPEG-LS encoder processes frame " << (frameNo+1) << " of " << frameCount);
+    if (dimage != NULL)
+    {
+      return codec.compressCookedFrame(dimage, photometricInterpretation, compressedData, compressedLength,
+          djcp, frameNo, nearLosslessDeviation);
+    }
+    const unsigned long frameSize = columns * rows * samplesPerPixel * (bitsAllocated / 8);
+    return codec.compressRawFrame(pixelData + frameSize * frameNo, bitsAllocated, columns, rows,
+        samplesPerPixel, planarConfiguration, photometricInterpretation, compressedData, compressedLength, djcp);
+  }
+
+private:
+  const DJLSEncoderBase& codec;
+  const DJLSCodecParameter *djcp;
+  const OFString& photometricInterpretation;
+  unsigned long frameCount;
+  /* parameters for the raw compression */
+  const Uint8 *pixelData;
+  Uint16 bitsAllocated;
+  Uint16 columns;
+  Uint16 rows;
+  Uint16 samplesPerPixel;
+  Uint16 planarConfiguration;
+  /* parameters for the cooked compression */
+  DicomImage *dimage;
+  Uint16 nearLosslessDeviation;
+};
+
+// --------------------------------------------------------------------------
+
 DJLSEncoderBase::DJLSEncoderBase()
 : DcmCodec()
 {
@@ -486,7 +568,6 @@ OFCondition DJLSEncoderBase::losslessRawEncode(
 
   DcmOffsetList offsetList;
   unsigned long compressedSize = 0;
-  unsigned long compressedFrameSize = 0;
   double uncompressedSize = 0.0;
 
   // render and compress each frame
@@ -501,23 +582,16 @@ OFCondition DJLSEncoderBase::losslessRawEncode(
     }
 
     unsigned long frameCount = OFstatic_cast(unsigned long, numberOfFrames);
-    unsigned long frameSize = columns * rows * samplesPerPixel * bytesAllocated;
-    const Uint8 *framePointer = OFreinterpret_cast(const Uint8 *, pixelData);
 
     // compute original image size in bytes, ignoring any padding bits.
     uncompressedSize = columns * rows * samplesPerPixel * bitsStored * frameCount / 8.0;
 
-    for (unsigned long i=0; (i<frameCount) && (result.good()); ++i)
-    {
-      // compress frame
-      DCMJPLS_DEBUG("JPEG-LS encoder processes frame " << (i+1) << " of " << frameCount);
-      result = compressRawFrame(framePointer, bitsAllocated, columns, rows,
-          samplesPerPixel, planarConfiguration, photometricInterpretation,
-          pixelSequence, offsetList, compressedFrameSize, djcp);
-
-      compressedSize += compressedFrameSize;
-      framePointer += frameSize;
-    }
+    // compress all frames, possibly in parallel
+    DJLSFrameEncoder frameEncoder(*this, djcp, photometricInterpretation, frameCount);
+    frameEncoder.setRawImage(OFreinterpret_cast(const Uint8 *, pixelData), bitsAllocated, columns, rows,
+        samplesPerPixel, planarConfiguration);
+    result = DcmCodec::encodeFrames(frameEncoder, OFstatic_cast(Uint32, frameCount), djcp->getNumberOfThreads(),
+        pixelSequence, offsetList, djcp->getFragmentSize(), compressedSize);
   }
 
   // store pixel sequence if everything went well.
@@ -553,15 +627,13 @@ OFCondition DJLSEncoderBase::compressRawFrame(
   Uint16 samplesPerPixel,
   Uint16 planarConfiguration,
   const OFString& /* photometricInterpretation */,
-  DcmPixelSequence *pixelSequence,
-  DcmOffsetList &offsetList,
-  unsigned long &compressedSize,
+  Uint8 *&compressedData,
+  Uint32 &compressedSize,
   const DJLSCodecParameter *djcp) const
 {
   OFCondition result = EC_Normal;
   Uint16 bytesAllocated = bitsAllocated / 8;
   Uint32 frameSize = width*height*bytesAllocated*samplesPerPixel;
-  Uint32 fragmentSize = djcp->getFragmentSize();
   OFBool opt_use_custom_options = djcp->getUseCustomOptions();
   JlsParameters jls_params;
   Uint8 *frameBuffer = NULL;
@@ -673,11 +745,10 @@ OFCondition DJLSEncoderBase::compressRawFrame(
     if (result.good())
     {
       // 'size' now contains the size of the compressed data in buffer
-      compressedSize = size;
-      result = pixelSequence->storeCompressedFrame(offsetList, buffer, size, fragmentSize);
+      compressedData = buffer;
+      compressedSize = OFstatic_cast(Uint32, size);
     }
-
-    delete[] buffer;
+    else delete[] buffer;
   }
 
   if (frameBuffer)
@@ -779,7 +850,6 @@ OFCondition DJLSEncoderBase::losslessCookedEncode(
 
   DcmOffsetList offsetList;
   unsigned long compressedSize = 0;
-  unsigned long compressedFrameSize = 0;
   double uncompressedSize = 0.0;
 
   // render and compress each frame
@@ -793,15 +863,11 @@ OFCondition DJLSEncoderBase::losslessCookedEncode(
     uncompressedSize = dimage->getWidth() * dimage->getHeight() *
       bitsPerSample * frameCount * samplesPerPixel / 8.0;
 
-    for (unsigned long i=0; (i<frameCount) && (result.good()); ++i)
-    {
-      // compress frame
-      DCMJPLS_DEBUG("JPEG-LS encoder processes frame " << (i+1) << " of " << frameCount);
-      result = compressCookedFrame(pixelSequence, dimage,
-          photometricInterpretation, offsetList, compressedFrameSize, djcp, i, nearLosslessDeviation);
-
-      compressedSize += compressedFrameSize;
-    }
+    // compress all frames, possibly in parallel
+    DJLSFrameEncoder frameEncoder(*this, djcp, photometricInterpretation, frameCount);
+    frameEncoder.setCookedImage(dimage, nearLosslessDeviation);
+    result = DcmCodec::encodeFrames(frameEncoder, OFstatic_cast(Uint32, frameCount), djcp->getNumberOfThreads(),
+        pixelSequence, offsetList, djcp->getFragmentSize(), compressedSize);
   }
 
   // store pixel sequence if everything went well.
@@ -837,11 +903,10 @@ OFCondition DJLSEncoderBase::losslessCookedEncode(
 
 
 OFCondition DJLSEncoderBase::compressCookedFrame(
-  DcmPixelSequence *pixelSequence,
   DicomImage *dimage,
   const OFString& /* photometricInterpretation */,
-  DcmOffsetList &offsetList,
-  unsigned long &compressedSize,
+  Uint8 *&compressedData,
+  Uint32 &compressedSize,
   const DJLSCodecParameter *djcp,
   Uint32 frame,
   Uint16 nearLosslessDeviation) const
@@ -854,7 +919,6 @@ OFCondition DJLSEncoderBase::compressCookedFrame(
   int depth = dimage->getDepth();
   if ((depth < 1) || (depth > 16)) return EC_JLSUnsupportedBitDepth;
 
-  Uint32 fragmentSize = djcp->getFragmentSize();
   OFBool opt_use_custom_options = djcp->getUseCustomOptions();
 
   const DiPixel *dinter = dimage->getInterData();
@@ -1070,12 +1134,12 @@ OFCondition DJLSEncoderBase::compressCookedFrame(
   if (result.good())
   {
     // 'compressed_buffer_size' now contains the size of the compressed data in buffer
-    compressedSize = compressed_buffer_size;
-    result = pixelSequence->storeCompressedFrame(offsetList, compressed_buffer, compressed_buffer_size, fragmentSize);
+    compressedData = compressed_buffer;
+    compressedSize = OFstatic_cast(Uint32, compressed_buffer_size);
   }
+  else delete[] compressed_buffer;
 
   delete[] buffer;
-  delete[] compressed_buffer;
   if (frameBuffer)
     delete[] frameBuffer;
 
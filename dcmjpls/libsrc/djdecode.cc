@@ -34,13 +34,16 @@ DJLSNearLosslessDecoder *DJLSDecoderRegistration::nearlosslessdecoder_ = NULL;
 void DJLSDecoderRegistration::registerCodecs(
     JLS_UIDCreation uidcreation,
     JLS_PlanarConfiguration planarconfig,
-    OFBool ignoreOffsetTable)
+    OFBool ignoreOffsetTable,
+    Uint32 numberOfThreads)
 {
   if (! registered_)
   {
     cp_ = new DJLSCodecParameter(uidcreation, planarconfig, ignoreOffsetTable);
     if (cp_)
     {
+      cp_->setNumberOfThreads(numberOfThreads);
+
       losslessdecoder_ = new DJLSLosslessDecoder();
       if (losslessdecoder_) DcmCodecList::registerCodec(losslessdecoder_, NULL, cp_);
 
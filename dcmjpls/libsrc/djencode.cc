@@ -44,7 +44,8 @@ void DJLSEncoderRegistration::registerCodecs(
     OFBool createOffsetTable,
     JLS_UIDCreation uidCreation,
     OFBool convertToSC,
-    DJLSCodecParameter::interleaveMode jplsInterleaveMode)
+    DJLSCodecParameter::interleaveMode jplsInterleaveMode,
+    Uint32 numberOfThreads)
 {
   if (! registered_)
   {
@@ -54,6 +55,7 @@ void DJLSEncoderRegistration::registerCodecs(
 
     if (cp_)
     {
+      cp_->setNumberOfThreads(numberOfThreads);
       losslessencoder_ = new DJLSLosslessEncoder();
       if (losslessencoder_) DcmCodecList::registerCodec(losslessencoder_, NULL, cp_);
       nearlosslessencoder_ = new DJLSNearLosslessEncoder();
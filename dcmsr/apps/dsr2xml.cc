@@ -26,6 +26,7 @@
 #include "dcmtk/dcmsr/dsrdoc.h"
 #include "dcmtk/dcmdata/cmdlnarg.h"
 #include "dcmtk/ofstd/ofstream.h"
+#include "dcmtk/ofstd/ofbufout.h"
 #include "dcmtk/ofstd/ofconapp.h"
 #include "dcmtk/dcmdata/dcuid.h"      /* for dcmtk version name */
 
@@ -53,7 +54,8 @@ static OFCondition writeFile(STD_NAMESPACE ostream &out,
                              const size_t readFlags,
                              const size_t writeFlags,
                              const char *defaultCharset,
-                             const OFBool checkAllStrings)
+                             const OFBool checkAllStrings,
+                             const OFBool bufferedOutput)
 {
     OFCondition result = EC_IllegalParameter;
     if ((ifname != NULL) && (dset != NULL))
@@ -108,7 +110,17 @@ static OFCondition writeFile(STD_NAMESPACE ostream &out,
                     }
                 }
                 if (result.good())
-                    result = dsrdoc->writeXML(out, writeFlags);
+                {
+                    if (bufferedOutput)
+                    {
+                        // collect the output in a large buffer
+                        OFBufferedOutputStream bufferedStream(out);
+                        result = dsrdoc->writeXML(bufferedStream, writeFlags);
+                        if (result.good() && !bufferedStream.flushBuffer())
+                            result = EC_InvalidStream;
+                    } else
+                        result = dsrdoc->writeXML(out, writeFlags);
+                }
             } else {
                 OFLOG_FATAL(dsr2xmlLogger, OFFIS_CONSOLE_APPLICATION << ": error (" << result.text()
                     << ") parsing file: " << ifname);
@@ -133,6 +145,7 @@ int main(int argc, char *argv[])
     E_FileReadMode opt_readMode = ERM_autoDetect;
     E_TransferSyntax opt_ixfer = EXS_Unknown;
     OFBool opt_checkAllStrings = OFFalse;
+    OFBool opt_bufferedOutput = OFFalse;
 #ifdef WITH_LIBICONV
     OFBool opt_convertToUTF8 = OFFalse;
 #endif
@@ -186,6 +199,9 @@ int main(int argc, char *argv[])
         cmd.addOption("--write-empty-tags",     "+We",    "write all tags even if their value is empty");
         cmd.addOption("--write-item-id",        "+Wi",    "always write item identifier");
         cmd.addOption("--write-template-id",    "+Wt",    "write template identification information");
+      cmd.addSubGroup("output buffering:");
+        cmd.addOption("--unbuffered-output",    "-Ob",    "flush the output after each line (default)");
+        cmd.addOption("--buffered-output",      "+Ob",    "collect the output in a large buffer\n(faster for large documents)");
 
     /* evaluate command line */
     prepareCmdLineArgs(argc, argv, OFFIS_CONSOLE_APPLICATION);
@@ -285,6 +301,13 @@ int main(int argc, char *argv[])
         if (cmd.findOption("--write-template-id"))
             opt_writeFlags |= DSRTypes::XF_writeTemplateIdentification;
 
+        cmd.beginOptionBlock();
+        if (cmd.findOption("--unbuffered-output"))
+            opt_bufferedOutput = OFFalse;
+        if (cmd.findOption("--buffered-output"))
+            opt_bufferedOutput = OFTrue;
+        cmd.endOptionBlock();
+
         /* check conflicts and dependencies */
         if (opt_writeFlags & DSRTypes::XF_addSchemaReference)
         {
@@ -379,13 +402,13 @@ int main(int argc, char *argv[])
                     if (stream.good())
                     {
                         /* write content in XML format to file */
-                        if (writeFile(stream, ifname, dset, opt_readFlags, opt_writeFlags, opt_defaultCharset, opt_checkAllStrings).bad())
+                        if (writeFile(stream, ifname, dset, opt_readFlags, opt_writeFlags, opt_defaultCharset, opt_checkAllStrings, opt_bufferedOutput).bad())
                             result = 2;
                     } else
                         result = 1;
                 } else {
                     /* write content in XML format to standard output */
-                    if (writeFile(COUT, ifname, dset, opt_readFlags, opt_writeFlags, opt_defaultCharset, opt_checkAllStrings).bad())
+                    if (writeFile(COUT, ifname, dset, opt_readFlags, opt_writeFlags, opt_defaultCharset, opt_checkAllStrings, opt_bufferedOutput).bad())
                         result = 3;
                 }
             }
@@ -0,0 +1,96 @@
+/*
+ *
+ *  Copyright (C) 2012, OFFIS e.V.
+ *  All rights reserved.  See COPYRIGHT file for details.
+ *
+ *  This software and supporting documentation were developed by
+ *
+ *    OFFIS e.V.
+ *    R&D Division Health
+ *    Escherweg 2
+ *    D-26121 Oldenburg, Germany
+ *
+ *
+ *  Module:  ofstd
+ *
+ *  Author:  DCMTK team
+ *
+ *  Purpose: Atomic operations on integer values (Header)
+ *
+ */
+
+
+#ifndef OFATOMIC_H
+#define OFATOMIC_H
+
+#include "dcmtk/config/osconfig.h"
+
+#include "dcmtk/ofstd/oftypes.h"
+#include "dcmtk/ofstd/ofdefine.h"
+
+
+/* atomic operations are only provided if compiled with thread support and
+ * supported by the platform (Windows or gcc 4.1 and newer, incl. clang)
+ */
+#ifdef WITH_THREADS
+#if defined(HAVE_WINDOWS_H) || (defined(__GNUC__) && ((__GNUC__ > 4) || ((__GNUC__ == 4) && (__GNUC_MINOR__ >= 1))))
+#define OFATOMIC_AVAILABLE
+#endif
+#endif
+
+
+#ifdef OFATOMIC_AVAILABLE
+
+/*---------------------*
+ *  class declaration  *
+ *---------------------*/
+
+/** class providing atomic operations on integer values, which can be used for
+ *  counters that are shared between threads without a mutex.  All operations
+ *  imply a full memory barrier.  This class is only available if the symbol
+ *  OFATOMIC_AVAILABLE is defined.
+ */
+class DCMTK_OFSTD_EXPORT OFAtomic
+{
+
+ public:
+
+    /** atomically add the given value
+     *  @param value reference to the value to be modified
+     *  @param diff value to be added (might be negative)
+     *  @return new value, i.e. after adding diff
+     */
+    static long add(volatile long &value,
+                    const long diff);
+
+    /** atomically replace the given value by a new one if it has not been
+     *  modified in the meantime (compare and swap)
+     *  @param value reference to the value to be modified
+     *  @param oldValue expected current value
+     *  @param newValue value to be stored if the current value is oldValue
+     *  @return OFTrue if the value has been replaced, OFFalse otherwise
+     */
+    static OFBool compareAndSwap(volatile long &value,
+                                 const long oldValue,
+                                 const long newValue);
+
+    /** atomically replace the given pointer by a new one if it has not been
+     *  modified in the meantime (compare and swap)
+     *  @param value reference to the pointer to be modified
+     *  @param oldValue expected current pointer
+     *  @param newValue pointer to be stored if the current pointer is oldValue
+     *  @return OFTrue if the pointer has been replaced, OFFalse otherwise
+     */
+    static OFBool compareAndSwap(void * volatile &value,
+                                 void *oldValue,
+                                 void *newValue);
+
+ private:
+
+    /// private undefined constructor
+    OFAtomic();
+};
+
+#endif
+
+#endif
@@ -0,0 +1,168 @@
+/*
+ *
+ *  Copyright (C) 2012, OFFIS e.V.
+ *  All rights reserved.  See COPYRIGHT file for details.
+ *
+ *  This software and supporting documentation were developed by
+ *
+ *    OFFIS e.V.
+ *    R&D Division Health
+ *    Escherweg 2
+ *    D-26121 Oldenburg, Germany
+ *
+ *
+ *  Module:  ofstd
+ *
+ *  Author:  DCMTK team
+ *
+ *  Purpose: Classes for buffered output to a stream (Header)
+ *
+ */
+
+
+#ifndef OFBUFOUT_H
+#define OFBUFOUT_H
+
+#include "dcmtk/config/osconfig.h"
+
+#include "dcmtk/ofstd/ofstream.h"
+#include "dcmtk/ofstd/oftypes.h"
+#include "dcmtk/ofstd/ofdefine.h"
+
+
+/// default size of the output buffer (in bytes)
+#define OFBUFOUT_DEFAULT_SIZE 65536
+
+
+/*---------------------*
+ *  class declaration  *
+ *---------------------*/
+
+/** A stream buffer that collects all output in a memory buffer and passes it to
+ *  a target stream in large blocks.  In contrast to the stream buffers of the
+ *  standard library, synchronization requests (e.g. caused by OFendl or flush())
+ *  do not write the buffer to the target stream, so that the output of large
+ *  documents consisting of many short lines does not result in one write operation
+ *  per line.  The buffer is only written if it is full, if flushBuffer() is
+ *  called or if the object is destroyed.
+ */
+class DCMTK_OFSTD_EXPORT OFBufferedStreamBuf
+  : public STD_NAMESPACE streambuf
+{
+
+ public:
+
+    /** constructor
+     *  @param target stream to which the buffered output is written
+     *  @param bufferSize size of the output buffer in bytes (minimum: 1)
+     */
+    OFBufferedStreamBuf(STD_NAMESPACE ostream &target,
+                        const size_t bufferSize = OFBUFOUT_DEFAULT_SIZE);
+
+    /** destructor.
+     *  Writes the remaining content of the buffer to the target stream.
+     */
+    virtual ~OFBufferedStreamBuf();
+
+    /** write the content of the buffer to the target stream and flush the target
+     *  stream.  The buffer is reused for the subsequent output.
+     *  @return OFTrue if successful, OFFalse if the target stream reported an error
+     */
+    OFBool flushBuffer();
+
+
+ protected:
+
+    /** write the content of the buffer and the given character to the target stream.
+     *  Called if the buffer is full.
+     *  @param c character to be written (or EOF)
+     *  @return the given character (or a value other than EOF) if successful, EOF otherwise
+     */
+    virtual int overflow(int c);
+
+    /** write a sequence of characters.  Large blocks that do not fit into the buffer
+     *  are passed directly to the target stream.
+     *  @param s characters to be written
+     *  @param n number of characters to be written
+     *  @return number of characters actually written
+     */
+    virtual STD_NAMESPACE streamsize xsputn(const char *s,
+                                            STD_NAMESPACE streamsize n);
+
+    /** synchronize with the target stream.
+     *  Does not write the buffer (see class description).
+     *  @return always 0 (success)
+     */
+    virtual int sync();
+
+
+ private:
+
+    /** write the content of the buffer to the target stream (without flushing it)
+     *  @return OFTrue if successful, OFFalse otherwise
+     */
+    OFBool writeBuffer();
+
+    /// private undefined copy constructor
+    OFBufferedStreamBuf(const OFBufferedStreamBuf &);
+
+    /// private undefined assignment operator
+    OFBufferedStreamBuf &operator=(const OFBufferedStreamBuf &);
+
+    /// target stream
+    STD_NAMESPACE ostream &Target;
+
+    /// output buffer
+    char *Buffer;
+
+    /// size of the output buffer
+    size_t BufferSize;
+};
+
+
+/** An output stream that writes to another stream through an OFBufferedStreamBuf.
+ *  This class can be used to speed up the creation of large text documents (e.g.
+ *  XML) on a file or console stream: all output is collected in a buffer that is
+ *  reused for the complete document and line ends do not force the output to be
+ *  written.  The remaining output is written when the object is destroyed or when
+ *  flushBuffer() is called.
+ */
+class DCMTK_OFSTD_EXPORT OFBufferedOutputStream
+  : public STD_NAMESPACE ostream
+{
+
+ public:
+
+    /** constructor
+     *  @param target stream to which the buffered output is written
+     *  @param bufferSize size of the output buffer in bytes (minimum: 1)
+     */
+    OFBufferedOutputStream(STD_NAMESPACE ostream &target,
+                           const size_t bufferSize = OFBUFOUT_DEFAULT_SIZE);
+
+    /** destructor.
+     *  Writes the remaining content of the buffer to the target stream.
+     */
+    virtual ~OFBufferedOutputStream();
+
+    /** write the content of the buffer to the target stream and flush the target
+     *  stream.  The bad bit of this stream is set if an error occurred.
+     *  @return OFTrue if successful, OFFalse otherwise
+     */
+    OFBool flushBuffer();
+
+
+ private:
+
+    /// private undefined copy constructor
+    OFBufferedOutputStream(const OFBufferedOutputStream &);
+
+    /// private undefined assignment operator
+    OFBufferedOutputStream &operator=(const OFBufferedOutputStream &);
+
+    /// stream buffer used for the output
+    OFBufferedStreamBuf StreamBuf;
+};
+
+
+#endif
@@ -545,6 +545,24 @@ class DCMTK_OFSTD_EXPORT OFStandard
      static double atof(const char *s,
                         OFBool *success = NULL);
 
+     /** converts a floating-point number from an ASCII decimal representation
+      *  to internal double-precision format, and reports where the conversion
+      *  stopped.  This function works exactly like atof() above, but the given
+      *  string does not need to contain a single number: the conversion stops at
+      *  the first character that cannot be part of the number (e.g. a backslash
+      *  delimiting the next value of a multi-valued DICOM element).  This allows
+      *  for parsing a sequence of numbers without copying each of them first.
+      *  @param s decimal ASCII floating-point number (see atof() above)
+      *  @param success pointer to return status code, may be NULL (see atof() above)
+      *  @param endPtr pointer to a variable that receives the position of the first
+      *    character after the parsed number, may be NULL.  If no conversion could
+      *    be performed, the value of 's' is stored.
+      *  @return floating-point equivalent of string
+      */
+     static double atof(const char *s,
+                        OFBool *success,
+                        const char **endPtr);
+
      /** formats a floating-point number into an ASCII string.
       *  This function works similar to sprintf(), except that this
       *  implementation is not affected by a locale setting.
@@ -0,0 +1,183 @@
+/*
+ *
+ *  Copyright (C) 2012, OFFIS e.V.
+ *  All rights reserved.  See COPYRIGHT file for details.
+ *
+ *  This software and supporting documentation were developed by
+ *
+ *    OFFIS e.V.
+ *    R&D Division Health
+ *    Escherweg 2
+ *    D-26121 Oldenburg, Germany
+ *
+ *
+ *  Module:  ofstd
+ *
+ *  Author:  DCMTK team
+ *
+ *  Purpose: Class for processing a number of jobs with a pool of threads (Header)
+ *
+ */
+
+
+#ifndef OFTHPOOL_H
+#define OFTHPOOL_H
+
+#include "dcmtk/config/osconfig.h"
+
+#include "dcmtk/ofstd/ofcond.h"
+#include "dcmtk/ofstd/ofthread.h"
+#include "dcmtk/ofstd/ofvector.h"
+#include "dcmtk/ofstd/ofdefine.h"
+
+
+class OFThreadPoolWorker;
+
+
+/*---------------------*
+ *  class declaration  *
+ *---------------------*/
+
+/** abstract base class for a list of independent jobs that are processed by
+ *  an OFThreadPool.  The jobs are identified by their index, starting with 0.
+ *  If multiple threads are used, processJob() is called concurrently for
+ *  different jobs.  Therefore, implementations must only access data that
+ *  belongs to the given job, or data that is specific to the given thread.
+ */
+class DCMTK_OFSTD_EXPORT OFParallelJobs
+{
+
+ public:
+
+    /** destructor
+     */
+    virtual ~OFParallelJobs() {}
+
+    /** process the given job
+     *  @param jobNo index of the job, starting with 0
+     *  @param threadNo index of the calling thread, starting with 0 for the thread
+     *    calling OFThreadPool::run().  Each thread processes one job at a time, so
+     *    this index can be used for accessing thread specific data (e.g. a cache).
+     *  @return EC_Normal if successful, an error code otherwise
+     */
+    virtual OFCondition processJob(const size_t jobNo,
+                                   const size_t threadNo) = 0;
+};
+
+
+/** a pool of worker threads that processes lists of independent jobs.
+ *  The worker threads are started by the constructor and wait for jobs until
+ *  the pool is destroyed, so a pool can be used for processing many small lists
+ *  of jobs (e.g. a batch of files or blocks of data) without starting new threads
+ *  each time.  The thread calling run() also processes jobs, i.e. a pool with
+ *  N threads starts N-1 worker threads.  If compiled without thread support,
+ *  all jobs are processed by the calling thread.
+ */
+class DCMTK_OFSTD_EXPORT OFThreadPool
+{
+
+ public:
+
+    /** constructor.  Starts the worker threads.
+     *  @param numberOfThreads total number of threads that process the jobs,
+     *    including the thread calling run().  Fewer threads are used if the worker
+     *    threads cannot be started (see getNumberOfThreads()).
+     */
+    OFThreadPool(const size_t numberOfThreads);
+
+    /** destructor.  Stops the worker threads.
+     */
+    ~OFThreadPool();
+
+    /** get the number of threads that process the jobs
+     *  @return number of threads, including the thread calling run() (minimum: 1)
+     */
+    size_t getNumberOfThreads() const;
+
+    /** process the given list of jobs and wait until all of them are done.
+     *  The jobs are started in ascending order.  This method must not be called
+     *  by more than one thread at a time.
+     *  @param jobs list of jobs to be processed
+     *  @param numberOfJobs number of jobs in the list
+     *  @param stopOnError if OFTrue, no further jobs are started after a job failed
+     *  @return EC_Normal if all jobs were successful, the error of the failed job
+     *    with the lowest index otherwise
+     */
+    OFCondition run(OFParallelJobs &jobs,
+                    const size_t numberOfJobs,
+                    const OFBool stopOnError = OFTrue);
+
+    /** process the given list of jobs with a temporary pool of threads.
+     *  No more threads are started than there are jobs.
+     *  @param jobs list of jobs to be processed
+     *  @param numberOfJobs number of jobs in the list
+     *  @param numberOfThreads maximum number of threads, including the calling thread
+     *  @param stopOnError if OFTrue, no further jobs are started after a job failed
+     *  @return EC_Normal if all jobs were successful, the error of the failed job
+     *    with the lowest index otherwise
+     */
+    static OFCondition runJobs(OFParallelJobs &jobs,
+                               const size_t numberOfJobs,
+                               const size_t numberOfThreads,
+                               const OFBool stopOnError = OFTrue);
+
+
+ private:
+
+    friend class OFThreadPoolWorker;
+
+    /** process jobs of the current list until all jobs have been started
+     *  (or a job failed, if requested)
+     *  @param threadNo index of the calling thread
+     */
+    void processJobs(const size_t threadNo);
+
+    /** main loop of the worker threads: wait for a list of jobs and process it
+     *  @param threadNo index of the calling worker thread
+     */
+    void processLists(const size_t threadNo);
+
+    /// private undefined copy constructor
+    OFThreadPool(const OFThreadPool &);
+
+    /// private undefined assignment operator
+    OFThreadPool &operator=(const OFThreadPool &);
+
+    /// list of jobs currently being processed (NULL if none)
+    OFParallelJobs *Jobs;
+
+    /// number of jobs in the current list
+    size_t NumberOfJobs;
+
+    /// index of the next job to be started
+    size_t NextJob;
+
+    /// index of the failed job with the lowest index (NumberOfJobs if none)
+    size_t FailedJob;
+
+    /// error of the failed job with the lowest index
+    OFCondition Result;
+
+    /// if OFTrue, no further jobs are started after a job failed
+    OFBool StopOnError;
+
+#ifdef WITH_THREADS
+    /// worker threads (the calling thread is not included)
+    OFVector<OFThreadPoolWorker *> Workers;
+
+    /// mutex protecting the job counters and the result
+    OFMutex Mutex;
+
+    /// semaphore waking up the worker threads (once per list of jobs or for stopping)
+    OFSemaphore StartSemaphore;
+
+    /// semaphore signaling that a worker thread finished its part of the current list
+    OFSemaphore DoneSemaphore;
+
+    /// flag telling the worker threads to terminate
+    OFBool Stop;
+#endif
+};
+
+
+#endif
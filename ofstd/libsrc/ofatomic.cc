@@ -0,0 +1,69 @@
+/*
+ *
+ *  Copyright (C) 2012, OFFIS e.V.
+ *  All rights reserved.  See COPYRIGHT file for details.
+ *
+ *  This software and supporting documentation were developed by
+ *
+ *    OFFIS e.V.
+ *    R&D Division Health
+ *    Escherweg 2
+ *    D-26121 Oldenburg, Germany
+ *
+ *
+ *  Module:  ofstd
+ *
+ *  Author:  DCMTK team
+ *
+ *  Purpose: Atomic operations on integer values (Source)
+ *
+ */
+
+
+#include "dcmtk/config/osconfig.h"
+
+#include "dcmtk/ofstd/ofatomic.h"
+
+#ifdef OFATOMIC_AVAILABLE
+
+#ifdef HAVE_WINDOWS_H
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>     /* for InterlockedExchangeAdd() and InterlockedCompareExchange...() */
+#endif
+
+
+long OFAtomic::add(volatile long &value,
+                   const long diff)
+{
+#ifdef HAVE_WINDOWS_H
+    return InterlockedExchangeAdd(&value, diff) + diff;
+#else
+    return __sync_add_and_fetch(&value, diff);
+#endif
+}
+
+
+OFBool OFAtomic::compareAndSwap(volatile long &value,
+                                const long oldValue,
+                                const long newValue)
+{
+#ifdef HAVE_WINDOWS_H
+    return InterlockedCompareExchange(&value, newValue, oldValue) == oldValue;
+#else
+    return __sync_bool_compare_and_swap(&value, oldValue, newValue) ? OFTrue : OFFalse;
+#endif
+}
+
+
+OFBool OFAtomic::compareAndSwap(void * volatile &value,
+                                void *oldValue,
+                                void *newValue)
+{
+#ifdef HAVE_WINDOWS_H
+    return InterlockedCompareExchangePointer(&value, newValue, oldValue) == oldValue;
+#else
+    return __sync_bool_compare_and_swap(&value, oldValue, newValue) ? OFTrue : OFFalse;
+#endif
+}
+
+#endif
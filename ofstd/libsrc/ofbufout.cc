@@ -0,0 +1,142 @@
+/*
+ *
+ *  Copyright (C) 2012, OFFIS e.V.
+ *  All rights reserved.  See COPYRIGHT file for details.
+ *
+ *  This software and supporting documentation were developed by
+ *
+ *    OFFIS e.V.
+ *    R&D Division Health
+ *    Escherweg 2
+ *    D-26121 Oldenburg, Germany
+ *
+ *
+ *  Module:  ofstd
+ *
+ *  Author:  DCMTK team
+ *
+ *  Purpose: Classes for buffered output to a stream (Source)
+ *
+ */
+
+
+#include "dcmtk/config/osconfig.h"
+
+#include "dcmtk/ofstd/ofbufout.h"
+#include "dcmtk/ofstd/ofcast.h"
+
+#define INCLUDE_CSTRING
+#define INCLUDE_CSTDIO
+#include "dcmtk/ofstd/ofstdinc.h"
+
+
+/*------------------*
+ *  implementation  *
+ *------------------*/
+
+OFBufferedStreamBuf::OFBufferedStreamBuf(STD_NAMESPACE ostream &target,
+                                         const size_t bufferSize)
+  : STD_NAMESPACE streambuf()
+  , Target(target)
+  , Buffer(NULL)
+  , BufferSize((bufferSize > 0) ? bufferSize : 1)
+{
+    Buffer = new char[BufferSize];
+    /* reserve the last byte for the character passed to overflow() */
+    setp(Buffer, Buffer + BufferSize - 1);
+}
+
+
+OFBufferedStreamBuf::~OFBufferedStreamBuf()
+{
+    flushBuffer();
+    delete[] Buffer;
+}
+
+
+OFBool OFBufferedStreamBuf::flushBuffer()
+{
+    const OFBool result = writeBuffer();
+    Target.flush();
+    return result && Target.good();
+}
+
+
+int OFBufferedStreamBuf::overflow(int c)
+{
+    if (c != EOF)
+    {
+        /* there is always room for one more character (see constructor) */
+        *pptr() = OFstatic_cast(char, c);
+        pbump(1);
+    }
+    return writeBuffer() ? ((c != EOF) ? c : 0) : EOF;
+}
+
+
+STD_NAMESPACE streamsize OFBufferedStreamBuf::xsputn(const char *s,
+                                                     STD_NAMESPACE streamsize n)
+{
+    const size_t length = OFstatic_cast(size_t, n);
+    /* write the buffer first if the characters do not fit */
+    if (length > OFstatic_cast(size_t, epptr() - pptr()))
+    {
+        if (!writeBuffer())
+            return 0;
+        /* pass large blocks directly to the target stream */
+        if (length >= BufferSize)
+        {
+            Target.write(s, n);
+            return Target.good() ? n : 0;
+        }
+    }
+    memcpy(pptr(), s, length);
+    pbump(OFstatic_cast(int, length));
+    return n;
+}
+
+
+int OFBufferedStreamBuf::sync()
+{
+    /* keep the content of the buffer, it is written by flushBuffer() */
+    return 0;
+}
+
+
+OFBool OFBufferedStreamBuf::writeBuffer()
+{
+    const size_t length = OFstatic_cast(size_t, pptr() - pbase());
+    if (length > 0)
+        Target.write(pbase(), OFstatic_cast(STD_NAMESPACE streamsize, length));
+    /* the buffer is reused in any case */
+    setp(Buffer, Buffer + BufferSize - 1);
+    return Target.good();
+}
+
+
+/* ------------------------------------------------------------------------- */
+
+
+OFBufferedOutputStream::OFBufferedOutputStream(STD_NAMESPACE ostream &target,
+                                               const size_t bufferSize)
+  : STD_NAMESPACE ostream(NULL)
+  , StreamBuf(target, bufferSize)
+{
+    /* the stream buffer is not yet constructed when the base class is initialized */
+    rdbuf(&StreamBuf);
+}
+
+
+OFBufferedOutputStream::~OFBufferedOutputStream()
+{
+    flushBuffer();
+}
+
+
+OFBool OFBufferedOutputStream::flushBuffer()
+{
+    const OFBool result = StreamBuf.flushBuffer();
+    if (!result)
+        setstate(STD_NAMESPACE ios::badbit);
+    return result;
+}
@@ -805,6 +805,27 @@ size_t OFStandard::getFileSize(const OFString &filename)
 }
 
 
+// Markup character classes: 0 = copy unchanged, 1 = reserved character or newline,
+// 2 = other control or non-ASCII character (only converted on request or for HTML 3.2)
+static const unsigned char markup_class[256] =
+  { 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 1, 2, 2, 1, 2, 2,  // 0x00 .. 0x0f
+    2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2,  // 0x10 .. 0x1f
+    0, 0, 1, 0, 0, 0, 1, 1, 0, 0, 0, 0, 0, 0, 0, 0,  // 0x20 .. 0x2f
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 0, 1, 0,  // 0x30 .. 0x3f
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,  // 0x40 .. 0x4f
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,  // 0x50 .. 0x5f
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,  // 0x60 .. 0x6f
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 2,  // 0x70 .. 0x7f
+    2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2,  // 0x80 .. 0x8f
+    2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2,  // 0x90 .. 0x9f
+    2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2,  // 0xa0 .. 0xaf
+    2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2,  // 0xb0 .. 0xbf
+    2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2,  // 0xc0 .. 0xcf
+    2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2,  // 0xd0 .. 0xdf
+    2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2,  // 0xe0 .. 0xef
+    2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2   // 0xf0 .. 0xff
+  };
+
 OFBool OFStandard::checkForMarkupConversion(const OFString &sourceString,
                                             const OFBool convertNonASCII,
                                             const size_t maxLength)
@@ -814,13 +835,13 @@ OFBool OFStandard::checkForMarkupConversion(const OFString &sourceString,
     const size_t strLen = sourceString.length();
     /* determine maximum number of characters to be converted */
     const size_t length = (maxLength == 0) ? strLen : ((strLen < maxLength) ? strLen : maxLength);
+    const char *str = sourceString.c_str();
     /* check for characters to be converted */
     while (pos < length)
     {
-        const size_t c = OFstatic_cast(unsigned char, sourceString.at(pos));
         /* TODO: do we always need to check for the NULL byte? */
-        if ((c == '<') || (c == '>') || (c == '&') || (c == '"') || (c == '\'') ||
-            (c == 10) || (c == 13) || (convertNonASCII && ((c < 32) || (c >= 127))))
+        const unsigned char charClass = markup_class[OFstatic_cast(unsigned char, str[pos])];
+        if ((charClass == 1) || (convertNonASCII && (charClass == 2)))
         {
             /* return on the first character that needs to be converted */
             result = OFTrue;
@@ -840,13 +861,27 @@ OFCondition OFStandard::convertToMarkupStream(STD_NAMESPACE ostream &out,
                                               const size_t maxLength)
 {
     size_t pos = 0;
+    size_t start = 0;
     const size_t strLen = sourceString.length();
     /* determine maximum number of characters to be converted */
     const size_t length = (maxLength == 0) ? strLen : ((strLen < maxLength) ? strLen : maxLength);
+    /* control and non-ASCII characters are always converted in HTML 3.2 mode */
+    const OFBool convertOther = convertNonASCII || (markupMode == MM_HTML32);
+    const char *str = sourceString.c_str();
     /* replace HTML/XHTML/XML reserved characters */
     while (pos < length)
     {
-        const char c = sourceString.at(pos);
+        const char c = str[pos];
+        const unsigned char charClass = markup_class[OFstatic_cast(unsigned char, c)];
+        /* just append (TODO: what about the NULL byte?) */
+        if ((charClass == 0) || ((charClass == 2) && !convertOther))
+        {
+            ++pos;
+            continue;
+        }
+        /* write all unchanged characters at once */
+        if (pos > start)
+            out.write(str + start, OFstatic_cast(STD_NAMESPACE streamsize, pos - start));
         /* less than */
         if (c == '<')
             out << "&lt;";
@@ -898,19 +933,14 @@ OFCondition OFStandard::convertToMarkupStream(STD_NAMESPACE ostream &out,
                     out << "&para;";
             }
         } else {
-            const size_t charValue = OFstatic_cast(unsigned char, c);
-            /* other character: ... */
-            if ((convertNonASCII || (markupMode == MM_HTML32)) && ((charValue < 32) || (charValue >= 127)))
-            {
-                /* convert < #32 and >= #127 to Unicode (ISO Latin-1) */
-                out << "&#" << charValue << ";";
-            } else {
-                /* just append (TODO: what about the NULL byte?) */
-                out << c;
-            }
+            /* convert < #32 and >= #127 to Unicode (ISO Latin-1) */
+            out << "&#" << OFstatic_cast(size_t, OFstatic_cast(unsigned char, c)) << ";";
         }
-        ++pos;
+        start = ++pos;
     }
+    /* write remaining unchanged characters */
+    if (pos > start)
+        out.write(str + start, OFstatic_cast(STD_NAMESPACE streamsize, pos - start));
     return EC_Normal;
 }
 
@@ -1010,6 +1040,9 @@ const OFString &OFStandard::convertToOctalString(const OFString &sourceString,
 // Base64 translation table as described in RFC 2045 (MIME)
 static const char enc_base64[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
 
+// size of the buffer used for writing the Base64 encoded data to the output stream
+#define BASE64_BUFFER_SIZE 4096
+
 OFCondition OFStandard::encodeBase64(STD_NAMESPACE ostream &out,
                                      const unsigned char *data,
                                      const size_t length,
@@ -1019,28 +1052,37 @@ OFCondition OFStandard::encodeBase64(STD_NAMESPACE ostream &out,
     /* check data buffer to be encoded */
     if (data != NULL)
     {
+        /* encoded characters are collected in a buffer, each step adds at most 8 characters */
+        char buffer[BASE64_BUFFER_SIZE];
+        size_t n = 0;
         unsigned char c;
         size_t w = 0;
         /* iterate over all data elements */
         for (size_t i = 0; i < length; i++)
         {
+            /* write buffer to the stream if it might be too small for the next step */
+            if (n > BASE64_BUFFER_SIZE - 8)
+            {
+                out.write(buffer, OFstatic_cast(STD_NAMESPACE streamsize, n));
+                n = 0;
+            }
             /* encode first 6 bits */
-            out << enc_base64[(data[i] >> 2) & 0x3f];
+            buffer[n++] = enc_base64[(data[i] >> 2) & 0x3f];
             /* insert line break (if width > 0) */
             if (++w == width)
             {
-                out << OFendl;
+                buffer[n++] = '\n';
                 w = 0;
             }
             /* encode remaining 2 bits of the first byte and 4 bits of the second byte */
             c = (data[i] << 4) & 0x3f;
             if (++i < length)
                 c |= (data[i] >> 4) & 0x0f;
-            out << enc_base64[c];
+            buffer[n++] = enc_base64[c];
             /* insert line break (if width > 0) */
             if (++w == width)
             {
-                out << OFendl;
+                buffer[n++] = '\n';
                 w = 0;
             }
             /* encode remaining 4 bits of the second byte and 2 bits of the third byte */
@@ -1049,31 +1091,33 @@ OFCondition OFStandard::encodeBase64(STD_NAMESPACE ostream &out,
                 c = (data[i] << 2) & 0x3f;
                 if (++i < length)
                     c |= (data[i] >> 6) & 0x03;
-                out << enc_base64[c];
+                buffer[n++] = enc_base64[c];
             } else {
                 i++;
                 /* append fill char */
-                out << '=';
+                buffer[n++] = '=';
             }
             /* insert line break (if width > 0) */
             if (++w == width)
             {
-                out << OFendl;
+                buffer[n++] = '\n';
                 w = 0;
             }
             /* encode remaining 6 bits of the third byte */
             if (i < length)
-                out << enc_base64[data[i] & 0x3f];
+                buffer[n++] = enc_base64[data[i] & 0x3f];
             else /* append fill char */
-                out << '=';
+                buffer[n++] = '=';
             /* insert line break (if width > 0) */
             if (++w == width)
             {
-                out << OFendl;
+                buffer[n++] = '\n';
                 w = 0;
             }
         }
-        /* flush stream */
+        /* write remaining characters and flush stream */
+        if (n > 0)
+            out.write(buffer, OFstatic_cast(STD_NAMESPACE streamsize, n));
         out.flush();
         status = EC_Normal;
     }
@@ -1192,6 +1236,16 @@ double OFStandard::atof(const char *s, OFBool *success)
   return result;
 }
 
+double OFStandard::atof(const char *s, OFBool *success, const char **endPtr)
+{
+  double result = 0.0;
+  int count = 0;
+  const OFBool converted = (1 == sscanf(s,"%lf%n",&result,&count));
+  if (success) *success = converted;
+  if (endPtr) *endPtr = converted ? s + count : s;
+  return result;
+}
+
 #else
 
 // --- definitions and constants for atof() ---
@@ -1219,8 +1273,14 @@ static const double atof_powersOf10[] =
 };
 
 double OFStandard::atof(const char *s, OFBool *success)
+{
+    return atof(s, success, NULL);
+}
+
+double OFStandard::atof(const char *s, OFBool *success, const char **endPtr)
 {
     if (success) *success = OFFalse;
+    if (endPtr) *endPtr = s;
     register const char *p = s;
     register char c;
     int sign = 0;
@@ -1340,12 +1400,17 @@ double OFStandard::atof(const char *s, OFBool *success)
             if (*p == '+') ++p;
             expSign = 0;
         }
-        while (isdigit(OFstatic_cast(unsigned char, *p)))
+        if (isdigit(OFstatic_cast(unsigned char, *p)))
         {
-            exponent = exponent * 10 + (*p - '0');
-            ++p;
+            while (isdigit(OFstatic_cast(unsigned char, *p)))
+            {
+                exponent = exponent * 10 + (*p - '0');
+                ++p;
+            }
         }
+        else p = pExp; // "E" without exponent is not part of the number
     }
+    if (endPtr) *endPtr = p;
 
     if (expSign)
        exponent = fracExp - exponent;
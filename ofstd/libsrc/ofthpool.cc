@@ -0,0 +1,229 @@
+/*
+ *
+ *  Copyright (C) 2012, OFFIS e.V.
+ *  All rights reserved.  See COPYRIGHT file for details.
+ *
+ *  This software and supporting documentation were developed by
+ *
+ *    OFFIS e.V.
+ *    R&D Division Health
+ *    Escherweg 2
+ *    D-26121 Oldenburg, Germany
+ *
+ *
+ *  Module:  ofstd
+ *
+ *  Author:  DCMTK team
+ *
+ *  Purpose: Class for processing a number of jobs with a pool of threads (Source)
+ *
+ */
+
+
+#include "dcmtk/config/osconfig.h"
+
+#include "dcmtk/ofstd/ofthpool.h"
+
+
+/*------------------------------*
+ *  worker thread of the pool  *
+ *------------------------------*/
+
+#ifdef WITH_THREADS
+
+/* worker thread that processes the lists of jobs passed to the pool */
+class OFThreadPoolWorker : public OFThread
+{
+
+ public:
+
+    OFThreadPoolWorker(OFThreadPool &pool,
+                       const size_t threadNo)
+      : OFThread()
+      , Pool(pool)
+      , ThreadNo(threadNo)
+    {
+    }
+
+ protected:
+
+    virtual void run()
+    {
+        Pool.processLists(ThreadNo);
+    }
+
+ private:
+
+    OFThreadPool &Pool;
+    const size_t ThreadNo;
+
+    // private undefined copy constructor and assignment operator
+    OFThreadPoolWorker(const OFThreadPoolWorker &);
+    OFThreadPoolWorker &operator=(const OFThreadPoolWorker &);
+};
+
+#endif
+
+
+/*------------------*
+ *  implementation  *
+ *------------------*/
+
+OFThreadPool::OFThreadPool(const size_t numberOfThreads)
+  : Jobs(NULL)
+  , NumberOfJobs(0)
+  , NextJob(0)
+  , FailedJob(0)
+  , Result(EC_Normal)
+  , StopOnError(OFTrue)
+#ifdef WITH_THREADS
+  , Workers()
+  , Mutex()
+  , StartSemaphore(0)
+  , DoneSemaphore(0)
+  , Stop(OFFalse)
+#endif
+{
+#ifdef WITH_THREADS
+    if (numberOfThreads > 1)
+    {
+        Workers.reserve(numberOfThreads - 1);
+        for (size_t i = 1; i < numberOfThreads; ++i)
+        {
+            OFThreadPoolWorker *worker = new OFThreadPoolWorker(*this, i);
+            /* use fewer threads if a worker thread cannot be started */
+            if (worker->start() != 0)
+            {
+                delete worker;
+                break;
+            }
+            Workers.push_back(worker);
+        }
+    }
+#else
+    (void) numberOfThreads;
+#endif
+}
+
+
+OFThreadPool::~OFThreadPool()
+{
+#ifdef WITH_THREADS
+    /* wake up all worker threads and wait until they have terminated */
+    Stop = OFTrue;
+    for (size_t i = 0; i < Workers.size(); ++i)
+        StartSemaphore.post();
+    for (size_t j = 0; j < Workers.size(); ++j)
+    {
+        Workers[j]->join();
+        delete Workers[j];
+    }
+#endif
+}
+
+
+size_t OFThreadPool::getNumberOfThreads() const
+{
+#ifdef WITH_THREADS
+    return Workers.size() + 1;
+#else
+    return 1;
+#endif
+}
+
+
+OFCondition OFThreadPool::run(OFParallelJobs &jobs,
+                              const size_t numberOfJobs,
+                              const OFBool stopOnError)
+{
+    Jobs = &jobs;
+    NumberOfJobs = numberOfJobs;
+    NextJob = 0;
+    FailedJob = numberOfJobs;
+    Result = EC_Normal;
+    StopOnError = stopOnError;
+#ifdef WITH_THREADS
+    /* wake up no more worker threads than needed, the calling thread also processes jobs */
+    const size_t numberOfWorkers = (numberOfJobs > Workers.size()) ? Workers.size()
+        : ((numberOfJobs > 0) ? numberOfJobs - 1 : 0);
+    for (size_t i = 0; i < numberOfWorkers; ++i)
+        StartSemaphore.post();
+    processJobs(0);
+    for (size_t j = 0; j < numberOfWorkers; ++j)
+        DoneSemaphore.wait();
+#else
+    processJobs(0);
+#endif
+    Jobs = NULL;
+    return Result;
+}
+
+
+OFCondition OFThreadPool::runJobs(OFParallelJobs &jobs,
+                                  const size_t numberOfJobs,
+                                  const size_t numberOfThreads,
+                                  const OFBool stopOnError)
+{
+    OFThreadPool pool((numberOfThreads < numberOfJobs) ? numberOfThreads : numberOfJobs);
+    return pool.run(jobs, numberOfJobs, stopOnError);
+}
+
+
+void OFThreadPool::processJobs(const size_t threadNo)
+{
+    while (1)
+    {
+        /* determine the next job to be processed */
+#ifdef WITH_THREADS
+        Mutex.lock();
+#endif
+        const OFBool finished = (NextJob >= NumberOfJobs) || (StopOnError && (FailedJob < NumberOfJobs));
+        const size_t jobNo = NextJob;
+        if (!finished)
+            ++NextJob;
+#ifdef WITH_THREADS
+        Mutex.unlock();
+#endif
+        if (finished)
+            break;
+        OFCondition status = Jobs->processJob(jobNo, threadNo);
+        if (status.bad())
+        {
+            /* report the failed job with the lowest index */
+#ifdef WITH_THREADS
+            Mutex.lock();
+#endif
+            if (jobNo < FailedJob)
+            {
+                FailedJob = jobNo;
+                Result = status;
+            }
+#ifdef WITH_THREADS
+            Mutex.unlock();
+#endif
+        }
+    }
+}
+
+
+#ifdef WITH_THREADS
+
+void OFThreadPool::processLists(const size_t threadNo)
+{
+    while (1)
+    {
+        StartSemaphore.wait();
+        if (Stop)
+            break;
+        processJobs(threadNo);
+        DoneSemaphore.post();
+    }
+}
+
+#else
+
+void OFThreadPool::processLists(const size_t /* threadNo */)
+{
+}
+
+#endif
@@ -0,0 +1,109 @@
+/*
+ *
+ *  Copyright (C) 2012, OFFIS e.V.
+ *  All rights reserved.  See COPYRIGHT file for details.
+ *
+ *  This software and supporting documentation were developed by
+ *
+ *    OFFIS e.V.
+ *    R&D Division Health
+ *    Escherweg 2
+ *    D-26121 Oldenburg, Germany
+ *
+ *
+ *  Module:  ofstd
+ *
+ *  Author:  DCMTK team
+ *
+ *  Purpose: test program for the atomic operations
+ *
+ */
+
+
+#include "dcmtk/config/osconfig.h"    /* make sure OS specific configuration is included first */
+
+#define OFTEST_OFSTD_ONLY
+#include "dcmtk/ofstd/oftest.h"
+#include "dcmtk/ofstd/ofatomic.h"
+
+#ifdef OFATOMIC_AVAILABLE
+
+#include "dcmtk/ofstd/ofthread.h"
+
+
+/* number of threads used for the test */
+#define NUMBER_OF_THREADS 4
+
+/* number of operations per thread */
+#define NUMBER_OF_OPERATIONS 100000
+
+
+// thread that increments a shared counter by both operations
+class AtomicThread : public OFThread
+{
+ public:
+    AtomicThread(volatile long &added, volatile long &swapped)
+      : OFThread(), Added(added), Swapped(swapped)
+    {
+    }
+
+    virtual void run()
+    {
+        for (int i = 0; i < NUMBER_OF_OPERATIONS; ++i)
+        {
+            OFAtomic::add(Added, 2);
+            long value;
+            do {
+                value = Swapped;
+            } while (!OFAtomic::compareAndSwap(Swapped, value, value + 1));
+        }
+    }
+
+ private:
+    volatile long &Added;
+    volatile long &Swapped;
+};
+
+
+OFTEST(ofstd_OFAtomic)
+{
+    volatile long value = 5;
+    OFCHECK_EQUAL(OFAtomic::add(value, 3), 8);
+    OFCHECK_EQUAL(OFAtomic::add(value, -10), -2);
+    OFCHECK(!OFAtomic::compareAndSwap(value, 0, 1));
+    OFCHECK_EQUAL(value, -2);
+    OFCHECK(OFAtomic::compareAndSwap(value, -2, 1));
+    OFCHECK_EQUAL(value, 1);
+
+    int first = 0;
+    int second = 0;
+    void * volatile pointer = NULL;
+    OFCHECK(OFAtomic::compareAndSwap(pointer, NULL, &first));
+    OFCHECK(!OFAtomic::compareAndSwap(pointer, NULL, &second));
+    OFCHECK(pointer == &first);
+
+    // no update must be lost when several threads modify the same values
+    volatile long added = 0;
+    volatile long swapped = 0;
+    AtomicThread *threads[NUMBER_OF_THREADS];
+    for (int i = 0; i < NUMBER_OF_THREADS; ++i)
+        threads[i] = new AtomicThread(added, swapped);
+    for (int i = 0; i < NUMBER_OF_THREADS; ++i)
+        OFCHECK_EQUAL(threads[i]->start(), 0);
+    for (int i = 0; i < NUMBER_OF_THREADS; ++i)
+    {
+        OFCHECK_EQUAL(threads[i]->join(), 0);
+        delete threads[i];
+    }
+    OFCHECK_EQUAL(added, 2L * NUMBER_OF_THREADS * NUMBER_OF_OPERATIONS);
+    OFCHECK_EQUAL(swapped, 1L * NUMBER_OF_THREADS * NUMBER_OF_OPERATIONS);
+}
+
+#else
+
+OFTEST(ofstd_OFAtomic)
+{
+    // without atomic operations, there is nothing to test here
+}
+
+#endif
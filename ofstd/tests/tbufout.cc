@@ -0,0 +1,86 @@
+/*
+ *
+ *  Copyright (C) 2012, OFFIS e.V.
+ *  All rights reserved.  See COPYRIGHT file for details.
+ *
+ *  This software and supporting documentation were developed by
+ *
+ *    OFFIS e.V.
+ *    R&D Division Health
+ *    Escherweg 2
+ *    D-26121 Oldenburg, Germany
+ *
+ *
+ *  Module:  ofstd
+ *
+ *  Author:  DCMTK team
+ *
+ *  Purpose: test program for the buffered output stream
+ *
+ */
+
+
+#include "dcmtk/config/osconfig.h"    /* make sure OS specific configuration is included first */
+
+#define OFTEST_OFSTD_ONLY
+#include "dcmtk/ofstd/oftest.h"
+#include "dcmtk/ofstd/ofbufout.h"
+#include "dcmtk/ofstd/ofstd.h"
+
+
+// write some XML-like content with short lines, long strings and Base64 data
+static void writeContent(STD_NAMESPACE ostream &out, const OFString &longString)
+{
+    unsigned char data[300];
+    for (size_t i = 0; i < sizeof(data); ++i)
+        data[i] = OFstatic_cast(unsigned char, i);
+    out << "<?xml version=\"1.0\"?>" << OFendl;
+    for (int i = 0; i < 20; ++i)
+    {
+        out << "<element tag=\"" << i << "\">";
+        OFStandard::convertToMarkupStream(out, longString.substr(0, 50 * i), OFTrue /* convertNonASCII */);
+        out << "</element>" << OFendl;
+    }
+    out << "<data>";
+    OFStandard::encodeBase64(out, data, sizeof(data), 72 /* width */);
+    out << "</data>" << OFendl << 'x';
+    out.write(longString.c_str(), longString.length());
+    out.flush();
+}
+
+
+OFTEST(ofstd_OFBufferedOutputStream)
+{
+    OFString longString;
+    for (int i = 0; i < 100; ++i)
+        longString += "A rather long <string> with \"special\" characters & an \366 umlaut\n";
+    // reference output written directly to the string stream
+    OFOStringStream reference;
+    writeContent(reference, longString);
+    OFSTRINGSTREAM_GETOFSTRING(reference, expected)
+    // the result is the same for all buffer sizes, including very small ones
+    const size_t bufferSizes[] = { 0, 1, 7, 100, 4096, OFBUFOUT_DEFAULT_SIZE };
+    for (size_t i = 0; i < sizeof(bufferSizes) / sizeof(bufferSizes[0]); ++i)
+    {
+        OFOStringStream target;
+        {
+            OFBufferedOutputStream out(target, bufferSizes[i]);
+            writeContent(out, longString);
+            OFCHECK(out.good());
+        }
+        OFSTRINGSTREAM_GETOFSTRING(target, result)
+        OFCHECK_EQUAL(result, expected);
+    }
+    // line ends and flush() do not write the buffer, flushBuffer() does
+    OFOStringStream target;
+    OFBufferedOutputStream out(target);
+    out << "line" << OFendl;
+    out.flush();
+    OFCHECK_EQUAL(OFstatic_cast(long, target.tellp()), 0);
+    OFCHECK(out.flushBuffer());
+    OFCHECK_EQUAL(OFstatic_cast(long, target.tellp()), 5);
+    out << "more" << OFendl;
+    OFCHECK(out.flushBuffer());
+    OFSTRINGSTREAM_GETOFSTRING(target, result)
+    OFCHECK_EQUAL(result, "line\nmore\n");
+}
@@ -24,6 +24,8 @@
 #define OFTEST_OFSTD_ONLY
 #include "dcmtk/ofstd/oftest.h"
 
+OFTEST_REGISTER(ofstd_OFAtomic);
+OFTEST_REGISTER(ofstd_OFBufferedOutputStream);
 OFTEST_REGISTER(ofstd_OFCharacterEncoding_1);
 OFTEST_REGISTER(ofstd_OFCharacterEncoding_2);
 OFTEST_REGISTER(ofstd_OFCharacterEncoding_3);
@@ -49,6 +51,7 @@ OFTEST_REGISTER(ofstd_OFString_identity_2);
 OFTEST_REGISTER(ofstd_OFString_identity_3);
 OFTEST_REGISTER(ofstd_OFString_reserve);
 OFTEST_REGISTER(ofstd_OFString_substr);
+OFTEST_REGISTER(ofstd_OFThreadPool);
 OFTEST_REGISTER(ofstd_OFTime);
 OFTEST_REGISTER(ofstd_OFUUID_1);
 OFTEST_REGISTER(ofstd_OFUUID_2);
@@ -0,0 +1,106 @@
+/*
+ *
+ *  Copyright (C) 2012, OFFIS e.V.
+ *  All rights reserved.  See COPYRIGHT file for details.
+ *
+ *  This software and supporting documentation were developed by
+ *
+ *    OFFIS e.V.
+ *    R&D Division Health
+ *    Escherweg 2
+ *    D-26121 Oldenburg, Germany
+ *
+ *
+ *  Module:  ofstd
+ *
+ *  Author:  DCMTK team
+ *
+ *  Purpose: test program for the thread pool
+ *
+ */
+
+
+#include "dcmtk/config/osconfig.h"    /* make sure OS specific configuration is included first */
+
+#define OFTEST_OFSTD_ONLY
+#include "dcmtk/ofstd/oftest.h"
+#include "dcmtk/ofstd/ofthpool.h"
+
+
+// list of jobs that record the processing threads and fail for selected jobs
+class TestJobs : public OFParallelJobs
+{
+ public:
+    TestJobs(const size_t numberOfJobs, const size_t failAt = 0)
+      : Processed(numberOfJobs, 0)
+      , ThreadNo(numberOfJobs, 0)
+      , FailAt(failAt)
+    {
+    }
+
+    virtual OFCondition processJob(const size_t jobNo, const size_t threadNo)
+    {
+        ++Processed[jobNo];
+        ThreadNo[jobNo] = threadNo;
+        /* fail for every job with an index that is a multiple of FailAt */
+        if ((FailAt > 0) && (jobNo > 0) && (jobNo % FailAt == 0))
+            return makeOFCondition(0, OFstatic_cast(unsigned short, jobNo), OF_error, "job failed");
+        return EC_Normal;
+    }
+
+    OFVector<int> Processed;
+    OFVector<size_t> ThreadNo;
+    size_t FailAt;
+};
+
+
+OFTEST(ofstd_OFThreadPool)
+{
+    const size_t numberOfJobs = 100;
+    OFThreadPool pool(4);
+    const size_t numberOfThreads = pool.getNumberOfThreads();
+    OFCHECK(numberOfThreads >= 1);
+    OFCHECK(numberOfThreads <= 4);
+    // the pool is reused for several lists of jobs, each job is processed exactly once
+    for (size_t round = 0; round < 10; ++round)
+    {
+        TestJobs jobs(numberOfJobs);
+        OFCHECK(pool.run(jobs, numberOfJobs).good());
+        for (size_t i = 0; i < numberOfJobs; ++i)
+        {
+            OFCHECK_EQUAL(jobs.Processed[i], 1);
+            OFCHECK(jobs.ThreadNo[i] < numberOfThreads);
+        }
+    }
+    // an empty list and a list with fewer jobs than threads
+    TestJobs noJobs(0);
+    OFCHECK(pool.run(noJobs, 0).good());
+    TestJobs fewJobs(2);
+    OFCHECK(pool.run(fewJobs, 2).good());
+    OFCHECK_EQUAL(fewJobs.Processed[0], 1);
+    OFCHECK_EQUAL(fewJobs.Processed[1], 1);
+    // without stopping on errors, all jobs are processed and the first error is returned
+    TestJobs failingJobs(numberOfJobs, 7);
+    OFCondition status = pool.run(failingJobs, numberOfJobs, OFFalse /* stopOnError */);
+    OFCHECK(status.bad());
+    OFCHECK_EQUAL(status.code(), 7);
+    for (size_t i = 0; i < numberOfJobs; ++i)
+        OFCHECK_EQUAL(failingJobs.Processed[i], 1);
+    // when stopping on errors, all jobs up to the first error are processed and
+    // no job is processed twice
+    TestJobs stoppingJobs(numberOfJobs, 7);
+    status = pool.run(stoppingJobs, numberOfJobs);
+    OFCHECK(status.bad());
+    OFCHECK_EQUAL(status.code(), 7);
+    for (size_t i = 0; i < numberOfJobs; ++i)
+    {
+        OFCHECK(stoppingJobs.Processed[i] <= 1);
+        if (i <= 7)
+            OFCHECK_EQUAL(stoppingJobs.Processed[i], 1);
+    }
+    // temporary pool, also with more threads than jobs
+    TestJobs tempJobs(3);
+    OFCHECK(OFThreadPool::runJobs(tempJobs, 3, 8).good());
+    for (size_t i = 0; i < 3; ++i)
+        OFCHECK_EQUAL(tempJobs.Processed[i], 1);
+}